@@ -424,6 +424,7 @@ namespace HACD
 		m_gamma = 0.01;
         m_nVerticesPerCH = 30;
 		m_callBack = 0;
+		m_jobRunner = 0;
         m_addExtraDistPoints = false;
 		m_scale = 1000.0;
 		m_partition = 0;
@@ -449,18 +450,20 @@ namespace HACD
         delete [] m_extraDistNormals;
 	}
 
+    void HACD::OrientEdge(size_t e)
+    {
+		GraphEdge & gE = m_graph.m_edges[e];
+        if (m_graph.m_vertices[gE.m_v2].m_ancestors.size()>m_graph.m_vertices[gE.m_v1].m_ancestors.size())
+        {
+			std::swap(gE.m_v1, gE.m_v2);
+        }
+    }
     void HACD::ComputeEdgeCost(size_t e)
     {
+		OrientEdge(e);
 		GraphEdge & gE = m_graph.m_edges[e];
         long v1 = gE.m_v1;
         long v2 = gE.m_v2;
-
-        if (m_graph.m_vertices[v2].m_ancestors.size()>m_graph.m_vertices[v1].m_ancestors.size())
-        {
-            gE.m_v1 = v2;
-            gE.m_v2 = v1;
-			std::swap(v1, v2);
-        }
 		GraphVertex & gV1 = m_graph.m_vertices[v1];
 		GraphVertex & gV2 = m_graph.m_vertices[v2];
 #ifdef HACD_DEBUG
@@ -618,12 +621,62 @@ namespace HACD
 		double volume  = volumeCH/pow(m_scale, 3.0);	// cluster's volume
         gE.m_error     = static_cast<Real>(concavity +  m_alpha * (1.0 - weightFlat) * ratio + m_beta * volume + m_gamma * static_cast<double>(distPoints.size()) / m_nPoints);	// cluster's priority
 	}
+	struct EdgeCostJobs
+	{
+		HACD *								m_hacd;
+		std::vector< std::vector<long> >	m_groups;
+	};
+	void HACD::ComputeEdgeCostsJob(void * data, size_t i)
+	{
+		EdgeCostJobs * jobs = static_cast<EdgeCostJobs *>(data);
+		const std::vector<long> & group = jobs->m_groups[i];
+		for (size_t e = 0; e < group.size(); ++e)
+		{
+			jobs->m_hacd->ComputeEdgeCost(group[e]);
+		}
+	}
+    void HACD::ComputeEdgeCosts(const std::vector<long> & edges)
+    {
+		// the heap manager is not thread safe, and a handful of edges is not worth the hand over
+		const size_t minParallelEdges = 8;
+		if (!m_jobRunner || m_heapManager || edges.size() < minParallelEdges)
+		{
+			for (size_t i = 0; i < edges.size(); ++i)
+			{
+				ComputeEdgeCost(edges[i]);
+			}
+			return;
+		}
+		// copying a cluster's convex-hull renumbers the source mesh, so the edges
+		// starting from the same cluster are computed by the same job
+		EdgeCostJobs jobs;
+		jobs.m_hacd = this;
+		std::map<long, size_t> groups;
+		for (size_t i = 0; i < edges.size(); ++i)
+		{
+			OrientEdge(edges[i]);
+			long v1 = m_graph.m_edges[edges[i]].m_v1;
+			std::map<long, size_t>::iterator itG = groups.find(v1);
+			if (itG == groups.end())
+			{
+				itG = groups.insert(std::pair<long, size_t>(v1, jobs.m_groups.size())).first;
+				jobs.m_groups.push_back(std::vector<long>());
+			}
+			jobs.m_groups[itG->second].push_back(edges[i]);
+		}
+		m_jobRunner->Run(jobs.m_groups.size(), &HACD::ComputeEdgeCostsJob, &jobs);
+    }
     bool HACD::InitializePriorityQueue()
     {
 		m_pqueue.reserve(m_graph.m_nE + 100);
+		std::vector<long> edges(m_graph.m_nE);
+        for (size_t e=0; e < m_graph.m_nE; ++e) 
+        {
+			edges[e] = static_cast<long>(e);
+        }
+		ComputeEdgeCosts(edges);
         for (size_t e=0; e < m_graph.m_nE; ++e) 
         {
-            ComputeEdgeCost(static_cast<long>(e));
 			m_pqueue.push(GraphEdgePriorityQueue(static_cast<long>(e), m_graph.m_edges[e].m_error));
         }
 		return true;
@@ -863,12 +916,15 @@ namespace HACD
 					printf("v1 %i v2 %i \n", v1, v2);
 	#endif
 					m_graph.EdgeCollapse(v1, v2);
-					long idEdge;
-					for(size_t itE = 0; itE < m_graph.m_vertices[v1].m_edges.Size(); ++itE)
+					std::vector<long> edges(m_graph.m_vertices[v1].m_edges.Size());
+					for(size_t itE = 0; itE < edges.size(); ++itE)
+					{
+						edges[itE] = m_graph.m_vertices[v1].m_edges[itE];
+					}
+					ComputeEdgeCosts(edges);
+					for(size_t itE = 0; itE < edges.size(); ++itE)
 					{
-						idEdge = m_graph.m_vertices[v1].m_edges[itE];
-						ComputeEdgeCost(idEdge);
-						m_pqueue.push(GraphEdgePriorityQueue(idEdge, m_graph.m_edges[idEdge].m_error));
+						m_pqueue.push(GraphEdgePriorityQueue(edges[itE], m_graph.m_edges[edges[itE]].m_error));
 					}
 				}
 			}
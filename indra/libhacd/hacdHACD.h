@@ -83,6 +83,15 @@ namespace HACD
 	
 	typedef ICallback* CallBackFunction;
 
+	//! Runs independent jobs, possibly concurrently
+    class IJobRunner
+    {
+    public:
+		//! Calls job(data, i) for every i in [0, count) and returns once all of them have returned.
+		virtual void Run(size_t count, void (*job)(void * data, size_t i), void * data) = 0;
+		virtual ~IJobRunner() {}
+    };
+
 	//! Provides an implementation of the Hierarchical Approximate Convex Decomposition (HACD) technique described in "A Simple and Efficient Approach for 3D Mesh Approximate Convex Decomposition" Game Programming Gems 8 - Chapter 2.8, p.202. A short version of the chapter was published in ICIP09 and is available at ftp://ftp.elet.polimi.it/users/Stefano.Tubaro/ICIP_USB_Proceedings_v2/pdfs/0003501.pdf
     class HACD
 	{            
@@ -114,6 +123,12 @@ namespace HACD
 		//! Gives the call-back function
 		//! @return pointer to the call-back function
 		const CallBackFunction                      GetCallBack() const { return m_callBack;}
+		//! Sets the job runner used to compute the clusters costs concurrently (ignored when a heap manager is used)
+		//! @param jobRunner pointer to the job runner, 0 = compute them on the calling thread
+		void										SetJobRunner(IJobRunner * jobRunner) { m_jobRunner = jobRunner;}
+		//! Gives the job runner
+		//! @return pointer to the job runner
+		IJobRunner *								GetJobRunner() const { return m_jobRunner;}
         
         //! Specifies whether faces points should be added when computing the concavity
 		//! @param addFacesPoints true = faces points should be added
@@ -262,6 +277,14 @@ namespace HACD
 		//! Computes the cost of an edge
 		//! @param e edge's id
         void                                        ComputeEdgeCost(size_t e);
+		//! Orders the edge's vertices so that m_v1 is the cluster with the most ancestors
+		//! @param e edge's id
+        void                                        OrientEdge(size_t e);
+		//! Computes the costs of several edges, using the job runner if any
+		//! @param edges edges' ids
+        void                                        ComputeEdgeCosts(const std::vector<long> & edges);
+		//! Job run by ComputeEdgeCosts()
+        static void                                 ComputeEdgeCostsJob(void * data, size_t i);
 		//! Initializes the priority queue
 		//! @param fast specifies whether fast mode is used
 		//! @return true if success
@@ -311,6 +334,7 @@ namespace HACD
 			std::greater<std::vector<GraphEdgePriorityQueue>::value_type> > m_pqueue;		//!> priority queue
 													HACD(const HACD & rhs);
 		CallBackFunction							m_callBack;					//>! call-back function
+		IJobRunner *								m_jobRunner;				//>! job runner used to compute the edges costs
 		long *										m_partition;				//>! array of size m_nTriangles where the i-th element specifies the cluster to which belong the i-th triangle
 		size_t										m_targetNTrianglesDecimatedMesh; //>! specifies the target number of triangles in the decimated mesh. If set to 0 no decimation is applied.
         HeapManager *                               m_heapManager;              //>! Heap Manager
@@ -19,6 +19,8 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
  */
 
+#include <stddef.h>
+
 #ifndef ND_HASCONVEXDECOMP_TRACER
  #define ND_HASCONVEXDECOMP_TRACER
 #endif
@@ -54,5 +56,23 @@ public:
 	virtual void setTracer( ndConvexDecompositionTracer *) = 0;
 };
 
+class ndConvexDecompositionJobRunner
+{
+public:
+	virtual ~ndConvexDecompositionJobRunner()
+	{ }
+
+	// Calls aJob( aData, i ) for every i in [0, aCount), possibly concurrently, and returns once all of them have returned.
+	virtual void run( size_t aCount, void (*aJob)( void *, size_t ), void *aData ) = 0;
+};
+
+// Implemented by decompositions whose bindDecomposition() is per thread, so that several threads can each work on their own
+// decomposition at once. The job runner, if any, is used to split the work of one decomposition; it must outlive its use.
+class ndConvexDecompositionParallel
+{
+public:
+	virtual void setJobRunner( ndConvexDecompositionJobRunner * ) = 0;
+};
+
 
 #endif
@@ -34,6 +34,8 @@ LLCDParam::LLCDEnumItem nd_hacdConvexDecomposition::mMethods[1];
 LLCDParam::LLCDEnumItem nd_hacdConvexDecomposition::mQuality[1];
 LLCDParam::LLCDEnumItem nd_hacdConvexDecomposition::mSimplify[1];
 
+ND_THREAD_LOCAL int nd_hacdConvexDecomposition::sCurrentDecoder = 0;
+
 LLConvexDecomposition* nd_hacdConvexDecomposition::getInstance()
 {
 	static nd_hacdConvexDecomposition sImpl;
@@ -43,7 +45,7 @@ LLConvexDecomposition* nd_hacdConvexDecomposition::getInstance()
 nd_hacdConvexDecomposition::nd_hacdConvexDecomposition()
 {
 	mNextId = 0;
-	mCurrentDecoder = 0;
+	memset( &mCallbacks[0], 0, sizeof( mCallbacks ) );
 	mSingleHullMeshFromMesh = new HACDDecoder();
 	mTracer = 0;
 }
@@ -118,6 +120,8 @@ LLCDResult nd_hacdConvexDecomposition::quitSystem()
 void nd_hacdConvexDecomposition::genDecomposition( int& decomp )
 {
 	HACDDecoder *pGen = new HACDDecoder();
+
+	std::lock_guard< std::mutex > oLock( mDecodersMutex );
 	decomp = mNextId;
 	++mNextId;
 
@@ -126,14 +130,31 @@ void nd_hacdConvexDecomposition::genDecomposition( int& decomp )
 
 void nd_hacdConvexDecomposition::deleteDecomposition( int decomp )
 {
-	delete mDecoders[ decomp ];
-	mDecoders.erase( decomp );
+	HACDDecoder *pC = 0;
+	{
+		std::lock_guard< std::mutex > oLock( mDecodersMutex );
+		std::map< int, HACDDecoder * >::iterator itr = mDecoders.find( decomp );
+		if( mDecoders.end() == itr )
+			return;
+		pC = itr->second;
+		mDecoders.erase( itr );
+	}
+	delete pC;
 }
 
 void nd_hacdConvexDecomposition::bindDecomposition( int decomp )
 {
 	TRACE_FUNC( mTracer );
-	mCurrentDecoder = decomp;
+	sCurrentDecoder = decomp;
+}
+
+HACDDecoder *nd_hacdConvexDecomposition::getCurrentDecoder()
+{
+	std::lock_guard< std::mutex > oLock( mDecodersMutex );
+	std::map< int, HACDDecoder * >::iterator itr = mDecoders.find( sCurrentDecoder );
+	if( mDecoders.end() == itr )
+		return 0;
+	return itr->second;
 }
 
 LLCDResult nd_hacdConvexDecomposition::setParam( const char* name, float val )
@@ -159,18 +180,21 @@ LLCDResult nd_hacdConvexDecomposition::setMeshData( const LLCDMeshData* data, bo
 	TRACE_FUNC( mTracer );
 	ndStructTracer::trace( data, vertex_based, mTracer );
 
-	HACDDecoder *pC = mDecoders[ mCurrentDecoder ];
+	HACDDecoder *pC = getCurrentDecoder();
+	if ( !pC )
+		return LLCD_STAGE_NOT_READY;
+
 	return ::setMeshData( data, vertex_based, pC );
 }
 
+// The callback applies to every decomposition, as they may be bound on other threads than the registering one.
 LLCDResult nd_hacdConvexDecomposition::registerCallback( int stage, llcdCallbackFunc callback )
 {
 	TRACE_FUNC( mTracer );
-	if( mDecoders.end() == mDecoders.find( mCurrentDecoder ) )
-		return LLCD_STAGE_NOT_READY;
+	if ( stage < 0 || stage >= NUM_STAGES )
+		return LLCD_INVALID_STAGE;
 
-	HACDDecoder *pC = mDecoders[ mCurrentDecoder ];
-	pC->mCallback = callback;
+	mCallbacks[ stage ] = callback;
 
 	return LLCD_OK;
 }
@@ -187,8 +211,12 @@ LLCDResult nd_hacdConvexDecomposition::executeStage( int stage )
 	if ( stage < 0 || stage >= NUM_STAGES )
 		return LLCD_INVALID_STAGE;
 
-	HACDDecoder *pC = mDecoders[ mCurrentDecoder ];
-	tHACD *pHACD = init( 1, MIN_NUMBER_OF_CLUSTERS, MAX_VERTICES_PER_HULL, CONNECT_DISTS[0], pC );
+	HACDDecoder *pC = getCurrentDecoder();
+	if ( !pC )
+		return LLCD_STAGE_NOT_READY;
+
+	pC->mCallback = mCallbacks[ stage ];
+	tHACD *pHACD = init( 1, MIN_NUMBER_OF_CLUSTERS, MAX_VERTICES_PER_HULL, CONNECT_DISTS[0], pC, &mJobRunner );
 
 	DecompData oRes = decompose( pHACD );
 	ndStructTracer::trace( oRes, mTracer );
@@ -203,7 +231,7 @@ LLCDResult nd_hacdConvexDecomposition::executeStage( int stage )
 int nd_hacdConvexDecomposition::getNumHullsFromStage( int stage )
 {
 	TRACE_FUNC( mTracer );
-	HACDDecoder *pC = mDecoders[ mCurrentDecoder ];
+	HACDDecoder *pC = getCurrentDecoder();
 
 	if ( !pC )
 		return 0;
@@ -214,14 +242,14 @@ int nd_hacdConvexDecomposition::getNumHullsFromStage( int stage )
 	return pC->mStages[stage].mHulls.size();
 }
 
-DecompData toSingleHull( HACDDecoder *aDecoder, LLCDResult &aRes, ndConvexDecompositionTracer *aTracer )
+DecompData toSingleHull( HACDDecoder *aDecoder, LLCDResult &aRes, ndConvexDecompositionTracer *aTracer, HACD::IJobRunner *aJobRunner )
 {
 	TRACE_FUNC( aTracer );
 	aRes = LLCD_REQUEST_OUT_OF_RANGE;
 
 	for ( int i = 0; i < TO_SINGLE_HULL_TRIES; ++i )
 	{
-		tHACD *pHACD = init( CONCAVITY_FOR_SINGLE_HULL[i], 1, MAX_VERTICES_PER_HULL, CONNECT_DISTS[i], aDecoder );
+		tHACD *pHACD = init( CONCAVITY_FOR_SINGLE_HULL[i], 1, MAX_VERTICES_PER_HULL, CONNECT_DISTS[i], aDecoder, aJobRunner );
 
 		DecompData oRes = decompose( pHACD );
 		delete pHACD;
@@ -241,14 +269,17 @@ DecompData toSingleHull( HACDDecoder *aDecoder, LLCDResult &aRes, ndConvexDecomp
 LLCDResult nd_hacdConvexDecomposition::getSingleHull( LLCDHull* hullOut )
 {
 	TRACE_FUNC( mTracer );
-	HACDDecoder *pC = mDecoders[ mCurrentDecoder ];
+	HACDDecoder *pC = getCurrentDecoder();
 
 	memset( hullOut, 0, sizeof( LLCDHull ) );
 
+	if ( !pC )
+		return LLCD_STAGE_NOT_READY;
+
 	LLCDResult res;
 
 	// Will already trace oRes
-	DecompData oRes = ::toSingleHull( pC, res, mTracer );
+	DecompData oRes = ::toSingleHull( pC, res, mTracer, &mJobRunner );
 
 	if ( LLCD_OK != res || oRes.mHulls.size() != 1 )
 		return res;
@@ -262,10 +293,13 @@ LLCDResult nd_hacdConvexDecomposition::getSingleHull( LLCDHull* hullOut )
 LLCDResult nd_hacdConvexDecomposition::getHullFromStage( int stage, int hull, LLCDHull* hullOut )
 {
 	TRACE_FUNC( mTracer );
-	HACDDecoder *pC = mDecoders[ mCurrentDecoder ];
+	HACDDecoder *pC = getCurrentDecoder();
 
 	memset( hullOut, 0, sizeof( LLCDHull ) );
 
+	if ( !pC )
+		return LLCD_STAGE_NOT_READY;
+
 	if ( stage < 0 || static_cast<size_t>(stage) >= pC->mStages.size() )
 		return LLCD_INVALID_STAGE;
 
@@ -283,10 +317,13 @@ LLCDResult nd_hacdConvexDecomposition::getHullFromStage( int stage, int hull, LL
 LLCDResult nd_hacdConvexDecomposition::getMeshFromStage( int stage, int hull, LLCDMeshData* meshDataOut )
 {
 	TRACE_FUNC( mTracer );
-	HACDDecoder *pC = mDecoders[ mCurrentDecoder ];
+	HACDDecoder *pC = getCurrentDecoder();
 
 	memset( meshDataOut, 0, sizeof( LLCDHull ) );
 
+	if ( !pC )
+		return LLCD_STAGE_NOT_READY;
+
 	if ( stage < 0 || static_cast<size_t>(stage) >= pC->mStages.size() )
 		return LLCD_INVALID_STAGE;
 
@@ -341,7 +378,7 @@ LLCDResult nd_hacdConvexDecomposition::generateSingleHullMeshFromMesh( LLCDMeshD
 		return res;
 
 	// Will already trace oRes
-	DecompData oRes = ::toSingleHull( mSingleHullMeshFromMesh, res, mTracer );
+	DecompData oRes = ::toSingleHull( mSingleHullMeshFromMesh, res, mTracer, &mJobRunner );
 
 	if ( LLCD_OK != res || oRes.mHulls.size() != 1 )
 		return res;
@@ -386,6 +423,10 @@ void nd_hacdConvexDecomposition::setTracer( ndConvexDecompositionTracer * aTrace
 		mTracer->addref();
 }
 
+void nd_hacdConvexDecomposition::setJobRunner( ndConvexDecompositionJobRunner *aRunner )
+{
+	mJobRunner.mRunner = aRunner;
+}
 
 bool nd_hacdConvexDecomposition::isFunctional()
 {
@@ -20,17 +20,23 @@
 #define ND_HACD_CONVEXDECOMP_H
 
 #include "llconvexdecomposition.h"
+#include "nd_hacdStructs.h"
 
 #include <map>
+#include <mutex>
 #include <vector>
 
-struct HACDDecoder;
-
-class nd_hacdConvexDecomposition : public LLConvexDecomposition, public ndConvexDecompositionTracable
+// Decompositions are bound per thread, so any number of threads can decompose at once as long as each works on its
+// own decomposition. The mesh and hull conversions that keep their results in this object (getMeshFromHull,
+// generateSingleHullMeshFromMesh) remain for one thread only.
+class nd_hacdConvexDecomposition : public LLConvexDecomposition, public ndConvexDecompositionTracable, public ndConvexDecompositionParallel
 {
 	int mNextId;
-	int mCurrentDecoder;
+	static ND_THREAD_LOCAL int sCurrentDecoder;
 	std::map< int, HACDDecoder * > mDecoders;
+	std::mutex mDecodersMutex; // guards mNextId and mDecoders
+	llcdCallbackFunc mCallbacks[ NUM_STAGES ];
+	HACDJobRunner mJobRunner;
 	HACDDecoder *mSingleHullMeshFromMesh;
 
 	std::vector< float > mMeshToHullVertices;
@@ -93,11 +99,14 @@ public:
 	void loadMeshData( const char* fileIn, LLCDMeshData** meshDataOut );
 
 	virtual void setTracer( ndConvexDecompositionTracer *);
+	virtual void setJobRunner( ndConvexDecompositionJobRunner * );
 
 	virtual bool isFunctional();
 
 private:
 	nd_hacdConvexDecomposition();
+
+	HACDDecoder *getCurrentDecoder();
 };
 
 #endif
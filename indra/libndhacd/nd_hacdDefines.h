@@ -23,6 +23,12 @@
 
 #define NUM_STAGES 1
 
+#ifdef _MSC_VER
+ #define ND_THREAD_LOCAL __declspec(thread)
+#else
+ #define ND_THREAD_LOCAL __thread
+#endif
+
 typedef unsigned short hacdUINT16;
 typedef unsigned int hacdUINT32;
 
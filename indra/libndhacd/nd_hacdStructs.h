@@ -52,6 +52,26 @@ struct DecompData
 	void clear();
 };
 
+struct HACDJobRunner: public HACD::IJobRunner
+{
+	ndConvexDecompositionJobRunner *mRunner;
+
+	HACDJobRunner()
+		: mRunner( 0 )
+	{ }
+
+	virtual void Run( size_t aCount, void (*aJob)( void *, size_t ), void *aData )
+	{
+		if( mRunner )
+			mRunner->run( aCount, aJob, aData );
+		else
+		{
+			for( size_t i = 0; i < aCount; ++i )
+				(*aJob)( aData, i );
+		}
+	}
+};
+
 struct HACDDecoder: public HACD::ICallback
 {
 	std::vector< tVecDbl > mVertices;
@@ -18,7 +18,7 @@
 
 #include "nd_hacdUtils.h"
 
-tHACD* init( int nConcavity, int nClusters, int nMaxVerticesPerHull, double dMaxConnectDist, HACDDecoder *aData )
+tHACD* init( int nConcavity, int nClusters, int nMaxVerticesPerHull, double dMaxConnectDist, HACDDecoder *aData, HACD::IJobRunner *aJobRunner )
 {
 	tHACD *pDec = HACD::CreateHACD(0);
 	pDec->SetPoints( &aData->mVertices[0] );
@@ -40,6 +40,7 @@ tHACD* init( int nConcavity, int nClusters, int nMaxVerticesPerHull, double dMax
 	pDec->SetConnectDist( dMaxConnectDist );
 
 	pDec->SetCallBack( aData );
+	pDec->SetJobRunner( aJobRunner );
 
 	return pDec;
 }
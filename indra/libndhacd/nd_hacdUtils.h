@@ -21,7 +21,7 @@
 
 #include "nd_hacdStructs.h"
 
-tHACD* init( int nConcavity, int nClusters, int nMaxVerticesPerHull, double dMaxConnectDist, HACDDecoder *aData );
+tHACD* init( int nConcavity, int nClusters, int nMaxVerticesPerHull, double dMaxConnectDist, HACDDecoder *aData, HACD::IJobRunner *aJobRunner = 0 );
 DecompData decompose( tHACD *aHACD );
 
 tVecLong fromI16( void *& pPtr, int aStride );
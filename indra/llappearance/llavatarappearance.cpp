@@ -1399,6 +1399,33 @@ void LLAvatarAppearance::addMaskedMorph(EBakedTextureIndex index, LLVisualParam*
 	}
 }
 
+// A masked morph only changes the mesh while it has weight, and its mask only
+// comes from a layer something is worn on.
+BOOL LLAvatarAppearance::hasActiveMorphMask(EBakedTextureIndex index) const
+{
+	if (index >= BAKED_NUM_INDICES || !mBakedTextureDatas[index].mTexLayerSet)
+	{
+		return FALSE;
+	}
+	LLTexLayerSet* layer_set = mBakedTextureDatas[index].mTexLayerSet;
+	for (morph_list_t::const_iterator iter = mBakedTextureDatas[index].mMaskedMorphs.begin();
+		 iter != mBakedTextureDatas[index].mMaskedMorphs.end(); ++iter)
+	{
+		const LLMaskedMorph* morph = *iter;
+		if (!morph->mMorphTarget || is_approx_zero(morph->mMorphTarget->getWeight()))
+		{
+			continue;
+		}
+		const LLTexLayerInterface* layer = layer_set->findLayerByName(morph->mLayer);
+		if (!layer || !isWearingWearableType(layer->getWearableType()))
+		{
+			continue;
+		}
+		return TRUE;
+	}
+	return FALSE;
+}
+
 
 //static
 BOOL LLAvatarAppearance::teToColorParams( ETextureIndex te, U32 *param_name )
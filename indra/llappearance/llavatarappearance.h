@@ -226,6 +226,7 @@ public:
 	//--------------------------------------------------------------------
 public:
 	void 	addMaskedMorph(LLAvatarAppearanceDefines::EBakedTextureIndex index, LLVisualParam* morph_target, BOOL invert, std::string layer);
+	BOOL	hasActiveMorphMask(LLAvatarAppearanceDefines::EBakedTextureIndex index) const;
 	virtual void	applyMorphMask(U8* tex_data, S32 width, S32 height, S32 num_components, LLAvatarAppearanceDefines::EBakedTextureIndex index = LLAvatarAppearanceDefines::BAKED_NUM_INDICES) = 0;
 
 /**                    Rendering
@@ -36,6 +36,7 @@
 #include "lldir.h"
 #include "llvfile.h"
 #include "llvfs.h"
+#include "lltexlayercompositor.h"
 #include "lltexlayerparams.h"
 #include "lltexturemanagerbridge.h"
 #include "lllocaltextureobject.h"
@@ -613,6 +614,67 @@ void LLTexLayerSet::renderAlphaMaskTextures(S32 x, S32 y, S32 width, S32 height,
 	gGL.setSceneBlendType(LLRender::BT_ALPHA);
 }
 
+LLTexLayerBake* LLTexLayerSet::createBake(S32 width, S32 height)
+{
+	BOOL visible = TRUE;
+	for (layer_list_t::iterator iter = mMaskLayerList.begin(); iter != mMaskLayerList.end(); iter++)
+	{
+		if ((*iter)->isInvisibleAlphaMask())
+		{
+			visible = FALSE;
+		}
+	}
+
+	LLTexLayerBake* bake = new LLTexLayerBake(getBodyRegionName(), width, height);
+	bake->fill(LLColor4(0.f, 0.f, 0.f, 1.f), LLTexLayerBake::BLEND_REPLACE, LLTexLayerBake::WRITE_ALL);
+	if (visible)
+	{
+		BOOL success = TRUE;
+		for (layer_list_t::iterator iter = mLayerList.begin(); iter != mLayerList.end(); iter++)
+		{
+			LLTexLayerInterface* layer = *iter;
+			if (layer->getRenderPass() == LLTexLayer::RP_COLOR)
+			{
+				success &= layer->addToBake(bake);
+			}
+		}
+		addAlphaMasksToBake(bake);
+		if (!success)
+		{
+			bake->setPartial();
+		}
+	}
+	else
+	{
+		bake->fill(LLColor4(0.f, 0.f, 0.f, 0.f), LLTexLayerBake::BLEND_REPLACE, LLTexLayerBake::WRITE_ALL);
+	}
+	return bake;
+}
+
+// Software counterpart of renderAlphaMaskTextures().
+void LLTexLayerSet::addAlphaMasksToBake(LLTexLayerBake* bake)
+{
+	const LLTexLayerSetInfo *info = getInfo();
+
+	if (!info->mStaticAlphaFileName.empty())
+	{
+		// Drawn with the texture replacing the color, under the alpha test.
+		LLImageRaw* raw = LLTexLayerStaticImageList::getInstance()->getImageRaw(info->mStaticAlphaFileName, TRUE);
+		bake->drawImage(raw, LLColor4::white, LLTexLayerBake::BLEND_REPLACE, LLTexLayerBake::WRITE_ALPHA,
+						LLTexLayerBake::MIN_ALPHA);
+	}
+	else if (info->mClearAlpha || (mMaskLayerList.size() > 0))
+	{
+		bake->fill(LLColor4(0.f, 0.f, 0.f, 1.f), LLTexLayerBake::BLEND_REPLACE, LLTexLayerBake::WRITE_ALPHA);
+	}
+
+	for (layer_list_t::iterator iter = mMaskLayerList.begin(); iter != mMaskLayerList.end(); iter++)
+	{
+		LLTexLayerInterface* layer = *iter;
+		layer->addAlphaToBake(bake);
+	}
+}
+
 void LLTexLayerSet::applyMorphMask(U8* tex_data, S32 width, S32 height, S32 num_components)
 {
 	mAvatarAppearance->applyMorphMask(tex_data, width, height, num_components, mBakedTexIndex);
@@ -631,6 +693,11 @@ BOOL LLTexLayerSet::isMorphValid() const
 	return TRUE;
 }
 
+BOOL LLTexLayerSet::hasActiveMorph() const
+{
+	return mAvatarAppearance->hasActiveMorphMask(mBakedTexIndex);
+}
+
 void LLTexLayerSet::invalidateMorphMasks()
 {
 	for( layer_list_t::iterator iter = mLayerList.begin(); iter != mLayerList.end(); iter++ )
@@ -1310,6 +1377,74 @@ BOOL LLTexLayer::render(S32 x, S32 y, S32 width, S32 height)
 	return success;
 }
 
+// Software counterpart of render().
+BOOL LLTexLayer::addToBake(LLTexLayerBake* bake)
+{
+	LLColor4 net_color;
+	BOOL color_specified = findNetColor(&net_color);
+
+	if (mTexLayerSet->getAvatarAppearance()->mIsDummy)
+	{
+		color_specified = true;
+		net_color = LLAvatarAppearance::getDummyColor();
+	}
+
+	BOOL success = TRUE;
+
+	if( is_approx_zero( net_color.mV[VW] ) )
+	{
+		return success;
+	}
+
+	LLTexLayerBake::EBlend blend = LLTexLayerBake::BLEND_ALPHA;
+	if (!mParamAlphaList.empty())
+	{
+		success &= addMorphMasksToBake(bake, net_color);
+		blend = LLTexLayerBake::BLEND_DEST_ALPHA;
+	}
+	if (getInfo()->mWriteAllChannels)
+	{
+		blend = LLTexLayerBake::BLEND_REPLACE;
+	}
+
+	if( (getInfo()->mLocalTexture != -1) && !getInfo()->mUseLocalTextureAlphaOnly )
+	{
+		LLGLTexture* tex = NULL;
+		if (mLocalTextureObject && mLocalTextureObject->getID() != IMG_DEFAULT_AVATAR)
+		{
+			tex = mLocalTextureObject->getImage();
+		}
+		if (tex)
+		{
+			bake->drawImage(mTexLayerSet->getBakeSourceImage(tex), net_color, blend, LLTexLayerBake::WRITE_ALL,
+							getInfo()->mWriteAllChannels ? 0.f : LLTexLayerBake::MIN_ALPHA);
+		}
+	}
+
+	if( !getInfo()->mStaticImageFileName.empty() )
+	{
+		LLImageRaw* raw = LLTexLayerStaticImageList::getInstance()->getImageRaw(getInfo()->mStaticImageFileName, getInfo()->mStaticImageIsMask);
+		if (raw)
+		{
+			bake->drawImage(raw, net_color, blend, LLTexLayerBake::WRITE_ALL, LLTexLayerBake::MIN_ALPHA);
+		}
+		else
+		{
+			success = FALSE;
+		}
+	}
+
+	if(((-1 == getInfo()->mLocalTexture) ||
+		 getInfo()->mUseLocalTextureAlphaOnly) &&
+		getInfo()->mStaticImageFileName.empty() &&
+		color_specified )
+	{
+		bake->fill(net_color, blend, LLTexLayerBake::WRITE_ALL);
+	}
+
+	return success;
+}
+
 const U8*	LLTexLayer::getAlphaData() const
 {
 	LLCRC alpha_mask_crc;
@@ -1432,6 +1567,34 @@ BOOL LLTexLayer::blendAlphaTexture(S32 x, S32 y, S32 width, S32 height)
 	return success;
 }
 
+// Software counterpart of blendAlphaTexture().
+BOOL LLTexLayer::addAlphaToBake(LLTexLayerBake* bake)
+{
+	BOOL success = TRUE;
+
+	LLImageRaw* raw = NULL;
+	if( !getInfo()->mStaticImageFileName.empty() )
+	{
+		raw = LLTexLayerStaticImageList::getInstance()->getImageRaw( getInfo()->mStaticImageFileName, getInfo()->mStaticImageIsMask );
+		success = raw != NULL;
+	}
+	else if (getInfo()->mLocalTexture >=0 && getInfo()->mLocalTexture < TEX_NUM_INDICES
+			 && mLocalTextureObject && mLocalTextureObject->getImage())
+	{
+		raw = mTexLayerSet->getBakeSourceImage(mLocalTextureObject->getImage());
+		if (!raw)
+		{
+			bake->setPartial();
+		}
+	}
+	if (raw)
+	{
+		bake->drawImage(raw, LLColor4::white, LLTexLayerBake::BLEND_MULT_ALPHA, LLTexLayerBake::WRITE_ALPHA);
+	}
+
+	return success;
+}
+
 /*virtual*/ void LLTexLayer::gatherAlphaMasks(U8 *data, S32 originX, S32 originY, S32 width, S32 height)
 {
 	addAlphaMask(data, originX, originY, width, height);
@@ -1595,6 +1758,60 @@ void LLTexLayer::renderMorphMasks(S32 x, S32 y, S32 width, S32 height, const LLC
 	}
 }
 
+// Software counterpart of renderMorphMasks(), without the readback: morph masks
+// are applied to the avatar mesh by GL bakes only.
+BOOL LLTexLayer::addMorphMasksToBake(LLTexLayerBake* bake, const LLColor4 &layer_color)
+{
+	BOOL success = TRUE;
+
+	llassert( !mParamAlphaList.empty() );
+
+	LLTexLayerParamAlpha* first_param = *mParamAlphaList.begin();
+	// Note: if the first param is a mulitply, multiply against the current buffer's alpha
+	if( !first_param || !first_param->getMultiplyBlend() )
+	{
+		bake->fill(LLColor4(0.f, 0.f, 0.f, 0.f), LLTexLayerBake::BLEND_REPLACE, LLTexLayerBake::WRITE_ALPHA);
+	}
+
+	// Accumulate alphas
+	for (param_alpha_list_t::iterator iter = mParamAlphaList.begin(); iter != mParamAlphaList.end(); iter++)
+	{
+		LLTexLayerParamAlpha* param = *iter;
+		success &= param->addToBake(bake);
+	}
+
+	// Accumulate the alpha component of the texture
+	if( getInfo()->mLocalTexture != -1 && mLocalTextureObject && mLocalTextureObject->getImage() )
+	{
+		LLImageRaw* raw = mTexLayerSet->getBakeSourceImage(mLocalTextureObject->getImage());
+		if (!raw)
+		{
+			bake->setPartial();
+		}
+		else if (raw->getComponents() == 4)
+		{
+			bake->drawImage(raw, LLColor4::white, LLTexLayerBake::BLEND_MULT_ALPHA, LLTexLayerBake::WRITE_ALPHA);
+		}
+	}
+
+	if( !getInfo()->mStaticImageFileName.empty() && getInfo()->mStaticImageIsMask )
+	{
+		LLImageRaw* raw = LLTexLayerStaticImageList::getInstance()->getImageRaw(getInfo()->mStaticImageFileName, getInfo()->mStaticImageIsMask);
+		if( raw && ((raw->getComponents() == 4) || (raw->getComponents() == 1)) )
+		{
+			bake->drawImage(raw, LLColor4::white, LLTexLayerBake::BLEND_MULT_ALPHA, LLTexLayerBake::WRITE_ALPHA);
+		}
+	}
+
+	// Multiply the alpha by the layer color's alpha.
+	if ( !is_approx_equal(layer_color.mV[VW], 1.f) )
+	{
+		bake->fill(layer_color, LLTexLayerBake::BLEND_MULT_ALPHA, LLTexLayerBake::WRITE_ALPHA);
+	}
+
+	return success;
+}
+
 static LLTrace::BlockTimerStatHandle FTM_ADD_ALPHA_MASK("addAlphaMask");
 void LLTexLayer::addAlphaMask(U8 *data, S32 originX, S32 originY, S32 width, S32 height)
 {
@@ -1791,6 +2008,45 @@ LLTexLayer* LLTexLayerTemplate::getLayer(U32 i) const
 	return success;
 }
 
+/*virtual*/ BOOL LLTexLayerTemplate::addToBake(LLTexLayerBake* bake)
+{
+	if(!mInfo)
+	{
+		return FALSE;
+	}
+
+	BOOL success = TRUE;
+	U32 num_wearables = updateWearableCache();
+	for (U32 i = 0; i < num_wearables; i++)
+	{
+		LLTexLayer *layer = getLayer(i);
+		if (layer)
+		{
+			// As in render(): the layer's params and colors come from its wearable.
+			LLWearable* wearable = mWearableCache[i];
+			wearable->writeToAvatar(mAvatarAppearance);
+			layer->setLTO(wearable->getLocalTextureObject(mInfo->mLocalTexture));
+			success &= layer->addToBake(bake);
+		}
+	}
+	return success;
+}
+
+/*virtual*/ BOOL LLTexLayerTemplate::addAlphaToBake(LLTexLayerBake* bake)
+{
+	BOOL success = TRUE;
+	U32 num_wearables = updateWearableCache();
+	for (U32 i = 0; i < num_wearables; i++)
+	{
+		LLTexLayer *layer = getLayer(i);
+		if (layer)
+		{
+			success &= layer->addAlphaToBake(bake);
+		}
+	}
+	return success;
+}
+
 /*virtual*/ void LLTexLayerTemplate::gatherAlphaMasks(U8 *data, S32 originX, S32 originY, S32 width, S32 height)
 {
 	U32 num_wearables = updateWearableCache();
@@ -1899,6 +2155,7 @@ void LLTexLayerSet::cloneTemplates(LLLocalTextureObject *lto, LLAvatarAppearance
 LLTexLayerStaticImageList::LLTexLayerStaticImageList() :
 	mGLBytes(0),
 	mTGABytes(0),
+	mRawBytes(0),
 	mImageNames(16384)
 {
 }
@@ -1912,24 +2169,28 @@ void LLTexLayerStaticImageList::dumpByteCount() const
 {
 	LL_INFOS() << "Avatar Static Textures " <<
 		"KB GL:" << (mGLBytes / 1024) <<
-		"KB TGA:" << (mTGABytes / 1024) << "KB" << LL_ENDL;
+		"KB TGA:" << (mTGABytes / 1024) <<
+		"KB Raw:" << (mRawBytes / 1024) << "KB" << LL_ENDL;
 }
 
 void LLTexLayerStaticImageList::deleteCachedImages()
 {
-	if( mGLBytes || mTGABytes )
+	if( mGLBytes || mTGABytes || mRawBytes )
 	{
 		LL_INFOS() << "Clearing Static Textures " <<
 			"KB GL:" << (mGLBytes / 1024) <<
-			"KB TGA:" << (mTGABytes / 1024) << "KB" << LL_ENDL;
+			"KB TGA:" << (mTGABytes / 1024) <<
+			"KB Raw:" << (mRawBytes / 1024) << "KB" << LL_ENDL;
 
 		//mStaticImageLists uses LLPointers, clear() will cause deletion
 		
 		mStaticImageListTGA.clear();
 		mStaticImageList.clear();
+		mStaticImageListRaw.clear();
 		
 		mGLBytes = 0;
 		mTGABytes = 0;
+		mRawBytes = 0;
 	}
 }
 
@@ -2017,6 +2278,38 @@ LLGLTexture* LLTexLayerStaticImageList::getTexture(const std::string& file_name,
 	return tex;
 }
 
+// Returns the decoded data of a tga file named file_name, converted the way
+// getTexture() converts it for GL.  Caches the result; software bakes hold on to
+// it from other threads, so it is never changed once cached.
+static LLTrace::BlockTimerStatHandle FTM_LOAD_STATIC_RAW("getImageRaw");
+LLImageRaw* LLTexLayerStaticImageList::getImageRaw(const std::string& file_name, BOOL is_mask)
+{
+	LL_RECORD_BLOCK_TIME(FTM_LOAD_STATIC_RAW);
+	const char *namekey = mImageNames.addString(file_name);
+	image_raw_map_t::const_iterator iter = mStaticImageListRaw.find(namekey);
+	if( iter != mStaticImageListRaw.end() )
+	{
+		return iter->second;
+	}
+
+	LLPointer<LLImageRaw> image_raw = new LLImageRaw;
+	if( !loadImageRaw( file_name, image_raw ) )
+	{
+		return NULL;
+	}
+	if( (image_raw->getComponents() == 1) && is_mask )
+	{
+		LLPointer<LLImageRaw> alpha_image_raw = image_raw;
+		image_raw = new LLImageRaw(image_raw->getWidth(),
+								   image_raw->getHeight(),
+								   4);
+		image_raw->copyUnscaledAlphaMask(alpha_image_raw, LLColor4U::black);
+	}
+	mStaticImageListRaw[ namekey ] = image_raw;
+	mRawBytes += image_raw->getDataSize();
+	return image_raw;
+}
+
 // Reads a .tga file, decodes it, and puts the decoded data in image_raw.
 // Returns TRUE if successful.
 static LLTrace::BlockTimerStatHandle FTM_LOAD_IMAGE_RAW("loadImageRaw");
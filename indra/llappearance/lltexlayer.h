@@ -42,6 +42,7 @@ class LLTexLayerSet;
 class LLTexLayerSetInfo;
 class LLTexLayerInfo;
 class LLTexLayerSetBuffer;
+class LLTexLayerBake;
 class LLWearable;
 class LLViewerVisualParam;
 
@@ -69,6 +70,9 @@ public:
 	virtual void			deleteCaches() = 0;
 	virtual BOOL			blendAlphaTexture(S32 x, S32 y, S32 width, S32 height) = 0;
 	virtual BOOL			isInvisibleAlphaMask() const = 0;
+	// Software counterparts of render() and blendAlphaTexture(), see LLTexLayerSet::createBake().
+	virtual BOOL			addToBake(LLTexLayerBake* bake) = 0;
+	virtual BOOL			addAlphaToBake(LLTexLayerBake* bake) = 0;
 
 	const LLTexLayerInfo* 	getInfo() const 			{ return mInfo; }
 	virtual BOOL			setInfo(const LLTexLayerInfo *info, LLWearable* wearable); // sets mInfo, calls initialization functions
@@ -128,6 +132,8 @@ public:
 	/*virtual*/ void		setHasMorph(BOOL newval);
 	/*virtual*/ void		deleteCaches();
 	/*virtual*/ BOOL		isInvisibleAlphaMask() const;
+	/*virtual*/ BOOL		addToBake(LLTexLayerBake* bake);
+	/*virtual*/ BOOL		addAlphaToBake(LLTexLayerBake* bake);
 protected:
 	U32 					updateWearableCache() const;
 	LLTexLayer* 			getLayer(U32 i) const;
@@ -163,6 +169,9 @@ public:
 	void					renderMorphMasks(S32 x, S32 y, S32 width, S32 height, const LLColor4 &layer_color, bool force_render);
 	void					addAlphaMask(U8 *data, S32 originX, S32 originY, S32 width, S32 height);
 	/*virtual*/ BOOL		isInvisibleAlphaMask() const;
+	/*virtual*/ BOOL		addToBake(LLTexLayerBake* bake);
+	/*virtual*/ BOOL		addAlphaToBake(LLTexLayerBake* bake);
+	BOOL					addMorphMasksToBake(LLTexLayerBake* bake, const LLColor4 &layer_color);
 
 	void					setLTO(LLLocalTextureObject *lto) 	{ mLocalTextureObject = lto; }
 	LLLocalTextureObject* 	getLTO() 							{ return mLocalTextureObject; }
@@ -202,9 +211,17 @@ public:
 	BOOL						render(S32 x, S32 y, S32 width, S32 height);
 	void						renderAlphaMaskTextures(S32 x, S32 y, S32 width, S32 height, bool forceClear = false);
 
+	// Flattens render() into a bake for LLTexLayerCompositor, which composites it
+	// without GL on any thread.  Morph masks are left alone.  Main thread.
+	LLTexLayerBake*				createBake(S32 width, S32 height);
+	void						addAlphaMasksToBake(LLTexLayerBake* bake);
+	// Decoded pixels of a local texture for createBake(); NULL when they aren't in memory.
+	virtual LLImageRaw*			getBakeSourceImage(LLGLTexture* tex)	{ return NULL; }
+
 	BOOL						isBodyRegion(const std::string& region) const;
 	void						applyMorphMask(U8* tex_data, S32 width, S32 height, S32 num_components);
 	BOOL						isMorphValid() const;
+	BOOL						hasActiveMorph() const;		// A morph mask shapes the mesh, which createBake() can't apply
 	virtual void				requestUpdate() = 0;
 	void						invalidateMorphMasks();
 	void						deleteCaches();
@@ -298,6 +315,8 @@ public:
 	~LLTexLayerStaticImageList();
 	LLGLTexture*		getTexture(const std::string& file_name, BOOL is_mask);
 	LLImageTGA*			getImageTGA(const std::string& file_name);
+	// Decoded pixels of what getTexture() would load, for software bakes.
+	LLImageRaw*			getImageRaw(const std::string& file_name, BOOL is_mask);
 	void				deleteCachedImages();
 	void				dumpByteCount() const;
 protected:
@@ -308,8 +327,11 @@ private:
 	texture_map_t 		mStaticImageList;
 	typedef std::map<const char*, LLPointer<LLImageTGA> > image_tga_map_t;
 	image_tga_map_t 	mStaticImageListTGA;
+	typedef std::map<const char*, LLPointer<LLImageRaw> > image_raw_map_t;
+	image_raw_map_t 	mStaticImageListRaw;
 	S32 				mGLBytes;
 	S32 				mTGABytes;
+	S32 				mRawBytes;
 };
 
 #endif  // LL_LLTEXLAYER_H
@@ -0,0 +1,605 @@
+/**
+ * @file lltexlayercompositor.cpp
+ * @brief Software compositing of avatar texture layer sets
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+
+#include "linden_common.h"
+
+#include "lltexlayercompositor.h"
+
+#include "llfasttimer.h"
+#include "llimage.h"
+#include "llimagetga.h"
+#include "llmemory.h"
+#include "lltimer.h"
+#include "llvector4a.h"
+#include "llworkerpool.h"
+
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+
+static LLTrace::BlockTimerStatHandle FTM_COMPOSITE_BAKES("Composite Bakes");
+
+// Rows per job.  Big enough to amortize the row buffers, small enough to keep
+// every thread busy on a single 512x512 region.
+static const S32 ROWS_PER_BAND = 32;
+
+static const F32 INV_255 = 1.f / 255.f;
+
+// compositeAsync() runs a handful of whole bakes per appearance change; two
+// threads finish them well within a frame or two without crowding the pool
+// that texture and mesh work share.
+static const U32 MAX_ASYNC_THREADS = 2;
+
+// static
+LLWorkerPool* LLTexLayerCompositor::sAsyncPool = NULL;
+
+// static
+const F32 LLTexLayerBake::MIN_ALPHA = 0.004f;
+bool LLTexLayerBake::sUseSIMD = true;
+
+LLTexLayerBake::Op::Op()
+:	mBlend(BLEND_ALPHA),
+	mWriteMask(WRITE_ALL),
+	mMinAlpha(0.f),
+	mAlphaOnly(false),
+	mDomain(0.f),
+	mWeight(0.f)
+{
+	mColor[0] = mColor[1] = mColor[2] = mColor[3] = 1.f;
+}
+
+LLTexLayerBake::LLTexLayerBake(const std::string& name, S32 width, S32 height)
+:	mName(name),
+	mWidth(width),
+	mHeight(height),
+	mPartial(false),
+	mComposited(0),
+	mCompositeTime(0.f)
+{
+}
+
+void LLTexLayerBake::fill(const LLColor4& color, EBlend blend, U32 write_mask, F32 min_alpha)
+{
+	mOps.push_back(Op());
+	Op& op = mOps.back();
+	op.mBlend = blend;
+	op.mWriteMask = write_mask;
+	op.mMinAlpha = min_alpha;
+	for (S32 i = 0; i < 4; ++i)
+	{
+		op.mColor[i] = color.mV[i];
+	}
+}
+
+void LLTexLayerBake::drawImage(LLImageRaw* image, const LLColor4& color, EBlend blend, U32 write_mask, F32 min_alpha)
+{
+	if (!image || !image->getData() || image->getWidth() == 0 || image->getHeight() == 0)
+	{
+		setPartial();
+		return;
+	}
+	fill(color, blend, write_mask, min_alpha);
+	mOps.back().mImage = image;
+}
+
+void LLTexLayerBake::drawGradient(LLImageTGA* image, F32 domain, F32 weight, EBlend blend)
+{
+	if (!image)
+	{
+		setPartial();
+		return;
+	}
+	fill(LLColor4::white, blend, WRITE_ALPHA);
+	Op& op = mOps.back();
+	op.mGradient = image;
+	op.mDomain = domain;
+	op.mWeight = weight;
+}
+
+void LLTexLayerBake::prepare()
+{
+	for (op_list_t::iterator iter = mOps.begin(); iter != mOps.end(); ++iter)
+	{
+		Op& op = *iter;
+		if (op.mGradient.notNull())
+		{
+			LLPointer<LLImageRaw> raw = new LLImageRaw;
+			if (op.mGradient->decodeAndProcess(raw, op.mDomain, op.mWeight))
+			{
+				op.mImage = raw;
+				op.mAlphaOnly = true;
+			}
+			else
+			{
+				// Leave the draw out, as the GL bake does when it can't load one.
+				op.mImage = NULL;
+				op.mBlend = BLEND_ADD;
+				op.mColor[3] = 0.f;
+				mPartial = true;
+			}
+		}
+		if (op.mImage.isNull())
+		{
+			continue;
+		}
+
+		const S32 image_width = op.mImage->getWidth();
+		op.mColumns.resize(mWidth);
+		op.mColumnFracs.resize(mWidth);
+		const F32 scale = (F32)image_width / (F32)mWidth;
+		for (S32 x = 0; x < mWidth; ++x)
+		{
+			F32 u = llclamp(((F32)x + 0.5f) * scale - 0.5f, 0.f, (F32)(image_width - 1));
+			S32 x0 = llfloor(u);
+			op.mColumns[x] = x0;
+			op.mColumnFracs[x] = u - (F32)x0;
+		}
+	}
+
+	if (mResult.isNull() || mResult->getWidth() != mWidth || mResult->getHeight() != mHeight)
+	{
+		mResult = new LLImageRaw(mWidth, mHeight, 4);
+	}
+}
+
+void LLTexLayerBake::compositeRows(S32 begin, S32 end)
+{
+	if (mResult.isNull() || !mResult->getData())
+	{
+		return;
+	}
+
+	F32* dst = (F32*)ll_aligned_malloc_16(mWidth * 4 * sizeof(F32));
+	F32* src = (F32*)ll_aligned_malloc_16(mWidth * 4 * sizeof(F32));
+	for (S32 row = begin; row < end; ++row)
+	{
+		memset(dst, 0, mWidth * 4 * sizeof(F32));
+		if (sUseSIMD)
+		{
+			compositeRowSIMD(row, dst, src);
+		}
+		else
+		{
+			compositeRowScalar(row, dst, src);
+		}
+
+		U8* out = mResult->getData() + row * mWidth * 4;
+		for (S32 i = 0; i < mWidth * 4; ++i)
+		{
+			out[i] = (U8)(llclamp(dst[i], 0.f, 1.f) * 255.f + 0.5f);
+		}
+	}
+	ll_aligned_free_16(src);
+	ll_aligned_free_16(dst);
+}
+
+// Source rows: where a row of an image lands, as a pair of rows and the weight
+// of the second.
+static void get_source_rows(S32 row, S32 height, const LLImageRaw* image, S32& y0, S32& y1, F32& frac)
+{
+	const S32 image_height = image->getHeight();
+	F32 v = llclamp(((F32)row + 0.5f) * (F32)image_height / (F32)height - 0.5f, 0.f, (F32)(image_height - 1));
+	y0 = llfloor(v);
+	y1 = llmin(y0 + 1, image_height - 1);
+	frac = v - (F32)y0;
+}
+
+//-----------------------------------------------------------------------------
+// SIMD path
+//-----------------------------------------------------------------------------
+
+static inline void load_texel(const U8* p, S32 components, bool alpha_only, LLVector4a& texel)
+{
+	switch (components)
+	{
+	case 1:
+		if (alpha_only)
+		{
+			texel.set(0.f, 0.f, 0.f, p[0]);
+		}
+		else
+		{
+			texel.set(p[0], p[0], p[0], 255.f);
+		}
+		break;
+	case 2:
+		texel.set(p[0], p[0], p[0], p[1]);
+		break;
+	case 3:
+		texel.set(p[0], p[1], p[2], 255.f);
+		break;
+	default:
+		texel.set(p[0], p[1], p[2], p[3]);
+		break;
+	}
+}
+
+template <LLTexLayerBake::EBlend BLEND>
+static void blend_row_simd(LLVector4a* dst, const LLVector4a* src, S32 width, F32 min_alpha, const LLVector4Logical& write)
+{
+	LLVector4a zero, one;
+	zero.clear();
+	one.splat(1.f);
+	for (S32 x = 0; x < width; ++x)
+	{
+		const LLVector4a& s = src[x];
+		if (s.getF32ptr()[3] < min_alpha)
+		{
+			continue;
+		}
+
+		const LLVector4a& d = dst[x];
+		LLVector4a out, factor;
+		switch (BLEND)
+		{
+		case LLTexLayerBake::BLEND_ALPHA:
+			factor.splat<3>(s);
+			out.setSub(s, d);
+			out.mul(factor);
+			out.add(d);
+			break;
+		case LLTexLayerBake::BLEND_REPLACE:
+			out = s;
+			break;
+		case LLTexLayerBake::BLEND_ADD:
+			out.setAdd(s, d);
+			break;
+		case LLTexLayerBake::BLEND_MULT_ALPHA:
+			factor.splat<3>(d);
+			out.setMul(s, factor);
+			break;
+		case LLTexLayerBake::BLEND_DEST_ALPHA:
+			factor.splat<3>(d);
+			out.setSub(s, d);
+			out.mul(factor);
+			out.add(d);
+			break;
+		}
+		out.clamp(zero, one);
+		dst[x].setSelectWithMask(write, out, d);
+	}
+}
+
+void LLTexLayerBake::compositeRowSIMD(S32 row, F32* dst_row, F32* src_row)
+{
+	LLVector4a* dst = (LLVector4a*)dst_row;
+	LLVector4a* src = (LLVector4a*)src_row;
+
+	for (op_list_t::const_iterator iter = mOps.begin(); iter != mOps.end(); ++iter)
+	{
+		const Op& op = *iter;
+		LLVector4a color;
+		color.loadua(op.mColor);
+
+		if (op.mImage.isNull())
+		{
+			for (S32 x = 0; x < mWidth; ++x)
+			{
+				src[x] = color;
+			}
+		}
+		else
+		{
+			// Texels are bytes; fold the conversion into the modulation.
+			color.mul(INV_255);
+
+			const LLImageRaw* image = op.mImage;
+			const S32 components = image->getComponents();
+			const S32 stride = image->getWidth() * components;
+			const S32 last_column = image->getWidth() - 1;
+			S32 y0, y1;
+			F32 fy;
+			get_source_rows(row, mHeight, image, y0, y1, fy);
+			const U8* row0 = image->getData() + y0 * stride;
+			const U8* row1 = image->getData() + y1 * stride;
+			for (S32 x = 0; x < mWidth; ++x)
+			{
+				const S32 x0 = op.mColumns[x];
+				const S32 x1 = llmin(x0 + 1, last_column);
+				const F32 fx = op.mColumnFracs[x];
+				LLVector4a t00, t10, t01, t11;
+				load_texel(row0 + x0 * components, components, op.mAlphaOnly, t00);
+				load_texel(row0 + x1 * components, components, op.mAlphaOnly, t10);
+				load_texel(row1 + x0 * components, components, op.mAlphaOnly, t01);
+				load_texel(row1 + x1 * components, components, op.mAlphaOnly, t11);
+				t00.setLerp(t00, t10, fx);
+				t01.setLerp(t01, t11, fx);
+				src[x].setLerp(t00, t01, fy);
+				src[x].mul(color);
+			}
+		}
+
+		LLVector4Logical write;
+		write.clear();
+		if (op.mWriteMask & WRITE_COLOR)
+		{
+			write.setElement<0>();
+			write.setElement<1>();
+			write.setElement<2>();
+		}
+		if (op.mWriteMask & WRITE_ALPHA)
+		{
+			write.setElement<3>();
+		}
+
+		switch (op.mBlend)
+		{
+		case BLEND_ALPHA:
+			blend_row_simd<BLEND_ALPHA>(dst, src, mWidth, op.mMinAlpha, write);
+			break;
+		case BLEND_REPLACE:
+			blend_row_simd<BLEND_REPLACE>(dst, src, mWidth, op.mMinAlpha, write);
+			break;
+		case BLEND_ADD:
+			blend_row_simd<BLEND_ADD>(dst, src, mWidth, op.mMinAlpha, write);
+			break;
+		case BLEND_MULT_ALPHA:
+			blend_row_simd<BLEND_MULT_ALPHA>(dst, src, mWidth, op.mMinAlpha, write);
+			break;
+		case BLEND_DEST_ALPHA:
+			blend_row_simd<BLEND_DEST_ALPHA>(dst, src, mWidth, op.mMinAlpha, write);
+			break;
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Scalar path
+//-----------------------------------------------------------------------------
+
+static inline void load_texel(const U8* p, S32 components, bool alpha_only, F32* texel)
+{
+	switch (components)
+	{
+	case 1:
+		texel[0] = texel[1] = texel[2] = alpha_only ? 0.f : p[0];
+		texel[3] = alpha_only ? p[0] : 255.f;
+		break;
+	case 2:
+		texel[0] = texel[1] = texel[2] = p[0];
+		texel[3] = p[1];
+		break;
+	case 3:
+		texel[0] = p[0];
+		texel[1] = p[1];
+		texel[2] = p[2];
+		texel[3] = 255.f;
+		break;
+	default:
+		texel[0] = p[0];
+		texel[1] = p[1];
+		texel[2] = p[2];
+		texel[3] = p[3];
+		break;
+	}
+}
+
+void LLTexLayerBake::compositeRowScalar(S32 row, F32* dst, F32* src)
+{
+	for (op_list_t::const_iterator iter = mOps.begin(); iter != mOps.end(); ++iter)
+	{
+		const Op& op = *iter;
+
+		if (op.mImage.isNull())
+		{
+			for (S32 x = 0; x < mWidth; ++x)
+			{
+				for (S32 c = 0; c < 4; ++c)
+				{
+					src[x * 4 + c] = op.mColor[c];
+				}
+			}
+		}
+		else
+		{
+			const LLImageRaw* image = op.mImage;
+			const S32 components = image->getComponents();
+			const S32 stride = image->getWidth() * components;
+			const S32 last_column = image->getWidth() - 1;
+			S32 y0, y1;
+			F32 fy;
+			get_source_rows(row, mHeight, image, y0, y1, fy);
+			const U8* row0 = image->getData() + y0 * stride;
+			const U8* row1 = image->getData() + y1 * stride;
+			for (S32 x = 0; x < mWidth; ++x)
+			{
+				const S32 x0 = op.mColumns[x];
+				const S32 x1 = llmin(x0 + 1, last_column);
+				const F32 fx = op.mColumnFracs[x];
+				F32 t00[4], t10[4], t01[4], t11[4];
+				load_texel(row0 + x0 * components, components, op.mAlphaOnly, t00);
+				load_texel(row0 + x1 * components, components, op.mAlphaOnly, t10);
+				load_texel(row1 + x0 * components, components, op.mAlphaOnly, t01);
+				load_texel(row1 + x1 * components, components, op.mAlphaOnly, t11);
+				for (S32 c = 0; c < 4; ++c)
+				{
+					F32 top = lerp(t00[c], t10[c], fx);
+					F32 bottom = lerp(t01[c], t11[c], fx);
+					src[x * 4 + c] = lerp(top, bottom, fy) * INV_255 * op.mColor[c];
+				}
+			}
+		}
+
+		for (S32 x = 0; x < mWidth; ++x)
+		{
+			const F32* s = src + x * 4;
+			F32* d = dst + x * 4;
+			if (s[3] < op.mMinAlpha)
+			{
+				continue;
+			}
+			for (S32 c = 0; c < 4; ++c)
+			{
+				if (!(op.mWriteMask & (c == 3 ? WRITE_ALPHA : WRITE_COLOR)))
+				{
+					continue;
+				}
+				F32 out = 0.f;
+				switch (op.mBlend)
+				{
+				case BLEND_ALPHA:
+					out = s[c] * s[3] + d[c] * (1.f - s[3]);
+					break;
+				case BLEND_REPLACE:
+					out = s[c];
+					break;
+				case BLEND_ADD:
+					out = s[c] + d[c];
+					break;
+				case BLEND_MULT_ALPHA:
+					out = s[c] * d[3];
+					break;
+				case BLEND_DEST_ALPHA:
+					out = s[c] * d[3] + d[c] * (1.f - d[3]);
+					break;
+				}
+				// Alpha comes last, so the color channels still blend against
+				// the old one.
+				d[c] = llclamp(out, 0.f, 1.f);
+			}
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// LLTexLayerCompositor
+//-----------------------------------------------------------------------------
+
+namespace
+{
+	struct Band
+	{
+		LLTexLayerBake*	mBake;
+		S32				mBegin;
+		S32				mEnd;
+	};
+
+	void prepare_bakes(const LLTexLayerCompositor::bake_list_t* bakes, U32 begin, U32 end)
+	{
+		for (U32 i = begin; i < end; ++i)
+		{
+			LLTexLayerBake* bake = (*bakes)[i];
+			bake->prepare();
+		}
+	}
+
+	void composite_bands(const std::vector<Band>* bands, U32 begin, U32 end)
+	{
+		for (U32 i = begin; i < end; ++i)
+		{
+			const Band& band = (*bands)[i];
+			band.mBake->compositeRows(band.mBegin, band.mEnd);
+		}
+	}
+}
+
+// static
+void LLTexLayerCompositor::composite(const bake_list_t& bakes, LLWorkerPool* pool)
+{
+	LL_RECORD_BLOCK_TIME(FTM_COMPOSITE_BAKES);
+	if (bakes.empty())
+	{
+		return;
+	}
+	if (!pool)
+	{
+		pool = LLWorkerPool::getDefault();
+	}
+
+	// Gradient decoding dominates preparation; one bake per job.
+	pool->parallelFor((U32)bakes.size(), 1, boost::bind(&prepare_bakes, &bakes, _1, _2));
+
+	std::vector<Band> bands;
+	for (bake_list_t::const_iterator iter = bakes.begin(); iter != bakes.end(); ++iter)
+	{
+		LLTexLayerBake* bake = *iter;
+		for (S32 row = 0; row < bake->getHeight(); row += ROWS_PER_BAND)
+		{
+			Band band;
+			band.mBake = bake;
+			band.mBegin = row;
+			band.mEnd = llmin(row + ROWS_PER_BAND, bake->getHeight());
+			bands.push_back(band);
+		}
+	}
+	pool->parallelFor((U32)bands.size(), 1, boost::bind(&composite_bands, &bands, _1, _2));
+
+	for (bake_list_t::const_iterator iter = bakes.begin(); iter != bakes.end(); ++iter)
+	{
+		setComposited(*iter);
+	}
+}
+
+// static
+void LLTexLayerCompositor::composite(LLTexLayerBake* bake, LLWorkerPool* pool)
+{
+	bake_list_t bakes;
+	bakes.push_back(bake);
+	composite(bakes, pool);
+}
+
+// static
+void LLTexLayerCompositor::compositeAsync(LLTexLayerBake* bake, LLWorkerPool* pool)
+{
+	if (!pool)
+	{
+		// A pool of its own: threads that help with parallelFor() on the
+		// default pool must never find a whole bake in front of them.
+		if (!sAsyncPool)
+		{
+			U32 threads = llclamp(boost::thread::hardware_concurrency() / 4, 1U, MAX_ASYNC_THREADS);
+			sAsyncPool = new LLWorkerPool("Avatar Bake", threads);
+		}
+		pool = sAsyncPool;
+	}
+	// Not split in bands: the caller isn't waiting, and a pool job must not
+	// wait on the pool itself.
+	pool->post(boost::bind(&LLTexLayerCompositor::compositeWhole, LLPointer<LLTexLayerBake>(bake)));
+}
+
+// static
+void LLTexLayerCompositor::cleanupClass()
+{
+	// Waits for the bake that is running; the queued ones are dropped.
+	delete sAsyncPool;
+	sAsyncPool = NULL;
+}
+
+// static
+void LLTexLayerCompositor::compositeWhole(LLPointer<LLTexLayerBake> bake)
+{
+	LLTimer timer;
+	bake->prepare();
+	bake->compositeRows(0, bake->getHeight());
+	bake->mCompositeTime = timer.getElapsedTimeF32();
+	setComposited(bake);
+}
+
+// static
+void LLTexLayerCompositor::setComposited(LLTexLayerBake* bake)
+{
+	bake->mComposited.store(1);
+}
@@ -0,0 +1,181 @@
+/**
+ * @file lltexlayercompositor.h
+ * @brief Software compositing of avatar texture layer sets
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+
+#ifndef LL_LLTEXLAYERCOMPOSITOR_H
+#define LL_LLTEXLAYERCOMPOSITOR_H
+
+#include "llatomic.h"
+#include "llpointer.h"
+#include "llrefcount.h"
+#include "v4color.h"
+
+#include <string>
+#include <vector>
+
+class LLImageRaw;
+class LLImageTGA;
+class LLWorkerPool;
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// LLTexLayerBake
+//
+// One body region's bake, flattened into the full-frame draws LLTexLayerSet::render()
+// issues through GL: fills and stretched images, each with a blend mode, a channel
+// write mask and an alpha test.  Colors, param weights and images are all resolved
+// when the bake is built (on the main thread, see LLTexLayerSet::createBake()), so
+// compositing needs nothing but the bake itself and may run on any thread.
+//
+// Pixels are kept as floats from the first draw to the last and only rounded to
+// bytes at the end; a GL bake rounds after every draw, so the two can differ by a
+// few steps where many layers overlap.
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+class LLTexLayerBake : public LLThreadSafeRefCount
+{
+	friend class LLTexLayerCompositor;
+public:
+	// Named after the GL blend functions they stand for.
+	enum EBlend
+	{
+		BLEND_ALPHA,		// src * src_alpha + dst * (1 - src_alpha)
+		BLEND_REPLACE,		// src
+		BLEND_ADD,			// src + dst
+		BLEND_MULT_ALPHA,	// src * dst_alpha
+		BLEND_DEST_ALPHA	// src * dst_alpha + dst * (1 - dst_alpha)
+	};
+
+	enum
+	{
+		WRITE_COLOR = 1,
+		WRITE_ALPHA = 2,
+		WRITE_ALL = WRITE_COLOR | WRITE_ALPHA
+	};
+
+	// Alpha test threshold of the GL bake (gAlphaMaskProgram's minimum alpha).
+	static const F32 MIN_ALPHA;
+
+	LLTexLayerBake(const std::string& name, S32 width, S32 height);
+
+	// Plan building.  Each draw covers the whole bake.  Sources with an alpha below
+	// min_alpha are discarded, as by the alpha test.
+	void	fill(const LLColor4& color, EBlend blend, U32 write_mask, F32 min_alpha = 0.f);
+	// Images are stretched to fit with bilinear filtering clamped at the edges, and
+	// modulated by color.  One component images are luminance; two are luminance
+	// and alpha.
+	void	drawImage(LLImageRaw* image, const LLColor4& color, EBlend blend, U32 write_mask, F32 min_alpha = 0.f);
+	// Param alpha gradient, run through LLImageTGA::decodeAndProcess() when the bake
+	// is composited.  Draws into alpha only.
+	void	drawGradient(LLImageTGA* image, F32 domain, F32 weight, EBlend blend);
+	// Something the GL bake would have drawn was not available.
+	void	setPartial()				{ mPartial = true; }
+
+	const std::string& getName() const	{ return mName; }
+	S32		getWidth() const			{ return mWidth; }
+	S32		getHeight() const			{ return mHeight; }
+	U32		getNumDraws() const			{ return (U32)mOps.size(); }
+	bool	isPartial() const			{ return mPartial; }
+
+	// RGBA, bottom row first like glReadPixels().  NULL until composited.
+	LLImageRaw* getResult() const		{ return mResult; }
+	// Set by LLTexLayerCompositor once every row is done; safe to poll from any
+	// thread, getResult() may be read after it turns true.
+	bool	isComposited() const		{ return mComposited.load() != 0; }
+	// Seconds the compositeAsync() job took; 0 for a bake composited in a batch.
+	F32		getCompositeTime() const	{ return mCompositeTime; }
+
+	// Compositing, in two steps so that the second can be split by rows: prepare()
+	// decodes the gradients and allocates the result, compositeRows() fills in rows
+	// [begin, end).  LLTexLayerCompositor does both.
+	void	prepare();
+	void	compositeRows(S32 begin, S32 end);
+
+	// False selects a plain scalar implementation, for checking and timing the
+	// SIMD one.
+	static bool sUseSIMD;
+
+private:
+	struct Op
+	{
+		Op();
+
+		EBlend					mBlend;
+		U32						mWriteMask;
+		F32						mMinAlpha;
+		F32						mColor[4];
+		LLPointer<LLImageRaw>	mImage;			// NULL for a fill
+		bool					mAlphaOnly;		// mImage holds alpha only
+		LLPointer<LLImageTGA>	mGradient;
+		F32						mDomain;
+		F32						mWeight;
+		// Source texel pair and weight of the second for each column, filled in
+		// by prepare().
+		std::vector<S32>		mColumns;
+		std::vector<F32>		mColumnFracs;
+	};
+	typedef std::vector<Op> op_list_t;
+
+	void	compositeRowSIMD(S32 row, F32* dst, F32* src);
+	void	compositeRowScalar(S32 row, F32* dst, F32* src);
+
+	std::string				mName;
+	S32						mWidth;
+	S32						mHeight;
+	op_list_t				mOps;
+	bool					mPartial;
+	LLPointer<LLImageRaw>	mResult;
+	LLAtomicU32				mComposited;
+	F32						mCompositeTime;
+};
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// LLTexLayerCompositor
+//
+// Composites a batch of bakes, typically every body region of an avatar, split in
+// bands of rows over a worker pool.  composite() blocks until all of them are done,
+// the calling thread taking part; compositeAsync() queues a bake and returns at once.
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+class LLTexLayerCompositor
+{
+public:
+	typedef std::vector<LLPointer<LLTexLayerBake> > bake_list_t;
+
+	// pool defaults to LLWorkerPool::getDefault().
+	static void composite(const bake_list_t& bakes, LLWorkerPool* pool = NULL);
+	static void composite(LLTexLayerBake* bake, LLWorkerPool* pool = NULL);
+	// Composites the bake as a single pool job.  Poll isComposited() for the
+	// result; the job holds its own reference, so the caller may drop the bake.
+	// pool defaults to one kept for these, apart from the default pool.
+	static void compositeAsync(LLTexLayerBake* bake, LLWorkerPool* pool = NULL);
+	static void cleanupClass();
+
+private:
+	static void compositeWhole(LLPointer<LLTexLayerBake> bake);
+	static void setComposited(LLTexLayerBake* bake);
+
+	static LLWorkerPool* sAsyncPool;
+};
+
+#endif // LL_LLTEXLAYERCOMPOSITOR_H
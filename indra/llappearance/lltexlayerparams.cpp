@@ -32,6 +32,7 @@
 #include "llimagetga.h"
 #include "llquantize.h"
 #include "lltexlayer.h"
+#include "lltexlayercompositor.h"
 #include "lltexturemanagerbridge.h"
 #include "llrender2dutils.h"
 #include "llwearable.h"
@@ -373,6 +374,42 @@ BOOL LLTexLayerParamAlpha::render(S32 x, S32 y, S32 width, S32 height)
 	return success;
 }
 
+// Software counterpart of render().  The gradient is processed by the compositor,
+// which leaves the GL cache alone.
+BOOL LLTexLayerParamAlpha::addToBake(LLTexLayerBake* bake)
+{
+	if (!mTexLayer || getSkip())
+	{
+		return TRUE;
+	}
+
+	F32 effective_weight = (mTexLayer->getTexLayerSet()->getAvatarAppearance()->getSex() & getSex()) ? mCurWeight : getDefaultWeight();
+	LLTexLayerParamAlphaInfo *info = (LLTexLayerParamAlphaInfo *)getInfo();
+	LLTexLayerBake::EBlend blend = info->mMultiplyBlend ? LLTexLayerBake::BLEND_MULT_ALPHA : LLTexLayerBake::BLEND_ADD;
+
+	if (!info->mStaticImageFileName.empty() && !mStaticImageInvalid)
+	{
+		if (mStaticImageTGA.isNull())
+		{
+			mStaticImageTGA = LLTexLayerStaticImageList::getInstance()->getImageTGA(info->mStaticImageFileName);
+			LLTexLayerSet::sHasCaches |= mStaticImageTGA.notNull() ? TRUE : FALSE;
+			if (mStaticImageTGA.isNull())
+			{
+				LL_WARNS() << "Unable to load static file: " << info->mStaticImageFileName << LL_ENDL;
+				mStaticImageInvalid = TRUE;
+				return FALSE;
+			}
+		}
+		bake->drawGradient(mStaticImageTGA, info->mDomain, effective_weight, blend);
+	}
+	else
+	{
+		bake->fill(LLColor4(0.f, 0.f, 0.f, effective_weight), blend, LLTexLayerBake::WRITE_ALPHA);
+	}
+
+	return TRUE;
+}
+
 //-----------------------------------------------------------------------------
 // LLTexLayerParamAlphaInfo
 //-----------------------------------------------------------------------------
@@ -35,6 +35,7 @@ class LLAvatarAppearance;
 class LLImageRaw;
 class LLImageTGA;
 class LLTexLayer;
+class LLTexLayerBake;
 class LLTexLayerInterface;
 class LLGLTexture;
 class LLWearable;
@@ -100,6 +101,7 @@ public:
 
 	// New functions
 	BOOL					render( S32 x, S32 y, S32 width, S32 height );
+	BOOL					addToBake(LLTexLayerBake* bake);
 	BOOL					getSkip() const;
 	void					deleteCaches();
 	BOOL					getMultiplyBlend() const;
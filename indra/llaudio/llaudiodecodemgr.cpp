@@ -41,6 +41,7 @@
 #include "llendianswizzle.h"
 #include "llassetstorage.h"
 #include "llrefcount.h"
+#include "llworkerpool.h"
 
 #include "llvorbisencode.h"
 
@@ -48,6 +49,10 @@
 #include "vorbis/vorbisfile.h"
 #include <iterator>
 #include <deque>
+#include <map>
+#include <set>
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
 
 extern LLAudioEngine *gAudiop;
 
@@ -55,11 +60,17 @@ LLAudioDecodeMgr *gAudioDecodeMgrp = NULL;
 
 static const S32 WAV_HEADER_SIZE = 44;
 
+// Decoding is mostly vorbis arithmetic, so a few threads are enough to keep
+// up with a burst of new sounds without taking cores from texture decode.
+static const U32 MAX_DECODE_THREADS = 4;
+
 
 //////////////////////////////////////////////////////////////////////////////
 
 
-class LLVorbisDecodeState : public LLRefCount
+// Decodes one sound into a WAV image in memory.  decode() runs on a decode
+// thread; everything else is called on the main thread once it's finished.
+class LLVorbisDecodeState : public LLThreadSafeRefCount
 {
 public:
 	class WriteResponder : public LLLFSThread::Responder
@@ -74,24 +85,36 @@ public:
 		LLPointer<LLVorbisDecodeState> mDecoder;
 	};
 	
-	LLVorbisDecodeState(const LLUUID &uuid, const std::string &out_filename);
+	LLVorbisDecodeState(const LLUUID &uuid, const std::string &out_filename, bool allow_large_sounds);
 
-	BOOL initDecode();
-	BOOL decodeSection(); // Return TRUE if done.
-	BOOL finishDecode();
+	// Runs the whole decode.  Decode thread.
+	void decode();
+
+	// Starts writing the decoded file to the cache.  isWritten() turns true
+	// once that has finished, successfully or not.
+	void writeCacheFile();
+	bool isWritten() const;
 
 	void flushBadFile();
 
 	void ioComplete(S32 bytes)			{ mBytesRead = bytes; }
 	BOOL isValid() const				{ return mValid; }
 	BOOL isDone() const					{ return mDone; }
+	bool isInitialized() const			{ return mInitialized; }
 	const LLUUID &getUUID() const		{ return mUUID; }
+	const std::vector<U8> &getWAVBuffer() const	{ return mWAVBuffer; }
 
 protected:
 	virtual ~LLVorbisDecodeState();
 
+	BOOL initDecode();
+	BOOL decodeSection(); // Return TRUE if done.
+	BOOL finishDecode();
+
 	BOOL mValid;
 	BOOL mDone;
+	bool mInitialized;
+	bool mAllowLargeSounds;
 	LLAtomicS32 mBytesRead;
 	LLUUID mUUID;
 
@@ -170,8 +193,8 @@ long vfs_tell (void *datasource)
 	return file->tell();
 }
 
-LLVorbisDecodeState::LLVorbisDecodeState(const LLUUID &uuid, const std::string &out_filename) :
-	mValid(FALSE), mDone(FALSE), mBytesRead(-1), mUUID(uuid),
+LLVorbisDecodeState::LLVorbisDecodeState(const LLUUID &uuid, const std::string &out_filename, bool allow_large_sounds) :
+	mValid(FALSE), mDone(FALSE), mInitialized(false), mAllowLargeSounds(allow_large_sounds), mBytesRead(-1), mUUID(uuid),
 #if !defined(USE_WAV_VFILE)
 	mOutFilename(out_filename), mFileHandle(LLLFSThread::nullHandle()),
 #endif
@@ -181,11 +204,38 @@ LLVorbisDecodeState::LLVorbisDecodeState(const LLUUID &uuid, const std::string &
 
 LLVorbisDecodeState::~LLVorbisDecodeState()
 {
-	if (!mDone)
+	// Once the stream is open, ov_clear() closes the file.
+	delete mInFilep;
+	mInFilep = NULL;
+}
+
+void LLVorbisDecodeState::decode()
+{
+	if (!initDecode())
 	{
-		delete mInFilep;
-		mInFilep = NULL;
+		return;
+	}
+	mInitialized = true;
+
+	try
+	{
+		while (!decodeSection())
+		{
+		}
+		if (isValid())
+		{
+			finishDecode();
+		}
 	}
+	catch (std::bad_alloc)
+	{
+		LL_WARNS("AudioEngine") << "bad_alloc whilst decoding " << mUUID << LL_ENDL;
+		mValid = FALSE;
+		mDone = TRUE;
+	}
+
+	ov_clear(&mVF);
+	mInFilep = NULL;
 }
 
 
@@ -245,7 +295,7 @@ BOOL LLVorbisDecodeState::initDecode()
 		LL_WARNS() << "Bad sound caught by zmagic" << LL_ENDL;
 		abort_decode = true;
 	}
-	else if(!gAudiop->getAllowLargeSounds())
+	else if(!mAllowLargeSounds)
 	{
 	// </edit> 
 	//Much more restrictive than zmagic. Perhaps make toggleable.
@@ -439,12 +489,7 @@ BOOL LLVorbisDecodeState::finishDecode()
 		return TRUE; // We've finished
 	}
 
-#if !defined(USE_WAV_VFILE)	
-	if (mFileHandle == LLLFSThread::nullHandle())
-#endif
 	{
-		ov_clear(&mVF);
-  
 		// write "data" chunk length, in little-endian format
 		S32 data_length = mWAVBuffer.size() - WAV_HEADER_SIZE;
 		mWAVBuffer[40] = (data_length) & 0x000000FF;
@@ -520,49 +565,38 @@ BOOL LLVorbisDecodeState::finishDecode()
 			mValid = FALSE;
 			return TRUE; // we've finished
 		}
-#if !defined(USE_WAV_VFILE)
-		mBytesRead = -1;
-		mFileHandle = LLLFSThread::sLocal->write(mOutFilename, &mWAVBuffer[0], 0, mWAVBuffer.size(),
-							 new WriteResponder(this));
-#endif
 	}
 
-	if (mFileHandle != LLLFSThread::nullHandle())
-	{
-		if (mBytesRead >= 0)
-		{
-			if (mBytesRead == 0)
-			{
-				LL_WARNS("AudioEngine") << "Unable to write file in LLVorbisDecodeState::finishDecode" << LL_ENDL;
-				mValid = FALSE;
-				return TRUE; // we've finished
-			}
-		}
-		else
-		{
-			return FALSE; // not done
-		}
-	}
-	
-	mDone = TRUE;
+	LL_DEBUGS("AudioEngine") << "Finished decode for " << getUUID() << LL_ENDL;
 
+	return TRUE;
+}
+
+void LLVorbisDecodeState::writeCacheFile()
+{
 #if defined(USE_WAV_VFILE)
 	// write the data.
 	LLVFile output(gVFS, mUUID, LLAssetType::AT_SOUND_WAV);
 	output.write(&mWAVBuffer[0], mWAVBuffer.size());
+	mBytesRead = mWAVBuffer.size();
+#else
+	// The responder keeps this, and so the buffer, alive until the write is done.
+	mBytesRead = -1;
+	mFileHandle = LLLFSThread::sLocal->write(mOutFilename, &mWAVBuffer[0], 0, mWAVBuffer.size(),
+											 new WriteResponder(this));
 #endif
-	LL_DEBUGS("AudioEngine") << "Finished decode for " << getUUID() << LL_ENDL;
+}
 
-	return TRUE;
+bool LLVorbisDecodeState::isWritten() const
+{
+	return mBytesRead >= 0;
 }
 
 void LLVorbisDecodeState::flushBadFile()
 {
-	if (mInFilep)
-	{
-		LL_WARNS("AudioEngine") << "Flushing bad vorbis file from VFS for " << mUUID << LL_ENDL;
-		mInFilep->remove();
-	}
+	LL_WARNS("AudioEngine") << "Flushing bad vorbis file from VFS for " << mUUID << LL_ENDL;
+	LLVFile infile(gVFS, mUUID, LLAssetType::AT_SOUND);
+	infile.remove();
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -571,137 +605,170 @@ class LLAudioDecodeMgr::Impl
 {
 	friend class LLAudioDecodeMgr;
 public:
-	Impl() {};
-	~Impl() {};
+	Impl();
+	~Impl();
 
 	void processQueue(const F32 num_secs = 0.005);
+	bool loadDecodedWAV(const LLUUID &uuid, LLAudioBuffer *bufferp);
 
 protected:
+	void startDecode(const LLUUID &uuid);
+	void decodeDone(LLVorbisDecodeState *decodep);
+	void runDecode(LLPointer<LLVorbisDecodeState> decodep);
+
 	std::deque<LLUUID> mDecodeQueue;
-	LLPointer<LLVorbisDecodeState> mCurrentDecodep;
+	std::set<LLUUID> mDecoding;		// on the decode threads
+
+	// Finished decodes, waiting for the main thread.  Guarded by mFinishedMutex.
+	LLMutex mFinishedMutex;
+	std::vector<LLPointer<LLVorbisDecodeState> > mFinished;
+
+	// Decoded sounds whose cache file isn't written yet.  Buffers load from
+	// here until it is.
+	typedef std::map<LLUUID, LLPointer<LLVorbisDecodeState> > decoded_map_t;
+	decoded_map_t mDecoded;
+
+	LLWorkerPool *mDecodePool;
 };
 
+LLAudioDecodeMgr::Impl::Impl()
+{
+	U32 threads = llclamp(boost::thread::hardware_concurrency() / 2, 1U, MAX_DECODE_THREADS);
+	mDecodePool = new LLWorkerPool("Audio Decode", threads);
+}
 
-void LLAudioDecodeMgr::Impl::processQueue(const F32 num_secs)
+LLAudioDecodeMgr::Impl::~Impl()
 {
-	LLUUID uuid;
+	// Waits for the decodes that are running; the queued ones are dropped.
+	delete mDecodePool;
+	mDecodePool = NULL;
+}
 
-	LLTimer decode_timer;
+void LLAudioDecodeMgr::Impl::runDecode(LLPointer<LLVorbisDecodeState> decodep)
+{
+	decodep->decode();
+
+	LLMutexLock lock(&mFinishedMutex);
+	mFinished.push_back(decodep);
+}
+
+void LLAudioDecodeMgr::Impl::startDecode(const LLUUID &uuid)
+{
+	LL_DEBUGS() << "Decoding " << uuid << " from audio queue!" << LL_ENDL;
+
+	std::string uuid_str;
+	uuid.toString(uuid_str);
+	std::string d_path = gDirUtilp->getExpandedFilename(LL_PATH_CACHE,uuid_str) + ".dsf";
+
+	LLPointer<LLVorbisDecodeState> decodep = new LLVorbisDecodeState(uuid, d_path, gAudiop->getAllowLargeSounds());
+	mDecoding.insert(uuid);
+	mDecodePool->post(boost::bind(&LLAudioDecodeMgr::Impl::runDecode, this, decodep));
+}
 
-	BOOL done = FALSE;
-	while (!done)
+void LLAudioDecodeMgr::Impl::decodeDone(LLVorbisDecodeState *decodep)
+{
+	const LLUUID &uuid = decodep->getUUID();
+	mDecoding.erase(uuid);
+
+	LLAudioData *adp = gAudiop ? gAudiop->getAudioData(uuid) : NULL;
+	if (!decodep->isInitialized())
 	{
-		if (mCurrentDecodep)
+		if (adp)
 		{
-			// <edit> rawrning
-			//BOOL res;
-			BOOL res = false;
-			// </edit>
+			adp->setLoadState(LLAudioData::STATE_LOAD_ERROR);
+		}
+		return;
+	}
 
-			// Decode in a loop until we're done or have run out of time.
-			/* <edit> */ try{ /* </edit> */
-			while(!(res = mCurrentDecodep->decodeSection()) && (decode_timer.getElapsedTimeF32() < num_secs))
-			{
-				// decodeSection does all of the work above
-			}
-			/* <edit> */ }catch(std::bad_alloc){LL_ERRS() << "bad_alloc whilst decoding" << LL_ENDL;} /* </edit> */
+	if (!decodep->isValid() || !decodep->isDone())
+	{
+		// We had an error when decoding, abort.
+		LL_WARNS("AudioEngine") << uuid << " has invalid vorbis data, aborting decode" << LL_ENDL;
+		decodep->flushBadFile();
+		if (adp)
+		{
+			adp->setLoadState(LLAudioData::STATE_LOAD_ERROR);
+		}
+		return;
+	}
 
-			if (mCurrentDecodep->isDone() && !mCurrentDecodep->isValid())
-			{
-				// We had an error when decoding, abort.
-				LL_WARNS("AudioEngine") << mCurrentDecodep->getUUID() << " has invalid vorbis data, aborting decode" << LL_ENDL;
-				mCurrentDecodep->flushBadFile();
-
-				if (gAudiop)
-				{
-					LLAudioData *adp = gAudiop->getAudioData(mCurrentDecodep->getUUID());
-					if(adp)
-					{
-						adp->setLoadState(LLAudioData::STATE_LOAD_ERROR);
-					}
-				}
-				mCurrentDecodep = NULL;
-				done = TRUE;
-			}
+	// Playable now; the cache file is only needed once the buffer is
+	// evicted, or by the next session.
+	decodep->writeCacheFile();
+	mDecoded[uuid] = decodep;
 
-			if (!res)
-			{
-				// We've used up out time slice, bail...
-				done = TRUE;
-			}
-			else if (mCurrentDecodep)
-			{
-				if (gAudiop && mCurrentDecodep->finishDecode())
-				{
-					// We finished!
-					LLAudioData *adp = gAudiop->getAudioData(mCurrentDecodep->getUUID());
-					if (!adp)
-					{
-						LL_WARNS("AudioEngine") << "Missing LLAudioData for decode of " << mCurrentDecodep->getUUID() << LL_ENDL;
-					}
-					else if (mCurrentDecodep->isValid() && mCurrentDecodep->isDone())
-					{
-						adp->setLoadState(LLAudioData::STATE_LOAD_READY);
-						// At this point, we could see if anyone needs this sound immediately, but
-						// I'm not sure that there's a reason to - we need to poll all of the playing
-						// sounds anyway.
-						//LL_INFOS("AudioEngine") << "Finished the vorbis decode, now what?" << LL_ENDL;
-					}
-					else
-					{
-						adp->setLoadState(LLAudioData::STATE_LOAD_ERROR);
-						LL_INFOS("AudioEngine") << "Vorbis decode failed for " << mCurrentDecodep->getUUID() << LL_ENDL;
-					}
-					mCurrentDecodep = NULL;
-				}
-				done = TRUE; // done for now
-			}
+	if (!adp)
+	{
+		LL_WARNS("AudioEngine") << "Missing LLAudioData for decode of " << uuid << LL_ENDL;
+	}
+	else
+	{
+		adp->setLoadState(LLAudioData::STATE_LOAD_READY);
+	}
+}
+
+void LLAudioDecodeMgr::Impl::processQueue(const F32 num_secs)
+{
+	LLTimer decode_timer;
+
+	// Release the decodes whose cache files have been written.
+	for (decoded_map_t::iterator iter = mDecoded.begin(); iter != mDecoded.end();)
+	{
+		if (iter->second->isWritten())
+		{
+			mDecoded.erase(iter++);
 		}
+		else
+		{
+			++iter;
+		}
+	}
+
+	std::vector<LLPointer<LLVorbisDecodeState> > finished;
+	{
+		LLMutexLock lock(&mFinishedMutex);
+		finished.swap(mFinished);
+	}
+	for (std::vector<LLPointer<LLVorbisDecodeState> >::iterator iter = finished.begin(); iter != finished.end(); ++iter)
+	{
+		decodeDone(*iter);
+	}
 
-		if (!done)
+	// Hand the queue to the decode threads.  Starting a decode opens nothing,
+	// so the time limit is only a guard against a huge backlog.
+	while (!mDecodeQueue.empty() && decode_timer.getElapsedTimeF32() < num_secs)
+	{
+		LLUUID uuid = mDecodeQueue.front();
+		mDecodeQueue.pop_front();
+		if (!gAudiop || mDecoding.count(uuid))
 		{
-			if (mDecodeQueue.empty())
-			{
-				// Nothing else on the queue.
-				done = TRUE;
-			}
-			else
+			continue;
+		}
+		if (mDecoded.count(uuid) || gAudiop->hasDecodedFile(uuid))
+		{
+			// This file has already been decoded, don't decode it again.
+			LLAudioData *adp = gAudiop->getAudioData(uuid);
+			if (adp && adp->getLoadState() == LLAudioData::STATE_LOAD_DECODING)
 			{
-				LLUUID uuid;
-				uuid = mDecodeQueue.front();
-				mDecodeQueue.pop_front();
-				if (!gAudiop || gAudiop->hasDecodedFile(uuid))
-				{
-					// This file has already been decoded, don't decode it again.
-					continue;
-				}
-
-				LL_DEBUGS() << "Decoding " << uuid << " from audio queue!" << LL_ENDL;
-
-				std::string uuid_str;
-				std::string d_path;
-
-				LLTimer timer;
-				timer.reset();
-
-				uuid.toString(uuid_str);
-				d_path = gDirUtilp->getExpandedFilename(LL_PATH_CACHE,uuid_str) + ".dsf";
-
-				mCurrentDecodep = new LLVorbisDecodeState(uuid, d_path);
-				if (!mCurrentDecodep->initDecode())
-				{
-					LLAudioData *adp = gAudiop->getAudioData(uuid);
-					if(adp)
-					{
-						adp->setLoadState(LLAudioData::STATE_LOAD_ERROR);
-					}
-					mCurrentDecodep = NULL;
-				}
+				adp->setLoadState(LLAudioData::STATE_LOAD_READY);
 			}
+			continue;
 		}
+		startDecode(uuid);
 	}
 }
 
+bool LLAudioDecodeMgr::Impl::loadDecodedWAV(const LLUUID &uuid, LLAudioBuffer *bufferp)
+{
+	decoded_map_t::iterator iter = mDecoded.find(uuid);
+	if (iter == mDecoded.end())
+	{
+		return false;
+	}
+	const std::vector<U8> &wav = iter->second->getWAVBuffer();
+	return bufferp->loadWAVData(&wav[0], (U32)wav.size());
+}
+
 //////////////////////////////////////////////////////////////////////////////
 
 LLAudioDecodeMgr::LLAudioDecodeMgr()
@@ -719,6 +786,11 @@ void LLAudioDecodeMgr::processQueue(const F32 num_secs)
 	mImpl->processQueue(num_secs);
 }
 
+bool LLAudioDecodeMgr::loadDecodedWAV(const LLUUID &uuid, LLAudioBuffer *bufferp)
+{
+	return mImpl->loadDecodedWAV(uuid, bufferp);
+}
+
 bool LLAudioDecodeMgr::addDecodeRequest(const LLUUID &uuid)
 {
 	if(uuid.isNull())
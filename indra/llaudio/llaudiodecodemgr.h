@@ -33,6 +33,7 @@
 #include "llassettype.h"
 #include "llframetimer.h"
 
+class LLAudioBuffer;
 class LLVFS;
 class LLVorbisDecodeState;
 
@@ -42,9 +43,16 @@ public:
 	LLAudioDecodeMgr();
 	~LLAudioDecodeMgr();
 
+	// Hands queued sounds to the decode threads and finishes the ones they
+	// are done with.  Main thread.
 	void processQueue(const F32 num_secs = 0.005);
 	bool addDecodeRequest(const LLUUID &uuid);
 	void addAudioRequest(const LLUUID &uuid);
+
+	// Loads a sound decoded this session into bufferp straight from memory.
+	// Returns false if it's not held in memory (any more), in which case the
+	// cache file has it.
+	bool loadDecodedWAV(const LLUUID &uuid, LLAudioBuffer *bufferp);
 	
 protected:
 	class Impl;
@@ -36,6 +36,7 @@
 #include "sound_ids.h"  // temporary hack for min/max distances
 
 #include "llvfs.h"
+#include "llvfile.h"
 #include "lldir.h"
 #include "llaudiodecodemgr.h"
 #include "llassetstorage.h"
@@ -1300,7 +1301,7 @@ void LLAudioEngine::startNextTransfer()
 	{
 		mCurrentTransfer = cur_adp;
 		mCurrentTransferTimer.reset();
-		mCurrentTransfer->updateLoadState();
+		mCurrentTransfer->updateLoadState(max_pri);
 	}
 	else
 	{
@@ -1337,6 +1338,10 @@ void LLAudioEngine::assetCallback(LLVFS *vfs, const LLUUID &uuid, LLAssetType::E
 		else
 		{
 			// LL_INFOS("AudioEngine") << "Got asset callback with good audio data for " << uuid << ", making decode request" << LL_ENDL;
+			if (ext_status != LL_EXSTAT_VFS_CACHED && gAssetStorage)
+			{
+				gAssetStorage->reportReceived(type, LLVFile(vfs, uuid, type).getSize());
+			}
 			adp->setLoadState(LLAudioData::STATE_LOAD_REQ_DECODE);
 			//Immediate decode.
 			adp->updateLoadState();
@@ -1455,7 +1460,7 @@ void LLAudioSource::update()
 		else
 		{
 			//The sound wasn't preloaded yet... so we must kick off the process.
-			adp->updateLoadState();
+			adp->updateLoadState(getPriority());
 		}
 	}
 }
@@ -1764,7 +1769,7 @@ LLAudioData::LLAudioData(const LLUUID &uuid) :
 		mLoadState = STATE_LOAD_REQ_FETCH;
 }
 
-void LLAudioData::updateLoadState()
+void LLAudioData::updateLoadState(F32 priority)
 {
 	if(mLoadState == STATE_LOAD_REQ_DECODE && gAudioDecodeMgrp)
 	{
@@ -1783,7 +1788,8 @@ void LLAudioData::updateLoadState()
 		LL_DEBUGS("AudioEngine") << "Fetching asset data for: " << getID() << LL_ENDL;
 		setLoadState(STATE_LOAD_FETCHING);
 
-		gAssetStorage->getAssetData(getID(), LLAssetType::AT_SOUND, LLAudioEngine::assetCallback, NULL);
+		gAssetStorage->getAssetData(getID(), LLAssetType::AT_SOUND, LLAudioEngine::assetCallback, NULL,
+									FALSE, llclamp(priority, 0.f, 1.f));
 	}
 }
 
@@ -1806,12 +1812,19 @@ bool LLAudioData::load()
 		return false;
 	}
 
-	std::string uuid_str;
-	std::string wav_path;
-	mID.toString(uuid_str);
-	wav_path= gDirUtilp->getExpandedFilename(LL_PATH_CACHE,uuid_str) + ".dsf";
+	// A sound decoded moments ago comes straight from memory; its cache file
+	// may not have been written yet.
+	bool loaded = gAudioDecodeMgrp && gAudioDecodeMgrp->loadDecodedWAV(mID, mBufferp);
+	if (!loaded)
+	{
+		std::string uuid_str;
+		std::string wav_path;
+		mID.toString(uuid_str);
+		wav_path= gDirUtilp->getExpandedFilename(LL_PATH_CACHE,uuid_str) + ".dsf";
+		loaded = mBufferp->loadWAV(wav_path);
+	}
 
-	if (!mBufferp->loadWAV(wav_path))
+	if (!loaded)
 	{
 		// Hrm.  Right now, let's unset the buffer, since it's empty.
 		gAudiop->cleanupBuffer(mBufferp);
@@ -412,7 +412,9 @@ public:
 	ELoadState	setLoadState(ELoadState state)	{ return mLoadState = state; }
 	bool		isInPreload() const				{ return mLoadState > STATE_LOAD_ERROR && mLoadState < STATE_LOAD_READY; }
 
-	void updateLoadState();
+	// priority is that of the source wanting the sound, and ranks the
+	// fetch against other sound downloads.
+	void updateLoadState(F32 priority = 0.f);
 
 	friend class LLAudioEngine; // Severe laziness, bad.
 
@@ -480,6 +482,9 @@ public:
 	LLAudioBuffer() : mInUse(true), mAudioDatap(NULL) { mLastUseTimer.reset(); }
 	virtual ~LLAudioBuffer() {};
 	virtual bool loadWAV(const std::string& filename) = 0;
+	// Same, from a WAV image in memory.  Engines that can't do that return
+	// false and the sound is loaded from its cache file instead.
+	virtual bool loadWAVData(const U8* data, U32 size) { return false; }
 	virtual U32 getLength() = 0;
 
 	friend class LLAudioEngine;
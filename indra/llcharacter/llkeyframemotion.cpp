@@ -60,6 +60,8 @@ static S32 MIN_ITERATION_COUNT = 2;
 static F32 MAX_PIXEL_AREA_CONSTRAINTS = 80000.f;
 static F32 MIN_PIXEL_AREA_CONSTRAINTS = 1000.f;
 static F32 MIN_ACCELERATION_SQUARED = 0.0005f * 0.0005f;
+// Characters covering this many pixels get their animations fetched first
+static F32 MAX_PIXEL_AREA_FETCH = 20000.f;
 
 static F32 MAX_CONSTRAINTS = 10;
 
@@ -528,7 +530,8 @@ LLMotion::LLMotionInitStatus LLKeyframeMotion::onInitialize(LLCharacter *charact
 						LLAssetType::AT_ANIMATION,
 						onLoadComplete,
 						(void *)character_id,
-						FALSE);
+						FALSE,
+						llclamp(mCharacter->getPixelArea() / MAX_PIXEL_AREA_FETCH, 0.f, 1.f));
 
 		return STATUS_HOLD;
 	case ASSET_FETCHED:
@@ -2267,6 +2270,10 @@ void LLKeyframeMotion::onLoadComplete(LLVFS *vfs,
 			}
 			LLVFile file(vfs, asset_uuid, type, LLVFile::READ);
 			S32 size = file.getSize();
+			if (ext_status != LL_EXSTAT_VFS_CACHED && gAssetStorage)
+			{
+				gAssetStorage->reportReceived(type, size);
+			}
 			
 			U8* buffer = new U8[size];
 			file.read((U8*)buffer, size);	/*Flawfinder: ignore*/
@@ -0,0 +1,160 @@
+/**
+ * @file llmappedfile.cpp
+ * @brief Read-only memory mapping of a file
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#if LL_WINDOWS
+#include "llwin32headerslean.h"
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "linden_common.h"
+#include "llmappedfile.h"
+#include "llstring.h"
+
+LLMappedFile::LLMappedFile()
+:	mData(NULL),
+	mSize(0)
+#if LL_WINDOWS
+	, mFile(INVALID_HANDLE_VALUE),
+	mMapping(NULL)
+#endif
+{
+}
+
+LLMappedFile::~LLMappedFile()
+{
+	close();
+}
+
+#if LL_WINDOWS
+
+bool LLMappedFile::open(const std::string& filename)
+{
+	close();
+
+	llutf16string utf16filename = utf8str_to_utf16str(filename);
+	// Let others write and delete the file while it is mapped, as they could
+	// while it was read through a stream.
+	HANDLE file = CreateFileW((LPCWSTR)utf16filename.c_str(), GENERIC_READ,
+							  FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+							  NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+	mFile = file;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || size.QuadPart <= 0 || (U64)size.QuadPart > (U64)SIZE_MAX)
+	{
+		close();
+		return false;
+	}
+
+	mMapping = CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (!mMapping)
+	{
+		close();
+		return false;
+	}
+	mData = (const U8*)MapViewOfFile((HANDLE)mMapping, FILE_MAP_READ, 0, 0, 0);
+	if (!mData)
+	{
+		LL_WARNS() << "Unable to map '" << filename << "', error " << GetLastError() << LL_ENDL;
+		close();
+		return false;
+	}
+	mSize = (size_t)size.QuadPart;
+	return true;
+}
+
+void LLMappedFile::close()
+{
+	if (mData)
+	{
+		UnmapViewOfFile(mData);
+		mData = NULL;
+	}
+	if (mMapping)
+	{
+		CloseHandle((HANDLE)mMapping);
+		mMapping = NULL;
+	}
+	if (mFile != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle((HANDLE)mFile);
+		mFile = INVALID_HANDLE_VALUE;
+	}
+	mSize = 0;
+}
+
+#else // LL_WINDOWS
+
+bool LLMappedFile::open(const std::string& filename)
+{
+	close();
+
+	int fd = ::open(filename.c_str(), O_RDONLY);
+	if (fd < 0)
+	{
+		return false;
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size <= 0)
+	{
+		::close(fd);
+		return false;
+	}
+
+	// The mapping holds its own reference to the file.
+	void* data = ::mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	::close(fd);
+	if (data == MAP_FAILED)
+	{
+		LL_WARNS() << "Unable to map '" << filename << "', errno " << errno << LL_ENDL;
+		return false;
+	}
+	mData = (const U8*)data;
+	mSize = (size_t)st.st_size;
+	return true;
+}
+
+void LLMappedFile::close()
+{
+	if (mData)
+	{
+		::munmap((void*)mData, mSize);
+		mData = NULL;
+	}
+	mSize = 0;
+}
+
+#endif // LL_WINDOWS
@@ -552,7 +552,7 @@ void LLQueuedThread::run()
 		
 		if (isQuitting())
 		{
-			LLTrace::get_thread_recorder()->pushToParent();
+			LLTrace::get_thread_recorder()->pushToParent(true);
 			endThread();
 			break;
 		}
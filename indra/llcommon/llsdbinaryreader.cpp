@@ -0,0 +1,215 @@
+/**
+ * @file llsdbinaryreader.cpp
+ * @brief Reads binary LLSD in place, without building an LLSD tree
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+
+#include "linden_common.h"
+#include "llsdbinaryreader.h"
+
+#include <string.h>
+
+// Deeper than any document the viewer reads; keeps hostile input from
+// exhausting the stack.
+static const U32 MAX_DEPTH = 64;
+
+LLSDBinaryReader::LLSDBinaryReader(const U8* data, size_t size)
+:	mCur(data),
+	mEnd(data + size),
+	mValid(data != NULL)
+{
+}
+
+bool LLSDBinaryReader::readArrayStart(U32& count)
+{
+	// Every entry takes at least a byte, which bounds what a corrupt count
+	// can make the caller allocate.
+	return expect('[') && readU32(count) && (count <= (size_t)(mEnd - mCur) || fail());
+}
+
+bool LLSDBinaryReader::readArrayEnd()
+{
+	return expect(']');
+}
+
+bool LLSDBinaryReader::readMapStart(U32& count)
+{
+	return expect('{') && readU32(count) && (count <= (size_t)(mEnd - mCur) || fail());
+}
+
+bool LLSDBinaryReader::readMapEnd()
+{
+	return expect('}');
+}
+
+bool LLSDBinaryReader::readKey(const char*& key, U32& length)
+{
+	if (!expect('k') || !readLength(length))
+	{
+		return false;
+	}
+	key = (const char*)mCur;
+	mCur += length;
+	return true;
+}
+
+bool LLSDBinaryReader::readBinary(const U8*& data, U32& size)
+{
+	if (!expect('b') || !readLength(size))
+	{
+		return false;
+	}
+	data = mCur;
+	mCur += size;
+	return true;
+}
+
+bool LLSDBinaryReader::readReal(F64& value)
+{
+	char marker = peek();
+	if (marker == 'i')
+	{
+		U32 bits;
+		++mCur;
+		if (!readU32(bits))
+		{
+			return false;
+		}
+		value = (F64)(S32)bits;
+		return true;
+	}
+	if (marker != 'r' || !skipBytes(1) || (size_t)(mEnd - mCur) < sizeof(F64))
+	{
+		return fail();
+	}
+	U64 bits = 0;
+	for (U32 i = 0; i < sizeof(F64); ++i)
+	{
+		bits = (bits << 8) | mCur[i];
+	}
+	mCur += sizeof(F64);
+	memcpy(&value, &bits, sizeof(F64));
+	return true;
+}
+
+bool LLSDBinaryReader::skipValue()
+{
+	return skipValue(0);
+}
+
+//static
+bool LLSDBinaryReader::keyIs(const char* key, U32 length, const char* name)
+{
+	return strlen(name) == length && !memcmp(key, name, length);
+}
+
+bool LLSDBinaryReader::expect(char marker)
+{
+	if (peek() != marker)
+	{
+		return fail();
+	}
+	++mCur;
+	return true;
+}
+
+bool LLSDBinaryReader::readU32(U32& value)
+{
+	if (!mValid || (size_t)(mEnd - mCur) < 4)
+	{
+		return fail();
+	}
+	value = ((U32)mCur[0] << 24) | ((U32)mCur[1] << 16) | ((U32)mCur[2] << 8) | (U32)mCur[3];
+	mCur += 4;
+	return true;
+}
+
+bool LLSDBinaryReader::readLength(U32& length)
+{
+	return readU32(length) && (length <= (size_t)(mEnd - mCur) || fail());
+}
+
+bool LLSDBinaryReader::skipBytes(size_t count)
+{
+	if (!mValid || (size_t)(mEnd - mCur) < count)
+	{
+		return fail();
+	}
+	mCur += count;
+	return true;
+}
+
+bool LLSDBinaryReader::skipValue(U32 depth)
+{
+	U32 count;
+	switch (peek())
+	{
+	case '!':
+	case '0':
+	case '1':
+		return skipBytes(1);
+	case 'i':
+		return skipBytes(1 + 4);
+	case 'r':
+	case 'd':
+		return skipBytes(1 + 8);
+	case 'u':
+		return skipBytes(1 + 16);
+	case 's':
+	case 'l':
+	case 'b':
+		++mCur;
+		return readLength(count) && skipBytes(count);
+	case '[':
+		if (depth >= MAX_DEPTH || !readArrayStart(count))
+		{
+			return fail();
+		}
+		while (count--)
+		{
+			if (!skipValue(depth + 1))
+			{
+				return false;
+			}
+		}
+		return readArrayEnd();
+	case '{':
+		if (depth >= MAX_DEPTH || !readMapStart(count))
+		{
+			return fail();
+		}
+		while (count--)
+		{
+			const char* key;
+			U32 length;
+			if (!readKey(key, length) || !skipValue(depth + 1))
+			{
+				return false;
+			}
+		}
+		return readMapEnd();
+	default:
+		return fail();
+	}
+}
@@ -0,0 +1,89 @@
+/**
+ * @file llsdbinaryreader.h
+ * @brief Reads binary LLSD in place, without building an LLSD tree
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+
+#ifndef LL_LLSDBINARYREADER_H
+#define LL_LLSDBINARYREADER_H
+
+// Walks a buffer of binary LLSD, as written by LLSDBinaryFormatter, without
+// building an LLSD tree. Meant for decoders that pull a few large binary
+// values out of a document: readBinary() points into the buffer instead of
+// copying into an LLSD::Binary, and keys are compared where they lie.
+//
+// The caller follows the document's structure: after readArrayStart() or
+// readMapStart() it reads exactly count entries (a key and a value each for
+// maps), then the matching end marker. Values it has no use for are stepped
+// over with skipValue().
+//
+// Notation-style delimited strings, which LLSDBinaryParser accepts but the
+// binary formatter never writes, are not supported; reads fail on them, as
+// they do on truncated or malformed input. After a failure isValid() is
+// false and every later read fails, so callers may check once at the end.
+class LL_COMMON_API LLSDBinaryReader
+{
+public:
+	LLSDBinaryReader(const U8* data, size_t size);
+
+	bool	isValid() const				{ return mValid; }
+	bool	atEnd() const				{ return mCur >= mEnd; }
+
+	// The type marker of the next value ('{', '[', 'b', 'r', ...), or 0 at
+	// the end of the buffer.
+	char	peek() const				{ return mValid && mCur < mEnd ? (char)*mCur : 0; }
+
+	bool	readArrayStart(U32& count);
+	bool	readArrayEnd();
+	bool	readMapStart(U32& count);
+	bool	readMapEnd();
+
+	// key points into the buffer and is not terminated.
+	bool	readKey(const char*& key, U32& length);
+
+	// data points into the buffer, with no particular alignment.
+	bool	readBinary(const U8*& data, U32& size);
+
+	// Accepts integers too, as LLSD::asReal() would.
+	bool	readReal(F64& value);
+
+	// Steps over one value of any type, containers included.
+	bool	skipValue();
+
+	static bool keyIs(const char* key, U32 length, const char* name);
+
+private:
+	bool	fail()						{ mValid = false; return false; }
+	bool	expect(char marker);
+	bool	readU32(U32& value);
+	bool	readLength(U32& length);
+	bool	skipBytes(size_t count);
+	bool	skipValue(U32 depth);
+
+	const U8*	mCur;
+	const U8*	mEnd;
+	bool		mValid;
+};
+
+#endif // LL_LLSDBINARYREADER_H
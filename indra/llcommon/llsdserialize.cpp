@@ -31,6 +31,7 @@
 #include "llpointer.h"
 #include "llstreamtools.h" // for fullread
 #include "llbase64.h"
+#include "llmemorystream.h"
 
 #include <iostream>
 
@@ -2118,89 +2119,94 @@ std::string zip_llsd(LLSD& data)
 
 // <alchemy>
 //decompress a block of LLSD from provided istream
-// not very efficient -- creats a copy of decompressed LLSD block in memory
-// and deserializes from that copy using LLSDSerialize
 bool unzip_llsd(LLSD& data, std::istream& is, S32 size)
 {
-	U8* result = NULL;
-	U32 cur_size = 0;
-	z_stream strm;
-		
-	const U32 CHUNK = 65536;
+	std::vector<U8> block;
+	if (!unzip_llsd_binary(block, is, size))
+	{
+		return false;
+	}
 
-	U8 *in = new U8[size];
-	is.read((char*) in, size); 
+	if (!block.empty())
+	{
+		LLMemoryStream istr(&block[0], block.size());
+		if (LLSDSerialize::fromBinary(data, istr, block.size()))
+		{
+			return true;
+		}
+	}
+	LL_WARNS() << "Failed to unzip LLSD block" << LL_ENDL;
+	return false;
+}
 
-	U8 out[CHUNK];
-		
+bool unzip_llsd_binary(std::vector<U8>& block, std::istream& is, S32 size)
+{
+	block.clear();
+	if (size <= 0)
+	{
+		return false;
+	}
+
+	std::vector<U8> in(size);
+	is.read((char*) &in[0], size); 
+
+	z_stream strm;
 	strm.zalloc = Z_NULL;
 	strm.zfree = Z_NULL;
 	strm.opaque = Z_NULL;
 	strm.avail_in = size;
-	strm.next_in = in;
+	strm.next_in = &in[0];
 
-	S32 ret = inflateInit(&strm);
-	
+	if (inflateInit(&strm) != Z_OK)
+	{
+		return false;
+	}
+
+	// Inflate straight into the result, growing it as needed; LLSD blocks
+	// compress to about a third of their size.
+	const U32 CHUNK = 65536;
+	block.resize(llmax((U32) size * 4, CHUNK));
+	U32 cur_size = 0;
+	S32 ret;
 	do
 	{
-		strm.avail_out = CHUNK;
-		strm.next_out = out;
+		if (cur_size == block.size())
+		{
+			block.resize(block.size() * 2);
+		}
+		strm.avail_out = block.size() - cur_size;
+		strm.next_out = &block[cur_size];
 		ret = inflate(&strm, Z_NO_FLUSH);
+		cur_size = block.size() - strm.avail_out;
 		
 		switch (ret)
 		{
 		case Z_NEED_DICT:
-			ret = Z_DATA_ERROR;
 		case Z_DATA_ERROR:
 		case Z_MEM_ERROR:
 		case Z_STREAM_ERROR:
 			inflateEnd(&strm);
-			free(result);
-			delete [] in;
+			block.clear();
 			return false;
-			break;
 		}
-
-		U32 have = CHUNK-strm.avail_out;
-
-		result = (U8*) realloc(result, cur_size + have);
-		memcpy(result+cur_size, out, have);
-		cur_size += have;
-
 	} while (ret == Z_OK);
 
 	inflateEnd(&strm);
-	delete [] in;
 
 	if (ret != Z_STREAM_END)
 	{
-		free(result);
+		block.clear();
 		return false;
 	}
+	block.resize(cur_size);
 
-	//result now points to the decompressed LLSD block
+	static const std::string deprecated_header("<? LLSD/Binary ?>");
+	if (cur_size >= deprecated_header.size()
+		&& !memcmp(&block[0], deprecated_header.data(), deprecated_header.size()))
 	{
-		std::string res_str((char*) result, cur_size);
-
-		std::string deprecated_header("<? LLSD/Binary ?>");
-
-		if (res_str.substr(0, deprecated_header.size()) == deprecated_header)
-		{
-			res_str = res_str.substr(deprecated_header.size()+1, cur_size);
-		}
-		cur_size = res_str.size();
-
-		std::istringstream istr(res_str);
-		
-		if (!LLSDSerialize::fromBinary(data, istr, cur_size))
-		{
-			LL_WARNS() << "Failed to unzip LLSD block" << LL_ENDL;
-			free(result);
-			return false;
-		}		
+		// The header is followed by a newline.
+		block.erase(block.begin(), block.begin() + llmin((U32) deprecated_header.size() + 1, cur_size));
 	}
-
-	free(result);
 	return true;
 }
 
@@ -817,5 +817,8 @@ public:
 //dirty little zip functions -- yell at davep
 LL_COMMON_API std::string zip_llsd(LLSD& data);
 LL_COMMON_API bool unzip_llsd(LLSD& data, std::istream& is, S32 size);
+// Inflates a block written by zip_llsd into block without parsing it, for
+// decoders that walk the binary LLSD themselves (see LLSDBinaryReader).
+LL_COMMON_API bool unzip_llsd_binary(std::vector<U8>& block, std::istream& is, S32 size);
 LL_COMMON_API U8* unzip_llsdNavMesh( bool& valid, unsigned int& outsize,std::istream& is, S32 size);
 #endif // LL_LLSDSERIALIZE_H
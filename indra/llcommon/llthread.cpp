@@ -102,7 +102,7 @@ void LLThread::runWrapper()
 #endif
 
 	// for now, hard code all LLThreads to report to single master thread recorder, which is known to be running on main thread
-	mRecorder = new LLTrace::ThreadRecorder(*LLTrace::get_master_thread_recorder());
+	mRecorder = new LLTrace::ThreadRecorder(*LLTrace::get_master_thread_recorder(), mName);
 
 	// Run the user supplied function
 	run();
@@ -35,12 +35,19 @@ extern MemStatHandle gTraceMemStat;
 
 static ThreadRecorder* sMasterThreadRecorder = NULL;
 
+// Pushing copies every accumulator, so busy threads only do it this often.
+static const F32 PUSH_INTERVAL = 0.01f;
+
+// Weight of the latest frame in the smoothed child thread times.
+static const F64 CHILD_TIME_SMOOTHING = 0.1;
+
 ///////////////////////////////////////////////////////////////////////
 // ThreadRecorder
 ///////////////////////////////////////////////////////////////////////
 
 ThreadRecorder::ThreadRecorder()
-:	mParentRecorder(NULL)
+:	mSharedReady(0),
+	mParentRecorder(NULL)
 {
 	init();
 }
@@ -88,8 +95,10 @@ void ThreadRecorder::init()
 }
 
 
-ThreadRecorder::ThreadRecorder( ThreadRecorder& parent )
-:	mParentRecorder(&parent)
+ThreadRecorder::ThreadRecorder( ThreadRecorder& parent, const std::string& name )
+:	mSharedReady(0),
+	mParentRecorder(&parent),
+	mName(name.empty() ? std::string("Unnamed thread") : name)
 {
 	init();
 	mParentRecorder->addChildRecorder(this);
@@ -258,18 +267,40 @@ void ThreadRecorder::removeChildRecorder( class ThreadRecorder* child )
 #if LL_TRACE_ENABLED
 	{ LLMutexLock lock(&mChildListMutex);
 		mChildThreadRecorders.remove(child);
+		// The child is gone before the next pull; keep what it pushed last.
+		if (child->mSharedReady)
+		{
+			mExitedChildRecordings.push_back(child->mSharedRecordingBuffers);
+		}
 	}
 #endif
 }
 
-void ThreadRecorder::pushToParent()
+void ThreadRecorder::pushToParent(bool force)
 {
 #if LL_TRACE_ENABLED
-	{ LLMutexLock lock(&mSharedRecordingMutex);	
-		LLTrace::get_thread_recorder()->bringUpToDate(&mThreadRecordingBuffers);
-		mSharedRecordingBuffers.append(mThreadRecordingBuffers);
-		mThreadRecordingBuffers.reset();
+	if (!force && (mSharedReady || mPushTimer.getElapsedTimeF32() < PUSH_INTERVAL))
+	{
+		return;
+	}
+	mPushTimer.reset();
+
+	LLTrace::get_thread_recorder()->bringUpToDate(&mThreadRecordingBuffers);
+	if (mSharedReady)
+	{
+		// Only forced pushes get here.  If the parent collects the pending
+		// push while we wait for the lock, the buffers are ours again.
+		LLMutexLock lock(&mSharedRecordingMutex);
+		if (mSharedReady)
+		{
+			mSharedRecordingBuffers.append(mThreadRecordingBuffers);
+			mThreadRecordingBuffers.reset();
+			return;
+		}
 	}
+	mSharedRecordingBuffers.append(mThreadRecordingBuffers);
+	mThreadRecordingBuffers.reset();
+	mSharedReady = 1;
 #endif
 }
 
@@ -286,13 +317,70 @@ void ThreadRecorder::pullFromChildren()
 
 		AccumulatorBufferGroup& target_recording_buffers = mActiveRecordings.back()->mPartialRecording;
 		target_recording_buffers.sync();
+		for (std::vector<AccumulatorBufferGroup>::const_iterator it = mExitedChildRecordings.begin(); it != mExitedChildRecordings.end(); ++it)
+		{
+			target_recording_buffers.merge(*it);
+		}
+		mExitedChildRecordings.clear();
+
+		const F64 counts_per_second = (F64)BlockTimer::countsPerSecond();
 		for (child_thread_recorder_list_t::iterator it = mChildThreadRecorders.begin(), end_it = mChildThreadRecorders.end();
 			it != end_it;
 			++it)
-		{ LLMutexLock lock(&(*it)->mSharedRecordingMutex);
+		{
+			ThreadRecorder* child = *it;
+			bool pushed = child->mSharedReady != 0;
+			// Only contended by a forced push from the child.
+			LLMutexLock lock(pushed ? &child->mSharedRecordingMutex : NULL);
+			if (pushed)
+			{
+				target_recording_buffers.merge(child->mSharedRecordingBuffers);
+			}
+
+			// Smooth per frame, counting frames the child pushed nothing in
+			// as idle.  The child's buffers are only read once it has
+			// handed them over.
+			const AccumulatorBuffer<TimeBlockAccumulator>& timers = child->mSharedRecordingBuffers.mStackTimers;
+			size_t num_timers = target_recording_buffers.mStackTimers.size();
+			size_t num_pushed = pushed ? timers.size() : 0;
+			child->mFrameTimes.resize(num_timers, 0.0);
+			child->mFrameCalls.resize(num_timers, 0.f);
+			for (size_t i = 0; i < num_timers; i++)
+			{
+				F64 time = i < num_pushed ? (F64)timers[i].mTotalTimeCounter / counts_per_second : 0.0;
+				F32 calls = i < num_pushed ? (F32)timers[i].mCalls : 0.f;
+				child->mFrameTimes[i] += (time - child->mFrameTimes[i]) * CHILD_TIME_SMOOTHING;
+				child->mFrameCalls[i] += (calls - child->mFrameCalls[i]) * (F32)CHILD_TIME_SMOOTHING;
+			}
+
+			if (pushed)
+			{
+				child->mSharedRecordingBuffers.reset();
+				child->mSharedReady = 0;
+			}
+		}
+	}
+#endif
+}
 
-			target_recording_buffers.merge((*it)->mSharedRecordingBuffers);
-			(*it)->mSharedRecordingBuffers.reset();
+void ThreadRecorder::getChildThreadTimes(const BlockTimerStatHandle& timer, child_thread_time_list_t& times)
+{
+	times.clear();
+#if LL_TRACE_ENABLED
+	LLMutexLock lock(&mChildListMutex);
+	size_t index = timer.getIndex();
+	for (child_thread_recorder_list_t::iterator it = mChildThreadRecorders.begin(), end_it = mChildThreadRecorders.end();
+		it != end_it;
+		++it)
+	{
+		ThreadRecorder* child = *it;
+		if (index < child->mFrameTimes.size() && child->mFrameCalls[index] > 0.f)
+		{
+			ChildThreadTime time;
+			time.mName = child->mName;
+			time.mTime = F64Seconds(child->mFrameTimes[index]);
+			time.mCalls = child->mFrameCalls[index];
+			times.push_back(time);
 		}
 	}
 #endif
@@ -30,7 +30,9 @@
 #include "stdtypes.h"
 #include "llpreprocessor.h"
 
+#include "llatomic.h"
 #include "llmutex.h"
+#include "lltimer.h"
 #include "lltraceaccumulators.h"
 #include "llthreadlocalstorage.h"
 
@@ -43,7 +45,7 @@ namespace LLTrace
 		typedef std::vector<ActiveRecording*> active_recording_list_t;
 	public:
 		ThreadRecorder();
-		explicit ThreadRecorder(ThreadRecorder& parent);
+		explicit ThreadRecorder(ThreadRecorder& parent, const std::string& name = std::string());
 
 		~ThreadRecorder();
 
@@ -56,7 +58,24 @@ namespace LLTrace
 
 		// call this periodically to gather stats data from child threads
 		void pullFromChildren();
-		void pushToParent();
+		// Hands what this thread recorded since the last push over to the
+		// parent, at most every PUSH_INTERVAL unless forced.  Never blocks
+		// unless forced: if the parent has not picked up the previous push
+		// yet, the data stays here until the next one.  A forced push, as
+		// at thread exit, is added to the pending one under a lock instead.
+		void pushToParent(bool force = false);
+
+		struct ChildThreadTime
+		{
+			std::string	mName;
+			F64Seconds	mTime;		// per frame, smoothed
+			F32			mCalls;
+		};
+		typedef std::vector<ChildThreadTime> child_thread_time_list_t;
+		// Time each child thread spends in timer per frame.  Child thread
+		// timers are kept out of this thread's recordings, where they would
+		// overlap the frame.  Call on the thread that pulls from children.
+		void getChildThreadTimes(const BlockTimerStatHandle& timer, child_thread_time_list_t& times);
 
 		TimeBlockTreeNode* getTimeBlockTreeNode(S32 index);
 
@@ -85,11 +104,28 @@ namespace LLTrace
 		typedef std::list<class ThreadRecorder*> child_thread_recorder_list_t;
 
 		child_thread_recorder_list_t	mChildThreadRecorders;	// list of child thread recorders associated with this master
-		LLMutex							mChildListMutex;		// protects access to child list
-		LLMutex							mSharedRecordingMutex;
+		LLMutex							mChildListMutex;		// protects access to child list, taken by children only when they start and stop
+
+		// Handoff to the parent: the child fills mSharedRecordingBuffers
+		// and sets mSharedReady, the parent merges them and clears it.
+		// Whoever does not own the buffers leaves them alone, except for
+		// forced pushes, which append to a pending push under
+		// mSharedRecordingMutex while the parent merges under it.
 		AccumulatorBufferGroup			mSharedRecordingBuffers;
+		LLAtomicU32						mSharedReady;
+		LLMutex							mSharedRecordingMutex;
+		LLTimer							mPushTimer;
 		ThreadRecorder*					mParentRecorder;
 
+		// Pushes children left pending when they went away, merged on the
+		// next pull.  Under mChildListMutex.
+		std::vector<AccumulatorBufferGroup>	mExitedChildRecordings;
+
+		// Kept by the parent, under its mChildListMutex
+		std::string						mName;
+		std::vector<F64>				mFrameTimes;			// smoothed, in seconds, by timer index
+		std::vector<F32>				mFrameCalls;
+
 	};
 
 	const LLThreadLocalPointer<ThreadRecorder>& get_thread_recorder();
@@ -0,0 +1,245 @@
+/**
+ * @file llworkerpool.cpp
+ * @brief Small fixed pool of threads for fork/join batches of independent jobs
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llworkerpool.h"
+
+#include <boost/bind.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "llatomic.h"
+#include "llthread.h"
+
+// More than this rarely helps the batches we run, and leaves cores for the
+// texture, mesh and HTTP threads.
+static const U32 MAX_DEFAULT_POOL_THREADS = 8;
+
+LLWorkerPool* LLWorkerPool::sDefaultPool = NULL;
+
+class LLWorkerPool::Worker : public LLThread
+{
+public:
+	Worker(const std::string& name, LLWorkerPool* pool)
+	:	LLThread(name),
+		mPool(pool)
+	{
+	}
+
+	~Worker()
+	{
+		// Wait for run() to return while this is still a Worker; a thread
+		// that only just started could otherwise call into a half
+		// destroyed object.
+		shutdown();
+	}
+
+protected:
+	/*virtual*/ void run()
+	{
+		while (mPool->runOneJob())
+		{
+		}
+	}
+
+private:
+	LLWorkerPool* mPool;
+};
+
+namespace
+{
+	// One parallelFor() call. Chunks are claimed through mNext, so whoever
+	// runs a chunk, the caller or a pool thread, only ever runs chunks of this
+	// batch. Shared with the queued jobs so that those still queued after the
+	// caller has been released find nothing left and return.
+	struct LLWorkerPoolBatch
+	{
+		const LLWorkerPool::range_job_t* mFn;	// only valid while chunks remain
+		U32			mCount;
+		U32			mGrain;
+		U32			mNumChunks;
+		LLAtomicU32	mNext;
+		LLAtomicU32	mRemaining;
+		LLCondition	mDone;
+	};
+
+	// Claims and runs one chunk. Returns false when all have been claimed.
+	bool run_chunk(LLWorkerPoolBatch* batch)
+	{
+		U32 chunk = batch->mNext++;
+		if (chunk >= batch->mNumChunks)
+		{
+			return false;
+		}
+		U32 begin = chunk * batch->mGrain;
+		(*batch->mFn)(begin, llmin(begin + batch->mGrain, batch->mCount));
+		if (--batch->mRemaining == 0)
+		{
+			LLMutexLock lock(&batch->mDone);
+			batch->mDone.broadcast();
+		}
+		return true;
+	}
+
+	void run_chunks(boost::shared_ptr<LLWorkerPoolBatch> batch)
+	{
+		while (run_chunk(batch.get()))
+		{
+		}
+	}
+}
+
+LLWorkerPool::LLWorkerPool(const std::string& name, U32 num_threads)
+:	mName(name),
+	mQuitting(false)
+{
+	for (U32 i = 0; i < num_threads; ++i)
+	{
+		Worker* worker = new Worker(llformat("%s %d", name.c_str(), i), this);
+		worker->start();
+		mWorkers.push_back(worker);
+	}
+	LL_INFOS() << "Started worker pool " << name << " with " << num_threads << " threads" << LL_ENDL;
+}
+
+LLWorkerPool::~LLWorkerPool()
+{
+	mQueueCondition.lock();
+	mQuitting = true;
+	// Let the threads finish what they're running, but not start anything else.
+	mJobs.clear();
+	mQueueCondition.broadcast();
+	mQueueCondition.unlock();
+
+	for (std::vector<Worker*>::iterator it = mWorkers.begin(); it != mWorkers.end(); ++it)
+	{
+		delete *it;
+	}
+	mWorkers.clear();
+}
+
+void LLWorkerPool::post(const job_t& job)
+{
+	if (mWorkers.empty())
+	{
+		job();
+		return;
+	}
+
+	LLMutexLock lock(&mQueueCondition);
+	mJobs.push_back(job);
+	mQueueCondition.signal();
+}
+
+void LLWorkerPool::parallelFor(U32 count, U32 grain, const range_job_t& fn)
+{
+	if (!count)
+	{
+		return;
+	}
+	grain = llmax(grain, 1U);
+
+	if (mWorkers.empty() || count <= grain)
+	{
+		fn(0, count);
+		return;
+	}
+
+	boost::shared_ptr<LLWorkerPoolBatch> batch = boost::make_shared<LLWorkerPoolBatch>();
+	batch->mFn = &fn;
+	batch->mCount = count;
+	batch->mGrain = grain;
+	batch->mNumChunks = (count + grain - 1) / grain;
+	batch->mNext = 0;
+	batch->mRemaining = batch->mNumChunks;
+
+	// One job per thread that could help; each runs chunks until none are
+	// left. The caller is one of the helpers.
+	U32 num_jobs = llmin(batch->mNumChunks - 1, (U32)mWorkers.size());
+	{
+		LLMutexLock lock(&mQueueCondition);
+		for (U32 i = 0; i < num_jobs; ++i)
+		{
+			mJobs.push_back(boost::bind(&run_chunks, batch));
+		}
+		mQueueCondition.broadcast();
+	}
+
+	// Help out rather than sleep, but only with this batch: anything else
+	// queued, post()ed jobs included, is left to the pool threads. Then
+	// wait for the chunks still running there.
+	while (run_chunk(batch.get()))
+	{
+	}
+
+	LLMutexLock lock(&batch->mDone);
+	while (batch->mRemaining > 0)
+	{
+		batch->mDone.wait();
+	}
+}
+
+// Pops and runs one job, sleeping until there is one. Returns false when
+// the pool is shutting down.
+bool LLWorkerPool::runOneJob()
+{
+	job_t job;
+	{
+		LLMutexLock lock(&mQueueCondition);
+		while (mJobs.empty() && !mQuitting)
+		{
+			mQueueCondition.wait();
+		}
+		if (mJobs.empty())
+		{
+			return false;
+		}
+		job.swap(mJobs.front());
+		mJobs.pop_front();
+	}
+	job();
+	return true;
+}
+
+// static
+LLWorkerPool* LLWorkerPool::getDefault()
+{
+	if (!sDefaultPool)
+	{
+		U32 cores = boost::thread::hardware_concurrency();
+		U32 num_threads = llclamp(cores, 2U, MAX_DEFAULT_POOL_THREADS + 1) - 1;
+		sDefaultPool = new LLWorkerPool("Worker Pool", num_threads);
+	}
+	return sDefaultPool;
+}
+
+// static
+void LLWorkerPool::cleanupDefault()
+{
+	delete sDefaultPool;
+	sDefaultPool = NULL;
+}
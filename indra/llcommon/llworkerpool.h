@@ -0,0 +1,88 @@
+/**
+ * @file llworkerpool.h
+ * @brief Small fixed pool of threads for fork/join batches of independent jobs
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLWORKERPOOL_H
+#define LL_LLWORKERPOOL_H
+
+#include <deque>
+#include <string>
+#include <vector>
+
+#include <boost/function.hpp>
+
+#include "llmutex.h"
+
+// A fixed set of threads draining one job queue. Unlike LLWorkerThread and
+// LLQueuedThread, which run long-lived prioritized requests on a single
+// thread, this is meant for splitting one batch of work across cores and
+// waiting for it: parallelFor() returns once every chunk has run. The
+// calling thread runs chunks of its own batch while it waits, never other
+// queued jobs, so a long post()ed job cannot land on it, and a pool with no
+// threads simply runs everything inline.
+//
+// Jobs must not touch state owned by the main thread (the message system,
+// the object list, GL, ...) unless that state is otherwise locked.
+class LL_COMMON_API LLWorkerPool
+{
+public:
+	typedef boost::function<void ()> job_t;
+	typedef boost::function<void (U32 begin, U32 end)> range_job_t;
+
+	LLWorkerPool(const std::string& name, U32 num_threads);
+	~LLWorkerPool();
+
+	U32		getNumThreads() const	{ return (U32)mWorkers.size(); }
+
+	// Calls fn on consecutive sub-ranges of [0, count), each at most grain
+	// long, spread over the pool. Returns when all of them have returned.
+	void	parallelFor(U32 count, U32 grain, const range_job_t& fn);
+
+	// Queues a job and returns immediately. The job is responsible for
+	// handing its results back (e.g. through an LLThreadSafeQueue). Jobs
+	// still queued when the pool is destroyed are dropped without running.
+	void	post(const job_t& job);
+
+	// Pool shared by viewer subsystems, one thread per core beyond the
+	// first. Created on first use.
+	static LLWorkerPool* getDefault();
+	static void cleanupDefault();
+
+private:
+	class Worker;
+	friend class Worker;
+
+	bool	runOneJob();
+
+	std::string			mName;
+	std::vector<Worker*> mWorkers;
+	LLCondition			mQueueCondition;	// guards mJobs and mQuitting
+	std::deque<job_t>	mJobs;
+	bool				mQuitting;
+
+	static LLWorkerPool* sDefaultPool;
+};
+
+#endif // LL_LLWORKERPOOL_H
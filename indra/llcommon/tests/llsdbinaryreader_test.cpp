@@ -0,0 +1,274 @@
+/**
+ * @file llsdbinaryreader_test.cpp
+ * @brief Tests for LLSDBinaryReader.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+
+#include "linden_common.h"
+
+#include <sstream>
+#include <string>
+
+#include "../llsdbinaryreader.h"
+#include "../llsd.h"
+#include "../llsdserialize.h"
+
+#include "../test/lltut.h"
+
+namespace
+{
+	std::string format_binary(const LLSD& sd)
+	{
+		std::ostringstream ostr;
+		LLPointer<LLSDBinaryFormatter> formatter = new LLSDBinaryFormatter();
+		formatter->format(sd, ostr);
+		return ostr.str();
+	}
+
+	void append_u32(std::string& out, U32 value)
+	{
+		out += (char)(value >> 24);
+		out += (char)(value >> 16);
+		out += (char)(value >> 8);
+		out += (char)value;
+	}
+
+	// count nested one element arrays around an integer.
+	std::string nested_arrays(U32 count)
+	{
+		std::string out;
+		for (U32 i = 0; i < count; ++i)
+		{
+			out += '[';
+			append_u32(out, 1);
+		}
+		out += 'i';
+		append_u32(out, 7);
+		out.append(count, ']');
+		return out;
+	}
+
+	LLSDBinaryReader make_reader(const std::string& buffer)
+	{
+		return LLSDBinaryReader((const U8*)buffer.data(), buffer.size());
+	}
+}
+
+namespace tut
+{
+	struct sdbinaryreader_data
+	{
+		sdbinaryreader_data()
+		{
+			LLSD::Binary blob;
+			for (S32 i = 0; i < 300; ++i)
+			{
+				blob.push_back((U8)(i * 7));
+			}
+			mBlob = blob;
+
+			LLSD array;
+			array.append(LLSD());
+			array.append(true);
+			array.append(false);
+			array.append(LLSD::Integer(-3));
+			array.append(LLSD::String("text"));
+			array.append(LLUUID::generateNewID());
+			array.append(LLDate(1234567.0));
+			array.append(LLURI("http://example.com/"));
+			array.append(LLSD::emptyMap());
+
+			mDoc["Blob"] = mBlob;
+			mDoc["Real"] = 2.5;
+			mDoc["Int"] = 42;
+			mDoc["Skipped"] = array;
+			mDoc["Nested"]["Inner"] = LLSD::emptyArray();
+
+			mBuffer = format_binary(mDoc);
+		}
+
+		LLSD		mDoc;
+		LLSD		mBlob;
+		std::string	mBuffer;
+	};
+	typedef test_group<sdbinaryreader_data> sdbinaryreader_test;
+	typedef sdbinaryreader_test::object sdbinaryreader_object;
+	tut::sdbinaryreader_test tut_sdbinaryreader_test("LLSDBinaryReader");
+
+	template<> template<>
+	void sdbinaryreader_object::test<1>()
+	{
+		set_test_name("Round trip with LLSDBinaryFormatter");
+		LLSDBinaryReader reader = make_reader(mBuffer);
+		U32 count = 0;
+		ensure("map start", reader.readMapStart(count));
+		ensure_equals("map size", count, (U32)mDoc.size());
+
+		bool saw_blob = false, saw_real = false, saw_int = false;
+		for (U32 i = 0; i < count; ++i)
+		{
+			const char* key;
+			U32 length;
+			ensure("key", reader.readKey(key, length));
+			if (LLSDBinaryReader::keyIs(key, length, "Blob"))
+			{
+				const U8* data;
+				U32 size;
+				ensure("binary", reader.readBinary(data, size));
+				const LLSD::Binary& blob = mBlob.asBinary();
+				ensure_equals("binary size", size, (U32)blob.size());
+				ensure("binary bytes", !memcmp(data, &blob[0], size));
+				saw_blob = true;
+			}
+			else if (LLSDBinaryReader::keyIs(key, length, "Real"))
+			{
+				F64 value;
+				ensure("real", reader.readReal(value));
+				ensure_equals("real value", value, 2.5);
+				saw_real = true;
+			}
+			else if (LLSDBinaryReader::keyIs(key, length, "Int"))
+			{
+				F64 value;
+				ensure("integer as real", reader.readReal(value));
+				ensure_equals("integer value", value, 42.0);
+				saw_int = true;
+			}
+			else
+			{
+				ensure("skip", reader.skipValue());
+			}
+		}
+		ensure("map end", reader.readMapEnd());
+		ensure("whole buffer read", reader.atEnd());
+		ensure("still valid", reader.isValid());
+		ensure("every value found", saw_blob && saw_real && saw_int);
+	}
+
+	template<> template<>
+	void sdbinaryreader_object::test<2>()
+	{
+		set_test_name("Truncated documents fail without overreading");
+		for (size_t size = 0; size < mBuffer.size(); ++size)
+		{
+			// A copy of exactly size bytes, so that overreads show up under
+			// memory checkers.
+			std::string truncated(mBuffer, 0, size);
+			LLSDBinaryReader reader = make_reader(truncated);
+			ensure("truncated document rejected", !reader.skipValue());
+			ensure("reader invalid", !reader.isValid());
+			ensure_equals("no marker after failure", reader.peek(), (char)0);
+		}
+	}
+
+	template<> template<>
+	void sdbinaryreader_object::test<3>()
+	{
+		set_test_name("Lengths and counts beyond the buffer");
+		std::string binary("b");
+		append_u32(binary, 0xFFFFFFF0);
+		binary += "abc";
+		LLSDBinaryReader binary_reader = make_reader(binary);
+		const U8* data;
+		U32 size;
+		ensure("oversized binary rejected", !binary_reader.readBinary(data, size));
+
+		std::string array("[");
+		append_u32(array, 0x7FFFFFFF);
+		array += "]";
+		LLSDBinaryReader array_reader = make_reader(array);
+		U32 count;
+		ensure("oversized array count rejected", !array_reader.readArrayStart(count));
+
+		std::string map("{");
+		append_u32(map, 1000);
+		map += "}";
+		LLSDBinaryReader map_reader = make_reader(map);
+		ensure("oversized map count rejected", !map_reader.readMapStart(count));
+
+		std::string key("{");
+		append_u32(key, 1);
+		key += 'k';
+		append_u32(key, 100);
+		key += "Blob}";
+		LLSDBinaryReader key_reader = make_reader(key);
+		const char* name;
+		U32 length;
+		ensure("map start", key_reader.readMapStart(count));
+		ensure("oversized key rejected", !key_reader.readKey(name, length));
+		ensure("later reads fail", !key_reader.readMapEnd());
+	}
+
+	template<> template<>
+	void sdbinaryreader_object::test<4>()
+	{
+		set_test_name("Nesting depth");
+		std::string shallow = nested_arrays(64);
+		LLSDBinaryReader shallow_reader = make_reader(shallow);
+		ensure("64 levels skipped", shallow_reader.skipValue());
+		ensure("64 levels consumed", shallow_reader.atEnd());
+
+		std::string deep = nested_arrays(65);
+		LLSDBinaryReader deep_reader = make_reader(deep);
+		ensure("65 levels rejected", !deep_reader.skipValue());
+		ensure("reader invalid", !deep_reader.isValid());
+
+		std::string hostile = nested_arrays(100000);
+		LLSDBinaryReader hostile_reader = make_reader(hostile);
+		ensure("deep nesting rejected", !hostile_reader.skipValue());
+	}
+
+	template<> template<>
+	void sdbinaryreader_object::test<5>()
+	{
+		set_test_name("Notation-style strings fail so callers fall back");
+		// LLSDBinaryParser accepts these, but the binary formatter never
+		// writes them.
+		std::string value("{");
+		append_u32(value, 1);
+		value += 'k';
+		append_u32(value, 4);
+		value += "Name\"quoted\"}";
+		LLSDBinaryReader value_reader = make_reader(value);
+		U32 count;
+		const char* key;
+		U32 length;
+		ensure("map start", value_reader.readMapStart(count));
+		ensure("key", value_reader.readKey(key, length));
+		ensure("delimited string value rejected", !value_reader.skipValue());
+		ensure("reader invalid", !value_reader.isValid());
+
+		std::string quoted_key("{");
+		append_u32(quoted_key, 1);
+		quoted_key += "'Name'i";
+		append_u32(quoted_key, 1);
+		quoted_key += '}';
+		LLSDBinaryReader key_reader = make_reader(quoted_key);
+		ensure("map start", key_reader.readMapStart(count));
+		ensure("delimited key rejected", !key_reader.readKey(key, length));
+
+		LLSDBinaryReader skip_reader = make_reader(quoted_key);
+		ensure("delimited key rejected when skipping", !skip_reader.skipValue());
+	}
+}
@@ -38,6 +38,8 @@
 
 #include "lltimer.h"
 #include "llthread.h"
+#include "llfasttimer.h"
+#include "lltracethreadrecorder.h"
 
 
 namespace
@@ -284,22 +286,46 @@ void HttpService::shutdown()
 // layer pieces and then either sleeps for a small time
 // or waits for a request to come in.  Repeats until
 // requested to stop.
+static LLTrace::BlockTimerStatHandle FTM_HTTP_REQUEST_QUEUE("HTTP Request Queue");
+static LLTrace::BlockTimerStatHandle FTM_HTTP_READY_QUEUE("HTTP Ready Queue");
+static LLTrace::BlockTimerStatHandle FTM_HTTP_TRANSPORT("HTTP Transport");
+
 void HttpService::threadRun(LLCoreInt::HttpThread * thread)
 {
 	boost::this_thread::disable_interruption di;
+
+	// Not an LLThread, so report timers to the main thread ourselves.
+	LLTrace::ThreadRecorder* recorder = NULL;
+	if (LLTrace::get_master_thread_recorder())
+	{
+		recorder = new LLTrace::ThreadRecorder(*LLTrace::get_master_thread_recorder(), "HTTP Service");
+	}
 	
 	ELoopSpeed loop(REQUEST_SLEEP);
 	while (! mExitRequested)
 	{
 		loop = processRequestQueue(loop);
 
-		// Process ready queue issuing new requests as needed
-		ELoopSpeed new_loop = mPolicy->processReadyQueue();
-		loop = (std::min)(loop, new_loop);
+		ELoopSpeed new_loop;
+		{
+			// Process ready queue issuing new requests as needed
+			LL_RECORD_BLOCK_TIME(FTM_HTTP_READY_QUEUE);
+			new_loop = mPolicy->processReadyQueue();
+			loop = (std::min)(loop, new_loop);
+		}
 		
-		// Give libcurl some cycles
-		new_loop = mTransport->processTransport();
-		loop = (std::min)(loop, new_loop);
+		{
+			// Give libcurl some cycles
+			LL_RECORD_BLOCK_TIME(FTM_HTTP_TRANSPORT);
+			new_loop = mTransport->processTransport();
+			loop = (std::min)(loop, new_loop);
+		}
+
+		if (recorder)
+		{
+			// Going to wait for the next request, which may be a while.
+			recorder->pushToParent(REQUEST_SLEEP == loop);
+		}
 		
 		// Determine whether to spin, sleep briefly or sleep for next request
 		if (REQUEST_SLEEP != loop)
@@ -309,6 +335,7 @@ void HttpService::threadRun(LLCoreInt::HttpThread * thread)
 	}
 
 	shutdown();
+	delete recorder;
 	sState = STOPPED;
 }
 
@@ -319,6 +346,7 @@ HttpService::ELoopSpeed HttpService::processRequestQueue(ELoopSpeed loop)
 	const bool wait_for_req(REQUEST_SLEEP == loop);
 	
 	mRequestQueue->fetchAll(wait_for_req, ops);
+	LL_RECORD_BLOCK_TIME(FTM_HTTP_REQUEST_QUEUE);
 	while (! ops.empty())
 	{
 		HttpOperation::ptr_t op(ops.front());
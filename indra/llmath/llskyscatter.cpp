@@ -0,0 +1,353 @@
+/**
+ * @file llskyscatter.cpp
+ * @brief CPU evaluation of the WindLight sky colour
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+
+#include "linden_common.h"
+
+#include "llskyscatter.h"
+
+#include "llmath.h"
+#include "llvector4a.h"
+
+static const LLColor3 DARK_BROWN(0.082f, 0.076f, 0.066f);
+static const LLColor3 BROWN(0.430f, 0.386f, 0.322f);
+
+// Colour saturation of the environment map.
+static const F32 SHINY_SATURATION = 0.3f;
+
+LLSkyScatter::LLSkyScatter(const Params& params)
+:	mDomeRadius(params.dome_radius),
+	mDomeOffset(params.dome_offset_ratio),
+	mMaxY(params.max_y),
+	mDensity(params.density_multiplier),
+	mGlowScale(params.glow.mV[0]),
+	mGlowExponent(params.glow.mV[2]),
+	mCloudSunlight(1.f - params.cloud_shadow),
+	mWindLightShaders(params.windlight_shaders)
+{
+	// The sun as seen from the top of the dome lights the ground below the
+	// horizon.
+	F32 top_inv_y = 1.f / llmax(0.f, params.lightnorm.mV[1] * 2.f);
+
+	for (S32 i = 0; i < 3; ++i)
+	{
+		mLightNorm[i] = params.lightnorm.mV[i];
+
+		mSunlight[i] = params.sunlight_color.mV[i];
+		mLightAtten[i] = (params.blue_density.mV[i] + params.haze_density * 0.25f)
+						 * (params.density_multiplier * params.max_y);
+		mExtinction[i] = params.blue_density.mV[i] + params.haze_density;
+		mBlueWeight[i] = params.blue_horizon.mV[i] * params.blue_density.mV[i] / mExtinction[i];
+		mHazeWeight[i] = params.haze_horizon * params.haze_density / mExtinction[i];
+		mAmbient[i] = params.ambient.mV[i];
+		mCloudAmbient[i] = mAmbient[i] + (1.f - mAmbient[i]) * params.cloud_shadow * 0.5f;
+		mGroundLight[i] = mSunlight[i] * expf(-mLightAtten[i] * top_inv_y) + mAmbient[i];
+	}
+
+	mFogSky[0] = llmax(params.fog_color.mV[0], 0.2f);
+	mFogSky[1] = llmax(params.fog_color.mV[1], 0.2f);
+	mFogSky[2] = llmax(params.fog_color.mV[2], 0.22f);
+
+	LLColor3 desat_fog(params.fog_color);
+	F32 brightness = desat_fog.brightness();
+	// So that shiny somewhat shows up at night.
+	if (brightness < 0.15f)
+	{
+		brightness = 0.15f;
+		desat_fog.setVec(0.15f, 0.15f, 0.15f);
+	}
+	for (S32 i = 0; i < 3; ++i)
+	{
+		mFogShiny[i] = desat_fog.mV[i] * SHINY_SATURATION + brightness * (1.f - SHINY_SATURATION);
+		if (mWindLightShaders)
+		{
+			mFogShiny[i] *= 0.5f;
+		}
+	}
+}
+
+void LLSkyScatter::evaluate(const LLVector3* dirs, U32 count, LLColor4* sky, LLColor4* shiny) const
+{
+	LL_ALIGN_16(F32 in[3][4]);
+	LL_ALIGN_16(F32 out[6][4]);
+	LLVector4a p[3];
+	LLVector4a sky_out[3];
+	LLVector4a shiny_out[3];
+
+	for (U32 i = 0; i < count; i += 4)
+	{
+		// A short last batch repeats its last direction.
+		U32 n = llmin(count - i, 4U);
+		for (U32 j = 0; j < 4; ++j)
+		{
+			// Into the WindLight frame, looking back along the ray.
+			const LLVector3& dir = dirs[i + llmin(j, n - 1)];
+			in[0][j] = -dir.mV[VY];
+			in[1][j] = -dir.mV[VZ];
+			in[2][j] = -dir.mV[VX];
+		}
+		for (S32 c = 0; c < 3; ++c)
+		{
+			p[c].load4a(in[c]);
+		}
+
+		evaluateBatch(p, sky_out, shiny_out);
+
+		for (S32 c = 0; c < 3; ++c)
+		{
+			sky_out[c].store4a(out[c]);
+			shiny_out[c].store4a(out[c + 3]);
+		}
+		for (U32 j = 0; j < n; ++j)
+		{
+			sky[i + j].setVec(out[0][j], out[1][j], out[2][j], 0.f);
+			shiny[i + j].setVec(out[3][j], out[4][j], out[5][j], 0.f);
+		}
+	}
+}
+
+void LLSkyScatter::evaluateBatch(const LLVector4a p[3], LLVector4a sky[3], LLVector4a shiny[3]) const
+{
+	const LLVector4a zero(0.f);
+	const LLVector4a one(1.f);
+
+	// Project the ray onto the sky dome.  With phi = acos(p.y) the sines of
+	// the angle sums expand into square roots, leaving no trig per lane.
+	LLVector4a sin_phi;
+	sin_phi.setMul(p[1], p[1]);
+	sin_phi.setSub(one, sin_phi);
+	sin_phi.setMax(sin_phi, zero);
+	sin_phi = _mm_sqrt_ps(sin_phi);
+
+	// Avoid dividing by zero straight up and down.
+	LLVector4a sin_a;
+	sin_a.setMax(sin_phi, LLVector4a(0.01f));
+
+	LLVector4a sin_b;
+	sin_b.setMul(sin_a, LLVector4a(mDomeOffset));
+	LLVector4a cos_b;
+	cos_b.setMul(sin_b, sin_b);
+	cos_b.setSub(one, cos_b);
+	cos_b.setMax(cos_b, zero);
+	cos_b = _mm_sqrt_ps(cos_b);
+
+	// dome_radius * sin(pi + phi + b) / sin_a
+	LLVector4a plen;
+	LLVector4a tmp;
+	plen.setMul(sin_phi, cos_b);
+	tmp.setMul(p[1], sin_b);
+	plen.add(tmp);
+	plen.div(sin_a);
+	plen.mul(-mDomeRadius);
+
+	// Carry the ray up to max_y, or 32km down below the horizon.
+	LLVector4a height;
+	height.setMul(p[1], plen);
+	LLVector4a scale;
+	scale.setSelectWithMask(height.greaterThan(zero), LLVector4a(mMaxY), LLVector4a(-32000.f));
+	scale.div(height);
+	scale.mul(plen);
+
+	LLVector4a n[3];
+	LLVector4a len(0.f);
+	for (S32 c = 0; c < 3; ++c)
+	{
+		n[c].setMul(p[c], scale);
+		tmp.setMul(n[c], n[c]);
+		len.add(tmp);
+	}
+	len = _mm_sqrt_ps(len);
+	for (S32 c = 0; c < 3; ++c)
+	{
+		n[c].div(len);
+	}
+
+	// Sunlight reaching the ray, from its height and lightnorm.
+	LLVector4a inv_y;
+	inv_y.setMax(n[1], zero);
+	inv_y.add(LLVector4a(mLightNorm[1]));
+	inv_y.setMax(inv_y, LLVector4a(F_APPROXIMATELY_ZERO));
+	inv_y.setDiv(one, inv_y);
+
+	LLVector4a dist;
+	dist.setMul(len, LLVector4a(mDensity));
+
+	// Haze glow: 0 at the sun, increasing away from it.  glow.z is negative,
+	// so the power makes a tight hotspot.
+	LLVector4a glow;
+	glow.setMul(n[0], LLVector4a(mLightNorm[0]));
+	for (S32 c = 1; c < 3; ++c)
+	{
+		tmp.setMul(n[c], LLVector4a(mLightNorm[c]));
+		glow.add(tmp);
+	}
+	glow.setSub(one, glow);
+	glow.setMax(glow, LLVector4a(0.001f));
+	glow.mul(mGlowScale);
+
+	// exp() and pow() have no SSE form here; they are done a lane at a time.
+	LL_ALIGN_16(F32 lane_inv_y[4]);
+	LL_ALIGN_16(F32 lane_dist[4]);
+	LL_ALIGN_16(F32 lane_glow[4]);
+	LL_ALIGN_16(F32 lane_sun[3][4]);
+	LL_ALIGN_16(F32 lane_trans[3][4]);
+	inv_y.store4a(lane_inv_y);
+	dist.store4a(lane_dist);
+	glow.store4a(lane_glow);
+	for (S32 j = 0; j < 4; ++j)
+	{
+		lane_glow[j] = powf(lane_glow[j], mGlowExponent) + 0.25f;
+		for (S32 c = 0; c < 3; ++c)
+		{
+			lane_sun[c][j] = mSunlight[c] * expf(-mLightAtten[c] * lane_inv_y[j]);
+			lane_trans[c][j] = expf(-mExtinction[c] * lane_dist[j]);
+		}
+	}
+	glow.load4a(lane_glow);
+
+	const LLVector4a cloud_sunlight(mCloudSunlight);
+	LLVector4a haze[3];
+	LLVector4a brightness(0.f);
+	for (S32 c = 0; c < 3; ++c)
+	{
+		LLVector4a sun;
+		sun.load4a(lane_sun[c]);
+		LLVector4a trans;
+		trans.load4a(lane_trans[c]);
+		const LLVector4a blue_weight(mBlueWeight[c]);
+		const LLVector4a haze_weight(mHazeWeight[c]);
+
+		// Haze colour above the clouds.
+		const LLVector4a ambient(mAmbient[c]);
+		LLVector4a above;
+		above.setAdd(sun, ambient);
+		above.mul(blue_weight);
+		tmp.setMul(sun, glow);
+		tmp.add(ambient);
+		tmp.mul(haze_weight);
+		above.add(tmp);
+
+		// Below the clouds the sun is dimmed and the ambient raised.
+		sun.mul(cloud_sunlight);
+		const LLVector4a cloud_ambient(mCloudAmbient[c]);
+		LLVector4a below;
+		below.setAdd(sun, cloud_ambient);
+		below.mul(blue_weight);
+		tmp.setMul(sun, glow);
+		tmp.add(cloud_ambient);
+		tmp.mul(haze_weight);
+		below.add(tmp);
+
+		// Final atmosphere additive.
+		tmp.setSub(one, trans);
+		haze[c].setMul(above, tmp);
+
+		// At the horizon, blend towards the darker colour below the clouds
+		// by the fourth root of the transparency.
+		trans = _mm_sqrt_ps(trans);
+		trans = _mm_sqrt_ps(trans);
+		LLVector4a blend;
+		blend.setSub(one, trans);
+		tmp.setSub(below, haze[c]);
+		tmp.mul(blend);
+		haze[c].add(tmp);
+
+		brightness.add(haze[c]);
+	}
+	brightness.mul(1.f / 3.f);
+
+	// Looking down, the haze turns into ground, faded in over the first
+	// tenth of the way.
+	LLVector4Logical below_horizon = n[1].lessThan(zero);
+	LLVector4Logical ground = n[1].lessThan(LLVector4a(-0.05f));
+	LLVector4Logical fade = LLVector4Logical(_mm_and_ps(below_horizon, n[1].greaterThan(LLVector4a(-0.1f))));
+	LLVector4a ground_mix;
+	ground_mix.setMul(n[1], LLVector4a(-0.9f));
+	LLVector4a fade_mix;
+	fade_mix.setAdd(n[1], LLVector4a(0.05f));
+	fade_mix.mul(-20.f);
+	fade_mix.setAbs(fade_mix);
+	for (S32 c = 0; c < 3; ++c)
+	{
+		LLVector4a earth(DARK_BROWN.mV[c]);
+		tmp.splat(BROWN.mV[c] - DARK_BROWN.mV[c]);
+		tmp.mul(ground_mix);
+		earth.add(tmp);
+		earth.mul(LLVector4a(mGroundLight[c]));
+		earth.mul(brightness);
+		haze[c].setSelectWithMask(ground, earth, haze[c]);
+
+		LLVector4a faded;
+		faded.setSub(haze[c], brightness);
+		faded.mul(fade_mix);
+		faded.add(brightness);
+		haze[c].setSelectWithMask(fade, faded, haze[c]);
+	}
+
+	// What the fragment shader adds.
+	if (!mWindLightShaders)
+	{
+		for (S32 c = 0; c < 3; ++c)
+		{
+			haze[c].add(haze[c]);
+			haze[c].clamp(zero, one);
+		}
+	}
+
+	// The environment map is desaturated, and darkened where it is dim.
+	brightness.setAdd(haze[0], haze[1]);
+	brightness.add(haze[2]);
+	brightness.mul(1.f / 3.f);
+	LLVector4a grey;
+	grey.setMul(brightness, LLVector4a(1.f - SHINY_SATURATION));
+	LLVector4a shade;
+	shade.setMul(brightness, LLVector4a(0.5f));
+	shade.add(LLVector4a(0.5f));
+
+	// Below the horizon both are the fog colour, darkening with depth.
+	LLVector4Logical fogged = p[1].greaterThan(LLVector4a(0.02f));
+	LLVector4a depth;
+	depth.setSub(p[1], LLVector4a(0.1f));
+	depth.setAbs(depth);
+	depth.setSub(one, depth);
+	depth.mul(depth);
+	LLVector4a fog_scale[3];
+	fog_scale[0].setMul(depth, depth);
+	fog_scale[1].setMul(fog_scale[0], LLVector4a(_mm_sqrt_ps(depth)));
+	fog_scale[2].setMul(fog_scale[0], depth);
+
+	for (S32 c = 0; c < 3; ++c)
+	{
+		shiny[c].setMul(haze[c], LLVector4a(SHINY_SATURATION));
+		shiny[c].add(grey);
+		shiny[c].mul(shade);
+
+		tmp.setMul(fog_scale[c], LLVector4a(mFogSky[c]));
+		sky[c].setSelectWithMask(fogged, tmp, haze[c]);
+		tmp.setMul(fog_scale[c], LLVector4a(mFogShiny[c]));
+		shiny[c].setSelectWithMask(fogged, tmp, shiny[c]);
+	}
+}
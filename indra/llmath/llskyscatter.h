@@ -0,0 +1,101 @@
+/**
+ * @file llskyscatter.h
+ * @brief CPU evaluation of the WindLight sky colour
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+
+#ifndef LL_LLSKYSCATTER_H
+#define LL_LLSKYSCATTER_H
+
+#include "v3color.h"
+#include "v4color.h"
+#include "v3math.h"
+#include "v4math.h"
+
+class LLVector4a;
+
+// The WindLight sky colour in a batch of view directions, as the sky shaders
+// would draw it, for the CPU built sky and environment cube maps.  This is
+// the same model as LLVOSky::calcSkyColorWLVert() and calcSkyColorWLFrag();
+// the two have to be changed together.
+//
+// The constructor works out everything that only depends on the sky
+// parameters.  evaluate() does the per direction part four directions at a
+// time, and only reads the object, so any number of threads may share one.
+class LLSkyScatter
+{
+public:
+	// Named after the LLVOSky members and shader uniforms they come from.
+	struct Params
+	{
+		F32			dome_radius;
+		F32			dome_offset_ratio;
+		LLColor3	sunlight_color;
+		LLColor3	ambient;
+		LLVector4	lightnorm;
+		LLColor3	blue_density;
+		LLColor3	blue_horizon;
+		F32			haze_density;
+		F32			haze_horizon;
+		F32			density_multiplier;
+		F32			max_y;
+		LLColor3	glow;
+		F32			cloud_shadow;
+		LLColor4	fog_color;				// below the horizon
+		bool		windlight_shaders;		// false for the fixed function sky
+	};
+
+	explicit LLSkyScatter(const Params& params);
+
+	// dirs are count unit vectors in the agent frame (Z up).  Writes the sky
+	// colour and the desaturated colour used for the environment map.
+	void evaluate(const LLVector3* dirs, U32 count, LLColor4* sky, LLColor4* shiny) const;
+
+private:
+	// p is the direction in the WindLight frame (Y up), one lane each.
+	void evaluateBatch(const LLVector4a p[3], LLVector4a sky[3], LLVector4a shiny[3]) const;
+
+	F32			mDomeRadius;
+	F32			mDomeOffset;
+	F32			mMaxY;
+	F32			mDensity;
+	F32			mLightNorm[3];
+	F32			mGlowScale;
+	F32			mGlowExponent;
+	F32			mCloudSunlight;			// sunlight left under the clouds
+	bool		mWindLightShaders;
+
+	F32			mSunlight[3];
+	F32			mLightAtten[3];
+	F32			mExtinction[3];
+	F32			mBlueWeight[3];			// blue_horizon * blue share of extinction
+	F32			mHazeWeight[3];			// haze_horizon * haze share of extinction
+	F32			mAmbient[3];
+	F32			mCloudAmbient[3];		// ambient raised by cloud cover
+	F32			mGroundLight[3];		// sunlight at the dome top + ambient
+	F32			mFogSky[3];
+	F32			mFogShiny[3];
+};
+
+#endif // LL_LLSKYSCATTER_H
@@ -47,6 +47,8 @@
 #include "llvolume.h"
 #include "llvolumeoctree.h"
 #include "llstl.h"
+#include "llmemorystream.h"
+#include "llsdbinaryreader.h"
 #include "llsdserialize.h"
 #include "llvector4a.h"
 #include "lltimer.h"
@@ -2363,19 +2365,221 @@ bool LLVolumeFace::VertexData::compareNormal(const LLVolumeFace::VertexData& rhs
 	return retval;
 }
 
+// Quantized streams of one face of a mesh LOD block. The pointers are into
+// the inflated block, or into the LLSD it was parsed into, and have no
+// particular alignment.
+struct LLVolume::PackedFace
+{
+	PackedFace()
+	:	mNoGeometry(false),
+		mHasWeights(false),
+		mPositions(NULL), mPositionsSize(0),
+		mNormals(NULL), mNormalsSize(0),
+		mTexCoords(NULL), mTexCoordsSize(0),
+		mIndices(NULL), mIndicesSize(0),
+		mWeights(NULL), mWeightsSize(0)
+	{
+	}
+
+	bool		mNoGeometry;
+	bool		mHasWeights;
+	const U8*	mPositions;
+	U32			mPositionsSize;
+	const U8*	mNormals;
+	U32			mNormalsSize;
+	const U8*	mTexCoords;
+	U32			mTexCoordsSize;
+	const U8*	mIndices;
+	U32			mIndicesSize;
+	const U8*	mWeights;
+	U32			mWeightsSize;
+	LLVector3	mMinPos;
+	LLVector3	mMaxPos;
+	LLVector2	mMinTC;
+	LLVector2	mMaxTC;
+};
+
+static void get_packed_binary(const LLSD& sd, const U8*& data, U32& size)
+{
+	const LLSD::Binary& binary = sd.asBinary();
+	data = binary.empty() ? NULL : &binary[0];
+	size = binary.size();
+}
+
+static bool read_packed_domain(LLSDBinaryReader& reader, F32* min, F32* max, U32 components)
+{
+	U32 count;
+	if (!reader.readMapStart(count))
+	{
+		return false;
+	}
+	while (count--)
+	{
+		const char* key;
+		U32 length;
+		if (!reader.readKey(key, length))
+		{
+			return false;
+		}
+		F32* out = LLSDBinaryReader::keyIs(key, length, "Min") ? min
+				 : LLSDBinaryReader::keyIs(key, length, "Max") ? max : NULL;
+		U32 values;
+		if (!out)
+		{
+			reader.skipValue();
+		}
+		else if (reader.readArrayStart(values))
+		{
+			for (U32 i = 0; i < values; ++i)
+			{
+				F64 value;
+				if (reader.readReal(value) && i < components)
+				{
+					out[i] = (F32) value;
+				}
+			}
+			reader.readArrayEnd();
+		}
+	}
+	return reader.readMapEnd();
+}
+
 bool LLVolume::unpackVolumeFaces(std::istream& is, S32 size)
 {
 	//input stream is now pointing at a zlib compressed block of LLSD
 	//decompress block
-	LLSD mdl;
-	if (!unzip_llsd(mdl, is, size))
+	std::vector<U8> block;
+	if (!unzip_llsd_binary(block, is, size) || block.empty())
 	{
 		LL_DEBUGS("MeshStreaming") << "Failed to unzip LLSD blob for LoD, will probably fetch from sim again." << LL_ENDL;
 		return false;
 	}
-	
+
+	return unpackVolumeFacesBinary(&block[0], block.size());
+}
+
+bool LLVolume::unpackVolumeFacesBinary(const U8* data, U32 size)
+{
+	std::vector<PackedFace> faces;
+	if (readPackedFaces(data, size, faces))
+	{
+		return unpackPackedFaces(faces);
+	}
+
+	// Not laid out as LLSDBinaryFormatter writes it; let the parser have a go.
+	LLSD mdl;
+	LLMemoryStream istr(data, size);
+	if (LLSDSerialize::fromBinary(mdl, istr, size) <= 0)
+	{
+		LL_DEBUGS("MeshStreaming") << "Failed to parse LLSD blob for LoD, will probably fetch from sim again." << LL_ENDL;
+		return false;
+	}
+	return unpackVolumeFacesLLSD(mdl);
+}
+
+bool LLVolume::unpackVolumeFacesLLSD(const LLSD& mdl)
+{
+	std::vector<PackedFace> faces(mdl.size());
+	for (U32 i = 0; i < (U32)faces.size(); ++i)
+	{
+		const LLSD& sd = mdl[i];
+		PackedFace& face = faces[i];
+		face.mNoGeometry = sd.has("NoGeometry");
+		get_packed_binary(sd["Position"], face.mPositions, face.mPositionsSize);
+		get_packed_binary(sd["Normal"], face.mNormals, face.mNormalsSize);
+		get_packed_binary(sd["TexCoord0"], face.mTexCoords, face.mTexCoordsSize);
+		get_packed_binary(sd["TriangleList"], face.mIndices, face.mIndicesSize);
+		face.mHasWeights = sd.has("Weights");
+		get_packed_binary(sd["Weights"], face.mWeights, face.mWeightsSize);
+		face.mMinPos.setValue(sd["PositionDomain"]["Min"]);
+		face.mMaxPos.setValue(sd["PositionDomain"]["Max"]);
+		const LLSD& tc_domain = sd["TexCoord0Domain"];
+		face.mMinTC.set((F32) tc_domain["Min"][0].asReal(), (F32) tc_domain["Min"][1].asReal());
+		face.mMaxTC.set((F32) tc_domain["Max"][0].asReal(), (F32) tc_domain["Max"][1].asReal());
+	}
+	return unpackPackedFaces(faces);
+}
+
+//static
+bool LLVolume::readPackedFaces(const U8* data, U32 size, std::vector<PackedFace>& faces)
+{
+	LLSDBinaryReader reader(data, size);
+	U32 face_count;
+	if (!reader.readArrayStart(face_count))
+	{
+		return false;
+	}
+
+	faces.resize(face_count);
+	for (U32 i = 0; i < face_count; ++i)
 	{
-		U32 face_count = mdl.size();
+		PackedFace& face = faces[i];
+		U32 key_count;
+		if (!reader.readMapStart(key_count))
+		{
+			return false;
+		}
+		while (key_count--)
+		{
+			const char* key;
+			U32 length;
+			if (!reader.readKey(key, length))
+			{
+				return false;
+			}
+
+			if (LLSDBinaryReader::keyIs(key, length, "Position"))
+			{
+				reader.readBinary(face.mPositions, face.mPositionsSize);
+			}
+			else if (LLSDBinaryReader::keyIs(key, length, "Normal"))
+			{
+				reader.readBinary(face.mNormals, face.mNormalsSize);
+			}
+			else if (LLSDBinaryReader::keyIs(key, length, "TexCoord0"))
+			{
+				reader.readBinary(face.mTexCoords, face.mTexCoordsSize);
+			}
+			else if (LLSDBinaryReader::keyIs(key, length, "TriangleList"))
+			{
+				reader.readBinary(face.mIndices, face.mIndicesSize);
+			}
+			else if (LLSDBinaryReader::keyIs(key, length, "Weights"))
+			{
+				face.mHasWeights = true;
+				reader.readBinary(face.mWeights, face.mWeightsSize);
+			}
+			else if (LLSDBinaryReader::keyIs(key, length, "PositionDomain"))
+			{
+				read_packed_domain(reader, face.mMinPos.mV, face.mMaxPos.mV, 3);
+			}
+			else if (LLSDBinaryReader::keyIs(key, length, "TexCoord0Domain"))
+			{
+				read_packed_domain(reader, face.mMinTC.mV, face.mMaxTC.mV, 2);
+			}
+			else
+			{
+				face.mNoGeometry |= LLSDBinaryReader::keyIs(key, length, "NoGeometry");
+				reader.skipValue();
+			}
+		}
+		reader.readMapEnd();
+	}
+	reader.readArrayEnd();
+
+	return reader.isValid();
+}
+
+// The quantized streams are native order U16s at any alignment.
+inline void load_packed_u16(U16* out, const U8* in, U32 count)
+{
+	memcpy(out, in, count * sizeof(U16));
+}
+
+bool LLVolume::unpackPackedFaces(const std::vector<PackedFace>& packed_faces)
+{
+	{
+		U32 face_count = packed_faces.size();
 
 		if (face_count == 0)
 		{ //no faces unpacked, treat as failed decode
@@ -2388,8 +2592,9 @@ bool LLVolume::unpackVolumeFaces(std::istream& is, S32 size)
 		for (U32 i = 0; i < face_count; ++i)
 		{
 			LLVolumeFace& face = mVolumeFaces[i];
+			const PackedFace& packed = packed_faces[i];
 
-			if (mdl[i].has("NoGeometry"))
+			if (packed.mNoGeometry)
 			{ //face has no geometry, continue
 				face.resizeIndices(3);
 				face.resizeVertices(1);
@@ -2400,46 +2605,27 @@ bool LLVolume::unpackVolumeFaces(std::istream& is, S32 size)
 				continue;
 			}
 
-			LLSD::Binary pos = mdl[i]["Position"];
-			LLSD::Binary norm = mdl[i]["Normal"];
-			LLSD::Binary tc = mdl[i]["TexCoord0"];
-			LLSD::Binary idx = mdl[i]["TriangleList"];
-
-			
-
 			//copy out indices
-			face.resizeIndices(idx.size()/2);
+			face.resizeIndices(packed.mIndicesSize/2);
 			
-			if (idx.empty() || face.mNumIndices < 3)
+			if (!packed.mIndicesSize || face.mNumIndices < 3)
 			{ //why is there an empty index list?
 				LL_WARNS() <<"Empty face present!" << LL_ENDL;
 				continue;
 			}
 
-			U16* indices = (U16*) &(idx[0]);
-			U32 count = idx.size()/2;
-			for (U32 j = 0; j < count; ++j)
-			{
-				face.mIndices[j] = indices[j];
-			}
+			load_packed_u16(face.mIndices, packed.mIndices, face.mNumIndices);
 
 			//copy out vertices
-			U32 num_verts = pos.size()/(3*2);
+			U32 num_verts = packed.mPositionsSize/(3*2);
 			face.resizeVertices(num_verts);
 
-			LLVector3 minp;
-			LLVector3 maxp;
-			LLVector2 min_tc; 
-			LLVector2 max_tc; 
-		
-			minp.setValue(mdl[i]["PositionDomain"]["Min"]);
-			maxp.setValue(mdl[i]["PositionDomain"]["Max"]);
 			LLVector4a min_pos, max_pos;
-			min_pos.load3(minp.mV);
-			max_pos.load3(maxp.mV);
+			min_pos.load3(packed.mMinPos.mV);
+			max_pos.load3(packed.mMaxPos.mV);
 
-			min_tc.setValue(mdl[i]["TexCoord0Domain"]["Min"]);
-			max_tc.setValue(mdl[i]["TexCoord0Domain"]["Max"]);
+			const LLVector2& min_tc = packed.mMinTC;
+			const LLVector2& max_tc = packed.mMaxTC;
 
 			LLVector4a pos_range;
 			pos_range.setSub(max_pos, min_pos);
@@ -2453,31 +2639,37 @@ bool LLVolume::unpackVolumeFaces(std::istream& is, S32 size)
 			LLVector4a* tc_out = (LLVector4a*) face.mTexCoords;
 
 			{
-				U16* v = (U16*) &(pos[0]);
+				const U8* src = packed.mPositions;
+				U16 v[3];
 				for (U32 j = 0; j < num_verts; ++j)
 				{
+					load_packed_u16(v, src, 3);
 					pos_out->set((F32) v[0], (F32) v[1], (F32) v[2]);
 					pos_out->div(65535.f);
 					pos_out->mul(pos_range);
 					pos_out->add(min_pos);
 					pos_out++;
-					v += 3;
+					src += 3*2;
 				}
 
 			}
 
 			{
-				if (!norm.empty())
+				// A stream shorter than the positions is treated as missing
+				// rather than read past.
+				if (packed.mNormalsSize >= num_verts*3*2)
 				{
-					U16* n = (U16*) &(norm[0]);
+					const U8* src = packed.mNormals;
+					U16 n[3];
 					for (U32 j = 0; j < num_verts; ++j)
 					{
+						load_packed_u16(n, src, 3);
 						norm_out->set((F32) n[0], (F32) n[1], (F32) n[2]);
 						norm_out->div(65535.f);
 						norm_out->mul(2.f);
 						norm_out->sub(1.f);
 						norm_out++;
-						n += 3;
+						src += 3*2;
 					}
 				}
 				else
@@ -2487,21 +2679,24 @@ bool LLVolume::unpackVolumeFaces(std::istream& is, S32 size)
 			}
 
 			{
-				if (!tc.empty())
+				if (packed.mTexCoordsSize >= num_verts*2*2)
 				{
-					U16* t = (U16*) &(tc[0]);
+					const U8* src = packed.mTexCoords;
+					U16 t[4];
 					for (U32 j = 0; j < num_verts; j+=2)
 					{
 						if (j < num_verts-1)
 						{
+							load_packed_u16(t, src, 4);
 							tc_out->set((F32) t[0], (F32) t[1], (F32) t[2], (F32) t[3]);
 						}
 						else
 						{
+							load_packed_u16(t, src, 2);
 							tc_out->set((F32) t[0], (F32) t[1], 0.f, 0.f);
 						}
 
-						t += 4;
+						src += 4*2;
 
 						tc_out->div(65535.f);
 						tc_out->mul(tc_range);
@@ -2516,16 +2711,17 @@ bool LLVolume::unpackVolumeFaces(std::istream& is, S32 size)
 				}
 			}
 
-			if (mdl[i].has("Weights"))
+			if (packed.mHasWeights)
 			{
 				face.allocateWeights(num_verts);
 
-				LLSD::Binary weights = mdl[i]["Weights"];
+				const U8* weights = packed.mWeights;
+				U32 weights_size = packed.mWeightsSize;
 
 				U32 idx = 0;
 
 				U32 cur_vertex = 0;
-				while (idx < weights.size() && cur_vertex < num_verts)
+				while (idx < weights_size && cur_vertex < num_verts)
 				{
 					const U8 END_INFLUENCES = 0xFF;
 					U8 joint = weights[idx++];
@@ -2535,7 +2731,7 @@ bool LLVolume::unpackVolumeFaces(std::istream& is, S32 size)
                     U32 joints[4] = {0,0,0,0};
 					LLVector4 joints_with_weights(0,0,0,0);
 
-					while (joint != END_INFLUENCES && idx < weights.size())
+					while (joint != END_INFLUENCES && idx + 2 <= weights_size)
 					{
 						U16 influence = weights[idx++];
 						influence |= ((U16) weights[idx++] << 8);
@@ -2545,7 +2741,7 @@ bool LLVolume::unpackVolumeFaces(std::istream& is, S32 size)
 						joints[cur_influence] = joint;
 						cur_influence++;
 
-						if (cur_influence >= 4)
+						if (cur_influence >= 4 || idx >= weights_size)
 						{
 							joint = END_INFLUENCES;
 						}
@@ -2568,7 +2764,7 @@ bool LLVolume::unpackVolumeFaces(std::istream& is, S32 size)
 					cur_vertex++;
 				}
 
-				if (cur_vertex != num_verts || idx != weights.size())
+				if (cur_vertex != num_verts || idx != weights_size)
 				{
 					LL_WARNS() << "Vertex weight count does not match vertex count!" << LL_ENDL;
 				}
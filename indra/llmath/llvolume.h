@@ -43,6 +43,7 @@ template <class T> class LLOctreeNode;
 class LLVolumeFace;
 class LLVolume;
 class LLVolumeTriangle;
+class LLSD;
 
 #include "lluuid.h"
 #include "v4color.h"
@@ -1069,13 +1070,26 @@ private:
 	void sculptGeneratePlaceholder();
 	void sculptCalcMeshResolution(U16 width, U16 height, U8 type, S32& s, S32& t);
 
+	struct PackedFace;
+	static bool readPackedFaces(const U8* data, U32 size, std::vector<PackedFace>& faces);
+	bool unpackPackedFaces(const std::vector<PackedFace>& faces);
+
 	
 protected:
 	BOOL generate();
 	void createVolumeFaces();
 public:
+	// Reads the faces of a zlib compressed mesh LOD block.
 	virtual bool unpackVolumeFaces(std::istream& is, S32 size);
 
+	// The same from an inflated block. The quantized streams are read
+	// straight out of it into the face buffers; only blocks that are not laid
+	// out as LLSDBinaryFormatter writes them go through an LLSD.
+	bool unpackVolumeFacesBinary(const U8* data, U32 size);
+
+	// The same from the block parsed into an LLSD array of faces.
+	bool unpackVolumeFacesLLSD(const LLSD& mdl);
+
 	virtual void setMeshAssetLoaded(BOOL loaded);
 	virtual BOOL isMeshAssetLoaded();
 
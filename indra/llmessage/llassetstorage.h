@@ -246,7 +246,15 @@ public:
 	// public interface methods
 	// note that your callback may get called BEFORE the function returns
 
-	virtual void getAssetData(const LLUUID uuid, LLAssetType::EType atype, LLGetAssetCallback cb, void *user_data, BOOL is_priority = FALSE);
+	// importance, from 0 to 1, ranks the request against others of its
+	// type for stores that schedule their downloads (screen area,
+	// distance, loudness).
+	virtual void getAssetData(const LLUUID uuid, LLAssetType::EType atype, LLGetAssetCallback cb, void *user_data, BOOL is_priority = FALSE, F32 importance = 0.5f);
+
+	// Download callbacks report the size of an asset that arrived over the
+	// network, rather than from the cache, for stores that measure their
+	// throughput.
+	virtual void reportReceived(LLAssetType::EType atype, S32 bytes) {}
 	
 	std::vector<LLUUID> mBlackListedAsset;
 
@@ -427,7 +435,7 @@ protected:
 	virtual void _queueDataRequest(const LLUUID& uuid, LLAssetType::EType type,
 								   void (*callback)(LLVFS *vfs, const LLUUID&, LLAssetType::EType, void *, S32, LLExtStat),
 								   void *user_data, BOOL duplicate,
-								   BOOL is_priority);
+								   BOOL is_priority, F32 importance);
 
 private:
 	void _init(LLMessageSystem *msg,
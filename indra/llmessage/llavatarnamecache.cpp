@@ -28,8 +28,10 @@
 
 #include "llavatarnamecache.h"
 
+#include "llavatarnamestore.h"
 #include "llcachename.h"		// we wrap this system
 #include "llcontrol.h"		// For LLCachedControl
+#include "llfile.h"
 #include "llframetimer.h"
 #include "llsd.h"
 #include "llsdserialize.h"
@@ -46,6 +48,7 @@
 #include "llcorehttputil.h"
 
 #include <map>
+#include <queue>
 #include <set>
 
 namespace LLAvatarNameCache
@@ -91,6 +94,24 @@ namespace LLAvatarNameCache
 	typedef std::map<LLUUID, LLAvatarName> cache_t;
 	cache_t sCache;
 
+	// Names kept between sessions.  Opened on the first lookup; a name
+	// moves into sCache when it is first asked for.
+	LLAvatarNameStore sStore;
+	std::string sStoreFilename;
+	LLFrameTimer sStoreFlushTimer;
+	const F32 STORE_FLUSH_INTERVAL = 60.f;
+
+	// sCache ids by expiry time, soonest first, so that expiring names does
+	// not have to look at every entry.  An entry's time may be stale; it is
+	// checked against the cache when it reaches the top.
+	typedef std::pair<F64, LLUUID> expiry_t;
+	typedef std::priority_queue<expiry_t, std::vector<expiry_t>, std::greater<expiry_t> > expiry_queue_t;
+	expiry_queue_t sExpiryQueue;
+
+	// Capability requests in flight, and the most allowed at once.
+	S32 sNameRequestsInFlight = 0;
+	const S32 MAX_NAME_REQUESTS_IN_FLIGHT = 4;
+
 	// Send bulk lookup requests a few times a second at most.
 	// Only need per-frame timing resolution.
 	LLFrameTimer sRequestTimer;
@@ -101,6 +122,9 @@ namespace LLAvatarNameCache
     // Time when unrefreshed cached names were checked last.
     static F64 sLastExpireCheck;
 
+    // How often to look for unrefreshed names.
+    const F64 EXPIRE_CHECK_INTERVAL = 60.0;
+
 	// Time-to-live for a temp cache entry.
 	const F64 TEMP_CACHE_ENTRY_LIFETIME = 60.0;
 
@@ -141,6 +165,16 @@ namespace LLAvatarNameCache
 	// Erase expired names from cache
 	void eraseUnrefreshed();
 
+	// Opens the store the first time a name is looked up.
+	void openStore();
+
+	// Finds agent_id in sCache, pulling it in from the store if needed.
+	cache_t::iterator findName(const LLUUID& agent_id);
+
+	// Adds or replaces a name in sCache, and in the store unless it is
+	// temporary.
+	void cacheName(const LLUUID& agent_id, const LLAvatarName& av_name);
+
     bool expirationFromCacheControl(const LLSD& headers, F64 *expires);
 
     // This is a coroutine.
@@ -196,6 +230,12 @@ void LLAvatarNameCache::requestAvatarNameCache_(std::string url, std::vector<LLU
     LL_DEBUGS("AvNameCache") << "Entering coroutine " << LLCoros::instance().getName()
         << " with url '" << url << "', requesting " << agentIds.size() << " Agent Ids" << LL_ENDL;
 
+    // Counted in by requestNamesViaCapability(); count it out however we leave.
+    struct InFlight
+    {
+        ~InFlight() { --sNameRequestsInFlight; }
+    } inFlight;
+
     try
 	{
         bool success = true;
@@ -303,7 +343,7 @@ void LLAvatarNameCache::handleAvNameCacheSuccess(const LLSD &data, const LLSD &h
 // Provide some fallback for agents that return errors
 void LLAvatarNameCache::handleAgentError(const LLUUID& agent_id)
 {
-	std::map<LLUUID,LLAvatarName>::iterator existing = sCache.find(agent_id);
+	cache_t::iterator existing = findName(agent_id);
 	if (existing == sCache.end())
     {
         // there is no existing cache entry, so make a temporary name from legacy
@@ -332,7 +372,7 @@ void LLAvatarNameCache::handleAgentError(const LLUUID& agent_id)
 void LLAvatarNameCache::processName(const LLUUID& agent_id, const LLAvatarName& av_name)
 {
 	// Add to the cache
-	sCache[agent_id] = av_name;
+	cacheName(agent_id, av_name);
 
 	// Suppress request from the queue
 	sPendingQueue.erase(agent_id);
@@ -362,54 +402,54 @@ void LLAvatarNameCache::requestNamesViaCapability()
 	static const U32 NAME_URL_MAX = 4096;
 	static const U32 NAME_URL_SEND_THRESHOLD = 3500;
 
-	std::string url;
-	url.reserve(NAME_URL_MAX);
-
-	std::vector<LLUUID> agent_ids;
-	agent_ids.reserve(128);
-	
-	U32 ids = 0;
-	ask_queue_t::const_iterator it;
-	while(!sAskQueue.empty())
+	// Everyone who asked since the last tick shares these requests: the ask
+	// queue is a set, and ids another request has since answered or taken
+	// on are dropped here rather than asked for twice.
+	while (!sAskQueue.empty() && sNameRequestsInFlight < MAX_NAME_REQUESTS_IN_FLIGHT)
 	{
-		it = sAskQueue.begin();
-		const LLUUID& agent_id = *it;
-		sAskQueue.erase(it);
+		std::string url;
+		url.reserve(NAME_URL_MAX);
 
-		if (url.empty())
-		{
-			// ...starting new request
-			url += sNameLookupURL;
-			url += "?ids=";
-			ids = 1;
-		}
-		else
+		std::vector<LLUUID> agent_ids;
+		agent_ids.reserve(128);
+
+		while (!sAskQueue.empty() && url.size() <= NAME_URL_SEND_THRESHOLD)
 		{
-			// ...continuing existing request
-			url += "&ids=";
-			ids++;
-		}
-		url += agent_id.asString();
-		agent_ids.push_back(agent_id);
+			ask_queue_t::iterator it = sAskQueue.begin();
+			LLUUID agent_id = *it;
+			sAskQueue.erase(it);
 
-		// mark request as pending
-		sPendingQueue[agent_id] = now;
+			if (isRequestPending(agent_id))
+			{
+				continue;
+			}
+			cache_t::const_iterator cached = sCache.find(agent_id);
+			if (cached != sCache.end() && cached->second.isValidName(now)
+				&& sSignalMap.find(agent_id) == sSignalMap.end())
+			{
+				continue;
+			}
+
+			url += url.empty() ? sNameLookupURL + "?ids=" : "&ids=";
+			url += agent_id.asString();
+			agent_ids.push_back(agent_id);
 
-		if (url.size() > NAME_URL_SEND_THRESHOLD)
+			// mark request as pending
+			sPendingQueue[agent_id] = now;
+		}
+
+		if (url.empty())
 		{
 			break;
 		}
-	}
-
-	if (!url.empty())
-	{
-        LL_DEBUGS("AvNameCache") << "LLAvatarNameCache::requestNamesViaCapability requested " << ids << " ids" << LL_ENDL;
 
-        std::string coroname = 
-            LLCoros::instance().launch("LLAvatarNameCache::requestAvatarNameCache_",
-            boost::bind(&LLAvatarNameCache::requestAvatarNameCache_, url, agent_ids));
-        LL_DEBUGS("AvNameCache") << coroname << " with  url '" << url << "', agent_ids.size()=" << agent_ids.size() << LL_ENDL;
+		LL_DEBUGS("AvNameCache") << "LLAvatarNameCache::requestNamesViaCapability requested " << agent_ids.size() << " ids" << LL_ENDL;
 
+		++sNameRequestsInFlight;
+		std::string coroname = 
+			LLCoros::instance().launch("LLAvatarNameCache::requestAvatarNameCache_",
+			boost::bind(&LLAvatarNameCache::requestAvatarNameCache_, url, agent_ids));
+		LL_DEBUGS("AvNameCache") << coroname << " with  url '" << url << "', agent_ids.size()=" << agent_ids.size() << LL_ENDL;
 	}
 }
 
@@ -485,7 +525,11 @@ void LLAvatarNameCache::cleanupClass()
     sHttpRequest.reset();
     sHttpHeaders.reset();
     sHttpOptions.reset();
+	flushCacheFile();
+	sStore.close();
+	sStoreFilename.clear();
 	sCache.clear();
+	sExpiryQueue = expiry_queue_t();
 }
 
 bool LLAvatarNameCache::importFile(std::istream& istr)
@@ -508,7 +552,7 @@ bool LLAvatarNameCache::importFile(std::istream& istr)
 	{
 		agent_id.set(it->first);
 		av_name.fromLLSD( it->second );
-		sCache[agent_id] = av_name;
+		cacheName(agent_id, av_name);
 	}
     LL_INFOS("AvNameCache") << "LLAvatarNameCache loaded " << sCache.size() << LL_ENDL;
 	// Some entries may have expired since the cache was stored,
@@ -518,27 +562,77 @@ bool LLAvatarNameCache::importFile(std::istream& istr)
     return true;
 }
 
-void LLAvatarNameCache::exportFile(std::ostream& ostr)
+void LLAvatarNameCache::setCacheFile(const std::string& filename)
 {
-	LLSD agents;
+	if (filename != sStoreFilename)
+	{
+		sStore.close();
+		sStoreFilename = filename;
+	}
+}
+
+void LLAvatarNameCache::openStore()
+{
+	if (sStoreFilename.empty() || sStore.isOpen())
+	{
+		return;
+	}
+
 	F64 max_unrefreshed = LLFrameTimer::getTotalSeconds() - MAX_UNREFRESHED_TIME;
-    LL_INFOS("AvNameCache") << "LLAvatarNameCache at exit cache has " << sCache.size() << LL_ENDL;
-	cache_t::const_iterator it = sCache.begin();
-	for ( ; it != sCache.end(); ++it)
-	{
-		const LLUUID& agent_id = it->first;
-		const LLAvatarName& av_name = it->second;
-		// Do not write temporary or expired entries to the stored cache
-		if (av_name.isValidName(max_unrefreshed))
+	if (!sStore.open(sStoreFilename, max_unrefreshed))
+	{
+		LL_WARNS("AvNameCache") << "removing invalid '" << sStoreFilename << "'" << LL_ENDL;
+		LLFile::remove(sStoreFilename);
+		sStore.open(sStoreFilename, max_unrefreshed);
+	}
+	sStoreFlushTimer.resetWithExpiry(STORE_FLUSH_INTERVAL);
+}
+
+void LLAvatarNameCache::flushCacheFile()
+{
+	if (!sStore.isOpen())
+	{
+		return;
+	}
+
+	if (sStore.needsCompaction(sCache.size()))
+	{
+		sStore.compact(sCache, LLFrameTimer::getTotalSeconds() - MAX_UNREFRESHED_TIME);
+	}
+	sStore.flush();
+	sStoreFlushTimer.resetWithExpiry(STORE_FLUSH_INTERVAL);
+}
+
+LLAvatarNameCache::cache_t::iterator LLAvatarNameCache::findName(const LLUUID& agent_id)
+{
+	cache_t::iterator it = sCache.find(agent_id);
+	if (it == sCache.end())
+	{
+		openStore();
+
+		// Stored names may have gone unrefreshed too long since the store
+		// was opened.
+		LLAvatarName av_name;
+		if (sStore.take(agent_id, av_name)
+			&& av_name.mExpires >= LLFrameTimer::getTotalSeconds() - MAX_UNREFRESHED_TIME)
 		{
-			// key must be a string
-			agents[agent_id.asString()] = av_name.asLLSD();
+			it = sCache.insert(cache_t::value_type(agent_id, av_name)).first;
+			sExpiryQueue.push(expiry_t(av_name.mExpires, agent_id));
 		}
 	}
-    LL_INFOS("AvNameCache") << "LLAvatarNameCache returning " << agents.size() << LL_ENDL;
-	LLSD data;
-	data["agents"] = agents;
-	LLSDSerialize::toPrettyXML(data, ostr);
+	return it;
+}
+
+void LLAvatarNameCache::cacheName(const LLUUID& agent_id, const LLAvatarName& av_name)
+{
+	openStore();
+
+	sCache[agent_id] = av_name;
+	sExpiryQueue.push(expiry_t(av_name.mExpires, agent_id));
+	if (sStore.isOpen() && av_name.isValidName())
+	{
+		sStore.put(agent_id, av_name);
+	}
 }
 
 void LLAvatarNameCache::setNameLookupURL(const std::string& name_lookup_url)
@@ -591,6 +685,11 @@ void LLAvatarNameCache::idle()
 
     // erase anything that has not been refreshed for more than MAX_UNREFRESHED_TIME
     eraseUnrefreshed();
+
+	if (sStore.isOpen() && sStoreFlushTimer.hasExpired())
+	{
+		flushCacheFile();
+	}
 }
 
 bool LLAvatarNameCache::isRequestPending(const LLUUID& agent_id)
@@ -613,12 +712,20 @@ void LLAvatarNameCache::eraseUnrefreshed()
 	F64 now = LLFrameTimer::getTotalSeconds();
 	F64 max_unrefreshed = now - MAX_UNREFRESHED_TIME;
 
-    if (!sLastExpireCheck || sLastExpireCheck < max_unrefreshed)
+    if (!sLastExpireCheck || sLastExpireCheck < now - EXPIRE_CHECK_INTERVAL)
     {
         sLastExpireCheck = now;
         S32 expired = 0;
-        for (cache_t::iterator it = sCache.begin(); it != sCache.end();)
+        while (!sExpiryQueue.empty() && sExpiryQueue.top().first < max_unrefreshed)
         {
+            LLUUID agent_id = sExpiryQueue.top().second;
+            sExpiryQueue.pop();
+
+            cache_t::iterator it = sCache.find(agent_id);
+            if (it == sCache.end())
+            {
+                continue;
+            }
             const LLAvatarName& av_name = it->second;
             if (av_name.mExpires < max_unrefreshed)
             {
@@ -626,16 +733,34 @@ void LLAvatarNameCache::eraseUnrefreshed()
                                          << " user '" << av_name.getAccountName() << "' "
                                          << "expired " << now - av_name.mExpires << " secs ago"
                                          << LL_ENDL;
-                sCache.erase(it++);
+                sCache.erase(it);
                 expired++;
             }
-			else
-			{
-				++it;
-			}
+            else
+            {
+                // Refreshed since this entry was queued; requeue at its
+                // current time in case no newer entry was.
+                sExpiryQueue.push(expiry_t(av_name.mExpires, agent_id));
+            }
+        }
+
+        // Refreshes leave stale entries behind; rebuild once they dominate.
+        if (sExpiryQueue.size() > sCache.size() * 2 + 1024)
+        {
+            std::vector<expiry_t> entries;
+            entries.reserve(sCache.size());
+            for (cache_t::const_iterator it = sCache.begin(); it != sCache.end(); ++it)
+            {
+                entries.push_back(expiry_t(it->second.mExpires, it->first));
+            }
+            sExpiryQueue = expiry_queue_t(std::greater<expiry_t>(), entries);
+        }
+
+        if (expired > 0)
+        {
+            LL_INFOS("AvNameCache") << "LLAvatarNameCache expired " << expired << " cached avatar names, "
+                                    << sCache.size() << " remaining" << LL_ENDL;
         }
-        LL_INFOS("AvNameCache") << "LLAvatarNameCache expired " << expired << " cached avatar names, "
-                                << sCache.size() << " remaining" << LL_ENDL;
 	}
 }
 
@@ -646,7 +771,7 @@ bool LLAvatarNameCache::get(const LLUUID& agent_id, LLAvatarName *av_name)
 	if (sRunning)
 	{
 		// ...only do immediate lookups when cache is running
-		std::map<LLUUID,LLAvatarName>::iterator it = sCache.find(agent_id);
+		cache_t::iterator it = findName(agent_id);
 		if (it != sCache.end())
 		{
 			*av_name = it->second;
@@ -670,7 +795,7 @@ bool LLAvatarNameCache::get(const LLUUID& agent_id, LLAvatarName *av_name)
 			if (gCacheName->getFullName(agent_id, full_name))
 			{
 				av_name->fromString(full_name);
-				sCache[agent_id] = *av_name;
+				cacheName(agent_id, *av_name);
 				return true;
 			}
 		}
@@ -717,7 +842,7 @@ LLAvatarNameCache::callback_connection_t LLAvatarNameCache::get(const LLUUID& ag
 	if (sRunning)
 	{
 		// ...only do immediate lookups when cache is running
-		std::map<LLUUID,LLAvatarName>::iterator it = sCache.find(agent_id);
+		cache_t::iterator it = findName(agent_id);
 		if (it != sCache.end())
 		{
 			const LLAvatarName& av_name = it->second;
@@ -797,12 +922,17 @@ void LLAvatarNameCache::setUseUsernames(bool use)
 void LLAvatarNameCache::erase(const LLUUID& agent_id)
 {
 	sCache.erase(agent_id);
+	openStore();
+	if (sStore.isOpen())
+	{
+		sStore.erase(agent_id);
+	}
 }
 
 void LLAvatarNameCache::insert(const LLUUID& agent_id, const LLAvatarName& av_name)
 {
 	// *TODO: update timestamp if zero?
-	sCache[agent_id] = av_name;
+	cacheName(agent_id, av_name);
 }
 
 #if 0
@@ -44,9 +44,17 @@ namespace LLAvatarNameCache
 	void initClass(bool running, bool usePeopleAPI);
 	void cleanupClass();
 
-	// Import/export the name cache to file.
+	// Import a name cache written as an LLSD XML document by older viewers.
 	bool importFile(std::istream& istr);
-	void exportFile(std::ostream& ostr);
+
+	// Keep names in a binary store file.  Nothing is read until the first
+	// lookup, and after that only names that are asked for get decoded.
+	// A file that turns out not to be a name store is replaced.
+	void setCacheFile(const std::string& filename);
+	// Append names changed since the last flush to the store, rewriting it
+	// first if it is mostly superseded records.  Also done periodically
+	// from idle().
+	void flushCacheFile();
 
 	// On the viewer, usually a simulator capabilities.
 	// If empty, name cache will fall back to using legacy name lookup system.
@@ -0,0 +1,276 @@
+/**
+ * @file llavatarnamestore.cpp
+ * @brief Append-only binary file backing LLAvatarNameCache
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llavatarnamestore.h"
+
+#include "llfile.h"
+#include "llsd.h"
+#include "llsdserialize.h"
+
+// File layout: STORE_MAGIC, then records of
+//   U32 size of what follows, U8 type, 16 byte agent id, F64 expires,
+//   and for puts the name as binary LLSD.
+// Host byte order; the file never leaves the machine that wrote it.
+static const char STORE_MAGIC[] = "LLAVNAM1";
+static const U32 STORE_MAGIC_SIZE = sizeof(STORE_MAGIC) - 1;
+static const U32 RECORD_HEADER_SIZE = sizeof(U32) + sizeof(U8) + UUID_BYTES + sizeof(F64);
+
+// Leave small files alone however much of them is superseded.
+static const S32 MIN_COMPACT_RECORDS = 1024;
+
+LLAvatarNameStore::LLAvatarNameStore()
+:	mRecordCount(0)
+{
+}
+
+LLAvatarNameStore::~LLAvatarNameStore()
+{
+	close();
+}
+
+bool LLAvatarNameStore::open(const std::string& filename, F64 min_expires)
+{
+	close();
+	mFilename = filename;
+
+	llifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+	if (!file.is_open())
+	{
+		return true;
+	}
+	file.seekg(0, std::ios::end);
+	std::streamoff length = file.tellg();
+	file.seekg(0, std::ios::beg);
+	if (length <= 0)
+	{
+		return true;
+	}
+	mData.resize((size_t)length);
+	file.read(&mData[0], length);
+	file.close();
+
+	if (mData.size() < STORE_MAGIC_SIZE || mData.compare(0, STORE_MAGIC_SIZE, STORE_MAGIC) != 0)
+	{
+		LL_WARNS("AvNameCache") << "'" << filename << "' is not an avatar name store" << LL_ENDL;
+		mData.clear();
+		return false;
+	}
+
+	U32 pos = STORE_MAGIC_SIZE;
+	const U32 end = (U32)mData.size();
+	while (pos + RECORD_HEADER_SIZE <= end)
+	{
+		U32 size;
+		memcpy(&size, &mData[pos], sizeof(U32));
+		if (size < RECORD_HEADER_SIZE - sizeof(U32) || size > end - pos - sizeof(U32))
+		{
+			break;
+		}
+
+		U8 type = (U8)mData[pos + sizeof(U32)];
+		LLUUID agent_id;
+		memcpy(agent_id.mData, &mData[pos + sizeof(U32) + sizeof(U8)], UUID_BYTES);
+		Entry entry;
+		memcpy(&entry.mExpires, &mData[pos + sizeof(U32) + sizeof(U8) + UUID_BYTES], sizeof(F64));
+		entry.mOffset = pos + RECORD_HEADER_SIZE;
+		entry.mSize = size - (RECORD_HEADER_SIZE - sizeof(U32));
+
+		if (type == RECORD_PUT && entry.mExpires >= min_expires)
+		{
+			mIndex[agent_id] = entry;
+		}
+		else
+		{
+			mIndex.erase(agent_id);
+		}
+		++mRecordCount;
+		pos += sizeof(U32) + size;
+	}
+
+	if (pos != end)
+	{
+		// Cut off the partial record, so that appends line up again.
+		LL_WARNS("AvNameCache") << "Dropping " << end - pos << " bytes of damaged records from '" << filename << "'" << LL_ENDL;
+		mData.resize(pos);
+		llofstream out(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+		out.write(mData.data(), mData.size());
+	}
+
+	LL_INFOS("AvNameCache") << "Indexed " << mIndex.size() << " names from " << mRecordCount << " records in '" << filename << "'" << LL_ENDL;
+	return true;
+}
+
+void LLAvatarNameStore::close()
+{
+	if (isOpen())
+	{
+		flush();
+	}
+	mFilename.clear();
+	mData.clear();
+	mIndex.clear();
+	mPending.clear();
+	mRecordCount = 0;
+}
+
+bool LLAvatarNameStore::take(const LLUUID& agent_id, LLAvatarName& av_name)
+{
+	index_t::iterator it = mIndex.find(agent_id);
+	if (it == mIndex.end())
+	{
+		return false;
+	}
+	const Entry& entry = it->second;
+
+	std::istringstream istr(mData.substr(entry.mOffset, entry.mSize));
+	LLSD sd;
+	bool ok = LLSDSerialize::fromBinary(sd, istr, entry.mSize) != LLSDParser::PARSE_FAILURE && sd.isMap();
+	if (ok)
+	{
+		av_name.fromLLSD(sd);
+		av_name.mExpires = entry.mExpires;
+	}
+	mIndex.erase(it);
+	return ok;
+}
+
+void LLAvatarNameStore::put(const LLUUID& agent_id, const LLAvatarName& av_name)
+{
+	mIndex.erase(agent_id);
+	appendRecord(mPending, RECORD_PUT, agent_id, &av_name);
+	++mRecordCount;
+}
+
+void LLAvatarNameStore::erase(const LLUUID& agent_id)
+{
+	mIndex.erase(agent_id);
+	appendRecord(mPending, RECORD_ERASE, agent_id, NULL);
+	++mRecordCount;
+}
+
+bool LLAvatarNameStore::flush()
+{
+	if (mPending.empty() || !isOpen())
+	{
+		return true;
+	}
+
+	bool is_new = !LLFile::isfile(mFilename);
+	llofstream out(mFilename.c_str(), std::ios::out | std::ios::binary | std::ios::app);
+	if (!out.is_open())
+	{
+		LL_WARNS("AvNameCache") << "Unable to append to '" << mFilename << "'" << LL_ENDL;
+		return false;
+	}
+	if (is_new)
+	{
+		out.write(STORE_MAGIC, STORE_MAGIC_SIZE);
+	}
+	out.write(mPending.data(), mPending.size());
+	mPending.clear();
+	return out.good();
+}
+
+bool LLAvatarNameStore::needsCompaction(size_t held) const
+{
+	S32 live = (S32)(mIndex.size() + held);
+	return mRecordCount > MIN_COMPACT_RECORDS && mRecordCount > live * 2;
+}
+
+// static
+void LLAvatarNameStore::appendRecord(std::string& out, ERecordType type, const LLUUID& agent_id, const LLAvatarName* av_name)
+{
+	std::string payload;
+	F64 expires = 0.0;
+	if (av_name)
+	{
+		std::ostringstream ostr;
+		LLSDSerialize::toBinary(av_name->asLLSD(), ostr);
+		payload = ostr.str();
+		expires = av_name->mExpires;
+	}
+
+	U32 size = RECORD_HEADER_SIZE - sizeof(U32) + (U32)payload.size();
+	U8 type_byte = (U8)type;
+	out.append((const char*)&size, sizeof(U32));
+	out.append((const char*)&type_byte, sizeof(U8));
+	out.append((const char*)agent_id.mData, UUID_BYTES);
+	out.append((const char*)&expires, sizeof(F64));
+	out.append(payload);
+}
+
+bool LLAvatarNameStore::rewrite(const std::string& records, S32 count)
+{
+	if (!isOpen())
+	{
+		return false;
+	}
+
+	std::string data(STORE_MAGIC, STORE_MAGIC_SIZE);
+	data.reserve(STORE_MAGIC_SIZE + records.size() + mIndex.size() * 128);
+	index_t index;
+	for (index_t::const_iterator it = mIndex.begin(); it != mIndex.end(); ++it)
+	{
+		const Entry& entry = it->second;
+		Entry moved = entry;
+		moved.mOffset = (U32)data.size() + RECORD_HEADER_SIZE;
+		data.append(mData, entry.mOffset - RECORD_HEADER_SIZE, RECORD_HEADER_SIZE + entry.mSize);
+		index[it->first] = moved;
+	}
+	data.append(records);
+
+	std::string temp_name = mFilename + ".tmp";
+	{
+		llofstream out(temp_name.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!out.is_open())
+		{
+			LL_WARNS("AvNameCache") << "Unable to write '" << temp_name << "'" << LL_ENDL;
+			return false;
+		}
+		out.write(data.data(), data.size());
+		if (!out.good())
+		{
+			out.close();
+			LLFile::remove(temp_name);
+			return false;
+		}
+	}
+	LLFile::remove_nowarn(mFilename);
+	if (LLFile::rename(temp_name, mFilename) != 0)
+	{
+		return false;
+	}
+
+	LL_INFOS("AvNameCache") << "Compacted '" << mFilename << "' from " << mRecordCount << " to " << index.size() + count << " records" << LL_ENDL;
+	// Whatever was pending is covered by records.
+	mData.swap(data);
+	mIndex.swap(index);
+	mPending.clear();
+	mRecordCount = (S32)mIndex.size() + count;
+	return true;
+}
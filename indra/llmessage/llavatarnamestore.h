@@ -0,0 +1,121 @@
+/**
+ * @file llavatarnamestore.h
+ * @brief Append-only binary file backing LLAvatarNameCache
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLAVATARNAMESTORE_H
+#define LL_LLAVATARNAMESTORE_H
+
+#include "llavatarname.h"
+#include "lluuid.h"
+
+#include <map>
+
+// Log of avatar name records: each put() or erase() appends one record, and
+// the newest record for an id wins when the file is read back.  Opening the
+// store only reads the file and indexes record offsets and expiry times;
+// a record's name is decoded the first time take() asks for it.  Writes are
+// buffered until flush(), and compact() rewrites the file without the
+// records that have been superseded.
+//
+// A record truncated by a crash is dropped on open, along with everything
+// after it.
+class LLAvatarNameStore
+{
+public:
+	LLAvatarNameStore();
+	~LLAvatarNameStore();
+
+	// Reads and indexes filename, creating it on the first flush() if it
+	// does not exist.  Records that expired before min_expires are skipped.
+	// Returns false if the file exists but is not a name store.
+	bool open(const std::string& filename, F64 min_expires);
+	void close();
+	bool isOpen() const					{ return !mFilename.empty(); }
+
+	// If the store holds an undecoded record for agent_id, decodes it into
+	// av_name, forgets it and returns true.  The caller owns the name from
+	// then on, and put()s it again if it changes.
+	bool take(const LLUUID& agent_id, LLAvatarName& av_name);
+
+	void put(const LLUUID& agent_id, const LLAvatarName& av_name);
+	void erase(const LLUUID& agent_id);
+
+	// Appends buffered records to the file.
+	bool flush();
+
+	// True once superseded records make up most of the file.  held is the
+	// number of names the caller has take()n or put() and still keeps.
+	bool needsCompaction(size_t held) const;
+
+	// Rewrites the file with the undecoded records plus one put() per name
+	// in names still valid at min_expires.  names is what the caller has
+	// take()n or put() and still holds.
+	template<typename NAME_MAP>
+	bool compact(const NAME_MAP& names, F64 min_expires)
+	{
+		std::string records;
+		S32 count = 0;
+		for (typename NAME_MAP::const_iterator it = names.begin(); it != names.end(); ++it)
+		{
+			if (it->second.isValidName(min_expires))
+			{
+				appendRecord(records, RECORD_PUT, it->first, &it->second);
+				++count;
+			}
+		}
+		return rewrite(records, count);
+	}
+
+	// Undecoded records.
+	S32 getCount() const				{ return (S32)mIndex.size(); }
+	// Records in the file and the write buffer, superseded or not.
+	S32 getRecordCount() const			{ return mRecordCount; }
+
+private:
+	enum ERecordType
+	{
+		RECORD_PUT = 1,
+		RECORD_ERASE = 2
+	};
+
+	struct Entry
+	{
+		U32 mOffset;		// Of the record's name, in mData
+		U32 mSize;
+		F64 mExpires;
+	};
+	typedef std::map<LLUUID, Entry> index_t;
+
+	static void appendRecord(std::string& out, ERecordType type, const LLUUID& agent_id, const LLAvatarName* av_name);
+	bool rewrite(const std::string& records, S32 count);
+
+	std::string	mFilename;
+	std::string	mData;			// File contents as read by open()
+	index_t		mIndex;
+	std::string	mPending;		// Records not yet flushed
+	S32			mRecordCount;
+};
+
+#endif // LL_LLAVATARNAMESTORE_H
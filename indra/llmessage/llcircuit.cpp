@@ -61,8 +61,8 @@ const S32 PING_START_BLOCK = 3;		// How many pings behind we have to be to consi
 const S32 PING_RELEASE_BLOCK = 2;	// How many pings behind we have to be to consider ourself unblocked.
 
 const F32Seconds TARGET_PERIOD_LENGTH(5.f);
-const F32Seconds LL_DUPLICATE_SUPPRESSION_TIMEOUT(60.f); //this can be long, as time-based cleanup is
-													// only done when wrapping packetids, now...
+// A PacketAck's Packets block is variable, so it holds at most 255.
+const S32 MAX_ACKS_PER_PACKET_ACK = 255;
 
 LLCircuitData::LLCircuitData(const LLHost &host, TPACKETID in_id, 
 							 const F32Seconds circuit_heartbeat_interval, const F32Seconds circuit_timeout)
@@ -103,6 +103,7 @@ LLCircuitData::LLCircuitData(const LLHost &host, TPACKETID in_id,
 	mPeakBPSOut(0.f),
 	mPeriodTime(0.0),
 	mExistenceTimer(),
+	mAckHead(0),
 	mAckCreationTime(0.f),
 	mCurrentResendCount(0),
 	mLastPacketGap(0),
@@ -131,50 +132,32 @@ LLCircuitData::~LLCircuitData()
 	// Clean up all pending transfers.
 	gTransferManager.cleanupConnection(mHost);
 
-	// remove all pending reliable messages on this circuit
+	// remove all pending reliable messages on this circuit, then all
+	// pending final retry reliable messages
 	std::vector<TPACKETID> doomed;
-	reliable_iter iter;
-	reliable_iter end = mUnackedPackets.end();
-	for(iter = mUnackedPackets.begin(); iter != end; ++iter)
+	LLReliablePacketRing* rings[] = { &mUnackedPackets, &mFinalRetryPackets };
+	for (S32 i = 0; i < 2; ++i)
 	{
-		packetp = iter->second;
-		gMessageSystem->mFailedResendPackets++;
-		if(gMessageSystem->mVerboseLog)
+		LLReliablePacketRing::Cursor cursor;
+		for (packetp = rings[i]->first(cursor); packetp; packetp = rings[i]->next(cursor))
 		{
-			doomed.push_back(packetp->mPacketID);
-		}
-		if (packetp->mCallback)
-		{
-			packetp->mCallback(packetp->mCallbackData,LL_ERR_CIRCUIT_GONE);
-		}
-
-		// Update stats
-		mUnackedPacketCount--;
-		mUnackedPacketBytes -= packetp->mBufferLength;
+			rings[i]->remove(packetp->mPacketID);
+			gMessageSystem->mFailedResendPackets++;
+			if(gMessageSystem->mVerboseLog)
+			{
+				doomed.push_back(packetp->mPacketID);
+			}
+			if (packetp->mCallback)
+			{
+				packetp->mCallback(packetp->mCallbackData,LL_ERR_CIRCUIT_GONE);
+			}
 
-		delete packetp;
-	}
+			// Update stats
+			mUnackedPacketCount--;
+			mUnackedPacketBytes -= packetp->mBufferLength;
 
-	// remove all pending final retry reliable messages on this circuit
-	end = mFinalRetryPackets.end();
-	for(iter = mFinalRetryPackets.begin(); iter != end; ++iter)
-	{
-		packetp = iter->second;
-		gMessageSystem->mFailedResendPackets++;
-		if(gMessageSystem->mVerboseLog)
-		{
-			doomed.push_back(packetp->mPacketID);
-		}
-		if (packetp->mCallback)
-		{
-			packetp->mCallback(packetp->mCallbackData,LL_ERR_CIRCUIT_GONE);
+			delete packetp;
 		}
-
-		// Update stats
-		mUnackedPacketCount--;
-		mUnackedPacketBytes -= packetp->mBufferLength;
-
-		delete packetp;
 	}
 
 	// log aborted reliable packets for this circuit.
@@ -191,80 +174,43 @@ LLCircuitData::~LLCircuitData()
 
 void LLCircuitData::ackReliablePacket(TPACKETID packet_num)
 {
-	reliable_iter iter;
-	LLReliablePacket *packetp;
-
-	iter = mUnackedPackets.find(packet_num);
-	if (iter != mUnackedPackets.end())
+	LLReliablePacket *packetp = mUnackedPackets.remove(packet_num);
+	if (!packetp)
 	{
-		packetp = iter->second;
-
-		if(gMessageSystem->mVerboseLog)
-		{
-			std::ostringstream str;
-			str << "MSG: <- " << packetp->mHost << "\tRELIABLE ACKED:\t"
-				<< packetp->mPacketID;
-			LL_INFOS() << str.str() << LL_ENDL;
-		}
-		if (packetp->mCallback)
-		{
-			if (packetp->mTimeout < F32Seconds(0.f))   // negative timeout will always return timeout even for successful ack, for debugging
-			{
-				packetp->mCallback(packetp->mCallbackData,LL_ERR_TCP_TIMEOUT);					
-			}
-			else
-			{
-				packetp->mCallback(packetp->mCallbackData,LL_ERR_NOERR);
-			}
-		}
-
-		// Update stats
-		mUnackedPacketCount--;
-		mUnackedPacketBytes -= packetp->mBufferLength;
-
-		// Cleanup
-		delete packetp;
-		mUnackedPackets.erase(iter);
+		packetp = mFinalRetryPackets.remove(packet_num);
+	}
+	if (!packetp)
+	{
+		// Couldn't find this packet on either of the unacked lists.
+		// maybe it's a duplicate ack?
 		return;
 	}
 
-	iter = mFinalRetryPackets.find(packet_num);
-	if (iter != mFinalRetryPackets.end())
+	if(gMessageSystem->mVerboseLog)
+	{
+		std::ostringstream str;
+		str << "MSG: <- " << packetp->mHost << "\tRELIABLE ACKED:\t"
+			<< packetp->mPacketID;
+		LL_INFOS() << str.str() << LL_ENDL;
+	}
+	if (packetp->mCallback)
 	{
-		packetp = iter->second;
-		// LL_INFOS() << "Packet " << packet_num << " removed from the pending list" << LL_ENDL;
-		if(gMessageSystem->mVerboseLog)
+		if (packetp->mTimeout < F32Seconds(0.f))   // negative timeout will always return timeout even for successful ack, for debugging
 		{
-			std::ostringstream str;
-			str << "MSG: <- " << packetp->mHost << "\tRELIABLE ACKED:\t"
-				<< packetp->mPacketID;
-			LL_INFOS() << str.str() << LL_ENDL;
+			packetp->mCallback(packetp->mCallbackData,LL_ERR_TCP_TIMEOUT);					
 		}
-		if (packetp->mCallback)
+		else
 		{
-			if (packetp->mTimeout < F32Seconds(0.f))   // negative timeout will always return timeout even for successful ack, for debugging
-			{
-				packetp->mCallback(packetp->mCallbackData,LL_ERR_TCP_TIMEOUT);					
-			}
-			else
-			{
-				packetp->mCallback(packetp->mCallbackData,LL_ERR_NOERR);
-			}
+			packetp->mCallback(packetp->mCallbackData,LL_ERR_NOERR);
 		}
+	}
 
-		// Update stats
-		mUnackedPacketCount--;
-		mUnackedPacketBytes -= packetp->mBufferLength;
+	// Update stats
+	mUnackedPacketCount--;
+	mUnackedPacketBytes -= packetp->mBufferLength;
 
-		// Cleanup
-		delete packetp;
-		mFinalRetryPackets.erase(iter);
-	}
-	else
-	{
-		// Couldn't find this packet on either of the unacked lists.
-		// maybe it's a duplicate ack?
-	}
+	// Cleanup
+	delete packetp;
 }
 
 
@@ -276,17 +222,14 @@ S32 LLCircuitData::resendUnackedPackets(const F64Seconds now)
 
 
 	//
-	// Theoretically we should search through the list for the packet with the oldest
-	// packet ID, as otherwise when we WRAP we will resend reliable packets out of order.
-	// Since resends are ALREADY out of order, and wrapping is highly rare (16+million packets),
-	// I'm not going to worry about this for now - djs
+	// The rings walk packets in sequence order, so resends go out oldest
+	// first even across a packet id wrap.
 	//
 
-	reliable_iter iter;
+	LLReliablePacketRing::Cursor cursor;
 	BOOL have_resend_overflow = FALSE;
-	for (iter = mUnackedPackets.begin(); iter != mUnackedPackets.end();)
+	for (packetp = mUnackedPackets.first(cursor); packetp; packetp = mUnackedPackets.next(cursor))
 	{
-		packetp = iter->second;
 
 		// Only check overflow if we haven't had one yet.
 		if (!have_resend_overflow)
@@ -307,12 +250,8 @@ S32 LLCircuitData::resendUnackedPackets(const F64Seconds now)
 					// This circuit has overflowed.  Do not retry.  Do not pass go.
 					packetp->mRetries = 0;
 					// Remove it from this list and add it to the final list.
-					mUnackedPackets.erase(iter++);
-					mFinalRetryPackets[packetp->mPacketID] = packetp;
-				}
-				else
-				{
-					++iter;
+					mUnackedPackets.remove(packetp->mPacketID);
+					mFinalRetryPackets.insert(packetp);
 				}
 				// Move on to the next unacked packet.
 				continue;
@@ -367,27 +306,17 @@ S32 LLCircuitData::resendUnackedPackets(const F64Seconds now)
 			if (!packetp->mRetries)
 			{
 				// Last resend, remove it from this list and add it to the final list.
-				mUnackedPackets.erase(iter++);
-				mFinalRetryPackets[packetp->mPacketID] = packetp;
-			}
-			else
-			{
-				// Don't remove it yet, it still gets to try to resend at least once.
-				++iter;
+				mUnackedPackets.remove(packetp->mPacketID);
+				mFinalRetryPackets.insert(packetp);
 			}
+			// Otherwise don't remove it yet, it still gets to try to resend at least once.
 			resent_packets++;
 		}
-		else
-		{
-			// Don't need to do anything with this packet, keep iterating.
-			++iter;
-		}
 	}
 
 
-	for (iter = mFinalRetryPackets.begin(); iter != mFinalRetryPackets.end();)
+	for (packetp = mFinalRetryPackets.first(cursor); packetp; packetp = mFinalRetryPackets.next(cursor))
 	{
-		packetp = iter->second;
 		if (now > packetp->mExpirationTime)
 		{
 			// fail (too many retries)
@@ -415,13 +344,9 @@ S32 LLCircuitData::resendUnackedPackets(const F64Seconds now)
 			mUnackedPacketCount--;
 			mUnackedPacketBytes -= packetp->mBufferLength;
 
-			mFinalRetryPackets.erase(iter++);
+			mFinalRetryPackets.remove(packetp->mPacketID);
 			delete packetp;
 		}
-		else
-		{
-			++iter;
-		}
 	}
 
 	return mUnackedPacketCount;
@@ -571,11 +496,11 @@ void LLCircuitData::addReliablePacket(S32 mSocket, U8 *buf_ptr, S32 buf_len, LLR
 
 	if (params && params->mRetries)
 	{
-		mUnackedPackets[packet_info->mPacketID] = packet_info;
+		mUnackedPackets.insert(packet_info);
 	}
 	else
 	{
-		mFinalRetryPackets[packet_info->mPacketID] = packet_info;
+		mFinalRetryPackets.insert(packet_info);
 	}
 }
 
@@ -599,7 +524,7 @@ void LLCircuit::resendUnackedPackets(S32& unacked_list_length, S32& unacked_list
 
 BOOL LLCircuitData::isDuplicateResend(TPACKETID packetnum)
 {
-	return (mRecentlyReceivedReliablePackets.find(packetnum) != mRecentlyReceivedReliablePackets.end());
+	return mRecentlyReceivedReliablePackets.contains(packetnum);
 }
 
 
@@ -864,89 +789,22 @@ BOOL LLCircuitData::updateWatchDogTimers(LLMessageSystem *msgsys)
 	// This is to handle the case if we actually manage to wrap our
 	// packet IDs - the oldest will actually have a higher packet ID
 	// than the current.
-	BOOL wrapped = FALSE;
-	reliable_iter iter;
-	iter = mUnackedPackets.upper_bound(getPacketOutID());
-	if (iter == mUnackedPackets.end())
+	TPACKETID current_id = getPacketOutID();
+	TPACKETID packet_id = current_id;
+	TPACKETID oldest_final = 0;
+	BOOL have_unacked = mUnackedPackets.getOldestID(current_id, packet_id);
+	if (mFinalRetryPackets.getOldestID(current_id, oldest_final))
 	{
-		// Nothing AFTER this one, so we want the lowest packet ID
-		// then.
-		iter = mUnackedPackets.begin();
-		wrapped = TRUE;
-	}
-
-	TPACKETID packet_id = 0;
-
-	// Check against the "final" packets
-	BOOL wrapped_final = FALSE;
-	reliable_iter iter_final;
-	iter_final = mFinalRetryPackets.upper_bound(getPacketOutID());
-	if (iter_final == mFinalRetryPackets.end())
-	{
-		iter_final = mFinalRetryPackets.begin();
-		wrapped_final = TRUE;
-	}
-
-	//LL_INFOS() << mHost << " - unacked count " << mUnackedPackets.size() << LL_ENDL;
-	//LL_INFOS() << mHost << " - final count " << mFinalRetryPackets.size() << LL_ENDL;
-	if (wrapped != wrapped_final)
-	{
-		// One of the "unacked" or "final" lists hasn't wrapped.  Whichever one
-		// hasn't has the oldest packet.
-		if (!wrapped)
+		// Use whichever of the unacked and final lists has the oldest packet.
+		if (!have_unacked
+			|| ((current_id - oldest_final) % LL_MAX_OUT_PACKET_ID) > ((current_id - packet_id) % LL_MAX_OUT_PACKET_ID))
 		{
-			// Hasn't wrapped, so the one on the
-			// unacked packet list is older
-			packet_id = iter->first;
-			//LL_INFOS() << mHost << ": nowrapped unacked" << LL_ENDL;
-		}
-		else
-		{
-			packet_id = iter_final->first;
-			//LL_INFOS() << mHost << ": nowrapped final" << LL_ENDL;
-		}
-	}
-	else
-	{
-		// They both wrapped, we can just use the minimum of the two.
-		if ((iter == mUnackedPackets.end()) && (iter_final == mFinalRetryPackets.end()))
-		{
-			// Wow!  No unacked packets at all!
-			// Send the ID of the last packet we sent out.
-			// This will flush all of the destination's
-			// unacked packets, theoretically.
-			//LL_INFOS() << mHost << ": No unacked!" << LL_ENDL;
-			packet_id = getPacketOutID();
-		}
-		else
-		{
-			BOOL had_unacked = FALSE;
-			if (iter != mUnackedPackets.end())
-			{
-				// Unacked list has the lowest so far
-				packet_id = iter->first;
-				had_unacked = TRUE;
-				//LL_INFOS() << mHost << ": Unacked" << LL_ENDL;
-			}
-
-			if (iter_final != mFinalRetryPackets.end())
-			{
-				// Use the lowest of the unacked list and the final list
-				if (had_unacked)
-				{
-					// Both had a packet, use the lowest.
-					packet_id = llmin(packet_id, iter_final->first);
-					//LL_INFOS() << mHost << ": Min of unacked/final" << LL_ENDL;
-				}
-				else
-				{
-					// Only the final had a packet, use it.
-					packet_id = iter_final->first;
-					//LL_INFOS() << mHost << ": Final!" << LL_ENDL;
-				}
-			}
+			packet_id = oldest_final;
 		}
 	}
+	// With no unacked packets at all, this sends the ID of the last packet
+	// we sent out. This will flush all of the destination's unacked
+	// packets, theoretically.
 
 	// Send off the another ping.
 	pingTimerStart();
@@ -998,45 +856,13 @@ void LLCircuitData::clearDuplicateList(TPACKETID oldest_id)
 	// we want to KEEP all x where oldest_id <= x <= last incoming packet, and delete everything else.
 
 	//LL_INFOS() << mHost << ": clearing before oldest " << oldest_id << LL_ENDL;
-	//LL_INFOS() << "Recent list before: " << mRecentlyReceivedReliablePackets.size() << LL_ENDL;
-	if (oldest_id < mHighestPacketID)
-	{
-		// Clean up everything with a packet ID less than oldest_id.
-		packet_time_map::iterator pit_start;
-		packet_time_map::iterator pit_end;
-		pit_start = mRecentlyReceivedReliablePackets.begin();
-		pit_end = mRecentlyReceivedReliablePackets.lower_bound(oldest_id);
-		mRecentlyReceivedReliablePackets.erase(pit_start, pit_end);
-	}
+	//LL_INFOS() << "Recent list before: " << mRecentlyReceivedReliablePackets.getCount() << LL_ENDL;
 
-	// Do timeout checks on everything with an ID > mHighestPacketID.
-	// This should be empty except for wrapping IDs.  Thus, this should be
-	// highly rare.
-	U64Microseconds mt_usec = LLMessageSystem::getMessageTimeUsecs();
+	// The window compares ids modulo the id space, so this also does the
+	// right thing when ids wrap, without waiting out a timeout.
+	mRecentlyReceivedReliablePackets.clearBefore(oldest_id);
 
-	packet_time_map::iterator pit;
-	for(pit = mRecentlyReceivedReliablePackets.upper_bound(mHighestPacketID);
-		pit != mRecentlyReceivedReliablePackets.end(); )
-	{
-		// Validate that the packet ID seems far enough away
-		if ((pit->first - mHighestPacketID) < 100)
-		{
-			LL_WARNS() << "Probably incorrectly timing out non-wrapped packets!" << LL_ENDL;
-		}
-		U64Microseconds delta_t_usec = mt_usec - (*pit).second;
-		F64Seconds delta_t_sec = delta_t_usec;
-		if (delta_t_sec > LL_DUPLICATE_SUPPRESSION_TIMEOUT)
-		{
-			// enough time has elapsed we're not likely to get a duplicate on this one
-			LL_INFOS() << "Clearing " << pit->first << " from recent list" << LL_ENDL;
-			mRecentlyReceivedReliablePackets.erase(pit++);
-		}
-		else
-		{
-			++pit;
-		}
-	}
-	//LL_INFOS() << "Recent list after: " << mRecentlyReceivedReliablePackets.size() << LL_ENDL;
+	//LL_INFOS() << "Recent list after: " << mRecentlyReceivedReliablePackets.getCount() << LL_ENDL;
 }
 
 BOOL LLCircuitData::checkCircuitTimeout()
@@ -1068,7 +894,7 @@ BOOL LLCircuitData::checkCircuitTimeout()
 // correctly place the packet in the correct list to be acked later.
 BOOL LLCircuitData::collectRAck(TPACKETID packet_num)
 {
-	if (mAcks.empty())
+	if (!getPendingAckCount())
 	{
 		// First extra ack, we need to add ourselves to the list of circuits that need to send acks
 		gMessageSystem->mCircuitInfo.mSendAckMap[mHost] = this;
@@ -1082,6 +908,27 @@ BOOL LLCircuitData::collectRAck(TPACKETID packet_num)
 	return TRUE;
 }
 
+S32 LLCircuitData::packAcks(U8* buffer, S32 max_count)
+{
+	S32 count = llmin(max_count, getPendingAckCount());
+	const TPACKETID* acks = &mAcks[mAckHead];
+	for (S32 i = 0; i < count; ++i)
+	{
+		TPACKETID packet_id = htonl(acks[i]);
+		memcpy(buffer + i * sizeof(TPACKETID), &packet_id, sizeof(TPACKETID));	/* Flawfinder: ignore */
+	}
+
+	// Consume from the front without shifting the rest down; the vector
+	// keeps its capacity for the next round of acks.
+	mAckHead += count;
+	if (mAckHead == (S32)mAcks.size())
+	{
+		mAcks.clear();
+		mAckHead = 0;
+	}
+	return count;
+}
+
 // this method is called during the message system processAcks() to
 // send out any acks that did not get sent already.
 void LLCircuit::sendAcks(F32 collect_time)
@@ -1093,7 +940,7 @@ void LLCircuit::sendAcks(F32 collect_time)
 	{
 		circuit_data_map::iterator cur_it = it++;
 		cd = (*cur_it).second;
-		S32 count = (S32)cd->mAcks.size();
+		S32 count = cd->getPendingAckCount();
 		F32 age = cd->getAgeInSeconds() - cd->mAckCreationTime;
 		if (age > collect_time || count == 0)
 		{
@@ -1108,9 +955,9 @@ void LLCircuit::sendAcks(F32 collect_time)
 					gMessageSystem->newMessageFast(_PREHASH_PacketAck);
 				}
 				gMessageSystem->nextBlockFast(_PREHASH_Packets);
-				gMessageSystem->addU32Fast(_PREHASH_ID, cd->mAcks[i]);
+				gMessageSystem->addU32Fast(_PREHASH_ID, cd->mAcks[cd->mAckHead + i]);
 				++acks_this_packet;
-				if(acks_this_packet > 250)
+				if(acks_this_packet >= MAX_ACKS_PER_PACKET_ACK)
 				{
 					gMessageSystem->sendMessage(cd->mHost);
 					acks_this_packet = 0;
@@ -1126,12 +973,13 @@ void LLCircuit::sendAcks(F32 collect_time)
 				std::ostringstream str;
 				str << "MSG: -> " << cd->mHost << "\tPACKET ACKS:\t";
 				std::ostream_iterator<TPACKETID> append(str, " ");
-				std::copy(cd->mAcks.begin(), cd->mAcks.end(), append);
+				std::copy(cd->mAcks.begin() + cd->mAckHead, cd->mAcks.end(), append);
 				LL_INFOS() << str.str() << LL_ENDL;
 			}
 
 				// empty out the acks list
 				cd->mAcks.clear();
+				cd->mAckHead = 0;
 				cd->mAckCreationTime = 0.f;
 			}
 			// remove data map
@@ -181,6 +181,10 @@ protected:
 	// correctly place the packet in the correct list to be acked
 	// later. RAack = requested ack
 	BOOL collectRAck(TPACKETID packet_num);
+	S32			getPendingAckCount() const		{ return (S32)mAcks.size() - mAckHead; }
+	// Writes up to max_count pending acks to buffer in network order and
+	// drops them from the pending list. Returns the number written.
+	S32			packAcks(U8* buffer, S32 max_count);
 
 
 	void			setTimeoutCallback(void (*callback_func)(const LLHost &host, void *user_data), void *user_data);
@@ -236,15 +240,13 @@ protected:
 	typedef std::map<TPACKETID, U64Microseconds> packet_time_map;
 
 	packet_time_map							mPotentialLostPackets;
-	packet_time_map							mRecentlyReceivedReliablePackets;
+	LLPacketIDWindow						mRecentlyReceivedReliablePackets;
 	std::vector<TPACKETID> mAcks;
+	S32 mAckHead; // first ack in mAcks not yet sent
 	F32 mAckCreationTime; // first ack creation time
 
-	typedef std::map<TPACKETID, LLReliablePacket *> reliable_map;
-	typedef reliable_map::iterator					reliable_iter;
-
-	reliable_map							mUnackedPackets;
-	reliable_map							mFinalRetryPackets;
+	LLReliablePacketRing					mUnackedPackets;
+	LLReliablePacketRing					mFinalRetryPackets;
 
 	S32										mUnackedPacketCount;
 	S32										mUnackedPacketBytes;
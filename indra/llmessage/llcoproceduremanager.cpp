@@ -27,6 +27,8 @@
 
 #include "linden_common.h" 
 #include "llcoproceduremanager.h"
+#include "lltimer.h"
+#include "lltrace.h"
 #include <boost/assign.hpp>
 
 //=========================================================================
@@ -39,15 +41,78 @@ static std::map<std::string, U32> DefaultPoolSizes =
         (std::string("AIS"),     1);    
         // *TODO: Rider for the moment keep AIS calls serialized otherwise the COF will tend to get out of sync.
 
+// Most coroutines a known pool may grow to under load.  AIS stays serialized 
+// for the reason above.
+static std::map<std::string, U32> DefaultPoolMaxSizes = 
+    boost::assign::map_list_of
+        (std::string("Upload"),  4)
+        (std::string("AIS"),     1);
+
 #define DEFAULT_POOL_SIZE 5
+#define DEFAULT_POOL_GROWTH 2
+
+// A pool grows when, at its observed execution time, the newest request 
+// would wait in the queue longer than this.
+static const F64 POOL_GROW_WAIT_SECS = 0.5;
+// Weight of each new sample in the running average of execution time.
+static const F64 EXEC_TIME_SMOOTHING = 0.2;
+
+// Upper bounds, in seconds, of the histogram buckets; the last one is open.
+static const F64 HISTOGRAM_BOUNDS[] = { 0.05, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0 };
+static const S32 HISTOGRAM_BUCKETS = LL_ARRAY_SIZE(HISTOGRAM_BOUNDS) + 1;
+
+// Trace stats have to exist before the thread recorders are created, so 
+// pools other than the known ones share one pair.
+static LLTrace::EventStatHandle<F64Seconds> sAISWaitTime("coproc_wait_AIS", "Time AIS requests spend queued");
+static LLTrace::EventStatHandle<F64Seconds> sAISExecTime("coproc_exec_AIS", "Time AIS requests take to run");
+static LLTrace::EventStatHandle<F64Seconds> sUploadWaitTime("coproc_wait_Upload", "Time uploads spend queued");
+static LLTrace::EventStatHandle<F64Seconds> sUploadExecTime("coproc_exec_Upload", "Time uploads take to run");
+static LLTrace::EventStatHandle<F64Seconds> sExpCacheWaitTime("coproc_wait_ExpCache", "Time experience lookups spend queued");
+static LLTrace::EventStatHandle<F64Seconds> sExpCacheExecTime("coproc_exec_ExpCache", "Time experience lookups take to run");
+static LLTrace::EventStatHandle<F64Seconds> sOtherWaitTime("coproc_wait_other", "Time other coprocedures spend queued");
+static LLTrace::EventStatHandle<F64Seconds> sOtherExecTime("coproc_exec_other", "Time other coprocedures take to run");
+
+//=========================================================================
+class LLCoprocedureHistogram
+{
+public:
+    LLCoprocedureHistogram()
+    {
+        memset(mCounts, 0, sizeof(mCounts));
+    }
+
+    void record(F64 seconds)
+    {
+        S32 bucket = 0;
+        while (bucket < HISTOGRAM_BUCKETS - 1 && seconds > HISTOGRAM_BOUNDS[bucket])
+        {
+            ++bucket;
+        }
+        ++mCounts[bucket];
+    }
+
+    LLSD asLLSD() const
+    {
+        LLSD counts = LLSD::emptyArray();
+        for (S32 i = 0; i < HISTOGRAM_BUCKETS; ++i)
+        {
+            counts.append(LLSD::Integer(mCounts[i]));
+        }
+        return counts;
+    }
+
+private:
+    U32 mCounts[HISTOGRAM_BUCKETS];
+};
 
 //=========================================================================
 class LLCoprocedurePool: private boost::noncopyable
 {
 public:
     typedef LLCoprocedureManager::CoProcedure_t CoProcedure_t;
+    typedef LLCoprocedureManager::EPriority EPriority;
 
-    LLCoprocedurePool(const std::string &name, size_t size);
+    LLCoprocedurePool(const std::string &name, size_t size, size_t maxSize);
     virtual ~LLCoprocedurePool();
 
     /// Places the coprocedure on the queue for processing. 
@@ -56,7 +121,7 @@ public:
     /// @param proc Is a bound function to be executed 
     /// 
     /// @return This method returns a UUID that can be used later to cancel execution.
-    LLUUID enqueueCoprocedure(const std::string &name, CoProcedure_t proc);
+    LLUUID enqueueCoprocedure(const std::string &name, CoProcedure_t proc, EPriority priority, const std::string &coalesceKey);
 
     /// Cancel a coprocedure. If the coprocedure is already being actively executed 
     /// this method calls cancelSuspendedOperation() on the associated HttpAdapter
@@ -71,7 +136,12 @@ public:
     ///
     inline size_t countPending() const
     {
-        return mPendingCoprocs.size();
+        size_t count = 0;
+        for (S32 i = 0; i < LLCoprocedureManager::PRIORITY_COUNT; ++i)
+        {
+            count += mPendingCoprocs[i].size();
+        }
+        return count;
     }
 
     /// Returns the number of coprocedures actively being processed.
@@ -88,20 +158,26 @@ public:
         return countPending() + countActive();
     }
 
+    LLSD getStats() const;
+
 private:
     struct QueuedCoproc
     {
         typedef boost::shared_ptr<QueuedCoproc> ptr_t;
 
-        QueuedCoproc(const std::string &name, const LLUUID &id, CoProcedure_t proc) :
+        QueuedCoproc(const std::string &name, const LLUUID &id, CoProcedure_t proc, const std::string &coalesceKey) :
             mName(name),
             mId(id),
-            mProc(proc)
+            mProc(proc),
+            mCoalesceKey(coalesceKey),
+            mEnqueueTime(LLTimer::getTotalSeconds())
         {}
 
         std::string mName;
         LLUUID mId;
         CoProcedure_t mProc;
+        std::string mCoalesceKey;
+        F64 mEnqueueTime;
     };
 
     // we use a deque here rather than std::queue since we want to be able to 
@@ -111,7 +187,8 @@ private:
 
     std::string     mPoolName;
     size_t          mPoolSize;
-    CoprocQueue_t   mPendingCoprocs;
+    size_t          mMaxPoolSize;
+    CoprocQueue_t   mPendingCoprocs[LLCoprocedureManager::PRIORITY_COUNT];
     ActiveCoproc_t  mActiveCoprocs;
     bool            mShutdown;
     LLEventStream   mWakeupTrigger;
@@ -121,12 +198,27 @@ private:
 
     CoroAdapterMap_t mCoroMapping;
 
+    F64             mAvgExecTime;
+    U32             mCoalescedCount;
+    U32             mPeakCoroCount;
+    LLCoprocedureHistogram mWaitHistogram;
+    LLCoprocedureHistogram mExecHistogram;
+    LLTrace::EventStatHandle<F64Seconds>& mWaitStat;
+    LLTrace::EventStatHandle<F64Seconds>& mExecStat;
+
+    void launchCoro(bool transient);
+    void growIfBacklogged();
+    QueuedCoproc::ptr_t popNextCoproc();
+    void invokeCoproc(const QueuedCoproc::ptr_t &coproc, LLCoreHttpUtil::HttpCoroutineAdapter::ptr_t &httpAdapter);
+
     void coprocedureInvokerCoro(LLCoreHttpUtil::HttpCoroutineAdapter::ptr_t httpAdapter);
+    void transientInvokerCoro(LLCoreHttpUtil::HttpCoroutineAdapter::ptr_t httpAdapter);
 
 };
 
 //=========================================================================
-LLCoprocedureManager::LLCoprocedureManager()
+LLCoprocedureManager::LLCoprocedureManager() :
+    mConnectionLimit(0)
 {
 }
 
@@ -139,7 +231,9 @@ LLCoprocedureManager::poolPtr_t LLCoprocedureManager::initializePool(const std::
 {
     // Attempt to look up a pool size in the configuration.  If found use that
     std::string keyName = "PoolSize" + poolName;
+    std::string maxKeyName = "PoolSizeMax" + poolName;
     int size = 0;
+    int maxSize = 0;
 
     if (poolName.empty())
         LL_ERRS("CoprocedureManager") << "Poolname must not be empty" << LL_ENDL;
@@ -147,6 +241,7 @@ LLCoprocedureManager::poolPtr_t LLCoprocedureManager::initializePool(const std::
     if (mPropertyQueryFn && !mPropertyQueryFn.empty())
     {
         size = mPropertyQueryFn(keyName);
+        maxSize = mPropertyQueryFn(maxKeyName);
     }
 
     if (size == 0)
@@ -163,7 +258,25 @@ LLCoprocedureManager::poolPtr_t LLCoprocedureManager::initializePool(const std::
         LL_WARNS() << "LLCoprocedureManager: No setting for \"" << keyName << "\" setting pool size to default of " << size << LL_ENDL;
     }
 
-    poolPtr_t pool(new LLCoprocedurePool(poolName, size));
+    if (maxSize == 0)
+    {
+        std::map<std::string, U32>::iterator it = DefaultPoolMaxSizes.find(poolName);
+        if (it == DefaultPoolMaxSizes.end())
+            maxSize = size * DEFAULT_POOL_GROWTH;
+        else
+            maxSize = (*it).second;
+
+        if (mPropertyDefineFn && !mPropertyDefineFn.empty())
+            mPropertyDefineFn(maxKeyName, maxSize, "Most coroutines the " + poolName + " pool may grow to when backlogged");
+    }
+
+    if (mConnectionLimit > 0)
+    {
+        maxSize = llmin(maxSize, (int)mConnectionLimit);
+    }
+    maxSize = llmax(maxSize, size);
+
+    poolPtr_t pool(new LLCoprocedurePool(poolName, size, maxSize));
     mPoolMap.insert(poolMap_t::value_type(poolName, pool));
 
     if (!pool)
@@ -172,7 +285,8 @@ LLCoprocedureManager::poolPtr_t LLCoprocedureManager::initializePool(const std::
 }
 
 //-------------------------------------------------------------------------
-LLUUID LLCoprocedureManager::enqueueCoprocedure(const std::string &pool, const std::string &name, CoProcedure_t proc)
+LLUUID LLCoprocedureManager::enqueueCoprocedure(const std::string &pool, const std::string &name, CoProcedure_t proc,
+    EPriority priority, const std::string &coalesceKey)
 {
     // Attempt to find the pool and enqueue the procedure.  If the pool does 
     // not exist, create it.
@@ -188,7 +302,7 @@ LLUUID LLCoprocedureManager::enqueueCoprocedure(const std::string &pool, const s
         targetPool = (*it).second;
     }
 
-    return targetPool->enqueueCoprocedure(name, proc);
+    return targetPool->enqueueCoprocedure(name, proc, priority, coalesceKey);
 }
 
 void LLCoprocedureManager::cancelCoprocedure(const LLUUID &id)
@@ -205,6 +319,7 @@ void LLCoprocedureManager::shutdown(bool hardShutdown)
 {
     for (poolMap_t::const_iterator it = mPoolMap.begin(); it != mPoolMap.end(); ++it)
     {
+        LL_INFOS("CoprocedureManager") << "Pool \"" << (*it).first << "\" stats: " << (*it).second->getStats() << LL_ENDL;
         (*it).second->shutdown(hardShutdown);
     }
     mPoolMap.clear();
@@ -216,6 +331,11 @@ void LLCoprocedureManager::setPropertyMethods(SettingQuery_t queryfn, SettingUpd
     mPropertyDefineFn = updatefn;
 }
 
+void LLCoprocedureManager::setConnectionLimit(U32 limit)
+{
+    mConnectionLimit = limit;
+}
+
 //-------------------------------------------------------------------------
 size_t LLCoprocedureManager::countPending() const
 {
@@ -274,27 +394,59 @@ size_t LLCoprocedureManager::count(const std::string &pool) const
     return (*it).second->count();
 }
 
+LLSD LLCoprocedureManager::getStats() const
+{
+    LLSD stats = LLSD::emptyMap();
+    for (poolMap_t::const_iterator it = mPoolMap.begin(); it != mPoolMap.end(); ++it)
+    {
+        stats[(*it).first] = (*it).second->getStats();
+    }
+    return stats;
+}
+
 //=========================================================================
-LLCoprocedurePool::LLCoprocedurePool(const std::string &poolName, size_t size):
+static LLTrace::EventStatHandle<F64Seconds>& getWaitStat(const std::string &poolName)
+{
+    if (poolName == "AIS")
+        return sAISWaitTime;
+    if (poolName == "Upload")
+        return sUploadWaitTime;
+    if (poolName == "ExpCache")
+        return sExpCacheWaitTime;
+    return sOtherWaitTime;
+}
+
+static LLTrace::EventStatHandle<F64Seconds>& getExecStat(const std::string &poolName)
+{
+    if (poolName == "AIS")
+        return sAISExecTime;
+    if (poolName == "Upload")
+        return sUploadExecTime;
+    if (poolName == "ExpCache")
+        return sExpCacheExecTime;
+    return sOtherExecTime;
+}
+
+LLCoprocedurePool::LLCoprocedurePool(const std::string &poolName, size_t size, size_t maxSize):
     mPoolName(poolName),
     mPoolSize(size),
-    mPendingCoprocs(),
+    mMaxPoolSize(maxSize),
     mShutdown(false),
     mWakeupTrigger("CoprocedurePool" + poolName, true),
     mCoroMapping(),
-    mHTTPPolicy(LLCore::HttpRequest::DEFAULT_POLICY_ID)
+    mHTTPPolicy(LLCore::HttpRequest::DEFAULT_POLICY_ID),
+    mAvgExecTime(0.0),
+    mCoalescedCount(0),
+    mPeakCoroCount(0),
+    mWaitStat(getWaitStat(poolName)),
+    mExecStat(getExecStat(poolName))
 {
     for (size_t count = 0; count < mPoolSize; ++count)
     {
-        LLCoreHttpUtil::HttpCoroutineAdapter::ptr_t httpAdapter(new LLCoreHttpUtil::HttpCoroutineAdapter( mPoolName + "Adapter", mHTTPPolicy));
-
-        std::string pooledCoro = LLCoros::instance().launch("LLCoprocedurePool("+mPoolName+")::coprocedureInvokerCoro",
-            boost::bind(&LLCoprocedurePool::coprocedureInvokerCoro, this, httpAdapter));
-
-        mCoroMapping.insert(CoroAdapterMap_t::value_type(pooledCoro, httpAdapter));
+        launchCoro(false);
     }
 
-    LL_INFOS() << "Created coprocedure pool named \"" << mPoolName << "\" with " << size << " items." << LL_ENDL;
+    LL_INFOS() << "Created coprocedure pool named \"" << mPoolName << "\" with " << size << " items, growing to at most " << maxSize << "." << LL_ENDL;
 
     mWakeupTrigger.post(LLSD());
 }
@@ -323,17 +475,32 @@ void LLCoprocedurePool::shutdown(bool hardShutdown)
 
     mShutdown = true;
     mCoroMapping.clear();
-    mPendingCoprocs.clear();
+    for (S32 i = 0; i < LLCoprocedureManager::PRIORITY_COUNT; ++i)
+    {
+        mPendingCoprocs[i].clear();
+    }
 }
 
 //-------------------------------------------------------------------------
-LLUUID LLCoprocedurePool::enqueueCoprocedure(const std::string &name, LLCoprocedurePool::CoProcedure_t proc)
+LLUUID LLCoprocedurePool::enqueueCoprocedure(const std::string &name, LLCoprocedurePool::CoProcedure_t proc,
+    EPriority priority, const std::string &coalesceKey)
 {
+    priority = llclamp(priority, LLCoprocedureManager::PRIORITY_LOW, LLCoprocedureManager::PRIORITY_NORMAL);
+    CoprocQueue_t &queue = mPendingCoprocs[priority];
+    if (!coalesceKey.empty() && !queue.empty() && queue.back()->mCoalesceKey == coalesceKey)
+    {
+        ++mCoalescedCount;
+        LL_DEBUGS("CoprocedureManager") << "Coprocedure(" << name << ") coalesced with queued id=" << queue.back()->mId.asString() << " in pool \"" << mPoolName << "\"" << LL_ENDL;
+        return queue.back()->mId;
+    }
+
     LLUUID id(LLUUID::generateNewID());
+    QueuedCoproc::ptr_t coproc(new QueuedCoproc(name, id, proc, coalesceKey));
 
-    mPendingCoprocs.push_back(QueuedCoproc::ptr_t(new QueuedCoproc(name, id, proc)));
+    queue.push_back(coproc);
     LL_INFOS() << "Coprocedure(" << name << ") enqueued with id=" << id.asString() << " in pool \"" << mPoolName << "\"" << LL_ENDL;
 
+    growIfBacklogged();
     mWakeupTrigger.post(LLSD());
 
     return id;
@@ -351,13 +518,17 @@ bool LLCoprocedurePool::cancelCoprocedure(const LLUUID &id)
         return true;
     }
 
-    for (CoprocQueue_t::iterator it = mPendingCoprocs.begin(); it != mPendingCoprocs.end(); ++it)
+    for (S32 i = 0; i < LLCoprocedureManager::PRIORITY_COUNT; ++i)
     {
-        if ((*it)->mId == id)
+        CoprocQueue_t &queue = mPendingCoprocs[i];
+        for (CoprocQueue_t::iterator it = queue.begin(); it != queue.end(); ++it)
         {
-            LL_INFOS() << "Found and removing queued coroutine(" << (*it)->mName << ") with Id=" << id.asString() << " in pool \"" << mPoolName << "\"" << LL_ENDL;
-            mPendingCoprocs.erase(it);
-            return true;
+            if ((*it)->mId == id)
+            {
+                LL_INFOS() << "Found and removing queued coroutine(" << (*it)->mName << ") with Id=" << id.asString() << " in pool \"" << mPoolName << "\"" << LL_ENDL;
+                queue.erase(it);
+                return true;
+            }
         }
     }
 
@@ -365,42 +536,167 @@ bool LLCoprocedurePool::cancelCoprocedure(const LLUUID &id)
     return false;
 }
 
+LLSD LLCoprocedurePool::getStats() const
+{
+    LLSD stats;
+    stats["pending"] = LLSD::Integer(countPending());
+    stats["active"] = LLSD::Integer(countActive());
+    stats["coroutines"] = LLSD::Integer(mCoroMapping.size());
+    stats["peak_coroutines"] = LLSD::Integer(mPeakCoroCount);
+    stats["coalesced"] = LLSD::Integer(mCoalescedCount);
+    stats["avg_exec_secs"] = mAvgExecTime;
+
+    LLSD bounds = LLSD::emptyArray();
+    for (S32 i = 0; i < HISTOGRAM_BUCKETS - 1; ++i)
+    {
+        bounds.append(HISTOGRAM_BOUNDS[i]);
+    }
+    stats["histogram_bounds"] = bounds;
+    stats["wait_histogram"] = mWaitHistogram.asLLSD();
+    stats["exec_histogram"] = mExecHistogram.asLLSD();
+    return stats;
+}
+
 //-------------------------------------------------------------------------
-void LLCoprocedurePool::coprocedureInvokerCoro(LLCoreHttpUtil::HttpCoroutineAdapter::ptr_t httpAdapter)
+void LLCoprocedurePool::launchCoro(bool transient)
 {
-    LLCore::HttpRequest::ptr_t httpRequest(new LLCore::HttpRequest);
+    LLCoreHttpUtil::HttpCoroutineAdapter::ptr_t httpAdapter(new LLCoreHttpUtil::HttpCoroutineAdapter( mPoolName + "Adapter", mHTTPPolicy));
 
+    std::string pooledCoro;
+    if (transient)
+    {
+        pooledCoro = LLCoros::instance().launch("LLCoprocedurePool(" + mPoolName + ")::transientInvokerCoro",
+            boost::bind(&LLCoprocedurePool::transientInvokerCoro, this, httpAdapter));
+    }
+    else
+    {
+        pooledCoro = LLCoros::instance().launch("LLCoprocedurePool(" + mPoolName + ")::coprocedureInvokerCoro",
+            boost::bind(&LLCoprocedurePool::coprocedureInvokerCoro, this, httpAdapter));
+    }
+
+    mCoroMapping.insert(CoroAdapterMap_t::value_type(pooledCoro, httpAdapter));
+    mPeakCoroCount = llmax(mPeakCoroCount, (U32)mCoroMapping.size());
+}
+
+// Adds a coroutine when every one is busy and the queue would take longer 
+// than POOL_GROW_WAIT_SECS to drain at the observed execution time.  Until 
+// something has completed there is nothing to go on, and the pool stays at 
+// its base size.
+void LLCoprocedurePool::growIfBacklogged()
+{
+    size_t coros = mCoroMapping.size();
+    if (mShutdown || coros >= mMaxPoolSize || mAvgExecTime <= 0.0)
+        return;
+
+    size_t idle = (coros > mActiveCoprocs.size()) ? coros - mActiveCoprocs.size() : 0;
+    size_t pending = countPending();
+    if (pending <= idle)
+        return;
+
+    F64 drainTime = (F64)pending * mAvgExecTime / (F64)llmax(coros, (size_t)1);
+    if (drainTime > POOL_GROW_WAIT_SECS)
+    {
+        LL_DEBUGS("CoprocedureManager") << "Growing pool \"" << mPoolName << "\" to " << coros + 1 << " coroutines, " << pending << " pending" << LL_ENDL;
+        launchCoro(true);
+    }
+}
+
+LLCoprocedurePool::QueuedCoproc::ptr_t LLCoprocedurePool::popNextCoproc()
+{
+    for (S32 i = LLCoprocedureManager::PRIORITY_COUNT - 1; i >= 0; --i)
+    {
+        CoprocQueue_t &queue = mPendingCoprocs[i];
+        if (!queue.empty())
+        {
+            QueuedCoproc::ptr_t coproc = queue.front();
+            queue.pop_front();
+            return coproc;
+        }
+    }
+    return QueuedCoproc::ptr_t();
+}
+
+void LLCoprocedurePool::invokeCoproc(const QueuedCoproc::ptr_t &coproc, LLCoreHttpUtil::HttpCoroutineAdapter::ptr_t &httpAdapter)
+{
+    ActiveCoproc_t::iterator itActive = mActiveCoprocs.insert(ActiveCoproc_t::value_type(coproc->mId, httpAdapter)).first;
+
+    F64 startTime = LLTimer::getTotalSeconds();
+    F64 waitTime = startTime - coproc->mEnqueueTime;
+    mWaitHistogram.record(waitTime);
+    LLTrace::record(mWaitStat, F64Seconds(waitTime));
+
+    LL_INFOS() << "Dequeued and invoking coprocedure(" << coproc->mName << ") with id=" << coproc->mId.asString() << " in pool \"" << mPoolName << "\"" << LL_ENDL;
+
+    try
+    {
+        coproc->mProc(httpAdapter, coproc->mId);
+    }
+    catch (std::exception &e)
+    {
+        LL_WARNS() << "Coprocedure(" << coproc->mName << ") id=" << coproc->mId.asString() <<
+            " threw an exception! Message=\"" << e.what() << "\"" << LL_ENDL;
+    }
+    catch (...)
+    {
+        LL_WARNS() << "A non std::exception was thrown from " << coproc->mName << " with id=" << coproc->mId << "." << " in pool \"" << mPoolName << "\"" << LL_ENDL;
+    }
+
+    LL_INFOS() << "Finished coprocedure(" << coproc->mName << ")" << " in pool \"" << mPoolName << "\"" << LL_ENDL;
+
+    F64 execTime = LLTimer::getTotalSeconds() - startTime;
+    mExecHistogram.record(execTime);
+    LLTrace::record(mExecStat, F64Seconds(execTime));
+    mAvgExecTime = (mAvgExecTime <= 0.0) ? execTime : mAvgExecTime + (execTime - mAvgExecTime) * EXEC_TIME_SMOOTHING;
+
+    // A cancel may already have removed it.
+    itActive = mActiveCoprocs.find(coproc->mId);
+    if (itActive != mActiveCoprocs.end())
+    {
+        mActiveCoprocs.erase(itActive);
+    }
+
+    if (!mShutdown)
+    {
+        growIfBacklogged();
+    }
+}
+
+//-------------------------------------------------------------------------
+void LLCoprocedurePool::coprocedureInvokerCoro(LLCoreHttpUtil::HttpCoroutineAdapter::ptr_t httpAdapter)
+{
     while (!mShutdown)
     {
         llcoro::suspendUntilEventOn(mWakeupTrigger);
         if (mShutdown)
             break;
         
-        while (!mPendingCoprocs.empty())
+        while (!mShutdown)
         {
-            QueuedCoproc::ptr_t coproc = mPendingCoprocs.front();
-            mPendingCoprocs.pop_front();
-            ActiveCoproc_t::iterator itActive = mActiveCoprocs.insert(ActiveCoproc_t::value_type(coproc->mId, httpAdapter)).first;
-
-            LL_INFOS() << "Dequeued and invoking coprocedure(" << coproc->mName << ") with id=" << coproc->mId.asString() << " in pool \"" << mPoolName << "\"" << LL_ENDL;
+            QueuedCoproc::ptr_t coproc = popNextCoproc();
+            if (!coproc)
+                break;
+            invokeCoproc(coproc, httpAdapter);
+        }
+    }
+}
 
-            try
-            {
-                coproc->mProc(httpAdapter, coproc->mId);
-            }
-            catch (std::exception &e)
-            {
-                LL_WARNS() << "Coprocedure(" << coproc->mName << ") id=" << coproc->mId.asString() <<
-                    " threw an exception! Message=\"" << e.what() << "\"" << LL_ENDL;
-            }
-            catch (...)
-            {
-                LL_WARNS() << "A non std::exception was thrown from " << coproc->mName << " with id=" << coproc->mId << "." << " in pool \"" << mPoolName << "\"" << LL_ENDL;
-            }
+// Extra coroutine added while the pool is backlogged.  It drains the queue 
+// along with the others and exits as soon as it finds it empty.
+void LLCoprocedurePool::transientInvokerCoro(LLCoreHttpUtil::HttpCoroutineAdapter::ptr_t httpAdapter)
+{
+    // Let launchCoro() record us before we can finish.
+    llcoro::suspend();
 
-            LL_INFOS() << "Finished coprocedure(" << coproc->mName << ")" << " in pool \"" << mPoolName << "\"" << LL_ENDL;
+    while (!mShutdown)
+    {
+        QueuedCoproc::ptr_t coproc = popNextCoproc();
+        if (!coproc)
+            break;
+        invokeCoproc(coproc, httpAdapter);
+    }
 
-            mActiveCoprocs.erase(itActive);
-        }
+    if (!mShutdown)
+    {
+        mCoroMapping.erase(LLCoros::instance().getName());
     }
 }
@@ -45,6 +45,17 @@ public:
 
     typedef boost::function<void(LLCoreHttpUtil::HttpCoroutineAdapter::ptr_t &, const LLUUID &id)> CoProcedure_t;
 
+    /// Pending coprocedures are dequeued highest priority first and in 
+    /// order of arrival within a priority.  In pools whose requests must 
+    /// complete in order (AIS), only requests that nothing queued after 
+    /// them depends on may go at PRIORITY_LOW.
+    enum EPriority
+    {
+        PRIORITY_LOW = 0,
+        PRIORITY_NORMAL,
+        PRIORITY_COUNT
+    };
+
     LLCoprocedureManager();
     virtual ~LLCoprocedureManager();
 
@@ -52,9 +63,19 @@ public:
     /// 
     /// @param name Is used for debugging and should identify this coroutine.
     /// @param proc Is a bound function to be executed 
+    /// @param priority Where the coprocedure goes in the pool's queue.
+    /// @param coalesceKey If not empty and the coprocedure last queued at 
+    ///                    the same priority is still waiting with the same 
+    ///                    key (typically its URL and body), proc is dropped 
+    ///                    and the waiting coprocedure's id is returned 
+    ///                    instead.  Only matching the last one keeps the 
+    ///                    order of everything queued in between.  Only use 
+    ///                    this for idempotent requests whose callers don't 
+    ///                    care which proc runs.
     /// 
     /// @return This method returns a UUID that can be used later to cancel execution.
-    LLUUID enqueueCoprocedure(const std::string &pool, const std::string &name, CoProcedure_t proc);
+    LLUUID enqueueCoprocedure(const std::string &pool, const std::string &name, CoProcedure_t proc,
+        EPriority priority = PRIORITY_NORMAL, const std::string &coalesceKey = std::string());
 
     /// Cancel a coprocedure. If the coprocedure is already being actively executed 
     /// this method calls cancelYieldingOperation() on the associated HttpAdapter
@@ -67,6 +88,11 @@ public:
 
     void setPropertyMethods(SettingQuery_t queryfn, SettingUpdate_t updatefn);
 
+    /// Upper bound on the coroutines any pool may grow to; normally the 
+    /// connection limit of the HTTP policy class the pools use.  Coroutines 
+    /// beyond that would only queue up inside llcorehttp.
+    void setConnectionLimit(U32 limit);
+
     /// Returns the number of coprocedures in the queue awaiting processing.
     ///
     size_t countPending() const;
@@ -82,6 +108,12 @@ public:
     size_t count() const;
     size_t count(const std::string &pool) const;
 
+    /// Queue wait and execution time histograms, coroutine counts and 
+    /// coalesced request counts for every pool, keyed by pool name.  Mean, 
+    /// min and max of the same times are also recorded through LLTrace as 
+    /// "coproc_wait_<pool>" and "coproc_exec_<pool>".
+    LLSD getStats() const;
+
 private:
 
     typedef boost::shared_ptr<LLCoprocedurePool> poolPtr_t;
@@ -93,6 +125,7 @@ private:
 
     SettingQuery_t mPropertyQueryFn;
     SettingUpdate_t mPropertyDefineFn;
+    U32 mConnectionLimit;
 };
 
 #endif
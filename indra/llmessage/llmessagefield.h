@@ -0,0 +1,312 @@
+/**
+ * @file llmessagefield.h
+ * @brief Typed accessors for message template variables, resolved by position
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLMESSAGEFIELD_H
+#define LL_LLMESSAGEFIELD_H
+
+#include "llmath.h"
+#include "llmessagereader.h"
+#include "llmsgvariabletype.h"
+#include "llquaternion.h"
+#include "lluuid.h"
+#include "message.h"
+#include "v3dmath.h"
+#include "v3math.h"
+#include "v4math.h"
+
+// The named getters (getU32Fast(_PREHASH_ObjectData, _PREHASH_ID, ...)) find
+// a field with a map lookup on the block name and another on the variable
+// name, for every field of every block. An LLMessageField also carries the
+// field's position in the message template, generated from
+// message_template.msg (see newview/generate_message_fields.py), so the
+// template reader can go straight to it through the per-message block index
+// it builds while decoding.
+//
+// Positions are only a hint: the reader checks that the block and variable
+// it finds there have the expected names, and if they don't (another
+// message that happens to share the block name, a template the simulator
+// changed, the LLSD reader) the accessor uses the named getter instead. The
+// result, including the non-finite and byte order fixups, is always what the
+// named getter would have returned.
+//
+// Fields are aggregates so the generated tables need no static constructors.
+// Canonical names are looked up on first use, from the thread reading
+// messages.
+
+// Names and template position of one variable.
+struct LLMessageFieldName
+{
+	const char*	mBlockName;
+	const char*	mVarName;
+	S32			mBlockIndex;
+	S32			mVarIndex;
+
+	mutable const char* mCanonicalBlock;
+	mutable const char* mCanonicalVar;
+
+	void resolve() const
+	{
+		if (!mCanonicalBlock)
+		{
+			mCanonicalBlock = LLMessageStringTable::getInstance()->getString(mBlockName);
+			mCanonicalVar = LLMessageStringTable::getInstance()->getString(mVarName);
+		}
+	}
+};
+
+// Per-type storage and fixups, mirroring LLTemplateMessageReader's getters.
+// raw_t is what the packet holds; fromRaw() turns it into value_t.
+template<EMsgVariableType TYPE> struct LLMessageFieldType;
+
+#define LL_MESSAGE_FIELD_GETTER(VALUE, GETTER)												\
+	static void getSlow(LLMessageSystem* msg, const char* block, const char* var,			\
+						VALUE& data, S32 blocknum)											\
+	{																						\
+		msg->GETTER##Fast(block, var, data, blocknum);										\
+	}																						\
+	static void getSlow(LLMessageReader* msg, const char* block, const char* var,			\
+						VALUE& data, S32 blocknum)											\
+	{																						\
+		msg->GETTER(block, var, data, blocknum);											\
+	}
+
+#define LL_MESSAGE_FIELD_PLAIN_TYPE(TYPE, VALUE, GETTER)									\
+	template<> struct LLMessageFieldType<TYPE>												\
+	{																						\
+		typedef VALUE value_t;																\
+		typedef VALUE raw_t;																\
+		static void fromRaw(const raw_t& raw, value_t& data, const LLMessageFieldName&)	\
+		{																					\
+			data = raw;																		\
+		}																					\
+		LL_MESSAGE_FIELD_GETTER(VALUE, GETTER)												\
+	};
+
+LL_MESSAGE_FIELD_PLAIN_TYPE(MVT_U8, U8, getU8)
+LL_MESSAGE_FIELD_PLAIN_TYPE(MVT_U16, U16, getU16)
+LL_MESSAGE_FIELD_PLAIN_TYPE(MVT_U32, U32, getU32)
+LL_MESSAGE_FIELD_PLAIN_TYPE(MVT_U64, U64, getU64)
+LL_MESSAGE_FIELD_PLAIN_TYPE(MVT_S8, S8, getS8)
+LL_MESSAGE_FIELD_PLAIN_TYPE(MVT_S16, S16, getS16)
+LL_MESSAGE_FIELD_PLAIN_TYPE(MVT_S32, S32, getS32)
+LL_MESSAGE_FIELD_PLAIN_TYPE(MVT_LLUUID, LLUUID, getUUID)
+LL_MESSAGE_FIELD_PLAIN_TYPE(MVT_IP_ADDR, U32, getIPAddr)
+
+#undef LL_MESSAGE_FIELD_PLAIN_TYPE
+
+// Values zeroed, with a warning, when not finite.
+#define LL_MESSAGE_FIELD_FINITE_TYPE(TYPE, VALUE, GETTER, IS_FINITE, ZERO)				\
+	template<> struct LLMessageFieldType<TYPE>												\
+	{																						\
+		typedef VALUE value_t;																\
+		typedef VALUE raw_t;																\
+		static void fromRaw(const raw_t& raw, value_t& data, const LLMessageFieldName& field) \
+		{																					\
+			data = raw;																		\
+			if (!(IS_FINITE))																\
+			{																				\
+				LL_WARNS() << "non-finite in " #GETTER "Fast " << field.mBlockName			\
+						   << " " << field.mVarName << LL_ENDL;								\
+				ZERO;																		\
+			}																				\
+		}																					\
+		LL_MESSAGE_FIELD_GETTER(VALUE, GETTER)												\
+	};
+
+LL_MESSAGE_FIELD_FINITE_TYPE(MVT_F32, F32, getF32, std::isfinite(data), data = 0.f)
+LL_MESSAGE_FIELD_FINITE_TYPE(MVT_F64, F64, getF64, std::isfinite(data), data = 0.0)
+LL_MESSAGE_FIELD_FINITE_TYPE(MVT_LLVector3, LLVector3, getVector3, data.isFinite(), data.zeroVec())
+LL_MESSAGE_FIELD_FINITE_TYPE(MVT_LLVector3d, LLVector3d, getVector3d, data.isFinite(), data.zeroVec())
+LL_MESSAGE_FIELD_FINITE_TYPE(MVT_LLVector4, LLVector4, getVector4, data.isFinite(), data.zeroVec())
+
+#undef LL_MESSAGE_FIELD_FINITE_TYPE
+
+template<> struct LLMessageFieldType<MVT_LLQuaternion>
+{
+	typedef LLQuaternion value_t;
+	typedef LLVector3 raw_t;		// Packed, W implied
+	static void fromRaw(const raw_t& raw, value_t& data, const LLMessageFieldName& field)
+	{
+		if (raw.isFinite())
+		{
+			data.unpackFromVector3(raw);
+		}
+		else
+		{
+			LL_WARNS() << "non-finite in getQuatFast " << field.mBlockName << " " << field.mVarName << LL_ENDL;
+			data.loadIdentity();
+		}
+	}
+	LL_MESSAGE_FIELD_GETTER(LLQuaternion, getQuat)
+};
+
+template<> struct LLMessageFieldType<MVT_BOOL>
+{
+	typedef BOOL value_t;
+	typedef U8 raw_t;
+	static void fromRaw(const raw_t& raw, value_t& data, const LLMessageFieldName&)
+	{
+		data = (BOOL)raw;
+	}
+	LL_MESSAGE_FIELD_GETTER(BOOL, getBOOL)
+};
+
+template<> struct LLMessageFieldType<MVT_IP_PORT>
+{
+	typedef U16 value_t;
+	typedef U16 raw_t;
+	static void fromRaw(const raw_t& raw, value_t& data, const LLMessageFieldName&)
+	{
+		data = ntohs(raw);
+	}
+	LL_MESSAGE_FIELD_GETTER(U16, getIPPort)
+};
+
+#undef LL_MESSAGE_FIELD_GETTER
+
+// A fixed size variable. SOURCE is LLMessageSystem or LLMessageReader.
+template<EMsgVariableType TYPE>
+struct LLMessageField
+{
+	typedef LLMessageFieldType<TYPE> type_t;
+	typedef typename type_t::value_t value_t;
+	typedef typename type_t::raw_t raw_t;
+
+	LLMessageFieldName mField;
+
+	template<class SOURCE>
+	void get(SOURCE* msg, value_t& data, S32 blocknum = 0) const
+	{
+		mField.resolve();
+		raw_t raw;
+		if (msg->getIndexedData(mField.mBlockIndex, mField.mVarIndex,
+								mField.mCanonicalBlock, mField.mCanonicalVar,
+								&raw, sizeof(raw_t), blocknum))
+		{
+			type_t::fromRaw(raw, data, mField);
+		}
+		else
+		{
+			type_t::getSlow(msg, mField.mCanonicalBlock, mField.mCanonicalVar, data, blocknum);
+		}
+	}
+};
+
+// Fixed and Variable byte blocks.
+struct LLMessageBinaryField
+{
+	LLMessageFieldName mField;
+
+	// size and max_size as for getBinaryDataFast().
+	template<class SOURCE>
+	void get(SOURCE* msg, void* datap, S32 size, S32 blocknum = 0, S32 max_size = S32_MAX) const
+	{
+		mField.resolve();
+		if (!msg->getIndexedData(mField.mBlockIndex, mField.mVarIndex,
+								 mField.mCanonicalBlock, mField.mCanonicalVar,
+								 datap, size, blocknum, max_size))
+		{
+			getBinarySlow(msg, datap, size, blocknum, max_size);
+		}
+	}
+
+	template<class SOURCE>
+	void getString(SOURCE* msg, S32 buffer_size, char* buffer, S32 blocknum = 0) const
+	{
+		buffer[0] = '\0';
+		get(msg, buffer, 0, blocknum, buffer_size);
+		buffer[buffer_size - 1] = '\0';
+	}
+
+	template<class SOURCE>
+	void getString(SOURCE* msg, std::string& outstr, S32 blocknum = 0) const
+	{
+		char buffer[MTUBYTES + 1] = {0};
+		get(msg, buffer, 0, blocknum, MTUBYTES);
+		buffer[MTUBYTES] = '\0';
+		outstr = buffer;
+	}
+
+	// Size in bytes of instance blocknum's data.
+	template<class SOURCE>
+	S32 getSize(SOURCE* msg, S32 blocknum = 0) const
+	{
+		mField.resolve();
+		S32 size = msg->getIndexedSize(mField.mBlockIndex, mField.mVarIndex,
+									   mField.mCanonicalBlock, mField.mCanonicalVar, blocknum);
+		return size >= 0 ? size : getSizeSlow(msg, blocknum);
+	}
+
+private:
+	void getBinarySlow(LLMessageSystem* msg, void* datap, S32 size, S32 blocknum, S32 max_size) const
+	{
+		msg->getBinaryDataFast(mField.mCanonicalBlock, mField.mCanonicalVar, datap, size, blocknum, max_size);
+	}
+	void getBinarySlow(LLMessageReader* msg, void* datap, S32 size, S32 blocknum, S32 max_size) const
+	{
+		msg->getBinaryData(mField.mCanonicalBlock, mField.mCanonicalVar, datap, size, blocknum, max_size);
+	}
+	S32 getSizeSlow(LLMessageSystem* msg, S32 blocknum) const
+	{
+		return msg->getSizeFast(mField.mCanonicalBlock, blocknum, mField.mCanonicalVar);
+	}
+	S32 getSizeSlow(LLMessageReader* msg, S32 blocknum) const
+	{
+		return msg->getSize(mField.mCanonicalBlock, blocknum, mField.mCanonicalVar);
+	}
+};
+
+// Instance count of one block.
+struct LLMessageBlockField
+{
+	const char*	mBlockName;
+	S32			mBlockIndex;
+
+	mutable const char* mCanonicalBlock;
+
+	template<class SOURCE>
+	S32 getNumberOfBlocks(SOURCE* msg) const
+	{
+		if (!mCanonicalBlock)
+		{
+			mCanonicalBlock = LLMessageStringTable::getInstance()->getString(mBlockName);
+		}
+		S32 count = msg->getIndexedNumberOfBlocks(mBlockIndex, mCanonicalBlock);
+		return count >= 0 ? count : getNumberOfBlocksSlow(msg);
+	}
+
+private:
+	S32 getNumberOfBlocksSlow(LLMessageSystem* msg) const
+	{
+		return msg->getNumberOfBlocksFast(mCanonicalBlock);
+	}
+	S32 getNumberOfBlocksSlow(LLMessageReader* msg) const
+	{
+		return msg->getNumberOfBlocks(mCanonicalBlock);
+	}
+};
+
+#endif // LL_LLMESSAGEFIELD_H
@@ -37,6 +37,24 @@ LLMessageReader::~LLMessageReader()
 	// even abstract base classes need a concrete destructor
 }
 
+//virtual
+BOOL LLMessageReader::getIndexedData(S32 block_index, S32 var_index, const char *blockname, const char *varname, void *datap, S32 size, S32 blocknum, S32 max_size)
+{
+	return FALSE;
+}
+
+//virtual
+S32 LLMessageReader::getIndexedSize(S32 block_index, S32 var_index, const char *blockname, const char *varname, S32 blocknum)
+{
+	return -1;
+}
+
+//virtual
+S32 LLMessageReader::getIndexedNumberOfBlocks(S32 block_index, const char *blockname)
+{
+	return -1;
+}
+
 //static 
 void LLMessageReader::setTimeDecodes(BOOL b)
 {
@@ -76,6 +76,17 @@ class LLMessageReader
 	virtual S32	getSize(const char *blockname, const char *varname) = 0;
 	virtual S32	getSize(const char *blockname, S32 blocknum, const char *varname) = 0;
 
+	// Positional lookups used by LLMessageField: block_index and var_index
+	// are positions in the message template, as generated from
+	// message_template.msg. They only succeed when the block and variable
+	// found there really are blockname/varname (canonical strings), so a
+	// stale or mismatched index just fails and the caller falls back to the
+	// named getters above. Readers without a template never succeed.
+	virtual BOOL getIndexedData(S32 block_index, S32 var_index, const char *blockname, const char *varname, void *datap, S32 size, S32 blocknum = 0, S32 max_size = S32_MAX);
+	// Return -1 when the lookup doesn't succeed.
+	virtual S32 getIndexedSize(S32 block_index, S32 var_index, const char *blockname, const char *varname, S32 blocknum = 0);
+	virtual S32 getIndexedNumberOfBlocks(S32 block_index, const char *blockname);
+
 	virtual void clearMessage() = 0;
 
 	/** Returns pointer to canonical (prehashed) string. */
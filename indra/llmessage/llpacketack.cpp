@@ -35,6 +35,7 @@
 #include "winsock2.h"
 #endif
 
+#include "llcircuit.h"
 #include "message.h"
 
 LLReliablePacket::LLReliablePacket(
@@ -71,7 +72,14 @@ LLReliablePacket::LLReliablePacket(
 	mSocket = socket;
 	if (mRetries)
 	{
-		mBuffer = new U8[buf_len];
+		if (buf_len <= LL_RELIABLE_INLINE_BUFFER_SIZE)
+		{
+			mBuffer = mInlineBuffer;
+		}
+		else
+		{
+			mBuffer = new U8[buf_len];
+		}
 		if (mBuffer != NULL)
 		{
 			memcpy(mBuffer,buf_ptr,buf_len);	/*Flawfinder: ignore*/
@@ -80,3 +88,427 @@ LLReliablePacket::LLReliablePacket(
 			
 	}
 }
+
+// Freed packets kept for reuse. Bounded so that one burst of reliable
+// traffic doesn't pin its peak memory for the rest of the session.
+static const size_t MAX_FREE_RELIABLE_PACKETS = 1024;
+static void* sFreeReliablePackets[MAX_FREE_RELIABLE_PACKETS];
+static size_t sFreeReliablePacketCount = 0;
+
+// static
+void* LLReliablePacket::operator new(size_t size)
+{
+	if (size == sizeof(LLReliablePacket) && sFreeReliablePacketCount)
+	{
+		return sFreeReliablePackets[--sFreeReliablePacketCount];
+	}
+	return ::operator new(size);
+}
+
+// static
+void LLReliablePacket::operator delete(void* ptr)
+{
+	if (!ptr)
+	{
+		return;
+	}
+	if (sFreeReliablePacketCount < MAX_FREE_RELIABLE_PACKETS)
+	{
+		sFreeReliablePackets[sFreeReliablePacketCount++] = ptr;
+	}
+	else
+	{
+		::operator delete(ptr);
+	}
+}
+
+// static
+void LLReliablePacket::cleanupPool()
+{
+	while (sFreeReliablePacketCount)
+	{
+		::operator delete(sFreeReliablePackets[--sFreeReliablePacketCount]);
+	}
+}
+
+// Packet ids wrap at LL_MAX_OUT_PACKET_ID (2^24). An id less than half the
+// id space ahead of another counts as newer.
+static const U32 PACKET_ID_MASK = LL_MAX_OUT_PACKET_ID - 1;
+static const U32 PACKET_ID_HALF = LL_MAX_OUT_PACKET_ID / 2;
+
+static const U32 INITIAL_RING_CAPACITY = 64;
+// Beyond this many ids between the oldest and newest packet in flight,
+// packets go to the overflow map. A circuit that far behind is throttled
+// to a crawl anyway.
+static const U32 MAX_RING_CAPACITY = 16384;
+
+LLReliablePacketRing::LLReliablePacketRing()
+:	mSlots(new LLReliablePacket*[INITIAL_RING_CAPACITY]),
+	mMask(INITIAL_RING_CAPACITY - 1),
+	mCount(0),
+	mOldestID(0),
+	mNewestID(0)
+{
+	memset(mSlots, 0, INITIAL_RING_CAPACITY * sizeof(LLReliablePacket*));
+}
+
+LLReliablePacketRing::~LLReliablePacketRing()
+{
+	delete [] mSlots;
+}
+
+U32 LLReliablePacketRing::getOffset(TPACKETID id) const
+{
+	return (id - mOldestID) & PACKET_ID_MASK;
+}
+
+// Makes room for span ids from mOldestID on, growing the slot array if
+// needed. Returns FALSE if that would exceed MAX_RING_CAPACITY.
+BOOL LLReliablePacketRing::reserve(U32 span)
+{
+	U32 capacity = mMask + 1;
+	if (span <= capacity)
+	{
+		return TRUE;
+	}
+	if (span > MAX_RING_CAPACITY)
+	{
+		return FALSE;
+	}
+	while (capacity < span)
+	{
+		capacity <<= 1;
+	}
+
+	LLReliablePacket** slots = new LLReliablePacket*[capacity];
+	memset(slots, 0, capacity * sizeof(LLReliablePacket*));
+	U32 mask = capacity - 1;
+	if (mCount)
+	{
+		U32 end = getOffset(mNewestID);
+		for (U32 pos = 0; pos <= end; ++pos)
+		{
+			TPACKETID id = (mOldestID + pos) & PACKET_ID_MASK;
+			slots[id & mask] = mSlots[id & mMask];
+		}
+	}
+	delete [] mSlots;
+	mSlots = slots;
+	mMask = mask;
+	return TRUE;
+}
+
+void LLReliablePacketRing::insert(LLReliablePacket* packetp)
+{
+	TPACKETID id = packetp->mPacketID;
+	if (!mCount)
+	{
+		mOldestID = id;
+		mNewestID = id;
+		mSlots[id & mMask] = packetp;
+		mCount++;
+		return;
+	}
+
+	U32 ahead = getOffset(id);
+	if (ahead < PACKET_ID_HALF)
+	{
+		if (reserve(ahead + 1))
+		{
+			llassert(!mSlots[id & mMask]);
+			mSlots[id & mMask] = packetp;
+			mCount++;
+			if (ahead > getOffset(mNewestID))
+			{
+				mNewestID = id;
+			}
+			return;
+		}
+	}
+	else
+	{
+		U32 behind = (mOldestID - id) & PACKET_ID_MASK;
+		if (reserve(behind + getOffset(mNewestID) + 1))
+		{
+			mSlots[id & mMask] = packetp;
+			mCount++;
+			mOldestID = id;
+			return;
+		}
+	}
+
+	mOverflow[id] = packetp;
+}
+
+LLReliablePacket* LLReliablePacketRing::find(TPACKETID id) const
+{
+	if (mCount && getOffset(id) <= getOffset(mNewestID))
+	{
+		LLReliablePacket* packetp = mSlots[id & mMask];
+		if (packetp && packetp->mPacketID == id)
+		{
+			return packetp;
+		}
+	}
+	if (!mOverflow.empty())
+	{
+		overflow_map_t::const_iterator iter = mOverflow.find(id);
+		if (iter != mOverflow.end())
+		{
+			return iter->second;
+		}
+	}
+	return NULL;
+}
+
+LLReliablePacket* LLReliablePacketRing::remove(TPACKETID id)
+{
+	if (mCount && getOffset(id) <= getOffset(mNewestID))
+	{
+		LLReliablePacket* packetp = mSlots[id & mMask];
+		if (packetp && packetp->mPacketID == id)
+		{
+			mSlots[id & mMask] = NULL;
+			mCount--;
+			if (mCount)
+			{
+				// Shrink the window to the packets still in it. Each slot
+				// is only stepped over once, so this is O(1) amortized.
+				while (!mSlots[mOldestID & mMask])
+				{
+					mOldestID = (mOldestID + 1) & PACKET_ID_MASK;
+				}
+				while (!mSlots[mNewestID & mMask])
+				{
+					mNewestID = (mNewestID - 1) & PACKET_ID_MASK;
+				}
+			}
+			return packetp;
+		}
+	}
+	if (!mOverflow.empty())
+	{
+		overflow_map_t::iterator iter = mOverflow.find(id);
+		if (iter != mOverflow.end())
+		{
+			LLReliablePacket* packetp = iter->second;
+			mOverflow.erase(iter);
+			return packetp;
+		}
+	}
+	return NULL;
+}
+
+BOOL LLReliablePacketRing::getOldestID(TPACKETID current_id, TPACKETID& oldest_id) const
+{
+	BOOL found = FALSE;
+	if (mCount)
+	{
+		oldest_id = mOldestID;
+		found = TRUE;
+	}
+	if (!mOverflow.empty())
+	{
+		// Anything after the current id is left over from before the ids
+		// last wrapped, so is older than anything up to it.
+		overflow_map_t::const_iterator iter = mOverflow.upper_bound(current_id);
+		if (iter == mOverflow.end())
+		{
+			iter = mOverflow.begin();
+		}
+		if (!found
+			|| ((current_id - iter->first) & PACKET_ID_MASK) > ((current_id - oldest_id) & PACKET_ID_MASK))
+		{
+			oldest_id = iter->first;
+			found = TRUE;
+		}
+	}
+	return found;
+}
+
+LLReliablePacket* LLReliablePacketRing::first(Cursor& cursor) const
+{
+	cursor.mNextID = mOldestID;
+	cursor.mInOverflow = FALSE;
+	return next(cursor);
+}
+
+LLReliablePacket* LLReliablePacketRing::next(Cursor& cursor) const
+{
+	if (!cursor.mInOverflow)
+	{
+		if (mCount)
+		{
+			U32 end = getOffset(mNewestID);
+			U32 pos = getOffset(cursor.mNextID);
+			if (pos >= PACKET_ID_HALF)
+			{
+				// Removals moved the oldest packet past the cursor
+				pos = 0;
+			}
+			for ( ; pos <= end; ++pos)
+			{
+				TPACKETID id = (mOldestID + pos) & PACKET_ID_MASK;
+				LLReliablePacket* packetp = mSlots[id & mMask];
+				if (packetp)
+				{
+					cursor.mNextID = (id + 1) & PACKET_ID_MASK;
+					return packetp;
+				}
+			}
+		}
+		cursor.mInOverflow = TRUE;
+		cursor.mNextID = 0;
+	}
+
+	overflow_map_t::const_iterator iter = mOverflow.lower_bound(cursor.mNextID);
+	if (iter == mOverflow.end())
+	{
+		return NULL;
+	}
+	cursor.mNextID = iter->first + 1;
+	return iter->second;
+}
+
+static const U32 INITIAL_WINDOW_BITS = 1024;
+// Ids received more than this far before the newest are forgotten even if
+// the peer hasn't yet told us it won't resend them.
+static const U32 MAX_WINDOW_BITS = 65536;
+
+LLPacketIDWindow::LLPacketIDWindow()
+:	mBits(INITIAL_WINDOW_BITS / 32, 0),
+	mMask(INITIAL_WINDOW_BITS - 1),
+	mBaseID(0),
+	mSpan(0),
+	mCount(0)
+{
+}
+
+BOOL LLPacketIDWindow::reserve(U32 span)
+{
+	U32 capacity = mMask + 1;
+	if (span <= capacity)
+	{
+		return TRUE;
+	}
+	if (span > MAX_WINDOW_BITS)
+	{
+		return FALSE;
+	}
+	while (capacity < span)
+	{
+		capacity <<= 1;
+	}
+
+	std::vector<U32> bits(capacity / 32, 0);
+	bits.swap(mBits);
+	U32 old_mask = mMask;
+	mMask = capacity - 1;
+	for (U32 pos = 0; pos < mSpan; ++pos)
+	{
+		TPACKETID id = (mBaseID + pos) & PACKET_ID_MASK;
+		if ((bits[(id & old_mask) >> 5] >> (id & 31)) & 1)
+		{
+			setBit(id);
+		}
+	}
+	return TRUE;
+}
+
+void LLPacketIDWindow::insert(TPACKETID id)
+{
+	id &= PACKET_ID_MASK;
+	if (!mCount)
+	{
+		mBaseID = id;
+		mSpan = 0;
+	}
+
+	U32 pos = (id - mBaseID) & PACKET_ID_MASK;
+	if (pos >= PACKET_ID_HALF)
+	{
+		// Arrived late, from before the window
+		U32 behind = (mBaseID - id) & PACKET_ID_MASK;
+		if (!reserve(mSpan + behind))
+		{
+			// Too old to be worth remembering
+			return;
+		}
+		mBaseID = id;
+		mSpan += behind;
+	}
+	else if (pos >= mSpan)
+	{
+		if (!reserve(pos + 1))
+		{
+			// Slide the window forward, forgetting the oldest ids
+			clearBefore((id - MAX_WINDOW_BITS + 1) & PACKET_ID_MASK);
+			if (!mCount)
+			{
+				mBaseID = id;
+				mSpan = 0;
+			}
+			pos = (id - mBaseID) & PACKET_ID_MASK;
+			reserve(pos + 1);
+		}
+		mSpan = pos + 1;
+	}
+
+	if (!testBit(id))
+	{
+		setBit(id);
+		mCount++;
+	}
+}
+
+BOOL LLPacketIDWindow::contains(TPACKETID id) const
+{
+	if (!mCount)
+	{
+		return FALSE;
+	}
+	id &= PACKET_ID_MASK;
+	if (((id - mBaseID) & PACKET_ID_MASK) >= mSpan)
+	{
+		return FALSE;
+	}
+	return testBit(id);
+}
+
+void LLPacketIDWindow::clearBefore(TPACKETID oldest_id)
+{
+	if (!mCount)
+	{
+		return;
+	}
+	U32 pos = (oldest_id - mBaseID) & PACKET_ID_MASK;
+	if (pos >= PACKET_ID_HALF)
+	{
+		// Everything we have is newer
+		return;
+	}
+	if (pos >= mSpan)
+	{
+		clear();
+		return;
+	}
+	for (U32 i = 0; i < pos; ++i)
+	{
+		TPACKETID id = (mBaseID + i) & PACKET_ID_MASK;
+		if (testBit(id))
+		{
+			resetBit(id);
+			mCount--;
+		}
+	}
+	mBaseID = oldest_id & PACKET_ID_MASK;
+	mSpan -= pos;
+}
+
+void LLPacketIDWindow::clear()
+{
+	std::fill(mBits.begin(), mBits.end(), 0);
+	mBaseID = 0;
+	mSpan = 0;
+	mCount = 0;
+}
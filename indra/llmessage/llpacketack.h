@@ -27,8 +27,16 @@
 #ifndef LL_LLPACKETACK_H
 #define LL_LLPACKETACK_H
 
+#include <map>
+#include <vector>
+
 #include "llhost.h"
 #include "llunits.h"
+#include "net.h"
+
+// Reliable packets up to this size keep their copy of the datagram inline.
+// Acks are appended after the copy is taken, so nearly all fit.
+const S32 LL_RELIABLE_INLINE_BUFFER_SIZE = MTUBYTES;
 
 class LLReliablePacketParams
 {
@@ -89,11 +97,23 @@ public:
 	~LLReliablePacket()
 	{ 
 		mCallback = NULL;
-		delete [] mBuffer;
+		if (mBuffer != mInlineBuffer)
+		{
+			delete [] mBuffer;
+		}
 		mBuffer = NULL;
 	};
 
+	// Packets are recycled through a free list rather than the heap. Only
+	// the message system thread creates and destroys them.
+	static void* operator new(size_t size);
+	static void operator delete(void* ptr);
+	static void cleanupPool();
+
+	TPACKETID getPacketID() const	{ return mPacketID; }
+
 	friend class LLCircuitData;
+	friend class LLReliablePacketRing;
 protected:
 	S32 mSocket;
 	LLHost mHost;
@@ -110,6 +130,86 @@ protected:
 	TPACKETID mPacketID;
 
 	F64Seconds mExpirationTime;
+
+	U8 mInlineBuffer[LL_RELIABLE_INLINE_BUFFER_SIZE];
+};
+
+// Reliable packets in flight on one circuit, by packet id. Outgoing ids are
+// sequential, so the ids in flight form a narrow window, and a power-of-two
+// slot array indexed by (id & mask) gives O(1) insertion, lookup and
+// removal. The rare packet that doesn't fit the window, such as one still
+// pending when a circuit restarts its ids, is kept in a map instead.
+// The ring does not own the packets.
+class LLReliablePacketRing
+{
+public:
+	LLReliablePacketRing();
+	~LLReliablePacketRing();
+
+	void				insert(LLReliablePacket* packetp);
+	LLReliablePacket*	find(TPACKETID id) const;
+	// Returns the packet removed, or NULL if id wasn't in the ring.
+	LLReliablePacket*	remove(TPACKETID id);
+
+	BOOL				isEmpty() const		{ return !mCount && mOverflow.empty(); }
+	S32					getCount() const	{ return mCount + (S32)mOverflow.size(); }
+
+	// Finds the packet id furthest behind current_id, taking wrapping into
+	// account. Returns FALSE if the ring is empty.
+	BOOL				getOldestID(TPACKETID current_id, TPACKETID& oldest_id) const;
+
+	// Walks the packets in sequence order. The packet last returned may be
+	// removed before asking for the next one.
+	struct Cursor
+	{
+		TPACKETID	mNextID;
+		BOOL		mInOverflow;
+	};
+	LLReliablePacket*	first(Cursor& cursor) const;
+	LLReliablePacket*	next(Cursor& cursor) const;
+
+private:
+	U32					getOffset(TPACKETID id) const;
+	BOOL				reserve(U32 span);
+
+	LLReliablePacket**	mSlots;
+	U32					mMask;
+	S32					mCount;
+	TPACKETID			mOldestID;
+	TPACKETID			mNewestID;
+
+	typedef std::map<TPACKETID, LLReliablePacket*> overflow_map_t;
+	overflow_map_t		mOverflow;
+};
+
+// Reliable packet ids recently received on a circuit, for duplicate
+// suppression. One bit per id over a sliding window of ids; ids that fall
+// out of the back of the window are forgotten, just as when the peer's
+// oldest unacked packet moves past them.
+class LLPacketIDWindow
+{
+public:
+	LLPacketIDWindow();
+
+	void	insert(TPACKETID id);
+	BOOL	contains(TPACKETID id) const;
+	// Forgets every id before oldest_id.
+	void	clearBefore(TPACKETID oldest_id);
+	void	clear();
+
+	S32		getCount() const	{ return mCount; }
+
+private:
+	BOOL	reserve(U32 span);
+	BOOL	testBit(TPACKETID id) const	{ return (mBits[(id & mMask) >> 5] >> (id & 31)) & 1; }
+	void	setBit(TPACKETID id)		{ mBits[(id & mMask) >> 5] |= 1U << (id & 31); }
+	void	resetBit(TPACKETID id)		{ mBits[(id & mMask) >> 5] &= ~(1U << (id & 31)); }
+
+	std::vector<U32>	mBits;
+	U32					mMask;
+	TPACKETID			mBaseID;	// Oldest id the window covers
+	U32					mSpan;		// Ids [mBaseID, mBaseID + mSpan) may be set
+	S32					mCount;
 };
 
 #endif
@@ -0,0 +1,209 @@
+/**
+ * @file llpacketreceivethread.cpp
+ * @brief Thread draining the message system's UDP socket into a packet ring
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llpacketreceivethread.h"
+
+#include "llproxy.h"
+#include "lltimer.h"
+#include "message.h"
+
+// Most packets we can take from one recvmmsg() call.
+static const S32 MAX_READ_BATCH = 64;
+
+// Poll timeout; bounds how long shutdown() waits on us.
+static const S32 POLL_TIMEOUT_MS = 20;
+
+LLPacketReceiveThread::LLPacketReceiveThread(S32 socket, U32 capacity)
+:	LLThread("Packet Receive"),
+	mSocket(socket),
+	mHead(0),
+	mTail(0),
+	mStallCount(0)
+{
+	U32 size = 1;
+	while (size < capacity)
+	{
+		size <<= 1;
+	}
+	mMask = size - 1;
+	mSlots = new Packet[size];
+}
+
+LLPacketReceiveThread::~LLPacketReceiveThread()
+{
+	shutdown();
+	delete[] mSlots;
+}
+
+const LLPacketReceiveThread::Packet* LLPacketReceiveThread::front() const
+{
+	U32 head = mHead;
+	if (head == mTail)
+	{
+		return NULL;
+	}
+	return &mSlots[head & mMask];
+}
+
+void LLPacketReceiveThread::pop()
+{
+	U32 head = mHead;
+	if (head != mTail)
+	{
+		mHead = head + 1;
+	}
+}
+
+void LLPacketReceiveThread::run()
+{
+	while (!isQuitting())
+	{
+		if (readPackets() > 0)
+		{
+			continue;
+		}
+		if (getPendingCount() > mMask)
+		{
+			// Ring is full; leave the rest in the socket buffer until the
+			// main thread catches up.
+			++mStallCount;
+			ms_sleep(1);
+			continue;
+		}
+		wait_for_packets(mSocket, POLL_TIMEOUT_MS);
+	}
+}
+
+// Fills as many free slots as there are packets waiting, then publishes
+// them all with one store to mTail.
+S32 LLPacketReceiveThread::readPackets()
+{
+	U32 tail = mTail;
+	U32 free_slots = mMask + 1 - (tail - mHead);
+	S32 batch = llmin((S32)free_slots, MAX_READ_BATCH);
+	if (batch <= 0)
+	{
+		return 0;
+	}
+
+	LLNetPacket net_packets[MAX_READ_BATCH];
+	for (S32 i = 0; i < batch; ++i)
+	{
+		net_packets[i].mBuffer = (char*)mSlots[(tail + i) & mMask].mRaw;
+	}
+
+	S32 count = receive_packets(mSocket, net_packets, batch);
+	for (S32 i = 0; i < count; ++i)
+	{
+		Packet& packet = mSlots[(tail + i) & mMask];
+		const LLNetPacket& net_packet = net_packets[i];
+		packet.mTrueSize = net_packet.mSize;
+		packet.mSender = LLHost(net_packet.mSenderIP, net_packet.mSenderPort);
+		packet.mReceivingIF = LLHost(net_packet.mReceivingIFIP, INVALID_PORT);
+
+		if (LLProxy::isSOCKSProxyEnabled())
+		{
+			if (packet.mTrueSize > SOCKS_HEADER_SIZE)
+			{
+				// *FIX We are assuming ATYP is 0x01 (IPv4), not 0x03 (hostname) or 0x04 (IPv6)
+				proxywrap_t header;
+				memcpy(&header, packet.mRaw, sizeof(header));	/* Flawfinder: ignore */
+				packet.mSender.setAddress(header.addr);
+				packet.mSender.setPort(ntohs(header.port));
+				packet.mTrueSize -= SOCKS_HEADER_SIZE;
+				memmove(packet.mRaw, packet.mRaw + SOCKS_HEADER_SIZE, packet.mTrueSize);
+			}
+			else
+			{
+				packet.mTrueSize = 0;
+			}
+		}
+
+		decodePacket(packet);
+	}
+
+	if (count > 0)
+	{
+		mTail = tail + count;
+	}
+	return count;
+}
+
+// static
+void LLPacketReceiveThread::decodePacket(Packet& packet)
+{
+	packet.mStatus = PACKET_OK;
+	packet.mSize = packet.mTrueSize;
+	packet.mCompressedSize = 0;
+	packet.mNumAcks = 0;
+
+	if (packet.mSize < (S32)LL_MINIMUM_VALID_PACKET_SIZE)
+	{
+		packet.mStatus = PACKET_TOO_SHORT;
+		return;
+	}
+
+	// Appended acks: ids follow the message, their count is the last byte.
+	if (packet.mRaw[0] & LL_ACK_FLAG)
+	{
+		U8 acks = packet.mRaw[--packet.mSize];
+		if (packet.mSize < (S32)(acks * sizeof(TPACKETID) + LL_MINIMUM_VALID_PACKET_SIZE))
+		{
+			packet.mStatus = PACKET_BAD_ACKS;
+			packet.mNumAcks = acks;
+			return;
+		}
+
+		// Same order the main thread used to ack them in: last one first.
+		S32 ack_pos = packet.mSize;
+		for (U8 i = 0; i < acks; ++i)
+		{
+			ack_pos -= sizeof(TPACKETID);
+			U32 mem_id = 0;
+			memcpy(&mem_id, &packet.mRaw[ack_pos], sizeof(TPACKETID));	/* Flawfinder: ignore */
+			packet.mAcks[i] = ntohl(mem_id);
+		}
+		packet.mNumAcks = acks;
+		packet.mSize = ack_pos;
+	}
+
+	if (packet.mRaw[0] & LL_ZERO_CODE_FLAG)
+	{
+		S32 expanded_size = zero_code_expand(packet.mRaw, packet.mSize, packet.mExpanded, NET_BUFFER_SIZE);
+		packet.mCompressedSize = packet.mSize;
+		if (expanded_size < 0)
+		{
+			packet.mStatus = PACKET_BAD_ZEROCODE;
+			packet.mSize = 0;
+		}
+		else
+		{
+			packet.mSize = expanded_size;
+		}
+	}
+}
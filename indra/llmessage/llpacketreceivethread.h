@@ -0,0 +1,107 @@
+/**
+ * @file llpacketreceivethread.h
+ * @brief Thread draining the message system's UDP socket into a packet ring
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLPACKETRECEIVETHREAD_H
+#define LL_LLPACKETRECEIVETHREAD_H
+
+#include "llatomic.h"
+#include "llhost.h"
+#include "llthread.h"
+#include "net.h"
+
+// Reads the message system socket on its own thread so that a long frame
+// on the main thread doesn't let the kernel's socket buffer overflow.
+// Packets go into a fixed ring of preallocated slots shared with exactly one
+// consumer (LLMessageSystem::checkMessages()); head and tail are atomics, so
+// neither side ever takes a lock. Appended acks are split off and zero-coded
+// packets expanded here, leaving only circuit bookkeeping and message
+// decoding to the main thread.
+//
+// When the ring is full the thread stops reading and lets the kernel buffer
+// the rest, so packets are only lost where they would have been anyway.
+class LLPacketReceiveThread : public LLThread
+{
+public:
+	enum EStatus
+	{
+		PACKET_OK,
+		PACKET_TOO_SHORT,		// Below LL_MINIMUM_VALID_PACKET_SIZE
+		PACKET_BAD_ACKS,		// Ack count runs past the start of the packet
+		PACKET_BAD_ZEROCODE		// Expands past MAX_BUFFER_SIZE
+	};
+
+	struct Packet
+	{
+		EStatus		mStatus;
+		LLHost		mSender;
+		LLHost		mReceivingIF;
+
+		S32			mTrueSize;			// As received, minus any proxy header
+		S32			mSize;				// Message bytes in getData()
+		S32			mCompressedSize;	// Zero-coded size, 0 if not zero-coded
+
+		U8			mNumAcks;
+		TPACKETID	mAcks[255];			// Host order
+
+		const U8*	getData() const		{ return mCompressedSize ? mExpanded : mRaw; }
+
+		U8			mRaw[NET_BUFFER_SIZE];
+		U8			mExpanded[NET_BUFFER_SIZE];
+	};
+
+	// capacity is rounded up to a power of two.
+	LLPacketReceiveThread(S32 socket, U32 capacity = 256);
+	~LLPacketReceiveThread();
+
+	// Consumer side. front() returns the oldest packet or NULL; the packet
+	// stays valid, and its slot reserved, until pop().
+	const Packet*	front() const;
+	void			pop();
+
+	// Packets waiting in the ring.
+	U32				getPendingCount() const	{ return mTail - mHead; }
+	// Times the ring filled up and reading stalled.
+	U32				getStallCount() const	{ return mStallCount; }
+
+	// Splits acks off and zero-code expands packet.mRaw. Public for tests.
+	static void		decodePacket(Packet& packet);
+
+protected:
+	/*virtual*/ void run();
+
+private:
+	S32 readPackets();
+
+	S32				mSocket;
+	U32				mMask;
+	Packet*			mSlots;
+
+	LLAtomicU32		mHead;			// Next slot to consume, written by the consumer
+	LLAtomicU32		mTail;			// Next slot to fill, written by this thread
+	LLAtomicU32		mStallCount;
+};
+
+#endif // LL_LLPACKETRECEIVETHREAD_H
@@ -47,6 +47,9 @@
 #include "llmessagelog.h"
 //</edit>
 
+// Most packets queued between flushes while batching sends.
+static const size_t MAX_QUEUED_SENDS = 64;
+
 ///////////////////////////////////////////////////////////
 LLPacketRing::LLPacketRing () :
 	mUseInThrottle(FALSE),
@@ -59,7 +62,12 @@ LLPacketRing::LLPacketRing () :
 	mInBufferLength(0),
 	mOutBufferLength(0),
 	mDropPercentage(0.0f),
-	mPacketsToDrop(0x0)
+	mPacketsToDrop(0x0),
+	mBatchSends(FALSE),
+	mQueuedSocket(-1),
+	mQueuedCount(0),
+	mSendCalls(0),
+	mSendFailures(0)
 {
 }
 
@@ -87,6 +95,9 @@ void LLPacketRing::cleanup ()
 		delete packetp;
 		mSendQueue.pop();
 	}
+
+	mQueuedCount = 0;
+	delete_and_clear(mQueued);
 }
 
 ///////////////////////////////////////////////////////////
@@ -120,6 +131,31 @@ void LLPacketRing::setOutBandwidth(const F32 bps)
 {
 	mOutThrottle.setRate(bps);
 }
+
+void LLPacketRing::setBatchSends(BOOL batch)
+{
+	if (!batch)
+	{
+		flushSends();
+	}
+	mBatchSends = batch;
+}
+///////////////////////////////////////////////////////////
+BOOL LLPacketRing::dropIncoming()
+{
+	if (mDropPercentage && (ll_frand(100.f) < mDropPercentage))
+	{
+		mPacketsToDrop++;
+	}
+
+	if (mPacketsToDrop)
+	{
+		mPacketsToDrop--;
+		return TRUE;
+	}
+	return FALSE;
+}
+
 ///////////////////////////////////////////////////////////
 S32 LLPacketRing::receiveFromRing (S32 socket, char *datap)
 {
@@ -354,7 +390,33 @@ BOOL LLPacketRing::sendPacket(int h_socket, char * send_buffer, S32 buf_size, LL
 
 BOOL LLPacketRing::sendPacketImpl(int h_socket, const char * send_buffer, S32 buf_size, LLHost host)
 {
-	
+	if (mBatchSends)
+	{
+		if (mQueuedCount && h_socket != mQueuedSocket)
+		{
+			flushSends();
+		}
+		if (mQueuedCount == (S32)mQueued.size())
+		{
+			if (mQueued.size() < MAX_QUEUED_SENDS)
+			{
+				mQueued.push_back(new QueuedPacket);
+			}
+			else
+			{
+				flushSends();
+			}
+		}
+		QueuedPacket* packetp = mQueued[mQueuedCount++];
+		packetp->mHost = host;
+		packetp->mSize = buf_size;
+		memcpy(packetp->getMessage(), send_buffer, buf_size);	/* Flawfinder: ignore */
+		mQueuedSocket = h_socket;
+		// Failures are counted when the queue is flushed.
+		return TRUE;
+	}
+
+	mSendCalls++;
 	if (!LLProxy::isSOCKSProxyEnabled())
 	{
 		return send_packet(h_socket, send_buffer, buf_size, host.getAddress(), host.getPort());
@@ -377,3 +439,50 @@ BOOL LLPacketRing::sendPacketImpl(int h_socket, const char * send_buffer, S32 bu
 						LLProxy::getInstance()->getUDPProxy().getAddress(),
 						LLProxy::getInstance()->getUDPProxy().getPort());
 }
+
+void LLPacketRing::flushSends()
+{
+	if (!mQueuedCount)
+	{
+		return;
+	}
+
+	LLNetSendPacket packets[MAX_QUEUED_SENDS];
+	BOOL use_proxy = LLProxy::isSOCKSProxyEnabled();
+	LLHost proxy;
+	if (use_proxy)
+	{
+		proxy = LLProxy::getInstance()->getUDPProxy();
+	}
+
+	for (S32 i = 0; i < mQueuedCount; ++i)
+	{
+		QueuedPacket* queuedp = mQueued[i];
+		LLNetSendPacket& packet = packets[i];
+		if (use_proxy)
+		{
+			proxywrap_t *socks_header = static_cast<proxywrap_t*>(static_cast<void*>(queuedp->mData));
+			socks_header->rsv   = 0;
+			socks_header->addr  = queuedp->mHost.getAddress();
+			socks_header->port  = htons(queuedp->mHost.getPort());
+			socks_header->atype = ADDRESS_IPV4;
+			socks_header->frag  = 0;
+
+			packet.mBuffer = queuedp->mData;
+			packet.mSize = queuedp->mSize + SOCKS_HEADER_SIZE;
+			packet.mRecipientIP = proxy.getAddress();
+			packet.mRecipientPort = proxy.getPort();
+		}
+		else
+		{
+			packet.mBuffer = queuedp->getMessage();
+			packet.mSize = queuedp->mSize;
+			packet.mRecipientIP = queuedp->mHost.getAddress();
+			packet.mRecipientPort = queuedp->mHost.getPort();
+		}
+	}
+
+	S32 sent = send_packets(mQueuedSocket, packets, mQueuedCount, &mSendCalls);
+	mSendFailures += mQueuedCount - sent;
+	mQueuedCount = 0;
+}
@@ -29,6 +29,7 @@
 #define LL_LLPACKETRING_H
 
 #include <queue>
+#include <vector>
 
 #include "llhost.h"
 #include "llpacketbuffer.h"
@@ -53,13 +54,42 @@ public:
 	S32  receivePacket (S32 socket, char *datap);
 	S32  receiveFromRing (S32 socket, char *datap);
 
+	// For packets read elsewhere (see LLPacketReceiveThread): applies the
+	// simulated packet loss and returns TRUE if the packet should be dropped.
+	BOOL dropIncoming();
+
 	BOOL sendPacket(int h_socket, char * send_buffer, S32 buf_size, LLHost host);
 
+	// Outgoing batching. While enabled, packets are queued instead of sent
+	// and go out together, with as few system calls as possible, from
+	// flushSends(). The message system flushes once a frame; the queue
+	// also flushes itself when full.
+	void setBatchSends(BOOL batch);
+	BOOL getBatchSends() const					{ return mBatchSends; }
+	void flushSends();
+
+	// A packet waiting for flushSends(). There is room in front of the
+	// message for a SOCKS header, and after it for appending acks.
+	struct QueuedPacket
+	{
+		LLHost	mHost;
+		S32		mSize;				// Message bytes, excluding any SOCKS header
+		char	mData[SOCKS_HEADER_SIZE + NET_BUFFER_SIZE];
+
+		char*	getMessage()		{ return mData + SOCKS_HEADER_SIZE; }
+	};
+	S32 getQueuedCount() const					{ return mQueuedCount; }
+	QueuedPacket& getQueued(S32 index)			{ return *mQueued[index]; }
+
 	inline LLHost getLastSender();
 	inline LLHost getLastReceivingInterface();
 
 	S32 getAndResetActualInBits()				{ S32 bits = mActualBitsIn; mActualBitsIn = 0; return bits;}
 	S32 getAndResetActualOutBits()				{ S32 bits = mActualBitsOut; mActualBitsOut = 0; return bits;}
+	// System calls made sending packets, and queued packets that failed
+	// to send
+	S32 getAndResetSendCalls()					{ S32 calls = mSendCalls; mSendCalls = 0; return calls;}
+	S32 getAndResetSendFailures()				{ S32 failures = mSendFailures; mSendFailures = 0; return failures;}
 protected:
 	BOOL mUseInThrottle;
 	BOOL mUseOutThrottle;
@@ -83,6 +113,14 @@ protected:
 	LLHost mLastSender;
 	LLHost mLastReceivingIF;
 
+	BOOL mBatchSends;
+	int mQueuedSocket;
+	S32 mQueuedCount;
+	std::vector<QueuedPacket*> mQueued;		// Grows to the batch size, then is reused
+
+	S32 mSendCalls;
+	S32 mSendFailures;
+
 private:
 	BOOL sendPacketImpl(int h_socket, const char * send_buffer, S32 buf_size, LLHost host);
 };
@@ -328,16 +328,14 @@ std::ostream& operator<<(std::ostream& s, const LLPartSysData &data)
 	return s;
 }
 
-BOOL LLPartSysData::isNullPS(const S32 block_num)
+//static
+BOOL LLPartSysData::isNullPS(const U8* data, S32 size)
 {
 	U8 ps_data_block[PS_MAX_DATA_BLOCK_SIZE];
 	U32 crc;
 
-	S32 size;
 	// Check size of block
-	size = gMessageSystem->getSize("ObjectData", block_num, "PSBlock");
-	
-	if (!size)
+	if (size <= 0)
 	{
 		return TRUE;
 	}
@@ -348,7 +346,7 @@ BOOL LLPartSysData::isNullPS(const S32 block_num)
 		return TRUE;
 	}
 
-	gMessageSystem->getBinaryData("ObjectData", "PSBlock", ps_data_block, size, block_num, PS_MAX_DATA_BLOCK_SIZE);
+	memcpy(ps_data_block, data, size);		/* Flawfinder: ignore */
 
 	LLDataPackerBinaryBuffer dp(ps_data_block, size);
 	if (size > PS_LEGACY_DATA_BLOCK_SIZE)
@@ -372,21 +370,18 @@ BOOL LLPartSysData::isNullPS(const S32 block_num)
 	return FALSE;
 }
 
-BOOL LLPartSysData::unpackBlock(const S32 block_num)
+BOOL LLPartSysData::unpackBlock(const U8* data, S32 size)
 {
 	U8 ps_data_block[PS_MAX_DATA_BLOCK_SIZE];
 
 	// Check size of block
-	S32 size = gMessageSystem->getSize("ObjectData", block_num, "PSBlock");
-
-	if (size > PS_MAX_DATA_BLOCK_SIZE)
+	if (size < 0 || size > PS_MAX_DATA_BLOCK_SIZE)
 	{
 		// Larger packets are newer and unsupported
 		return FALSE;
 	}
 
-	// Get from message
-	gMessageSystem->getBinaryData("ObjectData", "PSBlock", ps_data_block, size, block_num, PS_MAX_DATA_BLOCK_SIZE);
+	memcpy(ps_data_block, data, size);		/* Flawfinder: ignore */
 
 	LLDataPackerBinaryBuffer dp(ps_data_block, size);
 
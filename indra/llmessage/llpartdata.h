@@ -185,9 +185,11 @@ public:
 
 	BOOL unpack(LLDataPacker &dp);
 	BOOL unpackLegacy(LLDataPacker &dp);
-	BOOL unpackBlock(const S32 block_num);
+	// data and size are the PSBlock field of an object update.  Neither
+	// touches the message system, so they may run off the main thread.
+	BOOL unpackBlock(const U8* data, S32 size);
 		
-	static BOOL isNullPS(const S32 block_num); // Returns FALSE if this is a "NULL" particle system (i.e. no system)
+	static BOOL isNullPS(const U8* data, S32 size); // Returns FALSE if this is a "NULL" particle system (i.e. no system)
 
 	bool isLegacyCompatible() const;
 
@@ -223,6 +225,7 @@ public:
 	void clampSourceParticleRate();
 	
 	friend std::ostream&	 operator<<(std::ostream& s, const LLPartSysData &data);		// Stream a
+	friend class LLViewerPartSourceScript;
 
 	S32 getdataBlockSize() const;
 	
@@ -61,6 +61,8 @@ void LLTemplateMessageReader::clearMessage()
 	mCurrentRMessageTemplate = NULL;
 	delete mCurrentRMessageData;
 	mCurrentRMessageData = NULL;
+	mBlockInstances.clear();
+	mBlockRanges.clear();
 }
 
 void LLTemplateMessageReader::getData(const char *blockname, const char *varname, void *datap, S32 size, S32 blocknum, S32 max_size)
@@ -112,7 +114,11 @@ void LLTemplateMessageReader::getData(const char *blockname, const char *varname
 		return;
 	}
 
+	copyData(vardata, datap, max_size);
+}
 
+void LLTemplateMessageReader::copyData(const LLMsgVarData& vardata, void *datap, S32 max_size)
+{
 	const S32 vardata_size = vardata.getSize();
 	if( max_size >= vardata_size )
 	{   
@@ -139,7 +145,7 @@ void LLTemplateMessageReader::getData(const char *blockname, const char *varname
 	else
 	{
 		LL_WARNS() << "Msg " << mCurrentRMessageData->mName 
-			<< " variable " << vnamep
+			<< " variable " << vardata.getName()
 			<< " is size " << vardata.getSize()
 			<< " but truncated to max size of " << max_size
 			<< LL_ENDL;
@@ -148,6 +154,82 @@ void LLTemplateMessageReader::getData(const char *blockname, const char *varname
 	}
 }
 
+// Finds the variable at template position (block_index, var_index) in
+// instance blocknum, provided it is blockname/varname. Never logs: anything
+// unexpected is left for the named getters to report.
+const LLMsgVarData* LLTemplateMessageReader::findIndexedVar(S32 block_index, S32 var_index,
+															 const char *blockname, const char *varname,
+															 S32 blocknum) const
+{
+	if (mReceiveSize == -1 || !mCurrentRMessageData
+		|| block_index < 0 || block_index >= (S32)mBlockRanges.size())
+	{
+		return NULL;
+	}
+
+	const LLMessageBlock* block = *(mCurrentRMessageTemplate->mMemberBlocks.begin() + block_index);
+	const std::pair<U32, U32>& range = mBlockRanges[block_index];
+	if (block->mName != blockname || blocknum < 0 || (U32)blocknum >= range.second)
+	{
+		return NULL;
+	}
+
+	const LLMsgBlkData* block_data = mBlockInstances[range.first + blocknum];
+	if (var_index < 0 || var_index >= (S32)block_data->mMemberVarData.size())
+	{
+		return NULL;
+	}
+
+	// Variables are added in template order, so position is index.
+	const LLMsgVarData& vardata = *(block_data->mMemberVarData.begin() + var_index);
+	if (vardata.getName() != varname)
+	{
+		return NULL;
+	}
+	return &vardata;
+}
+
+//virtual
+BOOL LLTemplateMessageReader::getIndexedData(S32 block_index, S32 var_index,
+											 const char *blockname, const char *varname,
+											 void *datap, S32 size, S32 blocknum,
+											 S32 max_size)
+{
+	const LLMsgVarData* vardata = findIndexedVar(block_index, var_index, blockname, varname, blocknum);
+	if (!vardata || (size && size != vardata->getSize()))
+	{
+		return FALSE;
+	}
+	copyData(*vardata, datap, max_size);
+	return TRUE;
+}
+
+//virtual
+S32 LLTemplateMessageReader::getIndexedSize(S32 block_index, S32 var_index,
+											const char *blockname, const char *varname,
+											S32 blocknum)
+{
+	const LLMsgVarData* vardata = findIndexedVar(block_index, var_index, blockname, varname, blocknum);
+	return vardata ? vardata->getSize() : -1;
+}
+
+//virtual
+S32 LLTemplateMessageReader::getIndexedNumberOfBlocks(S32 block_index, const char *blockname)
+{
+	if (mReceiveSize == -1 || !mCurrentRMessageData
+		|| block_index < 0 || block_index >= (S32)mBlockRanges.size())
+	{
+		return -1;
+	}
+
+	const LLMessageBlock* block = *(mCurrentRMessageTemplate->mMemberBlocks.begin() + block_index);
+	if (block->mName != blockname)
+	{
+		return -1;
+	}
+	return (S32)mBlockRanges[block_index].second;
+}
+
 S32 LLTemplateMessageReader::getNumberOfBlocks(const char *blockname)
 {
 	// is there a message ready to go?
@@ -547,6 +629,8 @@ BOOL LLTemplateMessageReader::decodeData(const U8* buffer, const LLHost& sender,
 
 	// create base working data set
 	mCurrentRMessageData = new LLMsgData(mCurrentRMessageTemplate->mName);
+	mBlockInstances.clear();
+	mBlockRanges.clear();
 	
 	// loop through the template building the data structure as we go
 	LLMessageTemplate::message_block_map_t::const_iterator iter;
@@ -597,6 +681,7 @@ BOOL LLTemplateMessageReader::decodeData(const U8* buffer, const LLHost& sender,
 		}
 
 		LLMsgBlkData* cur_data_block = NULL;
+		mBlockRanges.push_back(std::make_pair((U32)mBlockInstances.size(), (U32)repeat_number));
 
 		// now loop through the block
 		for (i = 0; i < repeat_number; i++)
@@ -615,6 +700,7 @@ BOOL LLTemplateMessageReader::decodeData(const U8* buffer, const LLHost& sender,
 
 			// add the block to the message
 			mCurrentRMessageData->addBlock(cur_data_block);
+			mBlockInstances.push_back(cur_data_block);
 
 			// now read the variables
 			for (LLMessageBlock::message_variable_map_t::const_iterator iter = 
@@ -799,6 +885,14 @@ BOOL LLTemplateMessageReader::readMessage(const U8* buffer,
 	return decodeData(buffer, sender, false);
 }
 
+BOOL LLTemplateMessageReader::decodeMessage(const U8* buffer, S32 buffer_size,
+											const LLHost& sender)
+{
+	clearMessage();
+	return validateMessage(buffer, buffer_size, sender, true, true)
+		&& decodeData(buffer, sender, true);
+}
+
 //virtual 
 const char* LLTemplateMessageReader::getMessageName() const
 {
@@ -30,9 +30,12 @@
 #include "llmessagereader.h"
 
 #include <map>
+#include <vector>
 
 class LLMessageTemplate;
+class LLMsgBlkData;
 class LLMsgData;
+class LLMsgVarData;
 
 class LLTemplateMessageReader : public LLMessageReader
 {
@@ -91,6 +94,15 @@ public:
 	virtual S32	getSize(const char *blockname, S32 blocknum, 
 						const char *varname);
 
+	virtual BOOL getIndexedData(S32 block_index, S32 var_index,
+								const char *blockname, const char *varname,
+								void *datap, S32 size, S32 blocknum = 0,
+								S32 max_size = S32_MAX);
+	virtual S32 getIndexedSize(S32 block_index, S32 var_index,
+							   const char *blockname, const char *varname,
+							   S32 blocknum = 0);
+	virtual S32 getIndexedNumberOfBlocks(S32 block_index, const char *blockname);
+
 	virtual void clearMessage();
 
 	virtual const char* getMessageName() const;
@@ -101,6 +113,9 @@ public:
 	BOOL validateMessage(const U8* buffer, S32 buffer_size, 
 						 const LLHost& sender, bool trusted = false, bool custom = false);
 	BOOL readMessage(const U8* buffer, const LLHost& sender);
+	// Validates and decodes without calling the message handler, for code
+	// that inspects messages outside the message system.
+	BOOL decodeMessage(const U8* buffer, S32 buffer_size, const LLHost& sender);
 
 	bool isTrusted() const;
 	bool isBanned(bool trusted_source) const;
@@ -110,6 +125,10 @@ private:
 
 	void getData(const char *blockname, const char *varname, void *datap, 
 				 S32 size = 0, S32 blocknum = 0, S32 max_size = S32_MAX);
+	void copyData(const LLMsgVarData& vardata, void *datap, S32 max_size);
+	const LLMsgVarData* findIndexedVar(S32 block_index, S32 var_index,
+									   const char *blockname, const char *varname,
+									   S32 blocknum) const;
 
 	BOOL decodeTemplate(const U8* buffer, S32 buffer_size,  // inputs
 						LLMessageTemplate** msg_template,   // outputs
@@ -123,6 +142,12 @@ private:
 	LLMessageTemplate* mCurrentRMessageTemplate;
 	LLMsgData* mCurrentRMessageData;
 	message_template_number_map_t& mMessageNumbers;
+
+	// Decoded blocks in template order, filled in by decodeData(). The i'th
+	// template block's instances start at mBlockRanges[i].first and there
+	// are mBlockRanges[i].second of them.
+	std::vector<LLMsgBlkData*> mBlockInstances;
+	std::vector<std::pair<U32, U32> > mBlockRanges;
 	friend class LLFloaterMessageLogItem;
 };
 
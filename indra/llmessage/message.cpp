@@ -59,6 +59,7 @@
 #include "lltemplatemessagebuilder.h"
 #include "lltemplatemessagereader.h"
 #include "lltrustedmessageservice.h"
+#include "llpacketreceivethread.h"
 #include "llmessagetemplate.h"
 #include "llmessagetemplateparser.h"
 #include "llsd.h"
@@ -81,6 +82,8 @@
 //const char* MESSAGE_LOG_FILENAME = "message.log";
 static const F32Seconds CIRCUIT_DUMP_TIMEOUT(30.f);
 static const S32 TRUST_TIME_WINDOW = 3;
+// Most acks appended to one outgoing packet
+static const S32 MAX_APPENDED_ACKS = 250;
 
 // *NOTE: This needs to be moved into a seperate file so that it never gets
 // included in the viewer.  30 Sep 2002 mark
@@ -275,6 +278,8 @@ LLMessageSystem::LLMessageSystem(const std::string& filename, U32 port,
 	mMaxMessageTime   = F32Seconds(1.f);
 
 	mTrueReceiveSize = 0;
+	mReceiveThread = NULL;
+	mHoldingReceivedPacket = false;
 
 	mReceiveTime = F32Seconds(0.f);
 }
@@ -321,8 +326,11 @@ LLMessageSystem::~LLMessageSystem()
 	for_each(mMessageNumbers.begin(), mMessageNumbers.end(), DeletePairedPointer());
 	mMessageNumbers.clear();
 	
+	setReceiveThreadEnabled(false);
+
 	if (!mbError)
 	{
+		flushSends();
 		end_net(mSocket);
 	}
 	mSocket = 0;
@@ -378,6 +386,32 @@ BOOL LLMessageSystem::poll(F32 seconds)
 	}
 }
 
+void LLMessageSystem::setReceiveThreadEnabled(bool enabled)
+{
+	if (enabled == (mReceiveThread != NULL))
+	{
+		return;
+	}
+
+	if (enabled)
+	{
+		if (mbError)
+		{
+			return;
+		}
+		mReceiveThread = new LLPacketReceiveThread(mSocket);
+		mReceiveThread->start();
+		LL_INFOS("Messaging") << "Receiving packets on a dedicated thread" << LL_ENDL;
+	}
+	else
+	{
+		// Packets still in the ring are dropped; reliable ones get resent.
+		delete mReceiveThread;
+		mReceiveThread = NULL;
+		mHoldingReceivedPacket = false;
+	}
+}
+
 bool LLMessageSystem::isTrustedSender(const LLHost& host) const
 {
 	LLCircuitData* cdp = mCircuitInfo.findCircuit(host);
@@ -508,14 +542,41 @@ BOOL LLMessageSystem::checkMessages( S64 frame_count )
 		S32 true_rcv_size = 0;
 
 		U8* buffer = mTrueReceiveBuffer;
+		const LLPacketReceiveThread::Packet* decoded = NULL;
+
+		if (mReceiveThread)
+		{
+			// Done with the previous packet; its slot can be reused.
+			if (mHoldingReceivedPacket)
+			{
+				mReceiveThread->pop();
+				mHoldingReceivedPacket = false;
+			}
+			decoded = mReceiveThread->front();
+			while (decoded && mPacketRing.dropIncoming())
+			{
+				mReceiveThread->pop();
+				decoded = mReceiveThread->front();
+			}
+			mHoldingReceivedPacket = (decoded != NULL);
 
-		mTrueReceiveSize = mPacketRing.receivePacket(mSocket, (char *)mTrueReceiveBuffer);
-		// If you want to dump all received packets into SecondLife.log, uncomment this
-		//dumpPacketToLog();
+			mTrueReceiveSize = decoded ? decoded->mTrueSize : 0;
+			if (decoded)
+			{
+				mLastSender = decoded->mSender;
+				mLastReceivingIF = decoded->mReceivingIF;
+			}
+		}
+		else
+		{
+			mTrueReceiveSize = mPacketRing.receivePacket(mSocket, (char *)mTrueReceiveBuffer);
+			// If you want to dump all received packets into SecondLife.log, uncomment this
+			//dumpPacketToLog();
 
+			mLastSender = mPacketRing.getLastSender();
+			mLastReceivingIF = mPacketRing.getLastReceivingInterface();
+		}
 		receive_size = mTrueReceiveSize;
-		mLastSender = mPacketRing.getLastSender();
-		mLastReceivingIF = mPacketRing.getLastReceivingInterface();
 		
 		if (receive_size < (S32) LL_MINIMUM_VALID_PACKET_SIZE)
 		{
@@ -534,29 +595,62 @@ BOOL LLMessageSystem::checkMessages( S64 frame_count )
 			LLHost host;
 			LLCircuitData* cdp;
 			
-			// note if packet acks are appended.
-			if(buffer[0] & LL_ACK_FLAG)
+			if (decoded)
 			{
-				acks += buffer[--receive_size];
-				true_rcv_size = receive_size;
-				if(receive_size >= ((S32)(acks * sizeof(TPACKETID) + LL_MINIMUM_VALID_PACKET_SIZE)))
+				// Acks were split off and the packet expanded by the
+				// receive thread.
+				acks = decoded->mNumAcks;
+				if (decoded->mStatus == LLPacketReceiveThread::PACKET_BAD_ACKS)
 				{
-					receive_size -= acks * sizeof(TPACKETID);
-				}
-				else
-				{
-					// mal-formed packet. ignore it and continue with
-					// the next one
 					LL_WARNS("Messaging") << "Malformed packet received. Packet size "
-						<< receive_size << " with invalid no. of acks " << acks
+						<< receive_size - 1 << " with invalid no. of acks " << acks
 						<< LL_ENDL;
 					valid_packet = FALSE;
 					continue;
 				}
+
+				buffer = const_cast<U8*>(decoded->getData());
+				receive_size = decoded->mSize;
+				mIncomingCompressedSize = decoded->mCompressedSize;
+				mTotalBytesIn += mIncomingCompressedSize ? mIncomingCompressedSize : receive_size;
+				if (mIncomingCompressedSize)
+				{
+					mCompressedPacketsIn++;
+					mCompressedBytesIn += mIncomingCompressedSize;
+					mUncompressedBytesIn += receive_size;
+				}
+				if (decoded->mStatus == LLPacketReceiveThread::PACKET_BAD_ZEROCODE)
+				{
+					LL_WARNS("Messaging") << "attempt to write past reasonable encoded buffer size" << LL_ENDL;
+					callExceptionFunc(MX_WROTE_PAST_BUFFER_SIZE);
+				}
 			}
+			else
+			{
+				// note if packet acks are appended.
+				if(buffer[0] & LL_ACK_FLAG)
+				{
+					acks += buffer[--receive_size];
+					true_rcv_size = receive_size;
+					if(receive_size >= ((S32)(acks * sizeof(TPACKETID) + LL_MINIMUM_VALID_PACKET_SIZE)))
+					{
+						receive_size -= acks * sizeof(TPACKETID);
+					}
+					else
+					{
+						// mal-formed packet. ignore it and continue with
+						// the next one
+						LL_WARNS("Messaging") << "Malformed packet received. Packet size "
+							<< receive_size << " with invalid no. of acks " << acks
+							<< LL_ENDL;
+						valid_packet = FALSE;
+						continue;
+					}
+				}
 
-			// process the message as normal
-			mIncomingCompressedSize = zeroCodeExpand(&buffer, &receive_size);
+				// process the message as normal
+				mIncomingCompressedSize = zeroCodeExpand(&buffer, &receive_size);
+			}
 			mCurrentRecvPacketID = ntohl(*((U32*)(&buffer[1])));
 			host = getSender();
 
@@ -567,7 +661,19 @@ BOOL LLMessageSystem::checkMessages( S64 frame_count )
 			// this message came in on if it's valid, and NULL if the
 			// circuit was bogus.
 
-			if(cdp && (acks > 0) && ((S32)(acks * sizeof(TPACKETID)) < (true_rcv_size)))
+			if (cdp && decoded && (acks > 0))
+			{
+				for (S32 i = 0; i < acks; ++i)
+				{
+					cdp->ackReliablePacket(decoded->mAcks[i]);
+				}
+				if (!cdp->getUnackedPacketCount())
+				{
+					// Remove this circuit from the list of circuits with unacked packets
+					mCircuitInfo.mUnackedCircuitMap.erase(cdp->mHost);
+				}
+			}
+			else if(cdp && (acks > 0) && ((S32)(acks * sizeof(TPACKETID)) < (true_rcv_size)))
 			{
 				TPACKETID packet_id;
 				U32 mem_id=0;
@@ -696,7 +802,7 @@ BOOL LLMessageSystem::checkMessages( S64 frame_count )
 				if (cdp && recv_reliable)
 				{
 					// Add to the recently received list for duplicate suppression
-					cdp->mRecentlyReceivedReliablePackets[mCurrentRecvPacketID] = getMessageTimeUsecs();
+					cdp->mRecentlyReceivedReliablePackets.insert(mCurrentRecvPacketID);
 
 					// Put it onto the list of packets to be acked
 					cdp->collectRAck(mCurrentRecvPacketID);
@@ -772,7 +878,10 @@ void LLMessageSystem::processAcks(F32 collect_time)
 		//resend any necessary packets
 		mCircuitInfo.resendUnackedPackets(mUnackedListDepth, mUnackedListSize);
 
-		//cycle through ack list for each host we need to send acks to
+		// Put what acks fit onto packets already queued for their
+		// circuits, then cycle through the ack list for each host we
+		// still need to send acks to
+		appendQueuedAcks();
 		mCircuitInfo.sendAcks(collect_time);
 
 		if (!mDenyTrustedCircuitSet.empty())
@@ -815,6 +924,65 @@ void LLMessageSystem::processAcks(F32 collect_time)
 		mResendDumpTime = mt_sec;
 		mCircuitInfo.dumpResends();
 	}
+
+	flushSends();
+}
+
+void LLMessageSystem::flushSends()
+{
+	if (mPacketRing.getQueuedCount())
+	{
+		appendQueuedAcks();
+		mPacketRing.flushSends();
+	}
+	mSendPacketFailureCount += mPacketRing.getAndResetSendFailures();
+}
+
+// Acks collected since a queued packet was built can still ride along with
+// it, saving a PacketAck message of their own.
+void LLMessageSystem::appendQueuedAcks()
+{
+	for (S32 i = 0; i < mPacketRing.getQueuedCount(); ++i)
+	{
+		LLPacketRing::QueuedPacket& packet = mPacketRing.getQueued(i);
+		LLCircuitData* cdp = mCircuitInfo.findCircuit(packet.mHost);
+		if (!cdp || !cdp->getPendingAckCount())
+		{
+			continue;
+		}
+
+		U8* buf_ptr = (U8*)packet.getMessage();
+		S32 buffer_length = packet.mSize;
+		S32 appended = 0;
+		if (buf_ptr[0] & LL_ACK_FLAG)
+		{
+			// Already carries acks; add to them, count byte last.
+			appended = buf_ptr[--buffer_length];
+		}
+		S32 space_left = (MTUBYTES - buffer_length - 1) / (S32)sizeof(TPACKETID);
+		S32 append_ack_count = llmin(space_left, MAX_APPENDED_ACKS - appended);
+		if (append_ack_count <= 0)
+		{
+			continue;
+		}
+
+		if(mVerboseLog)
+		{
+			std::ostringstream str;
+			str << "MSG: -> " << packet.mHost << "\tQUEUED ACKS:\t";
+			std::ostream_iterator<TPACKETID> append(str, " ");
+			S32 count = llmin(append_ack_count, cdp->getPendingAckCount());
+			std::copy(cdp->mAcks.begin() + cdp->mAckHead,
+					  cdp->mAcks.begin() + cdp->mAckHead + count, append);
+			LL_INFOS("Messaging") << str.str() << LL_ENDL;
+		}
+
+		S32 added = cdp->packAcks(&buf_ptr[buffer_length], append_ack_count);
+		buffer_length += added * sizeof(TPACKETID);
+		buf_ptr[buffer_length++] = (U8)(appended + added);
+		buf_ptr[0] |= LL_ACK_FLAG;
+		packet.mSize = buffer_length;
+	}
 }
 
 void LLMessageSystem::copyMessageReceivedToSend()
@@ -1213,7 +1381,7 @@ S32 LLMessageSystem::sendMessage(const LLHost &host)
 
 	// tack packet acks onto the end of this message
 	S32 space_left = (MTUBYTES - buffer_length) / sizeof(TPACKETID); // space left for packet ids
-	S32 ack_count = (S32)cdp->mAcks.size();
+	S32 ack_count = cdp->getPendingAckCount();
 	BOOL is_ack_appended = FALSE;
 	std::vector<TPACKETID> acks;
 	if((space_left > 0) && (ack_count > 0) && 
@@ -1221,46 +1389,26 @@ S32 LLMessageSystem::sendMessage(const LLHost &host)
 	{
 		buf_ptr[0] |= LL_ACK_FLAG;
 		S32 append_ack_count = llmin(space_left, ack_count);
-		const S32 MAX_ACKS = 250;
-		append_ack_count = llmin(append_ack_count, MAX_ACKS);
-		std::vector<TPACKETID>::iterator iter = cdp->mAcks.begin();
-		std::vector<TPACKETID>::iterator last = cdp->mAcks.begin();
-		last += append_ack_count;
-		TPACKETID packet_id;
-		for( ; iter != last ; ++iter)
-		{
-			// grab the next packet id.
-			packet_id = (*iter);
-			if(mVerboseLog)
-			{
-				acks.push_back(packet_id);
-			}
-
-			// put it on the end of the buffer
-			packet_id = htonl(packet_id);
-
-			if((S32)(buffer_length + sizeof(TPACKETID)) < MAX_BUFFER_SIZE)
-			{
-			    memcpy(&buf_ptr[buffer_length], &packet_id, sizeof(TPACKETID));	/* Flawfinder: ignore */
-			    // Do the accounting
-			    buffer_length += sizeof(TPACKETID);
-			}
-			else
-			{
-			    // Just reporting error is likely not enough.  Need to
-			    // check how to abort or error out gracefully from
-			    // this function. XXXTBD
-				// *NOTE: Actually hitting this error would indicate
-				// the calculation above for space_left, ack_count,
-				// append_acout_count is incorrect or that
-				// MAX_BUFFER_SIZE has fallen below MTU which is bad
-				// and probably programmer error.
-			    LL_ERRS("Messaging") << "Buffer packing failed due to size.." << LL_ENDL;
-			}
+		append_ack_count = llmin(append_ack_count, MAX_APPENDED_ACKS);
+		if((S32)(buffer_length + append_ack_count * sizeof(TPACKETID)) >= MAX_BUFFER_SIZE)
+		{
+			// *NOTE: Actually hitting this error would indicate
+			// the calculation above for space_left, ack_count,
+			// append_acout_count is incorrect or that
+			// MAX_BUFFER_SIZE has fallen below MTU which is bad
+			// and probably programmer error.
+			LL_ERRS("Messaging") << "Buffer packing failed due to size.." << LL_ENDL;
+		}
+		if(mVerboseLog)
+		{
+			acks.assign(cdp->mAcks.begin() + cdp->mAckHead,
+						cdp->mAcks.begin() + cdp->mAckHead + append_ack_count);
 		}
 
-		// clean up the source
-		cdp->mAcks.erase(cdp->mAcks.begin(), last);
+		// put them all on the end of the buffer in one pass, and clean
+		// up the source
+		append_ack_count = cdp->packAcks(&buf_ptr[buffer_length], append_ack_count);
+		buffer_length += append_ack_count * sizeof(TPACKETID);
 
 		// tack the count in the final byte
 		U8 count = (U8)append_ack_count;
@@ -2649,6 +2797,7 @@ void end_messaging_system(bool print_summary)
 		delete gMessageSystem;
 		gMessageSystem = NULL;
 	}
+	LLReliablePacket::cleanupPool();
 }
 
 void LLMessageSystem::resetReceiveCounts()
@@ -2836,78 +2985,81 @@ S32 LLMessageSystem::zeroCodeExpand(U8** data, S32* data_size)
 	S32 in_size = *data_size;
 	mCompressedPacketsIn++;
 	mCompressedBytesIn += *data_size;
-	
-	*data[0] &= (~LL_ZERO_CODE_FLAG);
 
-	S32 count = (*data_size);  
-	
-	U8 *inptr = (U8 *)*data;
-	U8 *outptr = (U8 *)mEncodedRecvBuffer;
+	S32 expanded_size = zero_code_expand(*data, *data_size, mEncodedRecvBuffer, MAX_BUFFER_SIZE);
+	if (expanded_size < 0)
+	{
+		LL_WARNS("Messaging") << "attempt to write past reasonable encoded buffer size" << LL_ENDL;
+		callExceptionFunc(MX_WROTE_PAST_BUFFER_SIZE);
+		expanded_size = 0;
+	}
 
-// skip the packet id field
+	*data = mEncodedRecvBuffer;
+	*data_size = expanded_size;
+	mUncompressedBytesIn += *data_size;
 
-	for (U32 ii = 0; ii < LL_PACKET_ID_SIZE; ++ii)
+	return(in_size);
+}
+
+S32 zero_code_expand(const U8* in, S32 in_size, U8* out, S32 out_capacity)
+{
+	if (in_size < LL_PACKET_ID_SIZE || out_capacity < LL_PACKET_ID_SIZE)
 	{
-		count--;
-		*outptr++ = *inptr++;
+		return -1;
 	}
 
-// reconstruct encoded packet, keeping track of net size gain
+	const U8* in_end = in + in_size;
+	U8* out_begin = out;
+	U8* out_end = out + out_capacity;
 
-// sequential zero bytes are encoded as 0 [U8 count] 
-// with 0 0 [count] representing wrap (>256 zeroes)
+	// the header is never encoded
+	memcpy(out, in, LL_PACKET_ID_SIZE);	/* Flawfinder: ignore */
+	out[0] &= ~LL_ZERO_CODE_FLAG;
+	in += LL_PACKET_ID_SIZE;
+	out += LL_PACKET_ID_SIZE;
 
-	while (count--)
+	// sequential zero bytes are encoded as 0 [U8 count] 
+	// with 0 0 [count] representing wrap (>256 zeroes)
+	while (in < in_end)
 	{
-		if (outptr > (&mEncodedRecvBuffer[MAX_BUFFER_SIZE-1]))
+		if (out >= out_end)
 		{
-			LL_WARNS("Messaging") << "attempt to write past reasonable encoded buffer size 1" << LL_ENDL;
-			callExceptionFunc(MX_WROTE_PAST_BUFFER_SIZE);
-			outptr = mEncodedRecvBuffer;					
-			break;
+			return -1;
 		}
-		if (!((*outptr++ = *inptr++)))
+		U8 byte = *in++;
+		*out++ = byte;
+		if (byte)
 		{
-			while (((count--)) && (!(*inptr)))
-			{
-				*outptr++ = *inptr++;
-  				if (outptr > (&mEncodedRecvBuffer[MAX_BUFFER_SIZE-256]))
-  				{
-  					LL_WARNS("Messaging") << "attempt to write past reasonable encoded buffer size 2" << LL_ENDL;
-					callExceptionFunc(MX_WROTE_PAST_BUFFER_SIZE);
-					outptr = mEncodedRecvBuffer;
-					count = -1;
-					break;
-  				}
-				memset(outptr,0,255);
-				outptr += 255;
-			}
-			
-			if (count < 0)
-			{
-				break;
-			}
+			continue;
+		}
 
-			else
+		// each extra zero stands for another 256
+		while (in < in_end && !*in)
+		{
+			++in;
+			if (out_end - out < 256)
 			{
-  				if (outptr > (&mEncodedRecvBuffer[MAX_BUFFER_SIZE-(*inptr)]))
-				{
-  					LL_WARNS("Messaging") << "attempt to write past reasonable encoded buffer size 3" << LL_ENDL;
-					callExceptionFunc(MX_WROTE_PAST_BUFFER_SIZE);
-					outptr = mEncodedRecvBuffer;					
-				}
-				memset(outptr,0,(*inptr) - 1);
-				outptr += ((*inptr) - 1);
-				inptr++;
+				return -1;
 			}
-		}		
+			memset(out, 0, 256);
+			out += 256;
+		}
+		if (in == in_end)
+		{
+			break;
+		}
+
+		// the count includes the zero already written
+		S32 run = *in++ - 1;
+		if (out_end - out < run)
+		{
+			return -1;
+		}
+		memset(out, 0, run);
+		out += run;
 	}
-	
-	*data = mEncodedRecvBuffer;
-	*data_size = (S32)(outptr - mEncodedRecvBuffer);
-	mUncompressedBytesIn += *data_size;
 
-	return(in_size);
+	return (S32)(out - out_begin);
 }
 
 
@@ -3958,6 +4110,23 @@ S32	LLMessageSystem::getSize(const char *blockname, S32 blocknum,
 					   LLMessageStringTable::getInstance()->getString(varname));
 }
 
+BOOL LLMessageSystem::getIndexedData(S32 block_index, S32 var_index, const char *blockname, const char *varname,
+									 void *datap, S32 size, S32 blocknum, S32 max_size)
+{
+	return mMessageReader->getIndexedData(block_index, var_index, blockname, varname, datap, size, blocknum, max_size);
+}
+
+S32 LLMessageSystem::getIndexedSize(S32 block_index, S32 var_index, const char *blockname, const char *varname,
+									S32 blocknum) const
+{
+	return mMessageReader->getIndexedSize(block_index, var_index, blockname, varname, blocknum);
+}
+
+S32 LLMessageSystem::getIndexedNumberOfBlocks(S32 block_index, const char *blockname) const
+{
+	return mMessageReader->getIndexedNumberOfBlocks(block_index, blockname);
+}
+
 S32 LLMessageSystem::getReceiveSize() const
 {
 	return mMessageReader->getMessageSize();
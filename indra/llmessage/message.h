@@ -140,6 +140,11 @@ enum EPacketHeaderLayout
 	PHL_NAME = 6
 };
 
+// Expands a zero-coded packet from in into out and clears LL_ZERO_CODE_FLAG
+// in the copy. Returns the expanded size, or -1 if it wouldn't fit in
+// out_capacity bytes. Touches no message system state.
+S32 zero_code_expand(const U8* in, S32 in_size, U8* out, S32 out_capacity);
+
 
 const S32 LL_DEFAULT_RELIABLE_RETRIES = 3;
 const F32Seconds LL_MINIMUM_RELIABLE_TIMEOUT_SECONDS(1.f);
@@ -181,6 +186,7 @@ class LLMsgBlkData;
 class LLMessageTemplate;
 
 class LLMessagePollInfo;
+class LLPacketReceiveThread;
 class LLMessageBuilder;
 class LLTemplateMessageBuilder;
 class LLSDMessageBuilder;
@@ -334,8 +340,20 @@ public:
 
 	BOOL	poll(F32 seconds); // Number of seconds that we want to block waiting for data, returns if data was received
 	BOOL	checkMessages( S64 frame_count = 0 );
+
+	// Read the socket on a dedicated thread (see LLPacketReceiveThread)
+	// instead of from checkMessages(). The simulated inbound throttle of
+	// mPacketRing is not applied while this is on.
+	void	setReceiveThreadEnabled(bool enabled);
+	bool	getReceiveThreadEnabled() const { return mReceiveThread != NULL; }
 	void	processAcks(F32 collect_time = 0.f);
 
+	// Sends the packets mPacketRing has queued up while batching sends,
+	// first appending whatever acks are pending for their circuits.
+	// processAcks() calls this; call it directly after sending outside of
+	// the usual frame loop.
+	void	flushSends();
+
 	BOOL	isMessageFast(const char *msg);
 	BOOL	isMessage(const char *msg)
 	{
@@ -653,6 +671,15 @@ public:
 						const char *varname) const; // size in bytes of data
 	S32		getSize(const char *blockname, S32 blocknum, const char *varname) const;
 
+	// Template position lookups behind LLMessageField (llmessagefield.h).
+	// Names must be canonical; these fail rather than complain when the
+	// current message doesn't have blockname/varname at that position.
+	BOOL	getIndexedData(S32 block_index, S32 var_index, const char *blockname, const char *varname,
+						   void *datap, S32 size, S32 blocknum = 0, S32 max_size = S32_MAX);
+	S32		getIndexedSize(S32 block_index, S32 var_index, const char *blockname, const char *varname,
+						   S32 blocknum = 0) const;
+	S32		getIndexedNumberOfBlocks(S32 block_index, const char *blockname) const;
+
 	void	resetReceiveCounts();				// resets receive counts for all message types to 0
 	void	dumpReceiveCounts();				// dumps receive count for each message type to LL_INFOS()
 	void	dumpCircuitInfo();					// Circuit information to LL_INFOS()
@@ -765,6 +792,8 @@ private:
 	void		logValidMsg(LLCircuitData *cdp, const LLHost& sender, BOOL recv_reliable, BOOL recv_resent, BOOL recv_acks );
 	void		logRanOffEndOfPacket( const LLHost& sender );
 
+	void		appendQueuedAcks();
+
 	class LLMessageCountInfo
 	{
 	public:
@@ -779,6 +808,9 @@ private:
 	U8	mTrueReceiveBuffer[MAX_BUFFER_SIZE];
 	S32	mTrueReceiveSize;
 
+	LLPacketReceiveThread*	mReceiveThread;
+	bool					mHoldingReceivedPacket;	// front() of mReceiveThread is the current packet
+
 	// Must be valid during decode
 	
 	BOOL	mbError;
@@ -40,6 +40,7 @@
 	#include <arpa/inet.h>
 	#include <fcntl.h>
 	#include <errno.h>
+	#include <sys/select.h>
 #endif
 
 // linden library includes
@@ -179,6 +180,19 @@ U32 ip_string_to_u32(const char* ip_string)
 	return ip;
 }
 
+BOOL wait_for_packets(int hSocket, S32 timeout_ms)
+{
+	fd_set read_set;
+	FD_ZERO(&read_set);
+	FD_SET(hSocket, &read_set);
+
+	struct timeval timeout;
+	timeout.tv_sec = timeout_ms / 1000;
+	timeout.tv_usec = (timeout_ms % 1000) * 1000;
+
+	return select(hSocket + 1, &read_set, NULL, NULL, &timeout) > 0;
+}
+
 
 //////////////////////////////////////////////////////////////////////////////////////////
 // Windows Versions
@@ -338,6 +352,38 @@ S32 receive_packet(int hSocket, char * receiveBuffer)
 	return nRet;
 }
 
+S32 receive_packets(int hSocket, LLNetPacket* packets, S32 max_packets)
+{
+	S32 count = 0;
+	while (count < max_packets)
+	{
+		LLNetPacket& packet = packets[count];
+		SOCKADDR_IN src_addr;
+		int addr_size = sizeof(src_addr);
+		int size = recvfrom(hSocket, packet.mBuffer, NET_BUFFER_SIZE, 0, (struct sockaddr*)&src_addr, &addr_size);
+		if (size == SOCKET_ERROR)
+		{
+			int error = WSAGetLastError();
+			if (WSAECONNRESET == error)
+			{
+				// ICMP port unreachable from an earlier send, not a packet
+				continue;
+			}
+			if (WSAEWOULDBLOCK != error)
+			{
+				LL_INFOS() << "receive_packets() failed, Error: " << error << LL_ENDL;
+			}
+			break;
+		}
+		packet.mSize = size;
+		packet.mSenderIP = src_addr.sin_addr.s_addr;
+		packet.mSenderPort = ntohs(src_addr.sin_port);
+		packet.mReceivingIFIP = INVALID_HOST_IP_ADDRESS;
+		++count;
+	}
+	return count;
+}
+
 // Returns TRUE on success.
 BOOL send_packet(int hSocket, const char *sendBuffer, int size, U32 recipient, int nPort)
 {
@@ -598,6 +644,135 @@ int receive_packet(int hSocket, char * receiveBuffer)
 	return nRet;
 }
 
+#if LL_LINUX
+S32 receive_packets(int hSocket, LLNetPacket* packets, S32 max_packets)
+{
+	const S32 MAX_BATCH = 64;
+	struct mmsghdr msgs[MAX_BATCH];
+	struct iovec iovs[MAX_BATCH];
+	struct sockaddr_in src_addrs[MAX_BATCH];
+	char cmsgs[MAX_BATCH][CMSG_SPACE(sizeof(struct in_pktinfo))];
+
+	S32 batch = llmin(max_packets, MAX_BATCH);
+	memset(msgs, 0, sizeof(msgs[0]) * batch);
+	for (S32 i = 0; i < batch; ++i)
+	{
+		iovs[i].iov_base = packets[i].mBuffer;
+		iovs[i].iov_len = NET_BUFFER_SIZE;
+		msgs[i].msg_hdr.msg_name = &src_addrs[i];
+		msgs[i].msg_hdr.msg_namelen = sizeof(src_addrs[i]);
+		msgs[i].msg_hdr.msg_iov = &iovs[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+		msgs[i].msg_hdr.msg_control = cmsgs[i];
+		msgs[i].msg_hdr.msg_controllen = sizeof(cmsgs[i]);
+	}
+
+	int count = recvmmsg(hSocket, msgs, batch, MSG_DONTWAIT, NULL);
+	if (count <= 0)
+	{
+		return 0;
+	}
+
+	for (S32 i = 0; i < count; ++i)
+	{
+		LLNetPacket& packet = packets[i];
+		packet.mSize = msgs[i].msg_len;
+		packet.mSenderIP = src_addrs[i].sin_addr.s_addr;
+		packet.mSenderPort = ntohs(src_addrs[i].sin_port);
+		packet.mReceivingIFIP = INVALID_HOST_IP_ADDRESS;
+
+		for (struct cmsghdr* cmsgptr = CMSG_FIRSTHDR(&msgs[i].msg_hdr); cmsgptr != NULL; cmsgptr = CMSG_NXTHDR(&msgs[i].msg_hdr, cmsgptr))
+		{
+			if (cmsgptr->cmsg_level == SOL_IP && cmsgptr->cmsg_type == IP_PKTINFO)
+			{
+				in_pktinfo* pktinfo = (in_pktinfo*)CMSG_DATA(cmsgptr);
+				packet.mReceivingIFIP = pktinfo->ipi_spec_dst.s_addr;
+			}
+		}
+	}
+	return count;
+}
+
+S32 send_packets(int hSocket, const LLNetSendPacket* packets, S32 count, S32* calls)
+{
+	const S32 MAX_BATCH = 64;
+	struct mmsghdr msgs[MAX_BATCH];
+	struct iovec iovs[MAX_BATCH];
+	struct sockaddr_in dst_addrs[MAX_BATCH];
+
+	S32 sent = 0;
+	S32 done = 0;
+	S32 send_attempts = 0;
+	while (done < count)
+	{
+		S32 batch = llmin(count - done, MAX_BATCH);
+		memset(msgs, 0, sizeof(msgs[0]) * batch);
+		memset(dst_addrs, 0, sizeof(dst_addrs[0]) * batch);
+		for (S32 i = 0; i < batch; ++i)
+		{
+			const LLNetSendPacket& packet = packets[done + i];
+			dst_addrs[i].sin_family = AF_INET;
+			dst_addrs[i].sin_addr.s_addr = packet.mRecipientIP;
+			dst_addrs[i].sin_port = htons(packet.mRecipientPort);
+			iovs[i].iov_base = (void*)packet.mBuffer;
+			iovs[i].iov_len = packet.mSize;
+			msgs[i].msg_hdr.msg_name = &dst_addrs[i];
+			msgs[i].msg_hdr.msg_namelen = sizeof(dst_addrs[i]);
+			msgs[i].msg_hdr.msg_iov = &iovs[i];
+			msgs[i].msg_hdr.msg_iovlen = 1;
+		}
+
+		int ret = sendmmsg(hSocket, msgs, batch, 0);
+		if (calls)
+		{
+			++*calls;
+		}
+		if (ret > 0)
+		{
+			sent += ret;
+			done += ret;
+			send_attempts = 0;
+			continue;
+		}
+
+		// The first datagram of the batch failed. Retry it the way
+		// send_packet() would, then give up on it and carry on.
+		if ((errno == EAGAIN || errno == ECONNREFUSED) && ++send_attempts < 3)
+		{
+			LL_INFOS() << "sendmmsg() reported " << strerror(errno) << ", resending (attempt " << send_attempts << ")" << LL_ENDL;
+			continue;
+		}
+		LL_INFOS() << "sendmmsg() failed: " << errno << ", " << strerror(errno) << LL_ENDL;
+		LL_INFOS() << u32_to_ip_string(packets[done].mRecipientIP) << ":" << packets[done].mRecipientPort << LL_ENDL;
+		++done;
+		send_attempts = 0;
+	}
+	return sent;
+}
+#else
+S32 receive_packets(int hSocket, LLNetPacket* packets, S32 max_packets)
+{
+	S32 count = 0;
+	while (count < max_packets)
+	{
+		LLNetPacket& packet = packets[count];
+		struct sockaddr_in src_addr;
+		socklen_t addr_size = sizeof(src_addr);
+		int size = recvfrom(hSocket, packet.mBuffer, NET_BUFFER_SIZE, 0, (struct sockaddr*)&src_addr, &addr_size);
+		if (size < 0)
+		{
+			break;
+		}
+		packet.mSize = size;
+		packet.mSenderIP = src_addr.sin_addr.s_addr;
+		packet.mSenderPort = ntohs(src_addr.sin_port);
+		packet.mReceivingIFIP = INVALID_HOST_IP_ADDRESS;
+		++count;
+	}
+	return count;
+}
+#endif
+
 BOOL send_packet(int hSocket, const char * sendBuffer, int size, U32 recipient, int nPort)
 {
 	int		ret;
@@ -660,4 +835,23 @@ BOOL send_packet(int hSocket, const char * sendBuffer, int size, U32 recipient,
 
 #endif
 
+#if !LL_LINUX
+S32 send_packets(int hSocket, const LLNetSendPacket* packets, S32 count, S32* calls)
+{
+	S32 sent = 0;
+	for (S32 i = 0; i < count; ++i)
+	{
+		if (send_packet(hSocket, packets[i].mBuffer, packets[i].mSize, packets[i].mRecipientIP, packets[i].mRecipientPort))
+		{
+			++sent;
+		}
+		if (calls)
+		{
+			++*calls;
+		}
+	}
+	return sent;
+}
+#endif
+
 //EOF
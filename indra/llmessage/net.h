@@ -45,6 +45,38 @@ S32		receive_packet(int hSocket, char * receiveBuffer);
 
 BOOL	send_packet(int hSocket, const char *sendBuffer, int size, U32 recipient, int nPort);	// Returns TRUE on success.
 
+// One datagram read by receive_packets().
+struct LLNetPacket
+{
+	char*	mBuffer;			// In: at least NET_BUFFER_SIZE bytes
+	S32		mSize;				// Out: bytes received
+	U32		mSenderIP;
+	U32		mSenderPort;
+	U32		mReceivingIFIP;		// INVALID_HOST_IP_ADDRESS where unknown
+};
+
+// Reads up to max_packets waiting datagrams, with a single recvmmsg() call
+// on Linux. Returns the number read. Unlike receive_packet(), this doesn't
+// touch the get_sender() state, so it may run on a thread of its own.
+S32		receive_packets(int hSocket, LLNetPacket* packets, S32 max_packets);
+
+// One datagram for send_packets().
+struct LLNetSendPacket
+{
+	const char*	mBuffer;
+	S32			mSize;
+	U32			mRecipientIP;
+	U32			mRecipientPort;
+};
+
+// Sends count datagrams, with as few sendmmsg() calls as the kernel allows on
+// Linux and one sendto() each elsewhere. Returns the number sent. If calls is
+// given, it is incremented by the number of system calls made.
+S32		send_packets(int hSocket, const LLNetSendPacket* packets, S32 count, S32* calls = NULL);
+
+// Waits up to timeout_ms for the socket to become readable.
+BOOL	wait_for_packets(int hSocket, S32 timeout_ms);
+
 //void	get_sender(char * tmp);
 LLHost	get_sender();
 U32		get_sender_port();
@@ -0,0 +1,207 @@
+/**
+ * @file llavatarnamestore_test.cpp
+ * @brief LLAvatarNameStore persistence tests
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llavatarnamestore.h"
+
+#include "llfile.h"
+#include "llsd.h"
+
+#include "../test/lltut.h"
+
+namespace
+{
+	LLAvatarName make_name(const std::string& username, const std::string& display, F64 expires)
+	{
+		LLSD sd;
+		sd["username"] = username;
+		sd["display_name"] = display;
+		sd["legacy_first_name"] = username;
+		sd["legacy_last_name"] = "Resident";
+		LLAvatarName av_name;
+		av_name.fromLLSD(sd);
+		av_name.mExpires = expires;
+		return av_name;
+	}
+}
+
+namespace tut
+{
+	struct avatarnamestore_data
+	{
+		avatarnamestore_data()
+		{
+			mFilename = std::string(LLFile::tmpdir()) + "llavatarnamestore_test.bin";
+			LLFile::remove_nowarn(mFilename);
+		}
+		~avatarnamestore_data()
+		{
+			LLFile::remove_nowarn(mFilename);
+			LLFile::remove_nowarn(mFilename + ".tmp");
+		}
+
+		std::string mFilename;
+	};
+	typedef test_group<avatarnamestore_data> avatarnamestore_test;
+	typedef avatarnamestore_test::object avatarnamestore_object;
+	tut::avatarnamestore_test avatarnamestore("LLAvatarNameStore");
+
+	template<> template<>
+	void avatarnamestore_object::test<1>()
+	{
+		set_test_name("round trip, newest record wins");
+
+		LLUUID a, b, c;
+		a.generate();
+		b.generate();
+		c.generate();
+
+		{
+			LLAvatarNameStore store;
+			ensure("open missing file", store.open(mFilename, 0.0));
+			store.put(a, make_name("alpha", "Alpha", 1000.0));
+			store.put(b, make_name("bravo", "Bravo", 1000.0));
+			store.put(c, make_name("charlie", "Charlie", 1000.0));
+			store.put(a, make_name("alpha", "Alpha Two", 2000.0));
+			store.erase(c);
+			ensure("flush", store.flush());
+		}
+
+		LLAvatarNameStore store;
+		ensure("reopen", store.open(mFilename, 0.0));
+		ensure_equals("records", store.getRecordCount(), 5);
+		ensure_equals("live names", store.getCount(), 2);
+
+		LLAvatarName av_name;
+		ensure("take a", store.take(a, av_name));
+		ensure_equals("newest display name", av_name.getDisplayName(), std::string("Alpha Two"));
+		ensure_equals("newest expiry", av_name.mExpires, 2000.0);
+		ensure("a taken only once", !store.take(a, av_name));
+		ensure("erased c", !store.take(c, av_name));
+		ensure("take b", store.take(b, av_name));
+		ensure_equals("b username", av_name.getAccountName(), std::string("bravo"));
+	}
+
+	template<> template<>
+	void avatarnamestore_object::test<2>()
+	{
+		set_test_name("expired and damaged records are dropped");
+
+		LLUUID a, b;
+		a.generate();
+		b.generate();
+		{
+			LLAvatarNameStore store;
+			store.open(mFilename, 0.0);
+			store.put(a, make_name("alpha", "Alpha", 100.0));
+			store.put(b, make_name("bravo", "Bravo", 5000.0));
+			store.flush();
+		}
+
+		// Half a record, as a crash mid-append would leave
+		{
+			llofstream out(mFilename.c_str(), std::ios::out | std::ios::binary | std::ios::app);
+			U32 size = 200;
+			out.write((const char*)&size, sizeof(size));
+			out.write("partial", 7);
+		}
+
+		{
+			LLAvatarNameStore store;
+			ensure("open damaged", store.open(mFilename, 1000.0));
+			ensure_equals("only the unexpired name", store.getCount(), 1);
+			LLAvatarName av_name;
+			ensure("expired a", !store.take(a, av_name));
+			ensure("b survives", store.take(b, av_name));
+
+			// Appends after the cut must read back.
+			store.put(a, make_name("alpha", "Alpha", 6000.0));
+		}
+
+		LLAvatarNameStore store;
+		ensure("reopen", store.open(mFilename, 1000.0));
+		LLAvatarName av_name;
+		ensure("appended after damage", store.take(a, av_name));
+
+		llofstream out(mFilename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+		out << "<?xml version=\"1.0\" ?><llsd></llsd>";
+		out.close();
+		ensure("not a name store", !store.open(mFilename, 0.0));
+	}
+
+	template<> template<>
+	void avatarnamestore_object::test<3>()
+	{
+		set_test_name("compaction");
+
+		const S32 NAMES = 600;
+		std::vector<LLUUID> ids(NAMES);
+		std::map<LLUUID, LLAvatarName> held;
+		{
+			LLAvatarNameStore store;
+			store.open(mFilename, 0.0);
+			for (S32 i = 0; i < NAMES; ++i)
+			{
+				ids[i].generate();
+				store.put(ids[i], make_name("user", "First", 1000.0));
+			}
+			store.flush();
+		}
+
+		LLAvatarNameStore store;
+		store.open(mFilename, 0.0);
+		// Refresh the first half three times over, holding on to them.
+		for (S32 pass = 0; pass < 3; ++pass)
+		{
+			for (S32 i = 0; i < NAMES / 2; ++i)
+			{
+				LLAvatarName av_name = make_name("user", "Refreshed", 2000.0 + pass);
+				store.put(ids[i], av_name);
+				held[ids[i]] = av_name;
+			}
+		}
+		ensure_equals("records", store.getRecordCount(), NAMES + 3 * NAMES / 2);
+		ensure_equals("undecoded", store.getCount(), NAMES / 2);
+		ensure("wants compaction", store.needsCompaction(held.size()));
+
+		ensure("compact", store.compact(held, 0.0));
+		ensure_equals("compacted records", store.getRecordCount(), NAMES);
+		ensure("no longer wants compaction", !store.needsCompaction(held.size()));
+
+		// Undecoded records moved with the rewrite.
+		LLAvatarName av_name;
+		ensure("undecoded name after compaction", store.take(ids[NAMES - 1], av_name));
+		ensure_equals("undecoded display name", av_name.getDisplayName(), std::string("First"));
+		store.close();
+
+		ensure("reopen", store.open(mFilename, 0.0));
+		ensure_equals("reopened records", store.getRecordCount(), NAMES);
+		ensure("refreshed name", store.take(ids[0], av_name));
+		ensure_equals("refreshed display name", av_name.getDisplayName(), std::string("Refreshed"));
+		ensure_equals("refreshed expiry", av_name.mExpires, 2002.0);
+	}
+}
@@ -0,0 +1,432 @@
+/**
+ * @file llmessagefield_test.cpp
+ * @brief LLMessageField correctness and decode benchmark against the named getters
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llmessagefield.h"
+
+#include "../llmessagetemplate.h"
+#include "../llmessagetemplateparser.h"
+#include "../lltemplatemessagebuilder.h"
+#include "../lltemplatemessagereader.h"
+#include "lltimer.h"
+
+#include "../test/lltut.h"
+
+namespace
+{
+	// ObjectUpdate and ImprovedTerseObjectUpdate as in message_template.msg.
+	const char* TEMPLATE =
+		"version 2.0\n"
+		"{\n"
+		"	ObjectUpdate High 12 Trusted Zerocoded\n"
+		"	{ RegionData Single { RegionHandle U64 } { TimeDilation U16 } }\n"
+		"	{\n"
+		"		ObjectData Variable\n"
+		"		{ ID U32 } { State U8 } { FullID LLUUID } { CRC U32 } { PCode U8 }\n"
+		"		{ Material U8 } { ClickAction U8 } { Scale LLVector3 } { ObjectData Variable 1 }\n"
+		"		{ ParentID U32 } { UpdateFlags U32 }\n"
+		"		{ PathCurve U8 } { ProfileCurve U8 } { PathBegin U16 } { PathEnd U16 }\n"
+		"		{ PathScaleX U8 } { PathScaleY U8 } { PathShearX U8 } { PathShearY U8 }\n"
+		"		{ PathTwist S8 } { PathTwistBegin S8 } { PathRadiusOffset S8 } { PathTaperX S8 }\n"
+		"		{ PathTaperY S8 } { PathRevolutions U8 } { PathSkew S8 } { ProfileBegin U16 }\n"
+		"		{ ProfileEnd U16 } { ProfileHollow U16 }\n"
+		"		{ TextureEntry Variable 2 } { TextureAnim Variable 1 } { NameValue Variable 2 }\n"
+		"		{ Data Variable 2 } { Text Variable 1 } { TextColor Fixed 4 } { MediaURL Variable 1 }\n"
+		"		{ PSBlock Variable 1 } { ExtraParams Variable 1 }\n"
+		"		{ Sound LLUUID } { OwnerID LLUUID } { Gain F32 } { Flags U8 } { Radius F32 }\n"
+		"		{ JointType U8 } { JointPivot LLVector3 } { JointAxisOrAnchor LLVector3 }\n"
+		"	}\n"
+		"}\n"
+		"{\n"
+		"	ImprovedTerseObjectUpdate High 15 Trusted Unencoded\n"
+		"	{ RegionData Single { RegionHandle U64 } { TimeDilation U16 } }\n"
+		"	{ ObjectData Variable { Data Variable 1 } { TextureEntry Variable 2 } }\n"
+		"}\n";
+
+	// What generate_message_fields.py emits for the fields read below.
+	namespace ObjectUpdate
+	{
+		namespace RegionData
+		{
+			const LLMessageField<MVT_U64> RegionHandle = { { "RegionData", "RegionHandle", 0, 0, NULL, NULL } };
+		}
+		namespace ObjectData
+		{
+			const LLMessageBlockField NumBlocks = { "ObjectData", 1, NULL };
+			const LLMessageField<MVT_U32> ID = { { "ObjectData", "ID", 1, 0, NULL, NULL } };
+			const LLMessageField<MVT_LLUUID> FullID = { { "ObjectData", "FullID", 1, 2, NULL, NULL } };
+			const LLMessageField<MVT_U32> CRC = { { "ObjectData", "CRC", 1, 3, NULL, NULL } };
+			const LLMessageField<MVT_U8> PCode = { { "ObjectData", "PCode", 1, 4, NULL, NULL } };
+			const LLMessageField<MVT_U8> Material = { { "ObjectData", "Material", 1, 5, NULL, NULL } };
+			const LLMessageField<MVT_LLVector3> Scale = { { "ObjectData", "Scale", 1, 7, NULL, NULL } };
+			const LLMessageField<MVT_U32> ParentID = { { "ObjectData", "ParentID", 1, 9, NULL, NULL } };
+			const LLMessageField<MVT_U32> UpdateFlags = { { "ObjectData", "UpdateFlags", 1, 10, NULL, NULL } };
+			const LLMessageBinaryField TextureEntry = { { "ObjectData", "TextureEntry", 1, 29, NULL, NULL } };
+			const LLMessageBinaryField Text = { { "ObjectData", "Text", 1, 33, NULL, NULL } };
+			const LLMessageBinaryField TextColor = { { "ObjectData", "TextColor", 1, 34, NULL, NULL } };
+			const LLMessageField<MVT_F32> Gain = { { "ObjectData", "Gain", 1, 40, NULL, NULL } };
+			// Deliberately stale position, to exercise the fallback.
+			const LLMessageField<MVT_U32> StaleCRC = { { "ObjectData", "CRC", 1, 4, NULL, NULL } };
+		}
+	}
+
+	const S32 BLOCKS_PER_PACKET = 6;
+	const S32 TE_SIZE = 180;
+
+	char* canon(const char* name)
+	{
+		return LLMessageStringTable::getInstance()->getString(name);
+	}
+
+	U32 object_id(S32 packet, S32 block)
+	{
+		return (U32)(packet * BLOCKS_PER_PACKET + block + 1);
+	}
+
+	struct DecodedObject
+	{
+		U32			mID;
+		LLUUID		mFullID;
+		U32			mCRC;
+		U8			mPCode;
+		U8			mMaterial;
+		LLVector3	mScale;
+		U32			mParentID;
+		U32			mFlags;
+		S32			mTESize;
+		U8			mTE[TE_SIZE];
+		std::string	mText;
+		U8			mTextColor[4];
+		F32			mGain;
+
+		bool operator==(const DecodedObject& other) const
+		{
+			return mID == other.mID && mFullID == other.mFullID && mCRC == other.mCRC
+				&& mPCode == other.mPCode && mMaterial == other.mMaterial
+				&& mScale == other.mScale && mParentID == other.mParentID
+				&& mFlags == other.mFlags && mTESize == other.mTESize
+				&& !memcmp(mTE, other.mTE, mTESize) && mText == other.mText
+				&& !memcmp(mTextColor, other.mTextColor, 4) && mGain == other.mGain;
+		}
+	};
+}
+
+namespace tut
+{
+	struct messagefield_data
+	{
+		LLTemplateMessageBuilder::message_template_name_map_t mNameMap;
+		LLTemplateMessageReader::message_template_number_map_t mNumberMap;
+		std::vector<LLMessageTemplate*> mTemplates;
+		std::vector<std::vector<U8> > mPackets;
+
+		messagefield_data()
+		{
+			LLTemplateTokenizer tokens(TEMPLATE);
+			LLTemplateParser parsed(tokens);
+			for (LLTemplateParser::message_iterator it = parsed.getMessagesBegin();
+				 it != parsed.getMessagesEnd(); ++it)
+			{
+				mTemplates.push_back(*it);
+				mNameMap[(*it)->mName] = *it;
+				mNumberMap[(*it)->mMessageNumber] = *it;
+			}
+		}
+
+		~messagefield_data()
+		{
+			for_each(mTemplates.begin(), mTemplates.end(), DeletePointer());
+		}
+
+		// A stream of full updates shaped like a busy region's: a few
+		// objects per packet, each with a texture entry and some with text.
+		void buildObjectUpdates(S32 count)
+		{
+			LLTemplateMessageBuilder builder(mNameMap);
+			U8 buffer[MAX_BUFFER_SIZE];
+			U8 te[TE_SIZE];
+
+			for (S32 p = 0; p < count; ++p)
+			{
+				builder.newMessage(canon("ObjectUpdate"));
+				builder.nextBlock(canon("RegionData"));
+				builder.addU64(canon("RegionHandle"), 0x0003e80000041a00ULL);
+				builder.addU16(canon("TimeDilation"), 65535);
+
+				for (S32 b = 0; b < BLOCKS_PER_PACKET; ++b)
+				{
+					U32 id = object_id(p, b);
+					LLUUID full_id;
+					full_id.generate();
+					for (S32 i = 0; i < TE_SIZE; ++i)
+					{
+						te[i] = (U8)(id + i);
+					}
+					U8 color[4] = { 255, (U8)id, 0, 10 };
+					std::string text = (id % 3) ? std::string() : llformat("Object %u", id);
+
+					builder.nextBlock(canon("ObjectData"));
+					builder.addU32(canon("ID"), id);
+					builder.addU8(canon("State"), 0);
+					builder.addUUID(canon("FullID"), full_id);
+					builder.addU32(canon("CRC"), id * 7);
+					builder.addU8(canon("PCode"), 9);
+					builder.addU8(canon("Material"), 3);
+					builder.addU8(canon("ClickAction"), 0);
+					builder.addVector3(canon("Scale"), LLVector3(0.5f, 1.f, (F32)b));
+					builder.addBinaryData(canon("ObjectData"), te, 60);
+					builder.addU32(canon("ParentID"), b ? id - 1 : 0);
+					builder.addU32(canon("UpdateFlags"), 0x10000000 | id);
+					builder.addU8(canon("PathCurve"), 16);
+					builder.addU8(canon("ProfileCurve"), 1);
+					builder.addU16(canon("PathBegin"), 0);
+					builder.addU16(canon("PathEnd"), 0);
+					builder.addU8(canon("PathScaleX"), 100);
+					builder.addU8(canon("PathScaleY"), 100);
+					builder.addU8(canon("PathShearX"), 0);
+					builder.addU8(canon("PathShearY"), 0);
+					builder.addS8(canon("PathTwist"), 0);
+					builder.addS8(canon("PathTwistBegin"), 0);
+					builder.addS8(canon("PathRadiusOffset"), 0);
+					builder.addS8(canon("PathTaperX"), 0);
+					builder.addS8(canon("PathTaperY"), 0);
+					builder.addU8(canon("PathRevolutions"), 0);
+					builder.addS8(canon("PathSkew"), 0);
+					builder.addU16(canon("ProfileBegin"), 0);
+					builder.addU16(canon("ProfileEnd"), 0);
+					builder.addU16(canon("ProfileHollow"), 0);
+					builder.addBinaryData(canon("TextureEntry"), te, TE_SIZE);
+					builder.addBinaryData(canon("TextureAnim"), NULL, 0);
+					builder.addBinaryData(canon("NameValue"), NULL, 0);
+					builder.addBinaryData(canon("Data"), NULL, 0);
+					builder.addString(canon("Text"), text);
+					builder.addBinaryData(canon("TextColor"), color, 4);
+					builder.addBinaryData(canon("MediaURL"), NULL, 0);
+					builder.addBinaryData(canon("PSBlock"), NULL, 0);
+					builder.addBinaryData(canon("ExtraParams"), NULL, 0);
+					builder.addUUID(canon("Sound"), LLUUID::null);
+					builder.addUUID(canon("OwnerID"), LLUUID::null);
+					builder.addF32(canon("Gain"), 0.5f);
+					builder.addU8(canon("Flags"), 0);
+					builder.addF32(canon("Radius"), 0.f);
+					builder.addU8(canon("JointType"), 0);
+					builder.addVector3(canon("JointPivot"), LLVector3::zero);
+					builder.addVector3(canon("JointAxisOrAnchor"), LLVector3::zero);
+				}
+
+				memset(buffer, 0, LL_PACKET_ID_SIZE);
+				U32 size = builder.buildMessage(buffer, MAX_BUFFER_SIZE, 0);
+				mPackets.push_back(std::vector<U8>(buffer, buffer + size));
+				builder.clearMessage();
+			}
+		}
+
+		// The reads LLViewerObjectList and LLViewerObject make for each
+		// object of a full update, through the named getters...
+		static void readNamed(LLTemplateMessageReader& reader, std::vector<DecodedObject>& out)
+		{
+			static char* _ObjectData = canon("ObjectData");
+			static char* _RegionData = canon("RegionData");
+			static char* _RegionHandle = canon("RegionHandle");
+			static char* _ID = canon("ID");
+			static char* _FullID = canon("FullID");
+			static char* _CRC = canon("CRC");
+			static char* _PCode = canon("PCode");
+			static char* _Material = canon("Material");
+			static char* _Scale = canon("Scale");
+			static char* _ParentID = canon("ParentID");
+			static char* _UpdateFlags = canon("UpdateFlags");
+			static char* _TextureEntry = canon("TextureEntry");
+			static char* _Text = canon("Text");
+			static char* _TextColor = canon("TextColor");
+			static char* _Gain = canon("Gain");
+
+			U64 region_handle;
+			reader.getU64(_RegionData, _RegionHandle, region_handle);
+			S32 count = reader.getNumberOfBlocks(_ObjectData);
+			for (S32 i = 0; i < count; ++i)
+			{
+				DecodedObject object;
+				reader.getU32(_ObjectData, _ID, object.mID, i);
+				reader.getUUID(_ObjectData, _FullID, object.mFullID, i);
+				reader.getU32(_ObjectData, _CRC, object.mCRC, i);
+				reader.getU8(_ObjectData, _PCode, object.mPCode, i);
+				reader.getU8(_ObjectData, _Material, object.mMaterial, i);
+				reader.getVector3(_ObjectData, _Scale, object.mScale, i);
+				reader.getU32(_ObjectData, _ParentID, object.mParentID, i);
+				reader.getU32(_ObjectData, _UpdateFlags, object.mFlags, i);
+				object.mTESize = reader.getSize(_ObjectData, i, _TextureEntry);
+				reader.getBinaryData(_ObjectData, _TextureEntry, object.mTE, 0, i, TE_SIZE);
+				if (reader.getSize(_ObjectData, i, _Text) > 1)
+				{
+					reader.getString(_ObjectData, _Text, object.mText, i);
+				}
+				reader.getBinaryData(_ObjectData, _TextColor, object.mTextColor, 4, i);
+				reader.getF32(_ObjectData, _Gain, object.mGain, i);
+				out.push_back(object);
+			}
+		}
+
+		// ...and through the accessors.
+		static void readIndexed(LLTemplateMessageReader& reader, std::vector<DecodedObject>& out)
+		{
+			namespace Fields = ObjectUpdate::ObjectData;
+
+			U64 region_handle;
+			ObjectUpdate::RegionData::RegionHandle.get(&reader, region_handle);
+			S32 count = Fields::NumBlocks.getNumberOfBlocks(&reader);
+			for (S32 i = 0; i < count; ++i)
+			{
+				DecodedObject object;
+				Fields::ID.get(&reader, object.mID, i);
+				Fields::FullID.get(&reader, object.mFullID, i);
+				Fields::CRC.get(&reader, object.mCRC, i);
+				Fields::PCode.get(&reader, object.mPCode, i);
+				Fields::Material.get(&reader, object.mMaterial, i);
+				Fields::Scale.get(&reader, object.mScale, i);
+				Fields::ParentID.get(&reader, object.mParentID, i);
+				Fields::UpdateFlags.get(&reader, object.mFlags, i);
+				object.mTESize = Fields::TextureEntry.getSize(&reader, i);
+				Fields::TextureEntry.get(&reader, object.mTE, 0, i, TE_SIZE);
+				if (Fields::Text.getSize(&reader, i) > 1)
+				{
+					Fields::Text.getString(&reader, object.mText, i);
+				}
+				Fields::TextColor.get(&reader, object.mTextColor, 4, i);
+				Fields::Gain.get(&reader, object.mGain, i);
+				out.push_back(object);
+			}
+		}
+	};
+	typedef test_group<messagefield_data> messagefield_test;
+	typedef messagefield_test::object messagefield_object;
+	tut::messagefield_test messagefield("LLMessageField");
+
+	template<> template<>
+	void messagefield_object::test<1>()
+	{
+		set_test_name("indexed reads match named reads");
+
+		buildObjectUpdates(8);
+		LLTemplateMessageReader reader(mNumberMap);
+		for (size_t p = 0; p < mPackets.size(); ++p)
+		{
+			ensure("decoded", reader.decodeMessage(&mPackets[p][0], mPackets[p].size(), LLHost()));
+
+			std::vector<DecodedObject> named, indexed;
+			readNamed(reader, named);
+			readIndexed(reader, indexed);
+			ensure_equals("block count", (S32)indexed.size(), BLOCKS_PER_PACKET);
+			ensure("same blocks", named == indexed);
+			ensure_equals("id", indexed[2].mID, object_id((S32)p, 2));
+			ensure_equals("te size", indexed[2].mTESize, TE_SIZE);
+		}
+	}
+
+	template<> template<>
+	void messagefield_object::test<2>()
+	{
+		set_test_name("mismatched positions fall back to the named lookup");
+
+		buildObjectUpdates(1);
+		LLTemplateMessageReader reader(mNumberMap);
+		ensure("decoded", reader.decodeMessage(&mPackets[0][0], mPackets[0].size(), LLHost()));
+
+		U32 crc = 0;
+		ObjectUpdate::ObjectData::StaleCRC.get(&reader, crc, 1);
+		ensure_equals("stale position", crc, object_id(0, 1) * 7);
+
+		U8 value = 0;
+		ensure("wrong variable at position",
+			   !reader.getIndexedData(1, 4, canon("ObjectData"), canon("CRC"), &value, 1, 0));
+		ensure("block out of range",
+			   !reader.getIndexedData(1, 0, canon("ObjectData"), canon("ID"), &crc, 4, BLOCKS_PER_PACKET));
+
+		// Same block name, different message: ObjectUpdate's accessor finds
+		// TextureEntry at another position in a terse update.
+		LLTemplateMessageBuilder builder(mNameMap);
+		U8 te[4] = { 1, 2, 3, 4 };
+		builder.newMessage(canon("ImprovedTerseObjectUpdate"));
+		builder.nextBlock(canon("RegionData"));
+		builder.addU64(canon("RegionHandle"), 1);
+		builder.addU16(canon("TimeDilation"), 0);
+		builder.nextBlock(canon("ObjectData"));
+		builder.addBinaryData(canon("Data"), te, 2);
+		builder.addBinaryData(canon("TextureEntry"), te, 4);
+		U8 buffer[MAX_BUFFER_SIZE];
+		memset(buffer, 0, LL_PACKET_ID_SIZE);
+		U32 size = builder.buildMessage(buffer, MAX_BUFFER_SIZE, 0);
+		ensure("terse decoded", reader.decodeMessage(buffer, size, LLHost()));
+		ensure_equals("terse te size", ObjectUpdate::ObjectData::TextureEntry.getSize(&reader, 0), 4);
+		ensure_equals("terse block count", ObjectUpdate::ObjectData::NumBlocks.getNumberOfBlocks(&reader), 1);
+	}
+
+	template<> template<>
+	void messagefield_object::test<3>()
+	{
+		set_test_name("ObjectUpdate decode benchmark");
+
+		const S32 NUM_PACKETS = 500;
+		const S32 PASSES = 20;
+		buildObjectUpdates(NUM_PACKETS);
+
+		LLTemplateMessageReader reader(mNumberMap);
+		std::vector<DecodedObject> objects;
+		objects.reserve(NUM_PACKETS * BLOCKS_PER_PACKET);
+
+		F64 named_time = 0.0;
+		F64 indexed_time = 0.0;
+		for (S32 pass = 0; pass < PASSES; ++pass)
+		{
+			// Alternate, so neither path always runs with a warm cache.
+			for (S32 path = 0; path < 2; ++path)
+			{
+				bool indexed = (path + pass) % 2 == 1;
+				objects.clear();
+				LLTimer timer;
+				for (S32 p = 0; p < NUM_PACKETS; ++p)
+				{
+					reader.decodeMessage(&mPackets[p][0], mPackets[p].size(), LLHost());
+					if (indexed)
+					{
+						readIndexed(reader, objects);
+					}
+					else
+					{
+						readNamed(reader, objects);
+					}
+				}
+				(indexed ? indexed_time : named_time) += timer.getElapsedTimeF64();
+				ensure_equals("objects read", (S32)objects.size(), NUM_PACKETS * BLOCKS_PER_PACKET);
+			}
+		}
+
+		LL_INFOS() << "Decoding " << NUM_PACKETS * PASSES << " ObjectUpdate packets of "
+				   << BLOCKS_PER_PACKET << " objects: named getters " << named_time
+				   << "s, indexed accessors " << indexed_time << "s" << LL_ENDL;
+	}
+}
@@ -0,0 +1,292 @@
+/**
+ * @file llpacketack_test.cpp
+ * @brief Tests for the reliable packet ring and received packet id window
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llpacketack.h"
+
+#include "../llcircuit.h"
+#include "../message.h"
+#include "lltimer.h"
+
+#include "../test/lltut.h"
+
+namespace
+{
+	LLReliablePacket* make_packet(TPACKETID id, S32 size = 64)
+	{
+		std::vector<U8> buffer(size, 0);
+		U32 net_id = htonl(id);
+		memcpy(&buffer[PHL_PACKET_ID], &net_id, sizeof(net_id));
+		LLReliablePacketParams params;
+		params.mRetries = 3;
+		return new LLReliablePacket(-1, &buffer[0], size, &params);
+	}
+
+	// Ids the ring walks through, in order
+	std::vector<TPACKETID> walk(const LLReliablePacketRing& ring)
+	{
+		std::vector<TPACKETID> ids;
+		LLReliablePacketRing::Cursor cursor;
+		for (LLReliablePacket* packetp = ring.first(cursor); packetp; packetp = ring.next(cursor))
+		{
+			ids.push_back(packetp->getPacketID());
+		}
+		return ids;
+	}
+}
+
+namespace tut
+{
+	struct packetack_data
+	{
+		~packetack_data()
+		{
+			LLReliablePacket::cleanupPool();
+		}
+
+		void release(LLReliablePacketRing& ring)
+		{
+			LLReliablePacketRing::Cursor cursor;
+			for (LLReliablePacket* packetp = ring.first(cursor); packetp; packetp = ring.next(cursor))
+			{
+				ring.remove(packetp->getPacketID());
+				delete packetp;
+			}
+		}
+	};
+	typedef test_group<packetack_data> packetack_test;
+	typedef packetack_test::object packetack_object;
+	tut::packetack_test packetack("LLPacketAck");
+
+	template<> template<>
+	void packetack_object::test<1>()
+	{
+		set_test_name("ring insert, find, remove and grow");
+
+		LLReliablePacketRing ring;
+		ensure("starts empty", ring.isEmpty());
+
+		// Well past the initial capacity, so the ring has to grow.
+		for (TPACKETID id = 1; id <= 1000; ++id)
+		{
+			ring.insert(make_packet(id));
+		}
+		ensure_equals("count", ring.getCount(), 1000);
+		ensure("find first", ring.find(1) != NULL);
+		ensure("find last", ring.find(1000) != NULL);
+		ensure("not found", ring.find(1001) == NULL);
+
+		// Acks out of order
+		for (TPACKETID id = 2; id <= 1000; id += 2)
+		{
+			LLReliablePacket* packetp = ring.remove(id);
+			ensure("removed", packetp && packetp->getPacketID() == id);
+			delete packetp;
+		}
+		ensure("removed twice", ring.remove(2) == NULL);
+		ensure_equals("count after removal", ring.getCount(), 500);
+
+		TPACKETID oldest = 0;
+		ensure("has oldest", ring.getOldestID(1001, oldest));
+		ensure_equals("oldest", oldest, 1U);
+		delete ring.remove(1);
+		ensure("still has oldest", ring.getOldestID(1001, oldest));
+		ensure_equals("oldest after ack", oldest, 3U);
+
+		std::vector<TPACKETID> ids = walk(ring);
+		ensure_equals("walk count", (U32)ids.size(), 499U);
+		ensure_equals("walk first", ids.front(), 3U);
+		ensure_equals("walk last", ids.back(), 999U);
+
+		release(ring);
+		ensure("released", ring.isEmpty());
+	}
+
+	template<> template<>
+	void packetack_object::test<2>()
+	{
+		set_test_name("ring across an id wrap");
+
+		LLReliablePacketRing ring;
+		TPACKETID id = LL_MAX_OUT_PACKET_ID - 3;
+		for (S32 i = 0; i < 8; ++i)
+		{
+			ring.insert(make_packet(id));
+			id = (id + 1) % LL_MAX_OUT_PACKET_ID;
+		}
+
+		std::vector<TPACKETID> ids = walk(ring);
+		ensure_equals("walk count", (U32)ids.size(), 8U);
+		ensure_equals("oldest first", ids[0], LL_MAX_OUT_PACKET_ID - 3);
+		ensure_equals("wrapped", ids[3], 0U);
+		ensure_equals("newest last", ids[7], 4U);
+
+		TPACKETID oldest = 0;
+		ensure("has oldest", ring.getOldestID(4, oldest));
+		ensure_equals("oldest before wrap", oldest, LL_MAX_OUT_PACKET_ID - 3);
+
+		release(ring);
+	}
+
+	template<> template<>
+	void packetack_object::test<3>()
+	{
+		set_test_name("ring removal while walking and overflow");
+
+		LLReliablePacketRing ring;
+		for (TPACKETID id = 100; id < 200; ++id)
+		{
+			ring.insert(make_packet(id));
+		}
+		// Far outside any window the ring will hold
+		ring.insert(make_packet(5000000));
+		ensure_equals("count with overflow", ring.getCount(), 101);
+		ensure("overflow found", ring.find(5000000) != NULL);
+
+		// Remove every other packet as it is walked, as the resend loop does.
+		S32 seen = 0;
+		LLReliablePacketRing::Cursor cursor;
+		for (LLReliablePacket* packetp = ring.first(cursor); packetp; packetp = ring.next(cursor))
+		{
+			++seen;
+			if (seen % 2)
+			{
+				ring.remove(packetp->getPacketID());
+				delete packetp;
+			}
+		}
+		ensure_equals("walked all", seen, 101);
+		ensure_equals("half left", ring.getCount(), 50);
+		ensure("overflow removed", ring.find(5000000) == NULL);
+
+		release(ring);
+	}
+
+	template<> template<>
+	void packetack_object::test<4>()
+	{
+		set_test_name("packet pool");
+
+		LLReliablePacket* small = make_packet(1, 100);
+		LLReliablePacket* large = make_packet(2, LL_RELIABLE_INLINE_BUFFER_SIZE + 100);
+		ensure_equals("small id", small->getPacketID(), 1U);
+		ensure_equals("large id", large->getPacketID(), 2U);
+		delete small;
+		delete large;
+
+		// Freed packets are reused
+		LLReliablePacket* recycled = make_packet(3);
+		ensure("recycled", recycled == large || recycled == small);
+		delete recycled;
+	}
+
+	template<> template<>
+	void packetack_object::test<5>()
+	{
+		set_test_name("id window");
+
+		LLPacketIDWindow window;
+		ensure("empty", !window.contains(0));
+
+		for (TPACKETID id = 10; id < 3000; id += 3)
+		{
+			window.insert(id);
+		}
+		ensure("contains", window.contains(13));
+		ensure("not contains", !window.contains(14));
+		ensure("contains last", window.contains(2998));
+
+		// Late arrival from before the window
+		window.insert(5);
+		ensure("late arrival", window.contains(5));
+
+		window.clearBefore(1000);
+		ensure("cleared", !window.contains(13) && !window.contains(5));
+		ensure("kept", window.contains(1000));
+
+		// Across an id wrap
+		window.clear();
+		window.insert(LL_MAX_OUT_PACKET_ID - 2);
+		window.insert(1);
+		ensure("before wrap", window.contains(LL_MAX_OUT_PACKET_ID - 2));
+		ensure("after wrap", window.contains(1));
+		ensure("gap", !window.contains(0));
+		window.clearBefore(0);
+		ensure("cleared before wrap", !window.contains(LL_MAX_OUT_PACKET_ID - 2));
+		ensure("kept after wrap", window.contains(1));
+
+		// A jump far ahead slides the window rather than growing it forever
+		window.insert(1000000);
+		ensure("jump", window.contains(1000000));
+		ensure("slid past", !window.contains(1));
+		ensure_equals("count", window.getCount(), 1);
+	}
+
+	template<> template<>
+	void packetack_object::test<6>()
+	{
+		set_test_name("ring throughput");
+
+		// A busy circuit: a few hundred packets in flight, acked a frame
+		// behind in a different order than they were sent.
+		const S32 NUM_PACKETS = 1000000;
+		const S32 IN_FLIGHT = 400;
+		LLReliablePacketRing ring;
+		LLPacketIDWindow window;
+		std::vector<U8> buffer(200, 0);
+		LLReliablePacketParams params;
+		params.mRetries = 3;
+
+		LLTimer timer;
+		TPACKETID next_id = LL_MAX_OUT_PACKET_ID - NUM_PACKETS / 2;
+		TPACKETID next_ack = next_id;
+		for (S32 i = 0; i < NUM_PACKETS; ++i)
+		{
+			U32 net_id = htonl(next_id);
+			memcpy(&buffer[PHL_PACKET_ID], &net_id, sizeof(net_id));
+			ring.insert(new LLReliablePacket(-1, &buffer[0], (S32)buffer.size(), &params));
+			window.insert(next_id);
+			next_id = (next_id + 1) % LL_MAX_OUT_PACKET_ID;
+
+			if (ring.getCount() > IN_FLIGHT)
+			{
+				// Ack a pair in reverse
+				TPACKETID second = (next_ack + 1) % LL_MAX_OUT_PACKET_ID;
+				delete ring.remove(second);
+				delete ring.remove(next_ack);
+				next_ack = (second + 1) % LL_MAX_OUT_PACKET_ID;
+				window.clearBefore((next_ack - IN_FLIGHT) % LL_MAX_OUT_PACKET_ID);
+			}
+		}
+		F32 elapsed = timer.getElapsedTimeF32();
+		LL_INFOS() << "Tracked " << NUM_PACKETS << " reliable packets in " << elapsed << "s" << LL_ENDL;
+
+		ensure("bounded in flight", ring.getCount() <= IN_FLIGHT + 1);
+		ensure("recent id seen", window.contains((next_id - 1) % LL_MAX_OUT_PACKET_ID));
+		release(ring);
+	}
+}
@@ -0,0 +1,224 @@
+/**
+ * @file llpacketreceivethread_test.cpp
+ * @brief LLPacketReceiveThread decoding and loopback load tests
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llpacketreceivethread.h"
+
+#include "../message.h"
+#include "../net.h"
+#include "lltimer.h"
+#include "lltracethreadrecorder.h"
+
+#include "../test/lltut.h"
+
+namespace
+{
+	// Builds a zero-coded packet: header, then a message body of
+	// zero_count zeroes followed by payload, then acks.
+	S32 build_packet(U8* buffer, TPACKETID id, S32 zero_count, U8 payload, const std::vector<TPACKETID>& acks)
+	{
+		S32 size = 0;
+		buffer[size++] = LL_ZERO_CODE_FLAG | (acks.empty() ? 0 : LL_ACK_FLAG);
+		U32 net_id = htonl(id);
+		memcpy(&buffer[size], &net_id, sizeof(net_id));
+		size += sizeof(net_id);
+		buffer[size++] = 0;				// offset
+
+		while (zero_count > 0)
+		{
+			S32 run = llmin(zero_count, 255);
+			buffer[size++] = 0;
+			buffer[size++] = (U8)run;
+			zero_count -= run;
+		}
+		buffer[size++] = payload;
+
+		for (S32 i = 0; i < (S32)acks.size(); ++i)
+		{
+			U32 net_ack = htonl(acks[i]);
+			memcpy(&buffer[size], &net_ack, sizeof(net_ack));
+			size += sizeof(net_ack);
+		}
+		if (!acks.empty())
+		{
+			buffer[size++] = (U8)acks.size();
+		}
+		return size;
+	}
+}
+
+namespace tut
+{
+	struct packetreceive_data
+	{
+		packetreceive_data()
+		{
+			// LLThread hooks each thread's recorder up to the master one.
+			if (!LLTrace::get_master_thread_recorder())
+			{
+				LLTrace::set_master_thread_recorder(new LLTrace::ThreadRecorder());
+			}
+		}
+	};
+	typedef test_group<packetreceive_data> packetreceive_test;
+	typedef packetreceive_test::object packetreceive_object;
+	tut::packetreceive_test packetreceive("LLPacketReceiveThread");
+
+	template<> template<>
+	void packetreceive_object::test<1>()
+	{
+		set_test_name("zero_code_expand");
+
+		U8 in[] = { LL_ZERO_CODE_FLAG | LL_RELIABLE_FLAG, 0, 0, 0, 7, 0, 0xff, 1, 0, 3, 2 };
+		U8 out[64];
+		S32 size = zero_code_expand(in, sizeof(in), out, sizeof(out));
+		ensure_equals("expanded size", size, 6 + 1 + 1 + 3 + 1);
+		ensure_equals("flag cleared", out[0], LL_RELIABLE_FLAG);
+		ensure_equals("payload before run", out[7], 1);
+		ensure("zero run", out[8] == 0 && out[9] == 0 && out[10] == 0);
+		ensure_equals("payload after run", out[11], 2);
+
+		ensure_equals("overflow detected", zero_code_expand(in, sizeof(in), out, 10), -1);
+	}
+
+	template<> template<>
+	void packetreceive_object::test<2>()
+	{
+		set_test_name("decodePacket splits acks and expands");
+
+		std::vector<TPACKETID> acks;
+		acks.push_back(17);
+		acks.push_back(0x00abcdef);
+
+		LLPacketReceiveThread::Packet packet;
+		packet.mTrueSize = build_packet(packet.mRaw, 42, 600, 0x5a, acks);
+		LLPacketReceiveThread::decodePacket(packet);
+
+		ensure_equals("status", packet.mStatus, LLPacketReceiveThread::PACKET_OK);
+		ensure_equals("ack count", packet.mNumAcks, 2);
+		// Last appended first, as checkMessages() always acked them.
+		ensure_equals("first ack", packet.mAcks[0], 0x00abcdefU);
+		ensure_equals("second ack", packet.mAcks[1], 17U);
+		ensure("zero-coded", packet.mCompressedSize > 0);
+		ensure_equals("expanded size", packet.mSize, 6 + 600 + 1);
+		ensure_equals("payload", packet.getData()[packet.mSize - 1], 0x5a);
+
+		// Ack count claiming more ids than the packet holds
+		packet.mTrueSize = build_packet(packet.mRaw, 43, 0, 1, acks);
+		packet.mRaw[packet.mTrueSize - 1] = 200;
+		LLPacketReceiveThread::decodePacket(packet);
+		ensure_equals("bad acks", packet.mStatus, LLPacketReceiveThread::PACKET_BAD_ACKS);
+
+		packet.mTrueSize = 3;
+		LLPacketReceiveThread::decodePacket(packet);
+		ensure_equals("too short", packet.mStatus, LLPacketReceiveThread::PACKET_TOO_SHORT);
+	}
+
+	template<> template<>
+	void packetreceive_object::test<3>()
+	{
+		set_test_name("loopback flood");
+
+		S32 recv_socket = -1;
+		S32 send_socket = -1;
+		int recv_port = NET_USE_OS_ASSIGNED_PORT;
+		int send_port = NET_USE_OS_ASSIGNED_PORT;
+		ensure_equals("receive socket", start_net(recv_socket, recv_port), 0);
+		ensure_equals("send socket", start_net(send_socket, send_port), 0);
+
+		const U32 NUM_PACKETS = 50000;
+		const U32 loopback = ip_string_to_u32(LOOPBACK_ADDRESS_STRING);
+
+		LLPacketReceiveThread thread(recv_socket, 256);
+		thread.start();
+
+		std::vector<TPACKETID> acks;
+		acks.push_back(1);
+		U8 buffer[NET_BUFFER_SIZE];
+
+		U32 received = 0;
+		TPACKETID last_id = 0;
+		bool in_order = true;
+		bool intact = true;
+
+		LLTimer timer;
+		for (U32 sent = 1; sent <= NUM_PACKETS; ++sent)
+		{
+			acks[0] = sent;
+			S32 size = build_packet(buffer, sent, (S32)(sent % 700), (U8)sent, acks);
+			send_packet(send_socket, (char*)buffer, size, loopback, recv_port);
+
+			// Consume in bursts, as a frame would, not after every send.
+			if (sent % 1000 == 0)
+			{
+				while (const LLPacketReceiveThread::Packet* packet = thread.front())
+				{
+					TPACKETID id = ntohl(*(U32*)&packet->getData()[1]);
+					in_order = in_order && id > last_id;
+					intact = intact && packet->mStatus == LLPacketReceiveThread::PACKET_OK
+						&& packet->mNumAcks == 1 && packet->mAcks[0] == id
+						&& packet->mSize == 6 + (S32)(id % 700) + 1
+						&& packet->getData()[packet->mSize - 1] == (U8)id;
+					last_id = id;
+					++received;
+					thread.pop();
+				}
+			}
+		}
+
+		// Drain whatever is left
+		LLTimer drain_timer;
+		while (received < NUM_PACKETS && drain_timer.getElapsedTimeF32() < 2.f)
+		{
+			const LLPacketReceiveThread::Packet* packet = thread.front();
+			if (!packet)
+			{
+				ms_sleep(1);
+				continue;
+			}
+			TPACKETID id = ntohl(*(U32*)&packet->getData()[1]);
+			in_order = in_order && id > last_id;
+			last_id = id;
+			++received;
+			thread.pop();
+		}
+		F32 elapsed = timer.getElapsedTimeF32();
+
+		thread.shutdown();
+		end_net(recv_socket);
+		end_net(send_socket);
+
+		LL_INFOS() << "Loopback flood: " << received << "/" << NUM_PACKETS << " packets in "
+				   << elapsed << "s, ring stalled " << thread.getStallCount() << " times" << LL_ENDL;
+
+		ensure("packets decoded intact", intact);
+		ensure("packets in order", in_order);
+		// The kernel may still drop some under a flood; the ring must not
+		// lose a meaningful share.
+		ensure("most packets received", received >= NUM_PACKETS * 9 / 10);
+	}
+}
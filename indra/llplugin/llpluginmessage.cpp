@@ -353,13 +353,20 @@ void* LLPluginMessage::getValuePointer(const std::string &key) const
  *
  * @return Message as a string.
  */
-std::string LLPluginMessage::generate(void) const
+std::string LLPluginMessage::generate(EFormat format) const
 {
 	std::ostringstream result;
 	
-	// Pretty XML may be slightly easier to deal with while debugging...
-//	LLSDSerialize::toXML(mMessage, result);
-	LLSDSerialize::toPrettyXML(mMessage, result);
+	if(format == FORMAT_BINARY)
+	{
+		LLSDSerialize::toBinary(mMessage, result);
+	}
+	else
+	{
+		// Pretty XML may be slightly easier to deal with while debugging...
+//		LLSDSerialize::toXML(mMessage, result);
+		LLSDSerialize::toPrettyXML(mMessage, result);
+	}
 	
 	return result.str();
 }
@@ -376,7 +383,16 @@ int LLPluginMessage::parse(const std::string &message)
 
 	std::istringstream input(message);
 	
-	S32 parse_result = LLSDSerialize::fromXML(mMessage, input);
+	S32 parse_result;
+	// A message is always a map, which binary LLSD opens with '{'.  XML can't start that way.
+	if(!message.empty() && message[0] == '{')
+	{
+		parse_result = LLSDSerialize::fromBinary(mMessage, input, (S32)message.size());
+	}
+	else
+	{
+		parse_result = LLSDSerialize::fromXML(mMessage, input);
+	}
 	
 	return (int)parse_result;
 }
@@ -85,11 +85,21 @@ public:
 	// get the value of a key as a pointer.
 	void* getValuePointer(const std::string &key) const;
 
+	// Wire formats for generate().  Binary LLSD is much cheaper to write and parse than pretty-printed XML,
+	// but older plugin hosts only understand XML, so it's only used on connections where the plugin process
+	// has agreed to it during the handshake.  Messages passed to a plugin in-process are always XML.
+	enum EFormat
+	{
+		FORMAT_XML,
+		FORMAT_BINARY
+	};
+
 	// Flatten the message into a string
-	std::string generate(void) const;
+	std::string generate(EFormat format = FORMAT_XML) const;
 
 	// Parse an incoming message into component parts
 	// (this clears out all existing state before starting the parse)
+	// Either format is accepted.
 	// Returns -1 on failure, otherwise returns the number of key/value pairs in the message.
 	int parse(const std::string &message);
 	
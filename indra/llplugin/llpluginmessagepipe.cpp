@@ -35,6 +35,12 @@
 
 static const char MESSAGE_DELIMITER = '\0';
 
+// Messages that contain the delimiter (binary LLSD) are sent as a marker byte and a 32 bit big-endian length
+// followed by the message.  Neither XML nor binary LLSD messages can start with the marker, so the two
+// framings can be mixed on the same pipe.
+static const char FRAME_MARKER = '\x01';
+static const std::string::size_type FRAME_HEADER_SIZE = 5;
+
 LLPluginMessagePipeOwner::LLPluginMessagePipeOwner() :
 	mMessagePipe(NULL),
 	mSocketError(APR_SUCCESS)
@@ -121,8 +127,21 @@ bool LLPluginMessagePipe::addMessage(const std::string &message)
 		mOutputStartIndex = 0;
 	}
 		
-	mOutput += message;
-	mOutput += MESSAGE_DELIMITER;	// message separator
+	if(message.find(MESSAGE_DELIMITER) == std::string::npos)
+	{
+		mOutput += message;
+		mOutput += MESSAGE_DELIMITER;	// message separator
+	}
+	else
+	{
+		U32 length = (U32)message.size();
+		mOutput += FRAME_MARKER;
+		mOutput += (char)((length >> 24) & 0xFF);
+		mOutput += (char)((length >> 16) & 0xFF);
+		mOutput += (char)((length >> 8) & 0xFF);
+		mOutput += (char)(length & 0xFF);
+		mOutput += message;
+	}
 	
 	return true;
 }
@@ -177,8 +196,9 @@ bool LLPluginMessagePipe::pumpOutput()
 		
 		LLMutexLock lock(&mOutputMutex);
 
+		// Framed messages can contain nulls, so go by the size of what's left rather than its first byte.
 		const char * output_data = &(mOutput.data()[mOutputStartIndex]);
-		if(*output_data != '\0')
+		if(mOutputStartIndex < mOutput.size())
 		{
 			// write any outgoing messages
 			in_size = (apr_size_t) (mOutput.size() - mOutputStartIndex);
@@ -370,19 +390,48 @@ bool LLPluginMessagePipe::pumpInput(F64 timeout)
 
 void LLPluginMessagePipe::processInput(void)
 {
-	// Look for input delimiter(s) in the input buffer.
-	int delim;
+	// Look for complete messages in the input buffer.
 	mInputMutex.lock();
-	while((delim = mInput.find(MESSAGE_DELIMITER)) != std::string::npos)
-	{	
+	while(!mInput.empty())
+	{
+		std::string::size_type start, length, consumed;
+		if(mInput[0] == FRAME_MARKER)
+		{
+			if(mInput.size() < FRAME_HEADER_SIZE)
+			{
+				break;
+			}
+			length = ((std::string::size_type)(U8)mInput[1] << 24) |
+					 ((std::string::size_type)(U8)mInput[2] << 16) |
+					 ((std::string::size_type)(U8)mInput[3] << 8) |
+					 (std::string::size_type)(U8)mInput[4];
+			start = FRAME_HEADER_SIZE;
+			consumed = FRAME_HEADER_SIZE + length;
+			if(mInput.size() < consumed)
+			{
+				break;
+			}
+		}
+		else
+		{
+			std::string::size_type delim = mInput.find(MESSAGE_DELIMITER);
+			if(delim == std::string::npos)
+			{
+				break;
+			}
+			start = 0;
+			length = delim;
+			consumed = delim + 1;
+		}
+
 		// Let the owner process this message
 		if (mOwner)
 		{
 			// Pull the message out of the input buffer before calling receiveMessageRaw.
 			// It's now possible for this function to get called recursively (in the case where the plugin makes a blocking request)
 			// and this guarantees that the messages will get dequeued correctly.
-			std::string message(mInput, 0, delim);
-			mInput.erase(0, delim + 1);
+			std::string message(mInput, start, length);
+			mInput.erase(0, consumed);
 			mInputMutex.unlock();
 			mOwner->receiveMessageRaw(message);
 			mInputMutex.lock();
@@ -390,6 +439,7 @@ void LLPluginMessagePipe::processInput(void)
 		else
 		{
 			LL_WARNS("Plugin") << "!mOwner" << LL_ENDL;
+			break;
 		}
 	}
 	mInputMutex.unlock();
@@ -46,6 +46,7 @@ LLPluginProcessChild::LLPluginProcessChild()
 	mCPUElapsed = 0.0f;
 	mBlockingRequest = false;
 	mBlockingResponseReceived = false;
+	mBinaryMessages = false;
 }
 
 LLPluginProcessChild::~LLPluginProcessChild()
@@ -132,7 +133,12 @@ void LLPluginProcessChild::idle(void)
 			break;
 			
 			case STATE_CONNECTED:
-				sendMessageToParent(LLPluginMessage(LLPLUGIN_MESSAGE_CLASS_INTERNAL, "hello"));
+				{
+					// Let the parent know we can take binary messages.  A parent that can't will ignore this.
+					LLPluginMessage hello(LLPLUGIN_MESSAGE_CLASS_INTERNAL, "hello");
+					hello.setValueBoolean("binary_messages", true);
+					sendMessageToParent(hello);
+				}
 				setState(STATE_PLUGIN_LOADING);
 			break;
 						
@@ -311,9 +317,9 @@ void LLPluginProcessChild::sendMessageToPlugin(const LLPluginMessage &message)
 
 void LLPluginProcessChild::sendMessageToParent(const LLPluginMessage &message)
 {
-	std::string buffer = message.generate();
+	std::string buffer = message.generate(mBinaryMessages ? LLPluginMessage::FORMAT_BINARY : LLPluginMessage::FORMAT_XML);
 
-	LL_DEBUGS("Plugin") << "Sending to parent: " << buffer << LL_ENDL;
+	LL_DEBUGS("Plugin") << "Sending to parent: " << message.generate() << LL_ENDL;
 
 	writeMessageRaw(buffer);
 }
@@ -322,12 +328,12 @@ void LLPluginProcessChild::receiveMessageRaw(const std::string &message)
 {
 	// Incoming message from the TCP Socket
 
-	LL_DEBUGS("Plugin") << "Received from parent: " << message << LL_ENDL;
-
 	// Decode this message
 	LLPluginMessage parsed;
 	parsed.parse(message);
 
+	LL_DEBUGS("Plugin") << "Received from parent: " << parsed.generate() << LL_ENDL;
+
 	if(mBlockingRequest)
 	{
 		// We're blocking the plugin waiting for a response.
@@ -360,6 +366,9 @@ void LLPluginProcessChild::receiveMessageRaw(const std::string &message)
 			{
 				mPluginFile = parsed.getValue("file");
 				mPluginDir = parsed.getValue("dir");
+
+				// Everything the parent sends after this may be binary, and it wants the same from us.
+				mBinaryMessages = parsed.hasValue("binary_messages") && parsed.getValueBoolean("binary_messages");
 			}
             else if (message_name == "shutdown_plugin")
             {
@@ -452,7 +461,8 @@ void LLPluginProcessChild::receiveMessageRaw(const std::string &message)
 	{
 		LLTimer elapsed;
 
-		mInstance->sendMessage(message);
+		// Plugins only take XML.
+		mInstance->sendMessage(mBinaryMessages ? parsed.generate() : message);
 
 		mCPUElapsed += elapsed.getElapsedTimeF64();
 	}
@@ -474,12 +484,12 @@ void LLPluginProcessChild::receivePluginMessage(const std::string &message)
 
 	// FIXME: how should we handle queueing here?
 	
+	// Decode this message
+	LLPluginMessage parsed;
+	parsed.parse(message);
+
 	// Intercept certain base messages (responses to ones sent by this class)
 	{
-		// Decode this message
-		LLPluginMessage parsed;
-		parsed.parse(message);
-		
 		if(parsed.hasValue("blocking_request"))
 		{
 			mBlockingRequest = true;
@@ -545,7 +555,15 @@ void LLPluginProcessChild::receivePluginMessage(const std::string &message)
 	if(passMessage)
 	{
 		LL_DEBUGS("Plugin") << "Passing through to parent: " << message << LL_ENDL;
-		writeMessageRaw(message);
+		if(mBinaryMessages)
+		{
+			// It's already been parsed, so this saves the parent from parsing the XML.
+			writeMessageRaw(parsed.generate(LLPluginMessage::FORMAT_BINARY));
+		}
+		else
+		{
+			writeMessageRaw(message);
+		}
 	}
 	
 	while(mBlockingRequest)
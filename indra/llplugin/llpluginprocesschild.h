@@ -106,6 +106,7 @@ private:
     F64		mCPUElapsed;
 	bool	mBlockingRequest;
 	bool	mBlockingResponseReceived;
+	bool	mBinaryMessages;	// the parent asked for binary LLSD in load_plugin
 	std::queue<std::string> mMessageQueue;
     LLTimer mWaitGoodbye;
 	void deliverQueuedMessages();
@@ -43,6 +43,7 @@ LLPluginProcessParentOwner::~LLPluginProcessParentOwner()
 }
 
 bool LLPluginProcessParent::sUseReadThread = false;
+bool LLPluginProcessParent::sUseBinaryMessages = true;
 apr_pollset_t *LLPluginProcessParent::sPollSet = NULL;
 bool LLPluginProcessParent::sPollsetNeedsRebuild = false;
 LLMutex *LLPluginProcessParent::sInstancesMutex;
@@ -96,6 +97,8 @@ LLPluginProcessParent::LLPluginProcessParent(LLPluginProcessParentOwner *owner):
 	mDebug = false;
 	mBlocked = false;
 	mPolledInput = false;
+	mPluginBinaryMessages = false;
+	mBinaryMessages = false;
 	mPollFD.client_data = NULL;
 
 	mPluginLaunchTimeout = 60.0f;
@@ -254,6 +257,8 @@ void LLPluginProcessParent::init(const std::string &launcher_filename, const std
 	mPluginDir = plugin_dir;
 	mCPUUsage = 0.0f;
 	mDebug = debug;	
+	mPluginBinaryMessages = false;
+	mBinaryMessages = false;
 	setState(STATE_INITIALIZED);
 }
 
@@ -534,7 +539,15 @@ void LLPluginProcessParent::idle(void)
 					LLPluginMessage message(LLPLUGIN_MESSAGE_CLASS_INTERNAL, "load_plugin");
 					message.setValue("file", mPluginFile);
 					message.setValue("dir", mPluginDir);
+					bool binary_messages = mPluginBinaryMessages && sUseBinaryMessages;
+					if(binary_messages)
+					{
+						message.setValueBoolean("binary_messages", true);
+					}
 					sendMessage(message);
+
+					// This message goes out as XML; both directions switch to binary after it.
+					mBinaryMessages = binary_messages;
 				}
 
 				setState(STATE_LOADING);
@@ -667,8 +680,8 @@ void LLPluginProcessParent::sendMessage(const LLPluginMessage &message)
 		mHeartbeat.setTimerExpirySec(mPluginLockupTimeout);
 	}
 	
-	std::string buffer = message.generate();
-	LL_DEBUGS("Plugin") << "Sending: " << buffer << LL_ENDL;	
+	std::string buffer = message.generate(mBinaryMessages ? LLPluginMessage::FORMAT_BINARY : LLPluginMessage::FORMAT_XML);
+	LL_DEBUGS("Plugin") << "Sending: " << message.generate() << LL_ENDL;	
 	writeMessageRaw(buffer);
 	
 	// Try to send message immediately.
@@ -920,11 +933,11 @@ void LLPluginProcessParent::servicePoll()
 
 void LLPluginProcessParent::receiveMessageRaw(const std::string &message)
 {
-	LL_DEBUGS("Plugin") << "Received: " << message << LL_ENDL;
-	
 	LLPluginMessage parsed;
 	if(LLSDParser::PARSE_FAILURE != parsed.parse(message))
 	{
+		LL_DEBUGS("Plugin") << "Received: " << parsed.generate() << LL_ENDL;
+
 		if(parsed.hasValue("blocking_request"))
 		{
 			mBlocked = true;
@@ -941,6 +954,10 @@ void LLPluginProcessParent::receiveMessageRaw(const std::string &message)
 			receiveMessage(parsed);
 		}
 	}
+	else
+	{
+		LL_DEBUGS("Plugin") << "Failed to parse: " << message << LL_ENDL;
+	}
 }
 
 void LLPluginProcessParent::receiveMessageEarly(const LLPluginMessage &message)
@@ -983,6 +1000,7 @@ void LLPluginProcessParent::receiveMessage(const LLPluginMessage &message)
 			if(mState == STATE_CONNECTED)
 			{
 				// Plugin host has launched.  Tell it which plugin to load.
+				mPluginBinaryMessages = message.hasValue("binary_messages") && message.getValueBoolean("binary_messages");
 				setState(STATE_HELLO);
 			}
 			else
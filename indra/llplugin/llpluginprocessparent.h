@@ -129,6 +129,8 @@ public:
 	static bool canPollThreadRun() { return (sPollSet || sPollsetNeedsRebuild || sUseReadThread); };
 	static void setUseReadThread(bool use_read_thread);
 	static bool getUseReadThread() { return sUseReadThread; };
+	// Whether to offer binary LLSD to plugin processes that support it.  Only affects plugins launched afterwards.
+	static void setUseBinaryMessages(bool use_binary_messages) { sUseBinaryMessages = use_binary_messages; };
 
     static void shutdown();
 private:
@@ -189,6 +191,8 @@ private:
 	bool mDebug;
 	bool mBlocked;
 	bool mPolledInput;
+	bool mPluginBinaryMessages;	// the plugin process said it can take binary messages
+	bool mBinaryMessages;		// messages to the plugin process are sent as binary
 
 	LLProcessPtr mDebugger;
 	
@@ -196,6 +200,7 @@ private:
 	F32 mPluginLockupTimeout;		// If we don't receive a heartbeat in this many seconds, we declare the plugin locked up.
 
 	static bool sUseReadThread;
+	static bool sUseBinaryMessages;
 	apr_pollfd_t mPollFD;
 	static apr_pollset_t *sPollSet;
 	static bool sPollsetNeedsRebuild;
@@ -53,6 +53,7 @@
 #pragma warning (default : 4264)
 #endif
 
+#include <boost/bind.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/regex.hpp>
 #include <boost/algorithm/string/replace.hpp>
@@ -62,6 +63,7 @@
 #include "lljoint.h"
 
 #include "llmatrix4a.h"
+#include "llworkerpool.h"
 
 std::string colladaVersion[VERSIONTYPE_COUNT+1] = 
 {
@@ -1075,6 +1077,14 @@ bool LLDAELoader::OpenFile(const std::string& filename)
 	mTransform.condition();	
 	
 	U32 submodel_limit = count > 0 ? mGeneratedModelLimit/count : 0;
+
+	// collada-dom is not thread safe (its element references are counted
+	// without atomics), so the faces are read out of the DOM here, one mesh
+	// at a time, and the index lists each mesh no longer needs are dropped as
+	// soon as it is read. Normalizing, splitting, optimizing and validating
+	// the models only touches the faces and runs on the worker pool.
+	pending_mesh_list_t pending;
+	pending.reserve(count);
 	for (daeInt idx = 0; idx < count; ++idx)
 	{ //build map of domEntities to LLModel
 		domMesh* mesh = NULL;
@@ -1082,28 +1092,33 @@ bool LLDAELoader::OpenFile(const std::string& filename)
 		
 		if (mesh)
 		{
+			PendingMesh entry;
+			entry.mMesh = mesh;
+			entry.mBaseModel = loadBaseModelFromDomMesh(mesh, entry.mName);
+			pending.push_back(entry);
 
-			std::vector<LLModel*> models;
+			releaseDomMeshPrimitives(mesh);
+		}
+	}
 
-			loadModelsFromDomMesh(mesh, models, submodel_limit);
+	LLWorkerPool::getDefault()->parallelFor((U32)pending.size(), 1,
+		boost::bind(&LLDAELoader::processPendingMeshes, this, &pending, submodel_limit, _1, _2));
 
-			std::vector<LLModel*>::iterator i;
-			i = models.begin();
-			while (i != models.end())
+	for (pending_mesh_list_t::iterator iter = pending.begin(); iter != pending.end(); ++iter)
+	{
+		for (U32 i = 0; i < (U32)iter->mModels.size(); ++i)
+		{
+			LLModel* mdl = iter->mModels[i];
+			if(mdl->getStatus() != LLModel::NO_ERRORS)
 			{
-				LLModel* mdl = *i;
-				if(mdl->getStatus() != LLModel::NO_ERRORS)
-				{
-					setLoadState(ERROR_MODEL + mdl->getStatus()) ;
-					return false; //abort
-				}
+				setLoadState(ERROR_MODEL + mdl->getStatus()) ;
+				return false; //abort
+			}
 
-				if (mdl && validate_model(mdl))
-				{
-					mModelList.push_back(mdl);
-					mModelsMap[mesh].push_back(mdl);
-				}
-				i++;
+			if (iter->mValid[i])
+			{
+				mModelList.push_back(mdl);
+				mModelsMap[iter->mMesh].push_back(mdl);
 			}
 		}
 	}
@@ -2484,20 +2499,14 @@ LLModel* LLDAELoader::loadModelFromDomMesh(domMesh *mesh)
     return ret;
 }
 
-//static diff version supports creating multiple models when material counts spill
-// over the 8 face server-side limit
-//
-bool LLDAELoader::loadModelsFromDomMesh(domMesh* mesh, std::vector<LLModel*>& models_out, U32 submodel_limit)
+LLModel* LLDAELoader::loadBaseModelFromDomMesh(domMesh* mesh, std::string& model_name)
 {
-
 	LLVolumeParams volume_params;
 	volume_params.setType(LL_PCODE_PROFILE_SQUARE, LL_PCODE_PATH_LINE);
 
-	models_out.clear();
-
 	LLModel* ret = new LLModel(volume_params, 0.f);
 
-	std::string model_name = getLodlessLabel(mesh);
+	model_name = getLodlessLabel(mesh);
 	ret->mLabel = model_name + lod_suffix[mLod];
 
 	llassert(!ret->mLabel.empty());
@@ -2510,6 +2519,16 @@ bool LLDAELoader::loadModelsFromDomMesh(domMesh* mesh, std::vector<LLModel*>& mo
 	//
 	addVolumeFacesFromDomMesh(ret, mesh);
 
+	return ret;
+}
+
+void LLDAELoader::splitModel(LLModel* ret, const std::string& model_name, std::vector<LLModel*>& models_out, U32 submodel_limit) const
+{
+	LLVolumeParams volume_params;
+	volume_params.setType(LL_PCODE_PROFILE_SQUARE, LL_PCODE_PATH_LINE);
+
+	models_out.clear();
+
 	U32 volume_faces = ret->getNumVolumeFaces();
 
 	// Side-steps all manner of issues when splitting models
@@ -2571,8 +2590,63 @@ bool LLDAELoader::loadModelsFromDomMesh(domMesh* mesh, std::vector<LLModel*>& mo
 		remainder.clear();
 
 	} while (volume_faces);	
+}
 
-	return true;
+void LLDAELoader::processPendingMeshes(pending_mesh_list_t* meshes, U32 submodel_limit, U32 begin, U32 end) const
+{
+	for (U32 i = begin; i < end; ++i)
+	{
+		PendingMesh& entry = (*meshes)[i];
+		splitModel(entry.mBaseModel, entry.mName, entry.mModels, submodel_limit);
+
+		entry.mValid.resize(entry.mModels.size());
+		for (U32 j = 0; j < (U32)entry.mModels.size(); ++j)
+		{
+			LLModel* mdl = entry.mModels[j];
+			entry.mValid[j] = mdl->getStatus() == LLModel::NO_ERRORS && validate_model(mdl);
+		}
+	}
+}
+
+//static
+void LLDAELoader::releaseDomMeshPrimitives(domMesh* mesh)
+{
+	// The vertex sources stay: skinning reads the positions again. The
+	// index lists are only ever read into the volume faces.
+	domTriangles_Array& tris = mesh->getTriangles_array();
+	for (U32 i = 0; i < tris.getCount(); ++i)
+	{
+		domPRef p = tris[i]->getP();
+		if (p)
+		{
+			p->getValue().clear();
+		}
+	}
+
+	domPolylist_Array& polys = mesh->getPolylist_array();
+	for (U32 i = 0; i < polys.getCount(); ++i)
+	{
+		domPRef p = polys[i]->getP();
+		if (p)
+		{
+			p->getValue().clear();
+		}
+		domPolylist::domVcountRef vcount = polys[i]->getVcount();
+		if (vcount)
+		{
+			vcount->getValue().clear();
+		}
+	}
+
+	domPolygons_Array& polygons = mesh->getPolygons_array();
+	for (U32 i = 0; i < polygons.getCount(); ++i)
+	{
+		domP_Array& ps = polygons[i]->getP_array();
+		for (U32 j = 0; j < ps.getCount(); ++j)
+		{
+			ps[j]->getValue().clear();
+		}
+	}
 }
 
 bool LLDAELoader::createVolumeFacesFromDomMesh(LLModel* pModel, domMesh* mesh)
@@ -92,10 +92,33 @@ protected:
 
 	static LLModel* loadModelFromDomMesh(domMesh* mesh);
 
-	// Loads a mesh breaking it into one or more models as necessary
-	// to get around volume face limitations while retaining >8 materials
-	//
-	bool loadModelsFromDomMesh(domMesh* mesh, std::vector<LLModel*>& models_out, U32 submodel_limit);
+	// A mesh read out of the DOM and waiting to be split into models, which
+	// OpenFile spreads over the worker pool.
+	struct PendingMesh
+	{
+		domMesh*				mMesh;
+		std::string				mName;
+		LLModel*				mBaseModel;
+		std::vector<LLModel*>	mModels;
+		std::vector<bool>		mValid;
+	};
+	typedef std::vector<PendingMesh> pending_mesh_list_t;
+
+	// Reads all the faces of mesh into one model, unsplit and unoptimized.
+	// model_name gets the label without its LOD suffix.
+	LLModel* loadBaseModelFromDomMesh(domMesh* mesh, std::string& model_name);
+
+	// Normalizes and optimizes a model from loadBaseModelFromDomMesh, breaking
+	// it into as many models as it takes to get around volume face limitations
+	// while retaining >8 materials. Reads no DOM and no loader state but settings, so distinct models may
+	// be split concurrently.
+	void splitModel(LLModel* base, const std::string& model_name, std::vector<LLModel*>& models_out, U32 submodel_limit) const;
+
+	// Splits and validates meshes [begin, end).
+	void processPendingMeshes(pending_mesh_list_t* meshes, U32 submodel_limit, U32 begin, U32 end) const;
+
+	// Frees the index lists of mesh's primitives once its faces are loaded.
+	static void releaseDomMeshPrimitives(domMesh* mesh);
 
 	static std::string getElementLabel(daeElement *element);
 	static size_t getSuffixPosition(std::string label);
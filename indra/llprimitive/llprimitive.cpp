@@ -1272,9 +1272,6 @@ BOOL LLPrimitive::packTEMessage(LLDataPacker &dp) const
 S32 LLPrimitive::parseTEMessage(LLMessageSystem* mesgsys, char const* block_name, const S32 block_num, LLTEContents& tec)
 {
 	S32 retval = 0;
-   // temp buffer for material ID processing
-   // data will end up in tec.material_id[]	
-   U8 material_data[LLTEContents::MAX_TES*16];
 
 	if (block_num < 0)
 	{
@@ -1300,7 +1297,30 @@ S32 LLPrimitive::parseTEMessage(LLMessageSystem* mesgsys, char const* block_name
 		mesgsys->getBinaryDataFast(block_name, _PREHASH_TextureEntry, tec.packed_buffer, 0, block_num, LLTEContents::MAX_TE_BUFFER);
 	}
 
-	tec.face_count = llmin((U32)getNumTEs(),(U32)LLTEContents::MAX_TES);
+	return parseTEBuffer(tec.packed_buffer, tec.size, getNumTEs(), tec);
+}
+
+// static
+S32 LLPrimitive::parseTEBuffer(const U8* buffer, U32 size, U32 face_count, LLTEContents& tec)
+{
+   // temp buffer for material ID processing
+   // data will end up in tec.material_id[]	
+   U8 material_data[LLTEContents::MAX_TES*16];
+
+	size = llmin(size, LLTEContents::MAX_TE_BUFFER);
+	if (buffer != tec.packed_buffer)
+	{
+		memcpy(tec.packed_buffer, buffer, size);	/* Flawfinder: ignore */
+	}
+	tec.size = size;
+
+	if (tec.size == 0)
+	{
+		tec.face_count = 0;
+		return 0;
+	}
+
+	tec.face_count = llmin(face_count,(U32)LLTEContents::MAX_TES);
 
 	U8 *cur_ptr = tec.packed_buffer;
 	cur_ptr += unpackTEField(cur_ptr, tec.packed_buffer+tec.size, (U8 *)tec.image_data, 16, tec.face_count, MVT_LLUUID);
@@ -1338,19 +1358,21 @@ S32 LLPrimitive::parseTEMessage(LLMessageSystem* mesgsys, char const* block_name
 		tec.material_ids[i].set(&material_data[i * 16]);
 	}
 	
-	retval = 1;
-	return retval;
+	return 1;
 }
 
-S32 LLPrimitive::applyParsedTEMessage(LLTEContents& tec)
+S32 LLPrimitive::applyParsedTEMessage(const LLTEContents& tec)
 {
 	S32 retval = 0;
 
+	// tec may have been parsed ahead of time for more faces than we have
+	U32 face_count = llmin(tec.face_count, (U32)getNumTEs());
+
 	LLColor4 color;
 	LLColor4U coloru;
-	for (U32 i = 0; i < tec.face_count; i++)
+	for (U32 i = 0; i < face_count; i++)
 	{
-		LLUUID& req_id = ((LLUUID*)tec.image_data)[i];
+		const LLUUID& req_id = ((const LLUUID*)tec.image_data)[i];
 		retval |= setTETexture(i, req_id);
 		retval |= setTEScale(i, tec.scale_s[i], tec.scale_t[i]);
 		retval |= setTEOffset(i, (F32)tec.offset_s[i] / (F32)0x7FFF, (F32) tec.offset_t[i] / (F32) 0x7FFF);
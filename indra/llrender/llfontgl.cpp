@@ -34,6 +34,7 @@
 #include "llfasttimer.h"
 #include "llfontfreetype.h"
 #include "llfontbitmapcache.h"
+#include "llfontlayoutcache.h"
 #include "llfontregistry.h"
 #include "llgl.h"
 #include "llimagegl.h"
@@ -84,11 +85,13 @@ LLFontGL::~LLFontGL()
 
 void LLFontGL::reset()
 {
+	mLayoutCache.clear();
 	mFontFreetype->reset(sVertDPI, sHorizDPI);
 }
 
 void LLFontGL::destroyGL()
 {
+	mLayoutCache.clear();
 	mFontFreetype->destroyGL();
 }
 
@@ -98,11 +101,15 @@ BOOL LLFontGL::loadFace(const std::string& filename, const F32 point_size, const
 	{
 		mFontFreetype = new LLFontFreetype;
 	}
+	mLayoutCache.clear();
 
 	return mFontFreetype->loadFace(filename, point_size, vert_dpi, horz_dpi, components, is_fallback);
 }
 
 static LLTrace::BlockTimerStatHandle FTM_RENDER_FONTS("Fonts");
+static LLTrace::BlockTimerStatHandle FTM_RENDER_FONTS_LAYOUT("Font Layout Cache Miss");
+static LLTrace::CountStatHandle<> sFontLayoutCacheHits("fontlayoutcachehits", "Text runs drawn from the font layout cache");
+static LLTrace::CountStatHandle<> sFontLayoutCacheMisses("fontlayoutcachemisses", "Text runs laid out because they were not in the font layout cache");
 
 S32 LLFontGL::render(const LLWString &wstr, S32 begin_offset, const LLRect& rect, const LLColor4 &color, HAlign halign, VAlign valign, U8 style, 
 					 ShadowType shadow, S32 max_chars, F32* right_x, BOOL use_embedded, BOOL use_ellipses) const
@@ -234,12 +241,6 @@ S32 LLFontGL::render(const LLWString &wstr, S32 begin_offset, F32 x, F32 y, cons
 
 	const LLFontBitmapCache* font_bitmap_cache = mFontFreetype->getFontBitmapCache();
 
-	F32 inv_width = 1.f / font_bitmap_cache->getBitmapWidth();
-	F32 inv_height = 1.f / font_bitmap_cache->getBitmapHeight();
-
-	const S32 LAST_CHARACTER = LLFontFreetype::LAST_CHAR_FULL;
-
-
 	BOOL draw_ellipses = FALSE;
 	if (use_ellipses && halign == LEFT)
 	{
@@ -265,99 +266,120 @@ S32 LLFontGL::render(const LLWString &wstr, S32 begin_offset, F32 x, F32 y, cons
 
 	S32 bitmap_num = -1;
 	S32 glyph_count = 0;
-	for (i = begin_offset; i < begin_offset + length; i++)
-	{
-		llwchar wch = wstr[i];
 
-		// Handle embedded characters first, if they're enabled.
-		// Embedded characters are a hack for notecards
-		const embedded_data_t* ext_data = use_embedded ? getEmbeddedCharData(wch) : NULL;
-		if (ext_data)
+	// Strings without embedded characters go through the layout cache; the
+	// glyph lookups, kerning and pixel snapping below are then done once per
+	// distinct string instead of every frame.
+	const bool use_layout_cache = (!use_embedded || mEmbeddedChars.empty())
+		&& (U32)length <= LLFontLayoutCache::MAX_CACHED_LENGTH;
+	if (use_layout_cache)
+	{
+		// Lay out relative to the integer part of the pen position, so a run
+		// is reusable wherever the string is drawn: snapping to whole pixels
+		// only depends on the fractional part, which is quantized so that
+		// sub-pixel motion doesn't produce a new key every frame.
+		const F32 base_x = floorf(cur_x);
+		const F32 base_y = floorf(cur_y);
+		const S32 sub_x = LLFontLayoutCache::quantize(cur_x - base_x);
+		const S32 sub_y = LLFontLayoutCache::quantize(cur_y - base_y);
+
+		// The last glyph is kerned against the character following the run,
+		// so that is part of the key too (the terminator at the very end).
+		const llwchar* run_text = wstr.c_str() + begin_offset;
+		const U32 run_length = (U32)length + 1;
+
+		const LLFontLayoutRun* run = mLayoutCache.findRun(run_text, run_length, sub_x, sub_y, scaled_max_pixels);
+		if (run)
 		{
-			LLImageGL* ext_image = ext_data->mImage;
-			const LLWString& label = ext_data->mLabel;
-
-			F32 ext_height = (F32)ext_image->getHeight() * sScaleY;
-
-			F32 ext_width = (F32)ext_image->getWidth() * sScaleX;
-			F32 ext_advance = (EXT_X_BEARING * sScaleX) + ext_width;
+			add(sFontLayoutCacheHits, 1);
+		}
+		else
+		{
+			LL_RECORD_BLOCK_TIME(FTM_RENDER_FONTS_LAYOUT);
+			add(sFontLayoutCacheMisses, 1);
+			LLFontLayoutRun& new_run = mLayoutCache.insertRun(run_text, run_length, sub_x, sub_y, scaled_max_pixels);
+			layoutRun(wstr, begin_offset, length, LLFontLayoutCache::dequantize(sub_x), LLFontLayoutCache::dequantize(sub_y), scaled_max_pixels, new_run);
+			run = &new_run;
+		}
 
-			if (!label.empty())
+		for (std::vector<LLFontLayoutGlyph>::const_iterator it = run->mGlyphs.begin(); it != run->mGlyphs.end(); ++it)
+		{
+			if (it->mBitmapNum != bitmap_num)
 			{
-				ext_advance += (EXT_X_BEARING + getFontExtChar()->getWidthF32( label.c_str() )) * sScaleX;
-			}
+				if (glyph_count > 0)
+				{
+					gGL.begin(LLRender::QUADS);
+					{
+						gGL.vertexBatchPreTransformed(vertices, uvs, colors, glyph_count * 4);
+					}
+					gGL.end();
+					glyph_count = 0;
+				}
 
-			if (start_x + scaled_max_pixels < cur_x + ext_advance)
-			{
-				// Not enough room for this character.
-				break;
+				bitmap_num = it->mBitmapNum;
+				LLImageGL *font_image = font_bitmap_cache->getImageGL(bitmap_num);
+				gGL.getTexUnit(0)->bind(font_image);
 			}
 
-			gGL.getTexUnit(0)->bind(ext_image);
-
-			// snap origin to whole screen pixel
-			const F32 ext_x = (F32)ll_round(cur_render_x + (EXT_X_BEARING * sScaleX));
-			const F32 ext_y = (F32)ll_round(cur_render_y + (EXT_Y_BEARING * sScaleY + mFontFreetype->getAscenderHeight() - mFontFreetype->getLineHeight()));
-
-			LLRectf uv_rect(0.f, 1.f, 1.f, 0.f);
-			LLRectf screen_rect(ext_x, ext_y + ext_height, ext_x + ext_width, ext_y);
-
-			if (glyph_count > 0)
+			if (glyph_count >= GLYPH_BATCH_SIZE)
 			{
 				gGL.begin(LLRender::QUADS);
 				{
 					gGL.vertexBatchPreTransformed(vertices, uvs, colors, glyph_count * 4);
 				}
 				gGL.end();
-				glyph_count = 0;
-			}
-			renderQuad(vertices, uvs, colors, screen_rect, uv_rect, LLColor4U::white, 0);
-			//No batching here. It will never happen.
-			gGL.begin(LLRender::QUADS);
-			{
-				gGL.vertexBatchPreTransformed(vertices, uvs, colors, 4);
-			}
-			gGL.end();
 
-			if (!label.empty())
-			{
-				gGL.pushMatrix();
-				getFontExtChar()->render(label, 0,
-									 /*llfloor*/(ext_x / sScaleX) + ext_image->getWidth() + EXT_X_BEARING - sCurOrigin.mX, 
-									 /*llfloor*/(cur_render_y / sScaleY) - sCurOrigin.mY,
-									 color,
-									 halign, BASELINE, UNDERLINE, NO_SHADOW, S32_MAX, S32_MAX, NULL,
-									 TRUE );
-				gGL.popMatrix();
+				glyph_count = 0;
 			}
 
-			chars_drawn++;
-			cur_x += ext_advance;
-			if (((i + 1) < length) && wstr[i+1])
-			{
-				cur_x += EXT_KERNING * sScaleX;
-			}
-			cur_render_x = cur_x;
+			LLRectf screen_rect(it->mScreenRect);
+			screen_rect.translate(base_x, base_y);
+			drawGlyph(glyph_count, vertices, uvs, colors, screen_rect, it->mUVRect, text_color, style_to_add, shadow, drop_shadow_strength);
 		}
-		else
+
+		chars_drawn = run->mCharsDrawn;
+		cur_x = base_x + run->mEndX;
+		cur_y = base_y + run->mEndY;
+	}
+	else
+	{
+		for (i = begin_offset; i < begin_offset + length; i++)
 		{
-			const LLFontGlyphInfo* fgi = next_glyph;
-			next_glyph = NULL;
-			if(!fgi)
-			{
-				fgi = mFontFreetype->getGlyphInfo(wch);
-			}
-			if (!fgi)
-			{
-				LL_ERRS() << "Missing Glyph Info" << LL_ENDL;
-				break;
-			}
-			// Per-glyph bitmap texture.
-			S32 next_bitmap_num = fgi->mBitmapNum;
-			if (next_bitmap_num != bitmap_num)
+			llwchar wch = wstr[i];
+
+			// Handle embedded characters first, if they're enabled.
+			// Embedded characters are a hack for notecards
+			const embedded_data_t* ext_data = use_embedded ? getEmbeddedCharData(wch) : NULL;
+			if (ext_data)
 			{
-				// Actually draw the queued glyphs before switching their texture;
-				// otherwise the queued glyphs will be taken from wrong textures.
+				LLImageGL* ext_image = ext_data->mImage;
+				const LLWString& label = ext_data->mLabel;
+
+				F32 ext_height = (F32)ext_image->getHeight() * sScaleY;
+
+				F32 ext_width = (F32)ext_image->getWidth() * sScaleX;
+				F32 ext_advance = (EXT_X_BEARING * sScaleX) + ext_width;
+
+				if (!label.empty())
+				{
+					ext_advance += (EXT_X_BEARING + getFontExtChar()->getWidthF32( label.c_str() )) * sScaleX;
+				}
+
+				if (start_x + scaled_max_pixels < cur_x + ext_advance)
+				{
+					// Not enough room for this character.
+					break;
+				}
+
+				gGL.getTexUnit(0)->bind(ext_image);
+
+				// snap origin to whole screen pixel
+				const F32 ext_x = (F32)ll_round(cur_render_x + (EXT_X_BEARING * sScaleX));
+				const F32 ext_y = (F32)ll_round(cur_render_y + (EXT_Y_BEARING * sScaleY + mFontFreetype->getAscenderHeight() - mFontFreetype->getLineHeight()));
+
+				LLRectf uv_rect(0.f, 1.f, 1.f, 0.f);
+				LLRectf screen_rect(ext_x, ext_y + ext_height, ext_x + ext_width, ext_y);
+
 				if (glyph_count > 0)
 				{
 					gGL.begin(LLRender::QUADS);
@@ -367,64 +389,79 @@ S32 LLFontGL::render(const LLWString &wstr, S32 begin_offset, F32 x, F32 y, cons
 					gGL.end();
 					glyph_count = 0;
 				}
+				renderQuad(vertices, uvs, colors, screen_rect, uv_rect, LLColor4U::white, 0);
+				//No batching here. It will never happen.
+				gGL.begin(LLRender::QUADS);
+				{
+					gGL.vertexBatchPreTransformed(vertices, uvs, colors, 4);
+				}
+				gGL.end();
 
-				bitmap_num = next_bitmap_num;
-				LLImageGL *font_image = font_bitmap_cache->getImageGL(bitmap_num);
-				gGL.getTexUnit(0)->bind(font_image);
-			}
+				if (!label.empty())
+				{
+					gGL.pushMatrix();
+					getFontExtChar()->render(label, 0,
+										 /*llfloor*/(ext_x / sScaleX) + ext_image->getWidth() + EXT_X_BEARING - sCurOrigin.mX, 
+										 /*llfloor*/(cur_render_y / sScaleY) - sCurOrigin.mY,
+										 color,
+										 halign, BASELINE, UNDERLINE, NO_SHADOW, S32_MAX, S32_MAX, NULL,
+										 TRUE );
+					gGL.popMatrix();
+				}
 
-			if ((start_x + scaled_max_pixels) < (cur_x + fgi->mXBearing + fgi->mWidth))
-			{
-				// Not enough room for this character.
-				break;
+				chars_drawn++;
+				cur_x += ext_advance;
+				if (((i + 1) < length) && wstr[i+1])
+				{
+					cur_x += EXT_KERNING * sScaleX;
+				}
+				cur_render_x = cur_x;
 			}
-
-			// Draw the text at the appropriate location
-			//Specify vertices and texture coordinates
-			LLRectf uv_rect((fgi->mXBitmapOffset) * inv_width,
-					(fgi->mYBitmapOffset + fgi->mHeight + PAD_UVY) * inv_height,
-					(fgi->mXBitmapOffset + fgi->mWidth) * inv_width,
-				(fgi->mYBitmapOffset - PAD_UVY) * inv_height);
-			// snap glyph origin to whole screen pixel
-			LLRectf screen_rect((F32)ll_round(cur_render_x + (F32)fgi->mXBearing),
-				    (F32)ll_round(cur_render_y + (F32)fgi->mYBearing),
-				    (F32)ll_round(cur_render_x + (F32)fgi->mXBearing) + (F32)fgi->mWidth,
-				    (F32)ll_round(cur_render_y + (F32)fgi->mYBearing) - (F32)fgi->mHeight);
-			
-			if (glyph_count >= GLYPH_BATCH_SIZE)
+			else
 			{
-				gGL.begin(LLRender::QUADS);
+				LLFontLayoutGlyph glyph;
+				if (!layoutGlyph(wstr, i, start_x, scaled_max_pixels, cur_x, cur_y, next_glyph, glyph))
 				{
-					gGL.vertexBatchPreTransformed(vertices, uvs, colors, glyph_count * 4);
+					break;
 				}
-				gGL.end();
 
-				glyph_count = 0;
-			}
+				// Per-glyph bitmap texture.
+				if (glyph.mBitmapNum != bitmap_num)
+				{
+					// Actually draw the queued glyphs before switching their texture;
+					// otherwise the queued glyphs will be taken from wrong textures.
+					if (glyph_count > 0)
+					{
+						gGL.begin(LLRender::QUADS);
+						{
+							gGL.vertexBatchPreTransformed(vertices, uvs, colors, glyph_count * 4);
+						}
+						gGL.end();
+						glyph_count = 0;
+					}
 
-			drawGlyph(glyph_count, vertices, uvs, colors, screen_rect, uv_rect, text_color, style_to_add, shadow, drop_shadow_strength);
+					bitmap_num = glyph.mBitmapNum;
+					LLImageGL *font_image = font_bitmap_cache->getImageGL(bitmap_num);
+					gGL.getTexUnit(0)->bind(font_image);
+				}
 
-			chars_drawn++;
-			cur_x += fgi->mXAdvance;
-			cur_y += fgi->mYAdvance;
+				if (glyph_count >= GLYPH_BATCH_SIZE)
+				{
+					gGL.begin(LLRender::QUADS);
+					{
+						gGL.vertexBatchPreTransformed(vertices, uvs, colors, glyph_count * 4);
+					}
+					gGL.end();
 
-			llwchar next_char = wstr[i+1];
-			if (next_char && (next_char < LAST_CHARACTER))
-			{
-				// Kern this puppy.
-				next_glyph = mFontFreetype->getGlyphInfo(next_char);
-				cur_x += mFontFreetype->getXKerning(fgi, next_glyph);
-			}
+					glyph_count = 0;
+				}
 
-			// Round after kerning.
-			// Must do this to cur_x, not just to cur_render_x, otherwise you
-			// will squish sub-pixel kerned characters too close together.
-			// For example, "CCCCC" looks bad.
-			cur_x = (F32)ll_round(cur_x);
-			//cur_y = (F32)ll_round(cur_y);
+				drawGlyph(glyph_count, vertices, uvs, colors, glyph.mScreenRect, glyph.mUVRect, text_color, style_to_add, shadow, drop_shadow_strength);
 
-			cur_render_x = cur_x;
-			cur_render_y = cur_y;
+				chars_drawn++;
+				cur_render_x = cur_x;
+				cur_render_y = cur_y;
+			}
 		}
 	}
 
@@ -479,6 +516,87 @@ S32 LLFontGL::render(const LLWString &wstr, S32 begin_offset, F32 x, F32 y, cons
 	return chars_drawn;
 }
 
+bool LLFontGL::layoutGlyph(const LLWString& wstr, S32 i, F32 start_x, S32 scaled_max_pixels, F32& cur_x, F32& cur_y, const LLFontGlyphInfo*& next_glyph, LLFontLayoutGlyph& glyph) const
+{
+	const LLFontGlyphInfo* fgi = next_glyph;
+	next_glyph = NULL;
+	if(!fgi)
+	{
+		fgi = mFontFreetype->getGlyphInfo(wstr[i]);
+	}
+	if (!fgi)
+	{
+		LL_ERRS() << "Missing Glyph Info" << LL_ENDL;
+		return false;
+	}
+
+	if ((start_x + scaled_max_pixels) < (cur_x + fgi->mXBearing + fgi->mWidth))
+	{
+		// Not enough room for this character.
+		return false;
+	}
+
+	const LLFontBitmapCache* font_bitmap_cache = mFontFreetype->getFontBitmapCache();
+	const F32 inv_width = 1.f / font_bitmap_cache->getBitmapWidth();
+	const F32 inv_height = 1.f / font_bitmap_cache->getBitmapHeight();
+
+	// Draw the text at the appropriate location
+	//Specify vertices and texture coordinates
+	glyph.mBitmapNum = fgi->mBitmapNum;
+	glyph.mUVRect.set((fgi->mXBitmapOffset) * inv_width,
+			(fgi->mYBitmapOffset + fgi->mHeight + PAD_UVY) * inv_height,
+			(fgi->mXBitmapOffset + fgi->mWidth) * inv_width,
+		(fgi->mYBitmapOffset - PAD_UVY) * inv_height);
+	// snap glyph origin to whole screen pixel
+	glyph.mScreenRect.set((F32)ll_round(cur_x + (F32)fgi->mXBearing),
+			(F32)ll_round(cur_y + (F32)fgi->mYBearing),
+			(F32)ll_round(cur_x + (F32)fgi->mXBearing) + (F32)fgi->mWidth,
+			(F32)ll_round(cur_y + (F32)fgi->mYBearing) - (F32)fgi->mHeight);
+
+	cur_x += fgi->mXAdvance;
+	cur_y += fgi->mYAdvance;
+
+	llwchar next_char = wstr[i+1];
+	if (next_char && (next_char < LLFontFreetype::LAST_CHAR_FULL))
+	{
+		// Kern this puppy.
+		next_glyph = mFontFreetype->getGlyphInfo(next_char);
+		cur_x += mFontFreetype->getXKerning(fgi, next_glyph);
+	}
+
+	// Round after kerning.
+	// Must do this to cur_x, not just to cur_render_x, otherwise you
+	// will squish sub-pixel kerned characters too close together.
+	// For example, "CCCCC" looks bad.
+	cur_x = (F32)ll_round(cur_x);
+	//cur_y = (F32)ll_round(cur_y);
+	return true;
+}
+
+// Same layout as render()'s uncached path, recorded instead of drawn.
+// cur_x and cur_y are the starting pen position relative to whole pixels.
+void LLFontGL::layoutRun(const LLWString& wstr, S32 begin_offset, S32 length, F32 cur_x, F32 cur_y, S32 scaled_max_pixels, LLFontLayoutRun& run) const
+{
+	const F32 start_x = (F32)ll_round(cur_x);
+	const LLFontGlyphInfo* next_glyph = NULL;
+
+	run.mGlyphs.reserve(length);
+	run.mCharsDrawn = 0;
+	for (S32 i = begin_offset; i < begin_offset + length; i++)
+	{
+		LLFontLayoutGlyph glyph;
+		if (!layoutGlyph(wstr, i, start_x, scaled_max_pixels, cur_x, cur_y, next_glyph, glyph))
+		{
+			break;
+		}
+		run.mGlyphs.push_back(glyph);
+		run.mCharsDrawn++;
+	}
+
+	run.mEndX = cur_x;
+	run.mEndY = cur_y;
+}
+
 S32 LLFontGL::renderUTF8(const std::string &text, S32 begin_offset, F32 x, F32 y, const LLColor4 &color, HAlign halign,  VAlign valign, U8 style, ShadowType shadow, S32 max_chars, S32 max_pixels,  F32* right_x, BOOL use_ellipses) const
 {
 	return render(utf8str_to_wstring(text), begin_offset, x, y, color, halign, valign, style, shadow, max_chars, max_pixels, right_x, use_ellipses);
@@ -524,6 +642,19 @@ F32 LLFontGL::getWidthF32(const LLWString& utf32text, const S32 begin_offset, co
 	if (max_index <= 0 || begin_offset >= max_index)
 		return 0;
 
+	const bool use_layout_cache = (!use_embedded || mEmbeddedChars.empty())
+		&& (U32)(max_index - begin_offset) <= LLFontLayoutCache::MAX_CACHED_LENGTH;
+	const llwchar* cache_text = utf32text.c_str() + begin_offset;
+	const U32 cache_length = (U32)(max_index - begin_offset);
+	if (use_layout_cache)
+	{
+		F32 cached_width;
+		if (mLayoutCache.findWidth(cache_text, cache_length, cached_width))
+		{
+			return cached_width / sScaleX;
+		}
+	}
+
 	F32 cur_x = 0;
 
 	const LLFontGlyphInfo* next_glyph = NULL;
@@ -580,6 +711,11 @@ F32 LLFontGL::getWidthF32(const LLWString& utf32text, const S32 begin_offset, co
 	// add in extra pixels for last character's width past its xadvance
 	cur_x += width_padding;
 
+	if (use_layout_cache)
+	{
+		mLayoutCache.insertWidth(cache_text, cache_length, cur_x);
+	}
+
 	return cur_x / sScaleX;
 }
 
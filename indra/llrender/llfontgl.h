@@ -29,6 +29,7 @@
 #define LL_LLFONTGL_H
 
 #include "llcoord.h"
+#include "llfontlayoutcache.h"
 #include "llfontregistry.h"
 #include "llimagegl.h"
 #include "llpointer.h"
@@ -41,6 +42,7 @@ class LLColor4;
 // Key used to request a font.
 class LLFontDescriptor;
 class LLFontFreetype;
+struct LLFontGlyphInfo;
 
 // Structure used to store previously requested fonts.
 class LLFontRegistry;
@@ -229,6 +231,15 @@ protected:
 	LLFontDescriptor mFontDescriptor;
 	LLPointer<LLFontFreetype> mFontFreetype;
 
+	// Laid out runs and widths of recently drawn strings
+	mutable LLFontLayoutCache mLayoutCache;
+
+	// Lays out the glyph for wstr[i] at the pen position and advances the pen
+	// past it, kerned and snapped. Returns false if the glyph doesn't fit.
+	// next_glyph carries the kerning lookup over to the following call.
+	bool layoutGlyph(const LLWString& wstr, S32 i, F32 start_x, S32 scaled_max_pixels, F32& cur_x, F32& cur_y, const LLFontGlyphInfo*& next_glyph, LLFontLayoutGlyph& glyph) const;
+	void layoutRun(const LLWString& wstr, S32 begin_offset, S32 length, F32 cur_x, F32 cur_y, S32 scaled_max_pixels, LLFontLayoutRun& run) const;
+
 	void renderQuad(LLVector4a* vertex_out, LLVector2* uv_out, LLColor4U* colors_out, const LLRectf& screen_rect, const LLRectf& uv_rect, const LLColor4U& color, F32 slant_amt) const;
 	void drawGlyph(S32& glyph_count, LLVector4a* vertex_out, LLVector2* uv_out, LLColor4U* colors_out, const LLRectf& screen_rect, const LLRectf& uv_rect, const LLColor4U& color, U8 style, ShadowType shadow, F32 drop_shadow_fade) const;
 
@@ -0,0 +1,149 @@
+/**
+ * @file llfontlayoutcache.cpp
+ * @brief LRU cache of laid out glyph runs for LLFontGL
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llfontlayoutcache.h"
+
+// Per font. Name tags, chat lines and scroll list cells of a busy scene fit
+// comfortably; anything beyond that is rarely redrawn verbatim anyway.
+static const U32 MAX_CACHED_RUNS = 1024;
+static const U32 MAX_CACHED_WIDTHS = 2048;
+
+namespace
+{
+	size_t hash_key(const llwchar* text, size_t length, S32 sub_x, S32 sub_y, S32 max_pixels)
+	{
+		size_t seed = boost::hash_range(text, text + length);
+		boost::hash_combine(seed, sub_x);
+		boost::hash_combine(seed, sub_y);
+		boost::hash_combine(seed, max_pixels);
+		return seed;
+	}
+}
+
+size_t LLFontLayoutCache::KeyHasher::operator()(const Key& key) const
+{
+	return hash_key(key.mText.data(), key.mText.size(), key.mSubX, key.mSubY, key.mMaxPixels);
+}
+
+size_t LLFontLayoutCache::KeyHasher::operator()(const KeyRef& key) const
+{
+	return hash_key(key.mText, key.mLength, key.mSubX, key.mSubY, key.mMaxPixels);
+}
+
+LLFontLayoutCache::LLFontLayoutCache()
+{
+}
+
+const LLFontLayoutRun* LLFontLayoutCache::findRun(const llwchar* text, U32 length, S32 sub_x, S32 sub_y, S32 max_pixels)
+{
+	KeyRef key;
+	key.mText = text;
+	key.mLength = length;
+	key.mSubX = sub_x;
+	key.mSubY = sub_y;
+	key.mMaxPixels = max_pixels;
+
+	run_map_t::iterator found = mRunMap.find(key, KeyHasher(), KeyRefEqual());
+	if (found == mRunMap.end())
+	{
+		return NULL;
+	}
+	mRunLRU.splice(mRunLRU.begin(), mRunLRU, found->second);
+	return &found->second->second;
+}
+
+LLFontLayoutRun& LLFontLayoutCache::insertRun(const llwchar* text, U32 length, S32 sub_x, S32 sub_y, S32 max_pixels)
+{
+	Key key;
+	key.mText.assign(text, length);
+	key.mSubX = sub_x;
+	key.mSubY = sub_y;
+	key.mMaxPixels = max_pixels;
+
+	run_map_t::iterator found = mRunMap.find(key);
+	if (found != mRunMap.end())
+	{
+		mRunLRU.splice(mRunLRU.begin(), mRunLRU, found->second);
+		found->second->second = LLFontLayoutRun();
+		return found->second->second;
+	}
+
+	if (mRunLRU.size() >= MAX_CACHED_RUNS)
+	{
+		mRunMap.erase(mRunLRU.back().first);
+		mRunLRU.pop_back();
+	}
+	mRunLRU.push_front(std::make_pair(key, LLFontLayoutRun()));
+	mRunMap[key] = mRunLRU.begin();
+	return mRunLRU.front().second;
+}
+
+bool LLFontLayoutCache::findWidth(const llwchar* text, U32 length, F32& width)
+{
+	TextRef ref;
+	ref.mText = text;
+	ref.mLength = length;
+	width_map_t::iterator found = mWidthMap.find(ref, TextRefHasher(), TextRefEqual());
+	if (found == mWidthMap.end())
+	{
+		return false;
+	}
+	mWidthLRU.splice(mWidthLRU.begin(), mWidthLRU, found->second);
+	width = found->second->second;
+	return true;
+}
+
+void LLFontLayoutCache::insertWidth(const llwchar* text, U32 length, F32 width)
+{
+	TextRef ref;
+	ref.mText = text;
+	ref.mLength = length;
+	width_map_t::iterator found = mWidthMap.find(ref, TextRefHasher(), TextRefEqual());
+	if (found != mWidthMap.end())
+	{
+		found->second->second = width;
+		mWidthLRU.splice(mWidthLRU.begin(), mWidthLRU, found->second);
+		return;
+	}
+
+	if (mWidthLRU.size() >= MAX_CACHED_WIDTHS)
+	{
+		mWidthMap.erase(mWidthLRU.back().first);
+		mWidthLRU.pop_back();
+	}
+	mWidthLRU.push_front(std::make_pair(LLWString(text, length), width));
+	mWidthMap[mWidthLRU.front().first] = mWidthLRU.begin();
+}
+
+void LLFontLayoutCache::clear()
+{
+	mRunMap.clear();
+	mRunLRU.clear();
+	mWidthMap.clear();
+	mWidthLRU.clear();
+}
@@ -0,0 +1,164 @@
+/**
+ * @file llfontlayoutcache.h
+ * @brief LRU cache of laid out glyph runs for LLFontGL
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLFONTLAYOUTCACHE_H
+#define LL_LLFONTLAYOUTCACHE_H
+
+#include <algorithm>
+#include <list>
+#include <vector>
+#include <boost/unordered_map.hpp>
+
+#include "llmath.h"
+#include "llrect.h"
+#include "llstring.h"
+
+// One glyph quad of a laid out run. Positions are relative to the integer
+// part of the run's starting pen position.
+struct LLFontLayoutGlyph
+{
+	S32		mBitmapNum;
+	LLRectf	mScreenRect;
+	LLRectf	mUVRect;
+};
+
+// A laid out run: what LLFontGL::render() would compute for a string at a
+// given sub-pixel pen offset and width limit, minus colors and style, which
+// are applied when the quads are emitted.
+struct LLFontLayoutRun
+{
+	std::vector<LLFontLayoutGlyph> mGlyphs;
+	F32 mEndX;			// Final pen position, same frame as the glyphs
+	F32 mEndY;
+	S32 mCharsDrawn;
+};
+
+// Per-font LRU cache of laid out runs (used by render()) and measured
+// widths (used by getWidthF32() and render()'s alignment). Keys are the
+// text plus everything else the layout depends on; colors, shadows and
+// style flags don't affect layout and are not part of the key.
+class LLFontLayoutCache
+{
+public:
+	// Strings longer than this are laid out every time.
+	static const U32 MAX_CACHED_LENGTH = 512;
+	// Sub-pixel pen offsets are keyed in steps of 1/SUBPIXEL_STEPS pixel, so
+	// text scrolled or animated by fractions of a pixel reuses its runs.
+	static const S32 SUBPIXEL_STEPS = 4;
+
+	LLFontLayoutCache();
+
+	// Returns the cached run or NULL. The pointer stays valid until the next
+	// insertRun() or clear(). text is compared where it lies, so a run can
+	// be looked up straight out of the string being drawn. sub_x and sub_y
+	// are the pen offsets in 1/SUBPIXEL_STEPS pixel units, see quantize().
+	const LLFontLayoutRun* findRun(const llwchar* text, U32 length, S32 sub_x, S32 sub_y, S32 max_pixels);
+	LLFontLayoutRun& insertRun(const llwchar* text, U32 length, S32 sub_x, S32 sub_y, S32 max_pixels);
+
+	bool findWidth(const llwchar* text, U32 length, F32& width);
+	void insertWidth(const llwchar* text, U32 length, F32 width);
+
+	// Drop everything, e.g. when glyph bitmaps are rebuilt.
+	void clear();
+
+	static S32 quantize(F32 frac)		{ return ll_round(frac * SUBPIXEL_STEPS); }
+	static F32 dequantize(S32 sub)		{ return (F32)sub / SUBPIXEL_STEPS; }
+
+private:
+	struct Key
+	{
+		LLWString	mText;
+		S32			mSubX;
+		S32			mSubY;
+		S32			mMaxPixels;
+
+		bool operator==(const Key& other) const
+		{
+			return mSubX == other.mSubX && mSubY == other.mSubY
+				&& mMaxPixels == other.mMaxPixels && mText == other.mText;
+		}
+	};
+
+	// A Key whose text is not copied out, for lookups.
+	struct KeyRef
+	{
+		const llwchar*	mText;
+		U32				mLength;
+		S32				mSubX;
+		S32				mSubY;
+		S32				mMaxPixels;
+
+		bool operator==(const Key& other) const
+		{
+			return mSubX == other.mSubX && mSubY == other.mSubY
+				&& mMaxPixels == other.mMaxPixels && mLength == other.mText.size()
+				&& std::equal(mText, mText + mLength, other.mText.begin());
+		}
+	};
+
+	struct KeyHasher
+	{
+		size_t operator()(const Key& key) const;
+		size_t operator()(const KeyRef& key) const;
+	};
+
+	struct KeyRefEqual
+	{
+		bool operator()(const KeyRef& ref, const Key& key) const	{ return ref == key; }
+	};
+
+	// Width lookups, by text where it lies.
+	struct TextRef
+	{
+		const llwchar*	mText;
+		U32				mLength;
+	};
+
+	struct TextRefHasher
+	{
+		size_t operator()(const TextRef& ref) const	{ return boost::hash_range(ref.mText, ref.mText + ref.mLength); }
+	};
+
+	struct TextRefEqual
+	{
+		bool operator()(const TextRef& ref, const LLWString& text) const
+		{
+			return ref.mLength == text.size() && std::equal(ref.mText, ref.mText + ref.mLength, text.begin());
+		}
+	};
+
+	typedef std::list<std::pair<Key, LLFontLayoutRun> > run_lru_t;
+	typedef boost::unordered_map<Key, run_lru_t::iterator, KeyHasher> run_map_t;
+	run_lru_t	mRunLRU;		// Most recently used at the front
+	run_map_t	mRunMap;
+
+	typedef std::list<std::pair<LLWString, F32> > width_lru_t;
+	typedef boost::unordered_map<LLWString, width_lru_t::iterator, boost::hash<LLWString> > width_map_t;
+	width_lru_t	mWidthLRU;
+	width_map_t	mWidthMap;
+};
+
+#endif // LL_LLFONTLAYOUTCACHE_H
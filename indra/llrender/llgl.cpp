@@ -425,6 +425,7 @@ LLGLManager::LLGLManager() :
 	mHasFramebufferMultisample(FALSE),
 	mHasBlendFuncSeparate(FALSE),
 	mHasSync(FALSE),
+	mHasPixelBufferObject(FALSE),
 	mHasVertexBufferObject(FALSE),
 	mHasVertexArrayObject(FALSE),
 	mHasMapBufferRange(FALSE),
@@ -941,6 +942,7 @@ void LLGLManager::initExtensions()
 	mHasBlendFuncSeparate = FALSE;
 # endif // GL_EXT_blend_func_separate
 	mHasMipMapGeneration = FALSE;
+	mHasPixelBufferObject = FALSE;
 	mHasSeparateSpecularColor = FALSE;
 	mHasAnisotropic = FALSE;
 	mHasCubeMap = FALSE;
@@ -968,6 +970,9 @@ void LLGLManager::initExtensions()
 	mHasVertexBufferObject = ExtensionExists("GL_ARB_vertex_buffer_object", gGLHExts.mSysExts);
 	mHasVertexArrayObject = ExtensionExists("GL_ARB_vertex_array_object", gGLHExts.mSysExts);
 	mHasSync = ExtensionExists("GL_ARB_sync", gGLHExts.mSysExts);
+	// Pixel buffers share the buffer object entry points, so check
+	// mHasVertexBufferObject as well before using them.
+	mHasPixelBufferObject = mGLVersion >= 2.1f || ExtensionExists("GL_ARB_pixel_buffer_object", gGLHExts.mSysExts);
 	mHasMapBufferRange = ExtensionExists("GL_ARB_map_buffer_range", gGLHExts.mSysExts);
 	mHasFlushBufferRange = ExtensionExists("GL_APPLE_flush_buffer_range", gGLHExts.mSysExts);
 	mHasDepthClamp = ExtensionExists("GL_ARB_depth_clamp", gGLHExts.mSysExts) || ExtensionExists("GL_NV_depth_clamp", gGLHExts.mSysExts);
@@ -94,6 +94,7 @@ public:
 	BOOL mHasVertexBufferObject;
 	BOOL mHasVertexArrayObject;
 	BOOL mHasSync;
+	BOOL mHasPixelBufferObject;
 	BOOL mHasMapBufferRange;
 	BOOL mHasFlushBufferRange;
 	BOOL mHasPBuffer;
@@ -39,6 +39,8 @@
 #include "llgl.h"
 #include "llglslshader.h"
 #include "llrender.h"
+#include "llrendertarget.h"
+#include "lltextureupload.h"
 
 //----------------------------------------------------------------------------
 const F32 MIN_TEXTURE_LIFETIME = 10.f;
@@ -189,6 +191,7 @@ void LLImageGL::initClass(S32 num_catagories)
 //static 
 void LLImageGL::cleanupClass() 
 {	
+	LLTextureUpload::cleanupClass();
 	sTextureMemByCategory.clear() ;
 	sTextureMemByCategoryBound.clear() ;
 	sTextureCurMemByCategoryBound.clear() ;
@@ -329,6 +332,8 @@ S32 LLImageGL::updateBoundTexMem(const S32Bytes mem, const S32 ncomponents, S32
 //static 
 void LLImageGL::destroyGL(BOOL save_state)
 {
+	LLTextureUpload::destroyGL();
+
 	for (S32 stage = 0; stage < gGLManager.mNumTextureUnits; stage++)
 	{
 		gGL.getTexUnit(stage)->unbind(LLTexUnit::TT_TEXTURE);
@@ -699,7 +704,7 @@ void LLImageGL::setImage(const LLImageRaw* imageraw)
 }
 
 static LLTrace::BlockTimerStatHandle FTM_SET_IMAGE("setImage");
-void LLImageGL::setImage(const U8* data_in, BOOL data_hasmips)
+void LLImageGL::setImage(const U8* data_in, BOOL data_hasmips, LLTextureUpload* upload)
 {
 	LL_RECORD_BLOCK_TIME(FTM_SET_IMAGE);
 	bool is_compressed = false;
@@ -725,6 +730,13 @@ void LLImageGL::setImage(const U8* data_in, BOOL data_hasmips)
 	
 	llverify(gGL.getTexUnit(0)->bind(this));
 	
+	if (upload && !data_hasmips && !is_compressed && setStagedImage(upload, data_in))
+	{
+		stop_glerror();
+		LLTextureUpload::addFrameBytes(getMipBytes(mCurrentDiscardLevel));
+		mGLTextureCreated = true;
+		return;
+	}
 	
 	if (mUseMipMaps)
 	{
@@ -949,9 +961,69 @@ void LLImageGL::setImage(const U8* data_in, BOOL data_hasmips)
 		}
 	}
 	stop_glerror();
+	LLTextureUpload::addFrameBytes(getMipBytes(mCurrentDiscardLevel));
 	mGLTextureCreated = true;
 }
 
+static LLTrace::BlockTimerStatHandle FTM_SET_STAGED_IMAGE("setStagedImage");
+bool LLImageGL::setStagedImage(LLTextureUpload* upload, const U8* data_in)
+{
+	LL_RECORD_BLOCK_TIME(FTM_SET_STAGED_IMAGE);
+	S32 w = getWidth(mCurrentDiscardLevel);
+	S32 h = getHeight(mCurrentDiscardLevel);
+	if (mFormatSwapBytes || mFormatType != GL_UNSIGNED_BYTE
+		|| upload->getLevelWidth(0) != w || upload->getLevelHeight(0) != h)
+	{
+		return false;
+	}
+
+	// The staged mips are used when there are enough of them, otherwise only
+	// level 0 is and the GL generates the rest, as setImage() would.
+	S32 nummips = mUseMipMaps ? mMaxDiscardLevel - mCurrentDiscardLevel + 1 : 1;
+	bool staged_mips = upload->getLevels() >= nummips;
+	bool auto_mips = mUseMipMaps && !staged_mips;
+	if ((auto_mips && !mAutoGenMips) || !upload->beginUpload())
+	{
+		return false;
+	}
+
+	if (auto_mips && !LLRender::sGLCoreProfile)
+	{
+		glTexParameteri(mTarget, GL_GENERATE_MIPMAP, GL_TRUE);
+	}
+	S32 levels = auto_mips ? 1 : nummips;
+	for (S32 m = 0; m < levels; ++m)
+	{
+		LLImageGL::setManualImage(mTarget, m, mFormatInternal, upload->getLevelWidth(m), upload->getLevelHeight(m),
+								  mFormatPrimary, mFormatType, upload->getLevelPixels(m), mAllowCompression);
+		stop_glerror();
+	}
+	upload->endUpload();
+	if (auto_mips && LLRender::sGLCoreProfile)
+	{
+		glGenerateMipmap(mTarget);
+		stop_glerror();
+	}
+
+	if (!mUseMipMaps)
+	{
+		mMipLevels = 0;
+	}
+	else if (auto_mips)
+	{
+		mMipLevels = wpo2(llmax(w, h));
+	}
+	else
+	{
+		mMipLevels = nummips;
+	}
+
+	// Level 0 is the raw image itself, still readable here.
+	analyzeAlpha(data_in, w, h);
+	updatePickMask(w, h, data_in);
+	return true;
+}
+
 BOOL LLImageGL::setSubImage(const U8* datap, S32 data_width, S32 data_height, S32 x_pos, S32 y_pos, S32 width, S32 height, BOOL force_fast_update)
 {
 	if (!width || !height)
@@ -1528,7 +1600,8 @@ BOOL LLImageGL::createGLTexture()
 }
 
 static LLTrace::BlockTimerStatHandle FTM_CREATE_GL_TEXTURE2("createGLTexture(raw)");
-BOOL LLImageGL::createGLTexture(S32 discard_level, const LLImageRaw* imageraw, S32 usename/*=0*/, BOOL to_create, S32 category)
+BOOL LLImageGL::createGLTexture(S32 discard_level, const LLImageRaw* imageraw, S32 usename/*=0*/, BOOL to_create, S32 category,
+								LLTextureUpload* upload)
 {
 	LL_RECORD_BLOCK_TIME(FTM_CREATE_GL_TEXTURE2);
 	if (gGLManager.mIsDisabled)
@@ -1601,11 +1674,15 @@ BOOL LLImageGL::createGLTexture(S32 discard_level, const LLImageRaw* imageraw, S
 
 	setCategory(category);
  	const U8* rawdata = imageraw->getData();
-	return createGLTexture(discard_level, rawdata, FALSE, usename);
+	if (upload && upload->getRaw() != imageraw)
+	{
+		upload = NULL;
+	}
+	return createGLTexture(discard_level, rawdata, FALSE, usename, upload);
 }
 
 static LLTrace::BlockTimerStatHandle FTM_CREATE_GL_TEXTURE3("createGLTexture3(data)");
-BOOL LLImageGL::createGLTexture(S32 discard_level, const U8* data_in, BOOL data_hasmips, S32 usename)
+BOOL LLImageGL::createGLTexture(S32 discard_level, const U8* data_in, BOOL data_hasmips, S32 usename, LLTextureUpload* upload)
 {
 	LL_RECORD_BLOCK_TIME(FTM_CREATE_GL_TEXTURE3);
 	llassert(data_in);
@@ -1621,7 +1698,7 @@ BOOL LLImageGL::createGLTexture(S32 discard_level, const U8* data_in, BOOL data_
 	if (mTexName != 0 && discard_level == mCurrentDiscardLevel)
 	{
 		// This will only be true if the size has not changed
-		setImage(data_in, data_hasmips);
+		setImage(data_in, data_hasmips, upload);
 		return TRUE;
 	}
 	
@@ -1664,7 +1741,7 @@ BOOL LLImageGL::createGLTexture(S32 discard_level, const U8* data_in, BOOL data_
 
 	mCurrentDiscardLevel = discard_level;	
 
-	setImage(data_in, data_hasmips);
+	setImage(data_in, data_hasmips, upload);
 
 	// Set texture options to our defaults.
 	gGL.getTexUnit(0)->setHasMipMaps(mHasMipMaps);
@@ -1824,6 +1901,92 @@ void LLImageGL::deleteDeadTextures()
 		gGL.getTexUnit(0)->activate();
 	}
 }
+
+static LLTrace::BlockTimerStatHandle FTM_DOWNSCALE_GL_TEXTURE("downscale GL texture");
+BOOL LLImageGL::downscale(S32 discard_level)
+{
+	if (!gGLManager.mHasFramebufferObject || !mTexName || !mHasMipMaps || mBindTarget != LLTexUnit::TT_TEXTURE
+		|| mCurrentDiscardLevel < 0 || discard_level <= mCurrentDiscardLevel || discard_level > (S32)mMaxDiscardLevel
+		|| (mAllowCompression && sCompressTextures)
+		|| (mFormatInternal != GL_RGBA8 && mFormatInternal != GL_RGB8))
+	{
+		return FALSE;
+	}
+	LL_RECORD_BLOCK_TIME(FTM_DOWNSCALE_GL_TEXTURE);
+	stop_glerror();
+
+	// Level 0 of the new texture is level skip of the old one, and so on
+	// down to the last level createGLTexture() gave it.
+	const S32 skip = discard_level - mCurrentDiscardLevel;
+	const S32 levels = (S32)mMaxDiscardLevel - discard_level + 1;
+
+	U32 new_name = 0;
+	LLImageGL::generateTextures(1, &new_name);
+	gGL.getTexUnit(0)->bindManual(mBindTarget, new_name);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1);
+	for (S32 i = 0; i < levels; ++i)
+	{
+		glTexImage2D(GL_TEXTURE_2D, i, mFormatInternal, getWidth(discard_level + i), getHeight(discard_level + i), 0,
+					 mFormatPrimary, mFormatType, NULL);
+	}
+	gGL.getTexUnit(0)->unbind(mBindTarget);
+
+	// Blits are clipped to the scissor box like any other drawing.
+	LLGLDisable no_scissor(GL_SCISSOR_TEST);
+	U32 fbo[2];
+	glGenFramebuffers(2, fbo);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo[0]);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, fbo[1]);
+	bool success = true;
+	for (S32 i = 0; i < levels && success; ++i)
+	{
+		glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, mTexName, skip + i);
+		glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, new_name, i);
+		success = glCheckFramebufferStatus(GL_READ_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE
+			&& glCheckFramebufferStatus(GL_DRAW_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+		if (success)
+		{
+			S32 w = getWidth(discard_level + i);
+			S32 h = getHeight(discard_level + i);
+			glBlitFramebuffer(0, 0, w, h, 0, 0, w, h, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+		}
+	}
+	glBindFramebuffer(GL_FRAMEBUFFER, LLRenderTarget::sCurFBO ? LLRenderTarget::sCurFBO->getFBO() : 0);
+	glDeleteFramebuffers(2, fbo);
+	stop_glerror();
+
+	if (!success)
+	{
+		LLImageGL::deleteTextures(1, &new_name);
+		return FALSE;
+	}
+
+	if (gAuditTexture)
+	{
+		decTextureCounter(mTextureMemory, mComponents, mCategory) ;
+	}
+	sGlobalTextureMemory -= mTextureMemory;
+	LLImageGL::deleteTextures(1, &mTexName);
+	mTexName = new_name;
+	mCurrentDiscardLevel = discard_level;
+
+	// Set texture options to our defaults, as createGLTexture() does.
+	gGL.getTexUnit(0)->bind(this);
+	gGL.getTexUnit(0)->setHasMipMaps(mHasMipMaps);
+	gGL.getTexUnit(0)->setTextureAddressMode(mAddressMode);
+	gGL.getTexUnit(0)->setTextureFilteringOption(mFilterOption);
+	gGL.getTexUnit(0)->unbind(mBindTarget);
+	stop_glerror();
+
+	mTextureMemory = (S32Bytes)getMipBytes(discard_level);
+	sGlobalTextureMemory += mTextureMemory;
+	if (gAuditTexture)
+	{
+		incTextureCounter(mTextureMemory, mComponents, mCategory) ;
+	}
+	return TRUE;
+}
 		
 void LLImageGL::destroyGLTexture()
 {
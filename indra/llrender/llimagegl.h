@@ -41,6 +41,8 @@
 #define BYTES_TO_MEGA_BYTES(x) ((x) >> 20)
 #define MEGA_BYTES_TO_BYTES(x) ((x) << 20)
 
+class LLTextureUpload;
+
 //============================================================================
 class LLImageGL : public LLRefCount
 {
@@ -89,6 +91,8 @@ protected:
 	virtual ~LLImageGL();
 
 	void analyzeAlpha(const void* data_in, U32 w, U32 h);
+	// Uploads from staged pixels; false if they do not fit this texture.
+	bool setStagedImage(LLTextureUpload* upload, const U8* data_in);
 	void calcAlphaChannelOffsetAndStride();
 
 public:
@@ -101,17 +105,23 @@ public:
 	static void setManualImage(U32 target, S32 miplevel, S32 intformat, S32 width, S32 height, U32 pixformat, U32 pixtype, const void *pixels, bool allow_compression = true);
 
 	BOOL createGLTexture() ;
+	// upload, if given, holds the pixels of imageraw already staged by
+	// LLTextureUpload; it is ignored if it was staged from another image.
 	BOOL createGLTexture(S32 discard_level, const LLImageRaw* imageraw, S32 usename = 0, BOOL to_create = TRUE,
-		S32 category = sMaxCategories-1);
-	BOOL createGLTexture(S32 discard_level, const U8* data, BOOL data_hasmips = FALSE, S32 usename = 0);
+		S32 category = sMaxCategories-1, LLTextureUpload* upload = NULL);
+	BOOL createGLTexture(S32 discard_level, const U8* data, BOOL data_hasmips = FALSE, S32 usename = 0,
+		LLTextureUpload* upload = NULL);
 	void setImage(const LLImageRaw* imageraw);
-	void setImage(const U8* data_in, BOOL data_hasmips = FALSE);
+	void setImage(const U8* data_in, BOOL data_hasmips = FALSE, LLTextureUpload* upload = NULL);
 	BOOL setSubImage(const LLImageRaw* imageraw, S32 x_pos, S32 y_pos, S32 width, S32 height, BOOL force_fast_update = FALSE);
 	BOOL setSubImage(const U8* datap, S32 data_width, S32 data_height, S32 x_pos, S32 y_pos, S32 width, S32 height, BOOL force_fast_update = FALSE);
 	BOOL setSubImageFromFrameBuffer(S32 fb_x, S32 fb_y, S32 x_pos, S32 y_pos, S32 width, S32 height);
 
 	// Read back a raw image for this discard level, if it exists
 	BOOL readBackRaw(S32 discard_level, LLImageRaw* imageraw, bool compressed_ok); 
+	// Replaces the texture with a coarser one copied from its own mip chain
+	// on the GPU.  FALSE if it has no mips or a format that can't be blitted.
+	BOOL downscale(S32 discard_level);
 	void destroyGLTexture();
 	void forceToInvalidateGLTexture();
 
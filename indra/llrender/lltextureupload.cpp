@@ -0,0 +1,485 @@
+/**
+ * @file lltextureupload.cpp
+ * @brief Texture pixels staged for upload by a worker thread
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+
+#include "linden_common.h"
+
+#include "lltextureupload.h"
+
+#include "llfasttimer.h"
+#include "llgl.h"
+#include "llglheaders.h"
+#include "llimage.h"
+#include "llmutex.h"
+#include "lltimer.h"
+#include "llworkerpool.h"
+
+#include <boost/bind.hpp>
+#include <new>
+#include <set>
+
+static LLTrace::BlockTimerStatHandle FTM_TEXTURE_UPLOAD_STAGE("Stage Texture Upload");
+static LLTrace::BlockTimerStatHandle FTM_TEXTURE_UPLOAD_STALL("Texture Upload Stall");
+
+// Recycled staging memory kept between uploads.
+static const U32 MAX_FREE_HEAP_BUFFERS = 8;
+// Pixel buffers alive at once, mapped or waiting for reuse.
+static const U32 MAX_PIXEL_BUFFERS = 16;
+
+bool LLTextureUpload::sEnabled = true;
+U32 LLTextureUpload::sFrameBudget = 4096 * 1024;
+U32 LLTextureUpload::sFrameBytes = 0;
+U32 LLTextureUpload::sLastFrameBytes = 0;
+F32 LLTextureUpload::sFrameStall = 0.f;
+F32 LLTextureUpload::sLastFrameStall = 0.f;
+
+// Decides which of the pool job and wait() stages an upload.  The job only
+// holds the ticket: it cannot keep the upload alive, since the last reference
+// must not be dropped on a worker, and once wait() has taken over the upload
+// may be gone by the time the job runs.
+class LLTextureUpload::Ticket : public LLThreadSafeRefCount
+{
+public:
+	Ticket(LLTextureUpload* upload)
+	:	mUpload(upload),
+		mClaimed(0)
+	{
+	}
+
+	// True for the first caller only.
+	bool claim()
+	{
+		S32 expected = 0;
+		return mClaimed.compare_exchange_strong(expected, 1);
+	}
+
+	LLTextureUpload* const mUpload;
+
+private:
+	LLAtomicS32 mClaimed;
+};
+
+namespace
+{
+	typedef std::pair<U32, U8*> heap_buffer_t;
+	typedef std::pair<U32, U32> pixel_buffer_t;		// size, GL name
+
+	// Main thread only, except sCondition.
+	std::vector<LLPointer<LLTextureUpload> > sInFlight;
+	std::set<LLTextureUpload*> sMapped;
+	std::vector<heap_buffer_t> sFreeHeap;
+	std::vector<pixel_buffer_t> sFreePixelBuffers;
+	U32 sPixelBufferCount = 0;
+
+	// Signalled whenever an upload becomes ready.
+	LLCondition* sCondition = NULL;
+
+	LLCondition* getCondition()
+	{
+		if (!sCondition)
+		{
+			sCondition = new LLCondition();
+		}
+		return sCondition;
+	}
+
+	// Reuses a free buffer no more than twice the size asked for.
+	template<typename T>
+	bool take_free(std::vector<std::pair<U32, T> >& free_list, U32 size, std::pair<U32, T>& out)
+	{
+		for (typename std::vector<std::pair<U32, T> >::iterator it = free_list.begin(); it != free_list.end(); ++it)
+		{
+			if (it->first >= size && it->first <= size * 2)
+			{
+				out = *it;
+				free_list.erase(it);
+				return true;
+			}
+		}
+		return false;
+	}
+}
+
+// static
+LLPointer<LLTextureUpload> LLTextureUpload::stage(LLImageRaw* raw, bool mipmaps)
+{
+	if (!sEnabled || !raw || raw->isBufferInvalid() || !raw->getData())
+	{
+		return NULL;
+	}
+	S32 comps = raw->getComponents();
+	bool cpu_mips = mipmaps && !gGLManager.mHasMipMapGeneration;
+	bool pixel_buffer = gGLManager.mHasVertexBufferObject && gGLManager.mHasPixelBufferObject
+		&& (comps == 3 || comps == 4)
+		&& (sPixelBufferCount < MAX_PIXEL_BUFFERS || !sFreePixelBuffers.empty());
+	if (!cpu_mips && !pixel_buffer)
+	{
+		// Nothing a worker could do ahead of time.
+		return NULL;
+	}
+
+	LL_RECORD_BLOCK_TIME(FTM_TEXTURE_UPLOAD_STAGE);
+
+	LLPointer<LLTextureUpload> upload = new LLTextureUpload(raw);
+	S32 w = raw->getWidth();
+	S32 h = raw->getHeight();
+	S32 num_levels = cpu_mips ? MAX_DISCARD_LEVEL + 1 : 1;
+	for (S32 i = 0; i < num_levels; ++i)
+	{
+		Level level;
+		level.mWidth = w;
+		level.mHeight = h;
+		level.mOffset = 0;
+		upload->mLevels.push_back(level);
+		if (w <= 1 || h <= 1)
+		{
+			break;
+		}
+		w >>= 1;
+		h >>= 1;
+	}
+
+	if (!pixel_buffer && upload->getLevels() < 2)
+	{
+		return NULL;
+	}
+	upload->allocate(pixel_buffer);
+	if (!upload->mData && pixel_buffer && cpu_mips && upload->getLevels() > 1)
+	{
+		upload->allocate(false);
+	}
+	if (!upload->mData)
+	{
+		return NULL;
+	}
+
+	sInFlight.push_back(upload);
+	upload->mTicket = new Ticket(upload);
+	LLWorkerPool::getDefault()->post(boost::bind(&LLTextureUpload::runTicket, upload->mTicket));
+	return upload;
+}
+
+LLTextureUpload::LLTextureUpload(LLImageRaw* raw)
+:	mRaw(raw),
+	mSize(0),
+	mBuffer(0),
+	mBufferSize(0),
+	mData(NULL),
+	mHeapLevel0(false),
+	mState(STATE_PENDING)
+{
+}
+
+LLTextureUpload::~LLTextureUpload()
+{
+	release();
+}
+
+U32 LLTextureUpload::getLevelBytes(S32 level) const
+{
+	return (U32)(mLevels[level].mWidth * mLevels[level].mHeight * mRaw->getComponents());
+}
+
+void LLTextureUpload::allocate(bool pixel_buffer)
+{
+	// A heap buffer only holds the mips; level 0 is read from the raw image.
+	mHeapLevel0 = !pixel_buffer;
+	U32 offset = 0;
+	for (S32 i = 0; i < getLevels(); ++i)
+	{
+		if (i == 0 && mHeapLevel0)
+		{
+			continue;
+		}
+		mLevels[i].mOffset = offset;
+		offset += getLevelBytes(i);
+	}
+	mSize = offset;
+
+	if (pixel_buffer)
+	{
+		pixel_buffer_t buffer;
+		if (!take_free(sFreePixelBuffers, mSize, buffer))
+		{
+			if (sPixelBufferCount >= MAX_PIXEL_BUFFERS)
+			{
+				// Every buffer is taken and the free ones are the wrong size.
+				glDeleteBuffersARB(1, &sFreePixelBuffers.back().second);
+				sFreePixelBuffers.pop_back();
+				--sPixelBufferCount;
+			}
+			buffer.first = mSize;
+			glGenBuffersARB(1, &buffer.second);
+			++sPixelBufferCount;
+		}
+		glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, buffer.second);
+		// Orphan the previous contents so that mapping does not wait for the
+		// upload that last used them.
+		glBufferDataARB(GL_PIXEL_UNPACK_BUFFER_ARB, buffer.first, NULL, GL_STREAM_DRAW_ARB);
+		mData = (U8*)glMapBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, GL_WRITE_ONLY_ARB);
+		glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, 0);
+		mBuffer = buffer.second;
+		mBufferSize = buffer.first;
+		sMapped.insert(this);
+		if (!mData)
+		{
+			release();
+		}
+	}
+	else
+	{
+		heap_buffer_t buffer;
+		if (!take_free(sFreeHeap, mSize, buffer))
+		{
+			buffer.first = mSize;
+			buffer.second = new (std::nothrow) U8[mSize];
+		}
+		mData = buffer.second;
+		mBufferSize = buffer.first;
+	}
+}
+
+void LLTextureUpload::release()
+{
+	if (mBuffer)
+	{
+		if (mData)
+		{
+			glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, mBuffer);
+			glUnmapBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB);
+			glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, 0);
+		}
+		sFreePixelBuffers.push_back(pixel_buffer_t(mBufferSize, mBuffer));
+		sMapped.erase(this);
+	}
+	else if (mData)
+	{
+		if (sFreeHeap.size() < MAX_FREE_HEAP_BUFFERS)
+		{
+			sFreeHeap.push_back(heap_buffer_t(mBufferSize, mData));
+		}
+		else
+		{
+			delete[] mData;
+		}
+	}
+	mBuffer = 0;
+	mBufferSize = 0;
+	mData = NULL;
+}
+
+// static
+void LLTextureUpload::runTicket(LLPointer<Ticket> ticket)
+{
+	if (ticket->claim())
+	{
+		// sInFlight holds a reference until the upload is ready.
+		prepare(ticket->mUpload);
+	}
+}
+
+// static
+void LLTextureUpload::prepare(LLTextureUpload* upload)
+{
+	const U8* src = upload->mRaw->getData();
+	S32 comps = upload->mRaw->getComponents();
+	S32 levels = upload->getLevels();
+	if (upload->mHeapLevel0)
+	{
+		for (S32 i = 1; i < levels; ++i)
+		{
+			U8* dst = upload->mData + upload->mLevels[i].mOffset;
+			LLImageBase::generateMip(src, dst, upload->mLevels[i].mWidth, upload->mLevels[i].mHeight, comps);
+			src = dst;
+		}
+	}
+	else
+	{
+		// The mapped buffer may be write-combined, too slow to read the
+		// previous level back from.
+		memcpy(upload->mData, src, upload->getLevelBytes(0));
+		if (levels > 1)
+		{
+			U32 mips_size = upload->mSize - upload->getLevelBytes(0);
+			std::vector<U8> scratch(mips_size);
+			U32 base = upload->mLevels[1].mOffset;
+			for (S32 i = 1; i < levels; ++i)
+			{
+				U8* dst = &scratch[upload->mLevels[i].mOffset - base];
+				LLImageBase::generateMip(src, dst, upload->mLevels[i].mWidth, upload->mLevels[i].mHeight, comps);
+				src = dst;
+			}
+			memcpy(upload->mData + base, &scratch[0], mips_size);
+		}
+	}
+
+	LLCondition* condition = getCondition();
+	condition->lock();
+	upload->mState = STATE_READY;
+	condition->broadcast();
+	condition->unlock();
+}
+
+void LLTextureUpload::wait()
+{
+	if (isReady())
+	{
+		return;
+	}
+	LL_RECORD_BLOCK_TIME(FTM_TEXTURE_UPLOAD_STALL);
+	F64 start = LLTimer::getTotalSeconds();
+	if (mTicket->claim())
+	{
+		// Still queued; the job will find the ticket taken.
+		prepare(this);
+	}
+	else
+	{
+		LLCondition* condition = getCondition();
+		condition->lock();
+		while (!isReady())
+		{
+			condition->wait();
+		}
+		condition->unlock();
+	}
+	sFrameStall += (F32)(LLTimer::getTotalSeconds() - start);
+}
+
+bool LLTextureUpload::beginUpload()
+{
+	wait();
+	if (!mData)
+	{
+		// Dropped with the GL context.
+		return false;
+	}
+	if (mBuffer)
+	{
+		glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, mBuffer);
+		mData = NULL;
+		if (!glUnmapBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB))
+		{
+			// The contents were lost while mapped (mode switch and the like).
+			glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, 0);
+			release();
+			return false;
+		}
+	}
+	return true;
+}
+
+const void* LLTextureUpload::getLevelPixels(S32 level) const
+{
+	if (mBuffer)
+	{
+		return (const void*)(uintptr_t)mLevels[level].mOffset;
+	}
+	if (level == 0 && mHeapLevel0)
+	{
+		return mRaw->getData();
+	}
+	return mData + mLevels[level].mOffset;
+}
+
+void LLTextureUpload::endUpload()
+{
+	if (mBuffer)
+	{
+		glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, 0);
+	}
+	release();
+}
+
+// static
+void LLTextureUpload::newFrame()
+{
+	sLastFrameBytes = sFrameBytes;
+	sLastFrameStall = sFrameStall;
+	sFrameBytes = 0;
+	sFrameStall = 0.f;
+
+	for (std::vector<LLPointer<LLTextureUpload> >::iterator it = sInFlight.begin(); it != sInFlight.end();)
+	{
+		if ((*it)->isReady())
+		{
+			it = sInFlight.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
+}
+
+// static
+void LLTextureUpload::destroyGL()
+{
+	for (std::vector<LLPointer<LLTextureUpload> >::iterator it = sInFlight.begin(); it != sInFlight.end(); ++it)
+	{
+		(*it)->wait();
+	}
+	sInFlight.clear();
+
+	// Names are only returned to the free list by release(), so everything
+	// mapped has to be gathered first.
+	std::set<LLTextureUpload*> mapped;
+	mapped.swap(sMapped);
+	for (std::set<LLTextureUpload*>::iterator it = mapped.begin(); it != mapped.end(); ++it)
+	{
+		LLTextureUpload* upload = *it;
+		if (upload->mData)
+		{
+			glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, upload->mBuffer);
+			glUnmapBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB);
+		}
+		glDeleteBuffersARB(1, &upload->mBuffer);
+		upload->mBuffer = 0;
+		upload->mBufferSize = 0;
+		upload->mData = NULL;
+	}
+	glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, 0);
+
+	for (std::vector<pixel_buffer_t>::iterator it = sFreePixelBuffers.begin(); it != sFreePixelBuffers.end(); ++it)
+	{
+		glDeleteBuffersARB(1, &it->second);
+	}
+	sFreePixelBuffers.clear();
+	sPixelBufferCount = 0;
+}
+
+// static
+void LLTextureUpload::cleanupClass()
+{
+	destroyGL();
+	for (std::vector<heap_buffer_t>::iterator it = sFreeHeap.begin(); it != sFreeHeap.end(); ++it)
+	{
+		delete[] it->second;
+	}
+	sFreeHeap.clear();
+	delete sCondition;
+	sCondition = NULL;
+}
@@ -0,0 +1,140 @@
+/**
+ * @file lltextureupload.h
+ * @brief Texture pixels staged for upload by a worker thread
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+
+#ifndef LL_LLTEXTUREUPLOAD_H
+#define LL_LLTEXTUREUPLOAD_H
+
+#include "llatomic.h"
+#include "llpointer.h"
+#include "llrefcount.h"
+
+#include <vector>
+
+class LLImageRaw;
+
+// The pixels of one LLImageRaw, with the mip chain LLImageGL would
+// otherwise build inline, copied into staging memory by a worker thread
+// before the texture is created.  The staging memory is a pixel buffer
+// object when the GL has them, so that glTexImage2D() returns without
+// copying and the transfer overlaps the frame.  Otherwise it is a recycled
+// heap buffer, which only helps when the mips are built on the CPU.
+//
+// LLImageGL::createGLTexture() takes an upload and uses it if it still
+// matches the raw image.  The class statics count the bytes LLImageGL
+// uploads each frame against a budget, and the time the main thread spent
+// waiting for uploads that were not ready.
+class LLTextureUpload : public LLThreadSafeRefCount
+{
+public:
+	// Starts staging raw on the default LLWorkerPool, with its mips when
+	// mipmaps is set and the GL cannot generate them.  Returns NULL when
+	// staging is off or would not help.  Main thread only; raw must not be
+	// changed while the upload is pending.
+	static LLPointer<LLTextureUpload> stage(LLImageRaw* raw, bool mipmaps);
+
+	bool isReady() const					{ return mState != STATE_PENDING; }
+	// Blocks until the worker is done, counting the wait as a stall.  If no
+	// worker has started yet, stages the pixels on the calling thread
+	// instead, so it never waits behind other jobs on the pool.
+	void wait();
+
+	const LLImageRaw* getRaw() const		{ return mRaw; }
+	// Levels staged, level 0 being the size of the raw image.
+	S32 getLevels() const					{ return (S32)mLevels.size(); }
+	S32 getLevelWidth(S32 level) const		{ return mLevels[level].mWidth; }
+	S32 getLevelHeight(S32 level) const		{ return mLevels[level].mHeight; }
+
+	// GL thread.  Waits, then makes the staged pixels available to
+	// glTexImage2D().  Returns false if they were lost with the GL context,
+	// in which case the raw image has to be uploaded instead.
+	bool beginUpload();
+	// What to pass glTexImage2D() for a level: an offset into the bound
+	// pixel buffer, or a pointer.
+	const void* getLevelPixels(S32 level) const;
+	// Unbinds and recycles the staging memory.
+	void endUpload();
+
+	// Called once a frame, before textures are created.
+	static void newFrame();
+	// Counts every texture upload, staged or not, against the frame.
+	static void addFrameBytes(U32 bytes)	{ sFrameBytes += bytes; }
+	static bool hasFrameBudget()			{ return sFrameBytes < sFrameBudget; }
+	static U32 getLastFrameBytes()			{ return sLastFrameBytes; }
+	static F32 getLastFrameStallMS()		{ return sLastFrameStall * 1000.f; }
+
+	// Waits for the workers and drops every pixel buffer; uploads staged in
+	// one fall back to their raw image.
+	static void destroyGL();
+	// Must run before LLWorkerPool::cleanupDefault().
+	static void cleanupClass();
+
+	static bool	sEnabled;
+	static U32	sFrameBudget;				// bytes a frame
+
+protected:
+	LLTextureUpload(LLImageRaw* raw);
+	~LLTextureUpload();
+
+private:
+	class Ticket;
+
+	struct Level
+	{
+		S32	mWidth;
+		S32	mHeight;
+		U32	mOffset;						// into the staging memory
+	};
+
+	enum
+	{
+		STATE_PENDING,
+		STATE_READY
+	};
+
+	static void runTicket(LLPointer<Ticket> ticket);
+	static void prepare(LLTextureUpload* upload);
+	void allocate(bool pixel_buffer);
+	void release();
+	U32 getLevelBytes(S32 level) const;
+
+	LLPointer<LLImageRaw>	mRaw;
+	std::vector<Level>		mLevels;
+	U32						mSize;
+	U32						mBuffer;		// pixel buffer object, or 0
+	U32						mBufferSize;
+	U8*						mData;			// mapped buffer or heap memory
+	bool					mHeapLevel0;	// level 0 read straight from the raw image
+	LLAtomicS32				mState;
+	LLPointer<Ticket>		mTicket;		// shared with the pool job
+
+	static U32	sFrameBytes;
+	static U32	sLastFrameBytes;
+	static F32	sFrameStall;
+	static F32	sLastFrameStall;
+};
+
+#endif // LL_LLTEXTUREUPLOAD_H
@@ -60,6 +60,36 @@ static LLRegisterWidget<LLScrollListCtrl> r("scroll_list");
 LLMenuGL* sScrollListMenus[1] = {}; // List menus that recur, such as general avatars or groups menus
 
 // local structures & classes.
+
+// Sort keys are pulled out of the items once per sort instead of once per
+// comparison, and without building deferred cells.
+struct LLScrollListSortEntry
+{
+	LLScrollListItem*			mItem;
+	std::vector<std::string>	mKeys;		// per sort column; empty when sorting through a sort signal
+	std::vector<bool>			mHasKey;	// per sort column
+};
+
+static void fill_sort_entry(LLScrollListSortEntry& entry, LLScrollListItem* item, const std::vector<std::pair<S32, BOOL> >& sort_columns, bool use_sort_signal)
+{
+	const S32 num_keys = sort_columns.size();
+	entry.mItem = item;
+	entry.mHasKey.resize(num_keys);
+	if (!use_sort_signal)
+	{
+		entry.mKeys.resize(num_keys);
+	}
+	for (S32 k = 0; k < num_keys; ++k)
+	{
+		S32 col_idx = sort_columns[k].first;
+		entry.mHasKey[k] = item->hasColumn(col_idx);
+		if (entry.mHasKey[k] && !use_sort_signal)
+		{
+			entry.mKeys[k] = item->getColumnValue(col_idx).asString();
+		}
+	}
+}
+
 struct SortScrollListItem
 {
 	SortScrollListItem(const std::vector<std::pair<S32, BOOL> >& sort_orders,const LLScrollListCtrl::sort_signal_t*	sort_signal)
@@ -67,29 +97,26 @@ struct SortScrollListItem
 	,   mSortSignal(sort_signal)
 	{}
 
-	bool operator()(const LLScrollListItem* i1, const LLScrollListItem* i2)
+	bool operator()(const LLScrollListSortEntry* e1, const LLScrollListSortEntry* e2) const
 	{
 		// sort over all columns in order specified by mSortOrders
 		S32 sort_result = 0;
-		for (sort_order_t::const_reverse_iterator it = mSortOrders.rbegin();
-			 it != mSortOrders.rend(); ++it)
+		for (S32 i = (S32)mSortOrders.size() - 1; i >= 0; --i)
 		{
-			S32 col_idx = it->first;
-			BOOL sort_ascending = it->second;
+			S32 col_idx = mSortOrders[i].first;
+			BOOL sort_ascending = mSortOrders[i].second;
 
 			S32 order = sort_ascending ? 1 : -1; // ascending or descending sort for this column?
 
-			const LLScrollListCell *cell1 = i1->getColumn(col_idx);
-			const LLScrollListCell *cell2 = i2->getColumn(col_idx);
-			if (cell1 && cell2)
+			if (e1->mHasKey[i] && e2->mHasKey[i])
 			{
 				if(mSortSignal)
 				{
-					sort_result = order * (*mSortSignal)(col_idx,i1, i2);
+					sort_result = order * (*mSortSignal)(col_idx, e1->mItem, e2->mItem);
 				}
 				else
 				{
-					sort_result = order * LLStringUtil::compareDict(cell1->getValue().asString(), cell2->getValue().asString());
+					sort_result = order * LLStringUtil::compareDict(e1->mKeys[i], e2->mKeys[i]);
 				}
 				if (sort_result != 0)
 				{
@@ -140,6 +167,10 @@ LLScrollListCtrl::LLScrollListCtrl(const std::string& name, const LLRect& rect,
 	mTotalStaticColumnWidth(0),
 	mTotalColumnPadding(0),
 	mSorted(true),
+	mBulkAddDepth(0),
+	mBulkSortPending(false),
+	mFirstColumnOrdered(true),
+	mVirtualized(false),
 	mDirty(false),
 	mOriginalSelection(-1),
 	mLastSelected(NULL),
@@ -257,6 +288,7 @@ void LLScrollListCtrl::clearRows()
 {
 	std::for_each(mItemList.begin(), mItemList.end(), DeletePointer());
 	mItemList.clear();
+	mFirstColumnOrdered = true;
 	//mItemCount = 0;
 
 	// Scroll the bar back up to the top.
@@ -496,17 +528,22 @@ BOOL LLScrollListCtrl::addItem( LLScrollListItem* item, EAddPosition pos, BOOL r
 		{
 		case ADD_TOP:
 			mItemList.push_front(item);
+			mFirstColumnOrdered = false;
 			setNeedsSort();
 			break;
 	
 		case ADD_SORTED:
 			{
-				// sort by column 0, in ascending order
-				std::vector<sort_column_t> single_sort_column;
-				single_sort_column.push_back(std::make_pair(0, TRUE));
-
-				mItemList.push_back(item);
-				std::stable_sort(mItemList.begin(), mItemList.end(), SortScrollListItem(single_sort_column,mSortCallback));
+				if (mBulkAddDepth > 0)
+				{
+					// sorted once in endBulkAdd()
+					mItemList.push_back(item);
+					mBulkSortPending = true;
+				}
+				else
+				{
+					insertSorted(item);
+				}
 
 				// ADD_SORTED just sorts by first column...
 				// this might not match user sort criteria, so flag list as being in unsorted state
@@ -515,12 +552,14 @@ BOOL LLScrollListCtrl::addItem( LLScrollListItem* item, EAddPosition pos, BOOL r
 			}
 		case ADD_BOTTOM:
 			mItemList.push_back(item);
+			mFirstColumnOrdered = false;
 			setNeedsSort();
 			break;
 	
 		default:
 			llassert(0);
 			mItemList.push_back(item);
+			mFirstColumnOrdered = false;
 			setNeedsSort();
 			break;
 		}
@@ -535,18 +574,23 @@ BOOL LLScrollListCtrl::addItem( LLScrollListItem* item, EAddPosition pos, BOOL r
 			addColumn(col_params);
 		}
 
-		S32 num_cols = item->getNumColumns();
-		S32 i = 0;
-		for (LLScrollListCell* cell = item->getColumn(i); i < num_cols; cell = item->getColumn(++i))
+		S32 num_cols = llmin(item->getNumColumns(), (S32)mColumnsIndexed.size());
+		for (S32 i = 0; i < num_cols; ++i)
 		{
-			if (i >= (S32)mColumnsIndexed.size()) break;
-
-			cell->setWidth(mColumnsIndexed[i]->getWidth());
+			item->setColumnWidth(i, mColumnsIndexed[i]->getWidth());
 		}
 
+		if (!mLineHeight)
+		{
+			// need one real row to know how tall rows are
+			item->buildColumns();
+		}
 		updateLineHeightInsert(item);
 
-		updateLayout();
+		if (!mBulkAddDepth)
+		{
+			updateLayout();
+		}
 	}
 
 	return not_too_big;
@@ -575,10 +619,10 @@ S32 LLScrollListCtrl::calcMaxContentWidth()
 			item_list::iterator iter;
 			for (iter = mItemList.begin(); iter != mItemList.end(); iter++)
 			{
-				LLScrollListCell* cellp = (*iter)->getColumn(column->mIndex);
-				if (!cellp) continue;
+				LLScrollListItem* itemp = *iter;
+				if (!itemp->hasColumn(column->mIndex)) continue;
 
-				column->mMaxContentWidth = llmax(LLFontGL::getFontSansSerifSmall()->getWidth(cellp->getValue().asString()) + mColumnPadding + COLUMN_TEXT_PADDING, column->mMaxContentWidth);
+				column->mMaxContentWidth = llmax(LLFontGL::getFontSansSerifSmall()->getWidth(itemp->getColumnValue(column->mIndex).asString()) + mColumnPadding + COLUMN_TEXT_PADDING, column->mMaxContentWidth);
 			}
 		}
 		max_item_width += column->mMaxContentWidth;
@@ -631,13 +675,7 @@ void LLScrollListCtrl::updateLineHeight()
 	item_list::iterator iter;
 	for (iter = mItemList.begin(); iter != mItemList.end(); iter++)
 	{
-		LLScrollListItem *itemp = *iter;
-		S32 num_cols = itemp->getNumColumns();
-		S32 i = 0;
-		for (const LLScrollListCell* cell = itemp->getColumn(i); i < num_cols; cell = itemp->getColumn(++i))
-		{
-			mLineHeight = llmax( mLineHeight, cell->getHeight() + SCROLL_LIST_ROW_PAD );
-		}
+		updateLineHeightInsert(*iter);
 	}
 }
 
@@ -645,10 +683,12 @@ void LLScrollListCtrl::updateLineHeight()
 void LLScrollListCtrl::updateLineHeightInsert(LLScrollListItem* itemp)
 {
 	S32 num_cols = itemp->getNumColumns();
-	S32 i = 0;
-	for (const LLScrollListCell* cell = itemp->getColumn(i); i < num_cols; cell = itemp->getColumn(++i))
+	for (S32 i = 0; i < num_cols; ++i)
 	{
-		mLineHeight = llmax( mLineHeight, cell->getHeight() + SCROLL_LIST_ROW_PAD );
+		// deferred cells are measured when their row is first drawn
+		if (!itemp->isColumnBuilt(i)) continue;
+
+		mLineHeight = llmax( mLineHeight, itemp->getColumn(i)->getHeight() + SCROLL_LIST_ROW_PAD );
 	}
 }
 
@@ -715,13 +755,10 @@ void LLScrollListCtrl::updateColumns(bool force_update)
 		for (iter = mItemList.begin(); iter != mItemList.end(); iter++)
 		{
 			LLScrollListItem *itemp = *iter;
-			S32 num_cols = itemp->getNumColumns();
-			S32 i = 0;
-			for (LLScrollListCell* cell = itemp->getColumn(i); i < num_cols; cell = itemp->getColumn(++i))
+			S32 num_cols = llmin(itemp->getNumColumns(), (S32)mColumnsIndexed.size());
+			for (S32 i = 0; i < num_cols; ++i)
 			{
-				if (i >= (S32)mColumnsIndexed.size()) break;
-
-				cell->setWidth(mColumnsIndexed[i]->getWidth());
+				itemp->setColumnWidth(i, mColumnsIndexed[i]->getWidth());
 			}
 		}
 	}
@@ -846,6 +883,7 @@ void LLScrollListCtrl::swapWithNext(S32 index)
 		return;
 	}
 	updateSort();
+	mFirstColumnOrdered = false;
 	LLScrollListItem *cur_itemp = mItemList[index];
 	mItemList[index] = mItemList[index + 1];
 	mItemList[index + 1] = cur_itemp;
@@ -861,6 +899,7 @@ void LLScrollListCtrl::swapWithPrevious(S32 index)
 	}
 
 	updateSort();
+	mFirstColumnOrdered = false;
 	LLScrollListItem *cur_itemp = mItemList[index];
 	mItemList[index] = mItemList[index - 1];
 	mItemList[index - 1] = cur_itemp;
@@ -877,6 +916,7 @@ void LLScrollListCtrl::moveToFront(S32 index)
 	std::advance(it,index);
 	mItemList.push_front(*it);
 	mItemList.erase(it);
+	mFirstColumnOrdered = false;
 }
 
 void LLScrollListCtrl::deleteSingleItem(S32 target_index)
@@ -1180,7 +1220,7 @@ LLScrollListItem* LLScrollListCtrl::getItemByLabel(const std::string& label, BOO
 	for (iter = mItemList.begin(); iter != mItemList.end(); iter++)
 	{
 		LLScrollListItem* item = *iter;
-		std::string item_text = item->getColumn(column)->getValue().asString();	// Only select enabled items with matching names
+		std::string item_text = item->getColumnValue(column).asString();	// Only select enabled items with matching names
 		if (!case_sensitive)
 		{
 			LLStringUtil::toLower(item_text);
@@ -1239,12 +1279,12 @@ BOOL LLScrollListCtrl::selectItemByPrefix(const LLWString& target, BOOL case_sen
 			LLScrollListItem* item = *iter;
 
 			// Only select enabled items with matching names
-			LLScrollListCell* cellp = item->getColumn(getSearchColumn());
-			if (!cellp)
+			S32 search_column = getSearchColumn();
+			if (!item->hasColumn(search_column))
 			{
 				continue;
 			}
-			LLWString item_label = utf8str_to_wstring(cellp->getValue().asString());
+			LLWString item_label = utf8str_to_wstring(item->getColumnValue(search_column).asString());
 			if (!case_sensitive)
 			{
 				LLWStringUtil::toLower(item_label);
@@ -1259,7 +1299,7 @@ BOOL LLScrollListCtrl::selectItemByPrefix(const LLWString& target, BOOL case_sen
 			{
 				// find offset of matching text (might have leading whitespace)
 				S32 offset = item_label.find(target_trimmed);
-				cellp->highlightText(offset, target_trimmed.size());
+				item->getColumn(search_column)->highlightText(offset, target_trimmed.size());
 				selectItem(item);
 				found = TRUE;
 				break;
@@ -1409,16 +1449,27 @@ void LLScrollListCtrl::drawItems()
 		highlight_color.mV[VALPHA] = clamp_rescale(mSearchTimer.getElapsedTimeF32(), type_ahead_timeout * 0.7f, type_ahead_timeout, 0.4f, 0.f);
 
 		S32 first_line = mScrollLines;
-		S32 last_line = llmin((S32)mItemList.size() - 1, mScrollLines + getLinesPerPage());
-
 		if ((item_list::size_type)first_line >= mItemList.size())
 		{
 			return;
 		}
+
+		if (!mLineHeight)
+		{
+			// rows so far are all deferred; measure one before paging
+			showRow(mItemList[first_line]);
+			y = mItemListRect.mTop - mLineHeight;
+			cur_y = y;
+			num_page_lines = getLinesPerPage();
+		}
+
+		S32 last_line = llmin((S32)mItemList.size() - 1, mScrollLines + getLinesPerPage());
+
 		item_list::iterator iter;
 		for (S32 line = first_line; line <= last_line; line++)
 		{
 			LLScrollListItem* item = mItemList[line];
+			showRow(item);
 			
 			item_rect.setOriginAndSize( 
 				x, 
@@ -1468,6 +1519,23 @@ void LLScrollListCtrl::drawItems()
 }
 
 
+void LLScrollListCtrl::showRow(LLScrollListItem* item)
+{
+	if (!item->mShown)
+	{
+		item->mShown = true;
+		if (mOnRowShownCallback)
+		{
+			mOnRowShownCallback(item);
+		}
+	}
+	if (!item->mPendingColumns.empty())
+	{
+		item->buildColumns();
+		updateLineHeightInsert(item);
+	}
+}
+
 void LLScrollListCtrl::draw()
 {
 	LLLocalClipRect clip(getLocalRect());
@@ -1845,22 +1913,18 @@ LLScrollListItem* LLScrollListCtrl::hitItem( S32 x, S32 y )
 	// allow for partial line at bottom
 	S32 num_page_lines = getLinesPerPage();
 
-	S32 line = 0;
-	item_list::iterator iter;
-	for(iter = mItemList.begin(); iter != mItemList.end(); iter++)
+	// only the visible page can be hit
+	S32 last_line = llmin((S32)mItemList.size(), mScrollLines + num_page_lines);
+	for (S32 line = llmax(mScrollLines, 0); line < last_line; line++)
 	{
-		LLScrollListItem* item  = *iter;
-		if( mScrollLines <= line && line < mScrollLines + num_page_lines )
+		LLScrollListItem* item  = mItemList[line];
+		if( item->getEnabled() && item_rect.pointInRect( x, y ) )
 		{
-			if( item->getEnabled() && item_rect.pointInRect( x, y ) )
-			{
-				hit_item = item;
-				break;
-			}
-
-			item_rect.translate(0, -mLineHeight);
+			hit_item = item;
+			break;
 		}
-		line++;
+
+		item_rect.translate(0, -mLineHeight);
 	}
 
 	return hit_item;
@@ -2342,16 +2406,109 @@ void LLScrollListCtrl::updateSort() const
 {
 	if (hasSortOrder() && !isSorted())
 	{
-		// do stable sort to preserve any previous sorts
-		std::stable_sort(
-			mItemList.begin(), 
-			mItemList.end(), 
-			SortScrollListItem(mSortColumns,mSortCallback));
+		sortItems(mSortColumns);
 
 		mSorted = true;
 	}
 }
 
+static LLTrace::BlockTimerStatHandle FTM_SORT_SCROLL_LIST("Sort Scroll List");
+
+// Stable sort of mItemList, equivalent to a std::stable_sort over the whole
+// list but cheap in the common case of a few rows appended to a list that
+// was already in order.
+void LLScrollListCtrl::sortItems(const std::vector<sort_column_t>& sort_columns) const
+{
+	LL_RECORD_BLOCK_TIME(FTM_SORT_SCROLL_LIST);
+
+	// the last sort column is the primary one
+	mFirstColumnOrdered = !sort_columns.empty() && sort_columns.back() == sort_column_t(0, TRUE);
+
+	const S32 count = mItemList.size();
+	if (count < 2)
+	{
+		return;
+	}
+
+	std::vector<LLScrollListSortEntry> entries(count);
+	std::vector<const LLScrollListSortEntry*> order(count);
+	for (S32 i = 0; i < count; ++i)
+	{
+		fill_sort_entry(entries[i], mItemList[i], sort_columns, mSortCallback != NULL);
+		order[i] = &entries[i];
+	}
+
+	SortScrollListItem comparator(sort_columns, mSortCallback);
+
+	// length of the already ordered run at the front
+	S32 sorted_run = 1;
+	while (sorted_run < count && !comparator(order[sorted_run], order[sorted_run - 1]))
+	{
+		++sorted_run;
+	}
+	if (sorted_run == count)
+	{
+		return;
+	}
+
+	// sort the rest and merge; both steps are stable, and elements of the
+	// front run win ties, as they would in a full stable sort
+	std::stable_sort(order.begin() + sorted_run, order.end(), comparator);
+	std::inplace_merge(order.begin(), order.begin() + sorted_run, order.end(), comparator);
+
+	for (S32 i = 0; i < count; ++i)
+	{
+		mItemList[i] = order[i]->mItem;
+	}
+}
+
+// ADD_SORTED sorts by column 0, in ascending order. Once the list is in that
+// order, rows are placed by binary search, comparing O(log n) keys instead of
+// re-sorting the whole list for every row.
+void LLScrollListCtrl::insertSorted(LLScrollListItem* item)
+{
+	std::vector<sort_column_t> single_sort_column;
+	single_sort_column.push_back(std::make_pair(0, TRUE));
+
+	if (!mFirstColumnOrdered)
+	{
+		mItemList.push_back(item);
+		sortItems(single_sort_column);
+		return;
+	}
+
+	const bool use_sort_signal = mSortCallback != NULL;
+	SortScrollListItem comparator(single_sort_column, mSortCallback);
+	LLScrollListSortEntry new_entry;
+	LLScrollListSortEntry other_entry;
+	fill_sort_entry(new_entry, item, single_sort_column, use_sort_signal);
+
+	// after any equal rows, where the stable sort would have left it
+	item_list::iterator where = std::upper_bound(mItemList.begin(), mItemList.end(), item,
+		[&](LLScrollListItem*, LLScrollListItem* other)
+		{
+			fill_sort_entry(other_entry, other, single_sort_column, use_sort_signal);
+			return comparator(&new_entry, &other_entry);
+		});
+	mItemList.insert(where, item);
+}
+
+void LLScrollListCtrl::resortItem(LLScrollListItem* item)
+{
+	if (!mFirstColumnOrdered || mBulkSortPending)
+	{
+		// nothing to keep in order, or endBulkAdd() will sort anyway
+		return;
+	}
+
+	item_list::iterator it = std::find(mItemList.begin(), mItemList.end(), item);
+	if (it != mItemList.end())
+	{
+		mItemList.erase(it);
+		insertSorted(item);
+	}
+}
+
 // for one-shot sorts, does not save sort column/order
 void LLScrollListCtrl::sortOnce(S32 column, BOOL ascending)
 {
@@ -2359,10 +2516,7 @@ void LLScrollListCtrl::sortOnce(S32 column, BOOL ascending)
 	sort_column.push_back(std::make_pair(column, ascending));
 
 	// do stable sort to preserve any previous sorts
-	std::stable_sort(
-		mItemList.begin(), 
-		mItemList.end(), 
-		SortScrollListItem(sort_column,mSortCallback));
+	sortItems(sort_column);
 }
 
 void LLScrollListCtrl::dirtyColumns() 
@@ -2456,6 +2610,7 @@ LLXMLNodePtr LLScrollListCtrl::getXML(bool save_children) const
 	node->createChild("draw_stripes", TRUE)->setBoolValue(mDrawStripes);
 	node->createChild("column_padding", TRUE)->setIntValue(mColumnPadding);
 	node->createChild("mouse_wheel_opaque", TRUE)->setBoolValue(mMouseWheelOpaque);
+	node->createChild("virtualized", TRUE)->setBoolValue(mVirtualized);
 	addColorXML(node, mBgWriteableColor, "bg_writeable_color", "ScrollBgWriteableColor");
 	addColorXML(node, mBgReadOnlyColor, "bg_read_only_color", "ScrollBgReadOnlyColor");
 	addColorXML(node, mBgSelectedColor, "bg_selected_color", "ScrollSelectedBGColor");
@@ -2557,6 +2712,11 @@ void LLScrollListCtrl::setScrollListParameters(LLXMLNodePtr node)
 		node->getAttribute_bool("mouse_wheel_opaque", mMouseWheelOpaque);
 	}
 
+	if (node->hasAttribute("virtualized"))
+	{
+		node->getAttribute_bool("virtualized", mVirtualized);
+	}
+
 	if (node->hasAttribute("menu_num"))
 	{
 		// Some scroll lists use common menus identified by number
@@ -3087,6 +3247,20 @@ LLScrollListItem* LLScrollListCtrl::addRow(LLScrollListItem *new_item, const LLS
 		}
 		cell_p.font_halign = columnp->mFontAlignment;
 
+		if (mVirtualized && (cell_p.type() == "text" || cell_p.type() == "date" || cell_p.type() == "checkbox"))
+		{
+			// built when the row is first drawn
+			new_item->setPendingColumn(index, cell_p);
+			if (columnp->mHeader
+				&& cell_p.type() != "checkbox"
+				&& !cell_p.value().asString().empty())
+			{
+				columnp->mHeader->setHasResizableElement(TRUE);
+			}
+			col_index++;
+			continue;
+		}
+
 		LLScrollListCell* cell = LLScrollListCell::create(cell_p);
 
 		if (cell)
@@ -3133,7 +3307,7 @@ LLScrollListItem* LLScrollListCtrl::addRow(LLScrollListItem *new_item, const LLS
 	for (column_map_t::iterator column_it = mColumns.begin(); column_it != mColumns.end(); ++column_it)
 	{
 		S32 column_idx = column_it->second->mIndex;
-		if (new_item->getColumn(column_idx) == NULL)
+		if (!new_item->hasColumn(column_idx))
 		{
 			LLScrollListColumn* column_ptr = column_it->second;
 			LLScrollListCell::Params cell_p;
@@ -3167,11 +3341,42 @@ LLScrollListItem* LLScrollListCtrl::addSimpleElement(const std::string& value, E
 
 void LLScrollListCtrl::setValue(const LLSD& value )
 {
+	beginBulkAdd();
 	LLSD::array_const_iterator itor;
 	for (itor = value.beginArray(); itor != value.endArray(); ++itor)
 	{
 		addElement(*itor);
 	}
+	endBulkAdd();
+}
+
+void LLScrollListCtrl::beginBulkAdd()
+{
+	++mBulkAddDepth;
+}
+
+void LLScrollListCtrl::endBulkAdd()
+{
+	if (mBulkAddDepth <= 0)
+	{
+		LL_WARNS() << "endBulkAdd() without beginBulkAdd() on " << getName() << LL_ENDL;
+		return;
+	}
+	if (--mBulkAddDepth > 0)
+	{
+		return;
+	}
+
+	if (mBulkSortPending)
+	{
+		// one sort for the whole batch instead of one per ADD_SORTED
+		std::vector<sort_column_t> single_sort_column;
+		single_sort_column.push_back(std::make_pair(0, TRUE));
+		sortItems(single_sort_column);
+		mBulkSortPending = false;
+	}
+
+	updateLayout();
 }
 
 LLSD LLScrollListCtrl::getValue() const
@@ -76,6 +76,10 @@ public:
 	
 	typedef boost::signals2::signal<S32 (S32,const LLScrollListItem*,const LLScrollListItem*),maximum<S32> > sort_signal_t;
 
+	// Data-model hook for virtualized lists: called the first time a row is
+	// scrolled into view, just before its cells are built and drawn.
+	typedef boost::function<void (LLScrollListItem* item)> row_shown_callback_t;
+
 	LLScrollListCtrl(const std::string& name, const LLRect& rect, commit_callback_t commit_callback, bool multi_select, bool has_border = true, bool draw_heading = false);
 
 public:
@@ -115,6 +119,21 @@ public:
 	virtual void clearRows(); // clears all elements
 	virtual void sortByColumn(const std::string& name, BOOL ascending);
 
+	// Bracket large batches of addElement()/addRow() calls. Inside a batch,
+	// ADD_SORTED and layout updates are deferred to the matching endBulkAdd().
+	// Calls may nest.
+	void			beginBulkAdd();
+	void			endBulkAdd();
+
+	// Virtualized lists defer constructing text, date and checkbox cells
+	// until a row is drawn or a cell is explicitly asked for; sorting,
+	// column sizing and searching by value work off the stored values.
+	// Use LLScrollListItem::getColumnValue()/setColumnValue() to read and
+	// update rows without building their cells.
+	void			setVirtualized(bool virtualized)	{ mVirtualized = virtualized; }
+	bool			getVirtualized() const				{ return mVirtualized; }
+	void			setRowShownCallback(row_shown_callback_t cb) { mOnRowShownCallback = cb; }
+
 	// These functions take and return an array of arrays of elements, as above
 	virtual void	setValue(const LLSD& value );
 	virtual LLSD	getValue() const;
@@ -361,6 +380,8 @@ public:
 		}
 	}
 	void			dirtyColumns(); // some operation has potentially affected column layout or ordering
+	// moves a row added with ADD_SORTED back into place after its first column was edited
+	void			resortItem(LLScrollListItem* item);
 
 	boost::signals2::connection setSortCallback(sort_signal_t::slot_type cb )
 	{
@@ -398,6 +419,9 @@ private:
 	void			drawItems();
 
 	void            updateLineHeightInsert(LLScrollListItem* item);
+	void			showRow(LLScrollListItem* item);
+	void			sortItems(const std::vector<std::pair<S32, BOOL> >& sort_columns) const;
+	void			insertSorted(LLScrollListItem* item);
 	void			reportInvalidInput();
 	BOOL			isRepeatedChars(const LLWString& string) const;
 	void			selectItem(LLScrollListItem* itemp, BOOL single_select = TRUE);
@@ -466,6 +490,12 @@ private:
 	S32				mTotalColumnPadding;
 
 	mutable bool	mSorted;
+
+	S32				mBulkAddDepth;
+	bool			mBulkSortPending;	// an ADD_SORTED happened inside the current batch
+	mutable bool	mFirstColumnOrdered;	// rows are in ADD_SORTED order, new ones can be placed by binary search
+	bool			mVirtualized;
+	row_shown_callback_t mOnRowShownCallback;
 	
 	typedef std::map<std::string, LLScrollListColumn*> column_map_t;
 	column_map_t mColumns;
@@ -39,7 +39,8 @@ LLScrollListItem::LLScrollListItem( const Params& p )
 	mEnabled(p.enabled),
 	mUserdata(p.userdata),
 	mItemValue(p.value),
-	mColumns()
+	mColumns(),
+	mShown(false)
 {
 }
 
@@ -47,6 +48,7 @@ LLScrollListItem::LLScrollListItem( const Params& p )
 LLScrollListItem::~LLScrollListItem()
 {
 	std::for_each(mColumns.begin(), mColumns.end(), DeletePointer());
+	std::for_each(mPendingColumns.begin(), mPendingColumns.end(), DeletePointer());
 }
 
 void LLScrollListItem::addColumn(const LLScrollListCell::Params& p)
@@ -60,6 +62,10 @@ void LLScrollListItem::setNumColumns(S32 columns)
 	if (columns < prev_columns)
 	{
 		std::for_each(mColumns.begin()+columns, mColumns.end(), DeletePointer());
+		if (!mPendingColumns.empty())
+		{
+			std::for_each(mPendingColumns.begin()+columns, mPendingColumns.end(), DeletePointer());
+		}
 	}
 
 	mColumns.resize(columns);
@@ -68,6 +74,11 @@ void LLScrollListItem::setNumColumns(S32 columns)
 	{
 		mColumns[col] = NULL;
 	}
+
+	if (!mPendingColumns.empty())
+	{
+		mPendingColumns.resize(columns, NULL);
+	}
 }
 
 void LLScrollListItem::setColumn( S32 column, LLScrollListCell *cell )
@@ -76,6 +87,11 @@ void LLScrollListItem::setColumn( S32 column, LLScrollListCell *cell )
 	{
 		delete mColumns[column];
 		mColumns[column] = cell;
+		if (!mPendingColumns.empty())
+		{
+			delete mPendingColumns[column];
+			mPendingColumns[column] = NULL;
+		}
 	}
 	else
 	{
@@ -83,6 +99,103 @@ void LLScrollListItem::setColumn( S32 column, LLScrollListCell *cell )
 	}
 }
 
+void LLScrollListItem::setPendingColumn(S32 column, const LLScrollListCell::Params& p)
+{
+	if (column < (S32)mColumns.size())
+	{
+		delete mColumns[column];
+		mColumns[column] = NULL;
+		if (mPendingColumns.empty())
+		{
+			mPendingColumns.resize(mColumns.size(), NULL);
+		}
+		delete mPendingColumns[column];
+		mPendingColumns[column] = new LLScrollListCell::Params(p);
+	}
+	else
+	{
+		LL_ERRS() << "LLScrollListItem::setPendingColumn: bad column: " << column << LL_ENDL;
+	}
+}
+
+bool LLScrollListItem::hasColumn(S32 column) const
+{
+	if (column < 0 || column >= (S32)mColumns.size())
+	{
+		return false;
+	}
+	return mColumns[column] || (!mPendingColumns.empty() && mPendingColumns[column]);
+}
+
+bool LLScrollListItem::isColumnBuilt(S32 column) const
+{
+	return column >= 0 && column < (S32)mColumns.size() && mColumns[column];
+}
+
+const LLSD LLScrollListItem::getColumnValue(S32 column) const
+{
+	if (column < 0 || column >= (S32)mColumns.size())
+	{
+		return LLSD();
+	}
+	if (mColumns[column])
+	{
+		return mColumns[column]->getValue();
+	}
+	if (!mPendingColumns.empty() && mPendingColumns[column])
+	{
+		// Only text, date and checkbox cells are deferred, and for those
+		// the constructed cell's getValue() is the value it was given.
+		return mPendingColumns[column]->value();
+	}
+	return LLSD();
+}
+
+void LLScrollListItem::setColumnValue(S32 column, const LLSD& value)
+{
+	if (column < 0 || column >= (S32)mColumns.size())
+	{
+		return;
+	}
+	if (mColumns[column])
+	{
+		mColumns[column]->setValue(value);
+	}
+	else if (!mPendingColumns.empty() && mPendingColumns[column])
+	{
+		mPendingColumns[column]->value = value;
+	}
+}
+
+void LLScrollListItem::setColumnWidth(S32 column, S32 width)
+{
+	if (column < 0 || column >= (S32)mColumns.size())
+	{
+		return;
+	}
+	if (mColumns[column])
+	{
+		mColumns[column]->setWidth(width);
+	}
+	else if (!mPendingColumns.empty() && mPendingColumns[column])
+	{
+		mPendingColumns[column]->width = width;
+	}
+}
+
+void LLScrollListItem::buildColumns() const
+{
+	if (mPendingColumns.empty())
+	{
+		return;
+	}
+	for (S32 i = 0; i < (S32)mColumns.size(); ++i)
+	{
+		getColumn(i);
+	}
+	mPendingColumns.clear();
+}
+
 
 S32 LLScrollListItem::getNumColumns() const
 {
@@ -93,6 +206,12 @@ LLScrollListCell* LLScrollListItem::getColumn(const S32 i) const
 {
 	if (0 <= i && i < (S32)mColumns.size())
 	{
+		if (!mColumns[i] && !mPendingColumns.empty() && mPendingColumns[i])
+		{
+			mColumns[i] = LLScrollListCell::create(*mPendingColumns[i]);
+			delete mPendingColumns[i];
+			mPendingColumns[i] = NULL;
+		}
 		return mColumns[i];
 	}
 	return NULL;
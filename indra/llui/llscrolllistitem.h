@@ -90,6 +90,17 @@ public:
 
 	LLScrollListCell *getColumn(const S32 i) const;
 
+	// Deferred cells (virtualized lists): the cell is only constructed the
+	// first time getColumn() asks for it. Until then its value and width
+	// live in the stored params.
+	void	setPendingColumn(S32 column, const LLScrollListCell::Params& p);
+	bool	hasColumn(S32 column) const;
+	bool	isColumnBuilt(S32 column) const;
+	const LLSD getColumnValue(S32 column) const;	// doesn't build the cell
+	void	setColumnValue(S32 column, const LLSD& value);	// doesn't build the cell
+	void	setColumnWidth(S32 column, S32 width);	// doesn't build the cell
+	void	buildColumns() const;
+
 	std::string getContentsCSV() const;
 
 	virtual void draw(const LLRect& rect, const LLColor4& fg_color, const LLColor4& bg_color, const LLColor4& highlight_color, S32 column_padding);
@@ -102,8 +113,10 @@ private:
 	BOOL	mEnabled;
 	void*	mUserdata;
 	LLSD	mItemValue;
-	std::vector<LLScrollListCell *> mColumns;
+	mutable std::vector<LLScrollListCell *> mColumns;
+	mutable std::vector<LLScrollListCell::Params *> mPendingColumns; // empty unless cells were deferred
 	LLRect  mRectangle;
+	bool	mShown;		// set by LLScrollListCtrl the first time the row is drawn
 };
 
 #endif
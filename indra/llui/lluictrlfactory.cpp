@@ -41,6 +41,8 @@
 // other library includes
 #include "llcontrol.h"
 #include "lldir.h"
+#include "llmd5.h"
+#include "llxmlnodecache.h"
 #include "v4color.h"
 
 // this library includes
@@ -74,6 +76,8 @@
 LLTrace::BlockTimerStatHandle FTM_WIDGET_CONSTRUCTION("Widget Construction");
 LLTrace::BlockTimerStatHandle FTM_INIT_FROM_PARAMS("Widget InitFromParams");
 LLTrace::BlockTimerStatHandle FTM_WIDGET_SETUP("Widget Setup");
+static LLTrace::BlockTimerStatHandle FTM_XUI_CACHE_LOAD("XUI Compiled Load");
+static LLTrace::BlockTimerStatHandle FTM_XUI_PARSE("XUI Parse");
 
 const char XML_HEADER[] = "<?xml version=\"1.0\" encoding=\"utf-8\" standalone=\"yes\" ?>\n";
 
@@ -191,14 +195,31 @@ bool LLUICtrlFactory::getLayeredXMLNode(const std::string &xui_filename, LLXMLNo
 		}
 	}
 
+	std::vector<std::string> paths =
+	gDirUtilp->findSkinnedFilenames(LLDir::XUI, xui_filename);
+
+	// Every file contributing to the merged tree, in merge order; the compiled
+	// cache is only valid while all of them are unchanged.
+	std::vector<std::string> source_files;
+	source_files.reserve(paths.size() + 1);
+	source_files.push_back(full_filename);
+	source_files.insert(source_files.end(), paths.begin(), paths.end());
+
+	std::string cache_filename = getCompiledXMLFilename(source_files);
+	{
+		LL_RECORD_BLOCK_TIME(FTM_XUI_CACHE_LOAD);
+		if (LLXMLNodeCache::load(cache_filename, source_files, root))
+		{
+			return true;
+		}
+	}
+
+	LL_RECORD_BLOCK_TIME(FTM_XUI_PARSE);
 	if (!LLXMLNode::parseFile(full_filename, root, NULL))
 	{
 		LL_WARNS() << "Problem reading UI description file: " << full_filename << LL_ENDL;
 		return false;
 	}
-	
-	std::vector<std::string> paths =
-	gDirUtilp->findSkinnedFilenames(LLDir::XUI, xui_filename);
 
 	for ( auto& layer_filename : paths )
 	{
@@ -220,9 +241,43 @@ bool LLUICtrlFactory::getLayeredXMLNode(const std::string &xui_filename, LLXMLNo
 		}
 	}
 
+	LLXMLNodeCache::save(cache_filename, source_files, root);
+
 	return true;
 }
 
+// static
+std::string LLUICtrlFactory::getCompiledXMLFilename(const std::vector<std::string>& source_files)
+{
+	if (!LLXMLNodeCache::isEnabled())
+	{
+		return LLStringUtil::null;
+	}
+
+	if (gDirUtilp->getCacheDir().empty())
+	{
+		// Cache location not set up yet.
+		return LLStringUtil::null;
+	}
+	std::string cache_dir = gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "xui");
+	if (!LLFile::isdir(cache_dir))
+	{
+		LLFile::mkdir(cache_dir);
+	}
+
+	LLMD5 md5;
+	for (std::vector<std::string>::const_iterator it = source_files.begin(); it != source_files.end(); ++it)
+	{
+		md5.update(*it);
+		md5.update((const unsigned char*)"\n", 1);
+	}
+	md5.finalize();
+	char digest[33];
+	md5.hex_digest(digest);
+
+	return cache_dir + gDirUtilp->getDirDelimiter() + digest + ".xuic";
+}
+
 
 bool LLUICtrlFactory::getLayeredXMLNodeFromBuffer(const std::string &buffer, LLXMLNodePtr& root)
 {
@@ -144,6 +144,10 @@ public:
 	static const std::vector<std::string>& getXUIPaths();
 
 private:
+	// Per-source-set file name of the compiled XUI tree in the cache dir,
+	// or an empty string if the compiled cache is unavailable.
+	static std::string getCompiledXMLFilename(const std::vector<std::string>& source_files);
+
 	bool getLayeredXMLNodeImpl(const std::string &filename, LLXMLNodePtr& root);
 
 
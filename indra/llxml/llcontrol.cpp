@@ -172,9 +172,7 @@ LLControlVariable::LLControlVariable(const std::string& name, eControlType type,
 	  mHideFromSettingsEditor(hidefromsettingseditor),
 	  mCommitSignal(new commit_signal_t),
 	  mValidateSignal(new validate_signal_t),
-#ifdef PROF_CTRL_CALLS
 	  mLookupCount(0),
-#endif //PROF_CTRL_CALLS
 	  mIsCOA(IsCOA),
 	  mIsCOAParent(false),
 	  mCOAConnectedVar(NULL)
@@ -346,22 +344,29 @@ LLSD LLControlVariable::getSaveValue() const
 	return mValues[0];
 }
 
-#ifdef PROF_CTRL_CALLS
+// static
+bool LLControlGroup::sCountLookups = false;
+U32 LLControlGroup::sFrameLookups = 0;
+U32 LLControlGroup::sLastFrameLookups = 0;
+U32 LLControlGroup::sPeakFrameLookups = 0;
+U32 LLControlGroup::sCountedFrames = 0;
+
 void LLControlGroup::updateLookupMap(ctrl_name_table_t::const_iterator iter) const
 {
+	++sFrameLookups;
 	if(iter != mNameTable.end() && iter->second.notNull())
 	{
 		iter->second.get()->mLookupCount++;
 	}
 }
-#endif //PROF_CTRL_CALLS
 
 LLControlVariable* LLControlGroup::getControl(std::string const& name)
 {
 	ctrl_name_table_t::iterator iter = mNameTable.find(name);
-#ifdef PROF_CTRL_CALLS
-	updateLookupMap(iter);
-#endif //PROF_CTRL_CALLS
+	if (sCountLookups)
+	{
+		updateLookupMap(iter);
+	}
 	if(iter != mNameTable.end())
 		return iter->second->getCOAActive();
 	else
@@ -371,19 +376,88 @@ LLControlVariable* LLControlGroup::getControl(std::string const& name)
 LLControlVariable const* LLControlGroup::getControl(std::string const& name) const
 {
 	ctrl_name_table_t::const_iterator iter = mNameTable.find(name);
-#ifdef PROF_CTRL_CALLS
-	updateLookupMap(iter);
-#endif //PROF_CTRL_CALLS
+	if (sCountLookups)
+	{
+		updateLookupMap(iter);
+	}
 	if(iter != mNameTable.end())
 		return iter->second->getCOAActive();
 	else
 		return NULL;
 }
 
+void LLControlGroup::bindIndexedControls(const char* const* names, U32 count)
+{
+	mIndexedNames = names;
+	mIndexedControls.assign(count, NULL);
+	U32 missing = 0;
+	for (U32 i = 0; i < count; ++i)
+	{
+		if (!bindIndexedControl(i))
+		{
+			++missing;
+		}
+	}
+	if (missing)
+	{
+		LL_WARNS() << getKey() << ": " << missing << " of " << count << " indexed controls are not declared." << LL_ENDL;
+	}
+}
+
+LLControlVariable* LLControlGroup::bindIndexedControl(U32 index)
+{
+	if (!mIndexedNames)
+	{
+		return NULL;
+	}
+	// Store the base variable, not the COA-active one; getIndexedControl()
+	// resolves that per call since it changes with the per-account setting.
+	ctrl_name_table_t::iterator iter = mNameTable.find(mIndexedNames[index]);
+	if (iter == mNameTable.end())
+	{
+		return NULL;
+	}
+	mIndexedControls[index] = iter->second;
+	return iter->second;
+}
+
+// static
+void LLControlGroup::setLookupCounting(bool enable)
+{
+	if (enable && !sCountLookups)
+	{
+		// Start from a clean slate
+		struct reset_count : public ApplyFunctor
+		{
+			virtual void apply(const std::string& name, LLControlVariable* control) { control->mLookupCount = 0; }
+		} reset;
+		for (instance_iter it = beginInstances(); it != endInstances(); ++it)
+		{
+			it->applyToAll(&reset);
+		}
+		sFrameLookups = sLastFrameLookups = sPeakFrameLookups = sCountedFrames = 0;
+	}
+	sCountLookups = enable;
+}
+
+// static
+void LLControlGroup::endLookupFrame()
+{
+	if (!sCountLookups)
+	{
+		return;
+	}
+	sLastFrameLookups = sFrameLookups;
+	sPeakFrameLookups = llmax(sPeakFrameLookups, sFrameLookups);
+	sFrameLookups = 0;
+	++sCountedFrames;
+}
+
 ////////////////////////////////////////////////////////////////////////////
 
 LLControlGroup::LLControlGroup(const std::string& name)
-:	LLInstanceTracker<LLControlGroup, std::string>(name)
+:	LLInstanceTracker<LLControlGroup, std::string>(name),
+	mIndexedNames(NULL)
 {
 	mTypeString[TYPE_U32] = "U32";
 	mTypeString[TYPE_S32] = "S32";
@@ -405,6 +479,8 @@ LLControlGroup::~LLControlGroup()
 
 void LLControlGroup::cleanup()
 {
+	mIndexedNames = NULL;
+	mIndexedControls.clear();
 	mNameTable.clear();
 }
 
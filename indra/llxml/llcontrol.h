@@ -69,10 +69,6 @@
 # endif
 #endif
 
-#if LL_RELEASE_WITH_DEBUG_INFO
-#define PROF_CTRL_CALLS
-#endif //LL_RELEASE_WITH_DEBUG_INFO
-
 class LLVector3;
 class LLVector3d;
 class LLColor3;
@@ -183,10 +179,8 @@ public:
 			mValidateSignal = pConnect->mValidateSignal;
 		}
 	}
-#ifdef PROF_CTRL_CALLS
 public:
-	U32 mLookupCount;
-#endif //PROF_CTRL_CALLS
+	U32 mLookupCount;	// String-keyed lookups while LLControlGroup lookup counting is on
 private:
 	LLSD getComparableValue(const LLSD& value);
 	bool llsd_compare(const LLSD& a, const LLSD & b);
@@ -237,6 +231,37 @@ public:
 	LLControlVariable* getControl(std::string const& name);
 	LLControlVariable const* getControl(std::string const& name) const;
 
+	// Direct-indexed access for hot paths. bindIndexedControls() resolves a
+	// table of control names once (newview uses the LLSettingID table generated
+	// from settings.xml); getIndexedControl() is then a vector index instead of
+	// a name map lookup. The table must outlive the group.
+	void bindIndexedControls(const char* const* names, U32 count);
+	LLControlVariable* getIndexedControl(U32 index)
+	{
+		if (index >= mIndexedControls.size())
+		{
+			// Table not bound yet
+			return NULL;
+		}
+		LLControlVariable* control = mIndexedControls[index];
+		if (!control)
+		{
+			// Not declared yet when the table was bound.
+			control = bindIndexedControl(index);
+		}
+		return control ? control->getCOAActive() : NULL;
+	}
+
+	// Lookup instrumentation: while enabled, every string-keyed getControl()
+	// bumps the control's mLookupCount and the per-frame total, so hot
+	// callers can be found and moved to LLCachedControl or LLSettingID.
+	static void setLookupCounting(bool enable);
+	static bool isLookupCounting()				{ return sCountLookups; }
+	static void endLookupFrame();				// Call once per frame
+	static U32 getLastFrameLookups()			{ return sLastFrameLookups; }
+	static U32 getPeakFrameLookups()			{ return sPeakFrameLookups; }
+	static U32 getCountedFrames()				{ return sCountedFrames; }
+
 	struct ApplyFunctor
 	{
 		virtual ~ApplyFunctor() {};
@@ -356,9 +381,18 @@ public:
 	void updateCOASetting(bool coa_enabled);
 	bool handleCOASettingChange(const LLSD& newvalue);
 
-#ifdef PROF_CTRL_CALLS
+private:
 	void updateLookupMap(ctrl_name_table_t::const_iterator iter) const;
-#endif //PROF_CTRL_CALLS
+	LLControlVariable* bindIndexedControl(U32 index);
+
+	const char* const* mIndexedNames;
+	std::vector<LLControlVariable*> mIndexedControls;
+
+	static bool sCountLookups;
+	static U32 sFrameLookups;
+	static U32 sLastFrameLookups;
+	static U32 sPeakFrameLookups;
+	static U32 sCountedFrames;
 };
 
 
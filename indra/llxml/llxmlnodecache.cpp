@@ -0,0 +1,389 @@
+/**
+ * @file llxmlnodecache.cpp
+ * @brief Compiled binary representation of layered LLXMLNode trees
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llxmlnodecache.h"
+
+#include <map>
+
+#include "llfile.h"
+
+static const U32 XML_NODE_CACHE_MAGIC = 0x314e4358; // "XCN1"
+static const U32 XML_NODE_CACHE_VERSION = 1;
+
+// Sanity limit so a corrupt blob can't make us allocate the world.
+static const U32 XML_NODE_CACHE_MAX_COUNT = 1 << 24;
+
+bool LLXMLNodeCache::sEnabled = true;
+U32 LLXMLNodeCache::sHits = 0;
+U32 LLXMLNodeCache::sMisses = 0;
+
+namespace
+{
+	bool get_source_stamp(const std::string& filename, U64& size, S64& mtime)
+	{
+		llstat stat_data;
+		if (LLFile::stat(filename, &stat_data) != 0)
+		{
+			return false;
+		}
+		size = (U64)stat_data.st_size;
+		mtime = (S64)stat_data.st_mtime;
+		return true;
+	}
+
+	class LLXMLNodeCacheWriter
+	{
+	public:
+		void writeU8(U8 value)		{ mBody.append((const char*)&value, sizeof(value)); }
+		void writeU32(U32 value)	{ mBody.append((const char*)&value, sizeof(value)); }
+		void writeS32(S32 value)	{ mBody.append((const char*)&value, sizeof(value)); }
+		void writeU64(U64 value)	{ mBody.append((const char*)&value, sizeof(value)); }
+		void writeS64(S64 value)	{ mBody.append((const char*)&value, sizeof(value)); }
+
+		void writeRawString(std::string& out, const std::string& str)
+		{
+			U32 len = (U32)str.size();
+			out.append((const char*)&len, sizeof(len));
+			out.append(str);
+		}
+
+		U32 intern(const std::string& str)
+		{
+			std::map<std::string, U32>::iterator it = mStringIndex.find(str);
+			if (it != mStringIndex.end())
+			{
+				return it->second;
+			}
+			U32 index = (U32)mStrings.size();
+			mStrings.push_back(str);
+			mStringIndex[str] = index;
+			return index;
+		}
+
+		void writeNode(LLXMLNode* node)
+		{
+			const LLStringTableEntry* name = node->getName();
+			writeU32(intern(name ? std::string(name->mString) : std::string()));
+			writeU32(intern(node->getValue()));
+			writeU32(intern(node->mID));
+			writeU8(node->mIsAttribute ? 1 : 0);
+			writeU8((U8)node->mType);
+			writeU8((U8)node->mEncoding);
+			writeU32(node->mLength);
+			writeU32(node->mPrecision);
+			writeU32(node->mVersionMajor);
+			writeU32(node->mVersionMinor);
+			writeS32(node->mLineNumber);
+
+			writeU32((U32)node->mAttributes.size());
+			for (LLXMLAttribList::const_iterator it = node->mAttributes.begin();
+				 it != node->mAttributes.end(); ++it)
+			{
+				writeNode(it->second);
+			}
+
+			// Children are written in document order (the linked list), not in
+			// the name-sorted order of the child map.
+			writeU32(node->getChildCount());
+			for (LLXMLNodePtr child = node->getFirstChild(); child.notNull(); child = child->getNextSibling())
+			{
+				writeNode(child);
+			}
+		}
+
+		void finish(std::string& out, const std::vector<std::string>& source_files,
+					const std::vector<std::pair<U64, S64> >& stamps)
+		{
+			out.reserve(mBody.size() + 1024);
+			U32 header[2] = { XML_NODE_CACHE_MAGIC, XML_NODE_CACHE_VERSION };
+			out.append((const char*)header, sizeof(header));
+
+			U32 count = (U32)source_files.size();
+			out.append((const char*)&count, sizeof(count));
+			for (U32 i = 0; i < count; ++i)
+			{
+				writeRawString(out, source_files[i]);
+				out.append((const char*)&stamps[i].first, sizeof(U64));
+				out.append((const char*)&stamps[i].second, sizeof(S64));
+			}
+
+			count = (U32)mStrings.size();
+			out.append((const char*)&count, sizeof(count));
+			for (U32 i = 0; i < count; ++i)
+			{
+				writeRawString(out, mStrings[i]);
+			}
+
+			out.append(mBody);
+		}
+
+	private:
+		std::string mBody;
+		std::vector<std::string> mStrings;
+		std::map<std::string, U32> mStringIndex;
+	};
+
+	class LLXMLNodeCacheReader
+	{
+	public:
+		LLXMLNodeCacheReader(const U8* buffer, size_t length)
+		:	mCur(buffer),
+			mEnd(buffer + length)
+		{
+		}
+
+		template<typename T>
+		bool read(T& value)
+		{
+			if ((size_t)(mEnd - mCur) < sizeof(T))
+			{
+				return false;
+			}
+			memcpy(&value, mCur, sizeof(T));
+			mCur += sizeof(T);
+			return true;
+		}
+
+		bool readString(std::string& str)
+		{
+			U32 len;
+			if (!read(len) || (size_t)(mEnd - mCur) < len)
+			{
+				return false;
+			}
+			str.assign((const char*)mCur, len);
+			mCur += len;
+			return true;
+		}
+
+		bool readStringTable()
+		{
+			U32 count;
+			if (!read(count) || count > XML_NODE_CACHE_MAX_COUNT)
+			{
+				return false;
+			}
+			mStrings.resize(count);
+			mEntries.resize(count, NULL);
+			for (U32 i = 0; i < count; ++i)
+			{
+				if (!readString(mStrings[i]))
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		bool readNode(LLXMLNodePtr& node)
+		{
+			U32 name_idx, value_idx, id_idx;
+			U8 is_attribute, type, encoding;
+			U32 length, precision, version_major, version_minor;
+			S32 line_number;
+			if (!read(name_idx) || !read(value_idx) || !read(id_idx)
+				|| !read(is_attribute) || !read(type) || !read(encoding)
+				|| !read(length) || !read(precision)
+				|| !read(version_major) || !read(version_minor)
+				|| !read(line_number))
+			{
+				return false;
+			}
+			if (name_idx >= mStrings.size() || value_idx >= mStrings.size() || id_idx >= mStrings.size()
+				|| type > LLXMLNode::TYPE_NODEREF || encoding > LLXMLNode::ENCODING_HEX)
+			{
+				return false;
+			}
+
+			// Intern each distinct name into the global string table only once.
+			LLStringTableEntry*& name = mEntries[name_idx];
+			if (!name)
+			{
+				name = gStringTable.addStringEntry(mStrings[name_idx]);
+			}
+
+			node = new LLXMLNode(name, is_attribute != 0);
+			node->setValue(mStrings[value_idx]);
+			node->mID = mStrings[id_idx];
+			node->mType = (LLXMLNode::ValueType)type;
+			node->mEncoding = (LLXMLNode::Encoding)encoding;
+			node->mLength = length;
+			node->mPrecision = precision;
+			node->mVersionMajor = version_major;
+			node->mVersionMinor = version_minor;
+			node->setLineNumber(line_number);
+
+			U32 count;
+			for (S32 pass = 0; pass < 2; ++pass)
+			{
+				// pass 0: attributes, pass 1: children
+				if (!read(count) || count > XML_NODE_CACHE_MAX_COUNT)
+				{
+					return false;
+				}
+				for (U32 i = 0; i < count; ++i)
+				{
+					LLXMLNodePtr child;
+					if (!readNode(child))
+					{
+						return false;
+					}
+					node->addChild(child);
+				}
+			}
+			return true;
+		}
+
+		bool atEnd() const { return mCur == mEnd; }
+
+	private:
+		const U8* mCur;
+		const U8* mEnd;
+		std::vector<std::string> mStrings;
+		std::vector<LLStringTableEntry*> mEntries;
+	};
+}
+
+// static
+bool LLXMLNodeCache::load(const std::string& cache_filename,
+						  const std::vector<std::string>& source_files,
+						  LLXMLNodePtr& root)
+{
+	if (!sEnabled || cache_filename.empty())
+	{
+		return false;
+	}
+
+	LLFILE* fp = LLFile::fopen(cache_filename, "rb");
+	if (!fp)
+	{
+		++sMisses;
+		return false;
+	}
+	fseek(fp, 0, SEEK_END);
+	size_t length = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+
+	std::vector<U8> buffer(length);
+	size_t nread = length ? fread(&buffer[0], 1, length, fp) : 0;
+	fclose(fp);
+	if (nread != length || !length)
+	{
+		++sMisses;
+		return false;
+	}
+
+	LLXMLNodeCacheReader reader(&buffer[0], length);
+
+	U32 magic, version, count;
+	if (!reader.read(magic) || magic != XML_NODE_CACHE_MAGIC
+		|| !reader.read(version) || version != XML_NODE_CACHE_VERSION
+		|| !reader.read(count) || count != source_files.size())
+	{
+		++sMisses;
+		return false;
+	}
+
+	for (U32 i = 0; i < count; ++i)
+	{
+		std::string path;
+		U64 size, cur_size;
+		S64 mtime, cur_mtime;
+		if (!reader.readString(path) || !reader.read(size) || !reader.read(mtime)
+			|| path != source_files[i]
+			|| !get_source_stamp(path, cur_size, cur_mtime)
+			|| size != cur_size || mtime != cur_mtime)
+		{
+			LL_DEBUGS("XMLNode") << "Stale compiled XML cache " << cache_filename << LL_ENDL;
+			++sMisses;
+			return false;
+		}
+	}
+
+	LLXMLNodePtr new_root;
+	if (!reader.readStringTable() || !reader.readNode(new_root) || !reader.atEnd())
+	{
+		LL_WARNS() << "Corrupt compiled XML cache " << cache_filename << ", ignoring." << LL_ENDL;
+		LLFile::remove(cache_filename);
+		++sMisses;
+		return false;
+	}
+
+	new_root->updateDefault();
+	root = new_root;
+	++sHits;
+	return true;
+}
+
+// static
+bool LLXMLNodeCache::save(const std::string& cache_filename,
+						  const std::vector<std::string>& source_files,
+						  LLXMLNode* root)
+{
+	if (!sEnabled || cache_filename.empty() || !root)
+	{
+		return false;
+	}
+
+	std::vector<std::pair<U64, S64> > stamps;
+	stamps.reserve(source_files.size());
+	for (std::vector<std::string>::const_iterator it = source_files.begin(); it != source_files.end(); ++it)
+	{
+		U64 size;
+		S64 mtime;
+		if (!get_source_stamp(*it, size, mtime))
+		{
+			return false;
+		}
+		stamps.push_back(std::make_pair(size, mtime));
+	}
+
+	LLXMLNodeCacheWriter writer;
+	writer.writeNode(root);
+
+	std::string blob;
+	writer.finish(blob, source_files, stamps);
+
+	// Write to a temporary and rename, so a concurrent or interrupted write
+	// never leaves a truncated blob under the real name.
+	std::string tmp_filename = cache_filename + ".tmp";
+	LLFILE* fp = LLFile::fopen(tmp_filename, "wb");
+	if (!fp)
+	{
+		return false;
+	}
+	size_t written = fwrite(blob.data(), 1, blob.size(), fp);
+	fclose(fp);
+	if (written != blob.size())
+	{
+		LLFile::remove(tmp_filename);
+		return false;
+	}
+	LLFile::remove_nowarn(cache_filename);
+	return LLFile::rename(tmp_filename, cache_filename) == 0;
+}
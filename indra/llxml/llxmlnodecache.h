@@ -0,0 +1,69 @@
+/**
+ * @file llxmlnodecache.h
+ * @brief Compiled binary representation of layered LLXMLNode trees
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLXMLNODECACHE_H
+#define LL_LLXMLNODECACHE_H
+
+#include <string>
+#include <vector>
+
+#include "llxmlnode.h"
+
+// Stores the result of merging a stack of layered XML files (default skin,
+// skin overrides, language overlays) in a compact binary blob, so the tree
+// can be rebuilt without running expat or LLXMLNode::updateNode() again.
+//
+// A blob records the path, size and modification time of every source file
+// it was compiled from and is rejected as soon as any of them differ.
+// Node names and values are interned in a per-blob string table; names are
+// re-interned into gStringTable once per load rather than once per node.
+class LLXMLNodeCache
+{
+public:
+	// Rebuilds root from cache_filename if the blob exists and was compiled
+	// from exactly source_files in their current state.
+	static bool load(const std::string& cache_filename,
+					 const std::vector<std::string>& source_files,
+					 LLXMLNodePtr& root);
+
+	// Compiles root (already merged from source_files) to cache_filename.
+	static bool save(const std::string& cache_filename,
+					 const std::vector<std::string>& source_files,
+					 LLXMLNode* root);
+
+	static void setEnabled(bool enabled)	{ sEnabled = enabled; }
+	static bool isEnabled()					{ return sEnabled; }
+
+	static U32 getHits()					{ return sHits; }
+	static U32 getMisses()					{ return sMisses; }
+
+private:
+	static bool sEnabled;
+	static U32 sHits;
+	static U32 sMisses;
+};
+
+#endif // LL_LLXMLNODECACHE_H
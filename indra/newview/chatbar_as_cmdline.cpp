@@ -215,7 +215,6 @@ void resync_anims()
 	}
 }
 
-#ifdef PROF_CTRL_CALLS
 bool sort_calls(const std::pair<std::string, U32>& left, const std::pair<std::string, U32>& right)
 {
 	return left.second > right.second;
@@ -233,7 +232,6 @@ struct ProfCtrlListAccum : public LLControlGroup::ApplyFunctor
 	}
 	std::vector<std::pair<std::string, U32> > mVariableList;
 };
-#endif //PROF_CTRL_CALLS
 void spew_key_to_name(const LLUUID& targetKey, const LLAvatarName& av_name)
 {
 	cmdline_printchat(llformat("%s: %s", targetKey.asString().c_str(), av_name.getNSName().c_str()));
@@ -554,9 +552,18 @@ bool cmd_line_chat(std::string data, EChatType type)
 			invrepair();
 			return false;
 		}
-#ifdef PROF_CTRL_CALLS
 		else if (cmd == "dumpcalls")
 		{
+			// First use starts counting string-keyed setting lookups, later uses report them.
+			if (!LLControlGroup::isLookupCounting())
+			{
+				LLControlGroup::setLookupCounting(true);
+				cmdline_printchat("Counting setting lookups, run dumpcalls again to report.");
+				return false;
+			}
+			U32 frames = llmax(LLControlGroup::getCountedFrames(), 1U);
+			cmdline_printchat(llformat("Setting lookups over %u frames: last frame %u, peak %u", frames,
+				LLControlGroup::getLastFrameLookups(), LLControlGroup::getPeakFrameLookups()));
 			LLControlGroup::key_iter it = LLControlGroup::beginKeys();
 			LLControlGroup::key_iter end = LLControlGroup::endKeys();
 			for(;it!=end;++it)
@@ -564,16 +571,16 @@ bool cmd_line_chat(std::string data, EChatType type)
 				ProfCtrlListAccum list;
 				LLControlGroup::getInstance(*it)->applyToAll(&list);
 				std::sort(list.mVariableList.begin(),list.mVariableList.end(),sort_calls);
-				LL_INFOS() << *it << ": lookup count (" << gFrameCount << "frames)" << LL_ENDL;
+				LL_INFOS() << *it << ": lookup count (" << frames << " frames)" << LL_ENDL;
 				for(U32 i = 0;i<list.mVariableList.size();i++)
 				{
 					if (list.mVariableList[i].second)
-						LL_INFOS() << "  " << list.mVariableList[i].first << ":  " << list.mVariableList[i].second << " lookups, " << ((float)list.mVariableList[i].second / (float)gFrameCount) << "l/f\n" << LL_ENDL;
+						LL_INFOS() << "  " << list.mVariableList[i].first << ":  " << list.mVariableList[i].second << " lookups, " << ((float)list.mVariableList[i].second / (float)frames) << "l/f\n" << LL_ENDL;
 				}
 			}
+			LLControlGroup::setLookupCounting(false);
 			return false;
 		}
-#endif //PROF_CTRL_CALLS
 	}
 	return true;
 }
@@ -0,0 +1,180 @@
+#!/usr/bin/env python
+"""\
+@file generate_message_fields.py
+@brief Generates llmessagefields.h, LLMessageField accessors with template
+       positions for every variable in message_template.msg.
+
+$LicenseInfo:firstyear=2026&license=viewerlgpl$
+Second Life Viewer Source Code
+Copyright (C) 2026, Linden Research, Inc.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation;
+version 2.1 of the License only.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+$/LicenseInfo$
+"""
+
+import os
+import re
+import sys
+
+# Template type -> EMsgVariableType. Fixed and Variable become
+# LLMessageBinaryField.
+MVT_TYPES = {
+    'U8': 'MVT_U8',
+    'U16': 'MVT_U16',
+    'U32': 'MVT_U32',
+    'U64': 'MVT_U64',
+    'S8': 'MVT_S8',
+    'S16': 'MVT_S16',
+    'S32': 'MVT_S32',
+    'F32': 'MVT_F32',
+    'F64': 'MVT_F64',
+    'LLVector3': 'MVT_LLVector3',
+    'LLVector3d': 'MVT_LLVector3d',
+    'LLVector4': 'MVT_LLVector4',
+    'LLQuaternion': 'MVT_LLQuaternion',
+    'LLUUID': 'MVT_LLUUID',
+    'BOOL': 'MVT_BOOL',
+    'IPADDR': 'MVT_IP_ADDR',
+    'IPPORT': 'MVT_IP_PORT',
+}
+BINARY_TYPES = ('Fixed', 'Variable')
+
+# Name of the block count accessor in each block's namespace.
+BLOCK_COUNT = 'NumBlocks'
+
+# Variable names that are macros in system headers (X11); suffixed with _.
+MACRO_NAMES = ('Status', 'Success', 'None', 'Bool')
+
+def tokenize(text):
+    text = re.sub(r'//[^\n]*', '', text)
+    return re.findall(r'[{}]|[^\s{}]+', text)
+
+def parse(path):
+    """Return [(message, [(block, [(var, type)])])] in template order."""
+    with open(path, 'r') as f:
+        tokens = tokenize(f.read())
+    pos = [0]
+
+    def next_token():
+        token = tokens[pos[0]]
+        pos[0] += 1
+        return token
+
+    def peek():
+        return tokens[pos[0]] if pos[0] < len(tokens) else None
+
+    def expect(token):
+        got = next_token()
+        if got != token:
+            raise ValueError('expected %s, got %s' % (token, got))
+
+    messages = []
+    while peek() is not None:
+        token = next_token()
+        if token == 'version':
+            next_token()
+            continue
+        if token != '{':
+            raise ValueError('unexpected %s' % token)
+        name = next_token()
+        # frequency, number, trust, encoding and any deprecation flags
+        while peek() not in ('{', '}'):
+            next_token()
+        blocks = []
+        while peek() == '{':
+            next_token()
+            block_name = next_token()
+            block_type = next_token()
+            if block_type == 'Multiple':
+                next_token()
+            variables = []
+            while peek() == '{':
+                next_token()
+                var_name = next_token()
+                var_type = next_token()
+                if var_type in BINARY_TYPES:
+                    next_token()
+                elif var_type not in MVT_TYPES:
+                    raise ValueError('unknown type %s for %s.%s.%s' % (var_type, name, block_name, var_name))
+                expect('}')
+                variables.append((var_name, var_type))
+            expect('}')
+            blocks.append((block_name, variables))
+        expect('}')
+        messages.append((name, blocks))
+    return messages
+
+def identifier(name):
+    return name + '_' if name in MACRO_NAMES else name
+
+def main(argv):
+    if len(argv) != 3:
+        sys.stderr.write('usage: %s <message_template.msg> <output header>\n' % argv[0])
+        return 1
+
+    messages = parse(argv[1])
+
+    lines = []
+    lines.append('// Generated by generate_message_fields.py from %s. Do not edit.' % os.path.basename(argv[1]))
+    lines.append('')
+    lines.append('#ifndef LL_LLMESSAGEFIELDS_H')
+    lines.append('#define LL_LLMESSAGEFIELDS_H')
+    lines.append('')
+    lines.append('#include "llmessagefield.h"')
+    lines.append('')
+    lines.append('// LLMessageFields::<Message>::<Block>::<Variable>, plus')
+    lines.append('// LLMessageFields::<Message>::<Block>::%s.' % BLOCK_COUNT)
+    lines.append('namespace LLMessageFields')
+    lines.append('{')
+    for name, blocks in messages:
+        lines.append('namespace %s' % name)
+        lines.append('{')
+        for block_index, (block_name, variables) in enumerate(blocks):
+            lines.append('\tnamespace %s' % block_name)
+            lines.append('\t{')
+            lines.append('\t\tstatic const LLMessageBlockField %s = { "%s", %d, NULL };'
+                         % (BLOCK_COUNT, block_name, block_index))
+            for var_index, (var_name, var_type) in enumerate(variables):
+                if var_name == BLOCK_COUNT:
+                    raise ValueError('%s.%s has a variable named %s' % (name, block_name, BLOCK_COUNT))
+                if var_type in BINARY_TYPES:
+                    field_type = 'LLMessageBinaryField'
+                else:
+                    field_type = 'LLMessageField<%s>' % MVT_TYPES[var_type]
+                lines.append('\t\tstatic const %s %s = { { "%s", "%s", %d, %d, NULL, NULL } };'
+                             % (field_type, identifier(var_name), block_name, var_name, block_index, var_index))
+            lines.append('\t}')
+        lines.append('}')
+    lines.append('}')
+    lines.append('')
+    lines.append('#endif // LL_LLMESSAGEFIELDS_H')
+    lines.append('')
+    text = '\n'.join(lines)
+
+    # Only touch the output when it changes, so dependents aren't rebuilt.
+    try:
+        with open(argv[2], 'r') as f:
+            if f.read() == text:
+                return 0
+    except IOError:
+        pass
+    with open(argv[2], 'w') as f:
+        f.write(text)
+    return 0
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
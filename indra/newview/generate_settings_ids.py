@@ -0,0 +1,143 @@
+#!/usr/bin/env python
+"""\
+@file generate_settings_ids.py
+@brief Generates llviewersettingids.h, a typed, direct-indexed table of the
+       controls declared in app_settings/settings.xml and its includes.
+
+$LicenseInfo:firstyear=2026&license=viewerlgpl$
+Second Life Viewer Source Code
+Copyright (C) 2026, Linden Research, Inc.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation;
+version 2.1 of the License only.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+$/LicenseInfo$
+"""
+
+import os
+import re
+import sys
+import xml.etree.ElementTree as ElementTree
+
+# settings.xml type string -> C++ value type returned by the accessors.
+CPP_TYPES = {
+    'U32': 'U32',
+    'S32': 'S32',
+    'F32': 'F32',
+    'Boolean': 'bool',
+    'String': 'std::string',
+    'Vector3': 'LLVector3',
+    'Vector3D': 'LLVector3d',
+    'Rect': 'LLRect',
+    'Color4': 'LLColor4',
+    'Color3': 'LLColor3',
+    'LLSD': 'LLSD',
+}
+
+def read_settings(path, seen, out):
+    """Append (name, type) for every control in path, following Include."""
+    path = os.path.normpath(path)
+    if path in seen:
+        return
+    seen.add(path)
+    top = ElementTree.parse(path).getroot().find('map')
+    children = list(top)
+    for i in range(0, len(children) - 1, 2):
+        name = children[i].text
+        value = children[i + 1]
+        if name == 'Include':
+            for include in value.findall('string'):
+                read_settings(os.path.join(os.path.dirname(path), include.text), seen, out)
+            continue
+        type_string = None
+        entries = list(value)
+        for j in range(0, len(entries) - 1, 2):
+            if entries[j].text == 'Type':
+                type_string = entries[j + 1].text
+        if type_string in CPP_TYPES:
+            out.append((name, type_string))
+
+def identifier(name):
+    return re.sub(r'[^A-Za-z0-9_]', '_', name)
+
+def main(argv):
+    if len(argv) != 3:
+        sys.stderr.write('usage: %s <settings.xml> <output header>\n' % argv[0])
+        return 1
+
+    settings = []
+    read_settings(argv[1], set(), settings)
+
+    # LLControlGroup::loadFromFile() declares a control the first time it
+    # sees it; later declarations only replace its default and comment, and
+    # must have the same type.
+    unique = []
+    types = {}
+    for name, type_string in settings:
+        if name not in types:
+            types[name] = type_string
+            unique.append((name, type_string))
+        elif types[name] != type_string:
+            sys.stderr.write('%s is declared as both %s and %s\n' % (name, types[name], type_string))
+            return 1
+
+    lines = []
+    lines.append('// Generated by generate_settings_ids.py from %s. Do not edit.' % os.path.basename(argv[1]))
+    lines.append('')
+    lines.append('#ifndef LL_LLVIEWERSETTINGIDS_H')
+    lines.append('#define LL_LLVIEWERSETTINGIDS_H')
+    lines.append('')
+    lines.append('namespace LLSettingID')
+    lines.append('{')
+    lines.append('\tenum EID')
+    lines.append('\t{')
+    for name, type_string in unique:
+        lines.append('\t\t%s,' % identifier(name))
+    lines.append('\t\tCOUNT')
+    lines.append('\t};')
+    lines.append('')
+    lines.append('\tinline const char* const* getNames()')
+    lines.append('\t{')
+    lines.append('\t\tstatic const char* const sNames[COUNT] =')
+    lines.append('\t\t{')
+    for name, type_string in unique:
+        lines.append('\t\t\t"%s",' % name)
+    lines.append('\t\t};')
+    lines.append('\t\treturn sNames;')
+    lines.append('\t}')
+    lines.append('}')
+    lines.append('')
+    lines.append('template<LLSettingID::EID ID> struct LLSettingTraits;')
+    for name, type_string in unique:
+        lines.append('template<> struct LLSettingTraits<LLSettingID::%s> { typedef %s value_t; };'
+                     % (identifier(name), CPP_TYPES[type_string]))
+    lines.append('')
+    lines.append('#endif // LL_LLVIEWERSETTINGIDS_H')
+    lines.append('')
+    text = '\n'.join(lines)
+
+    # Only touch the output when it changes, so dependents aren't rebuilt.
+    try:
+        with open(argv[2], 'r') as f:
+            if f.read() == text:
+                return 0
+    except IOError:
+        pass
+    with open(argv[2], 'w') as f:
+        f.write(text)
+    return 0
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
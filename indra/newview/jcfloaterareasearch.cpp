@@ -202,6 +202,7 @@ void JCFloaterAreaSearch::results()
 	uuid_vec_t selected = mResultList->getSelectedIDs();
 	S32 scrollpos = mResultList->getScrollPos();
 	mResultList->deleteAllItems();
+	mResultList->beginBulkAdd();
 	S32 i;
 	S32 total = gObjectList.getNumObjects();
 
@@ -263,6 +264,7 @@ void JCFloaterAreaSearch::results()
 		}
 	}
 
+	mResultList->endBulkAdd();
 	mResultList->updateSort();
 	mResultList->selectMultiple(selected);
 	mResultList->setScrollPos(scrollpos);
@@ -31,6 +31,7 @@
 #include "llagent.h"
 #include "llcallbacklist.h"
 #include "llinventorymodel.h"
+#include "llsdserialize.h"
 #include "llsdutil.h"
 // [SL:KB] - Patch: Appearance-AISFilter | Checked: 2015-03-01 (Catznip-3.7)
 #include "llviewercontrol.h"
@@ -200,7 +201,8 @@ void AISAPI::RemoveCategory(const LLUUID &categoryId, completion_t callback)
     LLCoprocedureManager::CoProcedure_t proc(boost::bind(&AISAPI::InvokeAISCommandCoro,
         _1, delFn, url, categoryId, LLSD(), callback, REMOVECATEGORY));
 
-    EnqueueAISCommand("RemoveCategory", proc);
+    EnqueueAISCommand("RemoveCategory", proc, LLCoprocedureManager::PRIORITY_NORMAL,
+        getCoalesceKey("RemoveCategory", url, LLSD(), callback));
 }
 
 /*static*/ 
@@ -232,7 +234,8 @@ void AISAPI::RemoveItem(const LLUUID &itemId, completion_t callback)
     LLCoprocedureManager::CoProcedure_t proc(boost::bind(&AISAPI::InvokeAISCommandCoro,
         _1, delFn, url, itemId, LLSD(), callback, REMOVEITEM));
 
-    EnqueueAISCommand("RemoveItem", proc);
+    EnqueueAISCommand("RemoveItem", proc, LLCoprocedureManager::PRIORITY_NORMAL,
+        getCoalesceKey("RemoveItem", url, LLSD(), callback));
 }
 
 void AISAPI::CopyLibraryCategory(const LLUUID& sourceId, const LLUUID& destId, bool copySubfolders, completion_t callback)
@@ -275,7 +278,9 @@ void AISAPI::CopyLibraryCategory(const LLUUID& sourceId, const LLUUID& destId, b
     LLCoprocedureManager::CoProcedure_t proc(boost::bind(&AISAPI::InvokeAISCommandCoro,
         _1, copyFn, url, destId, LLSD(), callback, COPYLIBRARYCATEGORY));
 
-    EnqueueAISCommand("CopyLibraryCategory", proc);
+    // Bulk copies into a fresh folder.  Whatever depends on one waits for its 
+    // callback, so the commands queued after it may go first.
+    EnqueueAISCommand("CopyLibraryCategory", proc, LLCoprocedureManager::PRIORITY_LOW);
 }
 
 /*static*/ 
@@ -307,7 +312,8 @@ void AISAPI::PurgeDescendents(const LLUUID &categoryId, completion_t callback)
     LLCoprocedureManager::CoProcedure_t proc(boost::bind(&AISAPI::InvokeAISCommandCoro,
         _1, delFn, url, categoryId, LLSD(), callback, PURGEDESCENDENTS));
 
-    EnqueueAISCommand("PurgeDescendents", proc);
+    EnqueueAISCommand("PurgeDescendents", proc, LLCoprocedureManager::PRIORITY_NORMAL,
+        getCoalesceKey("PurgeDescendents", url, LLSD(), callback));
 }
 
 
@@ -339,7 +345,8 @@ void AISAPI::UpdateCategory(const LLUUID &categoryId, const LLSD &updates, compl
     LLCoprocedureManager::CoProcedure_t proc(boost::bind(&AISAPI::InvokeAISCommandCoro,
         _1, patchFn, url, categoryId, updates, callback, UPDATECATEGORY));
 
-    EnqueueAISCommand("UpdateCategory", proc);
+    EnqueueAISCommand("UpdateCategory", proc, LLCoprocedureManager::PRIORITY_NORMAL,
+        getCoalesceKey("UpdateCategory", url, updates, callback));
 }
 
 /*static*/
@@ -370,17 +377,35 @@ void AISAPI::UpdateItem(const LLUUID &itemId, const LLSD &updates, completion_t
     LLCoprocedureManager::CoProcedure_t proc(boost::bind(&AISAPI::InvokeAISCommandCoro,
         _1, patchFn, url, itemId, updates, callback, UPDATEITEM));
 
-    EnqueueAISCommand("UpdateItem", proc);
+    EnqueueAISCommand("UpdateItem", proc, LLCoprocedureManager::PRIORITY_NORMAL,
+        getCoalesceKey("UpdateItem", url, updates, callback));
 }
 
 /*static*/
-void AISAPI::EnqueueAISCommand(const std::string &procName, LLCoprocedureManager::CoProcedure_t proc)
+void AISAPI::EnqueueAISCommand(const std::string &procName, LLCoprocedureManager::CoProcedure_t proc,
+    LLCoprocedureManager::EPriority priority, const std::string &coalesceKey)
 {
     std::string procFullName = "AIS(" + procName + ")";
-    LLCoprocedureManager::instance().enqueueCoprocedure("AIS", procFullName, proc);
+    LLCoprocedureManager::instance().enqueueCoprocedure("AIS", procFullName, proc, priority, coalesceKey);
 
 }
 
+/*static*/
+std::string AISAPI::getCoalesceKey(const std::string &procName, const std::string &url, const LLSD &body, 
+    const completion_t &callback)
+{
+    // A coalesced command never runs its own callback.
+    if (callback && !callback.empty())
+    {
+        return std::string();
+    }
+
+    std::ostringstream key;
+    key << procName << " " << url << " ";
+    LLSDSerialize::toNotation(body, key);
+    return key.str();
+}
+
 /*static*/
 void AISAPI::InvokeAISCommandCoro(LLCoreHttpUtil::HttpCoroutineAdapter::ptr_t httpAdapter, 
         invokationFn_t invoke, std::string url, 
@@ -87,7 +87,13 @@ private:
     typedef boost::function < LLSD (LLCoreHttpUtil::HttpCoroutineAdapter::ptr_t, LLCore::HttpRequest::ptr_t,
         const std::string, LLSD, LLCore::HttpOptions::ptr_t, LLCore::HttpHeaders::ptr_t) > invokationFn_t;
 
-    static void EnqueueAISCommand(const std::string &procName, LLCoprocedureManager::CoProcedure_t proc);
+    static void EnqueueAISCommand(const std::string &procName, LLCoprocedureManager::CoProcedure_t proc,
+        LLCoprocedureManager::EPriority priority = LLCoprocedureManager::PRIORITY_NORMAL, 
+        const std::string &coalesceKey = std::string());
+    // Lets an idempotent command that nobody waits on merge with the same 
+    // command still queued right before it.
+    static std::string getCoalesceKey(const std::string &procName, const std::string &url, const LLSD &body, 
+        const completion_t &callback);
 
     static std::string getInvCap();
     static std::string getLibCap();
@@ -116,6 +116,8 @@ static void setting_changed();
 LLAppCoreHttp::HttpClass::HttpClass()
 	: mPolicy(LLCore::HttpRequest::DEFAULT_POLICY_ID),
 	  mConnLimit(0U),
+	  mConnBudget(0U),
+	  mConnApplied(0U),
 	  mPipelined(false)
 {}
 
@@ -442,63 +444,86 @@ void LLAppCoreHttp::refreshSettings(bool initial)
 
 		if (initial || setting != mHttpClasses[app_policy].mConnLimit || pipeline_changed)
 		{
-			// Set it and report.  Strategies depend on pipelining:
-			//
-			// No Pipelining.  Llcorehttp manages connections itself based
-			// on the PO_CONNECTION_LIMIT setting.  Set both limits to the
-			// same value for logical consistency.  In the future, may
-			// hand over connection management to libcurl after the
-			// connection cache has been better vetted.
-			//
-			// Pipelining.  Libcurl is allowed to manage connections to a
-			// great degree.  Steady state will connection limit based on
-			// the per-host setting.  Transitions (region crossings, new
-			// avatars, etc.) can request additional outbound connections
-			// to other servers via 2X total connection limit.
-			//
-			LLCore::HttpHandle handle;
-			handle = mRequest->setPolicyOption(LLCore::HttpRequest::PO_CONNECTION_LIMIT,
-											   mHttpClasses[app_policy].mPolicy,
-											   (mHttpClasses[app_policy].mPipelined ? 2 * setting : setting),
-                                               LLCore::HttpHandler::ptr_t());
-			if (LLCORE_HTTP_HANDLE_INVALID == handle)
+			const U32 budget(mHttpClasses[app_policy].mConnBudget);
+			if (applyConnectionLimit(app_policy, budget ? llmin(setting, budget) : setting))
 			{
-				status = mRequest->getStatus();
-				LL_WARNS("Init") << "Unable to set " << init_data[i].mUsage
-								 << " concurrency.  Reason:  " << status.toString()
-								 << LL_ENDL;
-			}
-			else
-			{
-				handle = mRequest->setPolicyOption(LLCore::HttpRequest::PO_PER_HOST_CONNECTION_LIMIT,
-												   mHttpClasses[app_policy].mPolicy,
-												   setting,
-                                                   LLCore::HttpHandler::ptr_t());
-				if (LLCORE_HTTP_HANDLE_INVALID == handle)
+				mHttpClasses[app_policy].mConnLimit = setting;
+				if (initial && setting != init_data[i].mDefault)
 				{
-					status = mRequest->getStatus();
-					LL_WARNS("Init") << "Unable to set " << init_data[i].mUsage
-									 << " per-host concurrency.  Reason:  " << status.toString()
+					LL_INFOS("Init") << "Application settings overriding default " << init_data[i].mUsage
+									 << " concurrency.  New value:  " << setting
 									 << LL_ENDL;
 				}
-				else
-				{
-					LL_DEBUGS("Init") << "Changed " << init_data[i].mUsage
-									  << " concurrency.  New value:  " << setting
-									  << LL_ENDL;
-					mHttpClasses[app_policy].mConnLimit = setting;
-					if (initial && setting != init_data[i].mDefault)
-					{
-						LL_INFOS("Init") << "Application settings overriding default " << init_data[i].mUsage
-										 << " concurrency.  New value:  " << setting
-										 << LL_ENDL;
-					}
-				}
 			}
 		}
 	}
 }
 
+
+void LLAppCoreHttp::setConnectionBudget(EAppPolicy policy, U32 budget)
+{
+	HttpClass & http_class(mHttpClasses[policy]);
+	http_class.mConnBudget = budget;
+
+	const U32 limit(budget ? llmin(http_class.mConnLimit, budget) : http_class.mConnLimit);
+	if (limit && limit != http_class.mConnApplied)
+	{
+		applyConnectionLimit(policy, limit);
+	}
+}
+
+
+bool LLAppCoreHttp::applyConnectionLimit(EAppPolicy policy, U32 limit)
+{
+	// Set it and report.  Strategies depend on pipelining:
+	//
+	// No Pipelining.  Llcorehttp manages connections itself based
+	// on the PO_CONNECTION_LIMIT setting.  Set both limits to the
+	// same value for logical consistency.  In the future, may
+	// hand over connection management to libcurl after the
+	// connection cache has been better vetted.
+	//
+	// Pipelining.  Libcurl is allowed to manage connections to a
+	// great degree.  Steady state will connection limit based on
+	// the per-host setting.  Transitions (region crossings, new
+	// avatars, etc.) can request additional outbound connections
+	// to other servers via 2X total connection limit.
+	//
+	LLCore::HttpStatus status;
+	LLCore::HttpHandle handle;
+	handle = mRequest->setPolicyOption(LLCore::HttpRequest::PO_CONNECTION_LIMIT,
+									   mHttpClasses[policy].mPolicy,
+									   (mHttpClasses[policy].mPipelined ? 2 * limit : limit),
+									   LLCore::HttpHandler::ptr_t());
+	if (LLCORE_HTTP_HANDLE_INVALID == handle)
+	{
+		status = mRequest->getStatus();
+		LL_WARNS("Init") << "Unable to set " << init_data[policy].mUsage
+						 << " concurrency.  Reason:  " << status.toString()
+						 << LL_ENDL;
+		return false;
+	}
+
+	handle = mRequest->setPolicyOption(LLCore::HttpRequest::PO_PER_HOST_CONNECTION_LIMIT,
+									   mHttpClasses[policy].mPolicy,
+									   limit,
+									   LLCore::HttpHandler::ptr_t());
+	if (LLCORE_HTTP_HANDLE_INVALID == handle)
+	{
+		status = mRequest->getStatus();
+		LL_WARNS("Init") << "Unable to set " << init_data[policy].mUsage
+						 << " per-host concurrency.  Reason:  " << status.toString()
+						 << LL_ENDL;
+		return false;
+	}
+
+	LL_DEBUGS("Init") << "Changed " << init_data[policy].mUsage
+					  << " concurrency.  New value:  " << limit
+					  << LL_ENDL;
+	mHttpClasses[policy].mConnApplied = limit;
+	return true;
+}
+
 LLCore::HttpStatus LLAppCoreHttp::sslVerify(const std::string &url, 
 	const LLCore::HttpHandler::ptr_t &handler, void *appdata)
 {
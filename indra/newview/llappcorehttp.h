@@ -222,6 +222,12 @@ public:
 			return mHttpClasses[policy].mPolicy;
 		}
 
+	// Return the connection limit configured for a policy class.
+	U32 getConnectionLimit(EAppPolicy policy) const
+		{
+			return mHttpClasses[policy].mConnLimit;
+		}
+
 	// Return whether a policy is using pipelined operations.
 	bool isPipelined(EAppPolicy policy) const
 		{
@@ -230,7 +236,15 @@ public:
 
 	// Apply initial or new settings from the environment.
 	void refreshSettings(bool initial);
+
+	// Hold a policy class below its configured connection limit, as
+	// LLAssetFetchScheduler does to share connections between fetchers.
+	// A budget of zero restores the configured limit.
+	void setConnectionBudget(EAppPolicy policy, U32 budget);
 	
+private:
+	bool applyConnectionLimit(EAppPolicy policy, U32 limit);
+
 private:
 	static const F64			MAX_THREAD_WAIT_TIME;
 	
@@ -244,7 +258,9 @@ private:
 
 	public:
 		policy_t					mPolicy;			// Policy class id for the class
-		U32							mConnLimit;
+		U32							mConnLimit;			// Configured limit
+		U32							mConnBudget;		// Cap below mConnLimit, if not zero
+		U32							mConnApplied;		// Limit last set on the policy class
 		bool						mPipelined;
 		boost::signals2::connection mSettingsSignal;	// Signal to global setting that affect this class (if any)
 	};
@@ -39,6 +39,7 @@
 #include "llversioninfo.h"
 #include "llfeaturemanager.h"
 #include "lluictrlfactory.h"
+#include "llxmlnodecache.h"
 #include "lltexteditor.h"
 #include "llerrorcontrol.h"
 #include "lleventtimer.h"
@@ -49,6 +50,7 @@
 #include "llagentwearables.h"
 #include "llwindow.h"
 #include "llviewerstats.h"
+#include "llviewersettingsregistry.h"
 #include "llmarketplacefunctions.h"
 #include "llmarketplacenotifications.h"
 #include "llmd5.h"
@@ -88,6 +90,8 @@
 // [SL:KB] - Patch: Appearance-Misc | Checked: 2013-02-12 (Catznip-3.4)
 #include "llappearancemgr.h"
 // [/SL:KB]
+#include "llassetfetchscheduler.h"
+#include "llpredictiveprefetcher.h"
 #include "llfloaterteleporthistory.h"
 #include "llcrashlogger.h"
 #include "llweb.h"
@@ -124,7 +128,9 @@
 #include "llnotify.h"
 #include "llviewerkeyboard.h"
 #include "lllfsthread.h"
+#include "llworkerpool.h"
 #include "llworkerthread.h"
+#include "lltexlayercompositor.h"
 #include "lltexturecache.h"
 #include "lltexturefetch.h"
 #include "llimageworker.h"
@@ -784,6 +790,7 @@ bool LLAppViewer::init()
 	gDirUtilp->setSkinFolder(gDirUtilp->getSkinFolder(), LLUI::getLanguage());
 	
 	LLUICtrlFactory::getInstance()->setupPaths(); // update paths with correct language set
+	LLXMLNodeCache::setEnabled(gSavedSettings.getBOOL("XUICompiledCache"));
 
 	// Setup LLTrans after LLUI::initClass has been called.
 	LLTrans::parseStrings("strings.xml", default_trans_args);
@@ -1061,6 +1068,9 @@ bool LLAppViewer::init()
     LLCoprocedureManager::getInstance()->setPropertyMethods(
         boost::bind(&LLControlGroup::getU32, boost::ref(gSavedSettings), _1),
         boost::bind(&LLControlGroup::declareU32, boost::ref(gSavedSettings), _1, _2, _3, TRUE));
+    // Pools issue their requests on the default policy class.
+    LLCoprocedureManager::getInstance()->setConnectionLimit(
+        getAppCoreHttp().getConnectionLimit(LLAppCoreHttp::AP_DEFAULT));
 
 	return true;
 }
@@ -1598,6 +1608,11 @@ bool LLAppViewer::cleanup()
 	// shut down mesh streamer
 	gMeshRepo.shutdown();
 
+	if (LLPredictivePrefetcher::instanceExists())
+	{
+		LLPredictivePrefetcher::instance().cleanup();
+	}
+
 	// Must clean up texture references before viewer window is destroyed.
 	if(LLHUDManager::instanceExists())
 	{
@@ -1886,9 +1901,11 @@ bool LLAppViewer::cleanup()
 	LLUIImageList::getInstance()->cleanUp();
 	
 	// This should eventually be done in LLAppViewer
+	LLTexLayerCompositor::cleanupClass();
 	LLImage::cleanupClass();
 	LLVFSThread::cleanupClass();
 	LLLFSThread::cleanupClass();
+	LLWorkerPool::cleanupDefault();
 
 #ifndef LL_RELEASE_FOR_DOWNLOAD
 	LL_INFOS() << "Auditing VFS" << LL_ENDL;
@@ -2267,6 +2284,7 @@ bool LLAppViewer::initConfiguration()
 	//COA vars in gSavedSettings will be linked to gSavedPerAccountSettings entries that will be created if not present.
 	//Signals will be shared between linked vars.
 	gSavedSettings.connectCOAVars(gSavedPerAccountSettings);
+	bind_saved_setting_ids();
 
 	// - set procedural settings 
 	// Note: can't use LL_PATH_PER_SL_ACCOUNT for any of these since we haven't logged in yet
@@ -3490,7 +3508,7 @@ U32 LLAppViewer::getObjectCacheVersion()
 {
 	// Viewer object cache version, change if object update
 	// format changes. JC
-	const U32 INDRA_OBJECT_CACHE_VERSION = 14;
+	const U32 INDRA_OBJECT_CACHE_VERSION = 15;
 
 	return INDRA_OBJECT_CACHE_VERSION;
 }
@@ -3880,19 +3898,25 @@ void LLAppViewer::saveFinalSnapshot()
 
 void LLAppViewer::loadNameCache()
 {
-	// display names cache
+	// display names cache, read on first lookup
+	std::string store_filename =
+		gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "avatar_name_cache.bin");
+	LL_INFOS("AvNameCache") << store_filename << LL_ENDL;
+	LLAvatarNameCache::setCacheFile(store_filename);
+
+	// Move names over from the XML cache older versions wrote.
 	std::string filename =
 		gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "avatar_name_cache.xml");
-	LL_INFOS("AvNameCache") << filename << LL_ENDL;
 	llifstream name_cache_stream(filename.c_str());
 	if(name_cache_stream.is_open())
 	{
 		if ( ! LLAvatarNameCache::importFile(name_cache_stream))
         {
             LL_WARNS("AppInit") << "removing invalid '" << filename << "'" << LL_ENDL;
-            name_cache_stream.close();
-            LLFile::remove(filename);
         }
+		name_cache_stream.close();
+		LLFile::remove(filename);
+		LLAvatarNameCache::flushCacheFile();
 	}
 
 	if (!gCacheName) return;
@@ -3909,13 +3933,7 @@ void LLAppViewer::loadNameCache()
 void LLAppViewer::saveNameCache()
 {
 	// display names cache
-	std::string filename =
-		gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "avatar_name_cache.xml");
-	llofstream name_cache_stream(filename.c_str());
-	if(name_cache_stream.is_open())
-	{
-		LLAvatarNameCache::exportFile(name_cache_stream);
-	}
+	LLAvatarNameCache::flushCacheFile();
 
     // real names cache
 	if (gCacheName)
@@ -4251,6 +4269,7 @@ void LLAppViewer::idle()
 		{
 			gObjectList.update(gAgent, *LLWorld::getInstance());
 		}
+		LLPredictivePrefetcher::instance().update();
 	}
 
 	//////////////////////////////////////
@@ -4703,6 +4722,7 @@ void LLAppViewer::idleNetwork()
 	// Retransmit unacknowledged packets.
 	gXferManager->retransmitUnackedPackets();
 	gAssetStorage->checkForTimeouts();
+	LLAssetFetchScheduler::instance().update();
 	gViewerThrottle.updateDynamicThrottle();
 
 	// Check that the circuit between the viewer and the agent's current
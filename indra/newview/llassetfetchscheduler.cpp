@@ -0,0 +1,365 @@
+/**
+ * @file llassetfetchscheduler.cpp
+ * @brief Shares download capacity between the asset fetchers
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "llassetfetchscheduler.h"
+
+#include "llappcorehttp.h"
+#include "llappviewer.h"
+#include "llsdserialize.h"
+#include "llviewerassetstorage.h"
+#include "llviewercontrol.h"
+
+static const F32 UPDATE_INTERVAL = 0.5f;
+
+// Every class keeps this much so that a new request never waits on a
+// reallocation.
+static const U32 MIN_GRANT = 1;
+
+// Added to a class's priority when weighting it, so that a class with
+// plenty waiting still gets a say against one urgent request.
+static const F32 PRIORITY_FLOOR = 0.25f;
+
+static const F32 THROUGHPUT_SMOOTHING = 0.3f;
+
+static const char* CLASS_NAMES[LLAssetFetchScheduler::AC_COUNT] =
+{
+	"texture",
+	"mesh",
+	"sound",
+	"animation"
+};
+
+LLAssetFetchScheduler::AssetClass::AssetClass()
+:	mActive(0),
+	mWaiting(0),
+	mPriority(0.f),
+	mLimit(0),
+	mGrant(0),
+	mBytes(0),
+	mBytesPerSec(0.f)
+{
+}
+
+LLAssetFetchScheduler::LLAssetFetchScheduler()
+:	mEnabled(false),
+	mHttpPool(0),
+	mTransferPool(0)
+{
+}
+
+// static
+LLAssetFetchScheduler::EAssetClass LLAssetFetchScheduler::classFor(LLAssetType::EType type)
+{
+	switch (type)
+	{
+	case LLAssetType::AT_TEXTURE:
+		return AC_TEXTURE;
+	case LLAssetType::AT_MESH:
+		return AC_MESH;
+	case LLAssetType::AT_SOUND:
+		return AC_SOUND;
+	case LLAssetType::AT_ANIMATION:
+		return AC_ANIMATION;
+	default:
+		return AC_COUNT;
+	}
+}
+
+// static
+const char* LLAssetFetchScheduler::getClassName(EAssetClass cls)
+{
+	return cls < AC_COUNT ? CLASS_NAMES[cls] : "other";
+}
+
+void LLAssetFetchScheduler::reportDemand(EAssetClass cls, U32 active, U32 waiting, F32 priority)
+{
+	AssetClass& asset_class(mClasses[cls]);
+	asset_class.mActive = active;
+	asset_class.mWaiting = waiting;
+	asset_class.mPriority = llclamp(priority, 0.f, 1.f);
+}
+
+void LLAssetFetchScheduler::reportReceived(EAssetClass cls, U32 bytes)
+{
+	mClasses[cls].mBytes += bytes;
+}
+
+F32 LLAssetFetchScheduler::getShare(EAssetClass cls) const
+{
+	const AssetClass& asset_class(mClasses[cls]);
+	if (!mEnabled || !asset_class.mLimit)
+	{
+		return 1.f;
+	}
+	return llmin(1.f, (F32)asset_class.mGrant / (F32)asset_class.mLimit);
+}
+
+bool LLAssetFetchScheduler::admitTransfer(const LLUUID& id, LLAssetType::EType type, F32 importance)
+{
+	EAssetClass cls(classFor(type));
+	if (cls != AC_SOUND && cls != AC_ANIMATION)
+	{
+		return true;
+	}
+
+	AssetClass& asset_class(mClasses[cls]);
+	for (transfer_queue_t::iterator it = asset_class.mQueue.begin(); it != asset_class.mQueue.end(); ++it)
+	{
+		if (it->mID == id && it->mType == type)
+		{
+			// Left behind by a request that was cleaned up; the new
+			// request takes its place.
+			it->mImportance = llmax(it->mImportance, importance);
+			return false;
+		}
+	}
+
+	if (!mEnabled || (asset_class.mQueue.empty() && asset_class.mActive < asset_class.mGrant))
+	{
+		++asset_class.mActive;
+		return true;
+	}
+
+	QueuedTransfer transfer;
+	transfer.mID = id;
+	transfer.mType = type;
+	transfer.mImportance = llclamp(importance, 0.f, 1.f);
+	asset_class.mQueue.push_back(transfer);
+	return false;
+}
+
+void LLAssetFetchScheduler::transferDone(LLAssetType::EType type)
+{
+	EAssetClass cls(classFor(type));
+	if ((cls == AC_SOUND || cls == AC_ANIMATION) && mClasses[cls].mActive)
+	{
+		--mClasses[cls].mActive;
+	}
+}
+
+void LLAssetFetchScheduler::update()
+{
+	if (mUpdateTimer.getElapsedTimeF32() >= UPDATE_INTERVAL)
+	{
+		reallocate();
+	}
+	startQueuedTransfers(AC_SOUND);
+	startQueuedTransfers(AC_ANIMATION);
+}
+
+void LLAssetFetchScheduler::reallocate()
+{
+	static LLCachedControl<bool> enabled(gSavedSettings, "AssetFetchScheduler", true);
+	static LLCachedControl<U32> http_pool(gSavedSettings, "AssetFetchHttpConnections", 16);
+	static LLCachedControl<U32> transfer_pool(gSavedSettings, "AssetFetchTransfers", 16);
+
+	F32 elapsed(mUpdateTimer.getElapsedTimeF32());
+	mUpdateTimer.reset();
+	for (S32 i = 0; i < AC_COUNT; ++i)
+	{
+		AssetClass& asset_class(mClasses[i]);
+		F32 rate(elapsed > 0.f ? asset_class.mBytes / elapsed : 0.f);
+		asset_class.mBytesPerSec += THROUGHPUT_SMOOTHING * (rate - asset_class.mBytesPerSec);
+		asset_class.mBytes = 0;
+		// Queued transfers are the UDP classes' waiting requests.
+		if (i == AC_SOUND || i == AC_ANIMATION)
+		{
+			asset_class.mWaiting = (U32)asset_class.mQueue.size();
+			F32 priority(0.f);
+			for (transfer_queue_t::const_iterator it = asset_class.mQueue.begin(); it != asset_class.mQueue.end(); ++it)
+			{
+				priority = llmax(priority, it->mImportance);
+			}
+			asset_class.mPriority = priority;
+		}
+	}
+
+	const LLAppCoreHttp& app_core_http(LLAppViewer::instance()->getAppCoreHttp());
+	mClasses[AC_TEXTURE].mLimit = app_core_http.getConnectionLimit(LLAppCoreHttp::AP_TEXTURE);
+	mClasses[AC_MESH].mLimit = app_core_http.getConnectionLimit(LLAppCoreHttp::AP_MESH2);
+	mHttpPool = llmax((U32)http_pool, 2 * MIN_GRANT);
+	mTransferPool = llmax((U32)transfer_pool, 2 * MIN_GRANT);
+	mClasses[AC_SOUND].mLimit = mTransferPool;
+	mClasses[AC_ANIMATION].mLimit = mTransferPool;
+
+	bool was_enabled(mEnabled);
+	mEnabled = enabled;
+	if (!mEnabled)
+	{
+		for (S32 i = 0; i < AC_COUNT; ++i)
+		{
+			mClasses[i].mGrant = mClasses[i].mLimit;
+		}
+		if (was_enabled)
+		{
+			applyHttpGrants();
+		}
+		return;
+	}
+
+	U32 old_grants[AC_COUNT];
+	for (S32 i = 0; i < AC_COUNT; ++i)
+	{
+		old_grants[i] = mClasses[i].mGrant;
+	}
+
+	allocate(AC_TEXTURE, AC_SOUND, mHttpPool);
+	allocate(AC_SOUND, AC_COUNT, mTransferPool);
+	applyHttpGrants();
+
+	bool changed(!was_enabled);
+	for (S32 i = 0; i < AC_COUNT; ++i)
+	{
+		changed |= old_grants[i] != mClasses[i].mGrant;
+	}
+	if (changed)
+	{
+		LL_DEBUGS("AssetFetch") << "Reallocated: " << getState() << LL_ENDL;
+	}
+}
+
+// Every class in [first, last) gets MIN_GRANT, then what is left of pool
+// goes out in proportion to demand weighted by priority, never past what
+// a class can use or is allowed.  Anything still left after that is
+// spread evenly, so that an idle class can take a burst straight away.
+void LLAssetFetchScheduler::allocate(S32 first, S32 last, U32 pool)
+{
+	U32 left(pool);
+	U32 wants[AC_COUNT];
+	F32 weights[AC_COUNT];
+	for (S32 i = first; i < last; ++i)
+	{
+		AssetClass& asset_class(mClasses[i]);
+		U32 demand(llmin(asset_class.mActive + asset_class.mWaiting, pool));
+		asset_class.mGrant = llmin(MIN_GRANT, asset_class.mLimit, left);
+		left -= asset_class.mGrant;
+		wants[i] = llclamp(demand, asset_class.mGrant, asset_class.mLimit);
+		weights[i] = (PRIORITY_FLOOR + asset_class.mPriority) * demand;
+	}
+
+	while (left)
+	{
+		F32 total_weight(0.f);
+		for (S32 i = first; i < last; ++i)
+		{
+			if (mClasses[i].mGrant < wants[i])
+			{
+				total_weight += weights[i];
+			}
+		}
+		if (total_weight <= 0.f)
+		{
+			break;
+		}
+
+		U32 given(0);
+		for (S32 i = first; i < last && given < left; ++i)
+		{
+			AssetClass& asset_class(mClasses[i]);
+			if (asset_class.mGrant < wants[i])
+			{
+				U32 share(llmax(1U, (U32)(left * weights[i] / total_weight)));
+				share = llmin(share, wants[i] - asset_class.mGrant, left - given);
+				asset_class.mGrant += share;
+				given += share;
+			}
+		}
+		left -= given;
+	}
+
+	bool gave(true);
+	while (left && gave)
+	{
+		gave = false;
+		for (S32 i = first; i < last && left; ++i)
+		{
+			AssetClass& asset_class(mClasses[i]);
+			if (asset_class.mGrant < asset_class.mLimit)
+			{
+				++asset_class.mGrant;
+				--left;
+				gave = true;
+			}
+		}
+	}
+}
+
+void LLAssetFetchScheduler::startQueuedTransfers(EAssetClass cls)
+{
+	AssetClass& asset_class(mClasses[cls]);
+	LLViewerAssetStorage* storage(static_cast<LLViewerAssetStorage*>(gAssetStorage));
+	while (!asset_class.mQueue.empty() && (!mEnabled || asset_class.mActive < asset_class.mGrant))
+	{
+		// Queues stay short; a scan beats keeping a heap ordered through
+		// importance raises.
+		transfer_queue_t::iterator best(asset_class.mQueue.begin());
+		for (transfer_queue_t::iterator it = best + 1; it != asset_class.mQueue.end(); ++it)
+		{
+			if (it->mImportance > best->mImportance)
+			{
+				best = it;
+			}
+		}
+		QueuedTransfer transfer(*best);
+		asset_class.mQueue.erase(best);
+
+		++asset_class.mActive;
+		if (!storage || !storage->startQueuedTransfer(transfer.mID, transfer.mType))
+		{
+			// Its requests are gone.
+			--asset_class.mActive;
+		}
+	}
+}
+
+void LLAssetFetchScheduler::applyHttpGrants()
+{
+	LLAppCoreHttp& app_core_http(LLAppViewer::instance()->getAppCoreHttp());
+	app_core_http.setConnectionBudget(LLAppCoreHttp::AP_TEXTURE, mEnabled ? mClasses[AC_TEXTURE].mGrant : 0);
+	app_core_http.setConnectionBudget(LLAppCoreHttp::AP_MESH2, mEnabled ? mClasses[AC_MESH].mGrant : 0);
+}
+
+LLSD LLAssetFetchScheduler::getState() const
+{
+	LLSD state;
+	state["enabled"] = mEnabled;
+	state["http_connections"] = (LLSD::Integer)mHttpPool;
+	state["transfers"] = (LLSD::Integer)mTransferPool;
+	for (S32 i = 0; i < AC_COUNT; ++i)
+	{
+		const AssetClass& asset_class(mClasses[i]);
+		LLSD& entry(state["classes"][CLASS_NAMES[i]]);
+		entry["active"] = (LLSD::Integer)asset_class.mActive;
+		entry["waiting"] = (LLSD::Integer)asset_class.mWaiting;
+		entry["priority"] = asset_class.mPriority;
+		entry["limit"] = (LLSD::Integer)asset_class.mLimit;
+		entry["grant"] = (LLSD::Integer)asset_class.mGrant;
+		entry["bytes_per_sec"] = asset_class.mBytesPerSec;
+	}
+	return state;
+}
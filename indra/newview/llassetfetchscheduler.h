@@ -0,0 +1,132 @@
+/**
+ * @file llassetfetchscheduler.h
+ * @brief Shares download capacity between the asset fetchers
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLASSETFETCHSCHEDULER_H
+#define LL_LLASSETFETCHSCHEDULER_H
+
+#include "llassettype.h"
+#include "llsingleton.h"
+#include "lltimer.h"
+#include "lluuid.h"
+
+#include <vector>
+
+// Shares the viewer's download capacity between textures, meshes, sounds
+// and animations, which would otherwise each fill the pipe on their own
+// when arriving in a region.  Every fetcher reports how many requests it
+// has running and waiting and how important its most urgent waiting
+// request is (screen area, distance, avatar size), and a few times a
+// second update() splits the budget between the classes by that demand:
+//
+//  - Textures and meshes share AssetFetchHttpConnections connections.
+//    Grants are applied to their LLCore policy classes as connection
+//    limits, never above the limits the user configured, and the fetchers
+//    scale their request high water marks by getShare().
+//  - Sounds and animations share AssetFetchTransfers UDP transfers.  These
+//    have no policy class, so LLViewerAssetStorage asks admitTransfer()
+//    before starting one and the scheduler queues the rest, starting the
+//    most important queued transfer whenever a slot frees up.
+//
+// Main thread only.
+class LLAssetFetchScheduler : public LLSingleton<LLAssetFetchScheduler>
+{
+public:
+	enum EAssetClass
+	{
+		AC_TEXTURE,
+		AC_MESH,
+		AC_SOUND,
+		AC_ANIMATION,
+		AC_COUNT
+	};
+
+	LLAssetFetchScheduler();
+
+	// The class an asset type is fetched under, or AC_COUNT if none.
+	static EAssetClass classFor(LLAssetType::EType type);
+	static const char* getClassName(EAssetClass cls);
+
+	// active and waiting are request counts.  priority is the importance
+	// of the most urgent waiting request, from 0 to 1.
+	void reportDemand(EAssetClass cls, U32 active, U32 waiting, F32 priority);
+	void reportReceived(EAssetClass cls, U32 bytes);
+
+	// Connections or transfers currently granted to a class.
+	U32 getGrant(EAssetClass cls) const		{ return mClasses[cls].mGrant; }
+	// The grant as a fraction of what the class may use unscheduled.
+	F32 getShare(EAssetClass cls) const;
+
+	// UDP transfers.  Returns true if the transfer may start now.
+	// Otherwise it is queued, or merged with the transfer already queued
+	// for the same asset, and LLViewerAssetStorage::startQueuedTransfer()
+	// is called for it later.  Every admitted transfer must end with
+	// transferDone().
+	bool admitTransfer(const LLUUID& id, LLAssetType::EType type, F32 importance);
+	void transferDone(LLAssetType::EType type);
+
+	// Once a frame.  Starts queued transfers, and reallocates the budget
+	// every UPDATE_INTERVAL.
+	void update();
+
+	// Settings, demand, grants and throughput of every class, for tuning.
+	LLSD getState() const;
+
+private:
+	struct QueuedTransfer
+	{
+		LLUUID				mID;
+		LLAssetType::EType	mType;
+		F32					mImportance;
+	};
+	typedef std::vector<QueuedTransfer> transfer_queue_t;
+
+	struct AssetClass
+	{
+		AssetClass();
+
+		U32					mActive;
+		U32					mWaiting;
+		F32					mPriority;
+		U32					mLimit;			// Most the class may be granted
+		U32					mGrant;
+		U32					mBytes;			// Received since the last reallocation
+		F32					mBytesPerSec;
+		transfer_queue_t	mQueue;			// UDP classes only
+	};
+
+	void reallocate();
+	void allocate(S32 first, S32 last, U32 pool);
+	void startQueuedTransfers(EAssetClass cls);
+	void applyHttpGrants();
+
+	AssetClass	mClasses[AC_COUNT];
+	bool		mEnabled;
+	U32			mHttpPool;
+	U32			mTransferPool;
+	LLTimer		mUpdateTimer;
+};
+
+#endif // LL_LLASSETFETCHSCHEDULER_H
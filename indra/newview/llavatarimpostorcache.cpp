@@ -0,0 +1,563 @@
+/**
+ * @file llavatarimpostorcache.cpp
+ * @brief Atlas of billboards drawn in place of distant avatars
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "llavatarimpostorcache.h"
+
+#include "llviewercamera.h"
+#include "llviewercontrol.h"
+#include "llvoavatar.h"
+#include "pipeline.h"
+
+#include <algorithm>
+
+static LLTrace::BlockTimerStatHandle FTM_IMPOSTOR_CACHE("Impostor Cache");
+
+static const U32 MIN_CELL_SIZE = 32;
+static const U32 MIN_ATLAS_SIZE = 256;
+static const U32 MAX_ATLAS_SIZE = 4096;
+static const U32 MAX_ANGLES = 16;
+
+// An avatar keeps the billboard of the direction it was last seen from
+// until the camera is this far (as a fraction of a direction) past the
+// edge, so that it does not flip between two of them.
+static const F32 ANGLE_HYSTERESIS = 0.1f;
+
+namespace
+{
+	struct Candidate
+	{
+		LLVOAvatar*	mAvatar;
+		S32			mPriority;
+		F32			mWeight;
+
+		bool operator<(const Candidate& rhs) const
+		{
+			return mPriority != rhs.mPriority ? mPriority > rhs.mPriority : mWeight > rhs.mWeight;
+		}
+	};
+
+	// Priorities of the avatars waiting for a billboard
+	enum
+	{
+		WAIT_MOVED = 0,		// Moved or changed distance since it was drawn
+		WAIT_STALE,			// Drawn from another direction or changed appearance
+		WAIT_SKINNED,		// Drawn skinned until it gets one
+		WAIT_INVISIBLE		// Visually muted: not drawn at all until it gets one
+	};
+}
+
+LLAvatarImpostorCache::LLAvatarImpostorCache()
+:	mAtlasSize(0),
+	mAngles(0),
+	mMaxLevel(0),
+	mUsedArea(0),
+	mFrame(0),
+	mUpdates(0),
+	mEvictions(0)
+{
+}
+
+bool LLAvatarImpostorCache::isAvailable() const
+{
+	return LLRenderTarget::sUseFBO;
+}
+
+void LLAvatarImpostorCache::checkSettings()
+{
+	static LLCachedControl<U32> atlas_size(gSavedSettings, "RenderAvatarImpostorAtlasSize", 2048);
+	static LLCachedControl<U32> angles(gSavedSettings, "RenderAvatarImpostorAngles", 8);
+
+	U32 size = MIN_ATLAS_SIZE;
+	while (size < MAX_ATLAS_SIZE && size * 2 <= atlas_size)
+	{
+		size *= 2;
+	}
+	U32 num_angles = llclamp((U32)angles, (U32)1, MAX_ANGLES);
+	if (size != mAtlasSize || num_angles != mAngles)
+	{
+		mAtlasSize = size;
+		mAngles = num_angles;
+		mMaxLevel = 0;
+		while ((mAtlasSize >> (mMaxLevel + 1)) >= MIN_CELL_SIZE)
+		{
+			++mMaxLevel;
+		}
+		reset();
+	}
+}
+
+void LLAvatarImpostorCache::reset()
+{
+	mTarget.release();
+
+	for (entry_map_t::iterator it = mEntries.begin(); it != mEntries.end(); ++it)
+	{
+		LLVOAvatar* avatar = const_cast<LLVOAvatar*>(it->first);
+		avatar->mImpostorSlot = -1;
+		avatar->mNeedsImpostorUpdate = TRUE;
+	}
+	mEntries.clear();
+	mSlots.clear();
+	mFreeSlots.clear();
+
+	mFreeCells.assign(mMaxLevel + 1, std::set<U32>());
+	mFreeCells[0].insert(0);
+	mUsedArea = 0;
+}
+
+void LLAvatarImpostorCache::update()
+{
+	LL_RECORD_BLOCK_TIME(FTM_IMPOSTOR_CACHE);
+
+	checkSettings();
+	++mFrame;
+	mUpdates = 0;
+	if (!isAvailable())
+	{
+		if (!mEntries.empty())
+		{
+			reset();
+		}
+		return;
+	}
+
+	std::vector<Candidate> candidates;
+	for (std::vector<LLCharacter*>::iterator iter = LLCharacter::sInstances.begin();
+		 iter != LLCharacter::sInstances.end(); ++iter)
+	{
+		LLVOAvatar* avatar = (LLVOAvatar*) *iter;
+		if (avatar->isDead() || !avatar->isVisible() || !avatar->wantsImpostor())
+		{
+			continue;
+		}
+
+		Entry& entry = getEntry(avatar);
+		bool muted = avatar->isVisuallyMuted();
+		if (muted != entry.mMuted)
+		{ // Muted avatars are drawn as a grey silhouette
+			entry.mMuted = muted;
+			invalidate(avatar);
+		}
+
+		S32 angle = calcAngle(avatar, entry.mAngle);
+		if (angle != entry.mAngle)
+		{
+			entry.mAngle = angle;
+			S32 index = entry.mSlots[angle];
+			if (index >= 0 && !mSlots[index].mStale)
+			{
+				showSlot(avatar, index);
+				avatar->mNeedsImpostorUpdate = FALSE;
+			}
+			else
+			{
+				avatar->mNeedsImpostorUpdate = TRUE;
+			}
+		}
+
+		if (avatar->mImpostorSlot < 0)
+		{ // Fall back on the nearest direction that is still in the atlas
+			for (U32 i = 1; i <= mAngles / 2 && avatar->mImpostorSlot < 0; ++i)
+			{
+				S32 index = entry.mSlots[(angle + i) % mAngles];
+				if (index < 0)
+				{
+					index = entry.mSlots[(angle + mAngles - i) % mAngles];
+				}
+				if (index >= 0)
+				{
+					showSlot(avatar, index);
+				}
+			}
+			avatar->mNeedsImpostorUpdate = TRUE;
+		}
+
+		S32 current = entry.mSlots[angle];
+		bool up_to_date = current >= 0 && current == avatar->mImpostorSlot && !mSlots[current].mStale;
+		if (avatar->mImpostorSlot >= 0)
+		{
+			mSlots[avatar->mImpostorSlot].mLastShown = mFrame;
+		}
+		if (!up_to_date)
+		{
+			avatar->mNeedsImpostorUpdate = TRUE;
+		}
+
+		if (!avatar->mNeedsImpostorUpdate)
+		{
+			entry.mRequested = mFrame;
+			continue;
+		}
+
+		Candidate candidate;
+		candidate.mAvatar = avatar;
+		if (avatar->mImpostorSlot < 0)
+		{
+			candidate.mPriority = muted ? WAIT_INVISIBLE : WAIT_SKINNED;
+		}
+		else
+		{
+			candidate.mPriority = up_to_date ? WAIT_MOVED : WAIT_STALE;
+		}
+		// Large avatars first, but do not let small ones starve.
+		candidate.mWeight = avatar->mImpostorPixelArea * (F32)(1 + mFrame - entry.mRequested);
+		candidates.push_back(candidate);
+	}
+
+	std::sort(candidates.begin(), candidates.end());
+
+	static LLCachedControl<U32> updates_per_frame(gSavedSettings, "RenderAvatarImpostorUpdatesPerFrame", 4);
+	U32 count = candidates.size();
+	if (updates_per_frame > 0)
+	{
+		count = llmin(count, (U32)updates_per_frame);
+	}
+	for (U32 i = 0; i < count; ++i)
+	{
+		gPipeline.generateImpostor(candidates[i].mAvatar);
+	}
+}
+
+void LLAvatarImpostorCache::removeAvatar(LLVOAvatar* avatar)
+{
+	entry_map_t::iterator it = mEntries.find(avatar);
+	if (it == mEntries.end())
+	{
+		return;
+	}
+	std::vector<S32> slots;
+	slots.swap(it->second.mSlots);
+	mEntries.erase(it);
+	for (std::vector<S32>::iterator iter = slots.begin(); iter != slots.end(); ++iter)
+	{
+		if (*iter >= 0)
+		{
+			freeSlot(*iter);
+		}
+	}
+	avatar->mImpostorSlot = -1;
+}
+
+void LLAvatarImpostorCache::invalidate(LLVOAvatar* avatar)
+{
+	entry_map_t::iterator it = mEntries.find(avatar);
+	if (it == mEntries.end())
+	{
+		return;
+	}
+	std::vector<S32>& slots = it->second.mSlots;
+	for (std::vector<S32>::iterator iter = slots.begin(); iter != slots.end(); ++iter)
+	{
+		if (*iter >= 0)
+		{
+			mSlots[*iter].mStale = true;
+		}
+	}
+	avatar->mNeedsImpostorUpdate = TRUE;
+}
+
+const LLAvatarImpostorCache::Slot* LLAvatarImpostorCache::getSlot(const LLVOAvatar* avatar) const
+{
+	return avatar->mImpostorSlot >= 0 ? &mSlots[avatar->mImpostorSlot] : NULL;
+}
+
+const LLAvatarImpostorCache::Slot* LLAvatarImpostorCache::acquireSlot(LLVOAvatar* avatar, U32 width, U32 height)
+{
+	if (!isAvailable() || !mAtlasSize)
+	{
+		return NULL;
+	}
+
+	Entry& entry = getEntry(avatar);
+	if (entry.mAngle < 0)
+	{
+		entry.mAngle = calcAngle(avatar, -1);
+	}
+
+	width = llclamp(width, (U32)1, mAtlasSize);
+	height = llclamp(height, (U32)1, mAtlasSize);
+	U32 level = getLevel(llmax(width, height));
+
+	S32 index = entry.mSlots[entry.mAngle];
+	if (index >= 0)
+	{
+		Slot& slot = mSlots[index];
+		if (slot.mCellSize == (mAtlasSize >> level))
+		{
+			slot.mWidth = width;
+			slot.mHeight = height;
+			slot.mLastShown = mFrame;
+			return &slot;
+		}
+		freeSlot(index);
+	}
+
+	U32 x, y;
+	while (!allocCell(level, x, y))
+	{
+		if (!evictOne())
+		{
+			return NULL;
+		}
+	}
+
+	if (mFreeSlots.empty())
+	{
+		index = mSlots.size();
+		mSlots.push_back(Slot());
+	}
+	else
+	{
+		index = mFreeSlots.back();
+		mFreeSlots.pop_back();
+	}
+
+	Slot& slot = mSlots[index];
+	slot.mAvatar = avatar;
+	slot.mAngle = entry.mAngle;
+	slot.mX = x;
+	slot.mY = y;
+	slot.mCellSize = mAtlasSize >> level;
+	slot.mWidth = width;
+	slot.mHeight = height;
+	slot.mLastShown = mFrame;
+	slot.mStale = true;
+	slot.mDistance = 0.f;
+	mUsedArea += slot.mCellSize * slot.mCellSize;
+
+	entry.mSlots[entry.mAngle] = index;
+	return &slot;
+}
+
+void LLAvatarImpostorCache::commitSlot(LLVOAvatar* avatar)
+{
+	entry_map_t::iterator it = mEntries.find(avatar);
+	if (it == mEntries.end() || it->second.mAngle < 0)
+	{
+		return;
+	}
+	S32 index = it->second.mSlots[it->second.mAngle];
+	if (index < 0)
+	{
+		return;
+	}
+
+	Slot& slot = mSlots[index];
+	slot.mOffset = avatar->mImpostorOffset;
+	slot.mDim = avatar->mImpostorDim;
+	slot.mExtents[0].set(avatar->mImpostorExtents[0].getF32ptr());
+	slot.mExtents[1].set(avatar->mImpostorExtents[1].getF32ptr());
+	slot.mViewAngle = avatar->mImpostorAngle;
+	slot.mDistance = avatar->mImpostorDistance;
+	slot.mStale = false;
+	slot.mLastShown = mFrame;
+
+	avatar->mImpostorSlot = index;
+	it->second.mRequested = mFrame;
+	++mUpdates;
+}
+
+F32 LLAvatarImpostorCache::getAtlasUsage() const
+{
+	return mAtlasSize ? (F32)mUsedArea / (F32)(mAtlasSize * mAtlasSize) : 0.f;
+}
+
+LLAvatarImpostorCache::Entry& LLAvatarImpostorCache::getEntry(LLVOAvatar* avatar)
+{
+	entry_map_t::iterator it = mEntries.find(avatar);
+	if (it == mEntries.end())
+	{
+		it = mEntries.insert(std::make_pair(avatar, Entry())).first;
+		Entry& entry = it->second;
+		entry.mSlots.assign(mAngles, -1);
+		entry.mAngle = -1;
+		entry.mRequested = mFrame;
+		entry.mMuted = avatar->isVisuallyMuted();
+	}
+	return it->second;
+}
+
+S32 LLAvatarImpostorCache::calcAngle(const LLVOAvatar* avatar, S32 current) const
+{
+	if (mAngles <= 1)
+	{
+		return 0;
+	}
+
+	// Direction of the camera in the avatar's frame
+	LLVector3 dir = LLViewerCamera::getInstance()->getOrigin() - (avatar->getRenderPosition() + avatar->mImpostorOffset);
+	dir = dir * ~avatar->getRenderRotation();
+	F32 yaw = atan2f(dir.mV[VY], dir.mV[VX]);
+	F32 step = F_TWO_PI / (F32)mAngles;
+
+	if (current >= 0)
+	{
+		F32 diff = fmodf(yaw - (F32)current * step + 3.f * F_PI, F_TWO_PI) - F_PI;
+		if (fabsf(diff) <= step * (0.5f + ANGLE_HYSTERESIS))
+		{
+			return current;
+		}
+	}
+
+	S32 angle = ll_round(yaw / step) % (S32)mAngles;
+	return angle < 0 ? angle + (S32)mAngles : angle;
+}
+
+void LLAvatarImpostorCache::showSlot(LLVOAvatar* avatar, S32 index)
+{
+	Slot& slot = mSlots[index];
+	slot.mLastShown = mFrame;
+
+	avatar->mImpostorSlot = index;
+	avatar->mImpostorOffset = slot.mOffset;
+	avatar->mImpostorDim = slot.mDim;
+	avatar->mImpostorExtents[0].load3(slot.mExtents[0].mV);
+	avatar->mImpostorExtents[1].load3(slot.mExtents[1].mV);
+	avatar->mImpostorAngle = slot.mViewAngle;
+	avatar->mImpostorDistance = slot.mDistance;
+}
+
+void LLAvatarImpostorCache::freeSlot(S32 index)
+{
+	Slot& slot = mSlots[index];
+	freeCell(getLevel(slot.mCellSize), slot.mX, slot.mY);
+	mUsedArea -= slot.mCellSize * slot.mCellSize;
+
+	if (LLVOAvatar* avatar = slot.mAvatar)
+	{
+		entry_map_t::iterator it = mEntries.find(avatar);
+		if (it != mEntries.end() && slot.mAngle < it->second.mSlots.size())
+		{
+			it->second.mSlots[slot.mAngle] = -1;
+		}
+		if (avatar->mImpostorSlot == index)
+		{
+			avatar->mImpostorSlot = -1;
+			avatar->mNeedsImpostorUpdate = TRUE;
+		}
+	}
+	slot.mAvatar = NULL;
+	mFreeSlots.push_back(index);
+}
+
+bool LLAvatarImpostorCache::evictOne()
+{
+	// Never what is on screen this frame
+	S32 oldest = -1;
+	U32 oldest_frame = mFrame;
+	for (U32 i = 0; i < mSlots.size(); ++i)
+	{
+		const Slot& slot = mSlots[i];
+		if (slot.mAvatar && slot.mLastShown < oldest_frame)
+		{
+			oldest = i;
+			oldest_frame = slot.mLastShown;
+		}
+	}
+	if (oldest < 0)
+	{
+		return false;
+	}
+	freeSlot(oldest);
+	++mEvictions;
+	return true;
+}
+
+U32 LLAvatarImpostorCache::getLevel(U32 size) const
+{
+	U32 level = 0;
+	while (level < mMaxLevel && (mAtlasSize >> (level + 1)) >= size)
+	{
+		++level;
+	}
+	return level;
+}
+
+bool LLAvatarImpostorCache::allocCell(U32 level, U32& x, U32& y)
+{
+	S32 from = level;
+	while (from >= 0 && mFreeCells[from].empty())
+	{
+		--from;
+	}
+	if (from < 0)
+	{
+		return false;
+	}
+
+	std::set<U32>::iterator first = mFreeCells[from].begin();
+	x = *first >> 16;
+	y = *first & 0xFFFF;
+	mFreeCells[from].erase(first);
+
+	// Split down to the size asked for, keeping the first quarter each time.
+	for (U32 l = from; l < level; ++l)
+	{
+		U32 half = mAtlasSize >> (l + 1);
+		mFreeCells[l + 1].insert(((x + half) << 16) | y);
+		mFreeCells[l + 1].insert((x << 16) | (y + half));
+		mFreeCells[l + 1].insert(((x + half) << 16) | (y + half));
+	}
+	return true;
+}
+
+void LLAvatarImpostorCache::freeCell(U32 level, U32 x, U32 y)
+{
+	while (level > 0)
+	{
+		U32 size = mAtlasSize >> level;
+		U32 parent_x = x & ~(size * 2 - 1);
+		U32 parent_y = y & ~(size * 2 - 1);
+
+		U32 siblings[3];
+		U32 count = 0;
+		for (U32 i = 0; i < 4; ++i)
+		{
+			U32 sibling_x = parent_x + (i & 1) * size;
+			U32 sibling_y = parent_y + (i >> 1) * size;
+			if (sibling_x != x || sibling_y != y)
+			{
+				siblings[count++] = (sibling_x << 16) | sibling_y;
+			}
+		}
+
+		std::set<U32>& cells = mFreeCells[level];
+		if (!cells.count(siblings[0]) || !cells.count(siblings[1]) || !cells.count(siblings[2]))
+		{
+			break;
+		}
+		for (U32 i = 0; i < 3; ++i)
+		{
+			cells.erase(siblings[i]);
+		}
+		x = parent_x;
+		y = parent_y;
+		--level;
+	}
+	mFreeCells[level].insert((x << 16) | y);
+}
@@ -0,0 +1,154 @@
+/**
+ * @file llavatarimpostorcache.h
+ * @brief Atlas of billboards drawn in place of distant avatars
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLAVATARIMPOSTORCACHE_H
+#define LL_LLAVATARIMPOSTORCACHE_H
+
+#include "llrendertarget.h"
+#include "llsingleton.h"
+#include "v2math.h"
+#include "v3math.h"
+
+#include <map>
+#include <set>
+#include <vector>
+
+class LLVOAvatar;
+
+// Keeps the billboards of impostored avatars in a single render target.
+// The atlas is split like a quadtree: each cell is a power of two square
+// that can be halved into four, and a freed cell merges back with its
+// siblings once all four are free.
+//
+// Every avatar has one billboard per direction it is seen from, so that
+// turning around it or watching it turn does not force a redraw as long as
+// the direction has been captured before.  Billboards whose avatar changed
+// appearance are kept on screen but marked stale; when the atlas is full
+// the least recently shown billboards make room for new ones.
+//
+// update() decides which billboards to redraw, most urgent first and no
+// more than RenderAvatarImpostorUpdatesPerFrame of them.  An avatar that
+// has no billboard yet is drawn skinned, except for visually muted ones,
+// which have nothing else to fall back on and are served first.
+//
+// Needs framebuffer objects: without them a render target cannot be drawn
+// into a sub-rectangle.  Main thread only.
+class LLAvatarImpostorCache : public LLSingleton<LLAvatarImpostorCache>
+{
+public:
+	struct Slot
+	{
+		LLVOAvatar*	mAvatar;		// NULL when the slot is free
+		U32			mAngle;
+		U32			mX;
+		U32			mY;
+		U32			mCellSize;
+		U32			mWidth;
+		U32			mHeight;
+		U32			mLastShown;		// Frame
+		bool		mStale;
+
+		// LLVOAvatar values the billboard was rendered with
+		LLVector3	mOffset;
+		LLVector2	mDim;
+		LLVector3	mExtents[2];
+		LLVector3	mViewAngle;
+		F32			mDistance;
+	};
+
+	LLAvatarImpostorCache();
+
+	// Once a frame before the scene is rendered.
+	void update();
+
+	// Releases the atlas and forgets every billboard.
+	void reset();
+
+	// The avatar is going away.
+	void removeAvatar(LLVOAvatar* avatar);
+
+	// The avatar looks different: all of its billboards need redrawing.
+	void invalidate(LLVOAvatar* avatar);
+
+	// The billboard the avatar is drawn with, or NULL.
+	const Slot* getSlot(const LLVOAvatar* avatar) const;
+
+	// For LLPipeline::generateImpostor(): the cell the avatar's current
+	// direction is rendered into, evicting old billboards if needed.  NULL
+	// if there is no room.
+	const Slot* acquireSlot(LLVOAvatar* avatar, U32 width, U32 height);
+
+	// The billboard acquired for the avatar has been rendered.
+	void commitSlot(LLVOAvatar* avatar);
+
+	LLRenderTarget& getTarget()				{ return mTarget; }
+	U32 getAtlasSize() const				{ return mAtlasSize; }
+	bool isAvailable() const;
+
+	U32 getSlotCount() const				{ return mSlots.size() - mFreeSlots.size(); }
+	F32 getAtlasUsage() const;
+	U32 getUpdateCount() const				{ return mUpdates; }
+	U32 getEvictionCount() const			{ return mEvictions; }
+
+private:
+	struct Entry
+	{
+		std::vector<S32>	mSlots;		// Per angle, -1 when missing
+		S32					mAngle;
+		U32					mRequested;	// Frame the avatar started waiting
+		bool				mMuted;
+	};
+	typedef std::map<const LLVOAvatar*, Entry> entry_map_t;
+
+	Entry& getEntry(LLVOAvatar* avatar);
+	S32 calcAngle(const LLVOAvatar* avatar, S32 current) const;
+	void showSlot(LLVOAvatar* avatar, S32 index);
+	void freeSlot(S32 index);
+	bool evictOne();
+	void checkSettings();
+
+	// Quadtree allocator; level 0 is the whole atlas.
+	U32 getLevel(U32 size) const;
+	bool allocCell(U32 level, U32& x, U32& y);
+	void freeCell(U32 level, U32 x, U32 y);
+
+	LLRenderTarget			mTarget;
+	U32						mAtlasSize;
+	U32						mAngles;
+	U32						mMaxLevel;
+	U32						mUsedArea;
+
+	std::vector<std::set<U32> >	mFreeCells;	// Per level, packed x << 16 | y
+	std::vector<Slot>		mSlots;
+	std::vector<S32>		mFreeSlots;
+	entry_map_t				mEntries;
+
+	U32						mFrame;
+	U32						mUpdates;	// Last frame
+	U32						mEvictions;	// Total
+};
+
+#endif // LL_LLAVATARIMPOSTORCACHE_H
@@ -40,6 +40,7 @@
 #include "llmatrix4a.h"
 
 #include "llagent.h" //for gAgent.needsRenderAvatar()
+#include "llavatarimpostorcache.h"
 #include "lldrawable.h"
 #include "lldrawpoolbump.h"
 #include "llface.h"
@@ -624,6 +625,8 @@ void LLDrawPoolAvatar::beginImpostor()
 	{
 		LLVOAvatar::sRenderDistance = llclamp(LLVOAvatar::sRenderDistance, 16.f, 256.f);
 		LLVOAvatar::sNumVisibleAvatars = 0;
+		LLVOAvatar::sNumSkinnedAvatars = 0;
+		LLVOAvatar::sNumImpostorAvatars = 0;
 	}
 
 	if (LLGLSLShader::sNoFixedFunction)
@@ -685,6 +688,8 @@ void LLDrawPoolAvatar::beginDeferredImpostor()
 	{
 		LLVOAvatar::sRenderDistance = llclamp(LLVOAvatar::sRenderDistance, 16.f, 256.f);
 		LLVOAvatar::sNumVisibleAvatars = 0;
+		LLVOAvatar::sNumSkinnedAvatars = 0;
+		LLVOAvatar::sNumImpostorAvatars = 0;
 	}
 
 	sVertexProgram = &gDeferredImpostorProgram;
@@ -1162,19 +1167,28 @@ void LLDrawPoolAvatar::renderAvatars(LLVOAvatar* single_avatar, S32 pass)
 		if (!LLPipeline::sReflectionRender)
 		{
 			LLVOAvatar::sNumVisibleAvatars++;
+			if (impostor)
+			{
+				LLVOAvatar::sNumImpostorAvatars++;
+			}
+			else
+			{
+				LLVOAvatar::sNumSkinnedAvatars++;
+			}
 		}
 
 		if (impostor)
 		{
-			if (LLPipeline::sRenderDeferred && !LLPipeline::sReflectionRender && avatarp->mImpostor.isComplete()) 
+			LLRenderTarget& atlas = LLAvatarImpostorCache::instance().getTarget();
+			if (LLPipeline::sRenderDeferred && !LLPipeline::sReflectionRender && atlas.isComplete()) 
 			{
 				if (normal_channel > -1)
 				{
-					avatarp->mImpostor.bindTexture(2, normal_channel);
+					atlas.bindTexture(2, normal_channel);
 				}
 				if (specular_channel > -1)
 				{
-					avatarp->mImpostor.bindTexture(1, specular_channel);
+					atlas.bindTexture(1, specular_channel);
 				}
 			}
 			avatarp->renderImpostor(LLColor4U(255,255,255,255), sDiffuseChannel);
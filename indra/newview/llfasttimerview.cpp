@@ -51,6 +51,7 @@
 #include "llstat.h"
 
 #include "llfasttimer.h"
+#include "lltracethreadrecorder.h"
 #include "lltreeiterators.h"
 #include "llmetricperformancetester.h"
 #include "llviewerstats.h"
@@ -331,6 +332,22 @@ BOOL LLFastTimerView::handleHover(S32 x, S32 y, MASK mask)
 }
 
 
+// Worker threads report their timers separately, since their time
+// overlaps the main thread's frame.  These are the current smoothed
+// per frame figures, whatever history is being shown.
+static void get_thread_times(BlockTimerStatHandle& timer, ThreadRecorder::child_thread_time_list_t& times)
+{
+	ThreadRecorder* master = get_master_thread_recorder();
+	if (master)
+	{
+		master->getChildThreadTimes(timer, times);
+	}
+	else
+	{
+		times.clear();
+	}
+}
+
 static std::string get_tooltip(BlockTimerStatHandle& timer, S32 history_index, PeriodicRecording& frame_recording)
 {
 	std::string tooltip;
@@ -343,6 +360,13 @@ static std::string get_tooltip(BlockTimerStatHandle& timer, S32 history_index, P
 	{
 		tooltip = llformat("%s (%d ms, %d calls)", timer.getName().c_str(), (S32)F64Milliseconds(frame_recording.getPrevRecording(history_index).getSum(timer)).value(), (S32)frame_recording.getPrevRecording(history_index).getSum(timer.callCount()));
 	}
+
+	ThreadRecorder::child_thread_time_list_t thread_times;
+	get_thread_times(timer, thread_times);
+	for (ThreadRecorder::child_thread_time_list_t::iterator it = thread_times.begin(); it != thread_times.end(); ++it)
+	{
+		tooltip += llformat("\n  %s: %.2f ms, %.1f calls per frame", it->mName.c_str(), F64Milliseconds(it->mTime).value(), it->mCalls);
+	}
 	return tooltip;
 }
 
@@ -1260,6 +1284,7 @@ void LLFastTimerView::drawLegend()
 		S32 cur_line = 0;
 		ft_display_idx.clear();
 		std::map<BlockTimerStatHandle*, S32> display_line;
+		ThreadRecorder::child_thread_time_list_t thread_times;
 		S32 item = 0;
 		for (block_timer_tree_df_iterator_t it = LLTrace::begin_block_timer_tree_df(FTM_FRAME);
 			it != block_timer_tree_df_iterator_t();
@@ -1298,11 +1323,26 @@ void LLFastTimerView::drawLegend()
 				calls = (S32)mRecording.getPeriodMean(idp->callCount(), RUNNING_AVERAGE_WIDTH);
 			}
 
+			F64Milliseconds thread_ms(0);
+			get_thread_times(*idp, thread_times);
+			for (ThreadRecorder::child_thread_time_list_t::iterator thread_it = thread_times.begin(); thread_it != thread_times.end(); ++thread_it)
+			{
+				thread_ms += thread_it->mTime;
+			}
+
 			std::string timer_label;
 			switch(mDisplayType)
 			{
 			case DISPLAY_TIME:
-				timer_label = llformat("%s [%.1f]",idp->getName().c_str(),ms.value());
+				if (thread_ms.value() > 0.0)
+				{
+					// Time on worker threads, per thread in the tooltip
+					timer_label = llformat("%s [%.1f +%.1f]",idp->getName().c_str(),ms.value(),thread_ms.value());
+				}
+				else
+				{
+					timer_label = llformat("%s [%.1f]",idp->getName().c_str(),ms.value());
+				}
 				break;
 			case DISPLAY_CALLS:
 				timer_label = llformat("%s (%d)",idp->getName().c_str(),calls);
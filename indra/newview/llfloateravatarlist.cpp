@@ -657,6 +657,7 @@ void LLFloaterAvatarList::refreshAvatarList()
 	S32 scrollpos = mAvatarList->getScrollPos();
 
 	mAvatarList->deleteAllItems();
+	mAvatarList->beginBulkAdd();
 
 	LLVector3d mypos = gAgent.getPositionGlobal();
 	LLVector3d posagent;
@@ -988,6 +989,7 @@ void LLFloaterAvatarList::refreshAvatarList()
 	}
 
 	// finish
+	mAvatarList->endBulkAdd();
 	mAvatarList->updateSort();
 	mAvatarList->selectMultiple(selected);
 	mAvatarList->setScrollPos(scrollpos);
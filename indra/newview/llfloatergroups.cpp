@@ -314,9 +314,9 @@ void LLPanelGroups::onGroupList()
 	if(!gAgent.getGroupData(group_id,group_data))
 		return;
 
-	bool list_in_profile = item->getColumn(1)->getValue().asBoolean();
-	bool receive_chat = item->getColumn(2)->getValue().asBoolean();
-	bool recieve_notify = item->getColumn(3)->getValue().asBoolean();
+	bool list_in_profile = item->getColumnValue(1).asBoolean();
+	bool receive_chat = item->getColumnValue(2).asBoolean();
+	bool recieve_notify = item->getColumnValue(3).asBoolean();
 	bool update_floaters = false;
 	if(gIMMgr->getIgnoreGroup(group_id) == receive_chat)
 	{
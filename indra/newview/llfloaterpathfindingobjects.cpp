@@ -156,7 +156,7 @@ void LLFloaterPathfindingObjects::draw()
 				LLViewerObject *viewerObject = gObjectList.findObject(selectedItem->getUUID());
 				if (viewerObject != NULL)
 				{
-					const std::string &objectName = selectedItem->getColumn(nameColumnIndex)->getValue().asString();
+					const std::string objectName = selectedItem->getColumnValue(nameColumnIndex).asString();
 					gObjectList.addDebugBeacon(viewerObject->getPositionAgent(), objectName, beaconColor, beaconTextColor, beaconWidth);
 				}
 			}
@@ -357,7 +357,9 @@ void LLFloaterPathfindingObjects::rebuildObjectsScrollList()
 
 	if ((mObjectList != NULL) && !mObjectList->isEmpty())
 	{
+		mObjectsScrollList->beginBulkAdd();
 		buildObjectsScrollList(mObjectList);
+		mObjectsScrollList->endBulkAdd();
 
 		mObjectsScrollList->selectMultiple(mObjectsToBeSelected);
 		if (mHasObjectsToBeSelected)
@@ -705,10 +707,9 @@ void LLFloaterPathfindingObjects::handleObjectNameResponse(const LLPathfindingOb
 		LLScrollListItem *scrollListItem = scrollListItemIter->second;
 		llassert(scrollListItem != NULL);
 
-		LLScrollListCell *scrollListCell = scrollListItem->getColumn(getOwnerNameColumnIndex());
 		LLSD ownerName = getOwnerName(pObject);
 
-		scrollListCell->setValue(ownerName);
+		scrollListItem->setColumnValue(getOwnerNameColumnIndex(), ownerName);
 
 		mMissingNameObjectsScrollListItems.erase(scrollListItemIter);
 	}
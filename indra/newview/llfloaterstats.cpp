@@ -167,6 +167,22 @@ void LLFloaterStats::buildStats()
 	stat_barp->mLabelSpacing = 500.f;
 	stat_barp->mPerSec = TRUE;
 
+	stat_barp = render_statviewp->addStat("Skinned Avatars", &(LLViewerStats::getInstance()->mSkinnedAvatarsStat), "DebugStatModeSkinnedAvatars");
+	stat_barp->setUnitLabel("/fr");
+	stat_barp->mMinBar = 0.f;
+	stat_barp->mMaxBar = 100.f;
+	stat_barp->mTickSpacing = 10.f;
+	stat_barp->mLabelSpacing = 50.f;
+	stat_barp->mPerSec = FALSE;
+
+	stat_barp = render_statviewp->addStat("Impostor Avatars", &(LLViewerStats::getInstance()->mImpostorAvatarsStat), "DebugStatModeImpostorAvatars");
+	stat_barp->setUnitLabel("/fr");
+	stat_barp->mMinBar = 0.f;
+	stat_barp->mMaxBar = 100.f;
+	stat_barp->mTickSpacing = 10.f;
+	stat_barp->mLabelSpacing = 50.f;
+	stat_barp->mPerSec = FALSE;
+
 	stat_barp = render_statviewp->addStat("Object Cache Hit Rate", &(LLViewerStats::getInstance()->mNumNewObjectsStat), std::string(), false, true);
 	stat_barp->setUnitLabel("%");
 	stat_barp->mMinBar = 0.f;
@@ -266,6 +282,9 @@ void LLFloaterStats::buildStats()
 	stat_barp = net_statviewp->addStat("UDP Packets Out", &(LLViewerStats::getInstance()->mPacketsOutStat), "DebugStatModePacketsOut");
 	stat_barp->setUnitLabel("/sec");
 
+	stat_barp = net_statviewp->addStat("UDP Send Calls", &(LLViewerStats::getInstance()->mPacketSendCallsStat), "DebugStatModePacketSendCalls");
+	stat_barp->setUnitLabel("/sec");
+
 	stat_barp = net_statviewp->addStat("UDP Textures", &(LLViewerStats::getInstance()->mUDPTextureKBitStat), "DebugStatModeUDPTexture");
 	stat_barp->setUnitLabel(" kbps");
 	stat_barp->mMinBar = 0.f;
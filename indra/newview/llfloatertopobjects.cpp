@@ -159,6 +159,7 @@ void LLFloaterTopObjects::handleReply(LLMessageSystem *msg, void** data)
 	LLScrollListCtrl *list = getChild<LLScrollListCtrl>("objects_list");
 
 	S32 block_count = msg->getNumberOfBlocks("ReportData");
+	list->beginBulkAdd();
 	for (S32 block = 0; block < block_count; ++block)
 	{
 		U32 task_local_id;
@@ -248,6 +249,7 @@ void LLFloaterTopObjects::handleReply(LLMessageSystem *msg, void** data)
 
 		mtotalScore += score;
 	}
+	list->endBulkAdd();
 
 	if (total_count == 0 && list->getItemCount() == 0)
 	{
@@ -301,9 +303,9 @@ void LLFloaterTopObjects::updateSelectionInfo()
 	llassert(sli);
 	if (sli)
 	{
-		getChild<LLUICtrl>("object_name_editor")->setValue(sli->getColumn(1)->getValue().asString());
-		getChild<LLUICtrl>("owner_name_editor")->setValue(sli->getColumn(2)->getValue().asString());
-		getChild<LLUICtrl>("parcel_name_editor")->setValue(sli->getColumn(4)->getValue().asString());
+		getChild<LLUICtrl>("object_name_editor")->setValue(sli->getColumnValue(1).asString());
+		getChild<LLUICtrl>("owner_name_editor")->setValue(sli->getColumnValue(2).asString());
+		getChild<LLUICtrl>("parcel_name_editor")->setValue(sli->getColumnValue(4).asString());
 	}
 }
 
@@ -500,8 +502,8 @@ void LLFloaterTopObjects::showBeacon()
 	LLScrollListItem* first_selected = list->getFirstSelected();
 	if (!first_selected) return;
 
-	std::string name = first_selected->getColumn(1)->getValue().asString();
-	std::string pos_string =  first_selected->getColumn(3)->getValue().asString();
+	std::string name = first_selected->getColumnValue(1).asString();
+	std::string pos_string =  first_selected->getColumnValue(3).asString();
 
 	F32 x, y, z;
 	S32 matched = sscanf(pos_string.c_str(), "<%g,%g,%g>", &x, &y, &z);
@@ -530,7 +532,7 @@ void LLFloaterTopObjects::onTeleportToObject()
 	LLScrollListItem* first_selected = list->getFirstSelected();
 	if (!first_selected) return;
 
-	std::string pos_string =  first_selected->getColumn(3)->getValue().asString();
+	std::string pos_string =  first_selected->getColumnValue(3).asString();
 
 	F32 x, y, z;
 	S32 matched = sscanf(pos_string.c_str(), "<%g,%g,%g>", &x, &y, &z);
@@ -31,6 +31,7 @@
 
 #include "llagent.h"
 #include "llappviewer.h"
+#include "llassetfetchscheduler.h"
 #include "llbufferstream.h"
 #include "llcallbacklist.h"
 #include "lldatapacker.h"
@@ -57,6 +58,7 @@
 #include "llvolume.h"
 #include "llvolumemgr.h"
 #include "llvovolume.h"
+#include "llworkerpool.h"
 #include "llworld.h"
 #include "material_codes.h"
 #include "pipeline.h"
@@ -67,6 +69,7 @@
 #include "bufferarray.h"
 #include "bufferstream.h"
 #include "llfasttimer.h"
+#include "lltracethreadrecorder.h"
 #include "llcorehttputil.h"
 #include "lltrans.h"
 #include "llstatusbar.h"
@@ -350,6 +353,8 @@ const S32 REQUEST2_HIGH_WATER_MAX = 100;
 const S32 REQUEST2_LOW_WATER_MIN = 16;
 const S32 REQUEST2_LOW_WATER_MAX = 50;
 
+const F32 UNSCORED_MESH_PRIORITY = 0.5f;				// Reported to LLAssetFetchScheduler when the pending requests went unscored
+
 const U32 LARGE_MESH_FETCH_THRESHOLD = 1U << 21;		// Size at which requests goes to narrow/slow queue
 const long SMALL_MESH_XFER_TIMEOUT = 120L;				// Seconds to complete xfer, small mesh downloads
 const long LARGE_MESH_XFER_TIMEOUT = 600L;				// Seconds to complete xfer, large downloads
@@ -848,6 +853,8 @@ LLMeshRepoThread::~LLMeshRepoThread()
 	mSignal = NULL;
 }
 
+static LLTrace::BlockTimerStatHandle FTM_MESH_THREAD("Mesh Repo Thread");
+
 void LLMeshRepoThread::run()
 {
 	LLCDResult res = LLConvexDecomposition::initThread();
@@ -878,6 +885,8 @@ void LLMeshRepoThread::run()
 			break;
 		}
 
+		LL_RECORD_BLOCK_TIME(FTM_MESH_THREAD);
+
 		if (! mHttpRequestSet.empty())
 		{
 			// Dispatch all HttpHandler notifications
@@ -1025,6 +1034,8 @@ void LLMeshRepoThread::run()
 		// For dev purposes only.  A dynamic change could make this false
 		// and that shouldn't assert.
 		// llassert_always(mHttpRequestSet.size() <= sRequestHighWater);
+
+		LLTrace::get_thread_recorder()->pushToParent();
 	}
 
 	if (mSignal->isLocked())
@@ -1947,13 +1958,12 @@ LLMeshUploadThread::DecompRequest::DecompRequest(LLModel* mdl, LLModel* base_mod
 	//copy out positions and indices
 	assignData(mdl) ;	
 
-	mThread->mFinalDecomp = this;
 	mThread->mPhysicsComplete = false;
 }
 
 void LLMeshUploadThread::DecompRequest::completed()
 {
-	if (mThread->mFinalDecomp == this)
+	if (--mThread->mPendingDecomps == 0)
 	{
 		mThread->mPhysicsComplete = true;
 	}
@@ -2213,6 +2223,7 @@ void LLMeshUploadThread::wholeModelToLLSD(LLSD& dest, bool include_textures)
 void LLMeshUploadThread::generateHulls()
 {
 	bool has_valid_requests = false ;
+	mPendingDecomps = 1;
 
 	for (instance_map::iterator iter = mInstance.begin(); iter != mInstance.end(); ++iter)
 	{
@@ -2248,14 +2259,20 @@ void LLMeshUploadThread::generateHulls()
 
 		llassert(physics != NULL);
 
-		DecompRequest* request = new DecompRequest(physics, data.mBaseModel, this);
+		LLPointer<DecompRequest> request = new DecompRequest(physics, data.mBaseModel, this);
 		if(request->isValid())
 		{
+			++mPendingDecomps;
 			gMeshRepo.mDecompThread->submitRequest(request);
 			has_valid_requests = true ;
 		}
 	}
 
+	if (--mPendingDecomps == 0)
+	{
+		mPhysicsComplete = true;
+	}
+
 	if (has_valid_requests)
 	{
 		// *NOTE:  Interesting livelock condition on shutdown.  If there
@@ -3270,6 +3287,38 @@ S32 LLMeshRepository::loadMesh(LLVOVolume* vobj, const LLVolumeParams& mesh_para
 	return detail;
 }
 
+bool LLMeshRepository::prefetchMesh(LLVOVolume* vobj, const LLVolumeParams& mesh_params, S32 detail)
+{
+	if (detail < 0 || detail >= 4)
+	{
+		return false;
+	}
+
+	LLVolume* volume = vobj->getVolume();
+	LLVolumeLODGroup* group = volume ? LLPrimitive::getVolumeManager()->getGroup(volume->getParams()) : NULL;
+	if (group)
+	{
+		LLVolume* lod = group->refLOD(detail);
+		bool loaded = lod && lod->isMeshAssetLoaded() && lod->getNumVolumeFaces() > 0;
+		group->derefLOD(lod);
+		if (loaded)
+		{
+			return false;
+		}
+	}
+
+	LLMutexLock lock(mMeshMutex);
+	mesh_load_map::iterator iter = mLoadingMeshes[detail].find(mesh_params);
+	if (iter != mLoadingMeshes[detail].end())
+	{
+		return false;
+	}
+	mLoadingMeshes[detail][mesh_params].insert(vobj->getID());
+	mPendingRequests.push_back(LLMeshRepoThread::LODRequest(mesh_params, detail));
+	LLMeshRepository::sLODPending++;
+	return true;
+}
+
 void LLMeshRepository::notifyLoadedMeshes()
 { //called from main thread
 	LL_RECORD_BLOCK_TIME(FTM_MESH_FETCH);
@@ -3295,7 +3344,10 @@ void LLMeshRepository::notifyLoadedMeshes()
 				  ? (2 * LLAppCoreHttp::PIPELINING_DEPTH)
 				  : 5);
 
-		LLMeshRepoThread::sMaxConcurrentRequests = gSavedSettings.getU32("Mesh2MaxConcurrentRequests");
+		// Less while LLAssetFetchScheduler has given our connections to
+		// other fetchers.
+		const F32 share(LLAssetFetchScheduler::instance().getShare(LLAssetFetchScheduler::AC_MESH));
+		LLMeshRepoThread::sMaxConcurrentRequests = llmax(1U, U32(gSavedSettings.getU32("Mesh2MaxConcurrentRequests") * share + 0.5f));
 		LLMeshRepoThread::sRequestHighWater = llclamp(scale * S32(LLMeshRepoThread::sMaxConcurrentRequests),
 													  REQUEST2_HIGH_WATER_MIN,
 													  REQUEST2_HIGH_WATER_MAX);
@@ -3429,6 +3481,7 @@ void LLMeshRepository::notifyLoadedMeshes()
 		}
 
 		S32 active_count = LLMeshRepoThread::sActiveHeaderRequests + LLMeshRepoThread::sActiveLODRequests;
+		F32 top_score = mPendingRequests.empty() ? 0.f : UNSCORED_MESH_PRIORITY;
 		if (active_count < LLMeshRepoThread::sRequestLowWater)
 		{
 			S32 push_count = LLMeshRepoThread::sRequestHighWater - active_count;
@@ -3476,6 +3529,7 @@ void LLMeshRepository::notifyLoadedMeshes()
 				//sort by "score"
 				std::partial_sort(mPendingRequests.begin(), mPendingRequests.begin() + push_count,
 								  mPendingRequests.end(), LLMeshRepoThread::CompareScoreGreater());
+				top_score = mPendingRequests.front().mScore;
 			}
 
 			while (!mPendingRequests.empty() && push_count > 0)
@@ -3488,6 +3542,13 @@ void LLMeshRepository::notifyLoadedMeshes()
 			}
 		}
 
+		// Score is angular size, so beyond 1 the mesh fills the view anyway.
+		static U32 reported_bytes = 0;
+		LLAssetFetchScheduler & scheduler(LLAssetFetchScheduler::instance());
+		scheduler.reportDemand(LLAssetFetchScheduler::AC_MESH, active_count, mPendingRequests.size(), llmin(top_score, 1.f));
+		scheduler.reportReceived(LLAssetFetchScheduler::AC_MESH, sBytesReceived - reported_bytes);
+		reported_bytes = sBytesReceived;
+
 		//send skin info requests
 		while (!mPendingSkinRequests.empty())
 		{
@@ -3965,8 +4026,51 @@ F32 LLMeshRepository::getStreamingCost(LLSD& header, F32 radius, S32* bytes, S32
 }
 
 
+// Decompositions running at once, each on its own model.
+static const U32 MAX_DECOMP_THREADS = 4;
+
+// Request being processed by the calling thread, for llcdCallback().
+static LL_THREAD_LOCAL LLPhysicsDecomp::Request* sCurDecompRequest = NULL;
+
+#ifdef ND_HASCONVEXDECOMP_TRACER
+
+// Spreads the cluster costs of one decomposition over the default pool.
+class LLPhysicsDecomp::JobRunner : public ndConvexDecompositionJobRunner
+{
+public:
+	JobRunner(LLWorkerPool* pool)
+	:	mPool(pool)
+	{
+	}
+
+	/*virtual*/ void run(size_t count, void (*job)(void*, size_t), void* data)
+	{
+		// A few chunks per thread, as cluster costs vary a lot.
+		U32 grain = llmax((U32)count / ((mPool->getNumThreads() + 1) * 4), 1U);
+		mPool->parallelFor((U32)count, grain, boost::bind(&JobRunner::runRange, job, data, _1, _2));
+	}
+
+private:
+	static void runRange(void (*job)(void*, size_t), void* data, U32 begin, U32 end)
+	{
+		for (U32 i = begin; i < end; ++i)
+		{
+			job(data, i);
+		}
+	}
+
+	LLWorkerPool* mPool;
+};
+
+#endif
+
 LLPhysicsDecomp::LLPhysicsDecomp()
-:	LLThread("Physics Decomp")
+:	LLThread("Physics Decomp"),
+	mPool(NULL),
+	mJobRunner(NULL),
+	mBatchSize(0),
+	mBatchDone(0),
+	mBatchProgress(0)
 {
 	mInited = false;
 	mQuitting = false;
@@ -3974,12 +4078,38 @@ LLPhysicsDecomp::LLPhysicsDecomp()
 
 	mSignal = new LLCondition();
 	mMutex = new LLMutex();
+
+	U32 threads = 0;
+#ifdef ND_HASCONVEXDECOMP_TRACER
+	ndConvexDecompositionParallel* parallel = dynamic_cast<ndConvexDecompositionParallel*>(LLConvexDecomposition::getInstance());
+	if (parallel)
+	{
+		threads = llclamp(boost::thread::hardware_concurrency() / 2, 1U, MAX_DECOMP_THREADS);
+		// Created here rather than on first use from a pool thread.
+		mJobRunner = new JobRunner(LLWorkerPool::getDefault());
+		parallel->setJobRunner(mJobRunner);
+	}
+#endif
+	mPool = new LLWorkerPool("Physics Decomp", threads);
 }
 
 LLPhysicsDecomp::~LLPhysicsDecomp()
 {
 	shutdown();
 
+	// Waits for the decompositions still running.
+	delete mPool;
+	mPool = NULL;
+
+#ifdef ND_HASCONVEXDECOMP_TRACER
+	if (mJobRunner)
+	{
+		dynamic_cast<ndConvexDecompositionParallel*>(LLConvexDecomposition::getInstance())->setJobRunner(NULL);
+		delete mJobRunner;
+		mJobRunner = NULL;
+	}
+#endif
+
 	delete mSignal;
 	mSignal = NULL;
 	delete mMutex;
@@ -4003,6 +4133,8 @@ void LLPhysicsDecomp::shutdown()
 void LLPhysicsDecomp::submitRequest(LLPhysicsDecomp::Request* request)
 {
 	LLMutexLock lock(mMutex);
+	request->mProgress = 0;
+	++mBatchSize;
 	mRequestQ.push(request);
 	mSignal->signal();
 }
@@ -4010,14 +4142,30 @@ void LLPhysicsDecomp::submitRequest(LLPhysicsDecomp::Request* request)
 //static
 S32 LLPhysicsDecomp::llcdCallback(const char* status, S32 p1, S32 p2)
 {	
-	if (gMeshRepo.mDecompThread && gMeshRepo.mDecompThread->mCurRequest.notNull())
+	Request* request = sCurDecompRequest;
+	LLPhysicsDecomp* decomp_thread = gMeshRepo.mDecompThread;
+	if (request && decomp_thread)
 	{
-		return gMeshRepo.mDecompThread->mCurRequest->statusCallback(status, p1, p2);
+		return request->statusCallback(status, decomp_thread->updateProgress(request, p1), p2);
 	}
 
 	return 1;
 }
 
+S32 LLPhysicsDecomp::updateProgress(Request* request, S32 progress)
+{
+	LLMutexLock lock(mMutex);
+	// HACD reports 0 again while it lists the hulls it made.
+	progress = llclamp(progress, request->mProgress, 100);
+	mBatchProgress += progress - request->mProgress;
+	request->mProgress = progress;
+	if (!mBatchSize)
+	{
+		return progress;
+	}
+	return ((S32)mBatchDone * 100 + mBatchProgress) / (S32)mBatchSize;
+}
+
 bool needTriangles( LLConvexDecomposition *aDC )
 {
 	if( !aDC )
@@ -4043,7 +4191,7 @@ bool needTriangles( LLConvexDecomposition *aDC )
 	return false;
 }
 
-void LLPhysicsDecomp::setMeshData(LLCDMeshData& mesh, bool vertex_based)
+void LLPhysicsDecomp::setMeshData(Request* request, LLCDMeshData& mesh, bool vertex_based)
 {
 	// <singu> HACD
 	if (vertex_based)
@@ -4055,17 +4203,17 @@ void LLPhysicsDecomp::setMeshData(LLCDMeshData& mesh, bool vertex_based)
 	}
 	// </singu>
 
-	mesh.mVertexBase = mCurRequest->mPositions[0].mV;
+	mesh.mVertexBase = request->mPositions[0].mV;
 	mesh.mVertexStrideBytes = 12;
-	mesh.mNumVertices = mCurRequest->mPositions.size();
+	mesh.mNumVertices = request->mPositions.size();
 
 	if(!vertex_based)
 	{
 		mesh.mIndexType = LLCDMeshData::INT_16;
-		mesh.mIndexBase = &(mCurRequest->mIndices[0]);
+		mesh.mIndexBase = &(request->mIndices[0]);
 		mesh.mIndexStrideBytes = 6;
 	
-		mesh.mNumTriangles = mCurRequest->mIndices.size()/3;
+		mesh.mNumTriangles = request->mIndices.size()/3;
 	}
 
 	if ((vertex_based || mesh.mNumTriangles > 0) && mesh.mNumVertices > 2)
@@ -4083,10 +4231,9 @@ void LLPhysicsDecomp::setMeshData(LLCDMeshData& mesh, bool vertex_based)
 	}
 }
 
-void LLPhysicsDecomp::doDecomposition()
+void LLPhysicsDecomp::doDecomposition(Request* request)
 {
 	LLCDMeshData mesh;
-	S32 stage = mStageID[mCurRequest->mStage];
 
 	if (LLConvexDecomposition::getInstance() == NULL)
 	{
@@ -4094,21 +4241,20 @@ void LLPhysicsDecomp::doDecomposition()
 		return;
 	}
 
+	std::map<std::string, S32>::const_iterator stage_iter = mStageID.find(request->mStage);
+	S32 stage = stage_iter != mStageID.end() ? stage_iter->second : 0;
+
 	//load data intoLLCD
 	if (stage == 0)
 	{
-		setMeshData(mesh, false);
+		setMeshData(request, mesh, false);
 	}
 		
 	//build parameter map
 	std::map<std::string, const LLCDParam*> param_map;
 
-	static const LLCDParam* params = NULL;
-	static S32 param_count = 0;
-	if (!params)
-	{
-		param_count = LLConvexDecomposition::getInstance()->getParameters(&params);
-	}
+	const LLCDParam* params = NULL;
+	S32 param_count = LLConvexDecomposition::getInstance()->getParameters(&params);
 	
 	for (S32 i = 0; i < param_count; ++i)
 	{
@@ -4117,7 +4263,7 @@ void LLPhysicsDecomp::doDecomposition()
 
 	U32 ret = LLCD_OK;
 	//set parameter values
-	for (decomp_params::iterator iter = mCurRequest->mParams.begin(); iter != mCurRequest->mParams.end(); ++iter)
+	for (decomp_params::iterator iter = request->mParams.begin(); iter != request->mParams.end(); ++iter)
 	{
 		const std::string& name = iter->first;
 		const LLSD& value = iter->second;
@@ -4145,7 +4291,7 @@ void LLPhysicsDecomp::doDecomposition()
 		}
 	}
 
-	mCurRequest->setStatusMessage("Executing.");
+	request->setStatusMessage("Executing.");
 
 	if (LLConvexDecomposition::getInstance() != NULL)
 	{
@@ -4158,16 +4304,16 @@ void LLPhysicsDecomp::doDecomposition()
 						   << LL_ENDL;
 		LLMutexLock lock(mMutex);
 
-		mCurRequest->mHull.clear();
-		mCurRequest->mHullMesh.clear();
+		request->mHull.clear();
+		request->mHullMesh.clear();
 
-		mCurRequest->setStatusMessage("FAIL");
+		request->setStatusMessage("FAIL");
 		
-		completeCurrent();
+		completeRequest(request);
 	}
 	else
 	{
-		mCurRequest->setStatusMessage("Reading results");
+		request->setStatusMessage("Reading results");
 
 		S32 num_hulls =0;
 		if (LLConvexDecomposition::getInstance() != NULL)
@@ -4177,11 +4323,11 @@ void LLPhysicsDecomp::doDecomposition()
 		
 		{
 			LLMutexLock lock(mMutex);
-			mCurRequest->mHull.clear();
-			mCurRequest->mHull.resize(num_hulls);
+			request->mHull.clear();
+			request->mHull.resize(num_hulls);
 
-			mCurRequest->mHullMesh.clear();
-			mCurRequest->mHullMesh.resize(num_hulls);
+			request->mHullMesh.clear();
+			request->mHullMesh.resize(num_hulls);
 		}
 
 		for (S32 i = 0; i < num_hulls; ++i)
@@ -4204,27 +4350,38 @@ void LLPhysicsDecomp::doDecomposition()
 			// if LLConvexDecomposition is a stub, num_hulls should have been set to 0 above, and we should not reach this code
 			LLConvexDecomposition::getInstance()->getMeshFromStage(stage, i, &mesh);
 
-			get_vertex_buffer_from_mesh(mesh, mCurRequest->mHullMesh[i]);
+			get_vertex_buffer_from_mesh(mesh, request->mHullMesh[i]);
 			
 			{
 				LLMutexLock lock(mMutex);
-				mCurRequest->mHull[i] = p;
+				request->mHull[i] = p;
 			}
 		}
 	
 		{
 			LLMutexLock lock(mMutex);
-			mCurRequest->setStatusMessage("FAIL");
-			completeCurrent();						
+			request->setStatusMessage("FAIL");
+			completeRequest(request);						
 		}
 	}
 }
 
-void LLPhysicsDecomp::completeCurrent()
+void LLPhysicsDecomp::completeRequest(Request* request)
 {
 	LLMutexLock lock(mMutex);
-	mCompletedQ.push(mCurRequest);
-	mCurRequest = NULL;
+	mCompletedQ.push(request);
+	mInFlight.erase(request->mDecompID);
+
+	mBatchProgress -= request->mProgress;
+	++mBatchDone;
+	if (mInFlight.empty() && mRequestQ.empty())
+	{
+		mBatchSize = mBatchDone = 0;
+		mBatchProgress = 0;
+	}
+
+	// Requests waiting for this model can go now.
+	mSignal->signal();
 }
 
 void LLPhysicsDecomp::notifyCompleted()
@@ -4269,7 +4426,7 @@ void make_box(LLPhysicsDecomp::Request * request)
 }
 
 
-void LLPhysicsDecomp::doDecompositionSingleHull()
+void LLPhysicsDecomp::doDecompositionSingleHull(Request* request)
 {
 	LLConvexDecomposition* decomp = LLConvexDecomposition::getInstance();
 
@@ -4281,21 +4438,21 @@ void LLPhysicsDecomp::doDecompositionSingleHull()
 	
 	LLCDMeshData mesh;	
 
-	setMeshData(mesh, true);
+	setMeshData(request, mesh, true);
 
 	LLCDResult ret = decomp->buildSingleHull() ;
 	if(ret)
 	{
 		LL_WARNS(LOG_MESH) << "Could not execute decomposition stage when attempting to create single hull." << LL_ENDL;
-		make_box(mCurRequest);
+		make_box(request);
 	}
 	else
 	{
 		{
 			LLMutexLock lock(mMutex);
-			mCurRequest->mHull.clear();
-			mCurRequest->mHull.resize(1);
-			mCurRequest->mHullMesh.clear();
+			request->mHull.clear();
+			request->mHull.resize(1);
+			request->mHullMesh.clear();
 		}
 
 		std::vector<LLVector3> p;
@@ -4315,12 +4472,12 @@ void LLPhysicsDecomp::doDecompositionSingleHull()
 
 		{
 			LLMutexLock lock(mMutex);
-			mCurRequest->mHull[0] = p;
+			request->mHull[0] = p;
 		}
 	}		
 
 	{
-		completeCurrent();
+		completeRequest(request);
 		
 	}
 }
@@ -4416,40 +4573,69 @@ void LLPhysicsDecomp::run()
 	while (!mQuitting)
 	{
 		mSignal->wait();
-		while (!mQuitting && !mRequestQ.empty())
-		{
-			{
-				LLMutexLock lock(mMutex);
-				mCurRequest = mRequestQ.front();
-				mRequestQ.pop();
-			}
+		dispatchRequests(decomp);
+	}
 
-			S32& id = *(mCurRequest->mDecompID);
-			if (id == -1)
-			{
-				decomp->genDecomposition(id);
-			}
-			decomp->bindDecomposition(id);
+	decomp->quitThread();
+	
+	if (mSignal->isLocked())
+	{ //let go of mSignal's associated mutex
+		mSignal->unlock();
+	}
 
-			if (mCurRequest->mStage == "single_hull")
+	mDone = true;
+}
+
+void LLPhysicsDecomp::dispatchRequests(LLConvexDecomposition* decomp)
+{
+	// mInFlight holds on to the requests until they complete.
+	std::vector<Request*> ready;
+	{
+		LLMutexLock lock(mMutex);
+		request_queue waiting;
+		while (!mRequestQ.empty())
+		{
+			LLPointer<Request> request = mRequestQ.front();
+			mRequestQ.pop();
+			if (mInFlight.find(request->mDecompID) != mInFlight.end())
 			{
-				doDecompositionSingleHull();
+				waiting.push(request);
 			}
 			else
 			{
-				doDecomposition();
-			}		
+				mInFlight[request->mDecompID] = request;
+				ready.push_back(request);
+			}
 		}
+		mRequestQ.swap(waiting);
 	}
 
-	decomp->quitThread();
-	
-	if (mSignal->isLocked())
-	{ //let go of mSignal's associated mutex
-		mSignal->unlock();
+	for (U32 i = 0; i < ready.size() && !mQuitting; ++i)
+	{
+		Request* request = ready[i];
+		S32& id = *(request->mDecompID);
+		if (id == -1)
+		{
+			decomp->genDecomposition(id);
+		}
+		mPool->post(boost::bind(&LLPhysicsDecomp::processRequest, this, request));
 	}
+}
 
-	mDone = true;
+void LLPhysicsDecomp::processRequest(Request* request)
+{
+	LLConvexDecomposition::getInstance()->bindDecomposition(*(request->mDecompID));
+
+	sCurDecompRequest = request;
+	if (request->mStage == "single_hull")
+	{
+		doDecompositionSingleHull(request);
+	}
+	else
+	{
+		doDecomposition(request);
+	}
+	sCurDecompRequest = NULL;
 }
 
 void LLPhysicsDecomp::Request::assignData(LLModel* mdl) 
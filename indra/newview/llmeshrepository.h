@@ -28,6 +28,7 @@
 #define LL_MESH_REPOSITORY_H
 
 #include "llassettype.h"
+#include "llatomic.h"
 #include "llmodel.h"
 #include "lluuid.h"
 #include "llviewertexture.h"
@@ -50,6 +51,7 @@ class LLMutex;
 class LLCondition;
 class LLVFS;
 class LLMeshRepository;
+class LLWorkerPool;
 
 class LLMeshUploadData
 {
@@ -100,6 +102,8 @@ public:
 	class Request : public LLRefCount
 	{
 	public:
+		Request() : mProgress(0) {}
+
 		//input params
 		S32* mDecompID;
 		std::string mStage;
@@ -113,6 +117,7 @@ public:
 		LLModel::convex_hull_decomposition mHull;
 		
 		//status message callback, called from decomposition thread
+		//p1 is the progress of every request submitted since the decomposer was last idle, in percent
 		virtual S32 statusCallback(const char* status, S32 p1, S32 p2) = 0;
 
 		//completed callback, called from the main thread
@@ -130,6 +135,10 @@ public:
 		void assignData(LLModel* mdl) ;
 		void updateTriangleAreaThreshold() ;
 		bool isValidTriangle(U16 idx1, U16 idx2, U16 idx3) ;
+
+	private:
+		friend class LLPhysicsDecomp;
+		S32 mProgress;	// percent, guarded by LLPhysicsDecomp::mMutex
 	};
 
 	LLCondition* mSignal;
@@ -148,13 +157,13 @@ public:
 	static S32 llcdCallback(const char*, S32, S32);
 	void cancel();
 
-	void setMeshData(LLCDMeshData& mesh, bool vertex_based);
-	void doDecomposition();
-	void doDecompositionSingleHull();
+	void setMeshData(Request* request, LLCDMeshData& mesh, bool vertex_based);
+	void doDecomposition(Request* request);
+	void doDecompositionSingleHull(Request* request);
 
 	virtual void run();
 	
-	void completeCurrent();
+	void completeRequest(Request* request);
 	void notifyCompleted();
 
 	std::map<std::string, S32> mStageID;
@@ -162,10 +171,30 @@ public:
 	typedef std::queue<LLPointer<Request> > request_queue;
 	request_queue mRequestQ;
 
-	LLPointer<Request> mCurRequest;
-
 	std::queue<LLPointer<Request> > mCompletedQ;
 
+private:
+	void dispatchRequests(LLConvexDecomposition* decomp);
+	void processRequest(Request* request);
+	S32 updateProgress(Request* request, S32 progress);
+
+	// Requests run on mPool when the decomposition library can bind a
+	// decomposition per thread, each on its own model; otherwise the pool has
+	// no threads and they run one at a time on this thread.
+	LLWorkerPool* mPool;
+	class JobRunner;
+	JobRunner* mJobRunner;
+
+	// Requests handed to mPool, by the decomposition they work on. A request
+	// for a model that is already being decomposed waits in mRequestQ.
+	typedef std::map<S32*, LLPointer<Request> > in_flight_map_t;
+	in_flight_map_t mInFlight;
+
+	// Progress of the requests submitted since mRequestQ and mInFlight were
+	// last both empty, guarded by mMutex.
+	U32 mBatchSize;
+	U32 mBatchDone;
+	S32 mBatchProgress;
 };
 
 class LLMeshRepoThread : public LLThread
@@ -381,7 +410,9 @@ public:
 		void completed();
 	};
 
-	LLPointer<DecompRequest> mFinalDecomp;
+	// Hull requests submitted and not completed yet, plus one held by
+	// generateHulls() while it submits. They complete in any order.
+	LLAtomicS32		mPendingDecomps;
 	volatile bool	mPhysicsComplete;
 
 	typedef std::map<LLPointer<LLModel>, std::vector<LLVector3> > hull_map;
@@ -484,6 +515,9 @@ public:
 
 	//mesh management functions
 	S32 loadMesh(LLVOVolume* volume, const LLVolumeParams& mesh_params, S32 detail = 0, S32 last_lod = -1);
+	// Request a LOD volume is expected to need soon.  Returns false if the
+	// LOD is already loaded or requested.
+	bool prefetchMesh(LLVOVolume* volume, const LLVolumeParams& mesh_params, S32 detail);
 	
 	void notifyLoadedMeshes();
 	void notifyMeshLoaded(const LLVolumeParams& mesh_params, LLVolume* volume);
@@ -228,10 +228,11 @@ LLScrollListItem* LLNameListCtrl::addNameItemRow(
 		fullname.append(suffix);
 	}
 
-	LLScrollListCell* cell = item->getColumn(mNameColumnIndex);
-	if (cell)
+	item->setColumnValue(mNameColumnIndex, fullname);
+	if (pos == ADD_SORTED)
 	{
-		cell->setValue(fullname);
+		// the row was placed before its name was known
+		resortItem(item);
 	}
 
 	dirtyColumns();
@@ -298,10 +299,10 @@ void LLNameListCtrl::onAvatarNameCache(const LLUUID& agent_id,
 	LLNameListItem* list_item = item.get();
 	if (list_item && list_item->getUUID() == agent_id)
 	{
-		LLScrollListCell* cell = list_item->getColumn(mNameColumnIndex);
-		if (cell)
+		if (list_item->hasColumn(mNameColumnIndex))
 		{
-			cell->setValue(name);
+			list_item->setColumnValue(mNameColumnIndex, name);
+			resortItem(list_item);
 			setNeedsSort();
 		}
 	}
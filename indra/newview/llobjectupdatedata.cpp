@@ -0,0 +1,451 @@
+/**
+ * @file llobjectupdatedata.cpp
+ * @brief Object update blocks decoded into plain values
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+
+#include "llviewerprecompiledheaders.h"
+
+#include "llobjectupdatedata.h"
+
+#include "lldatapacker.h"
+#include "llquantize.h"
+#include "llvolumemessage.h"
+#include "message.h"
+
+LLObjectUpdateData::LLObjectUpdateData()
+:	mCompressed(false),
+	mState(0),
+	mHasMotion(false),
+	mPrecision(32),
+	mHasFootPlane(false),
+	mHasAngularVelocity(false),
+	mCRC(0),
+	mUpdateFlags(0),
+	mParentID(0),
+	mMaterial(0),
+	mClickAction(0),
+	mSoundGain(0.f),
+	mSoundFlags(0),
+	mHasText(false),
+	mTextColor(LLColor4U::white),
+	mHasNameValues(false),
+	mParticles(PARTICLES_KEEP),
+	mHasVolumeParams(false),
+	mVolumeParamsValid(false),
+	mHasTextureAnim(false),
+	mHasTEs(false),
+	mTEsValid(true)
+{
+	mTEs.size = 0;
+	mTEs.face_count = 0;
+}
+
+LLNetworkData* LLObjectUpdateData::ExtraParams::get(U16 param_type)
+{
+	return const_cast<LLNetworkData*>(static_cast<const ExtraParams*>(this)->get(param_type));
+}
+
+const LLNetworkData* LLObjectUpdateData::ExtraParams::get(U16 param_type) const
+{
+	switch (param_type)
+	{
+	case LLNetworkData::PARAMS_FLEXIBLE:
+		return &mFlexible;
+	case LLNetworkData::PARAMS_LIGHT:
+		return &mLight;
+	case LLNetworkData::PARAMS_SCULPT:
+		return &mSculpt;
+	case LLNetworkData::PARAMS_LIGHT_IMAGE:
+		return &mLightImage;
+	default:
+		return NULL;
+	}
+}
+
+void LLObjectUpdateData::decodeMotion(const U8* data, S32 length, const RegionInfo& region)
+{
+	const F32 size = region.mWidth;
+	const F32 MAX_HEIGHT = region.mMaxHeight;
+	const F32 MIN_HEIGHT = region.mMinHeight;
+
+	// The quantized fields are U16 arrays at whatever alignment the block
+	// has, so they are copied out rather than read in place.
+	U16 val[4];
+	S32 count = 0;
+
+	switch (length)
+	{
+	case(60 + 16) :
+		// pull out collision normal for avatar
+		htonmemcpy(mFootPlane.mV, &data[count], MVT_LLVector4, sizeof(LLVector4));
+		mHasFootPlane = true;
+		count += sizeof(LLVector4);
+		// fall through
+	case 60:
+		// this is a terse 32 update
+		mHasMotion = true;
+		mPrecision = 32;
+		// pos
+		htonmemcpy(mPosition.mV, &data[count], MVT_LLVector3, sizeof(LLVector3));
+		count += sizeof(LLVector3);
+		// vel
+		htonmemcpy(mVelocity.mV, &data[count], MVT_LLVector3, sizeof(LLVector3));
+		count += sizeof(LLVector3);
+		// acc
+		htonmemcpy(mAcceleration.mV, &data[count], MVT_LLVector3, sizeof(LLVector3));
+		count += sizeof(LLVector3);
+		// theta
+		{
+			LLVector3 vec;
+			htonmemcpy(vec.mV, &data[count], MVT_LLVector3, sizeof(LLVector3));
+			mRotation.unpackFromVector3(vec);
+		}
+		count += sizeof(LLVector3);
+		// omega
+		htonmemcpy(mAngularVelocity.mV, &data[count], MVT_LLVector3, sizeof(LLVector3));
+		mHasAngularVelocity = true;
+		break;
+	case(32 + 16) :
+		// pull out collision normal for avatar
+		htonmemcpy(mFootPlane.mV, &data[count], MVT_LLVector4, sizeof(LLVector4));
+		mHasFootPlane = true;
+		count += sizeof(LLVector4);
+		// fall through
+	case 32:
+		// this is a terse 16 update
+		mHasMotion = true;
+		mPrecision = 16;
+
+		htonmemcpy(val, &data[count], MVT_U16Vec3, 6);
+		count += sizeof(U16) * 3;
+		mPosition.mV[VX] = U16_to_F32(val[VX], -0.5f*size, 1.5f*size);
+		mPosition.mV[VY] = U16_to_F32(val[VY], -0.5f*size, 1.5f*size);
+		mPosition.mV[VZ] = U16_to_F32(val[VZ], MIN_HEIGHT, MAX_HEIGHT);
+
+		htonmemcpy(val, &data[count], MVT_U16Vec3, 6);
+		count += sizeof(U16) * 3;
+		mVelocity.set(U16_to_F32(val[VX], -size, size),
+			U16_to_F32(val[VY], -size, size),
+			U16_to_F32(val[VZ], -size, size));
+
+		htonmemcpy(val, &data[count], MVT_U16Vec3, 6);
+		count += sizeof(U16) * 3;
+		mAcceleration.set(U16_to_F32(val[VX], -size, size),
+			U16_to_F32(val[VY], -size, size),
+			U16_to_F32(val[VZ], -size, size));
+
+		htonmemcpy(val, &data[count], MVT_U16Quat, 8);
+		count += sizeof(U16) * 4;
+		mRotation.mQ[VX] = U16_to_F32(val[VX], -1.f, 1.f);
+		mRotation.mQ[VY] = U16_to_F32(val[VY], -1.f, 1.f);
+		mRotation.mQ[VZ] = U16_to_F32(val[VZ], -1.f, 1.f);
+		mRotation.mQ[VW] = U16_to_F32(val[VW], -1.f, 1.f);
+
+		htonmemcpy(val, &data[count], MVT_U16Vec3, 6);
+		mAngularVelocity.set(U16_to_F32(val[VX], -size, size),
+			U16_to_F32(val[VY], -size, size),
+			U16_to_F32(val[VZ], -size, size));
+		mHasAngularVelocity = true;
+		break;
+
+	case 16:
+		// this is a terse 8 update
+		mHasMotion = true;
+		mPrecision = 8;
+		mPosition.mV[VX] = U8_to_F32(data[0], -0.5f*size, 1.5f*size);
+		mPosition.mV[VY] = U8_to_F32(data[1], -0.5f*size, 1.5f*size);
+		mPosition.mV[VZ] = U8_to_F32(data[2], MIN_HEIGHT, MAX_HEIGHT);
+
+		mVelocity.set(U8_to_F32(data[3], -size, size),
+			U8_to_F32(data[4], -size, size),
+			U8_to_F32(data[5], -size, size));
+
+		mAcceleration.set(U8_to_F32(data[6], -size, size),
+			U8_to_F32(data[7], -size, size),
+			U8_to_F32(data[8], -size, size));
+
+		mRotation.mQ[VX] = U8_to_F32(data[9], -1.f, 1.f);
+		mRotation.mQ[VY] = U8_to_F32(data[10], -1.f, 1.f);
+		mRotation.mQ[VZ] = U8_to_F32(data[11], -1.f, 1.f);
+		mRotation.mQ[VW] = U8_to_F32(data[12], -1.f, 1.f);
+
+		mAngularVelocity.set(U8_to_F32(data[13], -size, size),
+			U8_to_F32(data[14], -size, size),
+			U8_to_F32(data[15], -size, size));
+		mHasAngularVelocity = true;
+		break;
+	default:
+		break;
+	}
+}
+
+void LLObjectUpdateData::decodeCompressedTerse(LLDataPacker& dp)
+{
+	U16 val[4];
+
+	dp.unpackU8(mState, "State");
+
+	U8		value;
+	dp.unpackU8(value, "agent");
+	if (value)
+	{
+		dp.unpackVector4(mFootPlane, "Plane");
+		mHasFootPlane = true;
+	}
+	mHasMotion = true;
+	dp.unpackVector3(mPosition, "Pos");
+	dp.unpackU16(val[VX], "VelX");
+	dp.unpackU16(val[VY], "VelY");
+	dp.unpackU16(val[VZ], "VelZ");
+	mVelocity.set(U16_to_F32(val[VX], -128.f, 128.f),
+				  U16_to_F32(val[VY], -128.f, 128.f),
+				  U16_to_F32(val[VZ], -128.f, 128.f));
+	dp.unpackU16(val[VX], "AccX");
+	dp.unpackU16(val[VY], "AccY");
+	dp.unpackU16(val[VZ], "AccZ");
+	mAcceleration.set(U16_to_F32(val[VX], -64.f, 64.f),
+					  U16_to_F32(val[VY], -64.f, 64.f),
+					  U16_to_F32(val[VZ], -64.f, 64.f));
+
+	dp.unpackU16(val[VX], "ThetaX");
+	dp.unpackU16(val[VY], "ThetaY");
+	dp.unpackU16(val[VZ], "ThetaZ");
+	dp.unpackU16(val[VS], "ThetaS");
+	mRotation.mQ[VX] = U16_to_F32(val[VX], -1.f, 1.f);
+	mRotation.mQ[VY] = U16_to_F32(val[VY], -1.f, 1.f);
+	mRotation.mQ[VZ] = U16_to_F32(val[VZ], -1.f, 1.f);
+	mRotation.mQ[VS] = U16_to_F32(val[VS], -1.f, 1.f);
+	dp.unpackU16(val[VX], "AccX");
+	dp.unpackU16(val[VY], "AccY");
+	dp.unpackU16(val[VZ], "AccZ");
+	mAngularVelocity.set(U16_to_F32(val[VX], -64.f, 64.f),
+						 U16_to_F32(val[VY], -64.f, 64.f),
+						 U16_to_F32(val[VZ], -64.f, 64.f));
+	mHasAngularVelocity = true;
+}
+
+void LLObjectUpdateData::decodeCompressedFull(LLDataPacker& dp, bool is_volume)
+{
+	dp.unpackU8(mState, "State");
+	dp.unpackU32(mCRC, "CRC");
+	dp.unpackU8(mMaterial, "Material");
+	dp.unpackU8(mClickAction, "ClickAction");
+	dp.unpackVector3(mScale, "Scale");
+	mHasMotion = true;
+	dp.unpackVector3(mPosition, "Pos");
+	LLVector3 vec;
+	dp.unpackVector3(vec, "Rot");
+	mRotation.unpackFromVector3(vec);
+
+	U32 value;
+	dp.unpackU32(value, "SpecialCode");
+	dp.setPassFlags(value);
+	dp.unpackUUID(mOwnerID, "Owner");
+
+	if (value & 0x80)
+	{
+		dp.unpackVector3(mAngularVelocity, "Omega");
+		mHasAngularVelocity = true;
+	}
+
+	if (value & 0x20)
+	{
+		dp.unpackU32(mParentID, "ParentID");
+	}
+	else
+	{
+		mParentID = 0;
+	}
+
+	if (value & 0x2)
+	{
+		mData.resize(1);
+		dp.unpackU8(mData[0], "TreeData");
+	}
+	else if (value & 0x1)
+	{
+		U32 size;
+		S32 sp_size;
+		dp.unpackU32(size, "ScratchPadSize");
+		mData.resize(size);
+		if (size)
+		{
+			dp.unpackBinaryData(&mData[0], sp_size, "PartData");
+		}
+	}
+
+	if (value & 0x4)
+	{
+		mHasText = true;
+		dp.unpackString(mText, "Text");
+		dp.unpackBinaryDataFixed(mTextColor.mV, 4, "Color");
+		// alpha was flipped so that it zero encoded better
+		mTextColor.mV[3] = 255 - mTextColor.mV[3];
+	}
+
+	if (value & 0x200)
+	{
+		dp.unpackString(mMediaURL, "MediaURL");
+	}
+
+	//
+	// Unpack particle system data
+	//
+	if (value & 0x8)
+	{
+		mParticles = mParticleData.unpackLegacy(dp) ? PARTICLES_SET : PARTICLES_REMOVE;
+	}
+	else if (!(value & 0x400))
+	{
+		mParticles = PARTICLES_REMOVE;
+	}
+
+	decodeExtraParams(dp);
+
+	if (value & 0x10)
+	{
+		F32 cutoff;
+		dp.unpackUUID(mSoundID, "SoundUUID");
+		dp.unpackF32(mSoundGain, "SoundGain");
+		dp.unpackU8(mSoundFlags, "SoundFlags");
+		dp.unpackF32(cutoff, "SoundRadius");
+	}
+
+	if (value & 0x100)
+	{
+		std::string name_value_list;
+		dp.unpackString(name_value_list, "NV");
+		decodeNameValues(name_value_list);
+	}
+
+	if (!is_volume)
+	{
+		return;
+	}
+
+	mHasVolumeParams = true;
+	mVolumeParamsValid = LLVolumeMessage::unpackVolumeParams(&mVolumeParams, dp);
+
+	decodeTEs(dp);
+
+	if (value & 0x40)
+	{
+		mHasTextureAnim = true;
+		mTextureAnim.unpackTAMessage(dp);
+	}
+
+	if (value & 0x400)
+	{ //particle system (new)
+		mParticles = mParticleData.unpack(dp) ? PARTICLES_SET : PARTICLES_REMOVE;
+	}
+}
+
+void LLObjectUpdateData::decodeNameValues(const std::string& name_value_list)
+{
+	mHasNameValues = true;
+	mNameValues.clear();
+
+	std::string::size_type length = name_value_list.length();
+	std::string::size_type start = 0;
+	while (start < length)
+	{
+		std::string::size_type end = name_value_list.find_first_of("\n", start);
+		if (end == std::string::npos) end = length;
+		if (end > start)
+		{
+			mNameValues.push_back(name_value_list.substr(start, end - start));
+		}
+		start = end+1;
+	}
+}
+
+void LLObjectUpdateData::decodeParticles(const U8* data, S32 size)
+{
+	if (LLPartSysData::isNullPS(data, size) || !mParticleData.unpackBlock(data, size))
+	{
+		mParticles = PARTICLES_REMOVE;
+	}
+	else
+	{
+		mParticles = PARTICLES_SET;
+	}
+}
+
+void LLObjectUpdateData::decodeExtraParams(LLDataPacker& dp)
+{
+	U8 num_parameters;
+	dp.unpackU8(num_parameters, "num_params");
+	U8 param_block[MAX_OBJECT_PARAMS_SIZE];
+	for (U8 param=0; param<num_parameters; ++param)
+	{
+		U16 param_type;
+		S32 param_size;
+		dp.unpackU16(param_type, "param_type");
+		dp.unpackBinaryData(param_block, param_size, "param_data");
+		//LL_INFOS() << "Param type: " << param_type << ", Size: " << param_size << LL_ENDL;
+		if (LLNetworkData::PARAMS_MESH == param_type)
+		{
+			param_type = LLNetworkData::PARAMS_SCULPT;
+		}
+		LLNetworkData* data = mExtraParams.get(param_type);
+		if (!data)
+		{
+			LL_INFOS() << "Unknown param type. (" << llformat("0x%2x",param_type) << ")" << LL_ENDL;
+			continue;
+		}
+		LLDataPackerBinaryBuffer dp2(param_block, param_size);
+		data->unpack(dp2);
+
+		// A type sent twice takes its last value, in its first place.
+		U32 i = 0;
+		while (i < mExtraParams.mCount && mExtraParams.mTypes[i] != param_type)
+		{
+			++i;
+		}
+		if (i == mExtraParams.mCount)
+		{
+			mExtraParams.mTypes[mExtraParams.mCount++] = param_type;
+		}
+	}
+}
+
+void LLObjectUpdateData::decodeTEs()
+{
+	mHasTEs = true;
+	LLPrimitive::parseTEBuffer(mTEs.packed_buffer, mTEs.size, LLTEContents::MAX_TES, mTEs);
+}
+
+void LLObjectUpdateData::decodeTEs(LLDataPacker& dp)
+{
+	mHasTEs = true;
+	S32 size;
+	if (!dp.unpackBinaryData(mTEs.packed_buffer, size, "TextureEntry"))
+	{
+		LL_WARNS() << "Bad texture entry block!  Abort!" << LL_ENDL;
+		mTEsValid = false;
+		return;
+	}
+	LLPrimitive::parseTEBuffer(mTEs.packed_buffer, size, LLTEContents::MAX_TES, mTEs);
+}
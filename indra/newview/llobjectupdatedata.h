@@ -0,0 +1,161 @@
+/**
+ * @file llobjectupdatedata.h
+ * @brief Object update blocks decoded into plain values
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+
+#ifndef LL_LLOBJECTUPDATEDATA_H
+#define LL_LLOBJECTUPDATEDATA_H
+
+#include "llpartdata.h"
+#include "llprimitive.h"
+#include "lltextureanim.h"
+#include "llvolume.h"
+#include "v4coloru.h"
+
+#include <string>
+#include <vector>
+
+class LLDataPacker;
+
+// One ObjectData block of an object update message, decoded into plain
+// values by the decode phase of LLViewerObjectList::processObjectUpdate()
+// and applied by LLViewerObject::processUpdateMessage() and its overrides.
+//
+// The decoders touch nothing but the structure, so the object list runs
+// them on the worker pool. Whatever needs the message system, the object
+// list or global tables (reading message fields, parsing name-value pairs,
+// creating particle sources) stays with the main thread.
+struct LLObjectUpdateData
+{
+	// What the motion data is quantized against, read on the main thread.
+	struct RegionInfo
+	{
+		F32		mWidth;
+		F32		mMinHeight;
+		F32		mMaxHeight;
+	};
+
+	enum EParticles
+	{
+		PARTICLES_KEEP,			// The update doesn't mention them
+		PARTICLES_REMOVE,
+		PARTICLES_SET			// To mParticleData
+	};
+
+	// Extra parameters, at most one of each type, in the order received.
+	struct ExtraParams
+	{
+		enum { MAX_TYPES = 4 };
+
+		ExtraParams() : mCount(0) {}
+
+		// NULL for types the viewer doesn't know.
+		LLNetworkData* get(U16 param_type);
+		const LLNetworkData* get(U16 param_type) const;
+
+		U16						mTypes[MAX_TYPES];
+		U32						mCount;
+		LLFlexibleObjectData	mFlexible;
+		LLLightParams			mLight;
+		LLSculptParams			mSculpt;
+		LLLightImageParams		mLightImage;
+	};
+
+	LLObjectUpdateData();
+
+	// The ObjectData field of ObjectUpdate.
+	void decodeMotion(const U8* data, S32 length, const RegionInfo& region);
+	// An ImprovedTerseObjectUpdate Data field, past the LocalID.
+	void decodeCompressedTerse(LLDataPacker& dp);
+	// An ObjectUpdateCompressed Data field or an object cache entry, past
+	// the ID, LocalID and PCode. Volume parameters, texture entries and
+	// texture animation follow the common fields for volumes only.
+	void decodeCompressedFull(LLDataPacker& dp, bool is_volume);
+
+	// The NameValue field of ObjectUpdate, or the same in a compressed
+	// update: \n separated pairs.
+	void decodeNameValues(const std::string& name_value_list);
+	// The PSBlock field of ObjectUpdate.
+	void decodeParticles(const U8* data, S32 size);
+	// The ExtraParams field of ObjectUpdate, or the same in a compressed
+	// update.
+	void decodeExtraParams(LLDataPacker& dp);
+	// Parses mTEs.packed_buffer, for as many faces as an object may have;
+	// LLPrimitive::applyParsedTEMessage() clamps to its own.
+	void decodeTEs();
+	// A TextureEntry field packed with its length in front, as in
+	// ImprovedTerseObjectUpdate and compressed updates.
+	void decodeTEs(LLDataPacker& dp);
+
+	bool				mCompressed;	// From a compressed update or the object cache
+	U8					mState;
+
+	// Motion. A full compressed update carries only the position and
+	// rotation, and the angular velocity if mHasAngularVelocity.
+	bool				mHasMotion;
+	S32					mPrecision;		// Bits per component, 32, 16 or 8
+	bool				mHasFootPlane;
+	LLVector4			mFootPlane;
+	LLVector3			mPosition;
+	LLVector3			mVelocity;
+	LLVector3			mAcceleration;
+	LLQuaternion		mRotation;
+	bool				mHasAngularVelocity;
+	LLVector3			mAngularVelocity;
+
+	// Full updates.
+	U32					mCRC;
+	U32					mUpdateFlags;
+	U32					mParentID;
+	U8					mMaterial;
+	U8					mClickAction;
+	LLVector3			mScale;
+	LLUUID				mOwnerID;
+	LLUUID				mSoundID;
+	F32					mSoundGain;
+	U8					mSoundFlags;
+	std::vector<U8>		mData;			// Generic data, empty for none
+	bool				mHasText;
+	std::string			mText;
+	LLColor4U			mTextColor;		// Alpha already flipped back
+	std::string			mMediaURL;
+	bool				mHasNameValues;
+	std::vector<std::string> mNameValues;
+	EParticles			mParticles;
+	LLPartSysData		mParticleData;
+	ExtraParams			mExtraParams;
+
+	// Volumes.
+	bool				mHasVolumeParams;
+	bool				mVolumeParamsValid;
+	LLVolumeParams		mVolumeParams;
+	bool				mHasTextureAnim;
+	LLTextureAnim		mTextureAnim;
+	bool				mHasTEs;
+	bool				mTEsValid;
+	LLTEContents		mTEs;
+};
+
+#endif // LL_LLOBJECTUPDATEDATA_H
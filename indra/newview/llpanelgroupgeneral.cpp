@@ -810,6 +810,7 @@ void LLPanelGroupGeneral::updateMembers()
 
 	LLAvatarName av_name;
 
+	mListVisibleMembers->beginBulkAdd();
 	for( ; mMemberProgress != gdatap->mMembers.end() && !update_time.hasExpired(); 
 			++mMemberProgress)
 	{
@@ -838,6 +839,7 @@ void LLPanelGroupGeneral::updateMembers()
 			mAvatarNameCacheConnections[mMemberProgress->first] = LLAvatarNameCache::get(mMemberProgress->first, boost::bind(&LLPanelGroupGeneral::onNameCache, this, gdatap->getMemberVersion(), member, _2, _1));
 		}
 	}
+	mListVisibleMembers->endBulkAdd();
 
 	getChild<LLUICtrl>("text_owners_and_visible_members")->setTextArg("[COUNT]", boost::lexical_cast<std::string>(gdatap->mMembers.size()));
 
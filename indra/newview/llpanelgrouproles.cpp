@@ -1768,6 +1768,7 @@ void LLPanelGroupMembersSubTab::updateMembers()
 	LLTimer update_time;
 	update_time.setTimerExpirySec(UPDATE_MEMBERS_SECONDS_PER_FRAME);
 
+	mMembersList->beginBulkAdd();
 	for( ; mMemberProgress != end && !update_time.hasExpired(); ++mMemberProgress)
 	{
 		if (!mMemberProgress->second)
@@ -1798,6 +1799,7 @@ void LLPanelGroupMembersSubTab::updateMembers()
 			mAvatarNameCacheConnections[mMemberProgress->first] = LLAvatarNameCache::get(mMemberProgress->first, boost::bind(&LLPanelGroupMembersSubTab::onNameCache, this, gdatap->getMemberVersion(), mMemberProgress->second, _2, _1));
 		}
 	}
+	mMembersList->endBulkAdd();
 
 	if (mMemberProgress == end)
 	{
@@ -0,0 +1,359 @@
+/**
+ * @file llpredictiveprefetcher.cpp
+ * @brief Fetches textures and meshes ahead of the camera
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "llpredictiveprefetcher.h"
+
+#include "llagent.h"
+#include "lldrawable.h"
+#include "llmeshrepository.h"
+#include "llsdserialize.h"
+#include "llspatialpartition.h"
+#include "llviewercamera.h"
+#include "llviewercontrol.h"
+#include "llviewerobjectlist.h"
+#include "llviewerregion.h"
+#include "llviewertexturelist.h"
+#include "llvovolume.h"
+#include "llworld.h"
+#include "pipeline.h"
+
+#include <set>
+
+static LLTrace::BlockTimerStatHandle FTM_PREDICTIVE_PREFETCH("Predictive Prefetch");
+
+static const F32 PREDICT_INTERVAL = 0.25f;
+
+// Faster than this is a teleport or a region crossing, not motion.
+static const F32 MAX_CAMERA_SPEED = 128.f;
+static const F32 VELOCITY_SMOOTHING = 0.2f;
+
+// Fractions of the lookahead the camera is predicted at.
+static const F32 PREDICT_STEPS[] = { 0.5f, 1.f };
+
+// Prefetched textures ask for this much of their predicted size, so that
+// they never win over something already on screen.
+static const F32 TEXTURE_SIZE_SCALE = 0.25f;
+static const F32 MIN_PIXEL_AREA = 64.f;
+
+static const U32 MAX_TEXTURES = 256;
+static const U32 MAX_PREDICTIONS = 512;
+
+// An object not seen this long after being prefetched was a miss.
+static const F64 PREDICTION_TIMEOUT = 15.0;
+
+LLPredictivePrefetcher::LLPredictivePrefetcher()
+:	mHaveOrigin(false),
+	mIssued(0),
+	mHits(0),
+	mLate(0),
+	mWasted(0),
+	mTextureFetches(0),
+	mMeshFetches(0)
+{
+}
+
+void LLPredictivePrefetcher::update()
+{
+	LL_RECORD_BLOCK_TIME(FTM_PREDICTIVE_PREFETCH);
+
+	static LLCachedControl<bool> enabled(gSavedSettings, "PrefetchPredictive", true);
+	if (!enabled || gAgent.getTeleportState() != LLAgent::TELEPORT_NONE)
+	{
+		reset();
+		return;
+	}
+
+	updateVelocity();
+	checkPredictions();
+
+	// Texture stats are cleared each time a texture is processed, so they
+	// have to be added again every frame.
+	F64 now = LLTimer::getTotalSeconds();
+	for (texture_list_t::iterator it = mTextures.begin(); it != mTextures.end();)
+	{
+		if (it->mExpires < now || it->mImage->isFullyLoaded())
+		{
+			it = mTextures.erase(it);
+		}
+		else
+		{
+			it->mImage->addTextureStats(it->mVirtualSize);
+			++it;
+		}
+	}
+
+	if (mPredictTimer.getElapsedTimeF32() >= PREDICT_INTERVAL)
+	{
+		mPredictTimer.reset();
+		predict();
+	}
+}
+
+void LLPredictivePrefetcher::cleanup()
+{
+	if (mIssued)
+	{
+		LL_INFOS("Prefetch") << "Predictive prefetch: " << getStats() << LL_ENDL;
+	}
+	reset();
+}
+
+LLSD LLPredictivePrefetcher::getStats() const
+{
+	LLSD stats;
+	stats["issued"] = (LLSD::Integer)mIssued;
+	stats["hits"] = (LLSD::Integer)mHits;
+	stats["late"] = (LLSD::Integer)mLate;
+	stats["wasted"] = (LLSD::Integer)mWasted;
+	U32 resolved = mHits + mLate + mWasted;
+	stats["hit_rate"] = resolved ? (F32)mHits / (F32)resolved : 0.f;
+	stats["textures"] = (LLSD::Integer)mTextureFetches;
+	stats["meshes"] = (LLSD::Integer)mMeshFetches;
+	return stats;
+}
+
+void LLPredictivePrefetcher::reset()
+{
+	mHaveOrigin = false;
+	mVelocity.clearVec();
+	mTextures.clear();
+	mPredictions.clear();
+}
+
+void LLPredictivePrefetcher::updateVelocity()
+{
+	F32 dt = mFrameTimer.getElapsedTimeAndResetF32();
+	const LLVector3& origin = LLViewerCamera::getInstance()->getOrigin();
+	if (mHaveOrigin && dt > 0.f)
+	{
+		LLVector3 velocity = (origin - mLastOrigin) / dt;
+		if (velocity.magVec() > MAX_CAMERA_SPEED)
+		{
+			mVelocity.clearVec();
+		}
+		else
+		{
+			mVelocity = lerp(mVelocity, velocity, VELOCITY_SMOOTHING);
+		}
+	}
+	mLastOrigin = origin;
+	mHaveOrigin = true;
+}
+
+void LLPredictivePrefetcher::predict()
+{
+	static LLCachedControl<F32> lookahead(gSavedSettings, "PrefetchLookaheadSeconds", 3.f);
+	static LLCachedControl<F32> min_speed(gSavedSettings, "PrefetchMinSpeed", 2.f);
+	if (mVelocity.magVec() < min_speed || mPredictions.size() >= MAX_PREDICTIONS)
+	{
+		return;
+	}
+
+	LLViewerCamera* viewer_camera = LLViewerCamera::getInstance();
+	std::set<LLDrawable*> seen;
+	for (U32 step = 0; step < LL_ARRAY_SIZE(PREDICT_STEPS); ++step)
+	{
+		LLVector3 offset = mVelocity * (lookahead * PREDICT_STEPS[step]);
+
+		LLCamera camera = *viewer_camera;
+		LLVector3 frust[LLCamera::AGENT_FRUSTRUM_NUM];
+		for (S32 i = 0; i < LLCamera::AGENT_FRUSTRUM_NUM; ++i)
+		{
+			frust[i] = viewer_camera->mAgentFrustum[i] + offset;
+		}
+		camera.setOrigin(viewer_camera->getOrigin() + offset);
+		camera.calcAgentFrustumPlanes(frust);
+
+		// Bridges are left out: their cull marks the drawables under them
+		// visible.
+		std::vector<LLDrawable*> drawables;
+		const LLWorld::region_list_t& regions = LLWorld::getInstance()->getRegionList();
+		for (LLWorld::region_list_t::const_iterator iter = regions.begin(); iter != regions.end(); ++iter)
+		{
+			LLSpatialPartition* part = (*iter)->getSpatialPartition(LLViewerRegion::PARTITION_VOLUME);
+			if (part)
+			{
+				part->cull(camera, &drawables);
+			}
+		}
+
+		for (std::vector<LLDrawable*>::iterator iter = drawables.begin(); iter != drawables.end(); ++iter)
+		{
+			if (mPredictions.size() >= MAX_PREDICTIONS)
+			{
+				return;
+			}
+			if (seen.insert(*iter).second)
+			{
+				prefetchObject(*iter, camera);
+			}
+		}
+	}
+}
+
+void LLPredictivePrefetcher::prefetchObject(LLDrawable* drawable, LLCamera& camera)
+{
+	if (!drawable || drawable->isDead() || drawable->isVisible())
+	{
+		return;
+	}
+	LLViewerObject* vobj = drawable->getVObj();
+	if (!vobj || vobj->isDead() || vobj->getPCode() != LL_PCODE_VOLUME || vobj->isAttachment()
+		|| mPredictions.find(vobj->getID()) != mPredictions.end())
+	{
+		return;
+	}
+
+	const LLVector4a* ext = drawable->getSpatialExtents();
+	LLVector4a center, size;
+	center.setAdd(ext[0], ext[1]);
+	center.mul(0.5f);
+	size.setSub(ext[1], ext[0]);
+	size.mul(0.5f);
+	F32 pixel_area = LLPipeline::calcPixelArea(center, size, camera);
+	if (pixel_area < MIN_PIXEL_AREA)
+	{
+		return;
+	}
+
+	U32 textures = 0;
+	for (U8 te = 0; te < vobj->getNumTEs(); ++te)
+	{
+		LLViewerFetchedTexture* image = LLViewerTextureManager::staticCastToFetchedTexture(vobj->getTEImage(te));
+		if (image && addTexture(image, pixel_area * TEXTURE_SIZE_SCALE))
+		{
+			++textures;
+		}
+	}
+
+	U32 meshes = 0;
+	LLVOVolume* volumep = drawable->getVOVolume();
+	if (volumep && volumep->isMesh() && volumep->getVolume())
+	{
+		F32 distance = (LLVector3(center.getF32ptr()) - camera.getOrigin()).magVec();
+		S32 lod = volumep->calcLODAtDistance(distance);
+		if (lod > volumep->getLOD()
+			&& gMeshRepo.prefetchMesh(volumep, volumep->getVolume()->getParams(), lod))
+		{
+			++meshes;
+		}
+	}
+
+	if (textures || meshes)
+	{
+		Prediction& prediction = mPredictions[vobj->getID()];
+		prediction.mIssued = LLTimer::getTotalSeconds();
+		prediction.mHasMesh = meshes > 0;
+		++mIssued;
+		mTextureFetches += textures;
+		mMeshFetches += meshes;
+	}
+}
+
+bool LLPredictivePrefetcher::addTexture(LLViewerFetchedTexture* image, F32 virtual_size)
+{
+	if (image->isFullyLoaded())
+	{
+		return false;
+	}
+
+	F64 expires = LLTimer::getTotalSeconds() + PREDICTION_TIMEOUT;
+	for (texture_list_t::iterator it = mTextures.begin(); it != mTextures.end(); ++it)
+	{
+		if (it->mImage == image)
+		{
+			it->mVirtualSize = llmax(it->mVirtualSize, virtual_size);
+			it->mExpires = expires;
+			return false;
+		}
+	}
+	if (mTextures.size() >= MAX_TEXTURES)
+	{
+		return false;
+	}
+
+	PrefetchedTexture entry;
+	entry.mImage = image;
+	entry.mVirtualSize = virtual_size;
+	entry.mExpires = expires;
+	mTextures.push_back(entry);
+
+	// Get it into the fetch queue now rather than on its turn in the
+	// texture list's round-robin.
+	image->addTextureStats(virtual_size);
+	gTextureList.updateImageDecodePriority(image);
+	return true;
+}
+
+void LLPredictivePrefetcher::checkPredictions()
+{
+	F64 now = LLTimer::getTotalSeconds();
+	for (prediction_map_t::iterator it = mPredictions.begin(); it != mPredictions.end();)
+	{
+		LLViewerObject* vobj = gObjectList.findObject(it->first);
+		LLDrawable* drawable = vobj ? vobj->mDrawable.get() : NULL;
+		if (!drawable || vobj->isDead() || drawable->isDead())
+		{
+			mPredictions.erase(it++);
+			continue;
+		}
+
+		if (drawable->isVisible())
+		{
+			// A hit if everything was there by the time it was seen.
+			bool ready = true;
+			for (U8 te = 0; ready && te < vobj->getNumTEs(); ++te)
+			{
+				LLViewerFetchedTexture* image = LLViewerTextureManager::staticCastToFetchedTexture(vobj->getTEImage(te));
+				ready = !image || image->getDiscardLevel() >= 0;
+			}
+			if (ready && it->second.mHasMesh)
+			{
+				ready = vobj->getVolume() && vobj->getVolume()->isMeshAssetLoaded();
+			}
+			if (ready)
+			{
+				++mHits;
+			}
+			else
+			{
+				++mLate;
+			}
+			mPredictions.erase(it++);
+		}
+		else if (now - it->second.mIssued > PREDICTION_TIMEOUT)
+		{
+			++mWasted;
+			mPredictions.erase(it++);
+		}
+		else
+		{
+			++it;
+		}
+	}
+}
@@ -0,0 +1,110 @@
+/**
+ * @file llpredictiveprefetcher.h
+ * @brief Fetches textures and meshes ahead of the camera
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLPREDICTIVEPREFETCHER_H
+#define LL_LLPREDICTIVEPREFETCHER_H
+
+#include "llpointer.h"
+#include "llsingleton.h"
+#include "lltimer.h"
+#include "lluuid.h"
+#include "v3math.h"
+
+#include <map>
+#include <vector>
+
+class LLCamera;
+class LLDrawable;
+class LLViewerFetchedTexture;
+class LLVOVolume;
+
+// Extrapolates camera motion and fetches the textures and mesh LODs of
+// objects that are about to come into view, so that they are on their way
+// before the renderer asks for them.  Prefetched textures get a fraction
+// of the virtual size they will have, which keeps them behind everything
+// on screen in the fetch queue; meshes are only requested at the LOD their
+// predicted distance calls for.
+//
+// Every object prefetched is tracked until it becomes visible or the
+// prediction times out, giving the hit rate reported by getStats().
+//
+// Main thread only.
+class LLPredictivePrefetcher : public LLSingleton<LLPredictivePrefetcher>
+{
+public:
+	LLPredictivePrefetcher();
+
+	// Once a frame, after the object list update.
+	void update();
+
+	// Releases everything held and logs the statistics.
+	void cleanup();
+
+	// issued, hits, late, wasted and hit_rate count objects; textures and
+	// meshes count the fetches issued for them.
+	LLSD getStats() const;
+
+private:
+	struct PrefetchedTexture
+	{
+		LLPointer<LLViewerFetchedTexture>	mImage;
+		F32									mVirtualSize;
+		F64									mExpires;
+	};
+	typedef std::vector<PrefetchedTexture> texture_list_t;
+
+	struct Prediction
+	{
+		F64		mIssued;
+		bool	mHasMesh;
+	};
+	typedef std::map<LLUUID, Prediction> prediction_map_t;
+
+	void reset();
+	void updateVelocity();
+	void predict();
+	void prefetchObject(LLDrawable* drawable, LLCamera& camera);
+	bool addTexture(LLViewerFetchedTexture* image, F32 virtual_size);
+	void checkPredictions();
+
+	LLVector3			mLastOrigin;
+	LLVector3			mVelocity;
+	bool				mHaveOrigin;
+	LLTimer				mFrameTimer;
+	LLTimer				mPredictTimer;
+
+	texture_list_t		mTextures;
+	prediction_map_t	mPredictions;
+
+	U32					mIssued;
+	U32					mHits;
+	U32					mLate;
+	U32					mWasted;
+	U32					mTextureFetches;
+	U32					mMeshFetches;
+};
+
+#endif // LL_LLPREDICTIVEPREFETCHER_H
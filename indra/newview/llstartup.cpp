@@ -755,6 +755,14 @@ bool idle_startup()
 				msg->mPacketRing.setUseOutThrottle(TRUE);
 				msg->mPacketRing.setOutBandwidth(outBandwidth);
 			}
+
+			msg->mPacketRing.setBatchSends(gSavedSettings.getBOOL("MessageBatchSends"));
+
+			// The simulated inbound throttle reads the socket itself.
+			if (inBandwidth == 0.f && gSavedSettings.getBOOL("MessageReceiveThread"))
+			{
+				msg->setReceiveThreadEnabled(true);
+			}
 		}
 
 		LL_INFOS("AppInit") << "Message System Initialized." << LL_ENDL;
@@ -0,0 +1,310 @@
+/**
+ * @file lltexturebudget.cpp
+ * @brief Shares texture memory out among the fetched textures
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+
+#include "llviewerprecompiledheaders.h"
+
+#include "lltexturebudget.h"
+
+#include "llviewercontrol.h"
+#include "llviewertexture.h"
+#include "llviewertexturelist.h"
+
+#include <queue>
+
+static LLTrace::BlockTimerStatHandle FTM_TEXTURE_BUDGET("Texture Budget");
+static LLTrace::BlockTimerStatHandle FTM_TEXTURE_DOWNSCALE("Texture Downscale");
+
+// Left free for textures that appear between solves.
+static const F32 BUDGET_SCALE = 0.9f;
+// Textures smaller than this on screen are not being looked at.
+static const F32 MIN_VIRTUAL_SIZE = 10.f;
+static const F32 AVATAR_WEIGHT = 4.f;
+// Each one is a GPU blit of the texture's mip chain.
+static const U32 MAX_DOWNSCALES_PER_FRAME = 2;
+
+namespace
+{
+	// Screen area lost per byte saved by dropping a texture a level.
+	struct Step
+	{
+		F32	mCost;
+		U32	mEntry;
+
+		bool operator<(const Step& rhs) const
+		{
+			// Cheapest first out of std::priority_queue.
+			return mCost > rhs.mCost;
+		}
+	};
+}
+
+LLTextureBudget::LLTextureBudget()
+:	mFrames(0),
+	mDiscardBias(0.f),
+	mBudget(0),
+	mAssigned(0),
+	mNumCapped(0),
+	mNumDownscaled(0)
+{
+	for (S32 i = 0; i < NUM_CATEGORIES; ++i)
+	{
+		mResident[i] = 0;
+	}
+}
+
+bool LLTextureBudget::isEnabled() const
+{
+	static LLCachedControl<bool> enabled(gSavedSettings, "TextureBudgetEnabled", true);
+	return enabled;
+}
+
+// static
+LLTextureBudget::ECategory LLTextureBudget::getCategory(const LLViewerFetchedTexture* image)
+{
+	switch (image->mBoostLevel)
+	{
+	case LLGLTexture::BOOST_AVATAR_BAKED:
+	case LLGLTexture::BOOST_AVATAR:
+	case LLGLTexture::BOOST_AVATAR_BAKED_SELF:
+	case LLGLTexture::BOOST_AVATAR_SELF:
+		return CATEGORY_AVATAR;
+	case LLGLTexture::BOOST_HUD:
+	case LLGLTexture::BOOST_ICON:
+	case LLGLTexture::BOOST_UI:
+	case LLGLTexture::BOOST_PREVIEW:
+	case LLGLTexture::BOOST_MAP:
+	case LLGLTexture::BOOST_MAP_VISIBLE:
+		return CATEGORY_UI;
+	default:
+		return image->getFTType() == FTT_SERVER_BAKE ? CATEGORY_AVATAR : CATEGORY_SCENE;
+	}
+}
+
+// static
+const char* LLTextureBudget::getCategoryName(ECategory category)
+{
+	static const char* names[NUM_CATEGORIES] = { "Scene", "Avatar", "UI" };
+	return names[category];
+}
+
+void LLTextureBudget::update()
+{
+	if (!isEnabled())
+	{
+		if (mNumCapped)
+		{
+			for (LLViewerTextureList::image_priority_list_t::iterator it = gTextureList.mImageList.begin();
+				 it != gTextureList.mImageList.end(); ++it)
+			{
+				LLViewerFetchedTexture* image = *it;
+				image->mBudgetDiscardLevel = -1;
+			}
+			mNumCapped = 0;
+		}
+		mDownscales.clear();
+		return;
+	}
+
+	static LLCachedControl<U32> interval(gSavedSettings, "TextureBudgetInterval", 16);
+	if (++mFrames >= llmax((U32)interval, 1U))
+	{
+		mFrames = 0;
+		solve();
+	}
+	downscale();
+}
+
+// static
+S64 LLTextureBudget::getLevelBytes(const Entry& entry, S32 level)
+{
+	return entry.mBytes >> (2 * level);
+}
+
+void LLTextureBudget::solve()
+{
+	LL_RECORD_BLOCK_TIME(FTM_TEXTURE_BUDGET);
+
+	static LLCachedControl<F32> hysteresis(gSavedSettings, "TextureBudgetHysteresis", 0.1f);
+	static const F64 log_4 = log(4.0);
+
+	// A level of discard bias is a quarter of the memory.
+	F32 pressure = powf(0.25f, llmax(mDiscardBias, 0.f));
+	mBudget = (S64)((F32)((S64)gTextureList.getMaxResidentTexMem().value() << 20) * BUDGET_SCALE * pressure);
+	for (S32 i = 0; i < NUM_CATEGORIES; ++i)
+	{
+		mResident[i] = 0;
+	}
+
+	// Everything the budget does not govern is a fixed cost.
+	S64 total = 0;
+	std::vector<Entry> entries;
+	for (LLViewerTextureList::image_priority_list_t::iterator it = gTextureList.mImageList.begin();
+		 it != gTextureList.mImageList.end(); ++it)
+	{
+		LLViewerFetchedTexture* image = *it;
+		ECategory category = getCategory(image);
+		S64 resident = image->hasGLTexture() ? (S64)image->getTextureMemory().value() : 0;
+		mResident[category] += resident;
+
+		// The same textures the discard bias applied to.
+		bool governed = image->getType() == LLViewerTexture::LOD_TEXTURE
+			&& image->mBoostLevel < LLGLTexture::BOOST_SCULPTED
+			&& image->getUseDiscard() && !image->mForceToSaveRawImage
+			&& image->mFullWidth > 0 && image->mFullHeight > 0 && image->mTexelsPerImage > 0.f
+			&& image->mMaxVirtualSize > MIN_VIRTUAL_SIZE;
+		if (!governed)
+		{
+			image->mBudgetDiscardLevel = -1;
+			if (image->getBoundRecently())
+			{
+				total += resident;
+			}
+			continue;
+		}
+
+		Entry entry;
+		entry.mImage = image;
+		entry.mWeight = image->mMaxVirtualSize * (1.f + image->getAdditionalDecodePriority());
+		if (category == CATEGORY_AVATAR)
+		{
+			entry.mWeight *= AVATAR_WEIGHT;
+		}
+		S32 components = image->getComponents() ? image->getComponents() : 4;
+		entry.mBytes = (S64)image->mFullWidth * image->mFullHeight * components * 4 / 3;
+		entry.mMaxLevel = llclamp(image->getMaxDiscardLevel(), 0, MAX_DISCARD_LEVEL);
+		S32 min_level = (image->mFullWidth > LLGLTexture::MAX_IMAGE_SIZE_DEFAULT
+			|| image->mFullHeight > LLGLTexture::MAX_IMAGE_SIZE_DEFAULT) ? 1 : 0;
+		S32 natural = (S32)floorf((F32)(log(image->mTexelsPerImage / image->mMaxVirtualSize) / log_4));
+		entry.mNatural = llclamp(natural, min_level, entry.mMaxLevel);
+		entry.mLevel = entry.mNatural;
+		total += getLevelBytes(entry, entry.mLevel);
+		entries.push_back(entry);
+	}
+
+	// Tighten until within the budget, remembering where that was, then on
+	// to the smaller budget a cap has to fit before it is loosened.
+	std::priority_queue<Step> steps;
+	for (U32 i = 0; i < entries.size(); ++i)
+	{
+		if (entries[i].mLevel < entries[i].mMaxLevel)
+		{
+			Step step;
+			step.mCost = entries[i].mWeight / (F32)llmax(getLevelBytes(entries[i], entries[i].mLevel), (S64)1);
+			step.mEntry = i;
+			steps.push(step);
+		}
+	}
+
+	S64 loosen_budget = (S64)((F32)mBudget * (1.f - llclamp((F32)hysteresis, 0.f, 0.5f)));
+	std::vector<S32> tight_levels;
+	if (total <= mBudget)
+	{
+		for (U32 i = 0; i < entries.size(); ++i)
+		{
+			tight_levels.push_back(entries[i].mLevel);
+		}
+	}
+	while (total > loosen_budget && !steps.empty())
+	{
+		Entry& entry = entries[steps.top().mEntry];
+		steps.pop();
+		// Dropping a level saves three quarters of it.
+		S64 bytes = getLevelBytes(entry, entry.mLevel);
+		total -= bytes - (bytes >> 2);
+		++entry.mLevel;
+		if (entry.mLevel < entry.mMaxLevel)
+		{
+			Step step;
+			step.mCost = entry.mWeight / (F32)llmax(bytes >> 2, (S64)1);
+			step.mEntry = (U32)(&entry - &entries[0]);
+			steps.push(step);
+		}
+		if (tight_levels.empty() && total <= mBudget)
+		{
+			for (U32 i = 0; i < entries.size(); ++i)
+			{
+				tight_levels.push_back(entries[i].mLevel);
+			}
+		}
+	}
+	if (tight_levels.empty())
+	{
+		// Over budget even with every texture at its smallest.
+		for (U32 i = 0; i < entries.size(); ++i)
+		{
+			tight_levels.push_back(entries[i].mLevel);
+		}
+	}
+
+	// A cap stays where it was unless over budget (tight_levels is coarser)
+	// or well within it (mLevel, from the smaller budget, is finer).
+	mDownscales.clear();
+	mAssigned = total;
+	mNumCapped = 0;
+	for (U32 i = 0; i < entries.size(); ++i)
+	{
+		Entry& entry = entries[i];
+		LLViewerFetchedTexture* image = entry.mImage;
+		S32 previous = image->mBudgetDiscardLevel >= 0 ? image->mBudgetDiscardLevel : entry.mNatural;
+		S32 level = llclamp(previous, tight_levels[i], entry.mLevel);
+		mAssigned += getLevelBytes(entry, level) - getLevelBytes(entry, entry.mLevel);
+		if (level > entry.mNatural)
+		{
+			image->mBudgetDiscardLevel = level;
+			++mNumCapped;
+			S32 current = image->getDiscardLevel();
+			if (current >= 0 && current < level)
+			{
+				mDownscales.push_back(image);
+			}
+		}
+		else
+		{
+			image->mBudgetDiscardLevel = -1;
+		}
+	}
+}
+
+void LLTextureBudget::downscale()
+{
+	if (mDownscales.empty())
+	{
+		return;
+	}
+	LL_RECORD_BLOCK_TIME(FTM_TEXTURE_DOWNSCALE);
+
+	for (U32 count = 0; count < MAX_DOWNSCALES_PER_FRAME && !mDownscales.empty();)
+	{
+		LLPointer<LLViewerFetchedTexture> image = mDownscales.back();
+		mDownscales.pop_back();
+		if (image->mBudgetDiscardLevel >= 0 && image->downscaleTo(image->mBudgetDiscardLevel))
+		{
+			++mNumDownscaled;
+			++count;
+		}
+	}
+}
@@ -0,0 +1,118 @@
+/**
+ * @file lltexturebudget.h
+ * @brief Shares texture memory out among the fetched textures
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+
+#ifndef LL_LLTEXTUREBUDGET_H
+#define LL_LLTEXTUREBUDGET_H
+
+#include "llpointer.h"
+#include "llsingleton.h"
+
+#include <vector>
+
+class LLViewerFetchedTexture;
+
+// Decides, every few frames and for all textures at once, how far each
+// visible scene texture may be down-res'd to keep resident texture memory
+// within the cap set by LLViewerTextureList::updateMaxResidentTexMem(),
+// shrunk further while LLViewerTexture::updateClass() sees memory pressure.
+// This replaces the global discard bias, which moved every texture at once
+// and made crowded scenes swing between down-res and re-fetch.
+//
+// Each texture starts at the level its screen size calls for.  While the
+// total is over budget, the texture that loses the least on screen per
+// byte saved gives up a level; avatar bakes are weighted above the rest of
+// the scene.  The result caps the desired discard level of each texture.
+// A cap is only tightened when over budget and only loosened once the
+// textures fit a smaller budget again, so small changes in the scene do
+// not make textures flip between levels.
+//
+// Textures capped below what they hold are copied down from their own GL
+// mips, a few a frame, rather than being thrown out and fetched again.
+// Those that can't be copied on the GPU fall to the normal discard path.
+//
+// Main thread only.
+class LLTextureBudget : public LLSingleton<LLTextureBudget>
+{
+public:
+	enum ECategory
+	{
+		CATEGORY_SCENE,
+		CATEGORY_AVATAR,
+		CATEGORY_UI,
+		NUM_CATEGORIES
+	};
+
+	LLTextureBudget();
+
+	// Once a frame, before the texture decode priorities are updated.
+	void update();
+
+	bool isEnabled() const;
+
+	// LLViewerTexture's discard bias, raised under memory pressure.  Each
+	// level of it takes three quarters off the budget.
+	void setDiscardBias(F32 bias)					{ mDiscardBias = bias; }
+
+	static ECategory getCategory(const LLViewerFetchedTexture* image);
+	static const char* getCategoryName(ECategory category);
+
+	// Results of the last solve, in bytes.
+	S64 getBudget() const							{ return mBudget; }
+	S64 getAssigned() const							{ return mAssigned; }
+	S64 getResident(ECategory category) const		{ return mResident[category]; }
+	U32 getNumCapped() const						{ return mNumCapped; }
+	U32 getNumDownscaled() const					{ return mNumDownscaled; }
+
+private:
+	struct Entry
+	{
+		LLViewerFetchedTexture*	mImage;
+		F32		mWeight;			// screen area times importance
+		S64		mBytes;				// at discard level 0, with mips
+		S32		mNatural;			// level the screen size calls for
+		S32		mMaxLevel;
+		S32		mLevel;
+	};
+
+	void solve();
+	void downscale();
+
+	static S64 getLevelBytes(const Entry& entry, S32 level);
+
+	// Capped below the level they hold.
+	std::vector<LLPointer<LLViewerFetchedTexture> > mDownscales;
+	U32		mFrames;
+	F32		mDiscardBias;
+
+	S64		mBudget;
+	S64		mAssigned;
+	S64		mResident[NUM_CATEGORIES];
+	U32		mNumCapped;
+	U32		mNumDownscaled;
+};
+
+#endif // LL_LLTEXTUREBUDGET_H
@@ -43,6 +43,7 @@
 #include "message.h"
 
 #include "llagent.h"
+#include "llassetfetchscheduler.h"
 #include "lltexturecache.h"
 #include "llviewercontrol.h"
 #include "llviewertexturelist.h"
@@ -2559,7 +2560,9 @@ LLTextureFetch::LLTextureFetch(LLTextureCache* cache, LLImageDecodeThread* image
 	mHttpMetricsPolicyClass = app_core_http.getPolicy(LLAppCoreHttp::AP_REPORTING);
 	mHttpHighWater = HTTP_NONPIPE_REQUESTS_HIGH_WATER;
 	mHttpLowWater = HTTP_NONPIPE_REQUESTS_LOW_WATER;
+	mHttpSharePct.store(100);
 	mHttpSemaphore = 0;
+	mHttpWaitTopPriority = 0.f;
 
 	// Conditionally construct debugger object after 'this' is
 	// fully initialized.
@@ -3024,15 +3027,18 @@ void LLTextureFetch::commonUpdate()
 	// Update low/high water levels based on pipelining.  We pick
 	// up setting eventually, so the semaphore/request level can
 	// fall outside the [0..HIGH_WATER] range.  Expect that.
+	// Both shrink with the connections LLAssetFetchScheduler grants us,
+	// so that what we can't send waits where it can still be reprioritized.
+	const S32 share(mHttpSharePct.load(boost::memory_order_relaxed));
 	if (LLAppViewer::instance()->getAppCoreHttp().isPipelined(LLAppCoreHttp::AP_TEXTURE))
 	{
-		mHttpHighWater = HTTP_PIPE_REQUESTS_HIGH_WATER;
-		mHttpLowWater = HTTP_PIPE_REQUESTS_LOW_WATER;
+		mHttpHighWater = llmax(2, HTTP_PIPE_REQUESTS_HIGH_WATER * share / 100);
+		mHttpLowWater = llmax(1, HTTP_PIPE_REQUESTS_LOW_WATER * share / 100);
 	}
 	else
 	{
-		mHttpHighWater = HTTP_NONPIPE_REQUESTS_HIGH_WATER;
-		mHttpLowWater = HTTP_NONPIPE_REQUESTS_LOW_WATER;
+		mHttpHighWater = llmax(2, HTTP_NONPIPE_REQUESTS_HIGH_WATER * share / 100);
+		mHttpLowWater = llmax(1, HTTP_NONPIPE_REQUESTS_LOW_WATER * share / 100);
 	}
 
 	// Release waiters
@@ -3059,17 +3065,32 @@ S32 LLTextureFetch::update(F32 max_time_ms)
 {
 	static LLCachedControl<F32> band_width(gSavedSettings,"ThrottleBandwidthKBPS", 500.0);
 	
+	U32Bytes received;
+	U32 waiting;
+	F32 top_priority;
 	{
 		mNetworkQueueMutex.lock();										// +Mfnq
 		mMaxBandwidth = band_width();
 
 		// Singu TODO: LLStatViewer update.
 		//add(LLStatViewer::TEXTURE_NETWORK_DATA_RECEIVED, mHTTPTextureBits);
+		received = mHTTPTextureBits;
 		mHTTPTextureBits = (U32Bits)0;
+		waiting = mHttpWaitResource.size();
+		top_priority = waiting ? mHttpWaitTopPriority : 0.f;
 
 		mNetworkQueueMutex.unlock();									// -Mfnq
 	}
 
+	LLAssetFetchScheduler & scheduler(LLAssetFetchScheduler::instance());
+	scheduler.reportDemand(LLAssetFetchScheduler::AC_TEXTURE, mHttpSemaphore, waiting,
+						   top_priority / LLViewerFetchedTexture::maxDecodePriority());
+	scheduler.reportReceived(LLAssetFetchScheduler::AC_TEXTURE, received.value());
+	// Written here on the main thread, read by commonUpdate() on the fetch
+	// thread.  Only the value matters, so no ordering is needed.
+	mHttpSharePct.store(S32(scheduler.getShare(LLAssetFetchScheduler::AC_TEXTURE) * 100.f + 0.5f),
+						boost::memory_order_relaxed);
+
 	S32 res = LLWorkerThread::update(max_time_ms);
 	
 	if (!mDebugPause)
@@ -3757,6 +3778,15 @@ void LLTextureFetch::releaseHttpWaiters()
 	}
 	tids.clear();
 
+	if (! tids2.empty())
+	{
+		// Best of the waiters, for the asset fetch scheduler
+		LLTextureFetchWorker::Compare compare;
+		const F32 top_priority((* std::min_element(tids2.begin(), tids2.end(), compare))->mImagePriority);
+		LLMutexLock lock(&mNetworkQueueMutex);							// +Mfnq
+		mHttpWaitTopPriority = top_priority;
+	}																	// -Mfnq
+
 	// Sort into priority order, if necessary and only as much as needed
 	if (tids2.size() > needed)
 	{
@@ -362,6 +362,7 @@ public:
 	LLCore::HttpRequest::policy_t		mHttpMetricsPolicyClass;		// T*
 	S32									mHttpHighWater;					// Ttf
 	S32									mHttpLowWater;					// Ttf
+	LLAtomicS32							mHttpSharePct;					// Tmain writes, Ttf reads; LLAssetFetchScheduler's grant
 	
 	// We use a resource semaphore to keep HTTP requests in
 	// WAIT_HTTP_RESOURCE2 if there aren't sufficient slots in the
@@ -378,6 +379,7 @@ public:
 	
 	typedef std::set<LLUUID> wait_http_res_queue_t;
 	wait_http_res_queue_t				mHttpWaitResource;				// Mfnq
+	F32									mHttpWaitTopPriority;			// Mfnq
 
 	// Cumulative stats on the states/requests issued by
 	// textures running through here.
@@ -41,8 +41,10 @@
 #include "llmeshrepository.h"
 #include "llselectmgr.h"
 #include "llviewertexlayer.h"
+#include "lltexturebudget.h"
 #include "lltexturecache.h"
 #include "lltexturefetch.h"
+#include "lltextureupload.h"
 #include "llviewercontrol.h"
 #include "llviewerobject.h"
 #include "llviewertexture.h"
@@ -624,7 +626,7 @@ void LLGLTexMemBar::draw()
 #endif
 	//----------------------------------------------------------------------------
 
-	text = llformat("Textures: %d Fetch: %d(%d) Pkts:%d(%d) Cache R/W: %d/%d LFS:%d IW:%d Raw:%d HTP:%d DEC:%d CRE:%d ",
+	text = llformat("Textures: %d Fetch: %d(%d) Pkts:%d(%d) Cache R/W: %d/%d LFS:%d IW:%d Raw:%d HTP:%d DEC:%d CRE:%d UP:%dKB/%.1fms ",
 					gTextureList.getNumImages(),
 					LLAppViewer::getTextureFetch()->getNumRequests(), LLAppViewer::getTextureFetch()->getNumDeletes(),
 					LLAppViewer::getTextureFetch()->mPacketCount, LLAppViewer::getTextureFetch()->mBadPacketCount, 
@@ -634,7 +636,9 @@ void LLGLTexMemBar::draw()
 					LLImageRaw::sRawImageCount,
 					LLAppViewer::getTextureFetch()->getNumHTTPRequests(),
 					LLAppViewer::getImageDecodeThread()->getPending(), 
-					gTextureList.mCreateTextureList.size());
+					gTextureList.mCreateTextureList.size(),
+					LLTextureUpload::getLastFrameBytes() / 1024,
+					LLTextureUpload::getLastFrameStallMS());
 
 	LLFontGL::getFontMonospace()->renderUTF8(text, 0, 0, v_offset + line_height*3,
 											 text_color, LLFontGL::LEFT, LLFontGL::TOP);
@@ -649,6 +653,25 @@ void LLGLTexMemBar::draw()
 	LLFontGL::getFontMonospace()->renderUTF8(text, 0, left, v_offset + line_height*3,
 											 color, LLFontGL::LEFT, LLFontGL::TOP);
 	
+	// Texture budget line
+	LLTextureBudget& budget = LLTextureBudget::instance();
+	if (budget.isEnabled())
+	{
+		text = llformat("Budget: %d/%d MB Capped: %u Downscaled: %u Resident",
+						(S32)(budget.getAssigned() >> 20), (S32)(budget.getBudget() >> 20),
+						budget.getNumCapped(), budget.getNumDownscaled());
+		for (S32 i = 0; i < LLTextureBudget::NUM_CATEGORIES; ++i)
+		{
+			LLTextureBudget::ECategory category = (LLTextureBudget::ECategory)i;
+			text += llformat(" %s: %d MB", LLTextureBudget::getCategoryName(category),
+							 (S32)(budget.getResident(category) >> 20));
+		}
+		color = budget.getAssigned() > budget.getBudget() ? LLColor4::red : text_color;
+		color[VALPHA] = text_color[VALPHA];
+		LLFontGL::getFontMonospace()->renderUTF8(text, 0, 0, v_offset + line_height*4,
+												 color, LLFontGL::LEFT, LLFontGL::TOP);
+	}
+
 	// Mesh status line
 	text = llformat("Mesh: Reqs(Tot/Htp/Big): %u/%u/%u Rtr/Err: %u/%u Cread/Cwrite: %u/%u Low/At/High: %d/%d/%d",
 					LLMeshRepository::sMeshRequestCount, LLMeshRepository::sHTTPRequestCount, LLMeshRepository::sHTTPLargeRequestCount,
@@ -701,7 +724,7 @@ BOOL LLGLTexMemBar::handleMouseDown(S32 x, S32 y, MASK mask)
 LLRect LLGLTexMemBar::getRequiredRect()
 {
 	LLRect rect;
-	rect.mTop = 50;
+	rect.mTop = 64;
 	return rect;
 }
 
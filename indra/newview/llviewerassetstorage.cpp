@@ -33,6 +33,7 @@
 #include "message.h"
 
 #include "llagent.h"
+#include "llassetfetchscheduler.h"
 #include "lltransfersourceasset.h"
 #include "lltransfertargetvfile.h"
 #include "llviewerassetstats.h"
@@ -53,7 +54,8 @@ class LLViewerAssetRequest : public LLAssetRequest
 public:
 	LLViewerAssetRequest(const LLUUID &uuid, const LLAssetType::EType type)
 		: LLAssetRequest(uuid, type),
-		  mMetricsStartTime(0)
+		  mMetricsStartTime(0),
+		  mScheduled(false)
 		{
 		}
 	
@@ -64,6 +66,10 @@ public:
 	~LLViewerAssetRequest()
 		{
 			recordMetrics();
+			if (mScheduled && LLAssetFetchScheduler::instanceExists())
+			{
+				LLAssetFetchScheduler::instance().transferDone(mType);
+			}
 		}
 
 protected:
@@ -83,6 +89,7 @@ protected:
 	
 public:
 	LLViewerAssetStats::duration_t		mMetricsStartTime;
+	bool								mScheduled;			// Holds an LLAssetFetchScheduler transfer slot
 };
 
 ///----------------------------------------------------------------------------
@@ -324,6 +331,7 @@ void LLViewerAssetStorage::storeAssetData(
  * with the following changes:
  *  -  Use a locally-derived request class
  *  -  Start timing for metrics when request is queued
+ *  -  Let LLAssetFetchScheduler hold back sound and animation transfers
  *
  * This is an unfortunate implementation choice but it's forced by
  * current conditions.  A refactoring that might clean up the layers
@@ -341,7 +349,8 @@ void LLViewerAssetStorage::_queueDataRequest(
 	LLGetAssetCallback callback,
 	void *user_data,
 	BOOL duplicate,
-	BOOL is_priority)
+	BOOL is_priority,
+	F32 importance)
 {
 	if (mUpstreamHost.isOk())
 	{
@@ -361,21 +370,15 @@ void LLViewerAssetStorage::_queueDataRequest(
 	
 		if (!duplicate)
 		{
-			// send request message to our upstream data provider
-			// Create a new asset transfer.
-			LLTransferSourceParamsAsset spa;
-			spa.setAsset(uuid, atype);
-
-			// Set our destination file, and the completion callback.
-			LLTransferTargetParamsVFile tpvf;
-			tpvf.setAsset(uuid, atype);
-			tpvf.setCallback(downloadCompleteCallback, *req);
-
-			LL_DEBUGS("AssetStorage") << "Starting transfer for " << uuid << LL_ENDL;
-			LLTransferTargetChannel *ttcp = gTransferManager.getTargetChannel(mUpstreamHost, LLTCT_ASSET);
-			ttcp->requestTransfer(spa, tpvf, 100.f + (is_priority ? 1.f : 0.f));
-
-			LLViewerAssetStatsFF::record_enqueue_main(atype, false, false);
+			if (LLAssetFetchScheduler::instance().admitTransfer(uuid, atype, is_priority ? 1.f : importance))
+			{
+				req->mScheduled = true;
+				startTransfer(req);
+			}
+			else
+			{
+				LL_DEBUGS("AssetStorage") << "Queued transfer for " << uuid << LL_ENDL;
+			}
 		}
 	}
 	else
@@ -389,3 +392,52 @@ void LLViewerAssetStorage::_queueDataRequest(
 	}
 }
 
+bool LLViewerAssetStorage::startQueuedTransfer(const LLUUID& uuid, LLAssetType::EType type)
+{
+	if (!mUpstreamHost.isOk())
+	{
+		return false;
+	}
+
+	for (request_list_t::iterator iter = mPendingDownloads.begin();
+		 iter != mPendingDownloads.end(); ++iter)
+	{
+		LLViewerAssetRequest* req = dynamic_cast<LLViewerAssetRequest*>(*iter);
+		if (req && req->getUUID() == uuid && req->getType() == type)
+		{
+			req->mScheduled = true;
+			startTransfer(req);
+			return true;
+		}
+	}
+	return false;
+}
+
+// virtual
+void LLViewerAssetStorage::reportReceived(LLAssetType::EType atype, S32 bytes)
+{
+	LLAssetFetchScheduler::EAssetClass cls = LLAssetFetchScheduler::classFor(atype);
+	if (cls != LLAssetFetchScheduler::AC_COUNT && bytes > 0)
+	{
+		LLAssetFetchScheduler::instance().reportReceived(cls, (U32)bytes);
+	}
+}
+
+void LLViewerAssetStorage::startTransfer(LLViewerAssetRequest* req)
+{
+	// send request message to our upstream data provider
+	// Create a new asset transfer.
+	LLTransferSourceParamsAsset spa;
+	spa.setAsset(req->getUUID(), req->getType());
+
+	// Set our destination file, and the completion callback.
+	LLTransferTargetParamsVFile tpvf;
+	tpvf.setAsset(req->getUUID(), req->getType());
+	tpvf.setCallback(downloadCompleteCallback, *req);
+
+	LL_DEBUGS("AssetStorage") << "Starting transfer for " << req->getUUID() << LL_ENDL;
+	LLTransferTargetChannel *ttcp = gTransferManager.getTargetChannel(mUpstreamHost, LLTCT_ASSET);
+	ttcp->requestTransfer(spa, tpvf, 100.f + (req->mIsPriority ? 1.f : 0.f));
+
+	LLViewerAssetStatsFF::record_enqueue_main(req->getType(), false, false);
+}
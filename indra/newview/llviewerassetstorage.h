@@ -31,6 +31,7 @@
 //#include "curl/curl.h"
 
 class LLVFile;
+class LLViewerAssetRequest;
 
 class LLViewerAssetStorage : public LLAssetStorage
 {
@@ -64,6 +65,12 @@ public:
 		bool user_waiting=FALSE,
 		F64Seconds timeout=LL_ASSET_STORAGE_TIMEOUT);
 
+	// Starts the transfer LLAssetFetchScheduler held back for an asset.
+	// Returns false if no request wants the asset any more.
+	bool startQueuedTransfer(const LLUUID& uuid, LLAssetType::EType type);
+
+	/*virtual*/ void reportReceived(LLAssetType::EType atype, S32 bytes);
+
 protected:
 	using LLAssetStorage::_queueDataRequest;
 
@@ -73,7 +80,10 @@ protected:
 						   void (*callback) (LLVFS *vfs, const LLUUID&, LLAssetType::EType, void *, S32, LLExtStat),
 						   void *user_data,
 						   BOOL duplicate,
-						   BOOL is_priority);
+						   BOOL is_priority,
+						   F32 importance);
+
+	void startTransfer(LLViewerAssetRequest* req);
 };
 
 #endif
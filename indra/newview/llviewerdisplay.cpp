@@ -40,6 +40,7 @@
 #include "llagent.h"
 #include "llagentcamera.h"
 #include "llviewercontrol.h"
+#include "llviewersettingsregistry.h"
 #include "llcoord.h"
 #include "llcriticaldamp.h"
 #include "lldir.h"
@@ -397,10 +398,11 @@ void display(BOOL rebuild, F32 zoom_factor, int subfield, BOOL for_snapshot, boo
 
 	LLImageGL::updateStats(gFrameTimeSeconds);
 	
-	LLVOAvatar::sRenderName = gSavedSettings.getS32("RenderName");
-	LLVOAvatar::sRenderGroupTitles = !gSavedSettings.getBOOL("RenderHideGroupTitleAll");
+	LLVOAvatar::sRenderName = getSavedSetting<LLSettingID::RenderName>();
+	LLVOAvatar::sRenderGroupTitles = !getSavedSetting<LLSettingID::RenderHideGroupTitleAll>();
 	
 	gPipeline.mBackfaceCull = TRUE;
+	LLControlGroup::endLookupFrame();
 	gFrameCount++;
 	gRecentFrameCount++;
 	if (gFocusMgr.getAppHasFocus())
@@ -570,10 +572,10 @@ void display(BOOL rebuild, F32 zoom_factor, int subfield, BOOL for_snapshot, boo
 	if (gSavedDrawDistance > 0.0f && gAgent.getTeleportState() == LLAgent::TELEPORT_NONE)
 	{
 		if (gTeleportArrivalTimer.getElapsedTimeF32() >=
-			(F32)gSavedSettings.getU32("SpeedRezInterval"))
+			(F32)getSavedSetting<LLSettingID::SpeedRezInterval>())
 		{
 			gTeleportArrivalTimer.reset();
-			F32 current = gSavedSettings.getF32("RenderFarClip");
+			F32 current = getSavedSetting<LLSettingID::RenderFarClip>();
 			if (gSavedDrawDistance > current)
 			{
 				current *= 2.0;
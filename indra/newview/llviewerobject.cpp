@@ -32,6 +32,7 @@
 #include "imageids.h"
 #include "indra_constants.h"
 #include "llmath.h"
+#include "llmessagefields.h"
 #include "llflexibleobject.h"
 #include "llviewercontrol.h"
 #include "lldatapacker.h"
@@ -99,6 +100,7 @@
 #include "lltrans.h"
 #include "llsdutil.h"
 #include "llmediaentry.h"
+#include "llobjectupdatedata.h"
 #include "llvocache.h"
 // [RLVa:KB] - Checked: 2011-05-22 (RLVa-1.3.1a)
 #include "rlvhandler.h"
@@ -543,27 +545,19 @@ void LLViewerObject::cleanupVOClasses()
 	LLVOVolume::cleanupClass();
 }
 
-// Replaces all name value pairs with data from \n delimited list
+// Replaces all name value pairs with those of an update
 // Does not update server
-void LLViewerObject::setNameValueList(const std::string& name_value_list)
+void LLViewerObject::setNameValueList(const std::vector<std::string>& name_values)
 {
 	// Clear out the old
 	for_each(mNameValuePairs.begin(), mNameValuePairs.end(), DeletePairedPointer()) ;
 	mNameValuePairs.clear();
 
 	// Bring in the new
-	std::string::size_type length = name_value_list.length();
-	std::string::size_type start = 0;
-	while (start < length)
+	for (std::vector<std::string>::const_iterator iter = name_values.begin();
+		 iter != name_values.end(); ++iter)
 	{
-		std::string::size_type end = name_value_list.find_first_of("\n", start);
-		if (end == std::string::npos) end = length;
-		if (end > start)
-		{
-			std::string tok = name_value_list.substr(start, end - start);
-			addNVPair(tok);
-		}
-		start = end+1;
+		addNVPair(*iter);
 	}
 }
 
@@ -937,7 +931,7 @@ U32 LLViewerObject::processUpdateMessage(LLMessageSystem *mesgsys,
 					 void **user_data,
 					 U32 block_num,
 					 const EObjectUpdateType update_type,
-					 LLDataPacker *dp)
+					 const LLObjectUpdateData& update)
 {
 	LL_DEBUGS_ONCE("SceneLoadTiming") << "Received viewer object data" << LL_ENDL;
 
@@ -984,7 +978,7 @@ U32 LLViewerObject::processUpdateMessage(LLMessageSystem *mesgsys,
 	if(mesgsys != NULL)
 	{
 	U16 time_dilation16;
-	mesgsys->getU16Fast(_PREHASH_RegionData, _PREHASH_TimeDilation, time_dilation16);
+	LLMessageFields::ObjectUpdate::RegionData::TimeDilation.get(mesgsys, time_dilation16);
 	time_dilation = ((F32) time_dilation16) / 65535.f;
 	mRegionp->setTimeDilation(time_dilation);
 	}
@@ -1015,7 +1009,7 @@ U32 LLViewerObject::processUpdateMessage(LLMessageSystem *mesgsys,
 		parent_id = cur_parentp->mLocalID;
 	}
 
-	if (!dp)
+	if (!update.mCompressed)
 	{
 		switch(update_type)
 		{
@@ -1024,7 +1018,7 @@ U32 LLViewerObject::processUpdateMessage(LLMessageSystem *mesgsys,
 #ifdef DEBUG_UPDATE_TYPE
 				LL_INFOS() << "Full:" << getID() << LL_ENDL;
 #endif
-				processTerseData(mesgsys, user_data, block_num, this_update_precision, new_pos_parent, new_rot, new_angv, test_pos_parent);
+				applyTerseData(update, this_update_precision, new_pos_parent, new_rot, new_angv, test_pos_parent);
 
 				//clear cost and linkset cost
 				mCostStale = true;
@@ -1033,26 +1027,19 @@ U32 LLViewerObject::processUpdateMessage(LLMessageSystem *mesgsys,
 					gFloaterTools->dirty();
 				}
 
-				LLUUID audio_uuid;
-				LLUUID owner_id;	// only valid if audio_uuid or particle system is not null
-				F32    gain;
-				U8     sound_flags;
-
-				mesgsys->getU32Fast( _PREHASH_ObjectData, _PREHASH_CRC, crc, block_num);
-				mesgsys->getU32Fast( _PREHASH_ObjectData, _PREHASH_ParentID, parent_id, block_num);
-				mesgsys->getUUIDFast(_PREHASH_ObjectData, _PREHASH_Sound, audio_uuid, block_num );
 				// HACK: Owner id only valid if non-null sound id or particle system
-				mesgsys->getUUIDFast(_PREHASH_ObjectData, _PREHASH_OwnerID, owner_id, block_num );
-				mesgsys->getF32Fast( _PREHASH_ObjectData, _PREHASH_Gain, gain, block_num );
-				mesgsys->getU8Fast(  _PREHASH_ObjectData, _PREHASH_Flags, sound_flags, block_num );
-				mesgsys->getU8Fast(  _PREHASH_ObjectData, _PREHASH_Material, material, block_num );
-				mesgsys->getU8Fast(  _PREHASH_ObjectData, _PREHASH_ClickAction, click_action, block_num); 
-				mesgsys->getVector3Fast(_PREHASH_ObjectData, _PREHASH_Scale, new_scale, block_num );
+				const LLUUID& owner_id = update.mOwnerID;
+
+				crc = update.mCRC;
+				parent_id = update.mParentID;
+				material = update.mMaterial;
+				click_action = update.mClickAction;
+				new_scale = update.mScale;
 
 				mTotalCRC = crc;
 
 				// Owner ID used for sound muting or particle system muting
-				setAttachedSound(audio_uuid, owner_id, gain, sound_flags);
+				setAttachedSound(update.mSoundID, owner_id, update.mSoundGain, update.mSoundFlags);
 
 				U8 old_material = getMaterial();
 				if (old_material != material)
@@ -1070,26 +1057,20 @@ U32 LLViewerObject::processUpdateMessage(LLMessageSystem *mesgsys,
 				// Here we handle data specific to the full message.
 				//
 
-				U32 flags;
-				mesgsys->getU32Fast(_PREHASH_ObjectData, _PREHASH_UpdateFlags, flags, block_num);
+				U32 flags = update.mUpdateFlags;
 				// clear all but local flags
 				mFlags &= FLAGS_LOCAL;
 				mFlags |= flags;
 
-				U8 state;
-				mesgsys->getU8Fast(_PREHASH_ObjectData, _PREHASH_State, state, block_num );
-				mState = state;
+				mState = update.mState;
 
 				// ...new objects that should come in selected need to be added to the selected list
 				mCreateSelected = ((flags & FLAGS_CREATE_SELECTED) != 0);
 
 				// Set all name value pairs
-				S32 nv_size = mesgsys->getSizeFast(_PREHASH_ObjectData, block_num, _PREHASH_NameValue);
-				if (nv_size > 0)
+				if (update.mHasNameValues)
 				{
-					std::string name_value_list;
-					mesgsys->getStringFast(_PREHASH_ObjectData, _PREHASH_NameValue, name_value_list, block_num);
-					setNameValueList(name_value_list);
+					setNameValueList(update.mNameValues);
 				}
 
 				// Clear out any existing generic data
@@ -1099,23 +1080,21 @@ U32 LLViewerObject::processUpdateMessage(LLMessageSystem *mesgsys,
 				}
 
 				// Check for appended generic data
-				S32 data_size = mesgsys->getSizeFast(_PREHASH_ObjectData, block_num, _PREHASH_Data);
-				if (data_size <= 0)
+				if (update.mData.empty())
 				{
 					mData = NULL;
 				}
 				else
 				{
 					// ...has generic data
-					mData = new U8[data_size];
-					mesgsys->getBinaryDataFast(_PREHASH_ObjectData, _PREHASH_Data, mData, data_size, block_num);
+					mData = new U8[update.mData.size()];
+					memcpy(mData, &update.mData[0], update.mData.size());		/* Flawfinder: ignore */
 				}
 
 				mHudTextString.clear();				//Cache for reset on debug infodisplay toggle.
 				mHudTextColor = LLColor4U::white;	//Cache for reset on debug infodisplay toggle.
 
-				S32 text_size = mesgsys->getSizeFast(_PREHASH_ObjectData, block_num, _PREHASH_Text);
-				if (text_size > 1)
+				if (update.mHasText)
 				{
 					// Setup object text
 					if (!mText)
@@ -1129,14 +1108,8 @@ U32 LLViewerObject::processUpdateMessage(LLMessageSystem *mesgsys,
 					}
 
 					//Cache for reset on debug infodisplay toggle.
-					mesgsys->getStringFast(_PREHASH_ObjectData, _PREHASH_Text, mHudTextString, block_num );
-					
-					LLColor4U coloru;
-					mesgsys->getBinaryDataFast(_PREHASH_ObjectData, _PREHASH_TextColor, coloru.mV, 4, block_num);
-
-					// alpha was flipped so that it zero encoded better
-					coloru.mV[3] = 255 - coloru.mV[3];
-					mHudTextColor = LLColor4(coloru);	//Cache for reset on debug infodisplay toggle.
+					mHudTextString = update.mText;
+					mHudTextColor = LLColor4(update.mTextColor);	//Cache for reset on debug infodisplay toggle.
 					if(mText->getDoFade())	//Fade is disabled when this is being overridden by debug text.
 					{
 						mText->setColor(mHudTextColor);
@@ -1148,7 +1121,7 @@ U32 LLViewerObject::processUpdateMessage(LLMessageSystem *mesgsys,
 						mText->setObjectText(mHudTextString);
 					}
 // [/RLVa:KB]
-	
+
 					setChanged(MOVED | SILHOUETTE);
 				}
 				else if (mText.notNull())
@@ -1157,54 +1130,14 @@ U32 LLViewerObject::processUpdateMessage(LLMessageSystem *mesgsys,
 					mText = NULL;
 				}
 
-				std::string media_url;
-				mesgsys->getStringFast(_PREHASH_ObjectData, _PREHASH_MediaURL, media_url, block_num);
-                retval |= checkMediaURL(media_url);
-                
+                retval |= checkMediaURL(update.mMediaURL);
+
 				//
 				// Unpack particle system data
 				//
-				unpackParticleSource(block_num, owner_id);
-
-				// Mark all extra parameters not used
-				std::map<U16, ExtraParameter*>::iterator iter;
-				for (iter = mExtraParameterList.begin(); iter != mExtraParameterList.end(); ++iter)
-				{
-					iter->second->in_use = FALSE;
-				}
-
-				// Unpack extra parameters
-				S32 size = mesgsys->getSizeFast(_PREHASH_ObjectData, block_num, _PREHASH_ExtraParams);
-				if (size > 0)
-				{
-					U8 *buffer = new U8[size];
-					mesgsys->getBinaryDataFast(_PREHASH_ObjectData, _PREHASH_ExtraParams, buffer, size, block_num);
-					LLDataPackerBinaryBuffer dp(buffer, size);
-
-					U8 num_parameters;
-					dp.unpackU8(num_parameters, "num_params");
-					U8 param_block[MAX_OBJECT_PARAMS_SIZE];
-					for (U8 param=0; param<num_parameters; ++param)
-					{
-						U16 param_type;
-						S32 param_size;
-						dp.unpackU16(param_type, "param_type");
-						dp.unpackBinaryData(param_block, param_size, "param_data");
-						//LL_INFOS() << "Param type: " << param_type << ", Size: " << param_size << LL_ENDL;
-						LLDataPackerBinaryBuffer dp2(param_block, param_size);
-						unpackParameterEntry(param_type, &dp2);
-					}
-					delete[] buffer;
-				}
+				updateParticleSource(update, owner_id);
 
-				for (iter = mExtraParameterList.begin(); iter != mExtraParameterList.end(); ++iter)
-				{
-					if (!iter->second->in_use)
-					{
-						// Send an update message in case it was formerly in use
-						parameterChanged(iter->first, iter->second->data, FALSE, false);
-					}
-				}
+				applyExtraParameters(update);
 				break;
 			}
 
@@ -1213,7 +1146,7 @@ U32 LLViewerObject::processUpdateMessage(LLMessageSystem *mesgsys,
 #ifdef DEBUG_UPDATE_TYPE
 				LL_INFOS() << "TI:" << getID() << LL_ENDL;
 #endif
-				processTerseData(mesgsys, user_data, block_num, this_update_precision, new_pos_parent, new_rot, new_angv, test_pos_parent);
+				applyTerseData(update, this_update_precision, new_pos_parent, new_rot, new_angv, test_pos_parent);
 				break;
 			}
 
@@ -1225,18 +1158,7 @@ U32 LLViewerObject::processUpdateMessage(LLMessageSystem *mesgsys,
 	else
 	{
 		// handle the compressed case
-		LLUUID sound_uuid;
-		LLUUID	owner_id;
-		F32    gain = 0;
-		U8     sound_flags = 0;
-		F32		cutoff = 0;
-
-		U16 val[4];
-
-		U8		state;
-
-		dp->unpackU8(state, "State");
-		mState = state;
+		mState = update.mState;
 
 		switch(update_type)
 		{
@@ -1245,43 +1167,16 @@ U32 LLViewerObject::processUpdateMessage(LLMessageSystem *mesgsys,
 #ifdef DEBUG_UPDATE_TYPE
 				LL_INFOS() << "CompTI:" << getID() << LL_ENDL;
 #endif
-				U8		value;
-				dp->unpackU8(value, "agent");
-				if (value)
+				if (update.mHasFootPlane)
 				{
-					LLVector4 collision_plane;
-					dp->unpackVector4(collision_plane, "Plane");
-					((LLVOAvatar*)this)->setFootPlane(collision_plane);
+					((LLVOAvatar*)this)->setFootPlane(update.mFootPlane);
 				}
 				test_pos_parent = getPosition();
-				dp->unpackVector3(new_pos_parent, "Pos");
-				dp->unpackU16(val[VX], "VelX");
-				dp->unpackU16(val[VY], "VelY");
-				dp->unpackU16(val[VZ], "VelZ");
-				setVelocity(U16_to_F32(val[VX], -128.f, 128.f),
-							U16_to_F32(val[VY], -128.f, 128.f),
-							U16_to_F32(val[VZ], -128.f, 128.f));
-				dp->unpackU16(val[VX], "AccX");
-				dp->unpackU16(val[VY], "AccY");
-				dp->unpackU16(val[VZ], "AccZ");
-				setAcceleration(U16_to_F32(val[VX], -64.f, 64.f),
-								U16_to_F32(val[VY], -64.f, 64.f),
-								U16_to_F32(val[VZ], -64.f, 64.f));
-
-				dp->unpackU16(val[VX], "ThetaX");
-				dp->unpackU16(val[VY], "ThetaY");
-				dp->unpackU16(val[VZ], "ThetaZ");
-				dp->unpackU16(val[VS], "ThetaS");
-				new_rot.mQ[VX] = U16_to_F32(val[VX], -1.f, 1.f);
-				new_rot.mQ[VY] = U16_to_F32(val[VY], -1.f, 1.f);
-				new_rot.mQ[VZ] = U16_to_F32(val[VZ], -1.f, 1.f);
-				new_rot.mQ[VS] = U16_to_F32(val[VS], -1.f, 1.f);
-				dp->unpackU16(val[VX], "AccX");
-				dp->unpackU16(val[VY], "AccY");
-				dp->unpackU16(val[VZ], "AccZ");
-				new_angv.set(U16_to_F32(val[VX], -64.f, 64.f),
-							 U16_to_F32(val[VY], -64.f, 64.f),
-							 U16_to_F32(val[VZ], -64.f, 64.f));
+				new_pos_parent = update.mPosition;
+				setVelocity(update.mVelocity);
+				setAcceleration(update.mAcceleration);
+				new_rot = update.mRotation;
+				new_angv = update.mAngularVelocity;
 				setAngularVelocity(new_angv);
 			}
 			break;
@@ -1297,10 +1192,10 @@ U32 LLViewerObject::processUpdateMessage(LLMessageSystem *mesgsys,
 				{
 					gFloaterTools->dirty();
 				}
-	
-				dp->unpackU32(crc, "CRC");
+
+				crc = update.mCRC;
 				mTotalCRC = crc;
-				dp->unpackU8(material, "Material");
+				material = update.mMaterial;
 				U8 old_material = getMaterial();
 				if (old_material != material)
 				{
@@ -1310,63 +1205,40 @@ U32 LLViewerObject::processUpdateMessage(LLMessageSystem *mesgsys,
 						gPipeline.markMoved(mDrawable, FALSE); // undamped
 					}
 				}
-				dp->unpackU8(click_action, "ClickAction");
+				click_action = update.mClickAction;
 				setClickAction(click_action);
-				dp->unpackVector3(new_scale, "Scale");
-				dp->unpackVector3(new_pos_parent, "Pos");
-				LLVector3 vec;
-				dp->unpackVector3(vec, "Rot");
-				new_rot.unpackFromVector3(vec);
+				new_scale = update.mScale;
+				new_pos_parent = update.mPosition;
+				new_rot = update.mRotation;
 				setAcceleration(LLVector3::zero);
 
-				U32 value;
-				dp->unpackU32(value, "SpecialCode");
-				dp->setPassFlags(value);
-				dp->unpackUUID(owner_id, "Owner");
-
+				const LLUUID& owner_id = update.mOwnerID;
 				mOwnerID = owner_id;
 
-				if (value & 0x80)
+				if (update.mHasAngularVelocity)
 				{
-					dp->unpackVector3(new_angv, "Omega");
+					new_angv = update.mAngularVelocity;
 					setAngularVelocity(new_angv);
 				}
 
-				if (value & 0x20)
-				{
-					dp->unpackU32(parent_id, "ParentID");
-				}
-				else
-				{
-					parent_id = 0;
-				}
+				parent_id = update.mParentID;
 
-				S32 sp_size;
-				U32 size;
-				if (value & 0x2)
-				{
-					sp_size = 1;
-					delete [] mData;
-					mData = new U8[1];
-					dp->unpackU8(((U8*)mData)[0], "TreeData");
-				}
-				else if (value & 0x1)
+				delete [] mData;
+				if (update.mData.empty())
 				{
-					dp->unpackU32(size, "ScratchPadSize");
-					delete [] mData;
-					mData = new U8[size];
-					dp->unpackBinaryData((U8 *)mData, sp_size, "PartData");
+					mData = NULL;
 				}
 				else
 				{
-					mData = NULL;
+					mData = new U8[update.mData.size()];
+					memcpy(mData, &update.mData[0], update.mData.size());		/* Flawfinder: ignore */
 				}
 
 				mHudTextString.clear();				//Cache for reset on debug infodisplay toggle.
 				mHudTextColor = LLColor4U::white;	//Cache for reset on debug infodisplay toggle.
 
 				// Setup object text
-				if (!mText && (value & 0x4))
+				if (!mText && update.mHasText)
 				{
 					mText = (LLHUDText *)LLHUDObject::addHUDObject(LLHUDObject::LL_HUD_TEXT);
 					mText->setFont(LLFontGL::getFontSansSerif());
@@ -1376,14 +1248,11 @@ U32 LLViewerObject::processUpdateMessage(LLMessageSystem *mesgsys,
 					mText->setOnHUDAttachment(isHUDAttachment());
 				}
 
-				if (value & 0x4)
+				if (update.mHasText)
 				{
 					//Cache for reset on debug infodisplay toggle.
-					dp->unpackString(mHudTextString, "Text");
-					LLColor4U coloru;
-					dp->unpackBinaryDataFixed(coloru.mV, 4, "Color");
-					coloru.mV[3] = 255 - coloru.mV[3];
-					mHudTextColor = LLColor4(coloru);	//Cache for reset on debug infodisplay toggle.
+					mHudTextString = update.mText;
+					mHudTextColor = LLColor4(update.mTextColor);	//Cache for reset on debug infodisplay toggle.
 					if(mText->getDoFade())	//Fade is disabled when this is being overridden by debug text.
 					mText->setColor(mHudTextColor);
 					mText->setString(mHudTextString);
@@ -1402,82 +1271,29 @@ U32 LLViewerObject::processUpdateMessage(LLMessageSystem *mesgsys,
 					mText = NULL;
 				}
 
-                std::string media_url;
-				if (value & 0x200)
-				{
-					dp->unpackString(media_url, "MediaURL");
-				}
-                retval |= checkMediaURL(media_url);
+                retval |= checkMediaURL(update.mMediaURL);
 
 				//
-				// Unpack particle system data
+				// Unpack particle system data, legacy or (on volumes) new
 				//
-				if (value & 0x8)
-				{
-					unpackParticleSource(*dp, owner_id, true);
-				}
-				else if (!(value & 0x400))
-				{
-					deleteParticleSource();
-				}
-				
-				// Mark all extra parameters not used
-				std::map<U16, ExtraParameter*>::iterator iter;
-				for (iter = mExtraParameterList.begin(); iter != mExtraParameterList.end(); ++iter)
-				{
-					iter->second->in_use = FALSE;
-				}
-
-				// Unpack extra params
-				U8 num_parameters;
-				dp->unpackU8(num_parameters, "num_params");
-				U8 param_block[MAX_OBJECT_PARAMS_SIZE];
-				for (U8 param=0; param<num_parameters; ++param)
-				{
-					U16 param_type;
-					S32 param_size;
-					dp->unpackU16(param_type, "param_type");
-					dp->unpackBinaryData(param_block, param_size, "param_data");
-					//LL_INFOS() << "Param type: " << param_type << ", Size: " << param_size << LL_ENDL;
-					LLDataPackerBinaryBuffer dp2(param_block, param_size);
-					unpackParameterEntry(param_type, &dp2);
-				}
-
-				for (iter = mExtraParameterList.begin(); iter != mExtraParameterList.end(); ++iter)
-				{
-					if (!iter->second->in_use)
-					{
-						// Send an update message in case it was formerly in use
-						parameterChanged(iter->first, iter->second->data, FALSE, false);
-					}
-				}
+				updateParticleSource(update, owner_id);
 
-				if (value & 0x10)
-				{
-					dp->unpackUUID(sound_uuid, "SoundUUID");
-					dp->unpackF32(gain, "SoundGain");
-					dp->unpackU8(sound_flags, "SoundFlags");
-					dp->unpackF32(cutoff, "SoundRadius");
-				}
+				applyExtraParameters(update);
 
-				if (value & 0x100)
+				if (update.mHasNameValues)
 				{
-					std::string name_value_list;
-					dp->unpackString(name_value_list, "NV");
-
-					setNameValueList(name_value_list);
+					setNameValueList(update.mNameValues);
 				}
 
 				mTotalCRC = crc;
 
-				setAttachedSound(sound_uuid, owner_id, gain, sound_flags);
+				setAttachedSound(update.mSoundID, owner_id, update.mSoundGain, update.mSoundFlags);
 
 				// only get these flags on updates from sim, not cached ones
 				// Preload these five flags for every object.
 				// Finer shades require the object to be selected, and the selection manager
 				// stores the extended permission info.
-				U32 flags;
-				mesgsys->getU32Fast(_PREHASH_ObjectData, _PREHASH_UpdateFlags, flags, block_num);
+				U32 flags = update.mUpdateFlags;
 				// keep local flags and overwrite remote-controlled flags
 				mFlags = (mFlags & FLAGS_LOCAL) | flags;
 
@@ -1994,177 +1810,54 @@ U32 LLViewerObject::processUpdateMessage(LLMessageSystem *mesgsys,
 	return retval;
 }
 
-void LLViewerObject::processTerseData(LLMessageSystem *mesgsys, void **user_data, U32 block_num, S32& this_update_precision, LLVector3& new_pos_parent, LLQuaternion& new_rot, LLVector3& new_angv, LLVector3& test_pos_parent)
+void LLViewerObject::applyTerseData(const LLObjectUpdateData& update, S32& this_update_precision, LLVector3& new_pos_parent, LLQuaternion& new_rot, LLVector3& new_angv, LLVector3& test_pos_parent)
 {
-	// <FS:CR> Aurora Sim
-	//const F32 size = LLWorld::getInstance()->getRegionWidthInMeters();	
-	const F32 size = mRegionp->getWidth();
-	// </FS:CR> Aurora Sim
-	const F32 MAX_HEIGHT = LLWorld::getInstance()->getRegionMaxHeight();
-	const F32 MIN_HEIGHT = LLWorld::getInstance()->getRegionMinHeight();
+	if (update.mHasMotion)
+	{
+		// <FS:CR> Aurora Sim
+		//const F32 size = LLWorld::getInstance()->getRegionWidthInMeters();	
+		const F32 size = mRegionp->getWidth();
+		// </FS:CR> Aurora Sim
+		const F32 MAX_HEIGHT = LLWorld::getInstance()->getRegionMaxHeight();
+		const F32 MIN_HEIGHT = LLWorld::getInstance()->getRegionMinHeight();
 
-	U8  data[60+16]; // This needs to match the largest size below.
-#ifdef LL_BIG_ENDIAN
-	U16 valswizzle[4];
-#endif
-	U16	*val;
-	S32 count = 0;
-	LLVector4 collision_plane;
-
-	S32 length = mesgsys->getSizeFast(_PREHASH_ObjectData, block_num, _PREHASH_ObjectData);
-	mesgsys->getBinaryDataFast(_PREHASH_ObjectData, _PREHASH_ObjectData, data, length, block_num);
-
-	switch (length)
-	{
-	case(60 + 16) :
-		// pull out collision normal for avatar
-		htonmemcpy(collision_plane.mV, &data[count], MVT_LLVector4, sizeof(LLVector4));
-		((LLVOAvatar*)this)->setFootPlane(collision_plane);
-		count += sizeof(LLVector4);
-		// fall through
-	case 60:
-		// this is a terse 32 update
-		// pos
-		this_update_precision = 32;
-		htonmemcpy(new_pos_parent.mV, &data[count], MVT_LLVector3, sizeof(LLVector3));
-		count += sizeof(LLVector3);
-		// vel
-		htonmemcpy((void*)getVelocity().mV, &data[count], MVT_LLVector3, sizeof(LLVector3));
-		count += sizeof(LLVector3);
-		// acc
-		htonmemcpy((void*)getAcceleration().mV, &data[count], MVT_LLVector3, sizeof(LLVector3));
-		count += sizeof(LLVector3);
-		// theta
-		{
-			LLVector3 vec;
-			htonmemcpy(vec.mV, &data[count], MVT_LLVector3, sizeof(LLVector3));
-			new_rot.unpackFromVector3(vec);
-		}
-		count += sizeof(LLVector3);
-		// omega
-		htonmemcpy((void*)new_angv.mV, &data[count], MVT_LLVector3, sizeof(LLVector3));
-		if (new_angv.isExactlyZero())
+		if (update.mHasFootPlane)
 		{
-			// reset rotation time
-			resetRot();
+			// collision normal for avatar
+			((LLVOAvatar*)this)->setFootPlane(update.mFootPlane);
 		}
-		setAngularVelocity(new_angv);
-#if LL_DARWIN
-		if (length == 76)
+
+		// Compare against the old position at the precision of the update.
+		this_update_precision = update.mPrecision;
+		if (this_update_precision == 16)
 		{
-			setAngularVelocity(LLVector3::zero);
+			test_pos_parent.quantize16(-0.5f*size, 1.5f*size, MIN_HEIGHT, MAX_HEIGHT);
 		}
-#endif
-		break;
-	case(32 + 16) :
-		// pull out collision normal for avatar
-		htonmemcpy(collision_plane.mV, &data[count], MVT_LLVector4, sizeof(LLVector4));
-		((LLVOAvatar*)this)->setFootPlane(collision_plane);
-		count += sizeof(LLVector4);
-		// fall through
-	case 32:
-		// this is a terse 16 update
-		this_update_precision = 16;
-		test_pos_parent.quantize16(-0.5f*size, 1.5f*size, MIN_HEIGHT, MAX_HEIGHT);
-
-#ifdef LL_BIG_ENDIAN
-		htonmemcpy(valswizzle, &data[count], MVT_U16Vec3, 6); 
-		val = valswizzle;
-#else
-		val = (U16 *)&data[count];
-#endif
-		count += sizeof(U16) * 3;
-		new_pos_parent.mV[VX] = U16_to_F32(val[VX], -0.5f*size, 1.5f*size);
-		new_pos_parent.mV[VY] = U16_to_F32(val[VY], -0.5f*size, 1.5f*size);
-		new_pos_parent.mV[VZ] = U16_to_F32(val[VZ], MIN_HEIGHT, MAX_HEIGHT);
-
-#ifdef LL_BIG_ENDIAN
-		htonmemcpy(valswizzle, &data[count], MVT_U16Vec3, 6); 
-		val = valswizzle;
-#else
-		val = (U16 *)&data[count];
-#endif
-		count += sizeof(U16) * 3;
-		setVelocity(U16_to_F32(val[VX], -size, size),
-			U16_to_F32(val[VY], -size, size),
-			U16_to_F32(val[VZ], -size, size));
-
-#ifdef LL_BIG_ENDIAN
-		htonmemcpy(valswizzle, &data[count], MVT_U16Vec3, 6); 
-		val = valswizzle;
-#else
-		val = (U16 *)&data[count];
-#endif
-		count += sizeof(U16) * 3;
-		setAcceleration(U16_to_F32(val[VX], -size, size),
-			U16_to_F32(val[VY], -size, size),
-			U16_to_F32(val[VZ], -size, size));
-
-#ifdef LL_BIG_ENDIAN
-		htonmemcpy(valswizzle, &data[count], MVT_U16Quat, 8); 
-		val = valswizzle;
-#else
-		val = (U16 *)&data[count];
-#endif
-		count += sizeof(U16) * 4;
-		new_rot.mQ[VX] = U16_to_F32(val[VX], -1.f, 1.f);
-		new_rot.mQ[VY] = U16_to_F32(val[VY], -1.f, 1.f);
-		new_rot.mQ[VZ] = U16_to_F32(val[VZ], -1.f, 1.f);
-		new_rot.mQ[VW] = U16_to_F32(val[VW], -1.f, 1.f);
-
-#ifdef LL_BIG_ENDIAN
-		htonmemcpy(valswizzle, &data[count], MVT_U16Vec3, 6); 
-		val = valswizzle;
-#else
-		val = (U16 *)&data[count];
-#endif
-		new_angv.set(U16_to_F32(val[VX], -size, size),
-			U16_to_F32(val[VY], -size, size),
-			U16_to_F32(val[VZ], -size, size));
-		if (new_angv.isExactlyZero())
+		else if (this_update_precision == 8)
 		{
-			// reset rotation time
-			resetRot();
+			test_pos_parent.quantize8(-0.5f*size, 1.5f*size, MIN_HEIGHT, MAX_HEIGHT);
 		}
-		setAngularVelocity(new_angv);
-		break;
 
-	case 16:
-		// this is a terse 8 update
-		this_update_precision = 8;
-		test_pos_parent.quantize8(-0.5f*size, 1.5f*size, MIN_HEIGHT, MAX_HEIGHT);
-		new_pos_parent.mV[VX] = U8_to_F32(data[0], -0.5f*size, 1.5f*size);
-		new_pos_parent.mV[VY] = U8_to_F32(data[1], -0.5f*size, 1.5f*size);
-		new_pos_parent.mV[VZ] = U8_to_F32(data[2], MIN_HEIGHT, MAX_HEIGHT);
-
-		setVelocity(U8_to_F32(data[3], -size, size),
-			U8_to_F32(data[4], -size, size),
-			U8_to_F32(data[5], -size, size));
-
-		setAcceleration(U8_to_F32(data[6], -size, size),
-			U8_to_F32(data[7], -size, size),
-			U8_to_F32(data[8], -size, size));
-
-		new_rot.mQ[VX] = U8_to_F32(data[9], -1.f, 1.f);
-		new_rot.mQ[VY] = U8_to_F32(data[10], -1.f, 1.f);
-		new_rot.mQ[VZ] = U8_to_F32(data[11], -1.f, 1.f);
-		new_rot.mQ[VW] = U8_to_F32(data[12], -1.f, 1.f);
-
-		new_angv.set(U8_to_F32(data[13], -size, size),
-			U8_to_F32(data[14], -size, size),
-			U8_to_F32(data[15], -size, size));
+		new_pos_parent = update.mPosition;
+		setVelocity(update.mVelocity);
+		setAcceleration(update.mAcceleration);
+		new_rot = update.mRotation;
+		new_angv = update.mAngularVelocity;
 		if (new_angv.isExactlyZero())
 		{
 			// reset rotation time
 			resetRot();
 		}
 		setAngularVelocity(new_angv);
-		break;
-	default:
-		break;
+#if LL_DARWIN
+		if (this_update_precision == 32 && update.mHasFootPlane)
+		{
+			setAngularVelocity(LLVector3::zero);
+		}
+#endif
 	}
 
-	mesgsys->getU8Fast(_PREHASH_ObjectData, _PREHASH_State, mState, block_num);
+	mState = update.mState;
 }
 
 BOOL LLViewerObject::isActive() const
@@ -4855,82 +4548,38 @@ void LLViewerObject::setParticleSource(const LLPartSysData& particle_parameters,
 	LLViewerPartSim::getInstance()->addPartSource(pss);
 }
 
-void LLViewerObject::unpackParticleSource(const S32 block_num, const LLUUID& owner_id)
+void LLViewerObject::updateParticleSource(const LLObjectUpdateData& update, const LLUUID& owner_id)
 {
-	if (!mPartSourcep.isNull() && mPartSourcep->isDead())
+	if (update.mParticles == LLObjectUpdateData::PARTICLES_KEEP)
 	{
-		mPartSourcep = NULL;
-	}
-	if (mPartSourcep)
-	{
-		// If we've got one already, just update the existing source (or remove it)
-		if (!LLViewerPartSourceScript::unpackPSS(this, mPartSourcep, block_num))
-		{
-			mPartSourcep->setDead();
-			mPartSourcep = NULL;
-		}
-	}
-	else
-	{
-		LLPointer<LLViewerPartSourceScript> pss = LLViewerPartSourceScript::unpackPSS(this, NULL, block_num);
-		//If the owner is muted, don't create the system
-		if(LLMuteList::getInstance()->isMuted(owner_id, LLMute::flagParticles)) return;
-
-		// We need to be able to deal with a particle source that hasn't changed, but still got an update!
-		if (pss)
-		{
-// 			LL_INFOS() << "Making particle system with owner " << owner_id << LL_ENDL;
-			pss->setOwnerUUID(owner_id);
-			mPartSourcep = pss;
-			LLViewerPartSim::getInstance()->addPartSource(pss);
-		}
+		return;
 	}
-	if (mPartSourcep)
+	if (update.mParticles == LLObjectUpdateData::PARTICLES_REMOVE)
 	{
-		if (mPartSourcep->getImage()->getID() != mPartSourcep->mPartSysData.mPartImageID)
-		{
-			LLViewerTexture* image;
-			if (mPartSourcep->mPartSysData.mPartImageID == LLUUID::null)
-			{
-				image = LLViewerTextureManager::getFetchedTextureFromFile("pixiesmall.j2c");
-			}
-			else
-			{
-				image = LLViewerTextureManager::getFetchedTexture(mPartSourcep->mPartSysData.mPartImageID);
-			}
-			mPartSourcep->setImage(image);
-		}
+		deleteParticleSource();
+		return;
 	}
-}
 
-void LLViewerObject::unpackParticleSource(LLDataPacker &dp, const LLUUID& owner_id, bool legacy)
-{
 	if (!mPartSourcep.isNull() && mPartSourcep->isDead())
 	{
 		mPartSourcep = NULL;
 	}
 	if (mPartSourcep)
 	{
-		// If we've got one already, just update the existing source (or remove it)
-		if (!LLViewerPartSourceScript::unpackPSS(this, mPartSourcep, dp, legacy))
-		{
-			mPartSourcep->setDead();
-			mPartSourcep = NULL;
-		}
+		// If we've got one already, just update the existing source
+		LLViewerPartSourceScript::unpackPSS(this, mPartSourcep, update.mParticleData);
 	}
 	else
 	{
-		LLPointer<LLViewerPartSourceScript> pss = LLViewerPartSourceScript::unpackPSS(this, NULL, dp, legacy);
 		//If the owner is muted, don't create the system
 		if(LLMuteList::getInstance()->isMuted(owner_id, LLMute::flagParticles)) return;
+
 		// We need to be able to deal with a particle source that hasn't changed, but still got an update!
-		if (pss)
-		{
-// 			LL_INFOS() << "Making particle system with owner " << owner_id << LL_ENDL;
-			pss->setOwnerUUID(owner_id);
-			mPartSourcep = pss;
-			LLViewerPartSim::getInstance()->addPartSource(pss);
-		}
+		LLPointer<LLViewerPartSourceScript> pss = LLViewerPartSourceScript::unpackPSS(this, NULL, update.mParticleData);
+// 		LL_INFOS() << "Making particle system with owner " << owner_id << LL_ENDL;
+		pss->setOwnerUUID(owner_id);
+		mPartSourcep = pss;
+		LLViewerPartSim::getInstance()->addPartSource(pss);
 	}
 	if (mPartSourcep)
 	{
@@ -5094,7 +4743,34 @@ void LLViewerObject::adjustAudioGain(const F32 gain)
 
 //----------------------------------------------------------------------------
 
-bool LLViewerObject::unpackParameterEntry(U16 param_type, LLDataPacker *dp)
+void LLViewerObject::applyExtraParameters(const LLObjectUpdateData& update)
+{
+	const LLObjectUpdateData::ExtraParams& params = update.mExtraParams;
+
+	// Mark all extra parameters not used
+	std::map<U16, ExtraParameter*>::iterator iter;
+	for (iter = mExtraParameterList.begin(); iter != mExtraParameterList.end(); ++iter)
+	{
+		iter->second->in_use = FALSE;
+	}
+
+	for (U32 i = 0; i < params.mCount; ++i)
+	{
+		U16 param_type = params.mTypes[i];
+		unpackParameterEntry(param_type, *params.get(param_type));
+	}
+
+	for (iter = mExtraParameterList.begin(); iter != mExtraParameterList.end(); ++iter)
+	{
+		if (!iter->second->in_use)
+		{
+			// Send an update message in case it was formerly in use
+			parameterChanged(iter->first, iter->second->data, FALSE, false);
+		}
+	}
+}
+
+bool LLViewerObject::unpackParameterEntry(U16 param_type, const LLNetworkData& data)
 {
 	if (LLNetworkData::PARAMS_MESH == param_type)
 	{
@@ -5103,7 +4779,7 @@ bool LLViewerObject::unpackParameterEntry(U16 param_type, LLDataPacker *dp)
 	ExtraParameter* param = getExtraParameterEntryCreate(param_type);
 	if (param)
 	{
-		param->data->unpack(*dp);
+		param->data->copy(data);
 		param->in_use = TRUE;
 		parameterChanged(param_type, param->data, TRUE, false);
 		return true;
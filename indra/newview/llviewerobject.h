@@ -63,6 +63,7 @@ class LLWorld;
 class LLNameValue;
 class LLNetMap;
 class LLMessageSystem;
+struct LLObjectUpdateData;
 class LLPartSysData;
 class LLPrimitive;
 class LLPipeline;
@@ -169,13 +170,15 @@ public:
 		INVALID_UPDATE = 0x80000000 
 	};
 
+	// update is block block_num of the message, already decoded by the
+	// object list; mesgsys is still current for the sender and region data.
 	virtual U32		processUpdateMessage(LLMessageSystem *mesgsys,
 										void **user_data,
 										U32 block_num,
 										const EObjectUpdateType update_type,
-										LLDataPacker *dp);
+										const LLObjectUpdateData& update);
 
-	void processTerseData(LLMessageSystem *mesgsys, void **user_data, U32 block_num, S32& this_update_precision, LLVector3& new_pos_parent, LLQuaternion& new_rot, LLVector3& new_angv, LLVector3& test_pos_parent);
+	void applyTerseData(const LLObjectUpdateData& update, S32& this_update_precision, LLVector3& new_pos_parent, LLQuaternion& new_rot, LLVector3& new_angv, LLVector3& test_pos_parent);
 
 
 	virtual BOOL    isActive() const; // Whether this object needs to do an idleUpdate.
@@ -590,7 +593,8 @@ private:
 	ExtraParameter* createNewParameterEntry(U16 param_type);
 	ExtraParameter* getExtraParameterEntry(U16 param_type) const;
 	ExtraParameter* getExtraParameterEntryCreate(U16 param_type);
-	bool unpackParameterEntry(U16 param_type, LLDataPacker *dp);
+	void applyExtraParameters(const LLObjectUpdateData& update);
+	bool unpackParameterEntry(U16 param_type, const LLNetworkData& data);
 
     // This function checks to see if the given media URL has changed its version
     // and the update wasn't due to this agent's last action.
@@ -711,13 +715,12 @@ protected:
 	
 	BOOL isOnMap();
 
-	void unpackParticleSource(const S32 block_num, const LLUUID& owner_id);
-	void unpackParticleSource(LLDataPacker &dp, const LLUUID& owner_id, bool legacy);
+	void updateParticleSource(const LLObjectUpdateData& update, const LLUUID& owner_id);
 	void deleteParticleSource();
 	void setParticleSource(const LLPartSysData& particle_parameters, const LLUUID& owner_id);
 
 private:
-	void setNameValueList(const std::string& list);		// clears nv pairs and then individually adds \n separated NV pairs from \0 terminated string
+	void setNameValueList(const std::vector<std::string>& name_values);	// clears nv pairs and then individually adds the given NV pairs
 	void deleteTEImages(); // correctly deletes list of images
 	
 protected:
@@ -74,6 +74,9 @@
 #include "u64.h"
 #include "llviewertexturelist.h"
 #include "lldatapacker.h"
+#include "llmessagefields.h"
+#include "llvolumemessage.h"
+#include "llworkerpool.h"
 #ifdef LL_STANDALONE
 #include <zlib.h>
 #else
@@ -256,13 +259,13 @@ void LLViewerObjectList::processUpdateCore(LLViewerObject* objectp,
 										   void** user_data, 
 										   U32 i, 
 										   const EObjectUpdateType update_type, 
-										   LLDataPacker* dpp, 
+										   const LLObjectUpdateData& update, 
 										   BOOL just_created)
 {
 	LLMessageSystem* msg = gMessageSystem;
 
 	// ignore returned flags
-	objectp->processUpdateMessage(msg, user_data, i, update_type, dpp);
+	objectp->processUpdateMessage(msg, user_data, i, update_type, update);
 		
 	if (objectp->isDead())
 	{
@@ -321,6 +324,168 @@ void LLViewerObjectList::processUpdateCore(LLViewerObject* objectp,
 }
 
 static LLTrace::BlockTimerStatHandle FTM_PROCESS_OBJECTS("Process Objects");
+static LLTrace::BlockTimerStatHandle FTM_DECODE_OBJECT_UPDATES("Decode Object Updates");
+static LLTrace::BlockTimerStatHandle FTM_APPLY_OBJECT_UPDATES("Apply Object Updates");
+
+// Below this many blocks a message is decoded inline; handing it to the
+// worker pool would cost more than it saves.
+static const U32 MIN_PARALLEL_DECODE_BLOCKS = 8;
+static const U32 DECODE_BLOCKS_PER_JOB = 4;
+
+// Copies the motion data and state of block i of an ObjectUpdate.
+static void copy_motion_data(LLMessageSystem* mesgsys, S32 i, LLObjectUpdateBlock& block)
+{
+	namespace ObjectData = LLMessageFields::ObjectUpdate::ObjectData;
+
+	block.mMotionSize = ObjectData::ObjectData.getSize(mesgsys, i);
+	if (block.mMotionSize > 0)
+	{
+		ObjectData::ObjectData.get(mesgsys, block.mMotionData, 0, i, sizeof(block.mMotionData));
+	}
+	ObjectData::State.get(mesgsys, block.mUpdate.mState, i);
+}
+
+// Copies block i of a full ObjectUpdate. Fields that are only copied, or
+// take no real work to unpack, go straight into block.mUpdate.
+static void copy_full_update(LLMessageSystem* mesgsys, S32 i, LLObjectUpdateBlock& block)
+{
+	// ObjectUpdate's ObjectData block, read by template position.
+	namespace ObjectData = LLMessageFields::ObjectUpdate::ObjectData;
+
+	LLObjectUpdateData& update = block.mUpdate;
+
+	copy_motion_data(mesgsys, i, block);
+
+	ObjectData::CRC.get(mesgsys, update.mCRC, i);
+	ObjectData::ParentID.get(mesgsys, update.mParentID, i);
+	ObjectData::Sound.get(mesgsys, update.mSoundID, i);
+	// HACK: Owner id only valid if non-null sound id or particle system
+	ObjectData::OwnerID.get(mesgsys, update.mOwnerID, i);
+	ObjectData::Gain.get(mesgsys, update.mSoundGain, i);
+	ObjectData::Flags.get(mesgsys, update.mSoundFlags, i);
+	ObjectData::Material.get(mesgsys, update.mMaterial, i);
+	ObjectData::ClickAction.get(mesgsys, update.mClickAction, i);
+	ObjectData::Scale.get(mesgsys, update.mScale, i);
+	ObjectData::UpdateFlags.get(mesgsys, update.mUpdateFlags, i);
+
+	S32 nv_size = ObjectData::NameValue.getSize(mesgsys, i);
+	if (nv_size > 0)
+	{
+		update.mHasNameValues = true;
+		ObjectData::NameValue.getString(mesgsys, block.mNameValues, i);
+	}
+
+	S32 data_size = ObjectData::Data.getSize(mesgsys, i);
+	if (data_size > 0)
+	{
+		update.mData.resize(data_size);
+		ObjectData::Data.get(mesgsys, &update.mData[0], data_size, i);
+	}
+
+	S32 text_size = ObjectData::Text.getSize(mesgsys, i);
+	if (text_size > 1)
+	{
+		update.mHasText = true;
+		ObjectData::Text.getString(mesgsys, update.mText, i);
+		ObjectData::TextColor.get(mesgsys, update.mTextColor.mV, 4, i);
+		// alpha was flipped so that it zero encoded better
+		update.mTextColor.mV[3] = 255 - update.mTextColor.mV[3];
+	}
+
+	ObjectData::MediaURL.getString(mesgsys, update.mMediaURL, i);
+
+	S32 ps_size = ObjectData::PSBlock.getSize(mesgsys, i);
+	if (ps_size > 0)
+	{
+		block.mPSBlock.resize(ps_size);
+		ObjectData::PSBlock.get(mesgsys, &block.mPSBlock[0], ps_size, i);
+	}
+
+	S32 params_size = ObjectData::ExtraParams.getSize(mesgsys, i);
+	if (params_size > 0)
+	{
+		block.mExtraParams.resize(params_size);
+		ObjectData::ExtraParams.get(mesgsys, &block.mExtraParams[0], params_size, i);
+	}
+
+	S32 te_size = ObjectData::TextureEntry.getSize(mesgsys, i);
+	update.mTEs.size = te_size > 0 ? llmin((U32)te_size, LLTEContents::MAX_TE_BUFFER) : 0;
+	if (update.mTEs.size > 0)
+	{
+		ObjectData::TextureEntry.get(mesgsys, update.mTEs.packed_buffer, 0, i, LLTEContents::MAX_TE_BUFFER);
+	}
+
+	if (block.mPCode == LL_PCODE_VOLUME)
+	{
+		update.mHasVolumeParams = true;
+		update.mVolumeParamsValid = LLVolumeMessage::unpackVolumeParams(&update.mVolumeParams, mesgsys, _PREHASH_ObjectData, i);
+
+		if (ObjectData::TextureAnim.getSize(mesgsys, i))
+		{
+			update.mHasTextureAnim = true;
+			update.mTextureAnim.unpackTAMessage(mesgsys, i);
+		}
+	}
+}
+
+// Decode phase, second half: unpacks what was copied out of the message.
+// Only touches mUpdateBlocks[begin, end) and reads mUpdateRegion.
+void LLViewerObjectList::decodeUpdateBlocks(EObjectUpdateType update_type, bool compressed, bool cached, U32 begin, U32 end)
+{
+	for (U32 i = begin; i < end; ++i)
+	{
+		LLObjectUpdateBlock& block = mUpdateBlocks[i];
+		if (!block.mValid)
+		{
+			continue;
+		}
+
+		LLObjectUpdateData& update = block.mUpdate;
+		if (compressed || cached)
+		{
+			update.mCompressed = true;
+			block.mDP.assignBuffer(&block.mData[0], block.mData.size());
+			if (update_type != OUT_TERSE_IMPROVED) // OUT_FULL_COMPRESSED or OUT_FULL_CACHED
+			{
+				block.mDP.unpackUUID(block.mFullID, "ID");
+				block.mDP.unpackU32(block.mLocalID, "LocalID");
+				block.mDP.unpackU8(block.mPCode, "PCode");
+				update.decodeCompressedFull(block.mDP, block.mPCode == LL_PCODE_VOLUME);
+			}
+			else
+			{
+				block.mDP.unpackU32(block.mLocalID, "LocalID");
+				update.decodeCompressedTerse(block.mDP);
+				if (!block.mTextureEntry.empty())
+				{
+					LLDataPackerBinaryBuffer tdp(&block.mTextureEntry[0], block.mTextureEntry.size());
+					update.decodeTEs(tdp);
+				}
+			}
+			continue;
+		}
+
+		update.decodeMotion(block.mMotionData, block.mMotionSize, mUpdateRegion);
+		if (update_type != OUT_FULL)
+		{
+			continue;
+		}
+
+		if (update.mHasNameValues)
+		{
+			update.decodeNameValues(block.mNameValues);
+		}
+		update.decodeParticles(block.mPSBlock.empty() ? NULL : &block.mPSBlock[0], block.mPSBlock.size());
+		if (!block.mExtraParams.empty())
+		{
+			LLDataPackerBinaryBuffer dp(&block.mExtraParams[0], block.mExtraParams.size());
+			update.decodeExtraParams(dp);
+		}
+		// The face count isn't known until the volume is set in the apply
+		// phase, so parse for the maximum; applyParsedTEMessage() clamps.
+		update.decodeTEs();
+	}
+}
 
 void LLViewerObjectList::processObjectUpdate(LLMessageSystem *mesgsys,
 											 void **user_data,
@@ -340,7 +505,9 @@ void LLViewerObjectList::processObjectUpdate(LLMessageSystem *mesgsys,
 	// Coordinates in simulators are region-local
 	// Until we get region-locality working on viewer we
 	// have to transform to absolute coordinates.
-	num_objects = mesgsys->getNumberOfBlocksFast(_PREHASH_ObjectData);
+	// RegionData and ObjectData are the first two blocks of all four object
+	// update messages, so any of their block accessors will do.
+	num_objects = LLMessageFields::ObjectUpdate::ObjectData::NumBlocks.getNumberOfBlocks(mesgsys);
 
 	// I don't think this case is ever hit.  TODO* Test this.
 	if (!cached && !compressed && update_type != OUT_FULL)
@@ -379,7 +546,7 @@ void LLViewerObjectList::processObjectUpdate(LLMessageSystem *mesgsys,
 	}
 
 	U64 region_handle;
-	mesgsys->getU64Fast(_PREHASH_RegionData, _PREHASH_RegionHandle, region_handle);
+	LLMessageFields::ObjectUpdate::RegionData::RegionHandle.get(mesgsys, region_handle);
 
 	LLViewerRegion *regionp = LLWorld::getInstance()->getRegionFromHandle(region_handle);
 
@@ -389,69 +556,142 @@ void LLViewerObjectList::processObjectUpdate(LLMessageSystem *mesgsys,
 		return;
 	}
 
-	U8 compressed_dpbuffer[2048];
-	LLDataPackerBinaryBuffer compressed_dp(compressed_dpbuffer, 2048);
-	LLDataPacker *cached_dpp = NULL;
 	LLViewerStatsRecorder& recorder = LLViewerStatsRecorder::instance();
-	
-	for (i = 0; i < num_objects; i++)
+
+	// Decode phase: copy every block out of the message system, then unpack
+	// the copies into plain values. No scene state is touched here.
 	{
-		// timer is unused?
-		LLTimer update_timer;
-		BOOL justCreated = FALSE;
-		S32	msg_size = 0;
+		LL_RECORD_BLOCK_TIME(FTM_DECODE_OBJECT_UPDATES);
+
+		mUpdateBlocks.clear();
+		mUpdateBlocks.resize(num_objects);
+
+		// What 16 and 8 bit positions are quantized against.
+		mUpdateRegion.mWidth = regionp->getWidth();
+		mUpdateRegion.mMinHeight = LLWorld::getInstance()->getRegionMinHeight();
+		mUpdateRegion.mMaxHeight = LLWorld::getInstance()->getRegionMaxHeight();
+
+		// Terse and compressed updates share this path but not the position
+		// of Data in their ObjectData block.
+		const LLMessageBinaryField& data_field = update_type == OUT_TERSE_IMPROVED
+			? LLMessageFields::ImprovedTerseObjectUpdate::ObjectData::Data
+			: LLMessageFields::ObjectUpdateCompressed::ObjectData::Data;
 
-		if (cached)
+		for (i = 0; i < num_objects; i++)
 		{
-			U32 id;
-			U32 crc;
-			mesgsys->getU32Fast(_PREHASH_ObjectData, _PREHASH_ID, id, i);
-			mesgsys->getU32Fast(_PREHASH_ObjectData, _PREHASH_CRC, crc, i);
-			msg_size += sizeof(U32) * 2;
-		
-			// Lookup data packer and add this id to cache miss lists if necessary.
-			U8 cache_miss_type = LLViewerRegion::CACHE_MISS_TYPE_NONE;
-			cached_dpp = regionp->getDP(id, crc, cache_miss_type);
-			if (cached_dpp)
+			LLObjectUpdateBlock& block = mUpdateBlocks[i];
+
+			if (cached)
 			{
-				// Cache Hit.
-				cached_dpp->reset();
-				cached_dpp->unpackUUID(fullid, "ID");
-				cached_dpp->unpackU32(local_id, "LocalID");
-				cached_dpp->unpackU8(pcode, "PCode");
+				U32 id;
+				U32 crc;
+				LLMessageFields::ObjectUpdateCached::ObjectData::ID.get(mesgsys, id, i);
+				LLMessageFields::ObjectUpdateCached::ObjectData::CRC.get(mesgsys, crc, i);
+				block.mMsgSize += sizeof(U32) * 2;
+
+				// Lookup data packer and add this id to cache miss lists if necessary.
+				U8 cache_miss_type = LLViewerRegion::CACHE_MISS_TYPE_NONE;
+				LLDataPackerBinaryBuffer* cached_dpp = regionp->getDP(id, crc, cache_miss_type);
+				if (!cached_dpp)
+				{
+					// Cache Miss.
+					recorder.cacheMissEvent(id, update_type, cache_miss_type, block.mMsgSize);
+					block.mValid = false; // no data packer, skip this object
+					continue;
+				}
+				if (cached_dpp->getBufferSize() <= 0)
+				{
+					block.mValid = false;
+					continue;
+				}
+
+				// Cache Hit. Decode a copy; the entry's own packer is left alone.
+				block.mData.assign(cached_dpp->getBuffer(), cached_dpp->getBuffer() + cached_dpp->getBufferSize());
+				LLMessageFields::ObjectUpdateCached::ObjectData::UpdateFlags.get(mesgsys, block.mUpdate.mUpdateFlags, i);
 			}
-			else
+			else if (compressed)
 			{
-				// Cache Miss.
-				recorder.cacheMissEvent(id, update_type, cache_miss_type, msg_size);
+				S32 data_size = data_field.getSize(mesgsys, i);
+				if (data_size <= 0)
+				{
+					block.mValid = false;
+					continue;
+				}
+				block.mData.resize(data_size);
+				data_field.get(mesgsys, &block.mData[0], 0, i, data_size);
 
-				continue; // no data packer, skip this object
+				if (update_type != OUT_TERSE_IMPROVED) // OUT_FULL_COMPRESSED only?
+				{
+					LLMessageFields::ObjectUpdateCompressed::ObjectData::UpdateFlags.get(mesgsys, block.mUpdate.mUpdateFlags, i);
+				}
+				else
+				{
+					const LLMessageBinaryField& te_field = LLMessageFields::ImprovedTerseObjectUpdate::ObjectData::TextureEntry;
+					S32 te_size = te_field.getSize(mesgsys, i);
+					if (te_size > 0)
+					{
+						block.mTextureEntry.resize(te_size);
+						te_field.get(mesgsys, &block.mTextureEntry[0], 0, i, te_size);
+					}
+				}
+			}
+			else if (update_type != OUT_FULL) // !compressed, !OUT_FULL ==> OUT_FULL_CACHED only?
+			{
+				LLMessageFields::ObjectUpdate::ObjectData::ID.get(mesgsys, block.mLocalID, i);
+				block.mMsgSize += sizeof(U32);
+				copy_motion_data(mesgsys, i, block);
 			}
+			else // OUT_FULL only?
+			{
+				LLMessageFields::ObjectUpdate::ObjectData::FullID.get(mesgsys, block.mFullID, i);
+				LLMessageFields::ObjectUpdate::ObjectData::ID.get(mesgsys, block.mLocalID, i);
+				LLMessageFields::ObjectUpdate::ObjectData::PCode.get(mesgsys, block.mPCode, i);
+				block.mMsgSize += sizeof(LLUUID);
+				block.mMsgSize += sizeof(U32);
+				// LL_INFOS() << "Full Update, obj " << local_id << ", global ID" << fullid << "from " << mesgsys->getSender() << LL_ENDL;
+				copy_full_update(mesgsys, i, block);
+			}
+		}
+
+		// The unpacking runs on the worker pool for larger messages.
+		static LLCachedControl<bool> parallel_decode(gSavedSettings, "ParallelObjectUpdateDecode", true);
+		LLWorkerPool::range_job_t job = boost::bind(&LLViewerObjectList::decodeUpdateBlocks, this, update_type, compressed, cached, _1, _2);
+		if (parallel_decode && (U32)num_objects >= MIN_PARALLEL_DECODE_BLOCKS)
+		{
+			LLWorkerPool::getDefault()->parallelFor(num_objects, DECODE_BLOCKS_PER_JOB, job);
+		}
+		else
+		{
+			job(0, num_objects);
 		}
-		else if (compressed)
+	}
+
+	// Apply phase.
+	LL_RECORD_BLOCK_TIME(FTM_APPLY_OBJECT_UPDATES);
+
+	for (i = 0; i < num_objects; i++)
+	{
+		LLObjectUpdateBlock& block = mUpdateBlocks[i];
+		if (!block.mValid)
 		{
-			S32							uncompressed_length = 2048;
-			compressed_dp.reset();
+			continue;
+		}
 
-			U32 flags = 0;
-			if (update_type != OUT_TERSE_IMPROVED)
-			{
-				mesgsys->getU32Fast(_PREHASH_ObjectData, _PREHASH_UpdateFlags, flags, i);
-			}
-			
-			uncompressed_length = mesgsys->getSizeFast(_PREHASH_ObjectData, i, _PREHASH_Data);
-			mesgsys->getBinaryDataFast(_PREHASH_ObjectData, _PREHASH_Data, compressed_dpbuffer, 0, i);
-			compressed_dp.assignBuffer(compressed_dpbuffer, uncompressed_length);
+		// timer is unused?
+		LLTimer update_timer;
+		BOOL justCreated = FALSE;
+		S32	msg_size = block.mMsgSize;
 
-			if (update_type != OUT_TERSE_IMPROVED) // OUT_FULL_COMPRESSED only?
+		if (compressed || cached)
+		{
+			local_id = block.mLocalID;
+			if (update_type != OUT_TERSE_IMPROVED) // OUT_FULL_COMPRESSED or OUT_FULL_CACHED
 			{
-				compressed_dp.unpackUUID(fullid, "ID");
-				compressed_dp.unpackU32(local_id, "LocalID");
-				compressed_dp.unpackU8(pcode, "PCode");
+				fullid = block.mFullID;
+				pcode = block.mPCode;
 			}
 			else
 			{
-				compressed_dp.unpackU32(local_id, "LocalID");
 				getUUIDFromLocal(fullid,
 								 local_id,
 								 gMessageSystem->getSenderIP(),
@@ -465,8 +705,7 @@ void LLViewerObjectList::processObjectUpdate(LLMessageSystem *mesgsys,
 		}
 		else if (update_type != OUT_FULL) // !compressed, !OUT_FULL ==> OUT_FULL_CACHED only?
 		{
-			mesgsys->getU32Fast(_PREHASH_ObjectData, _PREHASH_ID, local_id, i);
-			msg_size += sizeof(U32);
+			local_id = block.mLocalID;
 
 			getUUIDFromLocal(fullid,
 							local_id,
@@ -480,11 +719,8 @@ void LLViewerObjectList::processObjectUpdate(LLMessageSystem *mesgsys,
 		}
 		else // OUT_FULL only?
 		{
-			mesgsys->getUUIDFast(_PREHASH_ObjectData, _PREHASH_FullID, fullid, i);
-			mesgsys->getU32Fast(_PREHASH_ObjectData, _PREHASH_ID, local_id, i);
-			msg_size += sizeof(LLUUID);
-			msg_size += sizeof(U32);
-			// LL_INFOS() << "Full Update, obj " << local_id << ", global ID" << fullid << "from " << mesgsys->getSender() << LL_ENDL;
+			fullid = block.mFullID;
+			local_id = block.mLocalID;
 		}
 		objectp = findObject(fullid);
 
@@ -545,7 +781,7 @@ void LLViewerObjectList::processObjectUpdate(LLMessageSystem *mesgsys,
 					continue;
 				}
 
-				mesgsys->getU8Fast(_PREHASH_ObjectData, _PREHASH_PCode, pcode, i);
+				pcode = block.mPCode;
 				msg_size += sizeof(U8);
 
 			}
@@ -594,18 +830,18 @@ void LLViewerObjectList::processObjectUpdate(LLMessageSystem *mesgsys,
 			{
 				objectp->mLocalID = local_id;
 			}
-			processUpdateCore(objectp, user_data, i, update_type, &compressed_dp, justCreated);
+			processUpdateCore(objectp, user_data, i, update_type, block.mUpdate, justCreated);
 			if (update_type != OUT_TERSE_IMPROVED) // OUT_FULL_COMPRESSED only?
 			{
 				bCached = true;
-				LLViewerRegion::eCacheUpdateResult result = objectp->mRegionp->cacheFullUpdate(objectp, compressed_dp);
+				LLViewerRegion::eCacheUpdateResult result = objectp->mRegionp->cacheFullUpdate(objectp, block.mDP);
 				recorder.cacheFullUpdate(local_id, update_type, result, objectp, msg_size);
 			}
 		}
 		else if (cached)
 		{
 			objectp->mLocalID = local_id;
-			processUpdateCore(objectp, user_data, i, update_type, cached_dpp, justCreated);
+			processUpdateCore(objectp, user_data, i, update_type, block.mUpdate, justCreated);
 		}
 		else
 		{
@@ -613,7 +849,7 @@ void LLViewerObjectList::processObjectUpdate(LLMessageSystem *mesgsys,
 			{
 				objectp->mLocalID = local_id;
 			}
-			processUpdateCore(objectp, user_data, i, update_type, NULL, justCreated);
+			processUpdateCore(objectp, user_data, i, update_type, block.mUpdate, justCreated);
 		}
 		recorder.objectUpdateEvent(local_id, update_type, objectp, msg_size);
 		objectp->setLastUpdateType(update_type);
@@ -41,6 +41,8 @@
 #include "llstring.h"
 
 // project includes
+#include "lldatapacker.h"
+#include "llobjectupdatedata.h"
 #include "llviewerobject.h"
 #include "lleventcoro.h"
 #include "llcoros.h"
@@ -60,6 +62,44 @@ constexpr U32 GL_NAME_PARCEL_WALL = 1;
 
 constexpr U32 GL_NAME_INDEX_OFFSET = 10;
 
+// One ObjectData block of an object update message. The copy phase of
+// processObjectUpdate() takes what it needs out of the message system, the
+// decode phase unpacks that into mUpdate, and the apply phase hands mUpdate
+// to the object.
+struct LLObjectUpdateBlock
+{
+	LLObjectUpdateBlock()
+	:	mValid(true),
+		mLocalID(0),
+		mPCode(0),
+		mMsgSize(0),
+		mMotionSize(0)
+	{
+	}
+
+	bool		mValid;			// false: nothing to apply (cache miss, empty payload)
+	U32			mLocalID;
+	LLUUID		mFullID;
+	LLPCode		mPCode;
+	S32			mMsgSize;
+
+	// ObjectUpdate: the fields that take more than a copy to decode.
+	U8			mMotionData[60 + 16];
+	S32			mMotionSize;
+	std::string	mNameValues;
+	std::vector<U8>	mPSBlock;
+	std::vector<U8>	mExtraParams;
+
+	// ObjectUpdateCompressed and ObjectUpdateCached: a copy of the Data
+	// field or of the cache entry, and a packer over it, left at the end of
+	// what was decoded. Terse updates also copy their TextureEntry field.
+	std::vector<U8>				mData;
+	LLDataPackerBinaryBuffer	mDP;
+	std::vector<U8>				mTextureEntry;
+
+	LLObjectUpdateData			mUpdate;
+};
+
 class LLViewerObjectList
 {
 public:
@@ -90,10 +130,11 @@ public:
 	void cleanDeadObjects(const BOOL use_timer = TRUE);	// Clean up the dead object list.
 
 	// Simulator and viewer side object updates...
-	void processUpdateCore(LLViewerObject* objectp, void** data, U32 block, const EObjectUpdateType update_type, LLDataPacker* dpp, BOOL justCreated);
+	void processUpdateCore(LLViewerObject* objectp, void** data, U32 block, const EObjectUpdateType update_type, const LLObjectUpdateData& update, BOOL justCreated);
 	void processObjectUpdate(LLMessageSystem *mesgsys, void **user_data, EObjectUpdateType update_type, bool cached=false, bool compressed=false);
 	void processCompressedObjectUpdate(LLMessageSystem *mesgsys, void **user_data, EObjectUpdateType update_type);
 	void processCachedObjectUpdate(LLMessageSystem *mesgsys, void **user_data, EObjectUpdateType update_type);
+
 	void updateApparentAngles(LLAgent &agent);
 	void update(LLAgent &agent, LLWorld &world);
 
@@ -245,6 +286,14 @@ public:
 	friend class LLViewerObject;
 
 private:
+	// Decodes mUpdateBlocks[begin, end). Touches nothing else, so it runs
+	// on the worker pool.
+	void decodeUpdateBlocks(EObjectUpdateType update_type, bool compressed, bool cached, U32 begin, U32 end);
+
+	// Scratch space for processObjectUpdate(), reused across messages.
+	std::vector<LLObjectUpdateBlock> mUpdateBlocks;
+	LLObjectUpdateData::RegionInfo mUpdateRegion;
+
     static void reportObjectCostFailure(LLSD &objectList);
     void fetchObjectCostsCoro(std::string url);
 
@@ -423,99 +423,23 @@ void LLViewerPartSourceScript::update(const F32 dt)
 }
 
 // static
-LLPointer<LLViewerPartSourceScript> LLViewerPartSourceScript::unpackPSS(LLViewerObject *source_objp, LLPointer<LLViewerPartSourceScript> pssp, const S32 block_num)
+LLPointer<LLViewerPartSourceScript> LLViewerPartSourceScript::unpackPSS(LLViewerObject *source_objp, LLPointer<LLViewerPartSourceScript> pssp, const LLPartSysData& particle_parameters)
 {
 	if (!pssp)
 	{
-		if (LLPartSysData::isNullPS(block_num))
-		{
-			return NULL;
-		}
-		LLPointer<LLViewerPartSourceScript> new_pssp = new LLViewerPartSourceScript(source_objp);
-		if (!new_pssp->mPartSysData.unpackBlock(block_num))
-		{
-			return NULL;
-		}
-		if (new_pssp->mPartSysData.mTargetUUID.notNull())
-		{
-			LLViewerObject *target_objp = gObjectList.findObject(new_pssp->mPartSysData.mTargetUUID);
-			new_pssp->setTargetObject(target_objp);
-		}
-		return new_pssp;
-	}
-	else
-	{
-		if (LLPartSysData::isNullPS(block_num))
-		{
-			return NULL;
-		}
-
-		if (!pssp->mPartSysData.unpackBlock(block_num))
-		{
-			return NULL;
-		}
-		if (pssp->mPartSysData.mTargetUUID.notNull())
-		{
-			LLViewerObject *target_objp = gObjectList.findObject(pssp->mPartSysData.mTargetUUID);
-			pssp->setTargetObject(target_objp);
-		}
-		return pssp;
+		return createPSS(source_objp, particle_parameters);
 	}
-}
-
 
-LLPointer<LLViewerPartSourceScript> LLViewerPartSourceScript::unpackPSS(LLViewerObject *source_objp, LLPointer<LLViewerPartSourceScript> pssp, LLDataPacker &dp, bool legacy)
-{
-	if (!pssp)
-	{
-		LLPointer<LLViewerPartSourceScript> new_pssp = new LLViewerPartSourceScript(source_objp);
-		if (legacy)
-		{
-			if (!new_pssp->mPartSysData.unpackLegacy(dp))
-			{
-				return NULL;
-			}
-		}
-		else
-		{
-			if (!new_pssp->mPartSysData.unpack(dp))
-			{
-				return NULL;
-			}
-		}
-		
-		if (new_pssp->mPartSysData.mTargetUUID.notNull())
-		{
-			LLViewerObject *target_objp = gObjectList.findObject(new_pssp->mPartSysData.mTargetUUID);
-			new_pssp->setTargetObject(target_objp);
-		}
-		
-		return new_pssp;
-	}
-	else
+	// The count of particles made so far belongs to the source, not the update.
+	S32 num_particles = pssp->mPartSysData.mNumParticles;
+	pssp->mPartSysData = particle_parameters;
+	pssp->mPartSysData.mNumParticles = num_particles;
+	if (pssp->mPartSysData.mTargetUUID.notNull())
 	{
-		if (legacy)
-		{
-			if (!pssp->mPartSysData.unpackLegacy(dp))
-			{
-				return NULL;
-			}
-		}
-		else
-		{
-			if (!pssp->mPartSysData.unpack(dp))
-			{
-				return NULL;
-			}
-		}
-
-		if (pssp->mPartSysData.mTargetUUID.notNull())
-		{
-			LLViewerObject *target_objp = gObjectList.findObject(pssp->mPartSysData.mTargetUUID);
-			pssp->setTargetObject(target_objp);
-		}
-		return pssp;
+		LLViewerObject *target_objp = gObjectList.findObject(pssp->mPartSysData.mTargetUUID);
+		pssp->setTargetObject(target_objp);
 	}
+	return pssp;
 }
 
 
@@ -178,7 +178,8 @@ public:
 	// Misc
 	LLVLComposition *mCompositionp;		// Composition layer for the surface
 
-	LLVOCacheEntry::vocache_entry_map_t		mCacheMap; //all cached entries
+	LLVOCacheEntry::vocache_entry_map_t		mCacheMap; //cached entries decoded or added this visit
+	LLVOCacheFile							mCacheFile; //the rest, still in the region's cache file
 	// time?
 	// LRU info?
 
@@ -727,8 +728,8 @@ void LLViewerRegion::loadObjectCache()
 
 	if(LLVOCache::hasInstance())
 	{
-		LLVOCache::getInstance()->readFromCache(mHandle, mImpl->mCacheID, mImpl->mCacheMap) ;
-		if (mImpl->mCacheMap.empty())
+		LLVOCache::getInstance()->readFromCache(mHandle, mImpl->mCacheID, mImpl->mCacheFile) ;
+		if (mImpl->mCacheFile.empty())
 		{
 			mCacheDirty = TRUE;
 		}
@@ -743,7 +744,7 @@ void LLViewerRegion::saveObjectCache()
 		return;
 	}
 
-	if (mImpl->mCacheMap.empty())
+	if (mImpl->mCacheMap.empty() && mImpl->mCacheFile.empty())
 	{
 		return;
 	}
@@ -753,7 +754,7 @@ void LLViewerRegion::saveObjectCache()
 		const F32 start_time_threshold = 600.0f; //seconds
 		bool removal_enabled = sVOCacheCullingEnabled && (mRegionTimer.getElapsedTimeF32() > start_time_threshold); //allow to remove invalid objects from object cache file.
 		
-		LLVOCache::getInstance()->writeToCache(mHandle, mImpl->mCacheID, mImpl->mCacheMap, mCacheDirty, removal_enabled) ;
+		LLVOCache::getInstance()->writeToCache(mHandle, mImpl->mCacheID, mImpl->mCacheMap, mImpl->mCacheFile, mCacheDirty, removal_enabled) ;
 		mCacheDirty = FALSE;
 	}
 
@@ -762,6 +763,7 @@ void LLViewerRegion::saveObjectCache()
 		delete iter->second;
 	}
 	mImpl->mCacheMap.clear();
+	mImpl->mCacheFile.close();
 }
 
 void LLViewerRegion::sendMessage()
@@ -1664,6 +1666,20 @@ LLViewerRegion::eCacheUpdateResult LLViewerRegion::cacheFullUpdate(LLViewerObjec
 	U32 crc = objectp->getCRC();
 
 	LLVOCacheEntry* entry = get_if_there(mImpl->mCacheMap, local_id, (LLVOCacheEntry*)NULL);
+	U32 file_crc;
+	if (!entry && mImpl->mCacheFile.getCRC(local_id, file_crc))
+	{
+		if (file_crc == crc)
+		{
+			// Unchanged, no need to decode it.
+			return CACHE_UPDATE_DUPE;
+		}
+		entry = mImpl->mCacheFile.take(local_id);
+		if (entry)
+		{
+			mImpl->mCacheMap[local_id] = entry;
+		}
+	}
 
 	if (entry)
 	{
@@ -1675,11 +1691,8 @@ LLViewerRegion::eCacheUpdateResult LLViewerRegion::cacheFullUpdate(LLViewerObjec
 			return CACHE_UPDATE_DUPE;
 		}
 
-		// Update the cache entry
-		mImpl->mCacheMap.erase(local_id);
-		delete entry;
-		entry = new LLVOCacheEntry(local_id, crc, dp);
-		mImpl->mCacheMap[local_id] = entry;
+		// Update the cache entry, keeping its place in the cache file
+		entry->assignCRC(crc, dp);
 		return CACHE_UPDATE_CHANGED;
 	}
 
@@ -1687,10 +1700,21 @@ LLViewerRegion::eCacheUpdateResult LLViewerRegion::cacheFullUpdate(LLViewerObjec
 
 	// Create new entry and add to map
 	eCacheUpdateResult result = CACHE_UPDATE_ADDED;
-	if (mImpl->mCacheMap.size() > MAX_OBJECT_CACHE_ENTRIES)
+	if (mImpl->mCacheMap.size() + mImpl->mCacheFile.getCount() > MAX_OBJECT_CACHE_ENTRIES)
 	{
-		delete mImpl->mCacheMap.begin()->second ;
-		mImpl->mCacheMap.erase(mImpl->mCacheMap.begin());
+		// Drop the lowest local id, decoded or not.
+		U32 file_id = mImpl->mCacheFile.getFirstLocalID();
+		if (mImpl->mCacheMap.empty() || (file_id && file_id < mImpl->mCacheMap.begin()->first))
+		{
+			mImpl->mCacheFile.erase(file_id);
+		}
+		else
+		{
+			LLVOCacheEntry* evicted = mImpl->mCacheMap.begin()->second;
+			mImpl->mCacheFile.eraseRecord(evicted->getFileOffset());
+			delete evicted;
+			mImpl->mCacheMap.erase(mImpl->mCacheMap.begin());
+		}
 		result = CACHE_UPDATE_REPLACED;
 		
 	}
@@ -1702,11 +1726,28 @@ LLViewerRegion::eCacheUpdateResult LLViewerRegion::cacheFullUpdate(LLViewerObjec
 
 // Get data packer for this object, if we have cached data
 // AND the CRC matches. JC
-LLDataPacker *LLViewerRegion::getDP(U32 local_id, U32 crc, U8 &cache_miss_type)
+LLDataPackerBinaryBuffer *LLViewerRegion::getDP(U32 local_id, U32 crc, U8 &cache_miss_type)
 {
 	//llassert(mCacheLoaded);  This assert failes often, changing to early-out -- davep, 2010/10/18
 
 	LLVOCacheEntry* entry = get_if_there(mImpl->mCacheMap, local_id, (LLVOCacheEntry*)NULL);
+	U32 file_crc;
+	if (!entry && mImpl->mCacheFile.getCRC(local_id, file_crc))
+	{
+		if (file_crc != crc)
+		{
+			cache_miss_type = CACHE_MISS_TYPE_CRC;
+			mCacheMissCRC.push_back(local_id);
+			return NULL;
+		}
+
+		// First hit on a record in the cache file; decode it now.
+		entry = mImpl->mCacheFile.take(local_id);
+		if (entry)
+		{
+			mImpl->mCacheMap[local_id] = entry;
+		}
+	}
 
 	if (entry)
 	{
@@ -1845,7 +1886,7 @@ void LLViewerRegion::dumpCache()
 		change_bin[changes]++;
 	}
 
-	LL_INFOS() << "Count " << mImpl->mCacheMap.size() << LL_ENDL;
+	LL_INFOS() << "Count " << mImpl->mCacheMap.size() << " undecoded " << mImpl->mCacheFile.getCount() << LL_ENDL;
 	for (i = 0; i < BINS; i++)
 	{
 		LL_INFOS() << "Hits " << i << " " << hit_bin[i] << LL_ENDL;
@@ -2029,7 +2070,7 @@ void LLViewerRegion::unpackRegionHandshake()
 	{
 		flags |= 0x00000001; //set the bit 0 to be 1 to ask sim to send all cacheable objects.		
 	}
-	if(mImpl->mCacheMap.empty())
+	if(mImpl->mCacheMap.empty() && mImpl->mCacheFile.empty())
 	{
 		flags |= 0x00000002; //set the bit 1 to be 1 to tell sim the cache file is empty, no need to send cache probes.
 	}
@@ -0,0 +1,88 @@
+/**
+ * @file llviewersettingsregistry.h
+ * @brief Typed, direct-indexed access to gSavedSettings by generated ID
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLVIEWERSETTINGSREGISTRY_H
+#define LL_LLVIEWERSETTINGSREGISTRY_H
+
+#include "llviewercontrol.h"
+#include "llviewersettingids.h"	// generated from app_settings/settings.xml by generate_settings_ids.py
+
+// Binds the generated LLSettingID table to gSavedSettings. Call once the
+// default settings files are loaded.
+inline void bind_saved_setting_ids()
+{
+	gSavedSettings.bindIndexedControls(LLSettingID::getNames(), LLSettingID::COUNT);
+}
+
+inline LLControlVariable* get_saved_setting_control(LLSettingID::EID id)
+{
+	LLControlVariable* control = gSavedSettings.getIndexedControl(id);
+	if (!control)
+	{
+		// Before bind_saved_setting_ids(), fall back to the name map.
+		control = gSavedSettings.getControl(LLSettingID::getNames()[id]);
+	}
+	return control;
+}
+
+// Replacement for gSavedSettings.getXXX("Name") on hot paths:
+//   F32 far_clip = getSavedSetting<LLSettingID::RenderFarClip>();
+// The type comes from settings.xml, and a misspelt name is a compile error.
+template<LLSettingID::EID ID>
+typename LLSettingTraits<ID>::value_t getSavedSetting()
+{
+	typedef typename LLSettingTraits<ID>::value_t value_t;
+	LLControlVariable* control = get_saved_setting_control(ID);
+	if (!control)
+	{
+		LL_WARNS() << "Control " << LLSettingID::getNames()[ID] << " not found." << LL_ENDL;
+		return value_t();
+	}
+	return convert_from_llsd<value_t>(control->get(), control->type(), control->getName());
+}
+
+template<LLSettingID::EID ID>
+void setSavedSetting(const typename LLSettingTraits<ID>::value_t& value)
+{
+	LLControlVariable* control = get_saved_setting_control(ID);
+	if (control)
+	{
+		control->set(convert_to_llsd(value));
+	}
+}
+
+// LLCachedControl bound by generated ID instead of a string literal.
+template<LLSettingID::EID ID>
+class LLCachedSetting : public LLCachedControl<typename LLSettingTraits<ID>::value_t>
+{
+public:
+	LLCachedSetting()
+	:	LLCachedControl<typename LLSettingTraits<ID>::value_t>(gSavedSettings, LLSettingID::getNames()[ID])
+	{
+	}
+};
+
+#endif // LL_LLVIEWERSETTINGSREGISTRY_H
@@ -223,11 +223,14 @@ LLViewerStats::LLViewerStats() :
 	mPacketsInStat("packetsinstat"),
 	mPacketsLostStat("packetsloststat"),
 	mPacketsOutStat("packetsoutstat"),
+	mPacketSendCallsStat("packetsendcallsstat"),
 	mPacketsLostPercentStat("packetslostpercentstat", 64),
 	mTexturePacketsStat("texturepacketsstat"),
 	mActualInKBitStat("actualinkbitstat"),
 	mActualOutKBitStat("actualoutkbitstat"),
 	mTrianglesDrawnStat("trianglesdrawnstat"),
+	mSkinnedAvatarsStat("skinnedavatarsstat"),
+	mImpostorAvatarsStat("impostoravatarsstat"),
 	mSimTimeDilation("simtimedilation"),
 	mSimFPS("simfps"),
 	mSimPhysicsFPS("simphysicsfps"),
@@ -307,6 +310,7 @@ void LLViewerStats::resetStats()
 	stats.mPacketsInStat.reset();
 	stats.mPacketsLostStat.reset();
 	stats.mPacketsOutStat.reset();
+	stats.mPacketSendCallsStat.reset();
 	stats.mFPSStat.reset();
 	stats.mTexturePacketsStat.reset();
 	stats.mAgentPositionSnaps.reset();
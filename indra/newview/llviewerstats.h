@@ -54,11 +54,14 @@ public:
 			mPacketsInStat,
 			mPacketsLostStat,
 			mPacketsOutStat,
+			mPacketSendCallsStat,	// System calls sending mPacketsOutStat
 			mPacketsLostPercentStat,
 			mTexturePacketsStat,
 			mActualInKBitStat,	// From the packet ring (when faking a bad connection)
 			mActualOutKBitStat,	// From the packet ring (when faking a bad connection)
 			mTrianglesDrawnStat,
+			mSkinnedAvatarsStat,
+			mImpostorAvatarsStat,
 			mMallocStat;
 
 	// Simulator stats
@@ -36,6 +36,8 @@
 #include "llvfs.h"
 #include "llviewerregion.h"
 #include "llglslshader.h"
+#include "lltexlayercompositor.h"
+#include "llviewertexture.h"
 #include "llvoavatarself.h"
 #include "pipeline.h"
 #include "llviewercontrol.h"
@@ -81,7 +83,12 @@ LLViewerTexLayerSetBuffer::LLViewerTexLayerSetBuffer(LLTexLayerSet* const owner,
 	mNumLowresUploads(0),
 	mUploadFailCount(0),
 	mNeedsUpdate(TRUE),
-	mNumLowresUpdates(0)
+	mNumLowresUpdates(0),
+	mPendingBakeFinal(FALSE),
+	mPendingBakeStale(FALSE),
+	mMorphMasksApplied(FALSE),
+	mVerifyBuildTime(0.f),
+	mGLRenderTime(-1.f)
 {
 	LLViewerTexLayerSetBuffer::sGLByteCount += getSize();
 	mNeedsUploadTimer.start();
@@ -127,6 +134,8 @@ void LLViewerTexLayerSetBuffer::requestUpdate()
 	restartUpdateTimer();
 	mNeedsUpdate = TRUE;
 	mNumLowresUpdates = 0;
+	// A bake still compositing on the worker pool is out of date.
+	mPendingBakeStale = TRUE;
 	// If we're in the middle of uploading a baked texture, we don't care about it any more.
 	// When it's downloaded, ignore it.
 	mUploadID.setNull();
@@ -177,6 +186,11 @@ BOOL LLViewerTexLayerSetBuffer::needsRender()
 	llassert(mTexLayerSet->getAvatarAppearance() == gAgentAvatarp);
 	if (!isAgentAvatarValid()) return FALSE;
 
+	if (mVerifyBake.notNull() && mVerifyBake->isComposited())
+	{
+		verifyCPUBake();
+	}
+
 	const BOOL upload_now = mNeedsUpload && isReadyToUpload();
 	const BOOL update_now = mNeedsUpdate && isReadyToUpdate();
 
@@ -201,7 +215,14 @@ BOOL LLViewerTexLayerSetBuffer::needsRender()
 	}
 
 	// Render if we have at least minimal level of detail for each local texture.
-	return getViewerTexLayerSet()->isLocalTextureDataAvailable();
+	if (!getViewerTexLayerSet()->isLocalTextureDataAvailable())
+	{
+		return FALSE;
+	}
+
+	// Uploads need the GL bake's readback and morph masks; a local update alone
+	// can be composited on the worker pool.
+	return upload_now || !updateOnCPU();
 }
 
 // virtual
@@ -221,9 +242,36 @@ void LLViewerTexLayerSetBuffer::postRenderTexLayerSet(BOOL success)
 	LLViewerDynamicTexture::postRender(success);
 }
 
+// virtual
+BOOL LLViewerTexLayerSetBuffer::render()
+{
+	static LLCachedControl<bool> verify_cpu(gSavedSettings, "AvatarBakeVerifyCPU", false);
+	mGLRenderTime = -1.f;
+	if (verify_cpu)
+	{
+		// Time the GL bake from an idle pipeline to its last draw.
+		glFinish();
+		mRenderTimer.reset();
+	}
+	BOOL success = renderTexLayerSet();
+	if (success)
+	{
+		// renderMorphMasks() ran for every layer that has one.
+		mMorphMasksApplied = TRUE;
+	}
+	return success;
+}
+
 // virtual
 void LLViewerTexLayerSetBuffer::midRenderTexLayerSet(BOOL success)
 {
+	static LLCachedControl<bool> verify_cpu(gSavedSettings, "AvatarBakeVerifyCPU", false);
+	if (verify_cpu && mGLRenderTime < 0.f)
+	{
+		glFinish();
+		mGLRenderTime = mRenderTimer.getElapsedTimeF32();
+	}
+
 	// do we need to upload, and do we have sufficient data to create an uploadable composite?
 	// TODO: When do we upload the texture if gAgent.mNumPendingQueries is non-zero?
 	const BOOL upload_now = mNeedsUpload && isReadyToUpload();
@@ -258,6 +306,8 @@ void LLViewerTexLayerSetBuffer::midRenderTexLayerSet(BOOL success)
 	{
 		doUpdate();
 	}
+	// This render supersedes any local update still compositing.
+	mPendingBake = NULL;
 
 	// *TODO: Old logic does not check success before setGLTextureCreated
 	// we have valid texture data now
@@ -360,6 +410,141 @@ BOOL LLViewerTexLayerSetBuffer::requestUpdateImmediate()
 	return result;
 }
 
+// Local updates, made while editing appearance and before the server has the
+// bake, are composited on the worker pool instead of in GL: the bake is built
+// here, composited by a pool job, and copied into the texture by whichever
+// later frame finds it done.  Layer sets with morph masks still render in GL,
+// since only the GL bake applies them to the mesh, as do bakes missing an image.
+// Returns FALSE when this update should be rendered in GL.
+BOOL LLViewerTexLayerSetBuffer::updateOnCPU()
+{
+	static LLCachedControl<bool> local_cpu(gSavedSettings, "AvatarBakeLocalCPU", true);
+	LLViewerTexLayerSet* layer_set = getViewerTexLayerSet();
+
+	if (mPendingBake.notNull())
+	{
+		if (!mPendingBake->isComposited())
+		{
+			return TRUE;
+		}
+		LLPointer<LLTexLayerBake> bake = mPendingBake;
+		mPendingBake = NULL;
+		// Still newer than what we show.  But if the appearance changed or the
+		// last local textures arrived meanwhile, bake again rather than have
+		// doUpdate() settle on it.
+		if (applyCPUBake(bake)
+			&& !mPendingBakeStale
+			&& mPendingBakeFinal == layer_set->isLocalTextureDataFinal()
+			&& !layer_set->hasActiveMorph())
+		{
+			doUpdate();
+			return TRUE;
+		}
+	}
+
+	// Only GL bakes read back the morph masks, so bakes that shape the mesh
+	// stay there.  Layer sets whose masked morphs are all idle, as they are
+	// with nothing loose worn, composite here like any other.
+	if (!local_cpu || layer_set->hasActiveMorph())
+	{
+		return FALSE;
+	}
+
+	LLPointer<LLTexLayerBake> bake = layer_set->createBake(mFullWidth, mFullHeight);
+	if (bake->isPartial())
+	{
+		return FALSE;
+	}
+	mPendingBake = bake;
+	mPendingBakeFinal = layer_set->isLocalTextureDataFinal();
+	mPendingBakeStale = FALSE;
+	LLTexLayerCompositor::compositeAsync(bake);
+	return TRUE;
+}
+
+// Copies a composited bake into our texture, as postRender() does the frame buffer.
+BOOL LLViewerTexLayerSetBuffer::applyCPUBake(const LLTexLayerBake* bake)
+{
+	const LLImageRaw* result = bake->getResult();
+	if (!result)
+	{
+		return FALSE;
+	}
+	if (mGLTexturep.isNull() || !mGLTexturep->getHasGLTexture() || mGLTexturep->getDiscardLevel() != 0)
+	{
+		LLViewerDynamicTexture::generateGLTexture();
+	}
+	if (!mGLTexturep->setSubImage(result, 0, 0, mFullWidth, mFullHeight))
+	{
+		return FALSE;
+	}
+	mGLTexturep->setGLTextureCreated(true);
+	mMorphMasksApplied = FALSE;
+	return TRUE;
+}
+
+// A masked morph took on weight since the last bake, which was composited
+// here and so left its mask alone.
+BOOL LLViewerTexLayerSetBuffer::needsMorphMasks() const
+{
+	return !mMorphMasksApplied && !mNeedsUpdate && getViewerTexLayerSet()->hasActiveMorph();
+}
+
+// Queues a CPU composite of the layer set just rendered, to be compared with
+// the GL readback in gl_data by verifyCPUBake() once the worker pool is done.
+void LLViewerTexLayerSetBuffer::startCPUBakeCheck(U8* gl_data)
+{
+	LLTimer timer;
+	mVerifyBake = getViewerTexLayerSet()->createBake(mFullWidth, mFullHeight);
+	mVerifyBuildTime = timer.getElapsedTimeF32();
+	mVerifyGLImage = new LLImageRaw(gl_data, mFullWidth, mFullHeight, 4);
+	LLTexLayerCompositor::compositeAsync(mVerifyBake);
+}
+
+void LLViewerTexLayerSetBuffer::verifyCPUBake()
+{
+	LLPointer<LLTexLayerBake> bake = mVerifyBake;
+	LLPointer<LLImageRaw> gl_image = mVerifyGLImage;
+	mVerifyBake = NULL;
+	mVerifyGLImage = NULL;
+
+	const LLImageRaw* result = bake->getResult();
+	if (!result
+		|| result->getWidth() != gl_image->getWidth()
+		|| result->getHeight() != gl_image->getHeight())
+	{
+		return;
+	}
+
+	// A GL bake rounds after every draw and filters a little differently, so
+	// only differences beyond a few steps count.
+	const S32 TOLERANCE = 8;
+	const U8* cpu_data = result->getData();
+	const U8* gl_data = gl_image->getData();
+	const S32 size = result->getWidth() * result->getHeight() * 4;
+	S32 max_diff = 0;
+	S32 mismatched = 0;
+	F64 total_diff = 0.0;
+	for (S32 i = 0; i < size; ++i)
+	{
+		S32 diff = llabs((S32)cpu_data[i] - (S32)gl_data[i]);
+		max_diff = llmax(max_diff, diff);
+		total_diff += diff;
+		if (diff > TOLERANCE)
+		{
+			++mismatched;
+		}
+	}
+
+	LL_INFOS("Avatar") << "CPU bake of " << getViewerTexLayerSet()->getBodyRegionName()
+					   << (bake->isPartial() ? " (partial)" : "")
+					   << ": " << bake->getNumDraws() << " draws, GL " << mGLRenderTime * 1000.f
+					   << " ms, CPU " << (mVerifyBuildTime + bake->getCompositeTime()) * 1000.f
+					   << " ms (" << mVerifyBuildTime * 1000.f << " building on the main thread); mean difference "
+					   << total_diff / size << ", max " << max_diff << ", "
+					   << mismatched << " channels off by more than " << TOLERANCE << LL_ENDL;
+}
+
 // Baked texture upload completed
 void sendTexLayerComplete(const LLSD& content, LLBakedUploadData* mBakedUploadData)
 {
@@ -395,6 +580,11 @@ void LLViewerTexLayerSetBuffer::doUpload()
 	glReadPixels(mOrigin.mX, mOrigin.mY, mFullWidth, mFullHeight, GL_RGBA, GL_UNSIGNED_BYTE, baked_color_data );
 	stop_glerror();
 
+	if (mGLRenderTime >= 0.f)
+	{
+		startCPUBakeCheck(baked_color_data);
+	}
+
 	// Get the MASK information from our texture
 	LLGLSUIDefault gls_ui;
 	LLPointer<LLImageRaw> baked_mask_image = new LLImageRaw(mFullWidth, mFullHeight, 1 );
@@ -716,6 +906,23 @@ void LLViewerTexLayerSet::createComposite()
 	}
 }
 
+// virtual
+LLImageRaw* LLViewerTexLayerSet::getBakeSourceImage(LLGLTexture* tex)
+{
+	LLViewerFetchedTexture* image = LLViewerTextureManager::staticCastToFetchedTexture(tex);
+	if (!image)
+	{
+		return NULL;
+	}
+	if (image->hasSavedRawImage())
+	{
+		return image->getSavedRawImage();
+	}
+	// Keep the pixels from now on, for the next bake.
+	image->forceToSaveRawImage(0);
+	return NULL;
+}
+
 void LLViewerTexLayerSet::setUpdatesEnabled( BOOL b )
 {
 	mUpdatesEnabled = b; 
@@ -30,6 +30,7 @@
 #include "lldynamictexture.h"
 #include "llextendedstatus.h"
 #include "lltexlayer.h"
+#include "lltexlayercompositor.h"
 
 class LLVOAvatarSelf;
 class LLViewerTexLayerSetBuffer;
@@ -53,6 +54,7 @@ public:
 	BOOL						isLocalTextureDataFinal() const;
 	void						updateComposite();
 	/*virtual*/void				createComposite();
+	/*virtual*/LLImageRaw*		getBakeSourceImage(LLGLTexture* tex);
 	void						setUpdatesEnabled(BOOL b);
 	BOOL						getUpdatesEnabled()	const 	{ return mUpdatesEnabled; }
 
@@ -123,7 +125,27 @@ protected:
 	// Pass these along for tex layer rendering.
 	virtual void			preRender(BOOL clear_depth) { preRenderTexLayerSet(); }
 	virtual void			postRender(BOOL success) { postRenderTexLayerSet(success); }
-	virtual BOOL			render() { return renderTexLayerSet(); }
+	virtual BOOL			render();
+
+	//--------------------------------------------------------------------
+	// Software bakes (AvatarBakeLocalCPU, AvatarBakeVerifyCPU)
+	//--------------------------------------------------------------------
+public:
+	BOOL					needsMorphMasks() const;		// Bake again in GL, for a morph mask that came into use
+private:
+	BOOL					updateOnCPU();					// Local update on the worker pool, FALSE to render it in GL
+	BOOL					applyCPUBake(const LLTexLayerBake* bake);
+	void					startCPUBakeCheck(U8* gl_data);
+	void					verifyCPUBake();
+	LLPointer<LLTexLayerBake> mPendingBake;					// Local update being composited on the worker pool
+	BOOL					mPendingBakeFinal;				// Whether mPendingBake was built from final local textures
+	BOOL					mPendingBakeStale;				// An update was requested after mPendingBake was built
+	BOOL					mMorphMasksApplied;				// What we show came from a GL bake, which applied the morph masks
+	LLPointer<LLTexLayerBake> mVerifyBake;					// CPU counterpart of the last uploaded GL bake
+	LLPointer<LLImageRaw>	mVerifyGLImage;					// GL readback mVerifyBake is compared with
+	F32						mVerifyBuildTime;				// Seconds createBake() took for mVerifyBake
+	LLTimer					mRenderTimer;
+	F32						mGLRenderTime;					// Seconds from render() to readback, < 0 when not timed
 	
 	//--------------------------------------------------------------------
 	// Uploads
@@ -48,6 +48,7 @@
 // viewer includes
 #include "llimagegl.h"
 #include "lldrawpool.h"
+#include "lltexturebudget.h"
 #include "lltexturefetch.h"
 #include "llviewertexturelist.h"
 #include "llviewercontrol.h"
@@ -521,6 +522,8 @@ void LLViewerTexture::updateClass(const F32 velocity, const F32 angular_velocity
 	sMaxTotalTextureMem = S32Megabytes(gTextureList.getMaxTotalTextureMem());
 	sMaxDesiredTextureMem = sMaxTotalTextureMem; //in Bytes, by default and when total used texture memory is small.
 
+	// With LLTextureBudget enabled the bias shrinks its budget rather than
+	// moving every texture.
 	if (sBoundTextureMemory >= sMaxBoundTextureMemory ||
 		sTotalTextureMemory >= sMaxTotalTextureMem)
 	{
@@ -553,6 +556,7 @@ void LLViewerTexture::updateClass(const F32 velocity, const F32 angular_velocity
 		}
 	}
 	sDesiredDiscardBias = llclamp(sDesiredDiscardBias, desired_discard_bias_min, desired_discard_bias_max);
+	LLTextureBudget::instance().setDiscardBias(sDesiredDiscardBias);
 	
 	F32 camera_moving_speed = LLViewerCamera::getInstance()->getAverageSpeed();
 	F32 camera_angular_speed = LLViewerCamera::getInstance()->getAverageAngularSpeed();
@@ -1021,6 +1025,7 @@ void LLViewerFetchedTexture::init(bool firstinit)
 	mCanUseHTTP = true ;
 	mDesiredDiscardLevel = MAX_DISCARD_LEVEL + 1;
 	mMinDesiredDiscardLevel = MAX_DISCARD_LEVEL + 1;
+	mBudgetDiscardLevel = -1;
 	
 	mDecodingAux = FALSE;
 
@@ -1373,6 +1378,12 @@ void LLViewerFetchedTexture::addToCreateTexture()
 #endif
 		mNeedsCreateTexture = TRUE;
 		gTextureList.mCreateTextureList.insert(this);
+
+		// Local files are resized in createTexture(), after staging.
+		if (mGLTexturep.notNull() && mUrl.compare(0, 7, "file://") != 0)
+		{
+			mUpload = LLTextureUpload::stage(mRawImage, mGLTexturep->getUseMipMaps());
+		}
 	}	
 	return ;
 }
@@ -1450,7 +1461,8 @@ BOOL LLViewerFetchedTexture::createTexture(S32 usename/*= 0*/)
 		return FALSE;
 	}
 		
-	res = mGLTexturep->createGLTexture(mRawDiscardLevel, mRawImage, usename, TRUE, mBoostLevel);
+	res = mGLTexturep->createGLTexture(mRawDiscardLevel, mRawImage, usename, TRUE, mBoostLevel, mUpload);
+	mUpload = NULL;
 
 	notifyAboutCreatingTexture();
 
@@ -2709,6 +2721,8 @@ bool LLViewerFetchedTexture::needsToSaveRawImage()
 
 void LLViewerFetchedTexture::destroyRawImage()
 {	
+	mUpload = NULL;
+
 	if (mAuxRawImage.notNull() && !needsToSaveRawImage())
 	{
 		sAuxCount--;
@@ -2735,6 +2749,34 @@ void LLViewerFetchedTexture::destroyRawImage()
 	}
 }
 
+static LLTrace::BlockTimerStatHandle FTM_DOWNSCALE_TEXTURE("Downscale Texture");
+bool LLViewerFetchedTexture::downscaleTo(S32 discard_level)
+{
+	S32 current_discard = getDiscardLevel();
+	if (!hasGLTexture() || current_discard < 0 || discard_level <= current_discard
+		|| discard_level > getMaxDiscardLevel() || mForSculpt || mFTType == FTT_SERVER_BAKE
+		|| mIsFetching || mNeedsCreateTexture || mRawImage.notNull() || needsToSaveRawImage())
+	{
+		return false;
+	}
+	LL_RECORD_BLOCK_TIME(FTM_DOWNSCALE_TEXTURE);
+
+	// The level is already in the texture's mip chain.
+	if (mGLTexturep->downscale(discard_level))
+	{
+		return true;
+	}
+
+	// Formats the GL can't blit; never worth a fetch, so only the cached raw
+	// image will do and otherwise the normal discard path takes it.
+	if (mCachedRawImage.notNull() && mCachedRawDiscardLevel > current_discard && mCachedRawDiscardLevel <= discard_level)
+	{
+		switchToCachedImage();
+		return true;
+	}
+	return false;
+}
+
 //use the mCachedRawImage to (re)generate the gl texture.
 //virtual
 void LLViewerFetchedTexture::switchToCachedImage()
@@ -3036,6 +3078,8 @@ void LLViewerLODTexture::processTextureStats()
 	{
 		//static const F64 log_2 = log(2.0);
 		static const F64 log_4 = log(4.0);
+		// LLTextureBudget takes the bias as a smaller budget instead.
+		const F32 discard_bias = LLTextureBudget::instance().isEnabled() ? 0.f : sDesiredDiscardBias;
 
 		F32 discard_level = 0.f;
 
@@ -3075,7 +3119,7 @@ void LLViewerLODTexture::processTextureStats()
 		}
 		if (mBoostLevel < LLGLTexture::BOOST_SCULPTED)
 		{
-			discard_level += sDesiredDiscardBias;
+			discard_level += discard_bias;
 			discard_level *= sDesiredDiscardScale; // scale
 			discard_level += sCameraMovingDiscardBias ;
 		}
@@ -3089,6 +3133,8 @@ void LLViewerLODTexture::processTextureStats()
 		
 		// Can't go higher than the max discard level
 		mDesiredDiscardLevel = llmin(getMaxDiscardLevel() + 1, (S32)discard_level);
+		// Stay within the memory LLTextureBudget gave this texture
+		mDesiredDiscardLevel = llmax(mDesiredDiscardLevel, mBudgetDiscardLevel);
 		// Clamp to min desired discard
 		mDesiredDiscardLevel = llmin(mMinDesiredDiscardLevel, mDesiredDiscardLevel);
 
@@ -3099,9 +3145,9 @@ void LLViewerLODTexture::processTextureStats()
 		//
 
 		S32 current_discard = getDiscardLevel();
-		if (sDesiredDiscardBias > 0.0f && mBoostLevel < LLGLTexture::BOOST_SCULPTED && current_discard >= 0)
+		if (discard_bias > 0.0f && mBoostLevel < LLGLTexture::BOOST_SCULPTED && current_discard >= 0)
 		{
-			if(desired_discard_bias_max <= sDesiredDiscardBias && !mForceToSaveRawImage)
+			if(desired_discard_bias_max <= discard_bias && !mForceToSaveRawImage)
 			{
 				//needs to release texture memory urgently
 				scaleDown() ;
@@ -33,6 +33,7 @@
 #include "llhost.h"
 #include "llgltypes.h"
 #include "llrender.h"
+#include "lltextureupload.h"
 #include "llmetricperformancetester.h"
 #include "httpcommon.h"
 
@@ -263,6 +264,7 @@ class LLViewerFetchedTexture : public LLViewerTexture
 {
 	friend class LLTextureBar; // debug info only
 	friend class LLTextureView; // debug info only
+	friend class LLTextureBudget;
 
 protected:
 	/*virtual*/ ~LLViewerFetchedTexture();
@@ -314,6 +316,8 @@ public:
 
 	 // ONLY call from LLViewerTextureList
 	BOOL createTexture(S32 usename = 0);
+	// False while a worker is still staging the raw image for createTexture().
+	bool isUploadReady() const { return mUpload.isNull() || mUpload->isReady(); }
 	void destroyTexture() ;	
 	
 	virtual void processTextureStats() ;
@@ -368,6 +372,10 @@ public:
 
 	LLImageRaw* reloadRawImage(S8 discard_level) ;
 	void destroyRawImage();
+	// Replaces the GL texture with a coarser discard level copied from its
+	// own mips on the GPU, or from the cached raw image, without fetching.
+	// False if it can't be downscaled now.
+	bool downscaleTo(S32 discard_level);
 	bool needsToSaveRawImage();
 
 	const std::string& getUrl() const {return mUrl;}
@@ -459,6 +467,7 @@ protected:
 	S32	mMinDiscardLevel;
 	S8  mDesiredDiscardLevel;			// The discard level we'd LIKE to have - if we have it and there's space	
 	S8  mMinDesiredDiscardLevel;	// The minimum discard level we'd like to have
+	S8  mBudgetDiscardLevel;		// Finest level LLTextureBudget allows, -1 for no limit
 
 	S8  mNeedsAux;					// We need to decode the auxiliary channels
 	S8  mHasAux;                    // We have aux channels
@@ -480,6 +489,7 @@ protected:
 
 	LLPointer<LLImageRaw> mRawImage;
 	S32 mRawDiscardLevel;
+	LLPointer<LLTextureUpload> mUpload;	// mRawImage staged for createTexture()
 
 	// Used ONLY for cloth meshes right now.  Make SURE you know what you're 
 	// doing if you use it for anything else! - djs
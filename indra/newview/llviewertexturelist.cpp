@@ -55,8 +55,10 @@
 #include "message.h"
 
 #include "llflexibleobject.h"
+#include "lltexturebudget.h"
 #include "lltexturecache.h"
 #include "lltexturefetch.h"
+#include "lltextureupload.h"
 #include "llviewercontrol.h"
 #include "llviewertexture.h"
 #include "llviewermedia.h"
@@ -763,6 +765,8 @@ void LLViewerTextureList::updateImages(F32 max_time)
 		max_time -= updateImagesLoadingFastCache(max_time);
 	}
 
+	LLTextureBudget::instance().update();
+
 	{
 		LL_RECORD_BLOCK_TIME(FTM_IMAGE_UPDATE_PRIORITIES);
 		updateImagesDecodePriorities();
@@ -777,6 +781,12 @@ void LLViewerTextureList::updateImages(F32 max_time)
 	
 	{
 		LL_RECORD_BLOCK_TIME(FTM_IMAGE_CREATE);
+		static LLCachedControl<bool> upload_staged(gSavedSettings, "TextureUploadStaged", true);
+		static LLCachedControl<U32> upload_budget(gSavedSettings, "TextureUploadBudgetKB", 4096);
+		LLTextureUpload::sEnabled = upload_staged;
+		LLTextureUpload::sFrameBudget = upload_budget * 1024;
+		LLTextureUpload::newFrame();
+
 		max_time = llmax(max_time, total_max_time*.50f); // at least 50% of max_time
 		max_time -= updateImagesCreateTextures(max_time);
 	}
@@ -914,33 +924,38 @@ void LLViewerTextureList::updateImagesDecodePriorities()
 					imagep->setInactive() ;										
 				}
 			}
-			
-			if (!imagep->isInImageList())
-			{
-				continue;
-			}
-			if(imagep->isInFastCacheList())
-			{
-				continue; //wait for loading from the fast cache.
-			}
 
-			imagep->processTextureStats();
-			F32 old_priority = imagep->getDecodePriority();
-			F32 old_priority_test = llmax(old_priority, 0.0f);
-			F32 decode_priority = imagep->calcDecodePriority();
-			F32 decode_priority_test = llmax(decode_priority, 0.0f);
-			// Ignore < 20% difference
-			if ((decode_priority_test < old_priority_test * .8f) ||
-				(decode_priority_test > old_priority_test * 1.25f))
-			{
-				removeImageFromList(imagep);
-				imagep->setDecodePriority(decode_priority);
-				addImageToList(imagep);
-			}
+			updateImageDecodePriority(imagep);
 		}
 	}
 }
 
+void LLViewerTextureList::updateImageDecodePriority(LLViewerFetchedTexture* imagep)
+{
+	if (!imagep->isInImageList())
+	{
+		return;
+	}
+	if(imagep->isInFastCacheList())
+	{
+		return; //wait for loading from the fast cache.
+	}
+
+	imagep->processTextureStats();
+	F32 old_priority = imagep->getDecodePriority();
+	F32 old_priority_test = llmax(old_priority, 0.0f);
+	F32 decode_priority = imagep->calcDecodePriority();
+	F32 decode_priority_test = llmax(decode_priority, 0.0f);
+	// Ignore < 20% difference
+	if ((decode_priority_test < old_priority_test * .8f) ||
+		(decode_priority_test > old_priority_test * 1.25f))
+	{
+		removeImageFromList(imagep);
+		imagep->setDecodePriority(decode_priority);
+		addImageToList(imagep);
+	}
+}
+
 void LLViewerTextureList::setDebugFetching(LLViewerFetchedTexture* tex, S32 debug_level)
 {
 	if(!tex->setDebugFetching(debug_level))
@@ -998,21 +1013,26 @@ F32 LLViewerTextureList::updateImagesCreateTextures(F32 max_time)
 	// decoded, but haven't been pushed into GL).
 	//
 	
+	// Uploads are also capped in bytes, so that a burst of large textures
+	// is spread over several frames instead of stalling one.
 	LLTimer create_timer;
-	image_list_t::iterator enditer = mCreateTextureList.begin();
 	for (image_list_t::iterator iter = mCreateTextureList.begin();
 		 iter != mCreateTextureList.end();)
 	{
-		image_list_t::iterator curiter = iter++;
-		enditer = iter;
-		LLViewerFetchedTexture *imagep = *curiter;
+		LLPointer<LLViewerFetchedTexture> imagep = *iter;
+		if (!imagep->isUploadReady())
+		{
+			// Its mips are still being built; take the next one.
+			++iter;
+			continue;
+		}
+		mCreateTextureList.erase(iter++);
 		imagep->createTexture();
-		if (create_timer.getElapsedTimeF32() > max_time)
+		if (create_timer.getElapsedTimeF32() > max_time || !LLTextureUpload::hasFrameBudget())
 		{
 			break;
 		}
 	}
-	mCreateTextureList.erase(mCreateTextureList.begin(), enditer);
 	return create_timer.getElapsedTimeF32();
 }
 
@@ -63,6 +63,7 @@ typedef	void (*LLImageCallback)(BOOL success,
 class LLViewerTextureList
 {
 	friend class LLTextureView;
+	friend class LLTextureBudget;
 	friend class LLViewerTextureManager;
 	friend class LLLocalBitmap;
 	
@@ -92,6 +93,8 @@ public:
 	// Using image stats, determine what images are necessary, and perform image updates.
 	void updateImages(F32 max_time);
 	void forceImmediateUpdate(LLViewerFetchedTexture* imagep) ;
+	// Recompute one image's decode priority now rather than on its turn.
+	void updateImageDecodePriority(LLViewerFetchedTexture* imagep);
 
 	// Decode and create textures for all images currently in list.
 	void decodeAllImages(F32 max_decode_time); 
@@ -41,6 +41,7 @@
 
 #include "llagent.h"
 #include "llagentcamera.h"
+#include "llavatarimpostorcache.h"
 #include "llmeshrepository.h"
 #include "llpanellogin.h"
 #include "llviewerkeyboard.h"
@@ -164,6 +165,7 @@
 #include "llviewerobjectlist.h"
 #include "llviewerparcelmgr.h"
 #include "llviewerregion.h"
+#include "llviewersettingsregistry.h"
 #include "llviewershadermgr.h"
 #include "llviewerstats.h"
 #include "llvoavatarself.h"
@@ -611,10 +613,19 @@ public:
 			}
 
 
-			addText(xpos,ypos, llformat("%d Avatars visible", LLVOAvatar::sNumVisibleAvatars));
+			addText(xpos,ypos, llformat("%d Avatars visible (%d skinned, %d impostors)", LLVOAvatar::sNumVisibleAvatars,
+				LLVOAvatar::sNumSkinnedAvatars, LLVOAvatar::sNumImpostorAvatars));
 			
 			ypos += y_inc;
 
+			if (LLAvatarImpostorCache::instanceExists())
+			{
+				LLAvatarImpostorCache& impostors = LLAvatarImpostorCache::instance();
+				addText(xpos,ypos, llformat("%d Impostors cached, %.0f%% of atlas, %d updated, %d evicted", impostors.getSlotCount(),
+					impostors.getAtlasUsage() * 100.f, impostors.getUpdateCount(), impostors.getEvictionCount()));
+				ypos += y_inc;
+			}
+
 			addText(xpos,ypos, llformat("%d Lights visible", LLPipeline::sVisibleLightCount));
 			
 			ypos += y_inc;
@@ -2758,7 +2769,7 @@ BOOL LLViewerWindow::handleKey(KEY key, MASK mask)
 		(MASK_CONTROL & mask) &&
 		('D' == key || 'd' == key))
 	{
-		if (gSavedSettings.getBOOL("LiruUseAdvancedMenuShortcut"))
+		if (getSavedSetting<LLSettingID::LiruUseAdvancedMenuShortcut>())
 			toggle_debug_menus(NULL);
 	}
 
@@ -2838,7 +2849,7 @@ BOOL LLViewerWindow::handleKey(KEY key, MASK mask)
 			// If text field is empty, there's no point in trying to move
 			// cursor with arrow keys, so allow movement
 			if (gChatBar->getCurrentChat().empty()
-				|| gSavedSettings.getBOOL("ArrowKeysMoveAvatar"))
+				|| getSavedSetting<LLSettingID::ArrowKeysMoveAvatar>())
 			{
 				/* Singu Note: We do this differently from LL to preserve the Ctrl-<Any ArrowKey> behavior in the chatbar, and we don't need alt because we're not CHUI
 				// let Control-Up and Control-Down through for chat line history,
@@ -2896,7 +2907,7 @@ BOOL LLViewerWindow::handleKey(KEY key, MASK mask)
 	// If "Pressing letter keys starts local chat" option is selected, we are not in mouselook,
 	// no view has keyboard focus, this is a printable character key (and no modifier key is
 	// pressed except shift), then give focus to nearby chat (STORM-560)
-	if (gSavedSettings.getBOOL("LetterKeysFocusChatBar") && !gAgentCamera.cameraMouselook() &&
+	if (getSavedSetting<LLSettingID::LetterKeysFocusChatBar>() && !gAgentCamera.cameraMouselook() &&
 		!keyboard_focus && key < 0x80 && (mask == MASK_NONE || mask == MASK_SHIFT))
 	{
 		{
@@ -3805,7 +3816,7 @@ void LLViewerWindow::renderSelections( BOOL for_gl_pick, BOOL pick_parcel_walls,
 					BOOL moveable_object_selected = FALSE;
 					BOOL all_selected_objects_move = TRUE;
 					BOOL all_selected_objects_modify = TRUE;
-					BOOL selecting_linked_set = !gSavedSettings.getBOOL("EditLinkedParts");
+					BOOL selecting_linked_set = !getSavedSetting<LLSettingID::EditLinkedParts>();
 
 					for (LLObjectSelection::iterator iter = LLSelectMgr::getInstance()->getSelection()->begin();
 						 iter != LLSelectMgr::getInstance()->getSelection()->end(); iter++)
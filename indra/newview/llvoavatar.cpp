@@ -45,6 +45,7 @@
 #include "llagentcamera.h"
 #include "llagentwearables.h"
 #include "llanimationstates.h"
+#include "llavatarimpostorcache.h"
 #include "llavatarnamecache.h"
 #include "llavatarpropertiesprocessor.h"
 #include "llphysicsmotion.h"
@@ -91,6 +92,7 @@
 #include "llviewerregion.h"
 #include "llviewershadermgr.h"
 #include "llviewerstats.h"
+#include "llviewersettingsregistry.h"
 #include "llviewerwearable.h"
 #include "llvoavatarself.h"
 #include "llvovolume.h"
@@ -1012,6 +1014,8 @@ S32 LLVOAvatar::sFreezeCounter = 0;
 U32 LLVOAvatar::sMaxVisible = 50;
 F32 LLVOAvatar::sRenderDistance = 256.f;
 S32	LLVOAvatar::sNumVisibleAvatars = 0;
+S32	LLVOAvatar::sNumSkinnedAvatars = 0;
+S32	LLVOAvatar::sNumImpostorAvatars = 0;
 S32	LLVOAvatar::sNumLODChangesThisFrame = 0;
 
 const LLUUID LLVOAvatar::sStepSoundOnLand("e8af4a28-aa83-4310-a7c4-c047e15ea0df");
@@ -1141,6 +1145,7 @@ LLVOAvatar::LLVOAvatar(const LLUUID& id,
 	setAnimationData("Speed", &mSpeed);
 
 	mNeedsImpostorUpdate = TRUE;
+	mImpostorSlot = -1;
 	mNeedsAnimUpdate = TRUE;
 
 	mImpostorDistance = 0;
@@ -1241,6 +1246,11 @@ LLVOAvatar::~LLVOAvatar()
 
 	SHClientTagMgr::instance().clearAvatarTag(this);
 
+	if (LLAvatarImpostorCache::instanceExists())
+	{
+		LLAvatarImpostorCache::instance().removeAvatar(this);
+	}
+
 	LL_DEBUGS() << "LLVOAvatar Destructor end" << LL_ENDL;
 }
 
@@ -1511,11 +1521,9 @@ void LLVOAvatar::destroyGL()
 //static
 void LLVOAvatar::resetImpostors()
 {
-	for (std::vector<LLCharacter*>::iterator iter = LLCharacter::sInstances.begin();
-		 iter != LLCharacter::sInstances.end(); ++iter)
+	if (LLAvatarImpostorCache::instanceExists())
 	{
-		LLVOAvatar* avatar = (LLVOAvatar*) *iter;
-		avatar->mImpostor.release();
+		LLAvatarImpostorCache::instance().reset();
 	}
 }
 
@@ -2382,12 +2390,12 @@ void LLVOAvatar::updateMeshData()
 U32 LLVOAvatar::processUpdateMessage(LLMessageSystem *mesgsys,
 									 void **user_data,
 									 U32 block_num, const EObjectUpdateType update_type,
-									 LLDataPacker *dp)
+									 const LLObjectUpdateData& update)
 {
 	const BOOL has_name = !getNVPair("FirstName");
 
 	// Do base class updates...
-	U32 retval = LLViewerObject::processUpdateMessage(mesgsys, user_data, block_num, update_type, dp);
+	U32 retval = LLViewerObject::processUpdateMessage(mesgsys, user_data, block_num, update_type, update);
 
 	// Print out arrival information once we have name of avatar.
 	if (has_name && getNVPair("FirstName"))
@@ -2617,7 +2625,7 @@ void LLVOAvatar::idleUpdateVoiceVisualizer(bool voice_enabled)
 	// Don't render the user's own voice visualizer when in mouselook, or when opening the mic is disabled.
 	if(isSelf())
 	{
-		if(gAgentCamera.cameraMouselook() || gSavedSettings.getBOOL("VoiceDisableMic"))
+		if(gAgentCamera.cameraMouselook() || getSavedSetting<LLSettingID::VoiceDisableMic>())
 		{
 			render_visualizer = false;
 		}
@@ -3855,7 +3863,7 @@ void LLVOAvatar::resetFreezeTime()
 void LLVOAvatar::updateDebugText()
 {
 
-	if (gSavedSettings.getBOOL("DebugAvatarAppearanceMessage"))
+	if (getSavedSetting<LLSettingID::DebugAvatarAppearanceMessage>())
 	{
 		S32 central_bake_version = -1;
 		LLViewerRegion* region = getRegion();
@@ -3903,7 +3911,7 @@ void LLVOAvatar::updateDebugText()
 		}
 		addDebugText(debug_line);
 	}
-	if (gSavedSettings.getBOOL("DebugAvatarCompositeBaked"))
+	if (getSavedSetting<LLSettingID::DebugAvatarCompositeBaked>())
 	{
 		if (!mBakedTextureDebugText.empty())
 			addDebugText(mBakedTextureDebugText);
@@ -5033,11 +5041,19 @@ U32 LLVOAvatar::renderRigid()
 
 U32 LLVOAvatar::renderImpostor(LLColor4U color, S32 diffuse_channel)
 {
-	if (!mImpostor.isComplete())
+	LLRenderTarget& atlas = LLAvatarImpostorCache::instance().getTarget();
+	const LLAvatarImpostorCache::Slot* slot = LLAvatarImpostorCache::instance().getSlot(this);
+	if (!slot || !atlas.isComplete())
 	{
 		return 0;
 	}
 
+	F32 scale = 1.f / (F32)atlas.getWidth();
+	F32 u0 = (F32)slot->mX * scale;
+	F32 v0 = (F32)slot->mY * scale;
+	F32 u1 = (F32)(slot->mX + slot->mWidth) * scale;
+	F32 v1 = (F32)(slot->mY + slot->mHeight) * scale;
+
 	LLVector3 pos(getRenderPosition()+mImpostorOffset);
 	LLVector3 at = (pos - LLViewerCamera::getInstance()->getOrigin());
 	at.normalize();
@@ -5051,15 +5067,15 @@ U32 LLVOAvatar::renderImpostor(LLColor4U color, S32 diffuse_channel)
 	gGL.setAlphaRejectSettings(LLRender::CF_GREATER, 0.f);
 
 	gGL.color4ubv(color.mV);
-	gGL.getTexUnit(diffuse_channel)->bind(&mImpostor);
+	gGL.getTexUnit(diffuse_channel)->bind(&atlas);
 	gGL.begin(LLRender::QUADS);
-	gGL.texCoord2f(0,0);
+	gGL.texCoord2f(u0,v0);
 	gGL.vertex3fv((pos+left-up).mV);
-	gGL.texCoord2f(1,0);
+	gGL.texCoord2f(u1,v0);
 	gGL.vertex3fv((pos-left-up).mV);
-	gGL.texCoord2f(1,1);
+	gGL.texCoord2f(u1,v1);
 	gGL.vertex3fv((pos-left+up).mV);
-	gGL.texCoord2f(0,1);
+	gGL.texCoord2f(u0,v1);
 	gGL.vertex3fv((pos+left+up).mV);
 	gGL.end();
 	gGL.flush();
@@ -5617,7 +5633,7 @@ void LLVOAvatar::processAnimationStateChanges()
 	}
 	
 	// clear all current animations
-	const bool AOEnabled(gSavedSettings.getBOOL("AOEnabled")); // <singu/>
+	const bool AOEnabled(getSavedSetting<LLSettingID::AOEnabled>()); // <singu/>
 	AnimIterator anim_it;
 	for (anim_it = mPlayingAnimations.begin(); anim_it != mPlayingAnimations.end();)
 	{
@@ -5715,7 +5731,7 @@ BOOL LLVOAvatar::processSingleAnimationStateChange( const LLUUID& anim_id, BOOL
 					//}
 					//else
 					{
-						LLUUID sound_id = LLUUID(gSavedSettings.getString("UISndTyping"));
+						LLUUID sound_id = LLUUID(getSavedSetting<LLSettingID::UISndTyping>());
 						gAudiop->triggerSound(sound_id, getID(), 1.0f, LLAudioEngine::AUDIO_TYPE_SFX, char_pos_global);
 					}
 				}
@@ -5885,7 +5901,7 @@ BOOL LLVOAvatar::startMotion(const LLUUID& id, F32 time_offset)
 	//                    hand and finger position and often breaks correct
 	//                    fit of prim nails, rings etc. when flying and
 	//                    using an AO.
-	if ("62c5de58-cb33-5743-3d07-9e4cd4352864" == id.getString() && gSavedSettings.getBOOL("DisableInternalFlyUpAnimation"))
+	if ("62c5de58-cb33-5743-3d07-9e4cd4352864" == id.getString() && getSavedSetting<LLSettingID::DisableInternalFlyUpAnimation>())
 	{
 		return TRUE;
 	}
@@ -6717,6 +6733,7 @@ const LLViewerJointAttachment *LLVOAvatar::attachObject(LLViewerObject *viewer_o
 	}
 
 	mVisualComplexityStale = TRUE;
+	LLAvatarImpostorCache::instance().invalidate(this);
 
 	if (viewer_object->isSelected())
 	{
@@ -6880,6 +6897,7 @@ BOOL LLVOAvatar::detachObject(LLViewerObject *viewer_object)
 		if (attachment->isObjectAttached(viewer_object))
 		{
 			mVisualComplexityStale = TRUE;
+			LLAvatarImpostorCache::instance().invalidate(this);
 			vector_replace_with_last(mAttachedObjectsVector,std::make_pair(viewer_object,attachment));
 
 			cleanupAttachedMesh( viewer_object );
@@ -7558,6 +7576,8 @@ void LLVOAvatar::updateMeshTextures()
 	static S32 update_counter = 0;
 	mBakedTextureDebugText.clear();
 
+	LLAvatarImpostorCache::instance().invalidate(this);
+
 	// if user has never specified a texture, assign the default
 	for (U32 i=0; i < getNumTEs(); i++)
 	{
@@ -8329,7 +8349,7 @@ void LLVOAvatar::processAvatarAppearance( LLMessageSystem* mesgsys )
     static S32 largestSelfCOFSeen(LLViewerInventoryCategory::VERSION_UNKNOWN);
 	LL_DEBUGS("Avatar") << "starts" << LL_ENDL;
 	
-	bool enable_verbose_dumps = gSavedSettings.getBOOL("DebugAvatarAppearanceMessage");
+	bool enable_verbose_dumps = getSavedSetting<LLSettingID::DebugAvatarAppearanceMessage>();
 	std::string dump_prefix = getFullname() + "_" + (isSelf()?"s":"o") + "_";
 	if (gSavedSettings.getBOOL("BlockAvatarAppearanceMessages"))
 	{
@@ -9258,20 +9278,19 @@ void LLVOAvatar::updateImpostors()
 {
 	LLCharacter::sAllowInstancesChange = FALSE ;
 
-	for (std::vector<LLCharacter*>::iterator iter = LLCharacter::sInstances.begin();
-		 iter != LLCharacter::sInstances.end(); ++iter)
-	{
-		LLVOAvatar* avatar = (LLVOAvatar*) *iter;
-		if (!avatar->isDead() && avatar->needsImpostorUpdate() && avatar->isVisible() && avatar->isImpostor())
-		{
-			gPipeline.generateImpostor(avatar);
-		}
-	}
+	LLAvatarImpostorCache::instance().update();
 
 	LLCharacter::sAllowInstancesChange = TRUE ;
 }
 
+// Drawn as a billboard.  Avatars far enough away to want one are drawn
+// skinned until LLAvatarImpostorCache has one for them.
 BOOL LLVOAvatar::isImpostor() const
+{
+	return (isVisuallyMuted() || (sUseImpostors && mUpdatePeriod >= IMPOSTOR_PERIOD && mImpostorSlot >= 0)) ? TRUE : FALSE;
+}
+
+BOOL LLVOAvatar::wantsImpostor() const
 {
 	return (isVisuallyMuted() || (sUseImpostors && mUpdatePeriod >= IMPOSTOR_PERIOD)) ? TRUE : FALSE;
 }
@@ -176,7 +176,7 @@ public:
 													 void **user_data,
 													 U32 block_num,
 													 const EObjectUpdateType update_type,
-													 LLDataPacker *dp);
+													 const LLObjectUpdateData& update);
 	virtual void   	 	 	idleUpdate(LLAgent &agent, LLWorld &world, const F64 &time);
 	/*virtual*/ BOOL   	 	 	updateLOD();
 	BOOL  	 	 	 	 	updateJointLODs();
@@ -501,6 +501,7 @@ private:
 	//--------------------------------------------------------------------
 public:
 	BOOL 		isImpostor() const;
+	BOOL		wantsImpostor() const;
 	BOOL 	    needsImpostorUpdate() const;
 	const LLVector3& getImpostorOffset() const;
 	const LLVector2& getImpostorDim() const;
@@ -509,9 +510,10 @@ public:
 	void 		setImpostorDim(const LLVector2& dim);
 	static void	resetImpostors();
 	static void updateImpostors();
-	LLRenderTarget mImpostor;
 	BOOL		mNeedsImpostorUpdate;
 private:
+	friend class LLAvatarImpostorCache;
+	S32			mImpostorSlot;	// In LLAvatarImpostorCache, -1 if none
 	LLVector3	mImpostorOffset;
 	LLVector2	mImpostorDim;
 	BOOL		mNeedsAnimUpdate;
@@ -743,6 +745,8 @@ public:
 	void			setVisibilityRank(U32 rank);
 	U32				getVisibilityRank()  const { return mVisibilityRank; } // unused
 	static S32 		sNumVisibleAvatars; // Number of instances of this class
+	static S32		sNumSkinnedAvatars; // Of the visible ones, drawn skinned
+	static S32		sNumImpostorAvatars; // Of the visible ones, drawn as impostors
 /**                    Appearance
  **                                                                            **
  *******************************************************************************/
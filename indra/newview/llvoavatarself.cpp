@@ -753,6 +753,17 @@ BOOL LLVOAvatarSelf::setParamWeight(const LLViewerVisualParam *param, F32 weight
 void LLVOAvatarSelf::updateVisualParams()
 {
 	LLVOAvatar::updateVisualParams();
+
+	// Bakes composited on the worker pool leave the morph masks alone, which
+	// is only safe while the masked morphs have no weight.
+	for (U32 i = 0; i < mBakedTextureDatas.size(); i++)
+	{
+		LLViewerTexLayerSet* layerset = getTexLayerSet(i);
+		if (layerset && layerset->getViewerComposite() && layerset->getViewerComposite()->needsMorphMasks())
+		{
+			layerset->requestUpdate();
+		}
+	}
 }
 
 void LLVOAvatarSelf::writeWearablesToAvatar()
@@ -36,6 +36,38 @@
 #include "llregionhandle.h"
 #include "llviewercontrol.h"
 
+// Region cache files are CACHE_FILE_MAGIC and the region's cache id,
+// followed by records of a RecordHeader and mCapacity bytes, mSize of them
+// data.  A record with a local id of 0 is dead.  Host byte order.
+static const char CACHE_FILE_MAGIC[] = "LLVOCRF1";
+static const U32 CACHE_FILE_MAGIC_SIZE = sizeof(CACHE_FILE_MAGIC) - 1;
+static const U32 CACHE_FILE_HEADER_SIZE = CACHE_FILE_MAGIC_SIZE + UUID_BYTES;
+
+struct RecordHeader
+{
+	U32 mLocalID;
+	U32 mCRC;
+	U32 mSize;
+	U32 mCapacity;
+};
+
+// Patches are first written to a journal beside the cache file as a list of
+// JournalHeaders each followed by mLength bytes to write at mOffset, ending
+// with an all zero header.  A journal without that header is incomplete and
+// was never applied.
+struct JournalHeader
+{
+	U32 mOffset;
+	U32 mLength;
+};
+static const char JOURNAL_FILE_SUFFIX[] = ".jnl";
+
+static const U32 RECORD_ALIGNMENT = 32;
+static const U32 MAX_RECORD_SIZE = 10000;
+
+// Files smaller than this are patched however much of them is dead.
+static const U32 MIN_REWRITE_SIZE = 64 * 1024;
+
 BOOL check_read(llifstream& infile, void* src, S32 n_bytes) 
 {
 	infile.read((char*) src, n_bytes);
@@ -59,13 +91,32 @@ LLVOCacheEntry::LLVOCacheEntry(U32 local_id, U32 crc, LLDataPackerBinaryBuffer &
 	mCRC(crc),
 	mHitCount(0),
 	mDupeCount(0),
-	mCRCChangeCount(0)
+	mCRCChangeCount(0),
+	mDirty(true),
+	mFileOffset(0),
+	mFileCapacity(0)
 {
 	mBuffer = new U8[dp.getBufferSize()];
 	mDP.assignBuffer(mBuffer, dp.getBufferSize());
 	mDP = dp; //memcpy
 }
 
+LLVOCacheEntry::LLVOCacheEntry(U32 local_id, U32 crc, const U8* data, S32 size, U32 file_offset, U32 file_capacity)
+	:
+	mLocalID(local_id),
+	mCRC(crc),
+	mHitCount(0),
+	mDupeCount(0),
+	mCRCChangeCount(0),
+	mDirty(false),
+	mFileOffset(file_offset),
+	mFileCapacity(file_capacity)
+{
+	mBuffer = new U8[size];
+	memcpy(mBuffer, data, size);
+	mDP.assignBuffer(mBuffer, size);
+}
+
 LLVOCacheEntry::LLVOCacheEntry()
 	:
 	mLocalID(0),
@@ -73,78 +124,14 @@ LLVOCacheEntry::LLVOCacheEntry()
 	mHitCount(0),
 	mDupeCount(0),
 	mCRCChangeCount(0),
-	mBuffer(NULL)
+	mBuffer(NULL),
+	mDirty(true),
+	mFileOffset(0),
+	mFileCapacity(0)
 {
 	mDP.assignBuffer(mBuffer, 0);
 }
 
-LLVOCacheEntry::LLVOCacheEntry(llifstream& infile)
-
-	: mBuffer(NULL)
-{
-	S32 size = -1;
-	BOOL success;
-
-	mDP.assignBuffer(mBuffer, 0);
-	
-	success = check_read(infile, &mLocalID, sizeof(U32));
-	if(success)
-	{
-		success = check_read(infile, &mCRC, sizeof(U32));
-	}
-	if(success)
-	{
-		success = check_read(infile, &mHitCount, sizeof(S32));
-	}
-	if(success)
-	{
-		success = check_read(infile, &mDupeCount, sizeof(S32));
-	}
-	if(success)
-	{
-		success = check_read(infile, &mCRCChangeCount, sizeof(S32));
-	}
-	if(success)
-	{
-		success = check_read(infile, &size, sizeof(S32));
-
-	// Corruption in the cache entries
-	if ((size > 10000) || (size < 1))
-	{
-		// We've got a bogus size, skip reading it.
-		// We won't bother seeking, because the rest of this file
-		// is likely bogus, and will be tossed anyway.
-			LL_WARNS() << "Bogus cache entry, size " << size << ", aborting!" << LL_ENDL;
-			success = FALSE;
-		}
-	}
-	if(success && size > 0)
-	{
-		mBuffer = new U8[size];
-		success = check_read(infile, mBuffer, size);
-
-		if(success)
-		{
-			mDP.assignBuffer(mBuffer, size);
-		}
-		else
-		{
-			delete[] mBuffer ;
-			mBuffer = NULL ;
-		}
-	}
-
-	if(!success)
-	{
-		mLocalID = 0;
-		mCRC = 0;
-		mHitCount = 0;
-		mDupeCount = 0;
-		mCRCChangeCount = 0;
-		mBuffer = NULL;
-	}
-}
-
 LLVOCacheEntry::~LLVOCacheEntry()
 {
 	mDP.freeBuffer();
@@ -165,6 +152,7 @@ void LLVOCacheEntry::assignCRC(U32 crc, LLDataPackerBinaryBuffer &dp)
 		mBuffer = new U8[dp.getBufferSize()];
 		mDP.assignBuffer(mBuffer, dp.getBufferSize());
 		mDP = dp;
+		mDirty = true;
 	}
 }
 
@@ -197,38 +185,132 @@ void LLVOCacheEntry::dump() const
 		<< LL_ENDL;
 }
 
-BOOL LLVOCacheEntry::writeToFile(llofstream& outfile) const
+BOOL LLVOCacheEntry::writeToFile(llofstream& outfile, U32 capacity) const
 {
-	BOOL success;
-	success = check_write(outfile, (void*)&mLocalID, sizeof(U32));
+	static const U8 padding[RECORD_ALIGNMENT] = { 0 };
+
+	RecordHeader header;
+	header.mLocalID = mLocalID;
+	header.mCRC = mCRC;
+	header.mSize = mDP.getBufferSize();
+	header.mCapacity = capacity;
+	llassert(header.mSize <= capacity);
+
+	BOOL success = check_write(outfile, &header, sizeof(RecordHeader));
 	if(success)
 	{
-		success = check_write(outfile, (void*)&mCRC, sizeof(U32));
+		success = check_write(outfile, (void*)mBuffer, header.mSize);
 	}
-	if(success)
+	for (U32 left = capacity - header.mSize; success && left > 0; )
 	{
-		success = check_write(outfile, (void*)&mHitCount, sizeof(S32));
+		U32 n = llmin(left, RECORD_ALIGNMENT);
+		success = check_write(outfile, (void*)padding, n);
+		left -= n;
 	}
-	if(success)
+
+	return success ;
+}
+
+//static
+U32 LLVOCacheEntry::getRecordCapacity(S32 size)
+{
+	return (U32)(size + RECORD_ALIGNMENT - 1) & ~(RECORD_ALIGNMENT - 1);
+}
+
+//---------------------------------------------------------------------------
+// LLVOCacheFile
+//---------------------------------------------------------------------------
+
+LLVOCacheFile::LLVOCacheFile()
+:	mLiveCount(0),
+	mEnd(0),
+	mDeadBytes(0),
+	mFirstLive(0),
+	mNeedsRewrite(true)
+{
+}
+
+LLVOCacheFile::Record* LLVOCacheFile::findRecord(U32 local_id)
+{
+	Record key;
+	key.mLocalID = local_id;
+	record_list_t::iterator iter = std::lower_bound(mRecords.begin(), mRecords.end(), key);
+	if (iter == mRecords.end() || iter->mLocalID != local_id || iter->mTaken)
 	{
-		success = check_write(outfile, (void*)&mDupeCount, sizeof(S32));
+		return NULL;
 	}
-	if(success)
+	return &*iter;
+}
+
+const LLVOCacheFile::Record* LLVOCacheFile::findRecord(U32 local_id) const
+{
+	return const_cast<LLVOCacheFile*>(this)->findRecord(local_id);
+}
+
+bool LLVOCacheFile::getCRC(U32 local_id, U32& crc) const
+{
+	const Record* record = findRecord(local_id);
+	if (!record)
 	{
-		success = check_write(outfile, (void*)&mCRCChangeCount, sizeof(S32));
+		return false;
 	}
-	if(success)
+	crc = record->mCRC;
+	return true;
+}
+
+U32 LLVOCacheFile::getFirstLocalID() const
+{
+	// Records are never untaken, so the cursor only moves forward.
+	while (mFirstLive < mRecords.size() && mRecords[mFirstLive].mTaken)
 	{
-		S32 size = mDP.getBufferSize();
-		success = check_write(outfile, (void*)&size, sizeof(S32));
-	
-		if(success)
-		{
-			success = check_write(outfile, (void*)mBuffer, size);
-		}
+		++mFirstLive;
 	}
+	return mFirstLive < mRecords.size() ? mRecords[mFirstLive].mLocalID : 0;
+}
 
-	return success ;
+LLVOCacheEntry* LLVOCacheFile::take(U32 local_id)
+{
+	Record* record = findRecord(local_id);
+	if (!record || !mFile.isOpen())
+	{
+		return NULL;
+	}
+	record->mTaken = true;
+	--mLiveCount;
+
+	const U8* data = mFile.getData() + record->mOffset + sizeof(RecordHeader);
+	return new LLVOCacheEntry(local_id, record->mCRC, data, record->mSize, record->mOffset, record->mCapacity);
+}
+
+void LLVOCacheFile::erase(U32 local_id)
+{
+	Record* record = findRecord(local_id);
+	if (record)
+	{
+		record->mTaken = true;
+		--mLiveCount;
+		eraseRecord(record->mOffset);
+	}
+}
+
+void LLVOCacheFile::eraseRecord(U32 offset)
+{
+	if (offset)
+	{
+		mErased.push_back(offset);
+	}
+}
+
+void LLVOCacheFile::close()
+{
+	mFile.close();
+	mRecords.clear();
+	mErased.clear();
+	mLiveCount = 0;
+	mEnd = 0;
+	mFirstLive = 0;
+	mDeadBytes = 0;
+	mNeedsRewrite = true;
 }
 
 //-------------------------------------------------------------------
@@ -442,6 +524,7 @@ void LLVOCache::removeFromCache(HeaderEntryInfo* entry)
 	std::string filename;
 	getObjectCacheFilename(entry->mHandle, filename);
 	LLFile::remove(filename);
+	LLFile::remove_nowarn(filename + JOURNAL_FILE_SUFFIX);
 	entry->mTime = INVALID_TIME ;
 	updateEntry(entry) ; //update the head file.
 }
@@ -595,7 +678,7 @@ BOOL LLVOCache::updateEntry(const HeaderEntryInfo* entry)
 	return check_write(outfile, (void*)entry, sizeof(HeaderEntryInfo)) ;
 }
 
-void LLVOCache::readFromCache(U64 handle, const LLUUID& id, LLVOCacheEntry::vocache_entry_map_t& cache_entry_map) 
+void LLVOCache::readFromCache(U64 handle, const LLUUID& id, LLVOCacheFile& cache_file) 
 {
 	if(!mEnabled)
 	{
@@ -604,6 +687,8 @@ void LLVOCache::readFromCache(U64 handle, const LLUUID& id, LLVOCacheEntry::voca
 	}
 	llassert_always(mInitialized);
 
+	cache_file.close();
+
 	handle_entry_map_t::iterator iter = mHandleEntryMap.find(handle) ;
 	if(iter == mHandleEntryMap.end()) //no cache
 	{
@@ -611,55 +696,95 @@ void LLVOCache::readFromCache(U64 handle, const LLUUID& id, LLVOCacheEntry::voca
 		return ;
 	}
 
-	bool success = true ;
+	std::string filename;
+	getObjectCacheFilename(handle, filename);
+	if(!replayJournal(filename))
 	{
-		std::string filename;
-		getObjectCacheFilename(handle, filename);
-		llifstream infile(filename, std::ios::in | std::ios::binary);
-	
-		LLUUID cache_id ;
-		success = check_read(infile, cache_id.mData, UUID_BYTES) ;
-	
-		if(success)
-		{		
-			if(cache_id != id)
-			{
-				LL_INFOS() << "Cache ID doesn't match for this region, discarding"<< LL_ENDL;
-				success = false ;
-			}
+		LL_WARNS() << "Failed to apply the journal of " << filename << ", discarding" << LL_ENDL;
+		removeEntry(iter->second) ;
+		return ;
+	}
 
-			if(success)
-			{
-				S32 num_entries;
-				success = check_read(infile, &num_entries, sizeof(S32)) ;
-	
-				if(success)
-				{
-					for (S32 i = 0; i < num_entries; i++)
-					{
-						LLVOCacheEntry* entry = new LLVOCacheEntry(infile);
-						if (!entry->getLocalID())
-						{
-							LL_WARNS() << "Aborting cache file load for " << filename << ", cache file corruption!" << LL_ENDL;
-							delete entry ;
-							success = false ;
-							break ;
-						}
-						cache_entry_map[entry->getLocalID()] = entry;
-					}
-				}
-			}
-		}		
+	LLMappedFile& file = cache_file.mFile;
+	bool success = file.open(filename) && file.getSize() >= CACHE_FILE_HEADER_SIZE && file.getSize() <= U32_MAX
+		&& !memcmp(file.getData(), CACHE_FILE_MAGIC, CACHE_FILE_MAGIC_SIZE);
+	if(success)
+	{
+		LLUUID cache_id ;
+		memcpy(cache_id.mData, file.getData() + CACHE_FILE_MAGIC_SIZE, UUID_BYTES);
+		if(cache_id != id)
+		{
+			LL_INFOS() << "Cache ID doesn't match for this region, discarding"<< LL_ENDL;
+			success = false ;
+		}
 	}
-	
 	if(!success)
 	{
-		if(cache_entry_map.empty())
+		cache_file.close();
+		removeEntry(iter->second) ;
+		return ;
+	}
+
+	// Index the records without touching their data.
+	const U8* data = file.getData();
+	const U32 size = (U32)file.getSize();
+	U32 pos = CACHE_FILE_HEADER_SIZE;
+	LLVOCacheFile::record_list_t& records = cache_file.mRecords;
+	while(pos + sizeof(RecordHeader) <= size)
+	{
+		RecordHeader header;
+		memcpy(&header, data + pos, sizeof(RecordHeader));
+		if(header.mCapacity > MAX_RECORD_SIZE + RECORD_ALIGNMENT || header.mSize > header.mCapacity
+			|| header.mCapacity > size - pos - sizeof(RecordHeader) || (header.mLocalID && header.mSize < 1))
+		{
+			break ;
+		}
+
+		U32 record_size = sizeof(RecordHeader) + header.mCapacity;
+		if(header.mLocalID)
 		{
-			removeEntry(iter->second) ;
+			LLVOCacheFile::Record record;
+			record.mLocalID = header.mLocalID;
+			record.mCRC = header.mCRC;
+			record.mOffset = pos;
+			record.mSize = header.mSize;
+			record.mCapacity = header.mCapacity;
+			record.mTaken = false;
+			records.push_back(record);
 		}
+		else
+		{
+			cache_file.mDeadBytes += record_size;
+		}
+		pos += record_size;
+	}
+	cache_file.mEnd = pos;
+	cache_file.mNeedsRewrite = pos != size;
+	if(cache_file.mNeedsRewrite)
+	{
+		LL_WARNS() << "Cache file corruption in " << filename << " at offset " << pos << ", keeping the records before it" << LL_ENDL;
 	}
 
+	// Appends that went through without the old record being killed leave
+	// two records for a local id; the later one wins.
+	std::stable_sort(records.begin(), records.end());
+	LLVOCacheFile::record_list_t::iterator out = records.begin();
+	for(LLVOCacheFile::record_list_t::iterator rec = records.begin(); rec != records.end(); ++rec)
+	{
+		if(out != records.begin() && (out - 1)->mLocalID == rec->mLocalID)
+		{
+			cache_file.mDeadBytes += sizeof(RecordHeader) + (out - 1)->mCapacity;
+			*(out - 1) = *rec;
+		}
+		else
+		{
+			*out++ = *rec;
+		}
+	}
+	records.erase(out, records.end());
+	cache_file.mLiveCount = (S32)records.size();
+	cache_file.mFirstLive = 0;
+
 	return ;
 }
 	
@@ -677,11 +802,12 @@ void LLVOCache::purgeEntries(U32 size)
 	mNumEntries = mHandleEntryMap.size() ;
 }
 
-void LLVOCache::writeToCache(U64 handle, const LLUUID& id, const LLVOCacheEntry::vocache_entry_map_t& cache_entry_map, BOOL dirty_cache, bool removal_enabled) 
+void LLVOCache::writeToCache(U64 handle, const LLUUID& id, const LLVOCacheEntry::vocache_entry_map_t& cache_entry_map, LLVOCacheFile& cache_file, BOOL dirty_cache, bool removal_enabled) 
 {
 	if(!mEnabled)
 	{
 		LL_WARNS() << "Not writing cache for handle " << handle << "): Cache is currently disabled." << LL_ENDL;
+		cache_file.close();
 		return ;
 	}
 	llassert_always(mInitialized);
@@ -689,6 +815,7 @@ void LLVOCache::writeToCache(U64 handle, const LLUUID& id, const LLVOCacheEntry:
 	if(mReadOnly)
 	{
 		LL_WARNS() << "Not writing cache for handle " << handle << "): Cache is currently in read-only mode." << LL_ENDL;
+		cache_file.close();
 		return ;
 	}	
 
@@ -707,6 +834,9 @@ void LLVOCache::writeToCache(U64 handle, const LLUUID& id, const LLVOCacheEntry:
 		entry->mIndex = mNumEntries++;
 		mHeaderEntryQueue.insert(entry) ;
 		mHandleEntryMap[handle] = entry ;
+
+		// Whatever is in the file predates the header entry.
+		cache_file.mNeedsRewrite = true;
 	}
 	else
 	{
@@ -724,47 +854,228 @@ void LLVOCache::writeToCache(U64 handle, const LLUUID& id, const LLVOCacheEntry:
 	if(!updateEntry(entry))
 	{
 		LL_WARNS() << "Failed to update cache header index " << entry->mIndex << ". handle = " << handle << LL_ENDL;
+		cache_file.close();
 		return ; //update failed.
 	}
 
 	if(!dirty_cache)
 	{
 		LL_WARNS() << "Skipping write to cache for handle " << handle << ": cache not dirty" << LL_ENDL;
+		cache_file.close();
 		return ; //nothing changed, no need to update.
 	}
 
-	//write to cache file
+	std::string filename;
+	getObjectCacheFilename(handle, filename);
+
+	// Rewrite once dead records make up most of the file, patch otherwise.
+	bool rewrite = cache_file.mNeedsRewrite || !cache_file.mFile.isOpen()
+		|| (cache_file.mEnd > MIN_REWRITE_SIZE && cache_file.mDeadBytes > cache_file.mEnd / 2);
+	bool success = rewrite ? rewriteCacheFile(filename, id, cache_entry_map, cache_file)
+						   : patchCacheFile(filename, cache_entry_map, cache_file);
+	cache_file.close();
+
+	if(!success)
+	{
+		removeEntry(entry) ;
+
+	}
+
+	return ;
+}
+
+bool LLVOCache::rewriteCacheFile(const std::string& filename, const LLUUID& id, const LLVOCacheEntry::vocache_entry_map_t& cache_entry_map, LLVOCacheFile& cache_file)
+{
+	// Written beside the old file, which the undecoded records are copied
+	// out of.
+	std::string temp_filename = filename + ".tmp";
 	bool success = true ;
 	{
-		std::string filename;
-		getObjectCacheFilename(handle, filename);
-		std::ios::openmode flags = std::ios::out | std::ios::binary;
-		if (LLFile::isfile(mHeaderFileName))
+		llofstream outfile(temp_filename, std::ios::out | std::ios::binary | std::ios::trunc);
+
+		success = check_write(outfile, (void*)CACHE_FILE_MAGIC, CACHE_FILE_MAGIC_SIZE) ;
+		if(success)
 		{
-			flags |= std::ios::in;
+			success = check_write(outfile, (void*)id.mData, UUID_BYTES) ;
 		}
-		llofstream outfile(filename, flags);
-
-		success = check_write(outfile, (void*)id.mData, UUID_BYTES) ;
 
-		if(success)
+		const U8* data = cache_file.mFile.getData();
+		for (LLVOCacheFile::record_list_t::const_iterator iter = cache_file.mRecords.begin(); success && data && iter != cache_file.mRecords.end(); ++iter)
 		{
-			S32 num_entries = cache_entry_map.size() ;
-			success = check_write(outfile, &num_entries, sizeof(S32));
-	
-			for (LLVOCacheEntry::vocache_entry_map_t::const_iterator iter = cache_entry_map.begin(); success && iter != cache_entry_map.end(); ++iter)
+			if (!iter->mTaken)
 			{
-				success = iter->second->writeToFile(outfile) ;
+				success = check_write(outfile, (void*)(data + iter->mOffset), sizeof(RecordHeader) + iter->mCapacity) ;
 			}
 		}
+		for (LLVOCacheEntry::vocache_entry_map_t::const_iterator iter = cache_entry_map.begin(); success && iter != cache_entry_map.end(); ++iter)
+		{
+			const LLVOCacheEntry* cache_entry = iter->second;
+			success = cache_entry->writeToFile(outfile, LLVOCacheEntry::getRecordCapacity(cache_entry->getSize())) ;
+		}
 	}
 
+	cache_file.mFile.close();
+	if(success)
+	{
+		LLFile::remove_nowarn(filename);
+		success = LLFile::rename(temp_filename, filename) == 0;
+	}
+	if(success)
+	{
+		// Anything left in it was for the old file.
+		LLFile::remove_nowarn(filename + JOURNAL_FILE_SUFFIX);
+	}
 	if(!success)
 	{
-		removeEntry(entry) ;
+		LLFile::remove(temp_filename);
+	}
+	return success ;
+}
+
+bool LLVOCache::patchCacheFile(const std::string& filename, const LLVOCacheEntry::vocache_entry_map_t& cache_entry_map, LLVOCacheFile& cache_file)
+{
+	cache_file.mFile.close();
+
+	// The patch is journaled and only applied once the whole journal is on
+	// disk, so that an interrupted save leaves the file as it was or fully
+	// patched, never with a torn record.
+	std::string journal_filename = filename + JOURNAL_FILE_SUFFIX;
+	std::vector<U32> dead = cache_file.mErased;
+	S32 patched = 0;
+	S32 appended = 0;
+	bool success = true ;
+	{
+		llofstream journal(journal_filename, std::ios::out | std::ios::binary | std::ios::trunc);
+		success = journal.is_open();
+
+		U32 end = cache_file.mEnd;
+		for (LLVOCacheEntry::vocache_entry_map_t::const_iterator iter = cache_entry_map.begin(); success && iter != cache_entry_map.end(); ++iter)
+		{
+			const LLVOCacheEntry* cache_entry = iter->second;
+			if (!cache_entry->isDirty())
+			{
+				continue;
+			}
 
+			JournalHeader header;
+			U32 capacity;
+			U32 offset = cache_entry->getFileOffset();
+			if (offset && (U32)cache_entry->getSize() <= cache_entry->getFileCapacity())
+			{
+				header.mOffset = offset;
+				capacity = cache_entry->getFileCapacity();
+				++patched;
+			}
+			else
+			{
+				header.mOffset = end;
+				capacity = LLVOCacheEntry::getRecordCapacity(cache_entry->getSize());
+				end += sizeof(RecordHeader) + capacity;
+				++appended;
+				if (offset)
+				{
+					dead.push_back(offset);
+				}
+			}
+			header.mLength = sizeof(RecordHeader) + capacity;
+			success = check_write(journal, &header, sizeof(JournalHeader))
+				&& cache_entry->writeToFile(journal, capacity);
+		}
+
+		const U32 dead_id = 0;
+		for (std::vector<U32>::const_iterator iter = dead.begin(); success && iter != dead.end(); ++iter)
+		{
+			JournalHeader header = { *iter, sizeof(U32) };
+			success = check_write(journal, &header, sizeof(JournalHeader))
+				&& check_write(journal, (void*)&dead_id, sizeof(U32));
+		}
+
+		if (success)
+		{
+			JournalHeader header = { 0, 0 };
+			success = check_write(journal, &header, sizeof(JournalHeader));
+			journal.flush();
+			success = success && journal.good();
+		}
 	}
 
-	return ;
+	if (!success)
+	{
+		LLFile::remove(journal_filename);
+		return false;
+	}
+
+	LL_DEBUGS("ObjectCache") << "Patching " << patched << ", appending " << appended << " and killing " << dead.size()
+							 << " records in " << filename << LL_ENDL;
+	return replayJournal(filename);
 }
 
+bool LLVOCache::replayJournal(const std::string& filename)
+{
+	std::string journal_filename = filename + JOURNAL_FILE_SUFFIX;
+	if (!LLFile::isfile(journal_filename))
+	{
+		return true;
+	}
+
+	LLMappedFile journal;
+	const U8* data = journal.open(journal_filename) ? journal.getData() : NULL;
+	const size_t size = data ? journal.getSize() : 0;
+
+	// Find the end marker first; without it the cache file was never touched.
+	bool complete = false;
+	size_t pos = 0;
+	while (pos + sizeof(JournalHeader) <= size)
+	{
+		JournalHeader header;
+		memcpy(&header, data + pos, sizeof(JournalHeader));
+		pos += sizeof(JournalHeader);
+		if (!header.mOffset && !header.mLength)
+		{
+			complete = true;
+			break;
+		}
+		if (header.mOffset < CACHE_FILE_HEADER_SIZE || header.mLength > size - pos)
+		{
+			break;
+		}
+		pos += header.mLength;
+	}
+
+	bool success = true;
+	if (complete)
+	{
+		llofstream outfile(filename, std::ios::in | std::ios::out | std::ios::binary);
+		success = outfile.is_open();
+		for (pos = 0; success; )
+		{
+			JournalHeader header;
+			memcpy(&header, data + pos, sizeof(JournalHeader));
+			pos += sizeof(JournalHeader);
+			if (!header.mOffset && !header.mLength)
+			{
+				break;
+			}
+			outfile.seekp(header.mOffset);
+			success = check_write(outfile, (void*)(data + pos), header.mLength);
+			pos += header.mLength;
+		}
+		if (success)
+		{
+			outfile.flush();
+			success = outfile.good();
+		}
+	}
+	else
+	{
+		LL_WARNS() << "Discarding incomplete cache journal " << journal_filename << LL_ENDL;
+	}
+	journal.close();
+
+	// A journal that failed to apply is kept, to be replayed on the next read.
+	if (success)
+	{
+		LLFile::remove(journal_filename);
+	}
+	return success;
+}
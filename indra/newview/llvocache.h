@@ -36,6 +36,7 @@
 #include "lluuid.h"
 #include "lldatapacker.h"
 #include "lldir.h"
+#include "llmappedfile.h"
 
 
 //---------------------------------------------------------------------------
@@ -46,7 +47,8 @@ class LLVOCacheEntry
 {
 public:
 	LLVOCacheEntry(U32 local_id, U32 crc, LLDataPackerBinaryBuffer &dp);
-	LLVOCacheEntry(llifstream& infile);
+	// Decoded from the record at file_offset of a region's cache file.
+	LLVOCacheEntry(U32 local_id, U32 crc, const U8* data, S32 size, U32 file_offset, U32 file_capacity);
 	LLVOCacheEntry();
 	~LLVOCacheEntry();
 
@@ -54,9 +56,21 @@ public:
 	U32 getCRC() const				{ return mCRC; }
 	S32 getHitCount() const			{ return mHitCount; }
 	S32 getCRCChangeCount() const	{ return mCRCChangeCount; }
+	S32 getSize() const				{ return mDP.getBufferSize(); }
+
+	// Changed since it was read from the cache file, or never written.
+	bool isDirty() const			{ return mDirty; }
+	// The record this entry was read from, 0 if none.
+	U32 getFileOffset() const		{ return mFileOffset; }
+	U32 getFileCapacity() const		{ return mFileCapacity; }
 
 	void dump() const;
-	BOOL writeToFile(llofstream& outfile) const;
+	// Writes a record with room for capacity bytes of data, which must be
+	// at least the entry's size.
+	BOOL writeToFile(llofstream& outfile, U32 capacity) const;
+	// Room left for data in a new record, so that small changes fit in
+	// place.
+	static U32 getRecordCapacity(S32 size);
 	void assignCRC(U32 crc, LLDataPackerBinaryBuffer &dp);
 	LLDataPackerBinaryBuffer *getDP(U32 crc);
 	void recordHit();
@@ -73,6 +87,72 @@ protected:
 	S32							mCRCChangeCount;
 	LLDataPackerBinaryBuffer	mDP;
 	U8							*mBuffer;
+	bool						mDirty;
+	U32							mFileOffset;
+	U32							mFileCapacity;
+};
+
+//
+// A region's object cache file, mapped into memory.  Opening it only
+// indexes the records by local id; a record is copied out into an
+// LLVOCacheEntry the first time the simulator's cache probes ask for it,
+// and the rest never leave the file.  Saving the region patches changed
+// records in place or appends them through a journal, and only rewrites the
+// whole file once most of it is dead.
+//
+class LLVOCacheFile
+{
+public:
+	LLVOCacheFile();
+
+	// No undecoded records.
+	bool empty() const				{ return mLiveCount == 0; }
+	S32 getCount() const			{ return mLiveCount; }
+
+	// CRC of the undecoded record for local_id.  Returns false if there is
+	// none.
+	bool getCRC(U32 local_id, U32& crc) const;
+	// Lowest local id with an undecoded record, 0 if none.  Amortized
+	// constant time.
+	U32 getFirstLocalID() const;
+
+	// Decodes the record for local_id and hands it over to the caller.  The
+	// entry remembers its record, so that saving it can reuse it.
+	LLVOCacheEntry* take(U32 local_id);
+	// Drops the record for local_id, or the record an entry was read from,
+	// from the file on the next save.
+	void erase(U32 local_id);
+	void eraseRecord(U32 offset);
+
+	void close();
+
+private:
+	friend class LLVOCache;
+
+	struct Record
+	{
+		U32		mLocalID;
+		U32		mCRC;
+		U32		mOffset;		// Of the record header
+		U32		mSize;
+		U32		mCapacity;
+		bool	mTaken;
+
+		bool operator<(const Record& rhs) const { return mLocalID < rhs.mLocalID; }
+	};
+	typedef std::vector<Record> record_list_t;
+
+	Record* findRecord(U32 local_id);
+	const Record* findRecord(U32 local_id) const;
+
+	LLMappedFile		mFile;
+	record_list_t		mRecords;		// Sorted by local id
+	std::vector<U32>	mErased;		// Records to kill on save
+	S32					mLiveCount;
+	U32					mEnd;			// End of the last good record
+	U32					mDeadBytes;
+	mutable size_t		mFirstLive;		// No live record before this one
+	bool				mNeedsRewrite;	// Damaged, or not this region's
 };
 
 //
@@ -119,8 +199,10 @@ public:
 	void initCache(ELLPath location, U32 size, U32 cache_version) ;
 	void removeCache(ELLPath location) ;
 
-	void readFromCache(U64 handle, const LLUUID& id, LLVOCacheEntry::vocache_entry_map_t& cache_entry_map) ;
-	void writeToCache(U64 handle, const LLUUID& id, const LLVOCacheEntry::vocache_entry_map_t& cache_entry_map, BOOL dirty_cache, bool removal_enabled);
+	void readFromCache(U64 handle, const LLUUID& id, LLVOCacheFile& cache_file) ;
+	// cache_entry_map holds the entries taken from cache_file or added
+	// since.  Closes cache_file.
+	void writeToCache(U64 handle, const LLUUID& id, const LLVOCacheEntry::vocache_entry_map_t& cache_entry_map, LLVOCacheFile& cache_file, BOOL dirty_cache, bool removal_enabled);
 	void removeEntry(U64 handle) ;
 
 	void setReadOnly(bool read_only) {mReadOnly = read_only;} 
@@ -137,6 +219,11 @@ private:
 	void removeEntry(HeaderEntryInfo* entry) ;
 	void purgeEntries(U32 size);
 	BOOL updateEntry(const HeaderEntryInfo* entry);
+	bool rewriteCacheFile(const std::string& filename, const LLUUID& id, const LLVOCacheEntry::vocache_entry_map_t& cache_entry_map, LLVOCacheFile& cache_file);
+	bool patchCacheFile(const std::string& filename, const LLVOCacheEntry::vocache_entry_map_t& cache_entry_map, LLVOCacheFile& cache_file);
+	// Applies and removes a complete patch journal left beside filename,
+	// drops an incomplete one.  Returns false if filename may be torn.
+	bool replayJournal(const std::string& filename);
 	
 private:
 	bool                 mEnabled;
@@ -42,10 +42,12 @@
 #include "lldrawpoolwater.h"
 #include "llglheaders.h"
 #include "llsky.h"
+#include "llskyscatter.h"
 #include "llviewercamera.h"
 #include "llviewertexturelist.h"
 #include "llviewerobjectlist.h"
 #include "llviewerregion.h"
+#include "llworkerpool.h"
 #include "llworld.h"
 #include "pipeline.h"
 #include "lldrawpoolwlsky.h"
@@ -55,9 +57,11 @@
 #undef min
 #undef max
 
-static const S32 NUM_TILES_X = 8;
-static const S32 NUM_TILES_Y = 4;
-static const S32 NUM_TILES = NUM_TILES_X * NUM_TILES_Y;
+// Updates taken to blend from one sky texture to the next.
+static const S32 SKY_BLEND_FRAMES = 192;
+
+// Cube map columns evaluated per worker job.
+static const U32 SKY_COLUMNS_PER_JOB = 8;
 
 // Heavenly body constants
 static const F32 SUN_DISK_RADIUS	= 0.5f;
@@ -313,8 +317,6 @@ void LLSkyTex::bindTexture(BOOL curr)
 F32	LLHeavenBody::sInterpVal = 0;
 
 S32 LLVOSky::sResolution = LLSkyTex::getResolution();
-S32 LLVOSky::sTileResX = sResolution/NUM_TILES_X;
-S32 LLVOSky::sTileResY = sResolution/NUM_TILES_Y;
 
 LLVOSky::LLVOSky(const LLUUID &id, const LLPCode pcode, LLViewerRegion *regionp)
 :	LLStaticViewerObject(id, pcode, regionp, TRUE),
@@ -418,12 +420,9 @@ void LLVOSky::init()
 	// Initialize the cached normalized direction vectors
 	for (S32 side = 0; side < 6; ++side)
 	{
-		for (S32 tile = 0; tile < NUM_TILES; ++tile)
-		{
-			initSkyTextureDirs(side, tile);
-			createSkyTexture(side, tile);
-		}
+		initSkyTextureDirs(side);
 	}
+	createSkyTexture();
 
 	for (S32 i = 0; i < 6; ++i)
 	{
@@ -512,14 +511,8 @@ void LLVOSky::restoreGL()
 
 }
 
-void LLVOSky::initSkyTextureDirs(const S32 side, const S32 tile)
+void LLVOSky::initSkyTextureDirs(const S32 side)
 {
-	S32 tile_x = tile % NUM_TILES_X;
-	S32 tile_y = tile / NUM_TILES_X;
-
-	S32 tile_x_pos = tile_x * sTileResX;
-	S32 tile_y_pos = tile_y * sTileResY;
-
 	F32 coeff[3] = {0, 0, 0};
 	const S32 curr_coef = side >> 1; // 0/1 = Z axis, 2/3 = Y, 4/5 = X
 	const S32 side_dir = (((side & 1) << 1) - 1);  // even = -1, odd = 1
@@ -530,9 +523,9 @@ void LLVOSky::initSkyTextureDirs(const S32 side, const S32 tile)
 
 	F32 inv_res = 1.f/sResolution;
 	S32 x, y;
-	for (y = tile_y_pos; y < (tile_y_pos + sTileResY); ++y)
+	for (y = 0; y < sResolution; ++y)
 	{
-		for (x = tile_x_pos; x < (tile_x_pos + sTileResX); ++x)
+		for (x = 0; x < sResolution; ++x)
 		{
 			coeff[x_coef] = F32((x<<1) + 1) * inv_res - 1.f;
 			coeff[y_coef] = F32((y<<1) + 1) * inv_res - 1.f;
@@ -544,22 +537,44 @@ void LLVOSky::initSkyTextureDirs(const S32 side, const S32 tile)
 	}
 }
 
-void LLVOSky::createSkyTexture(const S32 side, const S32 tile)
-{
-	S32 tile_x = tile % NUM_TILES_X;
-	S32 tile_y = tile / NUM_TILES_X;
+static LLTrace::BlockTimerStatHandle FTM_SKY_TEXTURE("Sky Texture");
 
-	S32 tile_x_pos = tile_x * sTileResX;
-	S32 tile_y_pos = tile_y * sTileResY;
+// Rebuilds every texel of both cube maps from the current atmospherics.
+void LLVOSky::createSkyTexture()
+{
+	LL_RECORD_BLOCK_TIME(FTM_SKY_TEXTURE);
+
+	LLSkyScatter::Params params;
+	params.dome_radius = dome_radius;
+	params.dome_offset_ratio = dome_offset_ratio;
+	params.sunlight_color = sunlight_color;
+	params.ambient = ambient;
+	params.lightnorm = lightnorm;
+	params.blue_density = blue_density;
+	params.blue_horizon = blue_horizon;
+	params.haze_density = haze_density;
+	params.haze_horizon = haze_horizon;
+	params.density_multiplier = density_multiplier;
+	params.max_y = max_y;
+	params.glow = glow;
+	params.cloud_shadow = cloud_shadow;
+	params.fog_color = mFogColor;
+	params.windlight_shaders = gPipeline.canUseWindLightShaders();
+	const LLSkyScatter scatter(params);
+
+	// Jobs write disjoint columns of the sides, so they need no locking.
+	LLWorkerPool::getDefault()->parallelFor(6 * sResolution, SKY_COLUMNS_PER_JOB,
+		boost::bind(&LLVOSky::createSkyColumns, this, boost::cref(scatter), _1, _2));
+}
 
-	S32 x, y;
-	for (y = tile_y_pos; y < (tile_y_pos + sTileResY); ++y)
+void LLVOSky::createSkyColumns(const LLSkyScatter& scatter, U32 begin, U32 end)
+{
+	for (U32 column = begin; column < end; ++column)
 	{
-		for (x = tile_x_pos; x < (tile_x_pos + sTileResX); ++x)
-		{
-			mSkyTex[side].setPixel(calcSkyColorInDir(mSkyTex[side].getDir(x, y)), x, y);
-			mShinyTex[side].setPixel(calcSkyColorInDir(mSkyTex[side].getDir(x, y), true), x, y);
-		}
+		const S32 side = column / sResolution;
+		const S32 offset = (column % sResolution) * sResolution;
+		scatter.evaluate(mSkyTex[side].mSkyDirs + offset, sResolution,
+						 mSkyTex[side].mSkyData + offset, mShinyTex[side].mSkyData + offset);
 	}
 }
 
@@ -679,6 +694,7 @@ void LLVOSky::initAtmospherics(void)
 	
 }
 
+// LLSkyScatter evaluates the same model for the cube maps; keep the two in step.
 LLColor4 LLVOSky::calcSkyColorInDir(const LLVector3 &dir, bool isShiny)
 {
 	F32 saturation = 0.3f;
@@ -1074,8 +1090,7 @@ BOOL LLVOSky::updateSky()
 	}
 
 	static S32 next_frame = 0;
-	const S32 total_no_tiles = 6 * NUM_TILES;
-	const S32 cycle_frame_no = total_no_tiles + 1;
+	const S32 cycle_frame_no = SKY_BLEND_FRAMES + 1;
 
 	if (mUpdateTimer.getElapsedTimeF32() > 0.001f)
 	{
@@ -1091,8 +1106,15 @@ BOOL LLVOSky::updateSky()
 		LLHeavenBody::setInterpVal( mInterpVal );
 		calcAtmospherics();
 
-		if (mForceUpdate || total_no_tiles == frame)
+		if (mForceUpdate || SKY_BLEND_FRAMES == frame)
 		{
+			if (!mForceUpdate || !mCubeMap)
+			{
+				// The whole cube is rebuilt at once from this frame's
+				// atmospherics, then blended in over the next cycle.  A
+				// forced update with a cube map rebuilds it below.
+				createSkyTexture();
+			}
 			LLSkyTex::stepCurrent();
 			
 			const static F32 LIGHT_DIRECTION_THRESHOLD = (F32) cos(DEG_TO_RAD * 1.f);
@@ -1122,13 +1144,7 @@ BOOL LLVOSky::updateSky()
                     if (mForceUpdate)
 					{
 						updateFog(LLViewerCamera::getInstance()->getFar());
-						for (int side = 0; side < 6; side++) 
-						{
-							for (int tile = 0; tile < NUM_TILES; tile++) 
-							{
-								createSkyTexture(side, tile);
-							}
-						}
+						createSkyTexture();
 
 						calcAtmospherics();
 
@@ -1178,12 +1194,6 @@ BOOL LLVOSky::updateSky()
 
 			mForceUpdate = FALSE;
 		}
-		else
-		{
-			const S32 side = frame / NUM_TILES;
-			const S32 tile = frame % NUM_TILES;
-			createSkyTexture(side, tile);
-		}
 	}
 
 	if (mDrawable.notNull() && mDrawable->getFace(0) && !mDrawable->getFace(0)->getVertexBuffer())
@@ -108,6 +108,7 @@ inline F32 color_min(const LLColor3 &col)
 
 class LLFace;
 class LLHaze;
+class LLSkyScatter;
 
 
 class LLSkyTex
@@ -470,8 +471,8 @@ public:
 	/*virtual*/ LLDrawable* createDrawable(LLPipeline *pipeline);
 	/*virtual*/ BOOL		updateGeometry(LLDrawable *drawable);
 
-	void initSkyTextureDirs(const S32 side, const S32 tile);
-	void createSkyTexture(const S32 side, const S32 tile);
+	void initSkyTextureDirs(const S32 side);
+	void createSkyTexture();
 
 	LLColor4 calcSkyColorInDir(const LLVector3& dir, bool isShiny = false);
 	
@@ -553,13 +554,14 @@ public:
 protected:
 	~LLVOSky();
 
+	// Fills columns [begin, end) of the six cube sides, counted side by side.
+	void createSkyColumns(const LLSkyScatter& scatter, U32 begin, U32 end);
+
 	LLPointer<LLViewerFetchedTexture> mSunTexturep;
 	LLPointer<LLViewerFetchedTexture> mMoonTexturep;
 	LLPointer<LLViewerFetchedTexture> mBloomTexturep;
 
 	static S32			sResolution;
-	static S32			sTileResX;
-	static S32			sTileResY;
 	LLSkyTex			mSkyTex[6];
 	LLSkyTex			mShinyTex[6];
 	LLHeavenBody		mSun;
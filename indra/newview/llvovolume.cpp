@@ -77,6 +77,7 @@
 #include "llmediaentry.h"
 #include "llmediadataclient.h"
 #include "llmeshrepository.h"
+#include "llobjectupdatedata.h"
 #include "llagent.h"
 #include "llviewermediafocus.h"
 #include "lldatapacker.h"
@@ -310,13 +311,13 @@ void LLVOVolume::cleanupClass()
 U32 LLVOVolume::processUpdateMessage(LLMessageSystem *mesgsys,
 										  void **user_data,
 										  U32 block_num, EObjectUpdateType update_type,
-										  LLDataPacker *dp)
+										  const LLObjectUpdateData& update)
 {
 	LLColor4U color;
 	const S32 teDirtyBits = (TEM_CHANGE_TEXTURE|TEM_CHANGE_COLOR|TEM_CHANGE_MEDIA);
 
 	// Do base class updates...
-	U32 retval = LLViewerObject::processUpdateMessage(mesgsys, user_data, block_num, update_type, dp);
+	U32 retval = LLViewerObject::processUpdateMessage(mesgsys, user_data, block_num, update_type, update);
 
 	LLUUID sculpt_id;
 	U8 sculpt_type = 0;
@@ -327,7 +328,7 @@ U32 LLVOVolume::processUpdateMessage(LLMessageSystem *mesgsys,
 		sculpt_type = sculpt_params->getSculptType();
 	}
 
-	if (!dp)
+	if (!update.mCompressed)
 	{
 		if (update_type == OUT_FULL)
 		{
@@ -337,7 +338,7 @@ U32 LLVOVolume::processUpdateMessage(LLMessageSystem *mesgsys,
 			//
 			//
 
-			if (mesgsys->getSizeFast(_PREHASH_ObjectData, block_num, _PREHASH_TextureAnim))
+			if (update.mHasTextureAnim)
 			{
 				if (!mTextureAnimp)
 				{
@@ -352,7 +353,7 @@ U32 LLVOVolume::processUpdateMessage(LLMessageSystem *mesgsys,
 					}
 				}
 				
-				mTextureAnimp->unpackTAMessage(mesgsys, block_num);
+				mTextureAnimp->LLTextureAnim::operator=(update.mTextureAnim);
 			}
 			else
 			{
@@ -367,8 +368,7 @@ U32 LLVOVolume::processUpdateMessage(LLMessageSystem *mesgsys,
 			}
 
 			// Unpack volume data
-			LLVolumeParams volume_params;
-			LLVolumeMessage::unpackVolumeParams(&volume_params, mesgsys, _PREHASH_ObjectData, block_num);
+			LLVolumeParams volume_params = update.mVolumeParams;
 			volume_params.setSculptID(sculpt_id, sculpt_type);
 
 			if (setVolume(volume_params, 0))
@@ -383,39 +383,39 @@ U32 LLVOVolume::processUpdateMessage(LLMessageSystem *mesgsys,
 		// Unpack texture entry data
 		//
 
-		S32 result = unpackTEMessage(mesgsys, _PREHASH_ObjectData, (S32) block_num);
-		if (result & teDirtyBits)
+		if (update.mHasTEs)
 		{
-			updateTEData();
-		}
-		if (result & TEM_CHANGE_MEDIA)
-		{
-			retval |= MEDIA_FLAGS_CHANGED;
+			S32 result = applyParsedTEMessage(update.mTEs);
+			if (result & teDirtyBits)
+			{
+				updateTEData();
+			}
+			if (result & TEM_CHANGE_MEDIA)
+			{
+				retval |= MEDIA_FLAGS_CHANGED;
+			}
 		}
 	}
 	else
 	{
 		if (update_type != OUT_TERSE_IMPROVED)
 		{
-			LLVolumeParams volume_params;
-			BOOL res = LLVolumeMessage::unpackVolumeParams(&volume_params, *dp);
-			if (!res)
+			if (!update.mVolumeParamsValid)
 			{
 				LL_WARNS() << "Bogus volume parameters in object " << getID() << LL_ENDL;
 				LL_WARNS() << getRegion()->getOriginGlobal() << LL_ENDL;
 			}
 
+			LLVolumeParams volume_params = update.mVolumeParams;
 			volume_params.setSculptID(sculpt_id, sculpt_type);
 
 			if (setVolume(volume_params, 0))
 			{
 				markForUpdate(TRUE);
 			}
-			S32 res2 = unpackTEMessage(*dp);
-			if (TEM_INVALID == res2)
+			if (!update.mTEsValid)
 			{
 				// There's something bogus in the data that we're unpacking.
-				dp->dumpBufferToLog();
 				LL_WARNS() << "Flushing cache files" << LL_ENDL;
 
 				if(LLVOCache::hasInstance() && getRegion())
@@ -427,6 +427,7 @@ U32 LLVOVolume::processUpdateMessage(LLMessageSystem *mesgsys,
 			}
 			else 
 			{
+				S32 res2 = applyParsedTEMessage(update.mTEs);
 				if (res2 & teDirtyBits) 
 				{
 					updateTEData();
@@ -437,9 +438,7 @@ U32 LLVOVolume::processUpdateMessage(LLMessageSystem *mesgsys,
 				}
 			}
 
-			U32 value = dp->getPassFlags();
-
-			if (value & 0x40)
+			if (update.mHasTextureAnim)
 			{
 				if (!mTextureAnimp)
 				{
@@ -453,7 +452,7 @@ U32 LLVOVolume::processUpdateMessage(LLMessageSystem *mesgsys,
 					}
 				}
 				mTexAnimMode = 0;
-				mTextureAnimp->unpackTAMessage(*dp);
+				mTextureAnimp->LLTextureAnim::operator=(update.mTextureAnim);
 			}
 			else if (mTextureAnimp)
 			{
@@ -464,28 +463,19 @@ U32 LLVOVolume::processUpdateMessage(LLMessageSystem *mesgsys,
 				mTexAnimMode = 0;
 			}
 
-			if (value & 0x400)
-			{ //particle system (new)
-				unpackParticleSource(*dp, mOwnerID, false);
-			}
+			// The new style particle system went to the base class with
+			// the rest of the update.
 		}
-		else
+		else if (update.mHasTEs && update.mTEsValid)
 		{
-			S32 texture_length = mesgsys->getSizeFast(_PREHASH_ObjectData, block_num, _PREHASH_TextureEntry);
-			if (texture_length)
+			S32 result = applyParsedTEMessage(update.mTEs);
+			if (result & teDirtyBits)
 			{
-				U8							tdpbuffer[1024];
-				LLDataPackerBinaryBuffer	tdp(tdpbuffer, 1024);
-				mesgsys->getBinaryDataFast(_PREHASH_ObjectData, _PREHASH_TextureEntry, tdpbuffer, 0, block_num);
-				S32 result = unpackTEMessage(tdp);
-				if (result & teDirtyBits)
-				{
-					updateTEData();
-				}
-				if (result & TEM_CHANGE_MEDIA)
-				{
-					retval |= MEDIA_FLAGS_CHANGED;
-				}
+				updateTEData();
+			}
+			if (result & TEM_CHANGE_MEDIA)
+			{
+				retval |= MEDIA_FLAGS_CHANGED;
 			}
 		}
 	}
@@ -1219,6 +1209,31 @@ S32	LLVOVolume::computeLODDetail(F32 distance, F32 radius)
 	return cur_detail;
 }
 
+S32 LLVOVolume::calcLODDetail(F32 distance, F32 radius)
+{
+	distance *= sDistanceFactor;
+
+	F32 rampDist = LLVOVolume::sLODFactor * 2;
+	
+	if (distance < rampDist)
+	{
+		// Boost LOD when you're REALLY close
+		distance *= distance/rampDist;
+	}
+	
+	// DON'T Compensate for field of view changing on FOV zoom.
+	distance *= F_PI/3.f;
+
+	return computeLODDetail(ll_round(distance, 0.01f), 
+							ll_round(radius, 0.01f));
+}
+
+S32 LLVOVolume::calcLODAtDistance(F32 distance)
+{
+	F32 radius = getVolume() ? getVolume()->mLODScaleBias.scaledVec(getScale()).length() : getScale().length();
+	return calcLODDetail(distance, radius);
+}
+
 BOOL LLVOVolume::calcLOD()
 {
 	if (mDrawable.isNull())
@@ -1244,21 +1259,7 @@ BOOL LLVOVolume::calcLOD()
 	}
 	
 
-	distance *= sDistanceFactor;
-
-	F32 rampDist = LLVOVolume::sLODFactor * 2;
-	
-	if (distance < rampDist)
-	{
-		// Boost LOD when you're REALLY close
-		distance *= distance/rampDist;
-	}
-	
-	// DON'T Compensate for field of view changing on FOV zoom.
-	distance *= F_PI/3.f;
-
-	cur_detail = computeLODDetail(ll_round(distance, 0.01f), 
-									ll_round(radius, 0.01f));
+	cur_detail = calcLODDetail(distance, radius);
 
 
 	if (gPipeline.hasRenderDebugMask(LLPipeline::RENDER_DEBUG_LOD_INFO) &&
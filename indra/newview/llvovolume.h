@@ -184,7 +184,7 @@ public:
 	/*virtual*/ U32		processUpdateMessage(LLMessageSystem *mesgsys,
 											void **user_data,
 											U32 block_num, const EObjectUpdateType update_type,
-											LLDataPacker *dp);
+											const LLObjectUpdateData& update);
 
 	/*virtual*/ void	setSelected(BOOL sel);
 	/*virtual*/ BOOL	setDrawableParent(LLDrawable* parentp);
@@ -344,8 +344,13 @@ public:
 	//clear out rigged volume and revert back to non-rigged state for picking/LOD/distance updates
 	void clearRiggedVolume();
 
+	// Detail level calcLOD() would pick with the camera distance meters
+	// away, ignoring rigging.
+	S32 calcLODAtDistance(F32 distance);
+
 protected:
 	S32	computeLODDetail(F32	distance, F32 radius);
+	S32 calcLODDetail(F32 distance, F32 radius);
 	BOOL calcLOD();
 	LLFace* addFace(S32 face_index);
 	void updateTEData();
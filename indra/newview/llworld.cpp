@@ -887,6 +887,7 @@ void LLWorld::updateNetStats()
 	LLViewerStats::getInstance()->mKBitStat.addValue(bits/1024.f);
 	LLViewerStats::getInstance()->mPacketsInStat.addValue(packets_in);
 	LLViewerStats::getInstance()->mPacketsOutStat.addValue(packets_out);
+	LLViewerStats::getInstance()->mPacketSendCallsStat.addValue(gMessageSystem->mPacketRing.getAndResetSendCalls());
 	LLViewerStats::getInstance()->mPacketsLostStat.addValue(gMessageSystem->mDroppedPackets);
 	if (packets_in)
 	{
@@ -57,6 +57,7 @@
 // newview includes
 #include "llagent.h"
 #include "llagentcamera.h"
+#include "llavatarimpostorcache.h"
 #include "lldrawable.h"
 #include "lldrawpoolalpha.h"
 #include "lldrawpoolavatar.h"
@@ -1764,6 +1765,8 @@ void LLPipeline::resetFrameStats()
 	assertInitialized();
 
 	LLViewerStats::getInstance()->mTrianglesDrawnStat.addValue(mTrianglesDrawn/1000.f);
+	LLViewerStats::getInstance()->mSkinnedAvatarsStat.addValue(LLVOAvatar::sNumSkinnedAvatars);
+	LLViewerStats::getInstance()->mImpostorAvatarsStat.addValue(LLVOAvatar::sNumImpostorAvatars);
 
 	if (mBatchCount > 0)
 	{
@@ -10468,7 +10471,6 @@ static LLTrace::BlockTimerStatHandle FTM_IMPOSTOR_MARK_VISIBLE("Impostor Mark Vi
 static LLTrace::BlockTimerStatHandle FTM_IMPOSTOR_SETUP("Impostor Setup");
 static LLTrace::BlockTimerStatHandle FTM_IMPOSTOR_BACKGROUND("Impostor Background");
 static LLTrace::BlockTimerStatHandle FTM_IMPOSTOR_ALLOCATE("Impostor Allocate");
-static LLTrace::BlockTimerStatHandle FTM_IMPOSTOR_RESIZE("Impostor Resize");
 
 void LLPipeline::generateImpostor(LLVOAvatar* avatar)
 {
@@ -10487,6 +10489,75 @@ void LLPipeline::generateImpostor(LLVOAvatar* avatar)
 
 	assertInitialized();
 
+	LLViewerCamera* viewer_camera = LLViewerCamera::getInstance();
+	LLCamera camera = *viewer_camera;
+	LLVector2 tdim;
+	F32 fov;
+	LLAvatarImpostorCache* cache = LLAvatarImpostorCache::getInstance();
+	LLRenderTarget& atlas = cache->getTarget();
+	const LLAvatarImpostorCache::Slot* slot;
+
+	{
+		LL_RECORD_BLOCK_TIME(FTM_IMPOSTOR_ALLOCATE);
+		const LLVector4a* ext = avatar->mDrawable->getSpatialExtents();
+		LLVector3 pos(avatar->getRenderPosition()+avatar->getImpostorOffset());
+
+		camera.lookAt(viewer_camera->getOrigin(), pos, viewer_camera->getUpAxis());
+	
+		LLVector4a half_height;
+		half_height.setSub(ext[1], ext[0]);
+		half_height.mul(0.5f);
+
+		LLVector4a left;
+		left.load3(camera.getLeftAxis().mV);
+		left.mul(left);
+		llassert(left.dot3(left).getF32() > F_APPROXIMATELY_ZERO);
+		left.normalize3fast();
+
+		LLVector4a up;
+		up.load3(camera.getUpAxis().mV);
+		up.mul(up);
+		llassert(up.dot3(up).getF32() > F_APPROXIMATELY_ZERO);
+		up.normalize3fast();
+
+		tdim.mV[0] = fabsf(half_height.dot3(left).getF32());
+		tdim.mV[1] = fabsf(half_height.dot3(up).getF32());
+
+		F32 distance = (pos-camera.getOrigin()).length();
+		fov = atanf(tdim.mV[1]/distance)*2.f*RAD_TO_DEG;
+
+		// get the number of pixels per angle
+		F32 pa = gViewerWindow->getWindowHeightRaw() / (RAD_TO_DEG * viewer_camera->getView());
+
+		//get resolution based on angle width and height of impostor (double desired resolution to prevent aliasing)
+		U32 resY = llmin(nhpo2((U32) (fov*pa)), (U32) 512);
+		U32 resX = llmin(nhpo2((U32) (atanf(tdim.mV[0]/distance)*2.f*RAD_TO_DEG*pa)), (U32) 512);
+
+		slot = cache->acquireSlot(avatar, resX, resY);
+		if (!slot)
+		{ //atlas is full of what is on screen, try again next frame
+			return;
+		}
+
+		if (!atlas.isComplete())
+		{
+			U32 size = cache->getAtlasSize();
+			if (LLPipeline::sRenderDeferred)
+			{
+				atlas.allocate(size,size,GL_SRGB8_ALPHA8,TRUE,FALSE);
+				addDeferredAttachments(atlas);
+			}
+			else
+			{
+				atlas.allocate(size,size,GL_RGBA,TRUE,FALSE);
+			}
+		
+			gGL.getTexUnit(0)->bind(&atlas);
+			gGL.getTexUnit(0)->setTextureFilteringOption(LLTexUnit::TFO_POINT);
+			gGL.getTexUnit(0)->unbind(LLTexUnit::TT_TEXTURE);
+		}
+	}
+
 	bool visually_muted = avatar->isVisuallyMuted();		
 
 	pushRenderTypeMask();
@@ -10528,8 +10599,6 @@ void LLPipeline::generateImpostor(LLVOAvatar* avatar)
 	sShadowRender = TRUE;
 	sImpostorRender = TRUE;
 
-	LLViewerCamera* viewer_camera = LLViewerCamera::getInstance();
-
 	{
 		LL_RECORD_BLOCK_TIME(FTM_IMPOSTOR_MARK_VISIBLE);
 		markVisible(avatar->mDrawable, *viewer_camera);
@@ -10559,43 +10628,12 @@ void LLPipeline::generateImpostor(LLVOAvatar* avatar)
 	}
 
 	stateSort(*LLViewerCamera::getInstance(), result);
-	
-	LLCamera camera = *viewer_camera;
-	LLVector2 tdim;
-	U32 resY = 0;
-	U32 resX = 0;
 
 	{
 		LL_RECORD_BLOCK_TIME(FTM_IMPOSTOR_SETUP);
-		const LLVector4a* ext = avatar->mDrawable->getSpatialExtents();
-		LLVector3 pos(avatar->getRenderPosition()+avatar->getImpostorOffset());
-
-		camera.lookAt(viewer_camera->getOrigin(), pos, viewer_camera->getUpAxis());
-	
-		LLVector4a half_height;
-		half_height.setSub(ext[1], ext[0]);
-		half_height.mul(0.5f);
-
-		LLVector4a left;
-		left.load3(camera.getLeftAxis().mV);
-		left.mul(left);
-		llassert(left.dot3(left).getF32() > F_APPROXIMATELY_ZERO);
-		left.normalize3fast();
-
-		LLVector4a up;
-		up.load3(camera.getUpAxis().mV);
-		up.mul(up);
-		llassert(up.dot3(up).getF32() > F_APPROXIMATELY_ZERO);
-		up.normalize3fast();
-
-		tdim.mV[0] = fabsf(half_height.dot3(left).getF32());
-		tdim.mV[1] = fabsf(half_height.dot3(up).getF32());
-
 		gGL.matrixMode(LLRender::MM_PROJECTION);
 		gGL.pushMatrix();
 	
-		F32 distance = (pos-camera.getOrigin()).length();
-		F32 fov = atanf(tdim.mV[1]/distance)*2.f*RAD_TO_DEG;
 		F32 aspect = tdim.mV[0]/tdim.mV[1];
 		LLMatrix4a persp = gGL.genPersp(fov, aspect, 1.f, 256.f);
 		glh_set_current_projection(persp);
@@ -10614,42 +10652,15 @@ void LLPipeline::generateImpostor(LLVOAvatar* avatar)
 
 		glClearColor(0.0f,0.0f,0.0f,0.0f);
 		gGL.setColorMask(true, true);
-	
-		// get the number of pixels per angle
-		F32 pa = gViewerWindow->getWindowHeightRaw() / (RAD_TO_DEG * viewer_camera->getView());
-
-		//get resolution based on angle width and height of impostor (double desired resolution to prevent aliasing)
-		resY = llmin(nhpo2((U32) (fov*pa)), (U32) 512);
-		resX = llmin(nhpo2((U32) (atanf(tdim.mV[0]/distance)*2.f*RAD_TO_DEG*pa)), (U32) 512);
-
-		if (!avatar->mImpostor.isComplete())
-		{
-			LL_RECORD_BLOCK_TIME(FTM_IMPOSTOR_ALLOCATE);
-			
-
-			if (LLPipeline::sRenderDeferred)
-			{
-				avatar->mImpostor.allocate(resX,resY,GL_SRGB8_ALPHA8,TRUE,FALSE);
-				addDeferredAttachments(avatar->mImpostor);
-			}
-			else
-			{
-				avatar->mImpostor.allocate(resX,resY,GL_RGBA,TRUE,FALSE);
-			}
-		
-			gGL.getTexUnit(0)->bind(&avatar->mImpostor);
-			gGL.getTexUnit(0)->setTextureFilteringOption(LLTexUnit::TFO_POINT);
-			gGL.getTexUnit(0)->unbind(LLTexUnit::TT_TEXTURE);
-		}
-		else if(resX != avatar->mImpostor.getWidth() || resY != avatar->mImpostor.getHeight())
-		{
-			LL_RECORD_BLOCK_TIME(FTM_IMPOSTOR_RESIZE);
-			avatar->mImpostor.resize(resX,resY);
-		}
 
-		avatar->mImpostor.bindTarget();
+		atlas.bindTarget();
 	}
 
+	//only touch this avatar's cell of the atlas, clear included
+	glViewport(slot->mX, slot->mY, slot->mWidth, slot->mHeight);
+	LLGLEnable scissor(GL_SCISSOR_TEST);
+	glScissor(slot->mX, slot->mY, slot->mWidth, slot->mHeight);
+
 	F32 old_alpha = LLDrawPoolAvatar::sMinimumAlpha;
 
 	if (visually_muted)
@@ -10659,7 +10670,7 @@ void LLPipeline::generateImpostor(LLVOAvatar* avatar)
 
 	if (LLPipeline::sRenderDeferred)
 	{
-		avatar->mImpostor.clear();
+		atlas.clear();
 		renderGeomDeferred(camera);
 
 		renderGeomPostDeferred(camera);		
@@ -10681,9 +10692,7 @@ void LLPipeline::generateImpostor(LLVOAvatar* avatar)
 	}
 	else
 	{
-		LLGLEnable scissor(GL_SCISSOR_TEST);
-		glScissor(0, 0, resX, resY);
-		avatar->mImpostor.clear();
+		atlas.clear();
 		renderGeom(camera);
 
 		// Shameless hack time: render it all again,
@@ -10763,7 +10772,8 @@ void LLPipeline::generateImpostor(LLVOAvatar* avatar)
 		gGL.popMatrix();
 	}
 
-	avatar->mImpostor.flush();
+	scissor.disable();
+	atlas.flush();
 
 	avatar->setImpostorDim(tdim);
 
@@ -10781,6 +10791,7 @@ void LLPipeline::generateImpostor(LLVOAvatar* avatar)
 
 	avatar->mNeedsImpostorUpdate = FALSE;
 	avatar->cacheImpostorValues();
+	LLAvatarImpostorCache::instance().commitSlot(avatar);
 
 	LLVertexBuffer::unbind();
 	LLGLState::checkStates();
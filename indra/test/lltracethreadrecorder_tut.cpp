@@ -0,0 +1,137 @@
+/**
+ * @file lltracethreadrecorder_tut.cpp
+ * @brief Tests handing child thread trace data to the master recorder.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+
+#include "linden_common.h"
+#include "lltut.h"
+
+#include "llatomic.h"
+#include "llcommon.h"
+#include "llthread.h"
+#include "lltimer.h"
+#include "lltrace.h"
+#include "lltracerecording.h"
+#include "lltracethreadrecorder.h"
+
+static LLTrace::CountStatHandle<> sPushedCount("threadrecorder_tut_pushed");
+
+namespace
+{
+	// Pushes twice and exits before the master pulls either push.
+	class PushingThread : public LLThread
+	{
+	public:
+		PushingThread() : LLThread("PushingThread") {}
+
+		/*virtual*/ void run()
+		{
+			LLTrace::add(sPushedCount, 1);
+			LLTrace::get_thread_recorder()->pushToParent(true);
+			// The first push is still pending here.
+			LLTrace::add(sPushedCount, 2);
+			LLTrace::get_thread_recorder()->pushToParent(true);
+		}
+	};
+
+	// Pushes once, then stays alive until released.
+	class LiveThread : public LLThread
+	{
+	public:
+		LiveThread() : LLThread("LiveThread"), mPushed(0), mRelease(0) {}
+
+		/*virtual*/ void run()
+		{
+			LLTrace::add(sPushedCount, 5);
+			LLTrace::get_thread_recorder()->pushToParent(true);
+			mPushed = 1;
+			while (!mRelease)
+			{
+				ms_sleep(1);
+			}
+		}
+
+		LLAtomicU32 mPushed;
+		LLAtomicU32 mRelease;
+	};
+}
+
+namespace tut
+{
+	struct threadrecorder_test
+	{
+		threadrecorder_test()
+		{
+			if (!LLTrace::get_master_thread_recorder())
+			{
+				LLCommon::initClass();
+			}
+		}
+	};
+	typedef test_group<threadrecorder_test> threadrecorder_group_t;
+	typedef threadrecorder_group_t::object threadrecorder_object_t;
+	tut::threadrecorder_group_t threadrecorder_instance("threadrecorder");
+
+	template<> template<>
+	void threadrecorder_object_t::test<1>()
+	{
+		LLTrace::Recording recording;
+		recording.start();
+
+		PushingThread thread;
+		thread.start();
+		while (!thread.isStopped())
+		{
+			ms_sleep(1);
+		}
+
+		LLTrace::get_master_thread_recorder()->pullFromChildren();
+		recording.stop();
+		ensure_equals("both pushes of an exited thread arrive", recording.getSum(sPushedCount), 3.0);
+	}
+
+	template<> template<>
+	void threadrecorder_object_t::test<2>()
+	{
+		LLTrace::Recording recording;
+		recording.start();
+
+		LiveThread thread;
+		thread.start();
+		while (!thread.mPushed)
+		{
+			ms_sleep(1);
+		}
+
+		LLTrace::get_master_thread_recorder()->pullFromChildren();
+		recording.stop();
+		thread.mRelease = 1;
+		while (!thread.isStopped())
+		{
+			ms_sleep(1);
+		}
+		ensure_equals("push of a running thread arrives", recording.getSum(sPushedCount), 5.0);
+	}
+}
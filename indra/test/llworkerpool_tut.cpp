@@ -0,0 +1,181 @@
+/**
+ * @file llworkerpool_tut.cpp
+ * @brief Tests for LLWorkerPool.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+
+#include "linden_common.h"
+#include "lltut.h"
+
+#include <vector>
+
+#include <boost/bind.hpp>
+
+#include "llatomic.h"
+#include "llthread.h"
+#include "lltimer.h"
+#include "llworkerpool.h"
+
+namespace
+{
+	void count_range(std::vector<U32>* counts, U32 begin, U32 end)
+	{
+		for (U32 i = begin; i < end; ++i)
+		{
+			++(*counts)[i];
+		}
+	}
+
+	void add_one(LLAtomicU32* counter)
+	{
+		++(*counter);
+	}
+
+	// Holds a pool thread until released.
+	void hold(LLAtomicU32* started, LLAtomicU32* release)
+	{
+		++(*started);
+		while (!*release)
+		{
+			ms_sleep(1);
+		}
+	}
+
+	void hold_for(LLAtomicU32* started, LLAtomicU32* finished, U32 ms)
+	{
+		++(*started);
+		ms_sleep(ms);
+		++(*finished);
+	}
+
+	void record_thread(boost::thread::id* id, LLAtomicU32* done)
+	{
+		*id = LLThread::currentID();
+		++(*done);
+	}
+
+	// Spins until counter reaches value, for at most a few seconds.
+	bool wait_for(LLAtomicU32& counter, U32 value)
+	{
+		for (S32 i = 0; i < 5000 && counter < value; ++i)
+		{
+			ms_sleep(1);
+		}
+		return counter >= value;
+	}
+}
+
+namespace tut
+{
+	struct workerpool_test
+	{
+	};
+	typedef test_group<workerpool_test> workerpool_group_t;
+	typedef workerpool_group_t::object workerpool_object_t;
+	tut::workerpool_group_t workerpool_instance("workerpool");
+
+	template<> template<>
+	void workerpool_object_t::test<1>()
+	{
+		// Every index exactly once, whatever the grain and thread count.
+		const U32 thread_counts[] = { 0, 1, 4 };
+		const U32 grains[] = { 1, 7, 1000 };
+		for (S32 t = 0; t < 3; ++t)
+		{
+			LLWorkerPool pool("workerpool_tut", thread_counts[t]);
+			for (S32 g = 0; g < 3; ++g)
+			{
+				std::vector<U32> counts(997, 0);
+				pool.parallelFor((U32)counts.size(), grains[g], boost::bind(&count_range, &counts, _1, _2));
+				for (U32 i = 0; i < counts.size(); ++i)
+				{
+					ensure_equals("each index covered once", counts[i], 1U);
+				}
+			}
+		}
+	}
+
+	template<> template<>
+	void workerpool_object_t::test<2>()
+	{
+		// post() runs every job, inline without threads.
+		LLAtomicU32 counter(0);
+		{
+			LLWorkerPool inline_pool("workerpool_tut", 0);
+			inline_pool.post(boost::bind(&add_one, &counter));
+			ensure_equals("inline post runs at once", (U32)counter, 1U);
+		}
+
+		LLWorkerPool pool("workerpool_tut", 2);
+		for (S32 i = 0; i < 100; ++i)
+		{
+			pool.post(boost::bind(&add_one, &counter));
+		}
+		ensure("posted jobs all run", wait_for(counter, 101));
+	}
+
+	template<> template<>
+	void workerpool_object_t::test<3>()
+	{
+		// The parallelFor() caller runs its own chunks only, never a job
+		// post()ed ahead of them.
+		LLWorkerPool pool("workerpool_tut", 1);
+		LLAtomicU32 started(0);
+		LLAtomicU32 release(0);
+		LLAtomicU32 done(0);
+		boost::thread::id posted_id;
+		pool.post(boost::bind(&hold, &started, &release));
+		ensure("pool thread held", wait_for(started, 1));
+		pool.post(boost::bind(&record_thread, &posted_id, &done));
+
+		std::vector<U32> counts(64, 0);
+		pool.parallelFor((U32)counts.size(), 1, boost::bind(&count_range, &counts, _1, _2));
+		for (U32 i = 0; i < counts.size(); ++i)
+		{
+			ensure_equals("caller ran its whole batch", counts[i], 1U);
+		}
+		ensure_equals("queued job left to the pool", (U32)done, 0U);
+
+		release = 1;
+		ensure("queued job runs once the thread is free", wait_for(done, 1));
+		ensure("queued job ran on the pool thread", posted_id != LLThread::currentID());
+	}
+
+	template<> template<>
+	void workerpool_object_t::test<4>()
+	{
+		// Shutting down lets the running job finish and drops queued ones.
+		LLAtomicU32 started(0);
+		LLAtomicU32 finished(0);
+		LLAtomicU32 dropped(0);
+		{
+			LLWorkerPool pool("workerpool_tut", 1);
+			pool.post(boost::bind(&hold_for, &started, &finished, 50));
+			ensure("pool thread busy", wait_for(started, 1));
+			pool.post(boost::bind(&add_one, &dropped));
+		}
+		ensure_equals("running job finished", (U32)finished, 1U);
+		ensure_equals("queued job dropped", (U32)dropped, 0U);
+	}
+}
@@ -0,0 +1,172 @@
+/**
+ * @file bake_benchmark.cpp
+ * @brief Times software avatar bakes without a viewer or GL.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+
+
+// Composites a set of body regions shaped like a clothed avatar's (a skin base, a few clothing
+// layers with alpha params, and alpha masks) through LLTexLayerCompositor, and reports the time
+// per full set of regions three ways: the scalar reference on this thread, SIMD on this thread,
+// and SIMD across the shared LLWorkerPool.  The SIMD result is checked against the scalar one.
+//
+// Compare with the GL bakes of a real avatar by setting AvatarBakeVerifyCPU in the viewer.
+//
+// usage: bake_benchmark [iterations] [resolution]
+
+#include "linden_common.h"
+
+#include "llapr.h"
+#include "llerrorcontrol.h"
+#include "llimage.h"
+#include "lltexlayercompositor.h"
+#include "lltimer.h"
+#include "llworkerpool.h"
+
+#include <stdlib.h>
+#include <iostream>
+
+static const S32 DEFAULT_ITERATIONS = 10;
+static const S32 DEFAULT_RESOLUTION = 512;		// LLTexLayerSetInfo width of most regions
+static const S32 NUM_REGIONS = 6;
+static const S32 CLOTHING_LAYERS = 4;
+
+// Noise, so that nothing compresses into a fast path.
+static LLImageRaw* make_image(S32 size, S32 components)
+{
+	LLImageRaw* image = new LLImageRaw(size, size, components);
+	U8* data = image->getData();
+	for (S32 i = 0; i < size * size * components; ++i)
+	{
+		data[i] = (U8)(rand() & 0xff);
+	}
+	return image;
+}
+
+static LLTexLayerCompositor::bake_list_t make_bakes(S32 resolution)
+{
+	// Sources are mostly larger than the bake, as uploaded clothing usually is.
+	LLPointer<LLImageRaw> skin = make_image(resolution, 3);
+	LLPointer<LLImageRaw> clothing = make_image(resolution * 2, 4);
+	LLPointer<LLImageRaw> mask = make_image(resolution, 4);
+
+	LLTexLayerCompositor::bake_list_t bakes;
+	for (S32 region = 0; region < NUM_REGIONS; ++region)
+	{
+		// The eyes are a small region.
+		S32 size = region == 3 ? resolution / 4 : resolution;
+		LLTexLayerBake* bake = new LLTexLayerBake("region", size, size);
+		bake->fill(LLColor4(0.f, 0.f, 0.f, 1.f), LLTexLayerBake::BLEND_REPLACE, LLTexLayerBake::WRITE_ALL);
+		bake->fill(LLColor4(0.8f, 0.6f, 0.5f, 1.f), LLTexLayerBake::BLEND_ALPHA, LLTexLayerBake::WRITE_ALL);
+		bake->drawImage(skin, LLColor4::white, LLTexLayerBake::BLEND_ALPHA, LLTexLayerBake::WRITE_ALL,
+						LLTexLayerBake::MIN_ALPHA);
+		for (S32 layer = 0; layer < CLOTHING_LAYERS; ++layer)
+		{
+			// Morph masks: two alpha params and the texture's own alpha.
+			bake->fill(LLColor4(0.f, 0.f, 0.f, 0.f), LLTexLayerBake::BLEND_REPLACE, LLTexLayerBake::WRITE_ALPHA);
+			bake->fill(LLColor4(0.f, 0.f, 0.f, 0.7f), LLTexLayerBake::BLEND_ADD, LLTexLayerBake::WRITE_ALPHA);
+			bake->drawImage(mask, LLColor4::white, LLTexLayerBake::BLEND_MULT_ALPHA, LLTexLayerBake::WRITE_ALPHA);
+			bake->drawImage(clothing, LLColor4::white, LLTexLayerBake::BLEND_MULT_ALPHA, LLTexLayerBake::WRITE_ALPHA);
+			bake->drawImage(clothing, LLColor4(0.9f, 0.9f, 1.f, 1.f), LLTexLayerBake::BLEND_DEST_ALPHA,
+							LLTexLayerBake::WRITE_ALL, LLTexLayerBake::MIN_ALPHA);
+		}
+		bake->fill(LLColor4(0.f, 0.f, 0.f, 1.f), LLTexLayerBake::BLEND_REPLACE, LLTexLayerBake::WRITE_ALPHA);
+		bake->drawImage(mask, LLColor4::white, LLTexLayerBake::BLEND_MULT_ALPHA, LLTexLayerBake::WRITE_ALPHA);
+		bakes.push_back(bake);
+	}
+	return bakes;
+}
+
+static F64 time_bakes(const LLTexLayerCompositor::bake_list_t& bakes, LLWorkerPool* pool, S32 iterations)
+{
+	LLTimer timer;
+	for (S32 i = 0; i < iterations; ++i)
+	{
+		LLTexLayerCompositor::composite(bakes, pool);
+	}
+	return timer.getElapsedTimeF64() * 1000.0 / iterations;
+}
+
+static void report(const char* name, F64 ms, F64 reference_ms)
+{
+	std::cout << name << ": " << ms << " ms per avatar, " << reference_ms / ms << "x" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+	ll_init_apr();
+
+	LLError::initForApplication(".");
+	LLError::setDefaultLevel(LLError::LEVEL_WARN);
+
+	S32 iterations = DEFAULT_ITERATIONS;
+	S32 resolution = DEFAULT_RESOLUTION;
+	if (argc > 1)
+	{
+		iterations = llmax(atoi(argv[1]), 1);
+	}
+	if (argc > 2)
+	{
+		resolution = llmax(atoi(argv[2]), 16);
+	}
+
+	LLTexLayerCompositor::bake_list_t bakes = make_bakes(resolution);
+	LLWorkerPool serial("Bake Benchmark", 0);
+
+	LLTexLayerBake::sUseSIMD = false;
+	F64 scalar_ms = time_bakes(bakes, &serial, iterations);
+	std::vector<LLPointer<LLImageRaw> > reference;
+	for (U32 i = 0; i < bakes.size(); ++i)
+	{
+		// Composited again below; keep the scalar results.
+		LLImageRaw* result = bakes[i]->getResult();
+		reference.push_back(new LLImageRaw(result->getData(), result->getWidth(), result->getHeight(), 4));
+	}
+	report("scalar         ", scalar_ms, scalar_ms);
+
+	LLTexLayerBake::sUseSIMD = true;
+	report("SIMD           ", time_bakes(bakes, &serial, iterations), scalar_ms);
+
+	LLWorkerPool* pool = LLWorkerPool::getDefault();
+	std::cout << pool->getNumThreads() + 1 << " threads" << std::endl;
+	report("SIMD, pooled   ", time_bakes(bakes, pool, iterations), scalar_ms);
+
+	S32 max_diff = 0;
+	for (U32 i = 0; i < bakes.size(); ++i)
+	{
+		const LLImageRaw* result = bakes[i]->getResult();
+		const S32 size = result->getWidth() * result->getHeight() * 4;
+		for (S32 j = 0; j < size; ++j)
+		{
+			max_diff = llmax(max_diff, llabs((S32)result->getData()[j] - (S32)reference[i]->getData()[j]));
+		}
+	}
+	std::cout << "largest difference from scalar: " << max_diff << std::endl;
+
+	bakes.clear();
+	reference.clear();
+	LLWorkerPool::cleanupDefault();
+	ll_cleanup_apr();
+	return max_diff > 1 ? 1 : 0;
+}
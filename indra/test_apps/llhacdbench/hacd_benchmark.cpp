@@ -0,0 +1,280 @@
+/**
+ * @file hacd_benchmark.cpp
+ * @brief Times convex decomposition of COLLADA models without a viewer.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+// Decomposes the models of COLLADA files with HACD as the upload floater's Decompose button does,
+// and reports the time for all of them four ways: one model at a time on this thread, as
+// LLPhysicsDecomp used to; one model at a time with the cluster costs spread over the shared
+// LLWorkerPool; one model per thread of a pool of its own, as LLPhysicsDecomp does now; and both.
+// The hull counts of every run are checked against the first.
+//
+// usage: hacd_benchmark [-t threads] file.dae [file.dae ...]
+
+#include "linden_common.h"
+
+#include "llapr.h"
+#include "llconvexdecomposition.h"
+#include "lldaeloader.h"
+#include "llerrorcontrol.h"
+#include "lltimer.h"
+#include "llworkerpool.h"
+
+#include <boost/bind.hpp>
+#include <stdlib.h>
+#include <string.h>
+#include <iostream>
+
+static const U32 DEFAULT_MODEL_THREADS = 4;		// MAX_DECOMP_THREADS in the viewer
+static const U32 MODEL_LIMIT = 768;				// ImporterModelLimit
+
+struct DecompMesh
+{
+	std::string				mLabel;
+	std::vector<LLVector3>	mPositions;
+	std::vector<U16>		mIndices;
+	S32						mDecompID;
+	S32						mHulls;
+};
+typedef std::vector<DecompMesh> mesh_list_t;
+
+// Same as LLPhysicsDecomp::JobRunner.
+class BenchJobRunner : public ndConvexDecompositionJobRunner
+{
+public:
+	BenchJobRunner(LLWorkerPool* pool)
+	:	mPool(pool)
+	{
+	}
+
+	/*virtual*/ void run(size_t count, void (*job)(void*, size_t), void* data)
+	{
+		U32 grain = llmax((U32)count / ((mPool->getNumThreads() + 1) * 4), 1U);
+		mPool->parallelFor((U32)count, grain, boost::bind(&BenchJobRunner::runRange, job, data, _1, _2));
+	}
+
+private:
+	static void runRange(void (*job)(void*, size_t), void* data, U32 begin, U32 end)
+	{
+		for (U32 i = begin; i < end; ++i)
+		{
+			job(data, i);
+		}
+	}
+
+	LLWorkerPool* mPool;
+};
+
+static void loaded(LLModelLoader::scene&, LLModelLoader::model_list&, S32, void*)
+{
+}
+
+static LLJoint* lookup_joint(const std::string&, void*)
+{
+	return NULL;
+}
+
+static U32 load_texture(LLImportMaterial&, void*)
+{
+	return 0;
+}
+
+static void state_changed(U32, void*)
+{
+}
+
+// Copies out the faces of every model the way LLPhysicsDecomp::Request::assignData() does,
+// leaving out the faces that would overflow 16 bit indices.
+static bool load_meshes(const std::string& filename, mesh_list_t& meshes)
+{
+	JointTransformMap joint_transforms;
+	JointSet joints_from_nodes;
+	LLDAELoader loader(filename, LLModel::LOD_PHYSICS, &loaded, &lookup_joint, &load_texture, &state_changed,
+					   NULL, joint_transforms, joints_from_nodes, MODEL_LIMIT, true);
+	if (!loader.OpenFile(filename))
+	{
+		return false;
+	}
+
+	for (LLModelLoader::model_list::iterator iter = loader.mModelList.begin(); iter != loader.mModelList.end(); ++iter)
+	{
+		LLModel* model = *iter;
+		DecompMesh mesh;
+		mesh.mLabel = model->mLabel;
+		mesh.mDecompID = -1;
+		mesh.mHulls = 0;
+		for (S32 i = 0; i < model->getNumVolumeFaces(); ++i)
+		{
+			const LLVolumeFace& face = model->getVolumeFace(i);
+			if (mesh.mPositions.size() + face.mNumVertices > 65535)
+			{
+				continue;
+			}
+			U16 index_offset = (U16)mesh.mPositions.size();
+			for (S32 j = 0; j < face.mNumVertices; ++j)
+			{
+				mesh.mPositions.push_back(LLVector3(face.mPositions[j].getF32ptr()));
+			}
+			for (S32 j = 0; j + 2 < face.mNumIndices; j += 3)
+			{
+				mesh.mIndices.push_back(face.mIndices[j] + index_offset);
+				mesh.mIndices.push_back(face.mIndices[j + 1] + index_offset);
+				mesh.mIndices.push_back(face.mIndices[j + 2] + index_offset);
+			}
+		}
+		if (mesh.mPositions.size() > 2 && mesh.mIndices.size() > 2)
+		{
+			meshes.push_back(mesh);
+		}
+	}
+	return true;
+}
+
+static void decompose(DecompMesh* mesh)
+{
+	LLConvexDecomposition* decomp = LLConvexDecomposition::getInstance();
+	decomp->bindDecomposition(mesh->mDecompID);
+
+	LLCDMeshData data;
+	data.mVertexBase = mesh->mPositions[0].mV;
+	data.mVertexStrideBytes = 12;
+	data.mNumVertices = mesh->mPositions.size();
+	data.mIndexType = LLCDMeshData::INT_16;
+	data.mIndexBase = &mesh->mIndices[0];
+	data.mIndexStrideBytes = 6;
+	data.mNumTriangles = mesh->mIndices.size() / 3;
+
+	mesh->mHulls = 0;
+	if (decomp->setMeshData(&data, false) == LLCD_OK && decomp->executeStage(0) == LLCD_OK)
+	{
+		mesh->mHulls = decomp->getNumHullsFromStage(0);
+	}
+}
+
+static void decompose_range(mesh_list_t* meshes, U32 begin, U32 end)
+{
+	for (U32 i = begin; i < end; ++i)
+	{
+		decompose(&(*meshes)[i]);
+	}
+}
+
+static F64 time_decompositions(mesh_list_t& meshes, LLWorkerPool* model_pool, ndConvexDecompositionJobRunner* runner)
+{
+	dynamic_cast<ndConvexDecompositionParallel*>(LLConvexDecomposition::getInstance())->setJobRunner(runner);
+	LLTimer timer;
+	model_pool->parallelFor((U32)meshes.size(), 1, boost::bind(&decompose_range, &meshes, _1, _2));
+	return timer.getElapsedTimeF64() * 1000.0;
+}
+
+static U32 check_hulls(const mesh_list_t& meshes, const std::vector<S32>& reference)
+{
+	U32 mismatches = 0;
+	for (U32 i = 0; i < meshes.size(); ++i)
+	{
+		if (meshes[i].mHulls != reference[i])
+		{
+			std::cout << "  " << meshes[i].mLabel << ": " << meshes[i].mHulls << " hulls, expected "
+					  << reference[i] << std::endl;
+			++mismatches;
+		}
+	}
+	return mismatches;
+}
+
+static void report(const char* name, F64 ms, F64 reference_ms)
+{
+	std::cout << name << ": " << ms << " ms, " << reference_ms / ms << "x" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+	ll_init_apr();
+
+	LLError::initForApplication(".");
+	LLError::setDefaultLevel(LLError::LEVEL_WARN);
+
+	U32 model_threads = DEFAULT_MODEL_THREADS;
+	mesh_list_t meshes;
+	for (S32 i = 1; i < argc; ++i)
+	{
+		if (!strcmp(argv[i], "-t") && i + 1 < argc)
+		{
+			model_threads = llmax(atoi(argv[++i]), 1);
+		}
+		else if (!load_meshes(argv[i], meshes))
+		{
+			std::cerr << "Could not load " << argv[i] << std::endl;
+		}
+	}
+	if (meshes.empty())
+	{
+		std::cerr << "usage: hacd_benchmark [-t threads] file.dae [file.dae ...]" << std::endl;
+		ll_cleanup_apr();
+		return 1;
+	}
+
+	LLConvexDecomposition::initSystem();
+	LLConvexDecomposition* decomp = LLConvexDecomposition::getInstance();
+	U32 triangles = 0;
+	for (U32 i = 0; i < meshes.size(); ++i)
+	{
+		decomp->genDecomposition(meshes[i].mDecompID);
+		triangles += meshes[i].mIndices.size() / 3;
+	}
+	std::cout << meshes.size() << " models, " << triangles << " triangles" << std::endl;
+
+	LLWorkerPool serial("HACD Benchmark", 0);
+	LLWorkerPool models("HACD Models", model_threads);
+	BenchJobRunner runner(LLWorkerPool::getDefault());
+	std::cout << model_threads << " model threads, " << LLWorkerPool::getDefault()->getNumThreads() + 1
+			  << " cluster threads" << std::endl;
+
+	F64 serial_ms = time_decompositions(meshes, &serial, NULL);
+	std::vector<S32> reference;
+	for (U32 i = 0; i < meshes.size(); ++i)
+	{
+		reference.push_back(meshes[i].mHulls);
+	}
+	report("one at a time          ", serial_ms, serial_ms);
+
+	U32 mismatches = 0;
+	report("clusters pooled        ", time_decompositions(meshes, &serial, &runner), serial_ms);
+	mismatches += check_hulls(meshes, reference);
+	report("models pooled          ", time_decompositions(meshes, &models, NULL), serial_ms);
+	mismatches += check_hulls(meshes, reference);
+	report("models, clusters pooled", time_decompositions(meshes, &models, &runner), serial_ms);
+	mismatches += check_hulls(meshes, reference);
+
+	dynamic_cast<ndConvexDecompositionParallel*>(decomp)->setJobRunner(NULL);
+	for (U32 i = 0; i < meshes.size(); ++i)
+	{
+		decomp->deleteDecomposition(meshes[i].mDecompID);
+	}
+	LLConvexDecomposition::quitSystem();
+
+	LLWorkerPool::cleanupDefault();
+	ll_cleanup_apr();
+	return mismatches ? 1 : 0;
+}
@@ -0,0 +1,326 @@
+/**
+ * @file mesh_decode_benchmark.cpp
+ * @brief Times decoding of mesh asset LODs without a viewer.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+
+// Decodes every LOD of a corpus of mesh assets two ways and reports the throughput of each in
+// MB/s of compressed asset: through an LLSD, as LLVolume::unpackVolumeFaces used to, and
+// straight from the inflated block into the face buffers, as it does now. Inflating alone is
+// timed as well, since both pay for it. The faces of the two decodes are checked to match.
+//
+// Assets are read whole from files, laid out as the mesh repository stores them: the binary
+// LLSD header followed by the LOD blocks. Without files, -g generates a corpus of prims.
+//
+// usage: mesh_decode_benchmark [-i iterations] [-g assets] [file ...]
+
+#include "linden_common.h"
+
+#include "llapr.h"
+#include "llerrorcontrol.h"
+#include "llmodel.h"
+#include "llsdserialize.h"
+#include "lltimer.h"
+#include "llvolume.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+static const S32 DEFAULT_ITERATIONS = 20;
+static const S32 DEFAULT_GENERATED = 64;
+
+static const char* LOD_NAMES[] =
+{
+	"lowest_lod",
+	"low_lod",
+	"medium_lod",
+	"high_lod",
+};
+
+struct LODBlock
+{
+	std::string				mSource;
+	std::string				mData;			// compressed
+	LLPointer<LLVolume>		mLLSDVolume;
+	LLPointer<LLVolume>		mDirectVolume;
+};
+typedef std::vector<LODBlock> block_list_t;
+
+static LLVolumeParams mesh_params()
+{
+	LLVolumeParams params;
+	params.setType(LL_PCODE_PROFILE_SQUARE, LL_PCODE_PATH_LINE);
+	LLUUID id;
+	id.generate();
+	params.setSculptID(id, LL_SCULPT_TYPE_MESH);
+	return params;
+}
+
+static void add_blocks(const std::string& source, const std::string& asset, block_list_t& blocks)
+{
+	std::istringstream stream(asset);
+	LLSD header;
+	if (LLSDSerialize::fromBinary(header, stream, asset.size()) <= 0)
+	{
+		std::cerr << source << ": no mesh header" << std::endl;
+		return;
+	}
+	size_t header_size = (size_t)stream.tellg();
+
+	LLVolumeParams params = mesh_params();
+	for (U32 i = 0; i < LL_ARRAY_SIZE(LOD_NAMES); ++i)
+	{
+		S32 offset = header[LOD_NAMES[i]]["offset"].asInteger();
+		S32 size = header[LOD_NAMES[i]]["size"].asInteger();
+		if (offset < 0 || size <= 0 || header_size + offset + size > asset.size())
+		{
+			continue;
+		}
+		LODBlock block;
+		block.mSource = source + " " + LOD_NAMES[i];
+		block.mData = asset.substr(header_size + offset, size);
+		block.mLLSDVolume = new LLVolume(params, 0.f);
+		block.mDirectVolume = new LLVolume(params, 0.f);
+		blocks.push_back(block);
+	}
+}
+
+static bool load_asset(const std::string& filename, block_list_t& blocks)
+{
+	std::ifstream file(filename.c_str(), std::ios::binary);
+	if (!file)
+	{
+		return false;
+	}
+	std::stringstream asset;
+	asset << file.rdbuf();
+	add_blocks(filename, asset.str(), blocks);
+	return true;
+}
+
+// Writes prims at the four LOD details the way the upload floater writes models.
+static void generate_assets(S32 count, block_list_t& blocks)
+{
+	static const U8 SHAPES[][2] =
+	{
+		{ LL_PCODE_PROFILE_CIRCLE_HALF, LL_PCODE_PATH_CIRCLE },		// sphere
+		{ LL_PCODE_PROFILE_CIRCLE, LL_PCODE_PATH_CIRCLE },			// torus
+		{ LL_PCODE_PROFILE_CIRCLE, LL_PCODE_PATH_LINE },			// cylinder
+		{ LL_PCODE_PROFILE_SQUARE, LL_PCODE_PATH_LINE },			// box
+	};
+	static const F32 DETAILS[] = { 1.f, 1.5f, 2.5f, 4.f };
+
+	for (S32 i = 0; i < count; ++i)
+	{
+		LLVolumeParams params;
+		params.setType(SHAPES[i % LL_ARRAY_SIZE(SHAPES)][0], SHAPES[i % LL_ARRAY_SIZE(SHAPES)][1]);
+		params.setHollow((F32)(i / LL_ARRAY_SIZE(SHAPES) % 4) * 0.2f);
+
+		LLPointer<LLModel> lods[LL_ARRAY_SIZE(DETAILS)];
+		for (U32 j = 0; j < LL_ARRAY_SIZE(DETAILS); ++j)
+		{
+			lods[j] = new LLModel(params, DETAILS[j]);
+		}
+
+		std::ostringstream asset;
+		LLModel::writeModel(asset, NULL, lods[3], lods[2], lods[1], lods[0], LLModel::Decomposition(), FALSE, FALSE);
+
+		std::ostringstream name;
+		name << "generated " << i;
+		add_blocks(name.str(), asset.str(), blocks);
+	}
+}
+
+static F64 time_inflate(const block_list_t& blocks, S32 iterations, U64& inflated_bytes)
+{
+	std::vector<U8> inflated;
+	LLTimer timer;
+	for (S32 i = 0; i < iterations; ++i)
+	{
+		inflated_bytes = 0;
+		for (U32 j = 0; j < blocks.size(); ++j)
+		{
+			std::istringstream stream(blocks[j].mData);
+			unzip_llsd_binary(inflated, stream, blocks[j].mData.size());
+			inflated_bytes += inflated.size();
+		}
+	}
+	return timer.getElapsedTimeF64();
+}
+
+static F64 time_llsd(block_list_t& blocks, S32 iterations, U32& failures)
+{
+	LLTimer timer;
+	for (S32 i = 0; i < iterations; ++i)
+	{
+		failures = 0;
+		for (U32 j = 0; j < blocks.size(); ++j)
+		{
+			std::istringstream stream(blocks[j].mData);
+			LLSD mdl;
+			if (!unzip_llsd(mdl, stream, blocks[j].mData.size())
+				|| !blocks[j].mLLSDVolume->unpackVolumeFacesLLSD(mdl))
+			{
+				++failures;
+			}
+		}
+	}
+	return timer.getElapsedTimeF64();
+}
+
+static F64 time_direct(block_list_t& blocks, S32 iterations, U32& failures)
+{
+	LLTimer timer;
+	for (S32 i = 0; i < iterations; ++i)
+	{
+		failures = 0;
+		for (U32 j = 0; j < blocks.size(); ++j)
+		{
+			std::istringstream stream(blocks[j].mData);
+			if (!blocks[j].mDirectVolume->unpackVolumeFaces(stream, blocks[j].mData.size()))
+			{
+				++failures;
+			}
+		}
+	}
+	return timer.getElapsedTimeF64();
+}
+
+template <class T>
+static bool same_array(const T* a, const T* b, S32 count)
+{
+	return count <= 0 || (a && b && !memcmp(a, b, count * sizeof(T)));
+}
+
+static bool same_faces(const LLVolume* a, const LLVolume* b)
+{
+	if (a->getNumVolumeFaces() != b->getNumVolumeFaces())
+	{
+		return false;
+	}
+	for (S32 i = 0; i < a->getNumVolumeFaces(); ++i)
+	{
+		const LLVolumeFace& fa = a->getVolumeFace(i);
+		const LLVolumeFace& fb = b->getVolumeFace(i);
+		if (fa.mNumVertices != fb.mNumVertices || fa.mNumIndices != fb.mNumIndices
+			|| !same_array(fa.mPositions, fb.mPositions, fa.mNumVertices)
+			|| !same_array(fa.mNormals, fb.mNormals, fa.mNormals ? fa.mNumVertices : 0)
+			|| !same_array(fa.mTexCoords, fb.mTexCoords, fa.mTexCoords ? fa.mNumVertices : 0)
+			|| !same_array(fa.mIndices, fb.mIndices, fa.mNumIndices)
+			|| !same_array(fa.mWeights, fb.mWeights, fa.mWeights ? fa.mNumVertices : 0))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+static void report(const char* name, F64 seconds, U64 compressed_bytes, S32 iterations, F64 reference_seconds)
+{
+	F64 mb = (F64)compressed_bytes * iterations / (1024.0 * 1024.0);
+	std::cout << name << ": " << seconds * 1000.0 / iterations << " ms per pass, " << mb / seconds << " MB/s";
+	if (reference_seconds > 0.0)
+	{
+		std::cout << ", " << reference_seconds / seconds << "x";
+	}
+	std::cout << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+	ll_init_apr();
+
+	LLError::initForApplication(".");
+	LLError::setDefaultLevel(LLError::LEVEL_WARN);
+
+	S32 iterations = DEFAULT_ITERATIONS;
+	S32 generated = 0;
+	block_list_t blocks;
+	for (S32 i = 1; i < argc; ++i)
+	{
+		if (!strcmp(argv[i], "-i") && i + 1 < argc)
+		{
+			iterations = llmax(atoi(argv[++i]), 1);
+		}
+		else if (!strcmp(argv[i], "-g") && i + 1 < argc)
+		{
+			generated = llmax(atoi(argv[++i]), 1);
+		}
+		else if (!load_asset(argv[i], blocks))
+		{
+			std::cerr << "Could not load " << argv[i] << std::endl;
+		}
+	}
+	if (blocks.empty() && !generated)
+	{
+		generated = DEFAULT_GENERATED;
+	}
+	generate_assets(generated, blocks);
+	if (blocks.empty())
+	{
+		std::cerr << "usage: mesh_decode_benchmark [-i iterations] [-g assets] [file ...]" << std::endl;
+		ll_cleanup_apr();
+		return 1;
+	}
+
+	U64 compressed_bytes = 0;
+	for (U32 i = 0; i < blocks.size(); ++i)
+	{
+		compressed_bytes += blocks[i].mData.size();
+	}
+
+	U64 inflated_bytes = 0;
+	U32 llsd_failures = 0;
+	U32 direct_failures = 0;
+	F64 inflate_seconds = time_inflate(blocks, iterations, inflated_bytes);
+	F64 llsd_seconds = time_llsd(blocks, iterations, llsd_failures);
+	F64 direct_seconds = time_direct(blocks, iterations, direct_failures);
+
+	std::cout << blocks.size() << " LOD blocks, " << compressed_bytes / 1024 << " KB compressed, "
+			  << inflated_bytes / 1024 << " KB inflated, " << iterations << " passes" << std::endl;
+	report("inflate only  ", inflate_seconds, compressed_bytes, iterations, 0.0);
+	report("through LLSD  ", llsd_seconds, compressed_bytes, iterations, llsd_seconds);
+	report("direct        ", direct_seconds, compressed_bytes, iterations, llsd_seconds);
+
+	U32 mismatches = 0;
+	for (U32 i = 0; i < blocks.size(); ++i)
+	{
+		if (!same_faces(blocks[i].mLLSDVolume, blocks[i].mDirectVolume))
+		{
+			std::cout << "  " << blocks[i].mSource << ": faces differ" << std::endl;
+			++mismatches;
+		}
+	}
+	if (llsd_failures || direct_failures)
+	{
+		std::cout << llsd_failures << " LLSD and " << direct_failures << " direct decodes failed" << std::endl;
+	}
+
+	blocks.clear();
+	ll_cleanup_apr();
+	return mismatches || llsd_failures != direct_failures ? 1 : 0;
+}
@@ -0,0 +1,213 @@
+/**
+ * @file plugin_pipe_benchmark.cpp
+ * @brief Loopback throughput test for LLPluginMessagePipe in both message formats.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+
+// Pushes messages shaped like the example media plugin's traffic through a pair of LLPluginMessagePipes
+// connected over a loopback socket, and reports messages per second for XML and binary LLSD.
+// The "host" end sends mouse events; the "plugin" end parses each one and answers with an "updated"
+// message, as the example plugin does when it redraws.  Both ends parse everything they receive.
+//
+// usage: plugin_pipe_benchmark [message_count]
+
+#include "linden_common.h"
+
+#include "llapr.h"
+#include "llerrorcontrol.h"
+#include "llhost.h"
+#include "llpluginmessage.h"
+#include "llpluginmessageclasses.h"
+#include "llpluginmessagepipe.h"
+#include "lltimer.h"
+
+#include <stdlib.h>
+#include <iostream>
+
+static const S32 DEFAULT_MESSAGE_COUNT = 100000;
+// Messages allowed in flight before the host waits for replies, so that this measures throughput and
+// not the socket round trip.
+static const S32 WINDOW_SIZE = 64;
+
+class BenchmarkEnd : public LLPluginMessagePipeOwner
+{
+	LOG_CLASS(BenchmarkEnd);
+public:
+	BenchmarkEnd(LLPluginMessage::EFormat format, bool echo)
+	:	mFormat(format),
+		mEcho(echo),
+		mReceived(0),
+		mBytesSent(0)
+	{
+	}
+
+	void send(const LLPluginMessage &message)
+	{
+		std::string buffer = message.generate(mFormat);
+		mBytesSent += buffer.size();
+		writeMessageRaw(buffer);
+	}
+
+	/* virtual */ void receiveMessageRaw(const std::string &message)
+	{
+		LLPluginMessage parsed;
+		if(parsed.parse(message) < 0)
+		{
+			LL_ERRS("plugin_pipe_benchmark") << "failed to parse message" << LL_ENDL;
+		}
+		++mReceived;
+
+		if(mEcho)
+		{
+			LLPluginMessage reply(LLPLUGIN_MESSAGE_CLASS_MEDIA, "updated");
+			reply.setValueS32("left", parsed.getValueS32("x"));
+			reply.setValueS32("top", parsed.getValueS32("y"));
+			reply.setValueS32("right", parsed.getValueS32("x") + 64);
+			reply.setValueS32("bottom", parsed.getValueS32("y") + 64);
+			send(reply);
+		}
+	}
+
+	/* virtual */ apr_status_t socketError(apr_status_t error)
+	{
+		LL_ERRS("plugin_pipe_benchmark") << "socket error " << error << LL_ENDL;
+		return error;
+	}
+
+	LLPluginMessagePipe *getPipe() { return mMessagePipe; }
+
+	LLPluginMessage::EFormat mFormat;
+	bool mEcho;
+	S32 mReceived;
+	size_t mBytesSent;
+};
+
+// Opens a listening socket on an ephemeral loopback port, the same way LLPluginProcessParent does.
+static LLSocket::ptr_t listen_on_loopback(U16 &port)
+{
+	LLSocket::ptr_t listen_socket = LLSocket::create(gAPRPoolp, LLSocket::STREAM_TCP);
+	apr_sockaddr_t* addr = NULL;
+	apr_sockaddr_t* bound_addr = NULL;
+	if(!listen_socket
+	   || ll_apr_warn_status(apr_sockaddr_info_get(&addr, "127.0.0.1", APR_INET, 0, 0, gAPRPoolp))
+	   || ll_apr_warn_status(apr_socket_bind(listen_socket->getSocket(), addr))
+	   || ll_apr_warn_status(apr_socket_addr_get(&bound_addr, APR_LOCAL, listen_socket->getSocket()))
+	   || ll_apr_warn_status(apr_socket_listen(listen_socket->getSocket(), 1)))
+	{
+		return LLSocket::ptr_t();
+	}
+	port = bound_addr->port;
+	return listen_socket;
+}
+
+static bool run(LLPluginMessage::EFormat format, S32 message_count)
+{
+	U16 port = 0;
+	LLSocket::ptr_t listen_socket = listen_on_loopback(port);
+	if(!listen_socket)
+	{
+		return false;
+	}
+
+	LLSocket::ptr_t plugin_socket = LLSocket::create(gAPRPoolp, LLSocket::STREAM_TCP);
+	if(!plugin_socket->blockingConnect(LLHost("127.0.0.1", port)))
+	{
+		return false;
+	}
+
+	// LLSocket takes ownership of the pool, as in LLPluginProcessParent::accept().
+	apr_socket_t *accepted = NULL;
+	apr_pool_t *accepted_pool = NULL;
+	apr_pool_create(&accepted_pool, gAPRPoolp);
+	if(ll_apr_warn_status(apr_socket_accept(&accepted, listen_socket->getSocket(), accepted_pool)))
+	{
+		apr_pool_destroy(accepted_pool);
+		return false;
+	}
+	LLSocket::ptr_t host_socket = LLSocket::create(accepted, accepted_pool);
+
+	BenchmarkEnd host(format, false);
+	BenchmarkEnd plugin(format, true);
+	new LLPluginMessagePipe(&host, host_socket);
+	new LLPluginMessagePipe(&plugin, plugin_socket);
+
+	LLTimer timer;
+	S32 sent = 0;
+	while(host.mReceived < message_count)
+	{
+		while(sent < message_count && sent - host.mReceived < WINDOW_SIZE)
+		{
+			LLPluginMessage message(LLPLUGIN_MESSAGE_CLASS_MEDIA, "mouse_event");
+			message.setValue("event", "move");
+			message.setValueS32("button", 0);
+			message.setValueS32("x", sent % 1024);
+			message.setValueS32("y", (sent / 1024) % 1024);
+			message.setValue("modifiers", "");
+			host.send(message);
+			++sent;
+		}
+
+		if(!host.getPipe()->pumpOutput()
+		   || !plugin.getPipe()->pump()
+		   || !host.getPipe()->pumpInput())
+		{
+			return false;
+		}
+	}
+	F64 seconds = timer.getElapsedTimeF64();
+
+	// Each round trip is two messages.
+	std::cout << (format == LLPluginMessage::FORMAT_BINARY ? "binary" : "xml   ")
+			  << ": " << message_count * 2 << " messages in " << seconds << " s, "
+			  << (S32)((message_count * 2) / seconds) << " messages/s, "
+			  << (host.mBytesSent + plugin.mBytesSent) / (message_count * 2) << " bytes/message"
+			  << std::endl;
+
+	// The pipes are deleted along with their owners.
+	return true;
+}
+
+int main(int argc, char **argv)
+{
+	ll_init_apr();
+
+	LLError::initForApplication(".");
+	LLError::setDefaultLevel(LLError::LEVEL_WARN);
+
+	S32 message_count = DEFAULT_MESSAGE_COUNT;
+	if(argc > 1)
+	{
+		message_count = llmax(atoi(argv[1]), 1);
+	}
+
+	bool success = run(LLPluginMessage::FORMAT_XML, message_count)
+				   && run(LLPluginMessage::FORMAT_BINARY, message_count);
+	if(!success)
+	{
+		std::cerr << "loopback connection failed" << std::endl;
+	}
+
+	ll_cleanup_apr();
+	return success ? 0 : 1;
+}
@@ -0,0 +1,179 @@
+/**
+ * @file sky_cube_benchmark.cpp
+ * @brief Times a full rebuild of the sky cube maps without a viewer or GL.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+
+// Evaluates every texel of the six sky cube sides the way LLVOSky::createSkyTexture() does, and reports
+// the time per full cube three ways: one direction per call, batched by column on this thread, and
+// batched across the shared LLWorkerPool.  Sky parameters are those of a clear midday.
+//
+// usage: sky_cube_benchmark [iterations] [resolution]
+
+#include "linden_common.h"
+
+#include "llapr.h"
+#include "llerrorcontrol.h"
+#include "llskyscatter.h"
+#include "lltimer.h"
+#include "llworkerpool.h"
+
+#include <boost/bind.hpp>
+#include <stdlib.h>
+#include <iostream>
+#include <vector>
+
+static const S32 DEFAULT_ITERATIONS = 100;
+static const S32 DEFAULT_RESOLUTION = 64;		// LLSkyTex::sResolution
+static const F64 FRAME_BUDGET_MS = 1000.0 / 60.0;
+
+struct SkyCube
+{
+	SkyCube(S32 res)
+	:	mResolution(res),
+		mDirs(6 * res * res),
+		mSky(6 * res * res),
+		mShiny(6 * res * res)
+	{
+		// Same layout as LLVOSky::initSkyTextureDirs().
+		F32 inv_res = 1.f / res;
+		for (S32 side = 0; side < 6; ++side)
+		{
+			F32 coeff[3] = { 0.f, 0.f, 0.f };
+			const S32 curr_coef = side >> 1;
+			const S32 x_coef = (curr_coef + 1) % 3;
+			const S32 y_coef = (x_coef + 1) % 3;
+			coeff[curr_coef] = (F32)(((side & 1) << 1) - 1);
+			for (S32 x = 0; x < res; ++x)
+			{
+				for (S32 y = 0; y < res; ++y)
+				{
+					coeff[x_coef] = F32((x << 1) + 1) * inv_res - 1.f;
+					coeff[y_coef] = F32((y << 1) + 1) * inv_res - 1.f;
+					LLVector3 dir(coeff[0], coeff[1], coeff[2]);
+					dir.normalize();
+					mDirs[(side * res + x) * res + y] = dir;
+				}
+			}
+		}
+	}
+
+	void evaluateColumns(const LLSkyScatter* scatter, U32 begin, U32 end)
+	{
+		for (U32 column = begin; column < end; ++column)
+		{
+			U32 offset = column * mResolution;
+			scatter->evaluate(&mDirs[offset], mResolution, &mSky[offset], &mShiny[offset]);
+		}
+	}
+
+	S32						mResolution;
+	std::vector<LLVector3>	mDirs;
+	std::vector<LLColor4>	mSky;
+	std::vector<LLColor4>	mShiny;
+};
+
+static LLSkyScatter::Params midday_params()
+{
+	LLSkyScatter::Params params;
+	params.dome_radius = 15000.f;
+	params.dome_offset_ratio = 0.96f;
+	params.sunlight_color.setVec(0.735f, 0.735f, 0.735f);
+	params.ambient.setVec(0.36f, 0.36f, 0.36f);
+	params.lightnorm.setVec(0.f, 0.707f, -0.707f, 0.f);
+	params.blue_density.setVec(0.245f, 0.449f, 0.76f);
+	params.blue_horizon.setVec(0.495f, 0.495f, 0.64f);
+	params.haze_density = 0.7f;
+	params.haze_horizon = 0.19f;
+	params.density_multiplier = 0.00018f;
+	params.max_y = 1605.f;
+	params.glow.setVec(5.f, 0.001f, -0.48f);
+	params.cloud_shadow = 0.27f;
+	params.fog_color.setVec(0.48f, 0.52f, 0.58f, 1.f);
+	params.windlight_shaders = true;
+	return params;
+}
+
+static void report(const char* name, F64 seconds, S32 iterations)
+{
+	F64 ms = seconds * 1000.0 / iterations;
+	std::cout << name << ": " << ms << " ms per cube, "
+			  << (ms <= FRAME_BUDGET_MS ? "within" : "over") << " a 60 fps frame" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+	ll_init_apr();
+
+	LLError::initForApplication(".");
+	LLError::setDefaultLevel(LLError::LEVEL_WARN);
+
+	S32 iterations = DEFAULT_ITERATIONS;
+	S32 resolution = DEFAULT_RESOLUTION;
+	if (argc > 1)
+	{
+		iterations = llmax(atoi(argv[1]), 1);
+	}
+	if (argc > 2)
+	{
+		resolution = llmax(atoi(argv[2]), 1);
+	}
+
+	SkyCube cube(resolution);
+	const LLSkyScatter scatter(midday_params());
+	const U32 texels = cube.mDirs.size();
+	const U32 columns = 6 * resolution;
+
+	LLTimer timer;
+	for (S32 i = 0; i < iterations; ++i)
+	{
+		for (U32 texel = 0; texel < texels; ++texel)
+		{
+			scatter.evaluate(&cube.mDirs[texel], 1, &cube.mSky[texel], &cube.mShiny[texel]);
+		}
+	}
+	report("per direction  ", timer.getElapsedTimeF64(), iterations);
+
+	timer.reset();
+	for (S32 i = 0; i < iterations; ++i)
+	{
+		cube.evaluateColumns(&scatter, 0, columns);
+	}
+	report("batched        ", timer.getElapsedTimeF64(), iterations);
+
+	LLWorkerPool* pool = LLWorkerPool::getDefault();
+	LLWorkerPool::range_job_t job = boost::bind(&SkyCube::evaluateColumns, &cube, &scatter, _1, _2);
+	timer.reset();
+	for (S32 i = 0; i < iterations; ++i)
+	{
+		// The grain LLVOSky uses.
+		pool->parallelFor(columns, 8, job);
+	}
+	std::cout << pool->getNumThreads() + 1 << " threads" << std::endl;
+	report("batched, pooled", timer.getElapsedTimeF64(), iterations);
+
+	LLWorkerPool::cleanupDefault();
+	ll_cleanup_apr();
+	return 0;
+}